@@ -46,6 +46,8 @@ typedef void         RT_VOID;
 typedef float        RT_FLOAT;
 
 typedef void ( *RT_CALLBACK_T )( int p_event, void *p_data);
+// called when bytes lent by lendData() are consumed by demuxer
+typedef void ( *RT_WRITEDATA_RELEASE )( void *opaque, const void *data);
 
 #define RtToBool(cond)  ((cond) != 0)
 #define RtToS8(x)     ((INT8)(x))
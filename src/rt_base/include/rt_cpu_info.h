@@ -24,4 +24,19 @@
 
 UINT32 rt_cpu_count(void);
 
+// instruction sets which can run on this cpu, checked at runtime
+#define RT_CPU_FEATURE_SSE2     (1 << 0)
+#define RT_CPU_FEATURE_SSE41    (1 << 1)
+#define RT_CPU_FEATURE_AVX2     (1 << 2)
+#define RT_CPU_FEATURE_NEON     (1 << 3)
+
+UINT32 rt_cpu_features(void);
+
+/*
+ * cpus of the fastest and of the slowest cluster by max frequency, bit i is
+ * cpu i. both are 0 when all cpus are the same or frequency is unknown.
+ */
+UINT64 rt_cpu_mask_big(void);
+UINT64 rt_cpu_mask_little(void);
+
 #endif  // SRC_RT_BASE_INCLUDE_RT_CPU_INFO_H_
@@ -38,6 +38,8 @@ typedef UINT32 (*rt_hash_comp_func)(const void *key1, const void *key2);
 // ! Hash Function for pointer
 UINT32 hash_ptr_func(UINT32 bucktes, const void *key);
 UINT32 hash_ptr_compare(const void *key1, const void *key2);
+// ! Hash Function for pointer and integer, all bits of key are mixed
+UINT32 hash_ptr_mix_func(UINT32 bucktes, const void *key);
 // ! Hash Function for String
 UINT32 hash_string_func(UINT32 bucktes, const void *key);
 UINT32 hash_string_compare(const void *key1, const void *key2);
@@ -46,6 +48,18 @@ UINT32 hash_string_compare(const void *key1, const void *key2);
 struct RtHashTable *rt_hash_table_create(UINT32 num_buckets,
                                                rt_hash_func hash,
                                                rt_hash_comp_func compare);
+
+/*
+ * open addressing table with robin hood probing, entries are inline in
+ * slots and slots grow with entries, so insert doesn't malloc one by one.
+ * hash is called with UINT32 max as buckets, and it is mixed again.
+ * all rt_hash_table_* work on it, buckets are slots with one node at most.
+ * keys should be unique, nodes are moved by insert and remove, so pointers
+ * of node are valid until the next insert or remove.
+ */
+struct RtHashTable *rt_hash_table_create_open(UINT32 num_slots,
+                                               rt_hash_func hash,
+                                               rt_hash_comp_func compare);
 void   rt_hash_table_destory(struct RtHashTable *hash, RT_BOOL free_data = RT_FALSE);
 void   rt_hash_table_dump(struct RtHashTable *hash);
 void   rt_hash_table_clear(struct RtHashTable *hash, RT_BOOL free_data = RT_FALSE);
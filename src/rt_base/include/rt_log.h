@@ -52,6 +52,16 @@ void rt_log(const char *tag, const char *fmt, const char *fname,
 void rt_err(const char *tag, const char *fmt, const char *fname,
                             const UINT16 row, ...);
 
+/*
+ * async mode: callers pack format and arguments into a ring of their own
+ * without lock, and lines are written by a background thread. format,
+ * tag and function must live as long as process, strings of "%s" are
+ * copied. repeated lines are limited, and lines are dropped if ring is full.
+ */
+void   rt_set_log_async(RT_BOOL async);
+RT_RET rt_log_flush();
+UINT64 rt_log_dropped();
+
 #ifdef __cplusplus
 }
 #endif
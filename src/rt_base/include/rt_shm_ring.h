@@ -0,0 +1,80 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * module: ring of frames in shared memory, one writer process publishes
+ *         frames or pcm, and reader processes take them without lock.
+ */
+
+#ifndef SRC_RT_BASE_INCLUDE_RT_SHM_RING_H_
+#define SRC_RT_BASE_INCLUDE_RT_SHM_RING_H_
+
+#include "rt_header.h" // NOLINT
+
+#define RT_SHM_RING_VERSION     1
+#define RT_SHM_RING_NAME_LEN    64
+
+#define RT_SHM_FRAME_FLAG_EOS       (1 << 0)
+#define RT_SHM_FRAME_FLAG_FORMAT    (1 << 1)    // format differs from last frame
+
+typedef enum _RT_SHM_FORMAT_TYPE {
+    RT_SHM_FORMAT_UNKNOWN = 0,
+    RT_SHM_FORMAT_VIDEO,
+    RT_SHM_FORMAT_AUDIO,
+} RT_SHM_FORMAT_TYPE;
+
+typedef struct _RtShmFormat {
+    INT32   mType;          // RT_SHM_FORMAT_TYPE
+    INT32   mFormat;        // RtVideoFormat or RtAudioFormat
+    INT32   mWidth;
+    INT32   mHeight;
+    INT32   mSampleRate;
+    INT32   mChannels;
+} RtShmFormat;
+
+typedef struct _RtShmFrame {
+    UINT64      mSeq;       // index of frame from the first one of writer
+    UINT32      mSize;      // bytes of frame, it is more than read when truncated
+    UINT32      mFlags;     // RT_SHM_FRAME_FLAG_*
+    INT64       mPts;
+    INT64       mWriteUs;   // RtTime::getNowTimeUs() of writer, for latency
+    RtShmFormat mFormat;
+} RtShmFrame;
+
+struct RtShmRing;
+
+/*
+ * writer never waits for readers. slots is rounded up to power of 2, the
+ * oldest frames are overwritten, and readers which are slower skip them.
+ * name is of /dev/shm, it is unlinked when writer closes the ring.
+ */
+struct RtShmRing* rt_shm_ring_create(const char *name, UINT32 slots, UINT32 slotBytes);
+RT_RET  rt_shm_ring_write(struct RtShmRing *ring, const void *data, UINT32 size,
+                          const RtShmFrame *frame);
+
+// reader api, what is needed by a reader process is this header only
+struct RtShmRing* rt_shm_ring_open(const char *name);
+/*
+ * copies next frame to data and returns RT_OK, RT_ERR_TIMEOUT when there
+ * is no frame in timeoutUs, RT_ERR_END_OF_STREAM when writer is closed.
+ * reader starts from the oldest frame in ring when it opens.
+ */
+RT_RET  rt_shm_ring_read(struct RtShmRing *ring, void *data, UINT32 capacity,
+                         RtShmFrame *frame, INT64 timeoutUs);
+// frames which are overwritten before reader takes them
+UINT64  rt_shm_ring_dropped(struct RtShmRing *ring);
+
+void    rt_shm_ring_close(struct RtShmRing **ring);
+
+#endif  // SRC_RT_BASE_INCLUDE_RT_SHM_RING_H_
@@ -36,6 +36,38 @@ typedef enum {
     THREAD_MAX,
 } ThreadState;
 
+typedef enum {
+    RT_SCHED_OTHER = 0,
+    RT_SCHED_FIFO,
+    RT_SCHED_RR,
+} RT_SCHED_POLICY;
+
+/*
+ * scheduling of thread, mPriority is 1~99 for FIFO and RR, mNice is
+ * -20~19 for OTHER. bit i of mCpuMask is cpu i, 0 means all cpus.
+ */
+typedef struct _RtThreadSched {
+    RT_SCHED_POLICY mPolicy;
+    INT32           mPriority;
+    INT32           mNice;
+    UINT64          mCpuMask;
+} RtThreadSched;
+
+// classes of scheduling requested by nodes and loopers
+typedef enum {
+    RT_THREAD_CLASS_DEFAULT = 0,    // inherited from creator, nothing applied
+    RT_THREAD_CLASS_REALTIME,       // message, vsync: FIFO
+    RT_THREAD_CLASS_AUDIO_RT,       // audio render: FIFO on big cores
+    RT_THREAD_CLASS_DECODE,         // decode and filter: higher nice on big cores
+    RT_THREAD_CLASS_BACKGROUND,     // io, thumbnail: lower nice on little cores
+    RT_THREAD_CLASS_MAX,
+} RT_THREAD_CLASS;
+
+/*
+ * fills scheduling of class, returns RT_ERR_VALUE for unknown class.
+ */
+RT_RET rt_thread_sched_of_class(RT_THREAD_CLASS cls, RtThreadSched *sched);
+
 class RtThread {
  public:
     // RtTaskSlot: atomic task, short time consumption
@@ -68,8 +100,18 @@ class RtThread {
     void join();
     void requestInterruption();
 
+    /**
+     * Scheduling applied by the thread itself before task runs, so it
+     * works for all later starts. a failed item (e.g. FIFO without
+     * CAP_SYS_NICE) is logged, and the others are still applied.
+     */
+    void setSched(const RtThreadSched *sched);
+    void setSchedClass(RT_THREAD_CLASS cls);
+
  public:
-    static INT32 getThreadID();
+    static INT32  getThreadID();
+    // scheduling which is in effect for calling thread
+    static RT_RET getSchedSelf(RtThreadSched *sched);
 
  public:
     void                *mData;
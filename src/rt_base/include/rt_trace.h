@@ -0,0 +1,93 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * module: tracing of pipeline, spans and instants are recorded into a ring
+ *         of the calling thread without lock, and dumped as chrome
+ *         trace-event json, which is opened by chrome://tracing or perfetto.
+ */
+
+#ifndef SRC_RT_BASE_INCLUDE_RT_TRACE_H_
+#define SRC_RT_BASE_INCLUDE_RT_TRACE_H_
+
+#include "rt_header.h" // NOLINT
+
+#define RT_TRACE_RING_EVENTS    4096    // power of 2, the oldest are overwritten
+#define RT_TRACE_MAX_THREADS    64
+
+#define RT_TRACE_PHASE_BEGIN    'B'
+#define RT_TRACE_PHASE_END      'E'
+#define RT_TRACE_PHASE_INSTANT  'i'
+#define RT_TRACE_PHASE_COUNTER  'C'
+
+/*
+ * category and name are not copied, they must be string literals or
+ * strings which live as long as process, such as names of node stub.
+ */
+void    rt_trace_enable(RT_BOOL enable);
+RT_BOOL rt_trace_enabled();
+void    rt_trace_event(char phase, const char *category, const char *name, INT64 value);
+void    rt_trace_thread_name(const char *name);
+
+// drop all events in rings, rings of live threads are kept
+void    rt_trace_reset();
+
+// events of all threads to json file, events being written are skipped
+RT_RET  rt_trace_dump(const char *path);
+
+class RtTraceScope {
+ public:
+    RtTraceScope(const char *category, const char *name)
+            : mCategory(category), mName(name), mActive(rt_trace_enabled()) {
+        if (mActive) {
+            rt_trace_event(RT_TRACE_PHASE_BEGIN, mCategory, mName, 0);
+        }
+    }
+    ~RtTraceScope() {
+        if (mActive) {
+            rt_trace_event(RT_TRACE_PHASE_END, mCategory, mName, 0);
+        }
+    }
+
+ private:
+    const char *mCategory;
+    const char *mName;
+    RT_BOOL     mActive;
+};
+
+/*
+ * macros of tracing are removed at compile time without HAVE_TRACE,
+ * otherwise they cost a relaxed load when tracing is disabled at runtime.
+ */
+#ifdef HAVE_TRACE
+#define RT_TRACE_CONCAT_(a, b)              a##b
+#define RT_TRACE_CONCAT(a, b)               RT_TRACE_CONCAT_(a, b)
+#define RT_TRACE_BEGIN(category, name)      rt_trace_event(RT_TRACE_PHASE_BEGIN, category, name, 0)
+#define RT_TRACE_END(category, name)        rt_trace_event(RT_TRACE_PHASE_END, category, name, 0)
+#define RT_TRACE_INSTANT(category, name, value) \
+                                            rt_trace_event(RT_TRACE_PHASE_INSTANT, category, name, value)
+#define RT_TRACE_COUNTER(category, name, value) \
+                                            rt_trace_event(RT_TRACE_PHASE_COUNTER, category, name, value)
+#define RT_TRACE_SCOPE(category, name)      RtTraceScope RT_TRACE_CONCAT(__trace_, __LINE__)(category, name)
+#define RT_TRACE_THREAD(name)               rt_trace_thread_name(name)
+#else
+#define RT_TRACE_BEGIN(category, name)          do {} while (0)
+#define RT_TRACE_END(category, name)            do {} while (0)
+#define RT_TRACE_INSTANT(category, name, value) do {} while (0)
+#define RT_TRACE_COUNTER(category, name, value) do {} while (0)
+#define RT_TRACE_SCOPE(category, name)          do {} while (0)
+#define RT_TRACE_THREAD(name)                   do {} while (0)
+#endif
+
+#endif  // SRC_RT_BASE_INCLUDE_RT_TRACE_H_
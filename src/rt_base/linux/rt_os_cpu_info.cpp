@@ -22,11 +22,79 @@
 #ifdef OS_LINUX
 
 //  #include <sysconf.h>
+#include <stdio.h>
 #include <unistd.h>
 UINT32 rt_cpu_count(void) {
     UINT32 count = sysconf(_SC_NPROCESSORS_CONF);
     return count;
 }
 
+UINT32 rt_cpu_features(void) {
+    UINT32 features = 0;
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_cpu_init();
+    features |= __builtin_cpu_supports("sse2")   ? RT_CPU_FEATURE_SSE2  : 0;
+    features |= __builtin_cpu_supports("sse4.1") ? RT_CPU_FEATURE_SSE41 : 0;
+    features |= __builtin_cpu_supports("avx2")   ? RT_CPU_FEATURE_AVX2  : 0;
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    // neon is mandatory in armv8, and armv7 is built with -mfpu=neon
+    features |= RT_CPU_FEATURE_NEON;
+#endif
+    return features;
+}
+
+#define RT_CPU_MASK_MAX     64
+
+static UINT32 rt_cpu_max_freq(UINT32 cpu) {
+    char   path[96];
+    UINT32 freq = 0;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cpufreq/cpuinfo_max_freq", cpu);
+    FILE *fp = fopen(path, "r");
+    if (NULL != fp) {
+        if (1 != fscanf(fp, "%u", &freq)) {
+            freq = 0;
+        }
+        fclose(fp);
+    }
+    return freq;
+}
+
+// big is true for the cluster of highest frequency, otherwise lowest
+static UINT64 rt_cpu_mask_cluster(bool big) {
+    UINT32 freqs[RT_CPU_MASK_MAX];
+    UINT32 count  = rt_cpu_count();
+    UINT32 target = 0;
+    UINT64 mask   = 0;
+    UINT64 all    = 0;
+    count = (count > RT_CPU_MASK_MAX) ? RT_CPU_MASK_MAX : count;
+    for (UINT32 cpu = 0; cpu < count; cpu++) {
+        freqs[cpu] = rt_cpu_max_freq(cpu);
+        if (0 == freqs[cpu]) {
+            return 0;
+        }
+        if ((0 == target) || (big ? (freqs[cpu] > target) : (freqs[cpu] < target))) {
+            target = freqs[cpu];
+        }
+    }
+    for (UINT32 cpu = 0; cpu < count; cpu++) {
+        all |= (1ull << cpu);
+        if (freqs[cpu] == target) {
+            mask |= (1ull << cpu);
+        }
+    }
+    // all cpus are the same
+    return (mask == all) ? 0 : mask;
+}
+
+UINT64 rt_cpu_mask_big(void) {
+    static UINT64 mask = rt_cpu_mask_cluster(true);
+    return mask;
+}
+
+UINT64 rt_cpu_mask_little(void) {
+    static UINT64 mask = rt_cpu_mask_cluster(false);
+    return mask;
+}
+
 #endif  // OS_LINUX
 
@@ -18,12 +18,20 @@
 
 #ifdef  HAS_PTHREAD
 
+#include <errno.h>
+#include <stdio.h>
 #include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 
 #include "rt_thread.h" // NOLINT
+#include "rt_cpu_info.h" // NOLINT
 #include "rt_log.h" // NOLINT
 #include "rt_mem.h" // NOLINT
 #include "rt_string_utils.h" // NOLINT
+#include "rt_trace.h" // NOLINT
 
 #ifdef LOG_TAG
 #undef LOG_TAG
@@ -36,6 +44,7 @@
 #define DEBUG_FLAG 0x1
 
 #define MAX_THREAD_NAME_LEN 12
+#define MAX_THREAD_CPUS     64
 
 #include <string.h>
 
@@ -47,8 +56,75 @@ typedef struct _rt_pthread_data {
     char           mName[MAX_THREAD_NAME_LEN];
     RtRunnable*    mRunnable;
     RtThread::RtTaskSlot mTaskSlot;
+    RT_BOOL        mSchedSet;
+    RtThreadSched  mSched;
 } RtThreadData;
 
+static INT32 thread_sys_tid() {
+    return (INT32)syscall(SYS_gettid);
+}
+
+/*
+ * unprivileged process may not raise priority of its threads, which is
+ * told once per process. other errors are told on every thread.
+ */
+static void thread_sched_error(RtThreadData* data, const char* item, int err) {
+    static volatile INT32 gDeniedOnce = 0;
+    if ((EPERM == err) || (EACCES == err)) {
+        if (__sync_bool_compare_and_swap(&gDeniedOnce, 0, 1)) {
+            RT_LOGD("%s: no permission to set %s, threads run with default scheduling",
+                     data->mName, item);
+        }
+        return;
+    }
+    RT_LOGE("%s: fail to set %s, error=%s", data->mName, item, strerror(err));
+}
+
+// failed items are skipped, thread runs with what is left
+static void thread_apply_sched(RtThreadData* data) {
+    RtThreadSched* sched = &(data->mSched);
+    struct sched_param param;
+    int policy = SCHED_OTHER;
+    switch (sched->mPolicy) {
+      case RT_SCHED_FIFO:
+        policy = SCHED_FIFO;
+        break;
+      case RT_SCHED_RR:
+        policy = SCHED_RR;
+        break;
+      default:
+        break;
+    }
+    rt_memset(&param, 0, sizeof(param));
+    param.sched_priority = (SCHED_OTHER == policy) ? 0 : sched->mPriority;
+    char item[64];
+    int err = pthread_setschedparam(pthread_self(), policy, &param);
+    if (0 != err) {
+        snprintf(item, sizeof(item), "policy(%d) priority(%d)", sched->mPolicy, sched->mPriority);
+        thread_sched_error(data, item, err);
+    }
+
+    if ((SCHED_OTHER == policy) && (0 != setpriority(PRIO_PROCESS, thread_sys_tid(), sched->mNice))) {
+        err = errno;
+        snprintf(item, sizeof(item), "nice(%d)", sched->mNice);
+        thread_sched_error(data, item, err);
+    }
+
+    if (0 != sched->mCpuMask) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (INT32 cpu = 0; cpu < MAX_THREAD_CPUS; cpu++) {
+            if (sched->mCpuMask & (1ull << cpu)) {
+                CPU_SET(cpu, &cpus);
+            }
+        }
+        if (0 != sched_setaffinity(0, sizeof(cpus), &cpus)) {
+            RT_LOGE("%s: fail to set cpu mask(0x%llx), error=%s",
+                     data->mName, (unsigned long long)sched->mCpuMask, strerror(errno));
+        }
+    }
+}
+
 static void* thread_looping(void* arg) {
     RtThread*     thread = static_cast<RtThread*>(arg);
     RtThreadData* data   = static_cast<RtThreadData*>(thread->mData);
@@ -58,6 +134,10 @@ static void* thread_looping(void* arg) {
     if (data->mLoopState == THREAD_IDLE)
         data->mLoopState = THREAD_LOOP;
     RT_LOGD_IF(DEBUG_FLAG, "call, pthread_looper(name:%-010s tid:%lu)", data->mName, tid%10000);
+    RT_TRACE_THREAD(data->mName);
+    if (data->mSchedSet) {
+        thread_apply_sched(data);
+    }
 
     if (RT_NULL != data->mTaskSlot) {
         data->mTaskSlot(data->mPtrData);
@@ -83,6 +163,8 @@ RtThreadData* createThreadData(RtThread::RtTaskSlot task_slot, RtRunnable* runna
         data->mRunnable   = runnable;
         data->mPtrData    = ptr_data;
         data->mLoopState  = THREAD_IDLE;
+        data->mSchedSet   = RT_FALSE;
+        rt_memset(&(data->mSched), 0, sizeof(RtThreadSched));
         return data;
     }
     return RT_NULL;
@@ -174,6 +256,96 @@ const char* RtThread::getName() {
     return "name-??";
 }
 
+void RtThread::setSched(const RtThreadSched* sched) {
+    if ((RT_NULL != mData) && (RT_NULL != sched)) {
+        RtThreadData* data = static_cast<RtThreadData*>(mData);
+        data->mSched    = *sched;
+        data->mSchedSet = RT_TRUE;
+    }
+}
+
+void RtThread::setSchedClass(RT_THREAD_CLASS cls) {
+    RtThreadSched sched;
+    if (RT_NULL == mData) {
+        return;
+    }
+    if (RT_THREAD_CLASS_DEFAULT == cls) {
+        RtThreadData* data = static_cast<RtThreadData*>(mData);
+        data->mSchedSet = RT_FALSE;
+        return;
+    }
+    if (RT_OK == rt_thread_sched_of_class(cls, &sched)) {
+        setSched(&sched);
+    }
+}
+
+RT_RET RtThread::getSchedSelf(RtThreadSched* sched) {
+    struct sched_param param;
+    cpu_set_t cpus;
+    int policy = SCHED_OTHER;
+    if (RT_NULL == sched) {
+        return RT_ERR_NULL_PTR;
+    }
+    if (0 != pthread_getschedparam(pthread_self(), &policy, &param)) {
+        return RT_ERR_BAD;
+    }
+    switch (policy) {
+      case SCHED_FIFO:
+        sched->mPolicy = RT_SCHED_FIFO;
+        break;
+      case SCHED_RR:
+        sched->mPolicy = RT_SCHED_RR;
+        break;
+      default:
+        sched->mPolicy = RT_SCHED_OTHER;
+        break;
+    }
+    sched->mPriority = param.sched_priority;
+    sched->mNice     = getpriority(PRIO_PROCESS, thread_sys_tid());
+    sched->mCpuMask  = 0;
+    CPU_ZERO(&cpus);
+    if (0 != sched_getaffinity(0, sizeof(cpus), &cpus)) {
+        return RT_ERR_BAD;
+    }
+    for (INT32 cpu = 0; cpu < MAX_THREAD_CPUS; cpu++) {
+        if (CPU_ISSET(cpu, &cpus)) {
+            sched->mCpuMask |= (1ull << cpu);
+        }
+    }
+    return RT_OK;
+}
+
+RT_RET rt_thread_sched_of_class(RT_THREAD_CLASS cls, RtThreadSched* sched) {
+    if (RT_NULL == sched) {
+        return RT_ERR_NULL_PTR;
+    }
+    rt_memset(sched, 0, sizeof(RtThreadSched));
+    switch (cls) {
+      case RT_THREAD_CLASS_DEFAULT:
+        break;
+      case RT_THREAD_CLASS_REALTIME:
+        sched->mPolicy   = RT_SCHED_FIFO;
+        sched->mPriority = 1;
+        break;
+      case RT_THREAD_CLASS_AUDIO_RT:
+        sched->mPolicy   = RT_SCHED_FIFO;
+        sched->mPriority = 3;
+        sched->mCpuMask  = rt_cpu_mask_big();
+        break;
+      case RT_THREAD_CLASS_DECODE:
+        sched->mNice     = -4;
+        sched->mCpuMask  = rt_cpu_mask_big();
+        break;
+      case RT_THREAD_CLASS_BACKGROUND:
+        sched->mNice     = 10;
+        sched->mCpuMask  = rt_cpu_mask_little();
+        break;
+      default:
+        return RT_ERR_VALUE;
+    }
+    return RT_OK;
+}
+
 INT32 RtThread::getThreadID() {
     pthread_t tid = pthread_self();
     return (INT32)tid;
@@ -28,16 +28,16 @@ void RtTime::getDateTime(DateTime* dt) {
     if (dt) {
         time_t m_time;
         time(&m_time);
-        struct tm* tstruct;
-        localtime_r(&m_time, tstruct);
+        struct tm tstruct;
+        localtime_r(&m_time, &tstruct);
 
-        dt->mYear       = RtToU16(tstruct->tm_year);
-        dt->mMonth      = RtToU8(tstruct->tm_mon + 1);
-        dt->mDayOfWeek  = RtToU8(tstruct->tm_wday);
-        dt->mDay        = RtToU8(tstruct->tm_mday);
-        dt->mHour       = RtToU8(tstruct->tm_hour);
-        dt->mMinute     = RtToU8(tstruct->tm_min);
-        dt->mSecond     = RtToU8(tstruct->tm_sec);
+        dt->mYear       = RtToU16(tstruct.tm_year + 1900);
+        dt->mMonth      = RtToU8(tstruct.tm_mon + 1);
+        dt->mDayOfWeek  = RtToU8(tstruct.tm_wday);
+        dt->mDay        = RtToU8(tstruct.tm_mday);
+        dt->mHour       = RtToU8(tstruct.tm_hour);
+        dt->mMinute     = RtToU8(tstruct.tm_min);
+        dt->mSecond     = RtToU8(tstruct.tm_sec);
     }
 }
 
@@ -33,14 +33,193 @@
 #endif
 #define LOG_TAG "rt_hash_table"
 
+/*
+ * slot of open addressing, root links to node if slot is used, so that
+ * slots are walked as buckets of chained table. dist is the distance of
+ * probing plus one, zero is an empty slot.
+ */
+struct RtHashSlot {
+    struct rt_hash_node root;
+    struct rt_hash_node node;
+    UINT32 hash;
+    UINT32 dist;
+};
+
+#define HASH_OPEN_MIN_SLOTS     16
+#define HASH_OPEN_LOAD_NUM      7       // slots grow at 7/8 load
+#define HASH_OPEN_LOAD_DEN      8
+
 struct RtHashTable {
     rt_hash_func      hash;
     rt_hash_comp_func compare;
 
+    // slots of open addressing, RT_NULL for chained table
+    struct RtHashSlot *slots;
+    UINT32   num_slots;
+    UINT32   num_entries;
+
     unsigned num_buckets;
     struct rt_hash_node buckets[1];
 };
 
+static struct rt_hash_node hash_empty_root = { RT_NULL, RT_NULL, RT_NULL };
+
+// finalizer of murmur3, bits of key are spread to all bits of hash
+static inline UINT32 hash_mix32(UINT32 value) {
+    value ^= value >> 16;
+    value *= 0x85ebca6b;
+    value ^= value >> 13;
+    value *= 0xc2b2ae35;
+    value ^= value >> 16;
+    return value;
+}
+
+static inline UINT32 hash_mix64(UINT64 value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdull;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ull;
+    value ^= value >> 33;
+    return (UINT32)value;
+}
+
+static inline UINT32 hash_open_value(struct RtHashTable *ht, const void *key) {
+    return hash_mix32((*ht->hash)(0xFFFFFFFF, key));
+}
+
+static struct RtHashSlot *hash_open_alloc(UINT32 num_slots) {
+    struct RtHashSlot *slots = rt_malloc_array(struct RtHashSlot, num_slots);
+    if (RT_NULL != slots) {
+        rt_memset(slots, 0, sizeof(struct RtHashSlot) * num_slots);
+    }
+    return slots;
+}
+
+static void hash_open_place(struct RtHashSlot *slot, const void *key, void *data,
+                            UINT32 hash, UINT32 dist) {
+    slot->node.next = RT_NULL;
+    slot->node.key  = key;
+    slot->node.data = data;
+    slot->root.next = &slot->node;
+    slot->hash      = hash;
+    slot->dist      = dist;
+}
+
+// robin hood: entry takes the slot of a richer one, which goes on probing
+static void hash_open_put(struct RtHashSlot *slots, UINT32 num_slots,
+                          const void *key, void *data, UINT32 hash) {
+    UINT32 mask = num_slots - 1;
+    UINT32 idx  = hash & mask;
+    UINT32 dist = 1;
+    while (0 != slots[idx].dist) {
+        struct RtHashSlot *slot = &slots[idx];
+        if (slot->dist < dist) {
+            const void *slot_key  = slot->node.key;
+            void       *slot_data = slot->node.data;
+            UINT32      slot_hash = slot->hash;
+            UINT32      slot_dist = slot->dist;
+            hash_open_place(slot, key, data, hash, dist);
+            key  = slot_key;
+            data = slot_data;
+            hash = slot_hash;
+            dist = slot_dist;
+        }
+        idx = (idx + 1) & mask;
+        dist++;
+    }
+    hash_open_place(&slots[idx], key, data, hash, dist);
+}
+
+static RT_BOOL hash_open_grow(struct RtHashTable *ht, UINT32 num_slots) {
+    struct RtHashSlot *slots = hash_open_alloc(num_slots);
+    if (RT_NULL == slots) {
+        return RT_FALSE;
+    }
+    for (UINT32 idx = 0; idx < ht->num_slots; idx++) {
+        struct RtHashSlot *slot = &ht->slots[idx];
+        if (0 != slot->dist) {
+            hash_open_put(slots, num_slots, slot->node.key, slot->node.data, slot->hash);
+        }
+    }
+    rt_safe_free(ht->slots);
+    ht->slots     = slots;
+    ht->num_slots = num_slots;
+    return RT_TRUE;
+}
+
+// index of slot with key, a richer slot on the way means key is absent
+static INT32 hash_open_find(struct RtHashTable *ht, const void *key) {
+    UINT32 hash = hash_open_value(ht, key);
+    UINT32 mask = ht->num_slots - 1;
+    UINT32 idx  = hash & mask;
+    for (UINT32 dist = 1; dist <= ht->slots[idx].dist; dist++) {
+        struct RtHashSlot *slot = &ht->slots[idx];
+        if ((slot->hash == hash) && ((*ht->compare)(slot->node.key, key) == 0)) {
+            return idx;
+        }
+        idx = (idx + 1) & mask;
+    }
+    return -1;
+}
+
+static void hash_open_insert(struct RtHashTable *ht, const void *key, void *data) {
+    if ((ht->num_entries + 1) * HASH_OPEN_LOAD_DEN > ht->num_slots * HASH_OPEN_LOAD_NUM) {
+        if (!hash_open_grow(ht, ht->num_slots * 2) && (ht->num_entries == ht->num_slots)) {
+            RT_LOGE("fail to grow hash=%p with %d entries", ht, ht->num_entries);
+            return;
+        }
+    }
+    hash_open_put(ht->slots, ht->num_slots, key, data, hash_open_value(ht, key));
+    ht->num_entries++;
+}
+
+// entries behind are shifted back, so no tombstone is left
+static RT_BOOL hash_open_remove(struct RtHashTable *ht, const void *key, RT_BOOL free_data) {
+    INT32 found = hash_open_find(ht, key);
+    if (found < 0) {
+        RT_LOGE("don't find node from the key!");
+        return RT_FALSE;
+    }
+    if (free_data) {
+        rt_safe_free(ht->slots[found].node.data);
+    }
+
+    UINT32 mask = ht->num_slots - 1;
+    UINT32 idx  = found;
+    UINT32 next = (idx + 1) & mask;
+    while (ht->slots[next].dist > 1) {
+        struct RtHashSlot *slot = &ht->slots[next];
+        hash_open_place(&ht->slots[idx], slot->node.key, slot->node.data, slot->hash, slot->dist - 1);
+        idx  = next;
+        next = (next + 1) & mask;
+    }
+    rt_memset(&ht->slots[idx], 0, sizeof(struct RtHashSlot));
+    ht->num_entries--;
+    return RT_TRUE;
+}
+
+struct RtHashTable *rt_hash_table_create_open(UINT32 num_slots,
+                                rt_hash_func hash, rt_hash_comp_func compare) {
+    UINT32 slots = HASH_OPEN_MIN_SLOTS;
+    while (slots < num_slots) {
+        slots <<= 1;
+    }
+
+    struct RtHashTable *ht = rt_malloc(struct RtHashTable);
+    if (RT_NULL == ht) {
+        return RT_NULL;
+    }
+    rt_memset(ht, 0, sizeof(struct RtHashTable));
+    ht->hash      = hash;
+    ht->compare   = compare;
+    ht->slots     = hash_open_alloc(slots);
+    ht->num_slots = slots;
+    if (RT_NULL == ht->slots) {
+        rt_safe_free(ht);
+    }
+    return ht;
+}
+
 struct RtHashTable *rt_hash_table_create(UINT32 num_buckets,
                                 rt_hash_func hash, rt_hash_comp_func compare) {
     struct RtHashTable *ht;
@@ -55,6 +234,9 @@ struct RtHashTable *rt_hash_table_create(UINT32 num_buckets,
     if (ht != NULL) {
         ht->hash        = hash;
         ht->compare     = compare;
+        ht->slots       = RT_NULL;
+        ht->num_slots   = 0;
+        ht->num_entries = 0;
         ht->num_buckets = num_buckets;
 
         for (i = 0; i < num_buckets; i++) {
@@ -70,6 +252,7 @@ struct RtHashTable *rt_hash_table_create(UINT32 num_buckets,
 
 void rt_hash_table_destory(struct RtHashTable *ht, RT_BOOL free_data) {
     rt_hash_table_clear(ht, free_data);
+    rt_safe_free(ht->slots);
     rt_safe_free(ht);
 }
 
@@ -94,6 +277,17 @@ void remove_at_head(rt_hash_node* list, rt_hash_node* elem) {
 void rt_hash_table_clear(struct RtHashTable *ht, RT_BOOL free_data) {
     struct rt_hash_node *list, *node, *next;
 
+    if (RT_NULL != ht->slots) {
+        for (UINT32 idx = 0; idx < ht->num_slots; idx++) {
+            if (free_data && (0 != ht->slots[idx].dist)) {
+                rt_safe_free(ht->slots[idx].node.data);
+            }
+        }
+        rt_memset(ht->slots, 0, sizeof(struct RtHashSlot) * ht->num_slots);
+        ht->num_entries = 0;
+        return;
+    }
+
     for (UINT32 bucket = 0; bucket < rt_hash_table_get_num_buckets(ht); bucket++) {
         list = rt_hash_table_get_bucket(ht, bucket);
         for (node = list->next; node != RT_NULL; node = next) {
@@ -110,11 +304,24 @@ void rt_hash_table_clear(struct RtHashTable *ht, RT_BOOL free_data) {
 }
 
 void rt_hash_table_dump(struct RtHashTable *ht) {
-    RT_LOGE("hash=%p; buckets=%02d", ht, ht->num_buckets);
     UINT32 bucket = 0;
     UINT32 idx    = 0;
     struct rt_hash_node *list, *node;
 
+    if (RT_NULL != ht->slots) {
+        RT_LOGE("hash=%p; slots=%02d; entries=%02d", ht, ht->num_slots, ht->num_entries);
+        for (bucket = 0; bucket < ht->num_slots; bucket++) {
+            struct RtHashSlot *slot = &ht->slots[bucket];
+            if (0 != slot->dist) {
+                RT_LOGE("slots[%02d:%02d]: node->key:%p, node->data:%p",
+                         bucket, slot->dist, slot->node.key, slot->node.data);
+            }
+        }
+        return;
+    }
+
+    RT_LOGE("hash=%p; buckets=%02d", ht, ht->num_buckets);
+
     for (bucket = 0; bucket < ht->num_buckets; bucket++) {
         idx    = 0;
         list = &(ht->buckets[bucket]);
@@ -126,6 +333,11 @@ void rt_hash_table_dump(struct RtHashTable *ht) {
 }
 
 struct rt_hash_node* rt_hash_table_find_root(struct RtHashTable *ht, const void *key) {
+    if (RT_NULL != ht->slots) {
+        INT32 found = hash_open_find(ht, key);
+        return (found < 0) ? &hash_empty_root : &ht->slots[found].root;
+    }
+
     const UINT32 hash_value = (*ht->hash)(ht->num_buckets, key);
     const UINT32 bucket     = hash_value % ht->num_buckets;
     struct rt_hash_node *list = &(ht->buckets[bucket]);
@@ -135,6 +347,11 @@ struct rt_hash_node* rt_hash_table_find_root(struct RtHashTable *ht, const void
 
 struct rt_hash_node* rt_hash_table_find_node(struct RtHashTable *ht, const void *key) {
     struct rt_hash_node *list, *node;
+    if (RT_NULL != ht->slots) {
+        INT32 found = hash_open_find(ht, key);
+        return (found < 0) ? RT_NULL : &ht->slots[found].node;
+    }
+
     list = rt_hash_table_find_root(ht, key);
     for (node = list->next; node != RT_NULL; node = node->next) {
        if ((*ht->compare)(node->key, key) == 0) {
@@ -154,6 +371,11 @@ void rt_hash_table_insert(
         struct RtHashTable *ht,
         const void *key,
         void *data) {
+    if (RT_NULL != ht->slots) {
+        hash_open_insert(ht, key, data);
+        return;
+    }
+
     const UINT32 hash_value = (*ht->hash)(ht->num_buckets, key);
     const UINT32 bucket     = hash_value % ht->num_buckets;
 
@@ -181,6 +403,10 @@ RT_BOOL rt_hash_table_replace(
 }
 
 RT_BOOL rt_hash_table_remove(struct RtHashTable *ht, const void *key, RT_BOOL free_data) {
+    if (RT_NULL != ht->slots) {
+        return hash_open_remove(ht, key, free_data);
+    }
+
     const UINT32 hash_value   = (*ht->hash)(ht->num_buckets, key);
     const UINT32 bucket       = hash_value % ht->num_buckets;
     struct rt_hash_node* list = &(ht->buckets[bucket]);
@@ -205,17 +431,20 @@ RT_BOOL rt_hash_table_remove(struct RtHashTable *ht, const void *key, RT_BOOL fr
 }
 
 UINT32 rt_hash_table_get_num_buckets(struct RtHashTable *hash) {
-    return hash->num_buckets;
+    return (RT_NULL != hash->slots) ? hash->num_slots : hash->num_buckets;
 }
 
 struct rt_hash_node* rt_hash_table_get_bucket(struct RtHashTable *hash, UINT32 idx) {
+    if (RT_NULL != hash->slots) {
+        return (idx < hash->num_slots) ? &hash->slots[idx].root : RT_NULL;
+    }
     if (idx < hash->num_buckets) {
         return & hash->buckets[idx];
     }
     return RT_NULL;
 }
 
-UINT32 hash_string_func(const void *key) {
+UINT32 rt_hash_table_string_hash(const void *key) {
     const char *str = (const char *) key;
     UINT32 hash = 5381;
 
@@ -227,6 +456,14 @@ UINT32 hash_string_func(const void *key) {
     return hash;
 }
 
+UINT32 hash_string_func(UINT32 bucktes, const void *key) {
+    return rt_hash_table_string_hash(key) % bucktes;
+}
+
+UINT32 hash_string_compare(const void *key1, const void *key2) {
+    return strcmp((const char *)key1, (const char *)key2) == 0 ? 0 : 1;
+}
+
 UINT32 hash_ptr_func(UINT32 bucktes, const void *key) {
     // return *((UINT32 *)(key)) % bucktes;
     // return (UINT32)((uintptr_t) key / sizeof(void *));
@@ -234,6 +471,10 @@ UINT32 hash_ptr_func(UINT32 bucktes, const void *key) {
     return (iKey % bucktes);
 }
 
+UINT32 hash_ptr_mix_func(UINT32 bucktes, const void *key) {
+    return hash_mix64(reinterpret_cast<uintptr_t>(key)) % bucktes;
+}
+
 UINT32 hash_ptr_compare(const void *key1, const void *key2) {
     return key1 == key2 ? 0 : 1;
 }
@@ -23,11 +23,11 @@
 
 #include "rt_header.h" // NOLINT
 #include "rt_os_log.h" // NOLINT
+#include "rt_log_async.h" // NOLINT
 
 typedef void (*rt_log_callback)(const char*, const char*, va_list);
 
 static UINT32   rt_log_flag = 0;
-static RtMutex* rt_log_lock = RT_NULL;
 
 #define MAX_LINE_LEN 256
 
@@ -35,6 +35,12 @@ void rt_set_log_flag(UINT32 flag) {
     rt_log_flag = flag;
 }
 
+// created once by the first caller, it is never freed for logs at exit
+static RtMutex* rt_log_lock() {
+    static RtMutex* lock = new RtMutex();
+    return lock;
+}
+
 static void rt_log_full(rt_log_callback log_cb, const char *tag,
                         const char *fmt, const char *fname,
                         const UINT16 row, va_list args) {
@@ -50,25 +56,23 @@ static void rt_log_full(rt_log_callback log_cb, const char *tag,
 
 void rt_log(const char *tag, const char *fmt, const char *fname,
                              const UINT16 row, ...) {
-    if (RT_NULL == rt_log_lock) {
-        rt_log_lock = new RtMutex();
-    }
-    RtAutoMutex autolock(rt_log_lock);
     va_list args;
     va_start(args, row);
-    rt_log_full(rt_os_log, tag, fmt, fname, row, args);
+    if (!rt_log_async_push(RT_LOG_LEVEL_LOG, tag, fmt, fname, row, args)) {
+        RtAutoMutex autolock(rt_log_lock());
+        rt_log_full(rt_os_log, tag, fmt, fname, row, args);
+    }
     va_end(args);
 }
 
 void rt_err(const char *tag, const char *fmt, const char *fname,
                             const UINT16 row, ...) {
-    if (RT_NULL == rt_log_lock) {
-        rt_log_lock = new RtMutex();
-    }
-    RtAutoMutex autolock(rt_log_lock);
     va_list args;
     va_start(args, row);
-    rt_log_full(rt_os_err, tag, fmt, fname, row, args);
+    if (!rt_log_async_push(RT_LOG_LEVEL_ERR, tag, fmt, fname, row, args)) {
+        RtAutoMutex autolock(rt_log_lock());
+        rt_log_full(rt_os_err, tag, fmt, fname, row, args);
+    }
     va_end(args);
 }
 
@@ -0,0 +1,641 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: async mode of rt_log. producers pack format and arguments into
+ *         a ring of their own without lock, the background thread formats
+ *         them in order of time, limits repeated lines and counts drops.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#ifdef HAS_PTHREAD
+#include <pthread.h>
+#endif
+
+#include "rt_header.h"       // NOLINT
+#include "rt_thread.h"       // NOLINT
+#include "rt_os_log.h"       // NOLINT
+#include "rt_log_async.h"    // NOLINT
+
+#define LOG_ASYNC_RECORDS       256     // power of 2, records of thread
+#define LOG_ASYNC_MAX_RINGS     64
+#define LOG_ASYNC_MAX_ARGS      12
+#define LOG_ASYNC_DATA_LEN      96
+#define LOG_ASYNC_LINE_LEN      1024
+#define LOG_ASYNC_IDLE_MS       2
+#define LOG_ASYNC_FLUSH_MS      1000
+
+// lines of one format in a window, the rest are counted only
+#define LOG_ASYNC_RATE_SLOTS    64
+#define LOG_ASYNC_RATE_BURST    32
+#define LOG_ASYNC_RATE_WINDOW   1000000ll
+
+typedef void (*rt_log_callback)(const char*, const char*, va_list);
+
+typedef enum _LOG_ARG_KIND {
+    LOG_ARG_NONE = 0,       // "%%"
+    LOG_ARG_INT,
+    LOG_ARG_UINT,
+    LOG_ARG_FLOAT,
+    LOG_ARG_CHAR,
+    LOG_ARG_STR,
+    LOG_ARG_PTR,
+    LOG_ARG_BAD,            // not packed, line is formatted by producer
+} LOG_ARG_KIND;
+
+typedef enum _LOG_ARG_LEN {
+    LOG_LEN_NONE = 0,
+    LOG_LEN_HH,
+    LOG_LEN_H,
+    LOG_LEN_L,
+    LOG_LEN_LL,
+    LOG_LEN_LD,
+    LOG_LEN_J,
+    LOG_LEN_Z,
+    LOG_LEN_T,
+} LOG_ARG_LEN;
+
+// one conversion of format, such as "%-*.*lld"
+typedef struct _RtLogSpec {
+    const char   *mBegin;
+    const char   *mLength;      // length modifier, it is skipped by consumer
+    const char   *mEnd;
+    INT32         mStars;       // arguments of '*' before the value
+    INT32         mPrecision;   // -1 without precision, -2 from argument
+    LOG_ARG_LEN   mLen;
+    LOG_ARG_KIND  mKind;
+} RtLogSpec;
+
+typedef union _RtLogArg {
+    INT64        mInt;
+    double       mFloat;
+    const void  *mPtr;
+} RtLogArg;
+
+/*
+ * strings of "%s" are copied into mData, their args are offsets of mData.
+ * if format is not packed, mData is the line formatted by producer.
+ */
+typedef struct _RtLogRecord {
+    const char  *mTag;
+    const char  *mFmt;
+    const char  *mFunc;
+    UINT64       mTimeUs;
+    UINT16       mRow;
+    UINT8        mLevel;
+    UINT8        mArgCount;
+    UINT8        mDataUsed;
+    UINT8        mFormatted;
+    RtLogArg     mArgs[LOG_ASYNC_MAX_ARGS];
+    char         mData[LOG_ASYNC_DATA_LEN];
+} RtLogRecord;
+
+// single producer and single consumer, head and tail are apart in cache
+typedef struct _RtLogRing {
+    volatile UINT32  mHead;
+    char             mPad0[60];
+    volatile UINT32  mTail;
+    UINT64           mDropsReported;
+    char             mPad1[48];
+    volatile UINT64  mDrops;
+    volatile INT32   mUsed;
+    RtLogRecord      mRecords[LOG_ASYNC_RECORDS];
+} RtLogRing;
+
+typedef struct _RtLogRate {
+    const char  *mFmt;
+    const char  *mFunc;
+    UINT16       mRow;
+    UINT64       mWindowUs;
+    UINT32       mCount;
+    UINT32       mSuppressed;
+} RtLogRate;
+
+static RtLogRing      *gLogRings[LOG_ASYNC_MAX_RINGS];
+static RtLogRate       gLogRates[LOG_ASYNC_RATE_SLOTS];
+static volatile INT32  gLogAsync   = 0;
+static volatile INT32  gLogRunning = 0;
+static RtThread       *gLogThread  = RT_NULL;
+static __thread RtLogRing *tLogRing = RT_NULL;
+
+#ifdef HAS_PTHREAD
+static pthread_key_t   gLogKey;
+static pthread_once_t  gLogOnce = PTHREAD_ONCE_INIT;
+
+// records left in ring are still written, ring is reused after that
+static void log_ring_release(void *ring) {
+    __atomic_store_n(&(static_cast<RtLogRing *>(ring)->mUsed), 0, __ATOMIC_RELEASE);
+}
+
+static void log_key_create() {
+    pthread_key_create(&gLogKey, log_ring_release);
+}
+#endif
+
+static RtMutex *log_async_lock() {
+    static RtMutex *lock = new RtMutex();
+    return lock;
+}
+
+static RtLogRing *log_ring_own(RtLogRing *ring) {
+#ifdef HAS_PTHREAD
+    pthread_once(&gLogOnce, log_key_create);
+    pthread_setspecific(gLogKey, ring);
+#endif
+    tLogRing = ring;
+    return ring;
+}
+
+static RtLogRing *log_ring_acquire() {
+    for (INT32 idx = 0; idx < LOG_ASYNC_MAX_RINGS; idx++) {
+        RtLogRing *ring     = __atomic_load_n(&gLogRings[idx], __ATOMIC_ACQUIRE);
+        INT32      expected = 0;
+        if ((RT_NULL != ring)
+              && (__atomic_load_n(&ring->mTail, __ATOMIC_ACQUIRE) == ring->mHead)
+              && __atomic_compare_exchange_n(&ring->mUsed, &expected, 1, RT_FALSE,
+                                             __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            return log_ring_own(ring);
+        }
+    }
+
+    for (INT32 idx = 0; idx < LOG_ASYNC_MAX_RINGS; idx++) {
+        if (RT_NULL != __atomic_load_n(&gLogRings[idx], __ATOMIC_ACQUIRE)) {
+            continue;
+        }
+        RtLogRing *ring = static_cast<RtLogRing *>(calloc(1, sizeof(RtLogRing)));
+        if (RT_NULL == ring) {
+            return RT_NULL;
+        }
+        ring->mUsed = 1;
+        RtLogRing *expected = RT_NULL;
+        if (__atomic_compare_exchange_n(&gLogRings[idx], &expected, ring, RT_FALSE,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            return log_ring_own(ring);
+        }
+        free(ring);
+    }
+    return RT_NULL;
+}
+
+static const char *log_parse_spec(const char *pos, RtLogSpec *spec) {
+    spec->mBegin     = pos++;
+    spec->mStars     = 0;
+    spec->mPrecision = -1;
+    spec->mLen       = LOG_LEN_NONE;
+    spec->mKind      = LOG_ARG_BAD;
+
+    while ((0 != *pos) && (RT_NULL != strchr("-+ #0'", *pos))) {
+        pos++;
+    }
+    if ('*' == *pos) {
+        spec->mStars++;
+        pos++;
+    }
+    while ((*pos >= '0') && (*pos <= '9')) {
+        pos++;
+    }
+    if ('.' == *pos) {
+        pos++;
+        if ('*' == *pos) {
+            spec->mStars++;
+            spec->mPrecision = -2;
+            pos++;
+        } else {
+            spec->mPrecision = 0;
+            while ((*pos >= '0') && (*pos <= '9')) {
+                spec->mPrecision = spec->mPrecision * 10 + (*pos++ - '0');
+            }
+        }
+    }
+
+    spec->mLength = pos;
+    switch (*pos) {
+      case 'h': spec->mLen = ('h' == pos[1]) ? LOG_LEN_HH : LOG_LEN_H; break;
+      case 'l': spec->mLen = ('l' == pos[1]) ? LOG_LEN_LL : LOG_LEN_L; break;
+      case 'q': spec->mLen = LOG_LEN_LL; break;
+      case 'L': spec->mLen = LOG_LEN_LD; break;
+      case 'j': spec->mLen = LOG_LEN_J;  break;
+      case 'z': spec->mLen = LOG_LEN_Z;  break;
+      case 't': spec->mLen = LOG_LEN_T;  break;
+      default: break;
+    }
+    pos += ((LOG_LEN_HH == spec->mLen) || (('l' == *pos) && (LOG_LEN_LL == spec->mLen))) ? 2
+         : (LOG_LEN_NONE != spec->mLen) ? 1 : 0;
+
+    switch (*pos) {
+      case '%':
+        spec->mKind = (spec->mLength == spec->mBegin + 1) ? LOG_ARG_NONE : LOG_ARG_BAD;
+        break;
+      case 'd': case 'i':
+        spec->mKind = LOG_ARG_INT;
+        break;
+      case 'u': case 'o': case 'x': case 'X':
+        spec->mKind = LOG_ARG_UINT;
+        break;
+      case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        spec->mKind = LOG_ARG_FLOAT;
+        break;
+      case 'c':
+        spec->mKind = (LOG_LEN_NONE == spec->mLen) ? LOG_ARG_CHAR : LOG_ARG_BAD;
+        break;
+      case 's':
+        spec->mKind = (LOG_LEN_NONE == spec->mLen) ? LOG_ARG_STR : LOG_ARG_BAD;
+        break;
+      case 'p':
+        spec->mKind = LOG_ARG_PTR;
+        break;
+      default:
+        // "%n" and unknown conversions
+        spec->mKind = LOG_ARG_BAD;
+        break;
+    }
+    spec->mEnd = (0 != *pos) ? pos + 1 : pos;
+    return spec->mEnd;
+}
+
+static INT64 log_read_int(const RtLogSpec *spec, va_list *args) {
+    switch (spec->mLen) {
+      case LOG_LEN_HH: return (signed char)va_arg(*args, int);
+      case LOG_LEN_H:  return (short)va_arg(*args, int);
+      case LOG_LEN_L:  return va_arg(*args, long);
+      case LOG_LEN_LL: return va_arg(*args, long long);
+      case LOG_LEN_J:  return va_arg(*args, intmax_t);
+      case LOG_LEN_Z:  return (INT64)va_arg(*args, size_t);
+      case LOG_LEN_T:  return va_arg(*args, ptrdiff_t);
+      default:         return va_arg(*args, int);
+    }
+}
+
+static UINT64 log_read_uint(const RtLogSpec *spec, va_list *args) {
+    switch (spec->mLen) {
+      case LOG_LEN_HH: return (unsigned char)va_arg(*args, unsigned int);
+      case LOG_LEN_H:  return (unsigned short)va_arg(*args, unsigned int);
+      case LOG_LEN_L:  return va_arg(*args, unsigned long);
+      case LOG_LEN_LL: return va_arg(*args, unsigned long long);
+      case LOG_LEN_J:  return va_arg(*args, uintmax_t);
+      case LOG_LEN_Z:  return va_arg(*args, size_t);
+      case LOG_LEN_T:  return (UINT64)va_arg(*args, ptrdiff_t);
+      default:         return va_arg(*args, unsigned int);
+    }
+}
+
+static void log_pack_str(RtLogRecord *record, RtLogArg *arg, const char *str, INT32 precision) {
+    if (RT_NULL == str) {
+        arg->mInt = -1;
+        return;
+    }
+    INT32 room = LOG_ASYNC_DATA_LEN - record->mDataUsed - 1;
+    INT32 len  = 0;
+    while ((len < room) && ((precision < 0) || (len < precision)) && (0 != str[len])) {
+        len++;
+    }
+    arg->mInt = record->mDataUsed;
+    memcpy(record->mData + record->mDataUsed, str, len);
+    record->mData[record->mDataUsed + len] = 0;
+    record->mDataUsed += len + 1;
+}
+
+// arguments are taken by conversions of format, RT_FALSE if they can't
+static RT_BOOL log_pack_args(RtLogRecord *record, const char *fmt, va_list *args) {
+    RtLogSpec spec;
+    for (const char *pos = strchr(fmt, '%'); RT_NULL != pos; pos = strchr(pos, '%')) {
+        pos = log_parse_spec(pos, &spec);
+        if (LOG_ARG_NONE == spec.mKind) {
+            continue;
+        }
+        if ((LOG_ARG_BAD == spec.mKind) || (record->mArgCount + spec.mStars + 1 > LOG_ASYNC_MAX_ARGS)) {
+            return RT_FALSE;
+        }
+        INT32 precision = spec.mPrecision;
+        for (INT32 star = 0; star < spec.mStars; star++) {
+            precision = va_arg(*args, int);
+            record->mArgs[record->mArgCount++].mInt = precision;
+        }
+        precision = (-2 == spec.mPrecision) ? precision : spec.mPrecision;
+
+        RtLogArg *arg = &record->mArgs[record->mArgCount++];
+        switch (spec.mKind) {
+          case LOG_ARG_INT:   arg->mInt   = log_read_int(&spec, args);          break;
+          case LOG_ARG_UINT:  arg->mInt   = (INT64)log_read_uint(&spec, args);  break;
+          case LOG_ARG_CHAR:  arg->mInt   = va_arg(*args, int);                 break;
+          case LOG_ARG_PTR:   arg->mPtr   = va_arg(*args, void *);              break;
+          case LOG_ARG_FLOAT:
+            arg->mFloat = (LOG_LEN_LD == spec.mLen) ? (double)va_arg(*args, long double)
+                                                    : va_arg(*args, double);
+            break;
+          case LOG_ARG_STR:
+            log_pack_str(record, arg, va_arg(*args, const char *), precision);
+            break;
+          default:
+            return RT_FALSE;
+        }
+    }
+    return RT_TRUE;
+}
+
+RT_BOOL rt_log_async_push(UINT8 level, const char *tag, const char *fmt,
+                          const char *fname, UINT16 row, va_list args) {
+    if (0 == __atomic_load_n(&gLogAsync, __ATOMIC_RELAXED)) {
+        return RT_FALSE;
+    }
+    RtLogRing *ring = (RT_NULL != tLogRing) ? tLogRing : log_ring_acquire();
+    if (RT_NULL == ring) {
+        return RT_FALSE;
+    }
+
+    UINT32 head = ring->mHead;
+    if (head - __atomic_load_n(&ring->mTail, __ATOMIC_ACQUIRE) >= LOG_ASYNC_RECORDS) {
+        __atomic_fetch_add(&ring->mDrops, 1, __ATOMIC_RELAXED);
+        return RT_TRUE;
+    }
+
+    RtLogRecord *record = &ring->mRecords[head & (LOG_ASYNC_RECORDS - 1)];
+    record->mTag       = tag;
+    record->mFmt       = fmt;
+    record->mFunc      = fname;
+    record->mRow       = row;
+    record->mLevel     = level;
+    record->mTimeUs    = RtTime::getNowTimeUs();
+    record->mArgCount  = 0;
+    record->mDataUsed  = 0;
+    record->mFormatted = 0;
+
+    va_list packs;
+    va_copy(packs, args);
+    if (!log_pack_args(record, fmt, &packs)) {
+        vsnprintf(record->mData, LOG_ASYNC_DATA_LEN, fmt, args);
+        record->mFormatted = 1;
+    }
+    va_end(packs);
+
+    __atomic_store_n(&ring->mHead, head + 1, __ATOMIC_RELEASE);
+    return RT_TRUE;
+}
+
+template <typename T>
+static INT32 log_format_arg(char *out, INT32 size, const char *spec, const RtLogArg *stars,
+                            INT32 count, T value) {
+    switch (count) {
+      case 0:  return snprintf(out, size, spec, value);
+      case 1:  return snprintf(out, size, spec, (int)stars[0].mInt, value);
+      default: return snprintf(out, size, spec, (int)stars[0].mInt, (int)stars[1].mInt, value);
+    }
+}
+
+static INT32 log_append(char *line, INT32 used, const char *text, INT32 len) {
+    len = RT_MIN(len, LOG_ASYNC_LINE_LEN - 1 - used);
+    if (len > 0) {
+        memcpy(line + used, text, len);
+        used += len;
+    }
+    line[used] = 0;
+    return used;
+}
+
+static INT32 log_format_record(const RtLogRecord *record, char *line, INT32 used) {
+    if (record->mFormatted) {
+        return log_append(line, used, record->mData, strlen(record->mData));
+    }
+
+    RtLogSpec   spec;
+    INT32       index = 0;
+    const char *text  = record->mFmt;
+    for (const char *pos = strchr(text, '%'); RT_NULL != pos; pos = strchr(text, '%')) {
+        used = log_append(line, used, text, pos - text);
+        text = log_parse_spec(pos, &spec);
+        if (LOG_ARG_NONE == spec.mKind) {
+            used = log_append(line, used, "%", 1);
+            continue;
+        }
+
+        // length modifier is dropped, integers are printed as long long
+        char  conv[32];
+        INT32 len = RT_MIN((INT32)(spec.mLength - spec.mBegin), (INT32)sizeof(conv) - 4);
+        memcpy(conv, spec.mBegin, len);
+        if ((LOG_ARG_INT == spec.mKind) || (LOG_ARG_UINT == spec.mKind)) {
+            conv[len++] = 'l';
+            conv[len++] = 'l';
+        }
+        conv[len++] = spec.mEnd[-1];
+        conv[len]   = 0;
+
+        const RtLogArg *stars = &record->mArgs[index];
+        const RtLogArg *arg   = &record->mArgs[index + spec.mStars];
+        index += spec.mStars + 1;
+
+        char  buffer[LOG_ASYNC_LINE_LEN];
+        INT32 size = sizeof(buffer);
+        switch (spec.mKind) {
+          case LOG_ARG_INT:
+            len = log_format_arg(buffer, size, conv, stars, spec.mStars, (long long)arg->mInt);
+            break;
+          case LOG_ARG_UINT:
+            len = log_format_arg(buffer, size, conv, stars, spec.mStars, (unsigned long long)arg->mInt);
+            break;
+          case LOG_ARG_CHAR:
+            len = log_format_arg(buffer, size, conv, stars, spec.mStars, (int)arg->mInt);
+            break;
+          case LOG_ARG_FLOAT:
+            len = log_format_arg(buffer, size, conv, stars, spec.mStars, arg->mFloat);
+            break;
+          case LOG_ARG_PTR:
+            len = log_format_arg(buffer, size, conv, stars, spec.mStars, arg->mPtr);
+            break;
+          case LOG_ARG_STR:
+            len = log_format_arg(buffer, size, conv, stars, spec.mStars,
+                                 (arg->mInt < 0) ? "(null)" : record->mData + arg->mInt);
+            break;
+          default:
+            len = 0;
+            break;
+        }
+        used = log_append(line, used, buffer, RT_MIN(RT_MAX(len, 0), size - 1));
+    }
+    return log_append(line, used, text, strlen(text));
+}
+
+static void log_emit(rt_log_callback log_cb, const char *tag, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    log_cb(tag, fmt, args);
+    va_end(args);
+}
+
+// the same prefix as synchronous lines, time is taken by producer
+static void log_write_line(UINT8 level, const char *tag, UINT64 timeUs,
+                           const char *fname, UINT16 row, const char *text) {
+    UINT64 now  = timeUs / 1000;
+    int    hour = now / 1000 / 60 / 60 % 24;
+    int    min  = now / 1000 / 60 % 60;
+    int    sec  = now / 1000 % 60;
+    int    msec = now % 1000;
+    char   line[LOG_ASYNC_LINE_LEN];
+    snprintf(line, sizeof(line), "%02d:%02d:%02d-%03d {%-18.18s:%03d} %s\r\n",
+             hour, min, sec, msec, fname, row, text);
+    log_emit((RT_LOG_LEVEL_ERR == level) ? rt_os_err : rt_os_log, tag, "%s", line);
+}
+
+static void log_rate_report(RtLogRate *rate, UINT64 timeUs) {
+    if ((RT_NULL != rate->mFmt) && (rate->mSuppressed > 0)) {
+        char text[128];
+        snprintf(text, sizeof(text), "suppressed %u repeated lines of {%s:%d}",
+                 rate->mSuppressed, rate->mFunc, rate->mRow);
+        log_write_line(RT_LOG_LEVEL_ERR, "rt_log", timeUs, "rt_log", 0, text);
+    }
+    rate->mSuppressed = 0;
+}
+
+// lines of the same format more than burst in a window are suppressed
+static RT_BOOL log_rate_accept(const RtLogRecord *record) {
+    RtLogRate *rate = &gLogRates[((uintptr_t)record->mFmt >> 3) % LOG_ASYNC_RATE_SLOTS];
+    if ((rate->mFmt != record->mFmt) || (record->mTimeUs - rate->mWindowUs >= LOG_ASYNC_RATE_WINDOW)) {
+        log_rate_report(rate, record->mTimeUs);
+        rate->mFmt      = record->mFmt;
+        rate->mFunc     = record->mFunc;
+        rate->mRow      = record->mRow;
+        rate->mWindowUs = record->mTimeUs;
+        rate->mCount    = 0;
+    }
+    if (++rate->mCount > LOG_ASYNC_RATE_BURST) {
+        rate->mSuppressed++;
+        return RT_FALSE;
+    }
+    return RT_TRUE;
+}
+
+static void log_write_record(const RtLogRecord *record) {
+    if (!log_rate_accept(record)) {
+        return;
+    }
+    char text[LOG_ASYNC_LINE_LEN];
+    text[0] = 0;
+    log_format_record(record, text, 0);
+    log_write_line(record->mLevel, record->mTag, record->mTimeUs, record->mFunc, record->mRow, text);
+}
+
+// drops of all rings since the last report, in one line
+static void log_report_drops() {
+    UINT64 drops = 0;
+    for (INT32 idx = 0; idx < LOG_ASYNC_MAX_RINGS; idx++) {
+        RtLogRing *ring = __atomic_load_n(&gLogRings[idx], __ATOMIC_ACQUIRE);
+        if (RT_NULL != ring) {
+            UINT64 count = __atomic_load_n(&ring->mDrops, __ATOMIC_RELAXED);
+            drops += count - ring->mDropsReported;
+            ring->mDropsReported = count;
+        }
+    }
+    if (drops > 0) {
+        char text[128];
+        snprintf(text, sizeof(text), "dropped %llu lines, rings of threads are full", (unsigned long long)drops);
+        log_write_line(RT_LOG_LEVEL_ERR, "rt_log", RtTime::getNowTimeUs(), "rt_log", 0, text);
+    }
+}
+
+// records of all rings are written in order of time, returns count of them
+static INT32 log_async_drain() {
+    INT32 count = 0;
+    while (RT_TRUE) {
+        RtLogRing   *first  = RT_NULL;
+        RtLogRecord *record = RT_NULL;
+        for (INT32 idx = 0; idx < LOG_ASYNC_MAX_RINGS; idx++) {
+            RtLogRing *ring = __atomic_load_n(&gLogRings[idx], __ATOMIC_ACQUIRE);
+            if ((RT_NULL == ring) || (ring->mTail == __atomic_load_n(&ring->mHead, __ATOMIC_ACQUIRE))) {
+                continue;
+            }
+            RtLogRecord *next = &ring->mRecords[ring->mTail & (LOG_ASYNC_RECORDS - 1)];
+            if ((RT_NULL == record) || (next->mTimeUs < record->mTimeUs)) {
+                first  = ring;
+                record = next;
+            }
+        }
+        if (RT_NULL == record) {
+            break;
+        }
+        log_write_record(record);
+        __atomic_store_n(&first->mTail, first->mTail + 1, __ATOMIC_RELEASE);
+        count++;
+    }
+    log_report_drops();
+    return count;
+}
+
+static void* log_async_loop(void *arg) {
+    (void)arg;
+    while (0 != __atomic_load_n(&gLogRunning, __ATOMIC_ACQUIRE)) {
+        if (0 == log_async_drain()) {
+            RtTime::sleepMs(LOG_ASYNC_IDLE_MS);
+        }
+    }
+    log_async_drain();
+    for (INT32 idx = 0; idx < LOG_ASYNC_RATE_SLOTS; idx++) {
+        log_rate_report(&gLogRates[idx], RtTime::getNowTimeUs());
+        gLogRates[idx].mFmt = RT_NULL;
+    }
+    return RT_NULL;
+}
+
+void rt_set_log_async(RT_BOOL async) {
+    RtAutoMutex autolock(log_async_lock());
+    if (async && (RT_NULL == gLogThread)) {
+        __atomic_store_n(&gLogRunning, 1, __ATOMIC_RELEASE);
+        gLogThread = new RtThread(log_async_loop, RT_NULL);
+        gLogThread->setName("rt_log");
+        if (!gLogThread->start()) {
+            __atomic_store_n(&gLogRunning, 0, __ATOMIC_RELEASE);
+            rt_safe_delete(gLogThread);
+            return;
+        }
+        __atomic_store_n(&gLogAsync, 1, __ATOMIC_RELEASE);
+    } else if (!async && (RT_NULL != gLogThread)) {
+        // lines are written by callers at once, then the rest are drained
+        __atomic_store_n(&gLogAsync, 0, __ATOMIC_RELEASE);
+        __atomic_store_n(&gLogRunning, 0, __ATOMIC_RELEASE);
+        gLogThread->join();
+        rt_safe_delete(gLogThread);
+    }
+}
+
+RT_RET rt_log_flush() {
+    if (0 == __atomic_load_n(&gLogAsync, __ATOMIC_ACQUIRE)) {
+        return RT_OK;
+    }
+    for (INT32 wait = 0; wait < LOG_ASYNC_FLUSH_MS; wait++) {
+        RT_BOOL empty = RT_TRUE;
+        for (INT32 idx = 0; (idx < LOG_ASYNC_MAX_RINGS) && empty; idx++) {
+            RtLogRing *ring = __atomic_load_n(&gLogRings[idx], __ATOMIC_ACQUIRE);
+            empty = (RT_NULL == ring) || (__atomic_load_n(&ring->mTail, __ATOMIC_ACQUIRE)
+                                           == __atomic_load_n(&ring->mHead, __ATOMIC_ACQUIRE));
+        }
+        if (empty) {
+            return RT_OK;
+        }
+        RtTime::sleepMs(1);
+    }
+    return RT_ERR_TIMEOUT;
+}
+
+UINT64 rt_log_dropped() {
+    UINT64 drops = 0;
+    for (INT32 idx = 0; idx < LOG_ASYNC_MAX_RINGS; idx++) {
+        RtLogRing *ring = __atomic_load_n(&gLogRings[idx], __ATOMIC_ACQUIRE);
+        if (RT_NULL != ring) {
+            drops += __atomic_load_n(&ring->mDrops, __ATOMIC_RELAXED);
+        }
+    }
+    return drops;
+}
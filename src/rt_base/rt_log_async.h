@@ -0,0 +1,33 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_RT_BASE_RT_LOG_ASYNC_H_
+#define SRC_RT_BASE_RT_LOG_ASYNC_H_
+
+#include <stdarg.h>
+#include "rt_header.h" // NOLINT
+
+#define RT_LOG_LEVEL_LOG    0
+#define RT_LOG_LEVEL_ERR    1
+
+/*
+ * packs line into ring of calling thread, returns RT_FALSE if async mode
+ * is off, then the line is written by caller.
+ */
+RT_BOOL rt_log_async_push(UINT8 level, const char *tag, const char *fmt,
+                          const char *fname, UINT16 row, va_list args);
+
+#endif  // SRC_RT_BASE_RT_LOG_ASYNC_H_
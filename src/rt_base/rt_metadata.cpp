@@ -74,7 +74,7 @@ struct RtMetaData::typed_data {
 RtMetaData::RtMetaData() {
     mLock = new RtMutex();
     RT_ASSERT(RT_NULL != mLock);
-    mHashTable = rt_hash_table_create(20, hash_ptr_func, hash_ptr_compare);
+    mHashTable = rt_hash_table_create_open(16, hash_ptr_mix_func, hash_ptr_compare);
 }
 
 RtMetaData::~RtMetaData() {
@@ -114,7 +114,8 @@ RT_BOOL RtMetaData::remove(UINT32 key) {
     item = reinterpret_cast<typed_data *>(data);
     item->clear();
     rt_free(item);
-    return rt_hash_table_remove(mHashTable, reinterpret_cast<void*>(key), RT_TRUE);
+    // item is freed above, so table doesn't free it again
+    return rt_hash_table_remove(mHashTable, reinterpret_cast<void*>(key), RT_FALSE);
 }
 
 RT_BOOL RtMetaData::setCString(UINT32 key, const char *value) {
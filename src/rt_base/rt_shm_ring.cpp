@@ -0,0 +1,333 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: ring of frames in shared memory, and futex wakeups of readers
+ */
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "rt_shm_ring"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "rt_shm_ring.h"      // NOLINT
+#include "rt_log.h"           // NOLINT
+#include "rt_mem.h"           // NOLINT
+#include "rt_time.h"          // NOLINT
+#include "rt_string_utils.h"  // NOLINT
+
+#define SHM_RING_MAGIC          MKTAG('r', 's', 'h', 'm')
+#define SHM_RING_DIR            "/dev/shm/"
+#define SHM_RING_ALIGN          64
+
+/*
+ * header is at the start of shared memory, descriptors and slots of data
+ * follow it. mHead is written by the writer only, readers keep cursors of
+ * their own, so that readers never change the ring.
+ */
+typedef struct _RtShmRingHeader {
+    volatile UINT32 mMagic;         // written last, ring is ready with it
+    UINT32          mVersion;
+    UINT32          mSlots;
+    UINT32          mSlotBytes;
+    UINT64          mDataOffset;
+    volatile UINT64 mHead;          // frames written
+    volatile UINT32 mFutex;         // bumped by each write and close
+    volatile UINT32 mWaiters;       // readers in futex wait
+    volatile UINT32 mClosed;
+} RtShmRingHeader;
+
+/*
+ * mSeq of frame n is 2n+1 while it is written, and 2n+2 when it is ready.
+ * a reader copies the frame between two loads of mSeq, and drops the copy
+ * when they differ, it is how the oldest frames are overwritten in place.
+ */
+typedef struct _RtShmRingDesc {
+    volatile UINT64 mSeq;
+    UINT32          mSize;
+    UINT32          mFlags;
+    INT64           mPts;
+    INT64           mWriteUs;
+    RtShmFormat     mFormat;
+} RtShmRingDesc;
+
+struct RtShmRing {
+    INT32             mFd;
+    size_t            mBytes;
+    RtShmRingHeader  *mHeader;
+    RtShmRingDesc    *mDescs;
+    UINT8            *mData;
+    RT_BOOL           mWriter;
+    UINT64            mCursor;
+    UINT64            mDropped;
+    RtShmFormat       mFormat;      // of last frame, writer only
+    char              mPath[RT_SHM_RING_NAME_LEN + sizeof(SHM_RING_DIR)];
+};
+
+static INT32 shm_ring_futex(volatile UINT32 *addr, INT32 op, UINT32 value, const struct timespec *ts) {
+    // not private, waiters are in other processes
+    return (INT32)syscall(SYS_futex, addr, op, value, ts, RT_NULL, 0);
+}
+
+static UINT32 shm_ring_pow2(UINT32 value) {
+    UINT32 pow2 = 1;
+    while (pow2 < value) {
+        pow2 <<= 1;
+    }
+    return pow2;
+}
+
+static size_t shm_ring_bytes(UINT32 slots, UINT32 slotBytes, UINT64 *dataOffset) {
+    size_t offset = RT_ALIGN(sizeof(RtShmRingHeader) + sizeof(RtShmRingDesc) * slots, SHM_RING_ALIGN);
+    *dataOffset = offset;
+    return offset + (size_t)slots * slotBytes;
+}
+
+static struct RtShmRing* shm_ring_map(const char *name, INT32 flags) {
+    if ((RT_NULL == name) || (RT_NULL != strchr(name, '/')) || (strlen(name) >= RT_SHM_RING_NAME_LEN)) {
+        RT_LOGE("invalid name of ring: %s", (RT_NULL == name) ? "null" : name);
+        return RT_NULL;
+    }
+    struct RtShmRing *ring = rt_malloc(struct RtShmRing);
+    rt_memset(ring, 0, sizeof(struct RtShmRing));
+    rt_str_snprintf(ring->mPath, sizeof(ring->mPath), "%s%s", SHM_RING_DIR, name);
+
+    // open of /dev/shm is what shm_open does, and it needs no librt
+    ring->mFd = open(ring->mPath, flags | O_CLOEXEC, 0666);
+    if (ring->mFd < 0) {
+        rt_free(ring);
+        return RT_NULL;
+    }
+    return ring;
+}
+
+// futex words are written by readers too, so all mappings are writable
+static RT_RET shm_ring_attach(struct RtShmRing *ring, size_t bytes) {
+    void *base = mmap(RT_NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, ring->mFd, 0);
+    if (MAP_FAILED == base) {
+        return RT_ERR_NOMEM;
+    }
+    ring->mBytes  = bytes;
+    ring->mHeader = reinterpret_cast<RtShmRingHeader *>(base);
+    ring->mDescs  = reinterpret_cast<RtShmRingDesc *>(ring->mHeader + 1);
+    ring->mData   = reinterpret_cast<UINT8 *>(base) + ring->mHeader->mDataOffset;
+    return RT_OK;
+}
+
+struct RtShmRing* rt_shm_ring_create(const char *name, UINT32 slots, UINT32 slotBytes) {
+    if ((0 == slots) || (0 == slotBytes)) {
+        return RT_NULL;
+    }
+    // ring of last writer which is killed is left, it is replaced
+    char path[RT_SHM_RING_NAME_LEN + sizeof(SHM_RING_DIR)];
+    rt_str_snprintf(path, sizeof(path), "%s%s", SHM_RING_DIR, (RT_NULL == name) ? "" : name);
+    unlink(path);
+
+    struct RtShmRing *ring = shm_ring_map(name, O_RDWR | O_CREAT | O_EXCL);
+    if (RT_NULL == ring) {
+        RT_LOGE("fail to create ring %s, errno %d", path, errno);
+        return RT_NULL;
+    }
+    ring->mWriter = RT_TRUE;
+
+    UINT64 dataOffset = 0;
+    slots     = shm_ring_pow2(slots);
+    slotBytes = RT_ALIGN(slotBytes, SHM_RING_ALIGN);
+    size_t bytes = shm_ring_bytes(slots, slotBytes, &dataOffset);
+    if (0 != ftruncate(ring->mFd, bytes)) {
+        RT_LOGE("fail to resize ring %s to %zu bytes", ring->mPath, bytes);
+        rt_shm_ring_close(&ring);
+        return RT_NULL;
+    }
+
+    // pages of new file are zero, so all descriptors are empty
+    RtShmRingHeader header;
+    rt_memset(&header, 0, sizeof(header));
+    header.mVersion    = RT_SHM_RING_VERSION;
+    header.mSlots      = slots;
+    header.mSlotBytes  = slotBytes;
+    header.mDataOffset = dataOffset;
+    if (sizeof(header) != pwrite(ring->mFd, &header, sizeof(header), 0)
+         || (RT_OK != shm_ring_attach(ring, bytes))) {
+        rt_shm_ring_close(&ring);
+        return RT_NULL;
+    }
+    __atomic_store_n(&ring->mHeader->mMagic, SHM_RING_MAGIC, __ATOMIC_RELEASE);
+    RT_LOGD("ring %s: %d slots of %d bytes", name, slots, slotBytes);
+    return ring;
+}
+
+RT_RET rt_shm_ring_write(struct RtShmRing *ring, const void *data, UINT32 size,
+                         const RtShmFrame *frame) {
+    if ((RT_NULL == ring) || !ring->mWriter) {
+        return RT_ERR_NULL_PTR;
+    }
+    RtShmRingHeader *header = ring->mHeader;
+    if (size > header->mSlotBytes) {
+        return RT_ERR_OUTOF_RANGE;
+    }
+
+    UINT64         seq  = header->mHead;
+    UINT32         slot = (UINT32)(seq & (header->mSlots - 1));
+    RtShmRingDesc *desc = &ring->mDescs[slot];
+    __atomic_store_n(&desc->mSeq, 2 * seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    if (size > 0) {
+        memcpy(ring->mData + (size_t)slot * header->mSlotBytes, data, size);
+    }
+    desc->mSize  = size;
+    desc->mFlags = (RT_NULL != frame) ? frame->mFlags : 0;
+    desc->mPts   = (RT_NULL != frame) ? frame->mPts : 0;
+    desc->mWriteUs = RtTime::getNowTimeUs();
+    if (RT_NULL != frame) {
+        if (0 != memcmp(&ring->mFormat, &frame->mFormat, sizeof(RtShmFormat))) {
+            desc->mFlags  |= RT_SHM_FRAME_FLAG_FORMAT;
+            ring->mFormat  = frame->mFormat;
+        }
+        desc->mFormat = frame->mFormat;
+    }
+    __atomic_store_n(&desc->mSeq, 2 * seq + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&header->mHead, seq + 1, __ATOMIC_RELEASE);
+
+    __atomic_fetch_add(&header->mFutex, 1, __ATOMIC_RELEASE);
+    if (__atomic_load_n(&header->mWaiters, __ATOMIC_ACQUIRE) > 0) {
+        shm_ring_futex(&header->mFutex, FUTEX_WAKE, INT_MAX, RT_NULL);
+    }
+    return RT_OK;
+}
+
+struct RtShmRing* rt_shm_ring_open(const char *name) {
+    struct RtShmRing *ring = shm_ring_map(name, O_RDWR);
+    if (RT_NULL == ring) {
+        return RT_NULL;
+    }
+
+    RtShmRingHeader header;
+    rt_memset(&header, 0, sizeof(header));
+    UINT64 dataOffset = 0;
+    struct stat st;
+    if ((sizeof(header) != pread(ring->mFd, &header, sizeof(header), 0))
+         || (RT_SHM_RING_VERSION != header.mVersion) || (0 == header.mSlots)
+         || (0 != fstat(ring->mFd, &st))
+         || ((size_t)st.st_size < shm_ring_bytes(header.mSlots, header.mSlotBytes, &dataOffset))) {
+        RT_LOGE("ring %s is not ready", ring->mPath);
+        rt_shm_ring_close(&ring);
+        return RT_NULL;
+    }
+
+    if ((RT_OK != shm_ring_attach(ring, st.st_size)) || (SHM_RING_MAGIC != __atomic_load_n(&ring->mHeader->mMagic, __ATOMIC_ACQUIRE))) {
+        rt_shm_ring_close(&ring);
+        return RT_NULL;
+    }
+    UINT64 head = __atomic_load_n(&ring->mHeader->mHead, __ATOMIC_ACQUIRE);
+    ring->mCursor = (head > ring->mHeader->mSlots) ? head - ring->mHeader->mSlots : 0;
+    return ring;
+}
+
+RT_RET rt_shm_ring_read(struct RtShmRing *ring, void *data, UINT32 capacity,
+                        RtShmFrame *frame, INT64 timeoutUs) {
+    if ((RT_NULL == ring) || ring->mWriter || (RT_NULL == frame)) {
+        return RT_ERR_NULL_PTR;
+    }
+    RtShmRingHeader *header   = ring->mHeader;
+    INT64            deadline = RtTime::getNowTimeUs() + RT_MAX(timeoutUs, 0ll);
+    while (1) {
+        UINT32 futex = __atomic_load_n(&header->mFutex, __ATOMIC_ACQUIRE);
+        UINT64 head  = __atomic_load_n(&header->mHead, __ATOMIC_ACQUIRE);
+        if (ring->mCursor + header->mSlots < head) {
+            ring->mDropped += head - header->mSlots - ring->mCursor;
+            ring->mCursor   = head - header->mSlots;
+        }
+
+        if (ring->mCursor < head) {
+            UINT64         seq  = ring->mCursor++;
+            UINT32         slot = (UINT32)(seq & (header->mSlots - 1));
+            RtShmRingDesc *desc = &ring->mDescs[slot];
+            UINT64         mark = __atomic_load_n(&desc->mSeq, __ATOMIC_ACQUIRE);
+            if (mark != 2 * seq + 2) {
+                ring->mDropped++;
+                continue;
+            }
+            frame->mSeq     = seq;
+            frame->mSize    = desc->mSize;
+            frame->mFlags   = desc->mFlags;
+            frame->mPts     = desc->mPts;
+            frame->mWriteUs = desc->mWriteUs;
+            frame->mFormat  = desc->mFormat;
+            if ((RT_NULL != data) && (frame->mSize <= header->mSlotBytes)) {
+                memcpy(data, ring->mData + (size_t)slot * header->mSlotBytes,
+                       RT_MIN(frame->mSize, capacity));
+            }
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (mark != __atomic_load_n(&desc->mSeq, __ATOMIC_RELAXED)) {
+                // overwritten while it is copied
+                ring->mDropped++;
+                continue;
+            }
+            return RT_OK;
+        }
+
+        if (__atomic_load_n(&header->mClosed, __ATOMIC_ACQUIRE)) {
+            return RT_ERR_END_OF_STREAM;
+        }
+        INT64 waitUs = deadline - (INT64)RtTime::getNowTimeUs();
+        if (waitUs <= 0) {
+            return RT_ERR_TIMEOUT;
+        }
+        struct timespec ts;
+        ts.tv_sec  = waitUs / 1000000;
+        ts.tv_nsec = (waitUs % 1000000) * 1000;
+        __atomic_fetch_add(&header->mWaiters, 1, __ATOMIC_ACQ_REL);
+        shm_ring_futex(&header->mFutex, FUTEX_WAIT, futex, &ts);
+        __atomic_fetch_sub(&header->mWaiters, 1, __ATOMIC_ACQ_REL);
+    }
+    return RT_OK;
+}
+
+UINT64 rt_shm_ring_dropped(struct RtShmRing *ring) {
+    return (RT_NULL != ring) ? ring->mDropped : 0;
+}
+
+void rt_shm_ring_close(struct RtShmRing **ring) {
+    if ((RT_NULL == ring) || (RT_NULL == *ring)) {
+        return;
+    }
+    struct RtShmRing *self = *ring;
+    if (RT_NULL != self->mHeader) {
+        if (self->mWriter) {
+            __atomic_store_n(&self->mHeader->mClosed, 1, __ATOMIC_RELEASE);
+            __atomic_fetch_add(&self->mHeader->mFutex, 1, __ATOMIC_RELEASE);
+            shm_ring_futex(&self->mHeader->mFutex, FUTEX_WAKE, INT_MAX, RT_NULL);
+        }
+        munmap(self->mHeader, self->mBytes);
+    }
+    if (self->mWriter) {
+        // readers keep their mappings, new readers can't open it
+        unlink(self->mPath);
+    }
+    close(self->mFd);
+    rt_safe_free(*ring);
+}
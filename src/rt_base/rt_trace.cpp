@@ -0,0 +1,255 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: rings of tracing and chrome trace-event json
+ */
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "rt_trace"
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef HAS_PTHREAD
+#include <pthread.h>
+#endif
+
+#include "rt_trace.h"         // NOLINT
+#include "rt_log.h"           // NOLINT
+#include "rt_thread.h"        // NOLINT
+#include "rt_time.h"          // NOLINT
+#include "rt_string_utils.h"  // NOLINT
+
+#define TRACE_NAME_LEN          16
+
+/*
+ * mSeq is the index+1 of event in the ring, it is zero while the owner is
+ * writing the event, so that the dumper skips events which are torn.
+ */
+typedef struct _RtTraceEvent {
+    volatile UINT32  mSeq;
+    char             mPhase;
+    const char      *mCategory;
+    const char      *mName;
+    INT64            mTimeUs;
+    INT64            mValue;
+} RtTraceEvent;
+
+/*
+ * ring is written by its owner thread only, and is given to another thread
+ * after the owner exits. mHead goes on, events before mFirst are dropped.
+ */
+typedef struct _RtTraceRing {
+    volatile UINT32  mHead;
+    volatile UINT32  mFirst;
+    volatile INT32   mUsed;
+    volatile INT32   mTid;
+    char             mName[TRACE_NAME_LEN];
+    RtTraceEvent     mEvents[RT_TRACE_RING_EVENTS];
+} RtTraceRing;
+
+static RtTraceRing   *gTraceRings[RT_TRACE_MAX_THREADS];
+static volatile INT32 gTraceEnabled = 0;
+static __thread RtTraceRing *tTraceRing = RT_NULL;
+
+#ifdef HAS_PTHREAD
+static pthread_key_t  gTraceKey;
+static pthread_once_t gTraceOnce = PTHREAD_ONCE_INIT;
+
+// ring is free to other threads when owner exits
+static void trace_ring_release(void *ring) {
+    __atomic_store_n(&(static_cast<RtTraceRing *>(ring)->mUsed), 0, __ATOMIC_RELEASE);
+}
+
+static void trace_key_create() {
+    pthread_key_create(&gTraceKey, trace_ring_release);
+}
+#endif
+
+static void trace_ring_own(RtTraceRing *ring) {
+    ring->mFirst   = __atomic_load_n(&ring->mHead, __ATOMIC_RELAXED);
+    ring->mName[0] = 0;
+    __atomic_store_n(&ring->mTid, RtThread::getThreadID(), __ATOMIC_RELEASE);
+#ifdef HAS_PTHREAD
+    pthread_once(&gTraceOnce, trace_key_create);
+    pthread_setspecific(gTraceKey, ring);
+#endif
+    tTraceRing = ring;
+}
+
+/*
+ * new slots are taken before rings of exited threads are reused,
+ * so that events of short threads are kept as long as possible.
+ */
+static RtTraceRing *trace_ring_acquire() {
+    for (INT32 idx = 0; idx < RT_TRACE_MAX_THREADS; idx++) {
+        if (RT_NULL != __atomic_load_n(&gTraceRings[idx], __ATOMIC_ACQUIRE)) {
+            continue;
+        }
+        RtTraceRing *ring = static_cast<RtTraceRing *>(calloc(1, sizeof(RtTraceRing)));
+        if (RT_NULL == ring) {
+            return RT_NULL;
+        }
+        ring->mUsed = 1;
+        RtTraceRing *expected = RT_NULL;
+        if (__atomic_compare_exchange_n(&gTraceRings[idx], &expected, ring, RT_FALSE,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            trace_ring_own(ring);
+            return ring;
+        }
+        free(ring);
+    }
+
+    for (INT32 idx = 0; idx < RT_TRACE_MAX_THREADS; idx++) {
+        RtTraceRing *ring   = __atomic_load_n(&gTraceRings[idx], __ATOMIC_ACQUIRE);
+        INT32       expected = 0;
+        if ((RT_NULL != ring) && __atomic_compare_exchange_n(&ring->mUsed, &expected, 1, RT_FALSE,
+                                                             __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            trace_ring_own(ring);
+            return ring;
+        }
+    }
+    return RT_NULL;
+}
+
+static inline RtTraceRing *trace_ring_self() {
+    return (RT_NULL != tTraceRing) ? tTraceRing : trace_ring_acquire();
+}
+
+void rt_trace_enable(RT_BOOL enable) {
+    __atomic_store_n(&gTraceEnabled, enable ? 1 : 0, __ATOMIC_RELAXED);
+}
+
+RT_BOOL rt_trace_enabled() {
+    return (0 != __atomic_load_n(&gTraceEnabled, __ATOMIC_RELAXED)) ? RT_TRUE : RT_FALSE;
+}
+
+void rt_trace_event(char phase, const char *category, const char *name, INT64 value) {
+    if (0 == __atomic_load_n(&gTraceEnabled, __ATOMIC_RELAXED)) {
+        return;
+    }
+    RtTraceRing *ring = trace_ring_self();
+    if (RT_NULL == ring) {
+        return;
+    }
+
+    UINT32        head  = ring->mHead;
+    RtTraceEvent *event = &ring->mEvents[head & (RT_TRACE_RING_EVENTS - 1)];
+    __atomic_store_n(&event->mSeq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    event->mPhase    = phase;
+    event->mCategory = category;
+    event->mName     = name;
+    event->mTimeUs   = (INT64)RtTime::getNowTimeUs();
+    event->mValue    = value;
+    __atomic_store_n(&event->mSeq, head + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->mHead, head + 1, __ATOMIC_RELEASE);
+}
+
+void rt_trace_thread_name(const char *name) {
+    RtTraceRing *ring = trace_ring_self();
+    if ((RT_NULL != ring) && (RT_NULL != name)) {
+        rt_str_snprintf(ring->mName, TRACE_NAME_LEN, "%s", name);
+    }
+}
+
+void rt_trace_reset() {
+    for (INT32 idx = 0; idx < RT_TRACE_MAX_THREADS; idx++) {
+        RtTraceRing *ring = __atomic_load_n(&gTraceRings[idx], __ATOMIC_ACQUIRE);
+        if (RT_NULL != ring) {
+            __atomic_store_n(&ring->mFirst, __atomic_load_n(&ring->mHead, __ATOMIC_ACQUIRE), __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static const char *trace_json_string(const char *str) {
+    return (RT_NULL != str) ? str : "";
+}
+
+static INT32 trace_dump_ring(FILE *fp, RtTraceRing *ring, INT32 count) {
+    INT32  tid   = __atomic_load_n(&ring->mTid, __ATOMIC_ACQUIRE);
+    UINT32 head  = __atomic_load_n(&ring->mHead, __ATOMIC_ACQUIRE);
+    UINT32 first = __atomic_load_n(&ring->mFirst, __ATOMIC_RELAXED);
+    if (head - first > RT_TRACE_RING_EVENTS) {
+        first = head - RT_TRACE_RING_EVENTS;
+    }
+    if (head == first) {
+        return count;
+    }
+
+    if (0 != ring->mName[0]) {
+        fprintf(fp, "%s\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                (count > 0) ? "," : "", tid, ring->mName);
+        count++;
+    }
+
+    for (UINT32 idx = first; idx != head; idx++) {
+        RtTraceEvent *event = &ring->mEvents[idx & (RT_TRACE_RING_EVENTS - 1)];
+        RtTraceEvent  copy;
+        UINT32 seq = __atomic_load_n(&event->mSeq, __ATOMIC_ACQUIRE);
+        copy.mPhase    = event->mPhase;
+        copy.mCategory = event->mCategory;
+        copy.mName     = event->mName;
+        copy.mTimeUs   = event->mTimeUs;
+        copy.mValue    = event->mValue;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if ((seq != idx + 1) || (seq != __atomic_load_n(&event->mSeq, __ATOMIC_RELAXED))) {
+            continue;
+        }
+
+        fprintf(fp, "%s\n{\"ph\":\"%c\",\"cat\":\"%s\",\"name\":\"%s\",\"ts\":%lld,\"pid\":1,\"tid\":%d",
+                (count > 0) ? "," : "", copy.mPhase, trace_json_string(copy.mCategory),
+                trace_json_string(copy.mName), (long long)copy.mTimeUs, tid);
+        switch (copy.mPhase) {
+          case RT_TRACE_PHASE_INSTANT:
+            fprintf(fp, ",\"s\":\"t\",\"args\":{\"value\":%lld}}", (long long)copy.mValue);
+            break;
+          case RT_TRACE_PHASE_COUNTER:
+            fprintf(fp, ",\"args\":{\"value\":%lld}}", (long long)copy.mValue);
+            break;
+          default:
+            fprintf(fp, "}");
+            break;
+        }
+        count++;
+    }
+    return count;
+}
+
+RT_RET rt_trace_dump(const char *path) {
+    if (RT_NULL == path) {
+        return RT_ERR_NULL_PTR;
+    }
+    FILE *fp = fopen(path, "w");
+    if (RT_NULL == fp) {
+        RT_LOGE("fail to open trace file(%s)", path);
+        return RT_ERR_BAD;
+    }
+
+    INT32 count = 0;
+    fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (INT32 idx = 0; idx < RT_TRACE_MAX_THREADS; idx++) {
+        RtTraceRing *ring = __atomic_load_n(&gTraceRings[idx], __ATOMIC_ACQUIRE);
+        if (RT_NULL != ring) {
+            count = trace_dump_ring(fp, ring, count);
+        }
+    }
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+
+    RT_LOGD("done, dump %d trace events to %s", count, path);
+    return RT_OK;
+}
@@ -31,5 +31,22 @@ UINT32 rt_cpu_count(void) {
     return count;
 }
 
+UINT32 rt_cpu_features(void) {
+    UINT32 features = 0;
+    if (IsProcessorFeaturePresent(PF_XMMI64_INSTRUCTIONS_AVAILABLE)) {
+        features |= RT_CPU_FEATURE_SSE2;
+    }
+    return features;
+}
+
+// clusters are not told apart on windows
+UINT64 rt_cpu_mask_big(void) {
+    return 0;
+}
+
+UINT64 rt_cpu_mask_little(void) {
+    return 0;
+}
+
 #endif  // OS_WINDOWS
 
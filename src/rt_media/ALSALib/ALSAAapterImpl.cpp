@@ -249,6 +249,28 @@ int alsa_snd_write_data(ALSASinkContext *ctx, void *data, int bytes) {
     return sent;
 }
 
+INT64 alsa_snd_wait_us(ALSASinkContext *ctx, int bytes) {
+    snd_pcm_uframes_t bufferSize = 0;
+    snd_pcm_uframes_t periodSize = 0;
+    unsigned int      rate       = 0;
+    if ((RT_NULL == ctx) || (RT_NULL == ctx->theInstance)) {
+        return 0;
+    }
+    snd_pcm_sframes_t avail = snd_pcm_avail_update(ctx->theInstance);
+    if ((avail < 0) || (snd_pcm_get_params(ctx->theInstance, &bufferSize, &periodSize) < 0)) {
+        // xrun is recovered by writing
+        return 0;
+    }
+    // data larger than buffer is written when buffer is empty
+    snd_pcm_sframes_t frames = snd_pcm_bytes_to_frames(ctx->theInstance, bytes);
+    frames = RT_MIN(frames, (snd_pcm_sframes_t)bufferSize);
+    if (avail >= frames) {
+        return 0;
+    }
+    rate = ctx->mAlsaParamsCtx->sampleRate;
+    return (rate > 0) ? (INT64)(frames - avail) * 1000000 / rate : 0;
+}
+
 ALSASinkContext* alsa_snd_create(const char *name) {
     AlsaParamsContext *params_ctx = RT_NULL;
     ALSASinkContext *ctx = rt_malloc(ALSASinkContext);
@@ -55,6 +55,9 @@ RT_RET alsa_set_snd_sw_params(ALSASinkContext *ctx);
 
 int alsa_snd_write_data(ALSASinkContext *ctx, void *data, int bytes);
 
+// time to wait before bytes can be written without block, 0 for now
+INT64 alsa_snd_wait_us(ALSASinkContext *ctx, int bytes);
+
 ALSASinkContext* alsa_snd_create(const char *name);
 
 RT_VOID alsa_snd_destroy(ALSASinkContext *ctx);
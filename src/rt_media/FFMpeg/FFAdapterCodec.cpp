@@ -46,9 +46,11 @@ FACodecContext* fa_video_decode_create(RtMetaData *meta) {
     INT32 err = 0;
     AVCodecContext *codec_ctx = NULL;
     FACodecContext *ctx = rt_malloc(FACodecContext);
+    rt_memset(ctx, 0, sizeof(FACodecContext));
     ctx->mTrackType     = RTTRACK_TYPE_VIDEO;
     ctx->mAvCodecCtx    = avcodec_alloc_context3(NULL);
     ctx->mFrame         = RT_NULL;
+    ctx->mPrerollUs     = -1;
     CHECK_IS_NULL(ctx->mAvCodecCtx);
     codec_ctx = ctx->mAvCodecCtx;
 
@@ -77,8 +79,11 @@ FACodecContext* fa_video_decode_create(RtMetaData *meta) {
     codec_ctx->width  = width;
     codec_ctx->height = height;
     if (extra_data != RT_NULL && extra_size != 0) {
+        // extradata is freed with codec context, it mustn't be the one of stream
+        codec_ctx->extradata = reinterpret_cast<UINT8 *>(av_mallocz(extra_size + AV_INPUT_BUFFER_PADDING_SIZE));
+        CHECK_IS_NULL(codec_ctx->extradata);
+        rt_memcpy(codec_ctx->extradata, extra_data, extra_size);
         codec_ctx->extradata_size = extra_size;
-        codec_ctx->extradata = reinterpret_cast<UINT8 *>(extra_data);
     }
 
     // find decoder again as codec_id may have changed
@@ -88,6 +93,12 @@ FACodecContext* fa_video_decode_create(RtMetaData *meta) {
         goto __FAILED;
     }
 
+    // reduced resolution decoding, not all decoders support it
+    INT32 lowres;
+    if (meta->findInt32(kKeyVCodecLowres, &lowres) && (lowres > 0)) {
+        codec_ctx->lowres = RT_MIN(lowres, codec_ctx->codec->max_lowres);
+    }
+
     RT_LOGD("Try to create decoder(%s)", avcodec_get_name(codec_ctx->codec_id));
     err = avcodec_open2(codec_ctx, codec_ctx->codec, NULL);
     if (err < 0) {
@@ -119,6 +130,7 @@ FACodecContext* fa_audio_decode_create(RtMetaData *meta) {
     ctx->mSwrCtx        = RT_NULL;
     ctx->mAvCodecCtx    = RT_NULL;
     ctx->mFrame         = RT_NULL;
+    ctx->mPrerollUs     = -1;
 
     // necessary parameters
     INT32 rt_codec_id;
@@ -173,8 +185,11 @@ FACodecContext* fa_video_encode_create(RtMetaData *meta) {
     AVCodecContext *codec_ctx = RT_NULL;
     const AVCodec  *codec     = RT_NULL;
     FACodecContext *ctx       = rt_malloc(FACodecContext);
+    rt_memset(ctx, 0, sizeof(FACodecContext));
+    ctx->mTrackType           = RTTRACK_TYPE_VIDEO;
     ctx->mAvCodecCtx          = RT_NULL;
     ctx->mFrame               = RT_NULL;
+    ctx->mPrerollUs           = -1;
 
     // necessary parameters
     RTCodecID codecID   = RT_VIDEO_ID_Unused;
@@ -192,10 +207,15 @@ FACodecContext* fa_video_encode_create(RtMetaData *meta) {
     }
 
     INT32 framerate;
-    if (!meta->findInt32(kKeyVCodecFrameRate, &framerate)) {
+    if (!meta->findInt32(kKeyVCodecFrameRate, &framerate) || (framerate <= 0)) {
         framerate = 30;
     }
 
+    INT32 global_header;
+    if (!meta->findInt32(kKeyVCodecGlobalHeader, &global_header)) {
+        global_header = 0;
+    }
+
     INT32 gop_size;
     if (!meta->findInt32(kKeyVCodecGopSize, &gop_size)) {
         gop_size = 10;
@@ -222,8 +242,8 @@ FACodecContext* fa_video_encode_create(RtMetaData *meta) {
     codec_ctx->width = width;
     codec_ctx->height = height;
     codec_ctx->bit_rate = bitrate;
-    /* frames per second */
-    codec_ctx->time_base = (AVRational){1, framerate};
+    /* pts of frames are in us, ms fits the 16 bits time base of mpeg4 */
+    codec_ctx->time_base = (AVRational){1, 1000};
     codec_ctx->framerate = (AVRational){framerate, 1};
 
     /* emit one intra frame every ten frames
@@ -235,6 +255,10 @@ FACodecContext* fa_video_encode_create(RtMetaData *meta) {
     codec_ctx->gop_size = gop_size;
     codec_ctx->max_b_frames = max_b_frames;
     codec_ctx->pix_fmt = AV_PIX_FMT_YUV420P;
+    if (global_header) {
+        // parameter sets are put in extradata for muxer, not in key frames
+        codec_ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
 
     RT_LOGD("begin to open ffmpeg encoder(%s) now", avcodec_get_name(codec_ctx->codec_id));
     err = avcodec_open2(codec_ctx, codec_ctx->codec, NULL);
@@ -308,11 +332,11 @@ void fa_video_encode_destroy(FACodecContext **fc) {
 
 
 static RT_RET fa_init_av_packet(AVPacket *pkt, RTMediaBuffer *buffer) {
-    RtMetaData *meta = buffer->getMetaData();
     rt_memset(pkt, 0, sizeof(AVPacket));
     av_init_packet(pkt);
 
     if (buffer) {
+        RtMetaData *meta = buffer->getMetaData();
         pkt->data = reinterpret_cast<UINT8 *>(buffer->getData());
         pkt->size = buffer->getSize();
         meta->findInt64(kKeyPacketPts, &pkt->pts);
@@ -331,13 +355,19 @@ static RT_RET fa_init_av_packet(AVPacket *pkt, RTMediaBuffer *buffer) {
 }
 
 static RT_RET fa_init_av_frame(FACodecContext* fc, AVFrame **frame, RTMediaBuffer *buffer) {
-    // RtMetaData *meta = buffer->getMetaData();
+    RtMetaData *meta = buffer->getMetaData();
     UINT8 *data = reinterpret_cast<UINT8 *>(buffer->getData());
+    INT64  pts  = AV_NOPTS_VALUE;
     AVFrame *tmp_frame = RT_NULL;
     tmp_frame = av_frame_alloc();
     tmp_frame->format = fc->mAvCodecCtx->pix_fmt;
     tmp_frame->width  = fc->mAvCodecCtx->width;
     tmp_frame->height = fc->mAvCodecCtx->height;
+    if (meta->findInt64(kKeyFramePts, &pts) && (AV_NOPTS_VALUE != pts)) {
+        tmp_frame->pts = av_rescale_q(pts, AV_TIME_BASE_Q, fc->mAvCodecCtx->time_base);
+    } else {
+        tmp_frame->pts = AV_NOPTS_VALUE;
+    }
 
     /* Y */
     tmp_frame->data[0] = data;
@@ -356,6 +386,26 @@ static RT_RET fa_init_av_frame(FACodecContext* fc, AVFrame **frame, RTMediaBuffe
     return RT_OK;
 }
 
+/*
+ * preroll of exact seek ends at the first frame which reaches target,
+ * frames ending before it are only decoded for reference. key frames of
+ * trick play are never dropped, they step away from target in rewind.
+ */
+static RT_BOOL fa_decode_preroll_drop(FACodecContext* fc, INT64 pts, INT64 endPts) {
+    if ((fc->mPrerollUs < 0) || (AV_NOPTS_VALUE == pts) || fc->mTrick) {
+        return RT_FALSE;
+    }
+    if (endPts < fc->mPrerollUs) {
+        return RT_TRUE;
+    }
+    RT_LOGD_IF(DEBUG_FLAG, "preroll done, target: %lld pts: %lld", fc->mPrerollUs, pts);
+    fc->mPrerollUs = -1;
+    if ((RTTRACK_TYPE_VIDEO == fc->mTrackType) && !fc->mTrick) {
+        fc->mAvCodecCtx->skip_frame = AVDISCARD_DEFAULT;
+    }
+    return RT_FALSE;
+}
+
 RT_RET fa_decode_send_packet(FACodecContext* fc, RTMediaBuffer *buffer) {
     if (!fc && buffer) {
         RT_LOGE("fc or pkt is NULL: fc: %p pkt: %p", fc, buffer);
@@ -365,6 +415,12 @@ RT_RET fa_decode_send_packet(FACodecContext* fc, RTMediaBuffer *buffer) {
     AVPacket* avPkt = av_packet_alloc();;
     fa_init_av_packet(avPkt, buffer);
 
+    // non-ref frames before target are neither shown nor referenced
+    if ((fc->mPrerollUs >= 0) && (RTTRACK_TYPE_VIDEO == fc->mTrackType)
+          && !fc->mTrick && (AV_NOPTS_VALUE != avPkt->pts)) {
+        fc->mAvCodecCtx->skip_frame = (avPkt->pts < fc->mPrerollUs) ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+    }
+
     if (avcodec_send_packet(fc->mAvCodecCtx, avPkt) == AVERROR(EAGAIN)) {
         RT_LOGE("send_packet returned EAGAIN, which is an API violation.\n");
         av_packet_unref(avPkt);
@@ -397,6 +453,10 @@ RT_RET fa_video_decode_get_frame(FACodecContext* fc, RTMediaBuffer *buffer) {
             av_frame_unref(frame);
             return RT_ERR_TIMEOUT;
         }
+        if ((ret >= 0) && fa_decode_preroll_drop(fc, frame->pts, frame->pts)) {
+            av_frame_unref(frame);
+            return RT_ERR_TIMEOUT;
+        }
     }
 
     meta = buffer->getMetaData();
@@ -440,6 +500,48 @@ RT_RET fa_video_decode_get_frame(FACodecContext* fc, RTMediaBuffer *buffer) {
     return RT_OK;
 }
 
+RT_RET fa_video_decode_peek(FACodecContext* fc, FAVideoPicture *picture) {
+    if ((RT_NULL == fc) || (RT_NULL == picture)) {
+        return RT_ERR_NULL_PTR;
+    }
+    if (!fc->mFrame) {
+        fc->mFrame = av_frame_alloc();
+    }
+    AVFrame *frame = fc->mFrame;
+    INT32    ret   = avcodec_receive_frame(fc->mAvCodecCtx, frame);
+    if (ret == AVERROR(EAGAIN)) {
+        return RT_ERR_TIMEOUT;
+    }
+    if (ret == AVERROR_EOF) {
+        return RT_ERR_END_OF_STREAM;
+    }
+    if (ret < 0) {
+        fa_utils_check_error(ret, "avcodec_receive_frame");
+        return RT_ERR_UNKNOWN;
+    }
+    if ((AV_PIX_FMT_YUV420P != frame->format) && (AV_PIX_FMT_YUVJ420P != frame->format)) {
+        RT_LOGE("pixel format(%d) isn't yuv420p", frame->format);
+        av_frame_unref(frame);
+        return RT_ERR_UNIMPLIMENTED;
+    }
+
+    for (INT32 idx = 0; idx < 3; idx++) {
+        picture->mPlane[idx]  = frame->data[idx];
+        picture->mStride[idx] = frame->linesize[idx];
+    }
+    picture->mWidth    = frame->width;
+    picture->mHeight   = frame->height;
+    picture->mPts      = frame->pts;
+    picture->mKeyFrame = frame->key_frame ? RT_TRUE : RT_FALSE;
+    return RT_OK;
+}
+
+void fa_video_decode_unref(FACodecContext* fc) {
+    if ((RT_NULL != fc) && (RT_NULL != fc->mFrame)) {
+        av_frame_unref(fc->mFrame);
+    }
+}
+
 RT_RET fa_audio_decode_get_frame(FACodecContext* fc, RTMediaBuffer *buffer) {
     UINT8 *dst = NULL;
     RtMetaData *meta = NULL;
@@ -457,6 +559,12 @@ RT_RET fa_audio_decode_get_frame(FACodecContext* fc, RTMediaBuffer *buffer) {
             av_frame_unref(frame);
             return RT_ERR_TIMEOUT;
         }
+        if ((ret >= 0) && (frame->sample_rate > 0)
+              && fa_decode_preroll_drop(fc, frame->pts,
+                        frame->pts + (INT64)frame->nb_samples * 1000000 / frame->sample_rate)) {
+            av_frame_unref(frame);
+            return RT_ERR_TIMEOUT;
+        }
     }
 
     meta = buffer->getMetaData();
@@ -574,50 +682,170 @@ __FAILED:
     return RT_ERR_UNKNOWN;
 }
 
+/*
+ * trick-play: frames which are not referenced and loop filter are skipped,
+ * keyframes are still decoded completely.
+ */
+void fa_decode_set_trick(FACodecContext* fc, RT_BOOL trick) {
+    if ((RT_NULL == fc) || (RT_NULL == fc->mAvCodecCtx)) {
+        return;
+    }
+    if (RTTRACK_TYPE_VIDEO != fc->mTrackType) {
+        return;
+    }
+    fc->mAvCodecCtx->skip_frame       = trick ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+    fc->mAvCodecCtx->skip_loop_filter = trick ? AVDISCARD_ALL : AVDISCARD_DEFAULT;
+    fc->mTrick                        = trick;
+    // target of last seek is stale once trick play starts or ends
+    fc->mPrerollUs                    = -1;
+}
+
+void fa_decode_set_preroll(FACodecContext* fc, INT64 targetUs) {
+    if ((RT_NULL == fc) || (RT_NULL == fc->mAvCodecCtx)) {
+        return;
+    }
+    // frames of old position are still kept in decoder
+    avcodec_flush_buffers(fc->mAvCodecCtx);
+    fc->mEosFlag   = RT_FALSE;
+    // seek of trick play only moves stepping of key frames
+    fc->mPrerollUs = fc->mTrick ? -1 : targetUs;
+}
+
+static RT_RET fa_encode_check_send(INT32 ret) {
+    if (ret == AVERROR(EAGAIN)) {
+        return RT_ERR_TIMEOUT;
+    }
+    if (ret == AVERROR_EOF) {
+        return RT_ERR_END_OF_STREAM;
+    }
+    if (ret < 0) {
+        fa_utils_check_error(ret, "avcodec_send_frame");
+        return RT_ERR_UNKNOWN;
+    }
+    return RT_OK;
+}
+
+/*
+ * frame is copied by encoder if it needs to keep it, so buffer can be
+ * released after sending. frame of EOS drains encoder.
+ */
 RT_RET fa_encode_send_frame(FACodecContext* fc, RTMediaBuffer *buffer) {
-    if (!fc && buffer) {
-        RT_LOGE("fc or pkt is NULL: fc: %p pkt: %p", fc, buffer);
+    if ((RT_NULL == fc) || (RT_NULL == buffer)) {
+        RT_LOGE("fc or frame is NULL: fc: %p frame: %p", fc, buffer);
         return RT_ERR_VALUE;
     }
 
-    AVFrame *frame;
-    fa_init_av_frame(fc, &frame, buffer);
+    INT32 ret = 0;
+    INT32 eos = 0;
+    buffer->getMetaData()->findInt32(kKeyFrameEOS, &eos);
+    if (buffer->getLength() > 0) {
+        AVFrame *frame = RT_NULL;
+        fa_init_av_frame(fc, &frame, buffer);
+        ret = avcodec_send_frame(fc->mAvCodecCtx, frame);
+        av_frame_free(&frame);
+    }
+    if ((ret >= 0) && eos) {
+        ret = avcodec_send_frame(fc->mAvCodecCtx, NULL);
+    }
+    return fa_encode_check_send(ret);
+}
 
-    if (avcodec_send_frame(fc->mAvCodecCtx, frame) < 0) {
-        RT_LOGE("send_frame returned EAGAIN, which is an API violation.\n");
-        return RT_ERR_TIMEOUT;
+/*
+ * frame refers to planes of picture, encoder copies them in send, so the
+ * picture can be unref after it. pts of picture is in us.
+ */
+RT_RET fa_encode_send_picture(FACodecContext* fc, FAVideoPicture *picture) {
+    if (RT_NULL == fc) {
+        return RT_ERR_VALUE;
+    }
+    if (RT_NULL == picture) {
+        return fa_encode_check_send(avcodec_send_frame(fc->mAvCodecCtx, NULL));
     }
 
-    return RT_OK;
+    AVFrame *frame = av_frame_alloc();
+    frame->format  = fc->mAvCodecCtx->pix_fmt;
+    frame->width   = picture->mWidth;
+    frame->height  = picture->mHeight;
+    frame->pts     = av_rescale_q(picture->mPts, AV_TIME_BASE_Q, fc->mAvCodecCtx->time_base);
+    for (INT32 idx = 0; idx < 3; idx++) {
+        frame->data[idx]     = picture->mPlane[idx];
+        frame->linesize[idx] = picture->mStride[idx];
+    }
+    INT32 ret = avcodec_send_frame(fc->mAvCodecCtx, frame);
+    av_frame_free(&frame);
+    return fa_encode_check_send(ret);
 }
 
+static INT32 fa_encode_packet_free(void *raw_pkt) {
+    AVPacket *pkt = reinterpret_cast<AVPacket *>(raw_pkt);
+    av_packet_free(&pkt);
+    return 0;
+}
+
+/*
+ * packet of encoder is lent to buffer without copy, it is freed when the
+ * buffer is released. timestamps of packet are in us.
+ */
 RT_RET fa_encode_get_packet(FACodecContext* fc, RTMediaBuffer *buffer) {
-    RtMetaData *meta = NULL;
-    int ret = 0;
+    if ((RT_NULL == fc) || (RT_NULL == buffer)) {
+        return RT_ERR_VALUE;
+    }
 
     AVPacket *pkt = av_packet_alloc();
-
-    meta = buffer->getMetaData();
-
-    ret = avcodec_receive_packet(fc->mAvCodecCtx, pkt);
-    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-        RT_LOGE("receive_packet returned EAGAIN, which is an API violation.\n");
+    INT32     ret = avcodec_receive_packet(fc->mAvCodecCtx, pkt);
+    if (ret == AVERROR(EAGAIN)) {
         av_packet_free(&pkt);
         return RT_ERR_TIMEOUT;
-    } else if (ret < 0) {
+    }
+    if (ret == AVERROR_EOF) {
+        // all packets are given out, encoder accepts frames again
         av_packet_free(&pkt);
-        return RT_ERR_TIMEOUT;
+        avcodec_flush_buffers(fc->mAvCodecCtx);
+        buffer->setData(RT_NULL, 0);
+        buffer->getMetaData()->setInt32(kKeyFrameEOS, 1);
+        buffer->setStatus(RT_MEDIA_BUFFER_STATUS_READY);
+        return RT_OK;
+    }
+    if (ret < 0) {
+        fa_utils_check_error(ret, "avcodec_receive_packet");
+        av_packet_free(&pkt);
+        return RT_ERR_UNKNOWN;
     }
 
-    meta->setInt64(kKeyPacketPts, pkt->pts);
-    meta->setInt64(kKeyPacketDts, pkt->dts);
-    buffer->setRange(0, pkt->size);
-
-    rt_memcpy(buffer->getData(), pkt->data, pkt->size);
+    AVRational  timeBase = fc->mAvCodecCtx->time_base;
+    buffer->setData(pkt->data, pkt->size, fa_encode_packet_free);
+    RtMetaData *meta = buffer->getMetaData();
+    meta->setPointer(kKeyPacketPtr, pkt);
+    meta->setInt64(kKeyPacketPts,   av_rescale_q(pkt->pts, timeBase, AV_TIME_BASE_Q));
+    meta->setInt64(kKeyPacketDts,   av_rescale_q(pkt->dts, timeBase, AV_TIME_BASE_Q));
+    meta->setInt32(kKeyPacketSize,  pkt->size);
+    meta->setInt32(kKeyPacketFlag,  pkt->flags);
     buffer->setStatus(RT_MEDIA_BUFFER_STATUS_READY);
     return RT_OK;
 }
 
+/*
+ * format of encoded track, extradata belongs to encoder.
+ */
+RT_RET fa_encode_query_format(FACodecContext* fc, RtMetaData *meta) {
+    if ((RT_NULL == fc) || (RT_NULL == fc->mAvCodecCtx) || (RT_NULL == meta)) {
+        return RT_ERR_NULL_PTR;
+    }
+    AVCodecContext *codec_ctx = fc->mAvCodecCtx;
+    meta->setInt32(kKeyCodecType,       fc->mTrackType);
+    meta->setInt32(kKeyCodecID,         fa_utils_to_rt_codec_id(codec_ctx->codec_id));
+    meta->setInt32(kKeyCodecProfile,    codec_ctx->profile);
+    meta->setInt32(kKeyCodecLevel,      codec_ctx->level);
+    meta->setInt64(kKeyCodecBitrate,    codec_ctx->bit_rate);
+    meta->setPointer(kKeyCodecExtraData, codec_ctx->extradata);
+    meta->setInt32(kKeyCodecExtraSize,  codec_ctx->extradata_size);
+    meta->setInt32(kKeyVCodecWidth,     codec_ctx->width);
+    meta->setInt32(kKeyVCodecHeight,    codec_ctx->height);
+    meta->setInt32(kKeyVCodecVideoDelay, codec_ctx->has_b_frames);
+    meta->setInt32(kKeyVCodecFrameRate, codec_ctx->framerate.num / RT_MAX(codec_ctx->framerate.den, 1));
+    return RT_OK;
+}
+
 
 void fa_codec_close(FACodecContext *fc);
 void fa_codec_flush(FACodecContext *fc);
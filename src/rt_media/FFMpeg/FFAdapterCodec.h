@@ -41,8 +41,20 @@ struct FACodecContext {
     SwrContext      *mSwrCtx;
     AVFrame         *mFrame;
     RT_BOOL          mEosFlag;
+    RT_BOOL          mTrick;
+    INT64            mPrerollUs;     // frames before it are dropped, -1 if no preroll
 };
 
+// decoded picture of yuv420p, planes belong to decoder
+typedef struct FAVideoPicture {
+    UINT8  *mPlane[3];
+    INT32   mStride[3];
+    INT32   mWidth;
+    INT32   mHeight;
+    INT64   mPts;
+    RT_BOOL mKeyFrame;
+} FAVideoPicture;
+
 class RtMetaData;
 class RTMediaBuffer;
 
@@ -55,12 +67,22 @@ void fa_video_encode_destroy(FACodecContext** fc);
 
 RT_RET fa_decode_send_packet(FACodecContext* fc, RTMediaBuffer *buffer);
 RT_RET fa_decode_get_frame(FACodecContext* fc, RTMediaBuffer *buffer);
+// picture is referenced without copy, until fa_video_decode_unref()
+RT_RET fa_video_decode_peek(FACodecContext* fc, FAVideoPicture *picture);
+void   fa_video_decode_unref(FACodecContext* fc);
 
 RT_RET fa_encode_send_frame(FACodecContext* fc, RTMediaBuffer *buffer);
+// planes of decoder are encoded without packing, NULL picture drains encoder
+RT_RET fa_encode_send_picture(FACodecContext* fc, FAVideoPicture *picture);
+// packet is lent to buffer without copy, until the buffer is released
 RT_RET fa_encode_get_packet(FACodecContext* fc, RTMediaBuffer *buffer);
+RT_RET fa_encode_query_format(FACodecContext* fc, RtMetaData *meta);
 
 
 void fa_codec_flush(FACodecContext* fc);
+void fa_decode_set_trick(FACodecContext* fc, RT_BOOL trick);
+// exact seek: decoder is flushed, frames before target are dropped without copy
+void fa_decode_set_preroll(FACodecContext* fc, INT64 targetUs);
 void fa_codec_push(FACodecContext* fc, char* buffer, UINT32 size);
 void fa_codec_pull(FACodecContext* fc, char* buffer, UINT32* size);
 
@@ -39,10 +39,22 @@
 #define API_HAVE_AV_REGISTER_ALL (LIBAVFORMAT_VERSION_MAJOR < 58)
 #endif
 
+#define FA_READER_BUFFER_SIZE   (32 * 1024)
+
 struct FAFormatContext {
     AVFormatContext  *mAvfc;
     FC_FLAG          mFcFlag;
     INT64            mDuration;
+    AVIOContext      *mAvio;        // custom I/O, only for fa_format_open_reader
+    void             *mOpaque;
+    FA_READ_FUNC      mRead;
+    FA_SEEK_FUNC      mSeek;
+};
+
+struct FAIOContext {
+    AVIOContext      *mAvio;
+    FA_INTERRUPT_FUNC mInterrupt;
+    void             *mOpaque;
 };
 
 static void ffmpeg_log_callback(void *ptr, int level, const char *fmt, va_list vl) {
@@ -78,6 +90,10 @@ FAFormatContext* fa_format_open(const char* uri, FC_FLAG flag /*FLAG_DEMUXER*/)
     fafc->mAvfc           = RT_NULL;
     fafc->mFcFlag         = flag;
     fafc->mDuration       = 0;
+    fafc->mAvio           = RT_NULL;
+    fafc->mOpaque         = RT_NULL;
+    fafc->mRead           = RT_NULL;
+    fafc->mSeek           = RT_NULL;
     AVDictionary*    opts = NULL;
 
     RT_LOGE_IF(DEBUG_FLAG, "uri = %s", uri);
@@ -106,12 +122,21 @@ FAFormatContext* fa_format_open(const char* uri, FC_FLAG flag /*FLAG_DEMUXER*/)
         fafc->mDuration = fafc->mAvfc->duration;
         break;
       case FLAG_MUXER:
-        fafc->mAvfc = avformat_alloc_context();
-        fafc->mAvfc->oformat = av_guess_format(NULL, uri, NULL);
-        err = avio_open(&fafc->mAvfc->pb, uri, AVIO_FLAG_WRITE);
-        if (fa_utils_check_error(err, "avio_open") < 0) {
+        #if API_HAVE_AV_REGISTER_ALL
+        av_register_all();
+        #endif
+        /* output format is guessed by extension of uri */
+        err = avformat_alloc_output_context2(&(fafc->mAvfc), NULL, NULL, uri);
+        if (fa_utils_check_error(err, "avformat_alloc_output_context2") < 0) {
             goto error_func;
         }
+        if (!(fafc->mAvfc->oformat->flags & AVFMT_NOFILE)) {
+            err = avio_open(&fafc->mAvfc->pb, uri, AVIO_FLAG_WRITE);
+            if (fa_utils_check_error(err, "avio_open") < 0) {
+                avformat_free_context(fafc->mAvfc);
+                goto error_func;
+            }
+        }
         break;
       default:
         break;
@@ -134,15 +159,174 @@ INT32 fa_format_close(FAFormatContext* fc) {
         avformat_close_input(&(fc->mAvfc));
         break;
     case FLAG_MUXER:
+        if (!(fc->mAvfc->oformat->flags & AVFMT_NOFILE)) {
+            avio_closep(&(fc->mAvfc->pb));
+        }
+        avformat_free_context(fc->mAvfc);
+        fc->mAvfc = RT_NULL;
         break;
     default:
         break;
     }
+    // avformat_close_input doesn't free custom I/O context
+    if (RT_NULL != fc->mAvio) {
+        av_freep(&(fc->mAvio->buffer));
+        avio_context_free(&(fc->mAvio));
+    }
     avformat_network_deinit();
     rt_safe_free(fc);
     return err;
 }
 
+static int fa_reader_read(void* opaque, uint8_t* buf, int size) {
+    FAFormatContext* fc = reinterpret_cast<FAFormatContext*>(opaque);
+    INT32 ret = fc->mRead(fc->mOpaque, buf, size);
+    if ((0 == ret) || (RT_ERR_END_OF_STREAM == ret)) {
+        return AVERROR_EOF;
+    }
+    return (ret < 0) ? AVERROR_EXIT : ret;
+}
+
+static int64_t fa_reader_seek(void* opaque, int64_t offset, int whence) {
+    FAFormatContext* fc = reinterpret_cast<FAFormatContext*>(opaque);
+    if (RT_NULL == fc->mSeek) {
+        return AVERROR(ENOSYS);
+    }
+    // AVSEEK_FORCE is meaningless for bytes which are cached already
+    whence &= ~AVSEEK_FORCE;
+    if (whence & AVSEEK_SIZE) {
+        whence = FA_SEEK_SIZE;
+    }
+    INT64 ret = fc->mSeek(fc->mOpaque, offset, whence);
+    return (ret < 0) ? AVERROR(EIO) : ret;
+}
+
+FAFormatContext* fa_format_open_reader(const char* uri, void* opaque,
+                                       FA_READ_FUNC read, FA_SEEK_FUNC seek) {
+    INT32 err = 0;
+    UINT8* buffer = RT_NULL;
+    FAFormatContext* fafc = rt_malloc(FAFormatContext);
+    fafc->mAvfc           = RT_NULL;
+    fafc->mFcFlag         = FLAG_DEMUXER;
+    fafc->mDuration       = 0;
+    fafc->mAvio           = RT_NULL;
+    fafc->mOpaque         = opaque;
+    fafc->mRead           = read;
+    fafc->mSeek           = seek;
+
+    RT_LOGE_IF(DEBUG_FLAG, "uri = %s (custom reader)", uri);
+    fa_ffmpeg_runtime_init();
+    #if API_HAVE_AV_REGISTER_ALL
+    av_register_all();
+    #endif
+    avformat_network_init();
+
+    buffer = reinterpret_cast<UINT8*>(av_malloc(FA_READER_BUFFER_SIZE));
+    fafc->mAvio = avio_alloc_context(buffer, FA_READER_BUFFER_SIZE, 0, fafc,
+                                     fa_reader_read, NULL,
+                                     (RT_NULL != seek) ? fa_reader_seek : NULL);
+    fafc->mAvfc = avformat_alloc_context();
+    if ((RT_NULL == fafc->mAvio) || (RT_NULL == fafc->mAvfc)) {
+        RT_LOGE("fail to alloc custom I/O context");
+        goto error_func;
+    }
+    fafc->mAvfc->pb     = fafc->mAvio;
+    fafc->mAvfc->flags |= AVFMT_FLAG_CUSTOM_IO;
+
+    /* avformat_open_input frees format context on failure */
+    err = avformat_open_input(&(fafc->mAvfc), uri, NULL, NULL);
+    if (fa_utils_check_error(err, "avformat_open_input") < 0) {
+        goto error_func;
+    }
+
+    err = avformat_find_stream_info(fafc->mAvfc, NULL);
+    if (fa_utils_check_error(err, "avformat_find_stream_info") < 0) {
+        avformat_close_input(&(fafc->mAvfc));
+        goto error_func;
+    }
+    fafc->mDuration = fafc->mAvfc->duration;
+    return fafc;
+
+error_func:
+    if (RT_NULL != fafc->mAvfc) {
+        avformat_free_context(fafc->mAvfc);
+    }
+    if (RT_NULL != fafc->mAvio) {
+        buffer = fafc->mAvio->buffer;
+        avio_context_free(&(fafc->mAvio));
+    }
+    av_freep(&buffer);
+    avformat_network_deinit();
+    rt_safe_free(fafc);
+    return RT_NULL;
+}
+
+static int fa_io_interrupt(void* opaque) {
+    FAIOContext* ioc = reinterpret_cast<FAIOContext*>(opaque);
+    return ioc->mInterrupt(ioc->mOpaque);
+}
+
+FAIOContext* fa_io_open(const char* uri, FA_INTERRUPT_FUNC interrupt, void* opaque) {
+    FAIOContext* ioc = rt_malloc(FAIOContext);
+    ioc->mAvio       = RT_NULL;
+    ioc->mInterrupt  = interrupt;
+    ioc->mOpaque     = opaque;
+
+    AVIOInterruptCB callback = { NULL, NULL };
+    if (RT_NULL != interrupt) {
+        callback.callback = fa_io_interrupt;
+        callback.opaque   = ioc;
+    }
+
+    fa_ffmpeg_runtime_init();
+    avformat_network_init();
+    INT32 err = avio_open2(&(ioc->mAvio), uri, AVIO_FLAG_READ, &callback, NULL);
+    if (fa_utils_check_error(err, "avio_open2") < 0) {
+        avformat_network_deinit();
+        rt_safe_free(ioc);
+        return RT_NULL;
+    }
+    return ioc;
+}
+
+INT32 fa_io_close(FAIOContext* ioc) {
+    if (RT_NULL == ioc) {
+        return -1;
+    }
+    avio_closep(&(ioc->mAvio));
+    avformat_network_deinit();
+    rt_safe_free(ioc);
+    return 0;
+}
+
+/*
+ * returns bytes of data, RT_ERR_END_OF_STREAM at the end of stream.
+ */
+INT32 fa_io_read(FAIOContext* ioc, UINT8* buf, INT32 size) {
+    if ((RT_NULL == ioc) || (RT_NULL == ioc->mAvio)) {
+        return RT_ERR_NULL_PTR;
+    }
+    INT32 ret = avio_read_partial(ioc->mAvio, buf, size);
+    if ((0 == ret) || (AVERROR_EOF == ret)) {
+        return RT_ERR_END_OF_STREAM;
+    }
+    return ret;
+}
+
+INT64 fa_io_seek(FAIOContext* ioc, INT64 offset) {
+    if ((RT_NULL == ioc) || (RT_NULL == ioc->mAvio)) {
+        return RT_ERR_NULL_PTR;
+    }
+    return avio_seek(ioc->mAvio, offset, SEEK_SET);
+}
+
+INT64 fa_io_size(FAIOContext* ioc) {
+    if ((RT_NULL == ioc) || (RT_NULL == ioc->mAvio)) {
+        return RT_ERR_NULL_PTR;
+    }
+    return avio_size(ioc->mAvio);
+}
+
 INT32 fa_format_seek_to(FAFormatContext* fc, INT32 track_id, UINT64 timestamp, UINT32 flags) {
     INT32 err = check_av_format_ctx(fc);
     if (-1 == err) {
@@ -157,6 +341,27 @@ INT32 fa_format_seek_to(FAFormatContext* fc, INT32 track_id, UINT64 timestamp, U
     return err;
 }
 
+/*
+ * seek to the keyframe at or before(backward) / at or after timeUs, which is
+ * found in the index of demuxer. used by trick-play to step over keyframes.
+ */
+INT32 fa_format_seek_key(FAFormatContext* fc, INT64 timeUs, RT_BOOL backward) {
+    INT32 err = check_av_format_ctx(fc);
+    if (-1 == err) {
+        return err;
+    }
+
+    INT64 timestamp = timeUs;
+    if (fc->mAvfc->start_time != AV_NOPTS_VALUE)
+        timestamp += fc->mAvfc->start_time;
+    if (backward) {
+        err = avformat_seek_file(fc->mAvfc, -1, RT_INT64_MIN, timestamp, timestamp, 0);
+    } else {
+        err = avformat_seek_file(fc->mAvfc, -1, timestamp, timestamp, RT_INT64_MAX, 0);
+    }
+    return err;
+}
+
 INT32 fa_format_packet_read(FAFormatContext* fc, void** raw_pkt) {
     INT32 err = check_av_format_ctx(fc);
     if (-1 == err) {
@@ -236,6 +441,151 @@ INT64 fa_format_get_duraton(FAFormatContext* fc) {
     return duration;
 }
 
+INT64 fa_format_get_bitrate(FAFormatContext* fc) {
+    INT64 bitrate = 0;
+    if (0 == check_av_format_ctx(fc)) {
+        bitrate = fc->mAvfc->bit_rate;
+    }
+    return bitrate;
+}
+
+/*
+ * timestamps of keyframes in index of demuxer, in us and same as dts of
+ * packets. index is built when file is opened, such as mp4 and mkv with cues.
+ */
+INT32 fa_format_query_keyframes(FAFormatContext* fc, INT32 track, INT64* timesUs, INT32 maxCount) {
+    INT32 err = check_av_format_ctx(fc);
+    if ((-1 == err) || (RT_NULL == timesUs) || (track < 0) || (track >= (INT32)fc->mAvfc->nb_streams)) {
+        return -1;
+    }
+
+    AVStream *stream = fc->mAvfc->streams[track];
+    INT64 startTimeUs = stream->start_time == AV_NOPTS_VALUE ? 0 :
+        av_rescale_q(stream->start_time, stream->time_base, AV_TIME_BASE_Q);
+    INT32 count = 0;
+    for (INT32 idx = 0; (idx < stream->nb_index_entries) && (count < maxCount); idx++) {
+        const AVIndexEntry *entry = &(stream->index_entries[idx]);
+        if (entry->flags & AVINDEX_KEYFRAME) {
+            timesUs[count++] = av_rescale_q(entry->timestamp, stream->time_base, AV_TIME_BASE_Q) - startTimeUs;
+        }
+    }
+    return count;
+}
+
+/*
+ * returns index of new stream. extradata is copied, so track can be
+ * released after it. time base is us, muxer may change it in header.
+ */
+INT32 fa_format_add_stream(FAFormatContext* fc, RTTrackParms* track) {
+    INT32 err = check_av_format_ctx(fc);
+    if ((-1 == err) || (RT_NULL == track)) {
+        return -1;
+    }
+
+    AVStream* stream = avformat_new_stream(fc->mAvfc, NULL);
+    if (RT_NULL == stream) {
+        RT_LOGE("fail to add stream of %s", av_get_media_type_string((AVMediaType)track->mCodecType));
+        return -1;
+    }
+    AVCodecParameters* cpar = stream->codecpar;
+    cpar->codec_type  = (AVMediaType)track->mCodecType;
+    cpar->codec_id    = (AVCodecID)fa_utils_to_av_codec_id(track->mCodecID);
+    cpar->codec_tag   = 0;
+    cpar->format      = track->mCodecFormat;
+    cpar->profile     = track->mCodecProfile;
+    cpar->level       = track->mCodecLevel;
+    cpar->bit_rate    = track->mBitrate;
+    if ((RT_NULL != track->mExtraData) && (track->mExtraDataSize > 0)) {
+        cpar->extradata = reinterpret_cast<UINT8*>(av_mallocz(track->mExtraDataSize
+                                                              + AV_INPUT_BUFFER_PADDING_SIZE));
+        rt_memcpy(cpar->extradata, track->mExtraData, track->mExtraDataSize);
+        cpar->extradata_size = track->mExtraDataSize;
+    }
+
+    switch (track->mCodecType) {
+      case RTTRACK_TYPE_VIDEO:
+        cpar->width           = track->mVideoWidth;
+        cpar->height          = track->mVideoHeight;
+        cpar->video_delay     = track->mVideoDelay;
+        cpar->field_order     = (AVFieldOrder)track->mFieldOrder;
+        cpar->color_range     = (AVColorRange)track->mColorRange;
+        cpar->color_primaries = (AVColorPrimaries)track->mColorPrimaries;
+        cpar->color_trc       = (AVColorTransferCharacteristic)track->mColorTrc;
+        cpar->color_space     = (AVColorSpace)track->mColorSpace;
+        cpar->chroma_location = (AVChromaLocation)track->mChromaLocation;
+        if (track->mVideoFrameRate > 0) {
+            stream->avg_frame_rate = (AVRational){track->mVideoFrameRate, 1};
+        }
+        break;
+      case RTTRACK_TYPE_AUDIO:
+        cpar->channel_layout        = track->mAudioChannelLayout;
+        cpar->channels              = track->mAudioChannels;
+        cpar->sample_rate           = track->mAudioSampleRate;
+        cpar->block_align           = track->mAudioBlockAlign;
+        cpar->frame_size            = track->mAudioFrameSize;
+        cpar->initial_padding       = track->mAudioInitialPadding;
+        cpar->trailing_padding      = track->mAudioTrailingPadding;
+        cpar->bits_per_coded_sample = track->mAudiobitsPerCodedSample;
+        break;
+      default:
+        break;
+    }
+    stream->time_base = AV_TIME_BASE_Q;
+    RT_LOGD("add stream(idx=%d) of %s", stream->index, avcodec_get_name(cpar->codec_id));
+    return stream->index;
+}
+
+INT32 fa_format_write_header(FAFormatContext* fc) {
+    INT32 err = check_av_format_ctx(fc);
+    if (-1 == err) {
+        return err;
+    }
+    err = avformat_write_header(fc->mAvfc, NULL);
+    return fa_utils_check_error(err, "avformat_write_header");
+}
+
+/*
+ * packet isn't referenced by muxer, its data is copied if muxer needs to
+ * interleave it, so packet can be released after writing.
+ */
+INT32 fa_format_packet_write(FAFormatContext* fc, INT32 streamIdx, RTPacket* rtPkt) {
+    INT32 err = check_av_format_ctx(fc);
+    if ((-1 == err) || (RT_NULL == rtPkt) || (streamIdx < 0)
+          || (streamIdx >= (INT32)fc->mAvfc->nb_streams)) {
+        return -1;
+    }
+
+    AVStream *stream = fc->mAvfc->streams[streamIdx];
+    AVPacket *avPkt  = av_packet_alloc();
+    avPkt->data         = rtPkt->mData;
+    avPkt->size         = rtPkt->mSize;
+    avPkt->pts          = av_rescale_q(rtPkt->mPts, AV_TIME_BASE_Q, stream->time_base);
+    avPkt->dts          = av_rescale_q(rtPkt->mDts, AV_TIME_BASE_Q, stream->time_base);
+    avPkt->duration     = av_rescale_q(rtPkt->mDuration, AV_TIME_BASE_Q, stream->time_base);
+    avPkt->flags        = rtPkt->mFlags;
+    avPkt->stream_index = streamIdx;
+    err = av_interleaved_write_frame(fc->mAvfc, avPkt);
+    av_packet_free(&avPkt);
+    return fa_utils_check_error(err, "av_interleaved_write_frame");
+}
+
+INT32 fa_format_write_trailer(FAFormatContext* fc) {
+    INT32 err = check_av_format_ctx(fc);
+    if (-1 == err) {
+        return err;
+    }
+    err = av_write_trailer(fc->mAvfc);
+    return fa_utils_check_error(err, "av_write_trailer");
+}
+
+// parameter sets of encoder are out of band, such as mp4 and mkv
+RT_BOOL fa_format_need_global_header(FAFormatContext* fc) {
+    if ((0 == check_av_format_ctx(fc)) && (RT_NULL != fc->mAvfc->oformat)) {
+        return (fc->mAvfc->oformat->flags & AVFMT_GLOBALHEADER) ? RT_TRUE : RT_FALSE;
+    }
+    return RT_FALSE;
+}
+
 void fa_format_build_track_meta(const AVStream* stream, RTTrackParms* track) {
     UINT32 frame_rate = 0;
     if (stream->avg_frame_rate.den > 0) {
@@ -35,11 +35,37 @@ class RtMetaData;
 FAFormatContext* fa_format_open(const char* uri, FC_FLAG flag = FLAG_DEMUXER);
 INT32  fa_format_close(FAFormatContext* fc);
 INT32  fa_format_seek_to(FAFormatContext* fc, INT32 track_id, UINT64 ts, UINT32 flags);
+INT32  fa_format_seek_key(FAFormatContext* fc, INT64 timeUs, RT_BOOL backward);
 INT32  fa_format_packet_read(FAFormatContext* fc, void** raw_pkt);
 INT32  fa_format_packet_parse(FAFormatContext* fc, void* raw_pkt, RTPacket* rt_pkt);
 INT32  fa_format_packet_type(void*  raw_pkt);
 INT32  fa_format_packet_free(void*  raw_pkt);
 INT64  fa_format_get_duraton(FAFormatContext* fc);
+INT64  fa_format_get_bitrate(FAFormatContext* fc);
+INT32  fa_format_query_keyframes(FAFormatContext* fc, INT32 track, INT64* timesUs, INT32 maxCount);
+
+// some operations for write, timestamps of packets are in us
+INT32   fa_format_add_stream(FAFormatContext* fc, RTTrackParms* track);
+INT32   fa_format_write_header(FAFormatContext* fc);
+INT32   fa_format_packet_write(FAFormatContext* fc, INT32 streamIdx, RTPacket* rtPkt);
+INT32   fa_format_write_trailer(FAFormatContext* fc);
+RT_BOOL fa_format_need_global_header(FAFormatContext* fc);
+
+// demuxer reads bytes from media source instead of ffmpeg protocols
+#define FA_SEEK_SIZE  0x10000  // whence of seek callback, query total size of stream
+typedef INT32 (*FA_READ_FUNC)(void* opaque, UINT8* buf, INT32 size);
+typedef INT64 (*FA_SEEK_FUNC)(void* opaque, INT64 offset, INT32 whence);
+FAFormatContext* fa_format_open_reader(const char* uri, void* opaque,
+                                       FA_READ_FUNC read, FA_SEEK_FUNC seek);
+
+// byte stream of ffmpeg protocols(http/https/file), used by I/O thread of media source
+struct FAIOContext;
+typedef INT32 (*FA_INTERRUPT_FUNC)(void* opaque);
+FAIOContext* fa_io_open(const char* uri, FA_INTERRUPT_FUNC interrupt, void* opaque);
+INT32  fa_io_close(FAIOContext* ioc);
+INT32  fa_io_read(FAIOContext* ioc, UINT8* buf, INT32 size);
+INT64  fa_io_seek(FAIOContext* ioc, INT64 offset);
+INT64  fa_io_size(FAIOContext* ioc);
 
 
 // some operations for media tracks
@@ -20,6 +20,7 @@
 #include <stdarg.h>          // NOLINT
 #include "FFAdapterUtils.h"  // NOLINT
 #include "RTMediaDef.h"      // NOLINT
+#include "RTImageColor.h"    // NOLINT
 #include "rt_log.h"          // NOLINT
 #include "rt_common.h"       // NOLINT
 
@@ -129,41 +130,25 @@ const char* fa_utils_ffmpeg_version() {
     return av_version_info();
 }
 
-#define YUV2R(y, u, v) ({ \
-    int r = (y) + ((((v) - 128) * 1436) >> 10); r > 255 ? 255 : r < 0 ? 0 : r; })
-#define YUV2G(y, u, v) ({ \
-    int g = (y) - ((((u) - 128) * 352 + ((v) - 128) * 731) >> 10); g > 255 ? 255 : g < 0 ? 0 : g; })
-#define YUV2B(y, u, v) ({ \
-    int b = (y) + ((((u) - 128) * 1814) >> 10); b > 255 ? 255 : b < 0 ? 0 : b; })
+/*
+ * packed yuv420p to rgb24, full range of BT.601 as before.
+ * see RTImageColor.h for strides, nv12/nv21 and other formats.
+ */
 UINT32 fa_utils_yuv420_to_rgb(void* src, unsigned char* dest, \
                                    int width, int height) {
-    int ix, iy;
-    const unsigned char *ysrc = (unsigned char*)src;
-    const unsigned char *usrc, *vsrc;
-
-    usrc = (unsigned char*)(ysrc + width * height);
-    vsrc = (unsigned char*)(usrc + (width * height) / 4);
-
-    for (iy = 0; iy < height; iy++) {
-        for (ix = 0; ix < width; ix += 2) {
-            *dest++ = YUV2R(*ysrc, *usrc, *vsrc);
-            *dest++ = YUV2G(*ysrc, *usrc, *vsrc);
-            *dest++ = YUV2B(*ysrc, *usrc, *vsrc);
-            ysrc++;
-
-            *dest++ = YUV2R(*ysrc, *usrc, *vsrc);
-            *dest++ = YUV2G(*ysrc, *usrc, *vsrc);
-            *dest++ = YUV2B(*ysrc, *usrc, *vsrc);
-            ysrc++;
-            usrc++;
-            vsrc++;
-        }
-        /* Rewind u and v for next line */
-        if (!(iy & 0x1)) {
-            usrc -= width / 2;
-            vsrc -= width / 2;
-        }
-    }
-    return 0;
+    INT32      chromaW = (width + 1) / 2;
+    RTImageYUV yuv;
+    rt_memset(&yuv, 0, sizeof(RTImageYUV));
+    yuv.mPlane[0]  = reinterpret_cast<const UINT8 *>(src);
+    yuv.mPlane[1]  = yuv.mPlane[0] + width * height;
+    yuv.mPlane[2]  = yuv.mPlane[1] + chromaW * ((height + 1) / 2);
+    yuv.mStride[0] = width;
+    yuv.mStride[1] = chromaW;
+    yuv.mStride[2] = chromaW;
+    yuv.mWidth     = width;
+    yuv.mHeight    = height;
+    yuv.mFormat    = RT_FMT_YUV420P;
+    return (RT_OK == rt_image_yuv_to_rgb(&yuv, dest, width * 3, RT_IMAGE_RGB24,
+                                         RTCOL_SPC_BT470BG, RTCOL_RANGE_JPEG)) ? 0 : 1;
 }
 
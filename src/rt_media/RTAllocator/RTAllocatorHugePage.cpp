@@ -0,0 +1,258 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * module: huge page allocator
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "RTAllocatorHugePage.h"    // NOLINT
+#include "RTMediaBuffer.h"          // NOLINT
+#include "RTMediaMetaKeys.h"        // NOLINT
+#include "rt_metadata.h"            // NOLINT
+#include "rt_hash_table.h"          // NOLINT
+#include "rt_mutex.h"               // NOLINT
+
+typedef struct _RtHugePageCache {
+    RtMutex        *mLock;
+    // mapped buffers, data -> size, buffers which are not in it are malloced
+    RtHashTable    *mMapped;
+    // freed buffers of n huge pages are linked in mFree[n - 1] by first word
+    void           *mFree[RT_HUGEPAGE_BUCKETS];
+    RT_BOOL         mHugeTlbAvail;
+    INT32           mPageSize;
+    RtHugePageStat  mStat;
+} RtHugePageCache;
+
+static RtHugePageCache* hugepage_cache() {
+    static RtHugePageCache *cache = RT_NULL;
+    static RtMutex         *lock  = new RtMutex();
+    RtMutex::RtAutolock autoLock(lock);
+    if (RT_NULL != cache) {
+        return cache;
+    }
+
+    cache = rt_malloc(RtHugePageCache);
+    rt_memset(cache, 0, sizeof(RtHugePageCache));
+    cache->mLock     = new RtMutex();
+    cache->mMapped   = rt_hash_table_create_open(64, hash_ptr_mix_func, hash_ptr_compare);
+    cache->mPageSize = (INT32)sysconf(_SC_PAGESIZE);
+    cache->mStat.mCapBytes = RT_HUGEPAGE_CACHE_CAP;
+
+    // hugetlbfs pages are used only when they are reserved and of 2MB
+    char  line[128];
+    INT32 pages = 0;
+    INT32 sizeKb = 0;
+    FILE *fp = fopen("/proc/meminfo", "r");
+    if (RT_NULL != fp) {
+        while (RT_NULL != fgets(line, sizeof(line), fp)) {
+            sscanf(line, "HugePages_Total: %d", &pages);
+            sscanf(line, "Hugepagesize: %d", &sizeKb);
+        }
+        fclose(fp);
+    }
+    cache->mHugeTlbAvail = ((pages > 0) && (sizeKb * 1024 == RT_HUGEPAGE_SIZE)) ? RT_TRUE : RT_FALSE;
+    return cache;
+}
+
+static void* hugepage_map(const RtHugePageCache *cache, size_t size, RT_BOOL *hugeTlb) {
+    *hugeTlb = RT_FALSE;
+#ifdef MAP_HUGETLB
+    if (cache->mHugeTlbAvail) {
+        void *data = mmap(RT_NULL, size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+        if (MAP_FAILED != data) {
+            *hugeTlb = RT_TRUE;
+            return data;
+        }
+    }
+#endif
+
+    // over-map and cut to 2MB aligned, so that THP can back the whole range
+    size_t span = size + RT_HUGEPAGE_SIZE;
+    UINT8 *base = reinterpret_cast<UINT8 *>(mmap(RT_NULL, span, PROT_READ | PROT_WRITE,
+                                                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (MAP_FAILED == base) {
+        return RT_NULL;
+    }
+    UINT8 *data = reinterpret_cast<UINT8 *>(RT_ALIGN((size_t)base, (size_t)RT_HUGEPAGE_SIZE));
+    if (data > base) {
+        munmap(base, data - base);
+    }
+    if (base + span > data + size) {
+        munmap(data + size, base + span - (data + size));
+    }
+#ifdef MADV_HUGEPAGE
+    madvise(data, size, MADV_HUGEPAGE);
+#endif
+
+    // faults in now instead of in decoding, one write maps a huge page with THP
+    for (size_t offset = 0; offset < size; offset += cache->mPageSize) {
+        data[offset] = 0;
+    }
+    return data;
+}
+
+static void hugepage_cache_trim(RtHugePageCache *cache, INT64 keepBytes) {
+    for (INT32 idx = RT_HUGEPAGE_BUCKETS - 1; idx >= 0; idx--) {
+        size_t size = (size_t)(idx + 1) * RT_HUGEPAGE_SIZE;
+        while ((cache->mStat.mCachedBytes > keepBytes) && (RT_NULL != cache->mFree[idx])) {
+            void *data = cache->mFree[idx];
+            cache->mFree[idx] = *reinterpret_cast<void **>(data);
+            rt_hash_table_remove(cache->mMapped, data);
+            munmap(data, size);
+            cache->mStat.mCachedBytes -= size;
+            cache->mStat.mMappedBytes -= size;
+        }
+    }
+}
+
+RTAllocatorHugePage::RTAllocatorHugePage(RtMetaData *config) {
+    init(config);
+}
+
+RTAllocatorHugePage::~RTAllocatorHugePage() {
+    deinit();
+}
+
+RT_BOOL RTAllocatorHugePage::checkAvail() {
+    return RT_TRUE;
+}
+
+RT_RET RTAllocatorHugePage::newBuffer(UINT32 capacity, RTMediaBuffer **buffer) {
+    *buffer = RT_NULL;
+    if (capacity < RT_HUGEPAGE_MIN_BUFFER) {
+        void *data = rt_mem_malloc(__FUNCTION__, capacity);
+        if (RT_NULL == data) {
+            return RT_ERR_NOMEM;
+        }
+        *buffer = new RTMediaBuffer(data, capacity, 0, 0, this);
+        return RT_OK;
+    }
+
+    RtHugePageCache *cache = hugepage_cache();
+    INT32  pages = (INT32)(RT_ALIGN((size_t)capacity, (size_t)RT_HUGEPAGE_SIZE) / RT_HUGEPAGE_SIZE);
+    size_t size  = (size_t)pages * RT_HUGEPAGE_SIZE;
+    void  *data  = RT_NULL;
+    {
+        RtMutex::RtAutolock autoLock(cache->mLock);
+        if ((pages <= RT_HUGEPAGE_BUCKETS) && (RT_NULL != cache->mFree[pages - 1])) {
+            data = cache->mFree[pages - 1];
+            cache->mFree[pages - 1] = *reinterpret_cast<void **>(data);
+            cache->mStat.mCachedBytes -= size;
+            cache->mStat.mHits++;
+        }
+    }
+
+    if (RT_NULL == data) {
+        // faulting in pages is slow, it is done out of lock
+        RT_BOOL hugeTlb = RT_FALSE;
+        data = hugepage_map(cache, size, &hugeTlb);
+        if (RT_NULL == data) {
+            RT_LOGE("fail to map %d huge pages", pages);
+            return RT_ERR_NOMEM;
+        }
+        RtMutex::RtAutolock autoLock(cache->mLock);
+        rt_hash_table_insert(cache->mMapped, data, reinterpret_cast<void *>(size));
+        cache->mStat.mMappedBytes += size;
+        cache->mStat.mHugeTlbs    += hugeTlb ? 1 : 0;
+        cache->mStat.mMisses++;
+    }
+
+    *buffer = new RTMediaBuffer(data, capacity, 0, 0, this);
+    return RT_OK;
+}
+
+RT_RET RTAllocatorHugePage::newBuffer(UINT32 width,
+                             UINT32 height,
+                             UINT32 format,
+                             RTMediaBuffer **buffer) {
+    // YUV420 Default
+    UINT32 capacity = width*height*3/2;
+    return newBuffer(capacity, buffer);
+}
+
+RT_RET RTAllocatorHugePage::freeBuffer(RTMediaBuffer **buffer) {
+    if (RT_NULL == *buffer) {
+        return RT_OK;
+    }
+
+    void *data = (*buffer)->getData();
+    if (RT_NULL != data) {
+        RtHugePageCache *cache = hugepage_cache();
+        RtMutex::RtAutolock autoLock(cache->mLock);
+        size_t size  = (size_t)rt_hash_table_find(cache->mMapped, data);
+        INT32  pages = (INT32)(size / RT_HUGEPAGE_SIZE);
+        if (0 == size) {
+            rt_free(data);
+        } else if ((pages <= RT_HUGEPAGE_BUCKETS)
+                    && (cache->mStat.mCachedBytes + (INT64)size <= cache->mStat.mCapBytes)) {
+            *reinterpret_cast<void **>(data) = cache->mFree[pages - 1];
+            cache->mFree[pages - 1] = data;
+            cache->mStat.mCachedBytes += size;
+        } else {
+            rt_hash_table_remove(cache->mMapped, data);
+            munmap(data, size);
+            cache->mStat.mMappedBytes -= size;
+        }
+    }
+    (*buffer)->setData(RT_NULL, 0);
+
+    // delete buffer wrapper
+    rt_safe_delete(*buffer);
+    *buffer = RT_NULL;
+    return RT_OK;
+}
+
+RT_RET RTAllocatorHugePage::init(RtMetaData *meta) {
+    INT64 capBytes = 0;
+    if ((RT_NULL == meta) || !meta->findInt64(kKeyMemCacheCap, &capBytes)) {
+        return RT_OK;
+    }
+
+    // cache is of the process, the latest cap takes effect
+    RtHugePageCache *cache = hugepage_cache();
+    RtMutex::RtAutolock autoLock(cache->mLock);
+    cache->mStat.mCapBytes = RT_MAX(capBytes, 0ll);
+    hugepage_cache_trim(cache, cache->mStat.mCapBytes);
+    return RT_OK;
+}
+
+RT_RET RTAllocatorHugePage::deinit() {
+    return RT_OK;
+}
+
+void RTAllocatorHugePage::summary(INT32 fd) {
+    RtHugePageStat stat;
+    getStat(&stat);
+    RT_LOGD("mapped %lldKB, cached %lldKB, cap %lldKB, hugetlb %d, hits %d, misses %d",
+             stat.mMappedBytes >> 10, stat.mCachedBytes >> 10, stat.mCapBytes >> 10,
+             stat.mHugeTlbs, stat.mHits, stat.mMisses);
+}
+
+void RTAllocatorHugePage::getStat(RtHugePageStat *stat) {
+    RtHugePageCache *cache = hugepage_cache();
+    RtMutex::RtAutolock autoLock(cache->mLock);
+    *stat = cache->mStat;
+}
+
+void RTAllocatorHugePage::trimCache() {
+    RtHugePageCache *cache = hugepage_cache();
+    RtMutex::RtAutolock autoLock(cache->mLock);
+    hugepage_cache_trim(cache, 0);
+}
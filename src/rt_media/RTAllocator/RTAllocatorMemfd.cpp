@@ -0,0 +1,211 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * module: memfd allocator
+ */
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "RTAllocatorMemfd.h"       // NOLINT
+#include "RTMediaBuffer.h"          // NOLINT
+#include "RTMediaMetaKeys.h"        // NOLINT
+#include "rt_metadata.h"            // NOLINT
+#include "rt_hash_table.h"          // NOLINT
+#include "rt_mutex.h"               // NOLINT
+
+// toolchains of boards may have kernel headers only
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC                 0x0001U
+#define MFD_ALLOW_SEALING           0x0002U
+#endif
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS                 (1024 + 9)
+#define F_SEAL_SEAL                 0x0001
+#define F_SEAL_SHRINK               0x0002
+#define F_SEAL_GROW                 0x0004
+#endif
+
+typedef struct _RtMemfdRegion {
+    struct _RtMemfdRegion  *mNext;
+    void                   *mData;
+    size_t                  mSize;
+    INT32                   mFd;
+} RtMemfdRegion;
+
+static INT32 memfd_open(const char *name, UINT32 flags) {
+#ifdef __NR_memfd_create
+    return (INT32)syscall(__NR_memfd_create, name, flags);
+#else
+    return -1;
+#endif
+}
+
+static void memfd_region_free(RtMemfdRegion *region) {
+    munmap(region->mData, region->mSize);
+    close(region->mFd);
+    rt_free(region);
+}
+
+RTAllocatorMemfd::RTAllocatorMemfd(RtMetaData *config)
+      : mLock(RT_NULL),
+        mRegions(RT_NULL),
+        mFree(RT_NULL),
+        mCachedBytes(0),
+        mCapBytes(RT_MEMFD_CACHE_CAP),
+        mSeals(F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL),
+        mPageSize(4096),
+        mCount(0) {
+    init(config);
+}
+
+RTAllocatorMemfd::~RTAllocatorMemfd() {
+    deinit();
+    // regions in use are left to their buffers, which outlive allocator
+    rt_hash_table_destory(mRegions);
+    rt_safe_delete(mLock);
+}
+
+RT_BOOL RTAllocatorMemfd::checkAvail() {
+    INT32 fd = memfd_open("rt_memfd_probe", MFD_CLOEXEC);
+    if (fd < 0) {
+        return RT_FALSE;
+    }
+    close(fd);
+    return RT_TRUE;
+}
+
+RT_RET RTAllocatorMemfd::newBuffer(UINT32 capacity, RTMediaBuffer **buffer) {
+    size_t         size   = RT_ALIGN((size_t)RT_MAX(capacity, 1u), (size_t)mPageSize);
+    RtMemfdRegion *region = RT_NULL;
+    *buffer = RT_NULL;
+    {
+        RtMutex::RtAutolock autoLock(mLock);
+        RtMemfdRegion **prev = &mFree;
+        for (RtMemfdRegion *iter = mFree; RT_NULL != iter; iter = iter->mNext) {
+            if (iter->mSize == size) {
+                *prev = iter->mNext;
+                mCachedBytes -= size;
+                region = iter;
+                break;
+            }
+            prev = &iter->mNext;
+        }
+    }
+
+    if (RT_NULL == region) {
+        char name[32];
+        snprintf(name, sizeof(name), "rt_memfd_%u", __atomic_fetch_add(&mCount, 1, __ATOMIC_RELAXED));
+        INT32 fd = memfd_open(name, MFD_CLOEXEC | ((0 != mSeals) ? MFD_ALLOW_SEALING : 0));
+        if (fd < 0) {
+            RT_LOGE("fail to create memfd of %d bytes", capacity);
+            return RT_ERR_NOMEM;
+        }
+        if (0 != ftruncate(fd, size)) {
+            RT_LOGE("fail to resize memfd to %zu bytes", size);
+            close(fd);
+            return RT_ERR_NOMEM;
+        }
+        if ((0 != mSeals) && (0 != fcntl(fd, F_ADD_SEALS, mSeals))) {
+            RT_LOGE("fail to seal memfd with 0x%x", mSeals);
+        }
+        void *data = mmap(RT_NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (MAP_FAILED == data) {
+            RT_LOGE("fail to map memfd of %zu bytes", size);
+            close(fd);
+            return RT_ERR_NOMEM;
+        }
+
+        region = rt_malloc(RtMemfdRegion);
+        region->mNext = RT_NULL;
+        region->mData = data;
+        region->mSize = size;
+        region->mFd   = fd;
+        RtMutex::RtAutolock autoLock(mLock);
+        rt_hash_table_insert(mRegions, data, region);
+    }
+
+    *buffer = new RTMediaBuffer(region->mData, capacity, 0, region->mFd, this);
+    return RT_OK;
+}
+
+RT_RET RTAllocatorMemfd::newBuffer(UINT32 width,
+                             UINT32 height,
+                             UINT32 format,
+                             RTMediaBuffer **buffer) {
+    // YUV420 Default
+    UINT32 capacity = width*height*3/2;
+    return newBuffer(capacity, buffer);
+}
+
+RT_RET RTAllocatorMemfd::freeBuffer(RTMediaBuffer **buffer) {
+    if (RT_NULL == *buffer) {
+        return RT_OK;
+    }
+
+    void *data = (*buffer)->getData();
+    if (RT_NULL != data) {
+        RtMutex::RtAutolock autoLock(mLock);
+        RtMemfdRegion *region = reinterpret_cast<RtMemfdRegion *>(rt_hash_table_find(mRegions, data));
+        if (RT_NULL == region) {
+            RT_LOGE("buffer %p is not of allocator %p", data, this);
+        } else if (mCachedBytes + (INT64)region->mSize <= mCapBytes) {
+            region->mNext = mFree;
+            mFree = region;
+            mCachedBytes += region->mSize;
+        } else {
+            rt_hash_table_remove(mRegions, data);
+            memfd_region_free(region);
+        }
+    }
+    (*buffer)->setData(RT_NULL, 0);
+
+    // delete buffer wrapper
+    rt_safe_delete(*buffer);
+    *buffer = RT_NULL;
+    return RT_OK;
+}
+
+RT_RET RTAllocatorMemfd::init(RtMetaData *meta) {
+    mLock     = new RtMutex();
+    mRegions  = rt_hash_table_create_open(32, hash_ptr_mix_func, hash_ptr_compare);
+    mPageSize = (INT32)sysconf(_SC_PAGESIZE);
+    if (RT_NULL != meta) {
+        meta->findInt32(kKeyMemSeals, &mSeals);
+        meta->findInt64(kKeyMemCacheCap, &mCapBytes);
+    }
+    return RT_OK;
+}
+
+RT_RET RTAllocatorMemfd::deinit() {
+    RtMutex::RtAutolock autoLock(mLock);
+    while (RT_NULL != mFree) {
+        RtMemfdRegion *region = mFree;
+        mFree = region->mNext;
+        rt_hash_table_remove(mRegions, region->mData);
+        memfd_region_free(region);
+    }
+    mCachedBytes = 0;
+    return RT_OK;
+}
+
+void RTAllocatorMemfd::summary(INT32 fd) {
+    RtMutex::RtAutolock autoLock(mLock);
+    RT_LOGD("memfd: cached %lldKB, cap %lldKB, seals 0x%x",
+             mCachedBytes >> 10, mCapBytes >> 10, mSeals);
+}
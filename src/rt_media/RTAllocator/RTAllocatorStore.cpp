@@ -22,6 +22,8 @@
 #include "RTAllocatorDrm.h"         // NOLINT
 #include "RTAllocatorIon.h"         // NOLINT
 #include "RTAllocatorGralloc.h"     // NOLINT
+#include "RTAllocatorHugePage.h"    // NOLINT
+#include "RTAllocatorMemfd.h"       // NOLINT
 #include "RTAllocatorMalloc.h"      // NOLINT
 
 RTAllocatorStore::RTAllocatorStore() {
@@ -45,6 +47,12 @@ RT_RET RTAllocatorStore::fetchAllocator(
         case RT_ALLOC_TYPE_GRAPHIC:
             *allocator = fetchGrallocAllocator(config);
             break;
+        case RT_ALLOC_TYPE_HUGEPAGE:
+            *allocator = fetchHugePageAllocator(config);
+            break;
+        case RT_ALLOC_TYPE_MEMFD:
+            *allocator = fetchMemfdAllocator(config);
+            break;
         default:
             RT_LOGE("unsupported allocator type: %d", type);
             ret = RT_ERR_UNKNOWN;
@@ -68,6 +76,12 @@ RT_RET RTAllocatorStore::priorAvailLinearAllocator(RtMetaData* config, RTAllocat
         return ret;
     }
 
+    rt_allocator = fetchHugePageAllocator(config);
+    if (rt_allocator) {
+        *allocator = rt_allocator;
+        return ret;
+    }
+
     rt_allocator = fetchMallocAllocator(config);
     if (rt_allocator) {
         *allocator = rt_allocator;
@@ -110,6 +124,28 @@ RTAllocator* RTAllocatorStore::fetchGrallocAllocator(RtMetaData *config) {
     return allocator;
 }
 
+RTAllocator* RTAllocatorStore::fetchHugePageAllocator(RtMetaData *config) {
+    RTAllocator* allocator = RT_NULL;
+    #if OS_LINUX
+    RT_BOOL avail = RTAllocatorHugePage::checkAvail();
+    if (avail) {
+        allocator = new RTAllocatorHugePage(config);
+    }
+    #endif
+    return allocator;
+}
+
+RTAllocator* RTAllocatorStore::fetchMemfdAllocator(RtMetaData *config) {
+    RTAllocator* allocator = RT_NULL;
+    #if OS_LINUX
+    RT_BOOL avail = RTAllocatorMemfd::checkAvail();
+    if (avail) {
+        allocator = new RTAllocatorMemfd(config);
+    }
+    #endif
+    return allocator;
+}
+
 RTAllocator* RTAllocatorStore::fetchMallocAllocator(RtMetaData *config) {
     RTAllocator* allocator = NULL;
     RT_BOOL avail = RTAllocatorMalloc::checkAvail();
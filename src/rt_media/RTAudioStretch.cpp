@@ -0,0 +1,398 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * module: audio time stretch (WSOLA), tempo is changed and pitch is kept.
+ *         interleaved S16 or float pcm, not thread-safe.
+ */
+
+#include <math.h>                   // NOLINT
+#include <string.h>                 // NOLINT
+#if defined(__SSE2__)
+#include <emmintrin.h>              // NOLINT
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>               // NOLINT
+#define STRETCH_USE_NEON
+#endif
+
+#include "RTAudioStretch.h"         // NOLINT
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "RTAudioStretch"
+
+#ifdef DEBUG_FLAG
+#undef DEBUG_FLAG
+#endif
+#define DEBUG_FLAG 0x0
+
+/*
+ * each output sequence is mixed with the previous one over overlap, the
+ * position of sequence in input is searched around its nominal position.
+ */
+#define STRETCH_SEQUENCE_MS         40
+#define STRETCH_OVERLAP_MS          10
+#define STRETCH_SEEK_MS             15
+#define STRETCH_COARSE_STEP         4
+
+/*
+ * samples are halved before multiplying, so that a pair of products never
+ * overflows 32 bits. sums are kept in float, only their ratio is used.
+ */
+static void stretch_corr_s16(const INT16 *ref, const INT16 *cmp, INT32 count,
+                             float *corr, float *norm) {
+    INT32 idx = 0;
+    float sumCorr = 0.0f;
+    float sumNorm = 0.0f;
+#if defined(__SSE2__)
+    __m128 accCorr = _mm_setzero_ps();
+    __m128 accNorm = _mm_setzero_ps();
+    for (; idx + 8 <= count; idx += 8) {
+        __m128i a = _mm_srai_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ref + idx)), 1);
+        __m128i b = _mm_srai_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(cmp + idx)), 1);
+        accCorr = _mm_add_ps(accCorr, _mm_cvtepi32_ps(_mm_madd_epi16(a, b)));
+        accNorm = _mm_add_ps(accNorm, _mm_cvtepi32_ps(_mm_madd_epi16(b, b)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, accCorr);
+    sumCorr = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm_storeu_ps(lanes, accNorm);
+    sumNorm = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(STRETCH_USE_NEON)
+    float32x4_t accCorr = vdupq_n_f32(0.0f);
+    float32x4_t accNorm = vdupq_n_f32(0.0f);
+    for (; idx + 8 <= count; idx += 8) {
+        int16x8_t a = vshrq_n_s16(vld1q_s16(ref + idx), 1);
+        int16x8_t b = vshrq_n_s16(vld1q_s16(cmp + idx), 1);
+        int32x4_t c = vmull_s16(vget_low_s16(a), vget_low_s16(b));
+        int32x4_t n = vmull_s16(vget_low_s16(b), vget_low_s16(b));
+        c = vmlal_s16(c, vget_high_s16(a), vget_high_s16(b));
+        n = vmlal_s16(n, vget_high_s16(b), vget_high_s16(b));
+        accCorr = vaddq_f32(accCorr, vcvtq_f32_s32(c));
+        accNorm = vaddq_f32(accNorm, vcvtq_f32_s32(n));
+    }
+    sumCorr = vgetq_lane_f32(accCorr, 0) + vgetq_lane_f32(accCorr, 1)
+            + vgetq_lane_f32(accCorr, 2) + vgetq_lane_f32(accCorr, 3);
+    sumNorm = vgetq_lane_f32(accNorm, 0) + vgetq_lane_f32(accNorm, 1)
+            + vgetq_lane_f32(accNorm, 2) + vgetq_lane_f32(accNorm, 3);
+#endif
+    for (; idx < count; idx++) {
+        INT32 a = ref[idx] >> 1;
+        INT32 b = cmp[idx] >> 1;
+        sumCorr += static_cast<float>(a * b);
+        sumNorm += static_cast<float>(b * b);
+    }
+    *corr = sumCorr;
+    *norm = sumNorm;
+}
+
+static void stretch_corr_flt(const float *ref, const float *cmp, INT32 count,
+                             float *corr, float *norm) {
+    INT32 idx = 0;
+    float sumCorr = 0.0f;
+    float sumNorm = 0.0f;
+#if defined(__SSE2__)
+    __m128 accCorr = _mm_setzero_ps();
+    __m128 accNorm = _mm_setzero_ps();
+    for (; idx + 4 <= count; idx += 4) {
+        __m128 a = _mm_loadu_ps(ref + idx);
+        __m128 b = _mm_loadu_ps(cmp + idx);
+        accCorr = _mm_add_ps(accCorr, _mm_mul_ps(a, b));
+        accNorm = _mm_add_ps(accNorm, _mm_mul_ps(b, b));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, accCorr);
+    sumCorr = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm_storeu_ps(lanes, accNorm);
+    sumNorm = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(STRETCH_USE_NEON)
+    float32x4_t accCorr = vdupq_n_f32(0.0f);
+    float32x4_t accNorm = vdupq_n_f32(0.0f);
+    for (; idx + 4 <= count; idx += 4) {
+        float32x4_t a = vld1q_f32(ref + idx);
+        float32x4_t b = vld1q_f32(cmp + idx);
+        accCorr = vmlaq_f32(accCorr, a, b);
+        accNorm = vmlaq_f32(accNorm, b, b);
+    }
+    sumCorr = vgetq_lane_f32(accCorr, 0) + vgetq_lane_f32(accCorr, 1)
+            + vgetq_lane_f32(accCorr, 2) + vgetq_lane_f32(accCorr, 3);
+    sumNorm = vgetq_lane_f32(accNorm, 0) + vgetq_lane_f32(accNorm, 1)
+            + vgetq_lane_f32(accNorm, 2) + vgetq_lane_f32(accNorm, 3);
+#endif
+    for (; idx < count; idx++) {
+        sumCorr += ref[idx] * cmp[idx];
+        sumNorm += cmp[idx] * cmp[idx];
+    }
+    *corr = sumCorr;
+    *norm = sumNorm;
+}
+
+/*
+ * keeps [head, tail) of buffer, and makes room for bytes after tail.
+ */
+static UINT8* stretch_reserve(UINT8 **buf, INT32 *capacity, INT32 *head, INT32 *tail, INT32 bytes) {
+    INT32 used = *tail - *head;
+    if (*capacity - *tail >= bytes) {
+        return *buf + *tail;
+    }
+    if (*capacity - used >= bytes) {
+        memmove(*buf, *buf + *head, used);
+    } else {
+        INT32  size  = RT_MAX(*capacity * 2, used + bytes);
+        UINT8 *large = rt_malloc_size(UINT8, size);
+        RT_ASSERT(RT_NULL != large);
+        rt_memcpy(large, *buf + *head, used);
+        rt_safe_free(*buf);
+        *buf      = large;
+        *capacity = size;
+    }
+    *head = 0;
+    *tail = used;
+    return *buf + *tail;
+}
+
+RTAudioStretch::RTAudioStretch(INT32 sampleRate, INT32 channels, RTSampleFormat format)
+        : mSampleRate(sampleRate),
+          mChannels(channels),
+          mFormat(format),
+          mRate(1.0f),
+          mInputHead(0),
+          mInputTail(0),
+          mInputPtsUs(0ll),
+          mOutputHead(0),
+          mOutputTail(0),
+          mOutputPtsUs(0ll),
+          mOverlapValid(RT_FALSE),
+          mSkipFraction(0.0) {
+    if ((RT_SAMPLE_FMT_S16 != format) && (RT_SAMPLE_FMT_FLT != format)) {
+        RT_LOGE("sample format(%d) isn't supported, pcm is copied as it is", format);
+    }
+    mFrameBytes    = channels * ((RT_SAMPLE_FMT_FLT == format) ? sizeof(float) : sizeof(INT16));
+    mSeqFrames     = sampleRate * STRETCH_SEQUENCE_MS / 1000;
+    mOverlapFrames = sampleRate * STRETCH_OVERLAP_MS / 1000;
+    mSeekFrames    = sampleRate * STRETCH_SEEK_MS / 1000;
+
+    mInputCapacity  = (mSeekFrames + mSeqFrames) * mFrameBytes * 4;
+    mOutputCapacity = mSeqFrames * mFrameBytes * 4;
+    mInput   = rt_malloc_size(UINT8, mInputCapacity);
+    mOutput  = rt_malloc_size(UINT8, mOutputCapacity);
+    mOverlap = rt_malloc_size(UINT8, mOverlapFrames * mFrameBytes);
+    RT_ASSERT((RT_NULL != mInput) && (RT_NULL != mOutput) && (RT_NULL != mOverlap));
+
+    RTObject::trace(getName(), this, sizeof(RTAudioStretch));
+}
+
+RTAudioStretch::~RTAudioStretch() {
+    rt_safe_free(mInput);
+    rt_safe_free(mOutput);
+    rt_safe_free(mOverlap);
+    RTObject::untrace(getName(), this);
+}
+
+RT_RET RTAudioStretch::setRate(float rate) {
+    if ((rate < AUDIO_STRETCH_MIN_RATE) || (rate > AUDIO_STRETCH_MAX_RATE)) {
+        RT_LOGE("rate(%.2f) is out of [%.1f, %.1f]", rate, AUDIO_STRETCH_MIN_RATE, AUDIO_STRETCH_MAX_RATE);
+        return RT_ERR_VALUE;
+    }
+    mRate = rate;
+    return RT_OK;
+}
+
+float RTAudioStretch::getRate() {
+    return mRate;
+}
+
+RT_BOOL RTAudioStretch::isCompatible(INT32 sampleRate, INT32 channels, RTSampleFormat format) {
+    return ((sampleRate == mSampleRate) && (channels == mChannels) && (format == mFormat))
+             ? RT_TRUE : RT_FALSE;
+}
+
+RT_RET RTAudioStretch::queueInput(const void *data, INT32 bytes, INT64 ptsUs) {
+    if ((RT_NULL == data) || (bytes <= 0)) {
+        return RT_ERR_VALUE;
+    }
+    if (mInputHead == mInputTail) {
+        mInputPtsUs = ptsUs;
+    }
+    UINT8 *dst = stretch_reserve(&mInput, &mInputCapacity, &mInputHead, &mInputTail, bytes);
+    rt_memcpy(dst, data, bytes);
+    mInputTail += bytes;
+    process();
+    return RT_OK;
+}
+
+INT32 RTAudioStretch::readOutput(void *data, INT32 bytes) {
+    INT32 size = RT_MIN(bytes, mOutputTail - mOutputHead);
+    size -= size % mFrameBytes;
+    if (size <= 0) {
+        return 0;
+    }
+    rt_memcpy(data, mOutput + mOutputHead, size);
+    mOutputHead  += size;
+    mOutputPtsUs += (INT64)((size / mFrameBytes) * 1000000.0 * mRate / mSampleRate);
+    return size;
+}
+
+INT32 RTAudioStretch::availableOutput() {
+    return mOutputTail - mOutputHead;
+}
+
+INT32 RTAudioStretch::pendingInput() {
+    return mInputTail - mInputHead;
+}
+
+INT64 RTAudioStretch::getOutputPts() {
+    return mOutputPtsUs;
+}
+
+void RTAudioStretch::flush() {
+    mInputHead    = mInputTail  = 0;
+    mOutputHead   = mOutputTail = 0;
+    mOverlapValid = RT_FALSE;
+    mSkipFraction = 0.0;
+}
+
+void RTAudioStretch::summary(INT32 fd) {
+    RT_LOGD("rate: %.2f, format: %d, %d Hz, %d channels, input: %d bytes, output: %d bytes",
+             mRate, mFormat, mSampleRate, mChannels, pendingInput(), availableOutput());
+}
+
+UINT8* RTAudioStretch::reserveOutput(INT32 bytes) {
+    if (mOutputHead == mOutputTail) {
+        mOutputPtsUs = mInputPtsUs;
+    }
+    return stretch_reserve(&mOutput, &mOutputCapacity, &mOutputHead, &mOutputTail, bytes);
+}
+
+float RTAudioStretch::correlate(const UINT8 *input) {
+    float corr  = 0.0f;
+    float norm  = 0.0f;
+    INT32 count = mOverlapFrames * mChannels;
+    if (RT_SAMPLE_FMT_FLT == mFormat) {
+        stretch_corr_flt(reinterpret_cast<const float *>(mOverlap),
+                         reinterpret_cast<const float *>(input), count, &corr, &norm);
+    } else {
+        stretch_corr_s16(reinterpret_cast<const INT16 *>(mOverlap),
+                         reinterpret_cast<const INT16 *>(input), count, &corr, &norm);
+    }
+    return corr / sqrtf(norm + 1.0f);
+}
+
+/*
+ * coarse search on every STRETCH_COARSE_STEP frames, then fine search
+ * around the best one.
+ */
+INT32 RTAudioStretch::seekBestOffset(const UINT8 *input) {
+    INT32 best     = 0;
+    float bestCorr = correlate(input);
+    for (INT32 offset = STRETCH_COARSE_STEP; offset < mSeekFrames; offset += STRETCH_COARSE_STEP) {
+        float corr = correlate(input + offset * mFrameBytes);
+        if (corr > bestCorr) {
+            bestCorr = corr;
+            best     = offset;
+        }
+    }
+    INT32 start = RT_MAX(best - STRETCH_COARSE_STEP + 1, 0);
+    INT32 end   = RT_MIN(best + STRETCH_COARSE_STEP, mSeekFrames);
+    INT32 found = best;
+    for (INT32 offset = start; offset < end; offset++) {
+        if (offset == best) {
+            continue;
+        }
+        float corr = correlate(input + offset * mFrameBytes);
+        if (corr > bestCorr) {
+            bestCorr = corr;
+            found    = offset;
+        }
+    }
+    return found;
+}
+
+void RTAudioStretch::overlapMix(const UINT8 *input, UINT8 *output) {
+    float scale = 1.0f / mOverlapFrames;
+    if (RT_SAMPLE_FMT_FLT == mFormat) {
+        const float *prev = reinterpret_cast<const float *>(mOverlap);
+        const float *next = reinterpret_cast<const float *>(input);
+        float       *dst  = reinterpret_cast<float *>(output);
+        for (INT32 frame = 0; frame < mOverlapFrames; frame++) {
+            float weight = frame * scale;
+            for (INT32 ch = 0; ch < mChannels; ch++, prev++, next++, dst++) {
+                *dst = *prev + (*next - *prev) * weight;
+            }
+        }
+        return;
+    }
+
+    const INT16 *prev = reinterpret_cast<const INT16 *>(mOverlap);
+    const INT16 *next = reinterpret_cast<const INT16 *>(input);
+    INT16       *dst  = reinterpret_cast<INT16 *>(output);
+    for (INT32 frame = 0; frame < mOverlapFrames; frame++) {
+        float weight = frame * scale;
+        for (INT32 ch = 0; ch < mChannels; ch++, prev++, next++, dst++) {
+            *dst = (INT16)(*prev + (*next - *prev) * weight);
+        }
+    }
+}
+
+void RTAudioStretch::process() {
+    INT32 fb = mFrameBytes;
+    if ((1.0f == mRate) || ((RT_SAMPLE_FMT_S16 != mFormat) && (RT_SAMPLE_FMT_FLT != mFormat))) {
+        if (mOverlapValid) {
+            // tail of last sequence is mixed into input, then input is copied
+            if (mInputTail - mInputHead < (mSeekFrames + mOverlapFrames) * fb) {
+                return;
+            }
+            INT32 offset = seekBestOffset(mInput + mInputHead);
+            overlapMix(mInput + mInputHead + offset * fb, reserveOutput(mOverlapFrames * fb));
+            mOutputTail  += mOverlapFrames * fb;
+            mInputHead   += (offset + mOverlapFrames) * fb;
+            mInputPtsUs  += (offset + mOverlapFrames) * 1000000ll / mSampleRate;
+            mOverlapValid = RT_FALSE;
+        }
+        INT32 bytes   = mInputTail - mInputHead;
+        rt_memcpy(reserveOutput(bytes), mInput + mInputHead, bytes);
+        mOutputTail  += bytes;
+        mInputPtsUs  += (bytes / fb) * 1000000ll / mSampleRate;
+        mInputHead    = mInputTail = 0;
+        mSkipFraction = 0.0;
+        return;
+    }
+
+    INT32 seqBytes = (mSeqFrames - mOverlapFrames) * fb;
+    INT32 needed   = (mSeekFrames + mSeqFrames) * fb;
+    while (mInputTail - mInputHead >= needed) {
+        const UINT8 *input  = mInput + mInputHead;
+        UINT8       *output = reserveOutput(seqBytes);
+        INT32        offset = 0;
+        if (!mOverlapValid) {
+            rt_memcpy(output, input, seqBytes);
+        } else {
+            offset = seekBestOffset(input);
+            overlapMix(input + offset * fb, output);
+            rt_memcpy(output + mOverlapFrames * fb, input + (offset + mOverlapFrames) * fb,
+                      (mSeqFrames - 2 * mOverlapFrames) * fb);
+        }
+        rt_memcpy(mOverlap, input + (offset + mSeqFrames - mOverlapFrames) * fb, mOverlapFrames * fb);
+        mOverlapValid = RT_TRUE;
+        mOutputTail  += seqBytes;
+
+        // input moves rate times of output, fraction is carried to next sequence
+        mSkipFraction += (double)mRate * (mSeqFrames - mOverlapFrames);
+        INT32 skip     = (INT32)mSkipFraction;
+        mSkipFraction -= skip;
+        mInputHead    += skip * fb;
+        mInputPtsUs   += skip * 1000000ll / mSampleRate;
+    }
+}
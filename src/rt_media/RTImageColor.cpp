@@ -0,0 +1,438 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * module: colour conversion of yuv420 to rgb, kernels of simd are picked
+ *         by features of cpu, results are the same as the scalar one.
+ */
+
+#if defined(__SSE2__)
+#include <emmintrin.h>              // NOLINT
+#if defined(__GNUC__)
+#include <immintrin.h>              // NOLINT
+#define COLOR_USE_AVX2
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>               // NOLINT
+#define COLOR_USE_NEON
+#endif
+#include <string.h>                 // NOLINT
+
+#include "RTImageColor.h"           // NOLINT
+#include "rt_cpu_info.h"            // NOLINT
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "RTImageColor"
+
+#ifdef DEBUG_FLAG
+#undef DEBUG_FLAG
+#endif
+#define DEBUG_FLAG 0x0
+
+/*
+ * coefficients are Q13, so that products of two int16 fit in madd of simd.
+ * every kernel rounds and clips the same int32 sum, results are bit-exact.
+ */
+#define COLOR_SHIFT         13
+#define COLOR_ROUND         (1 << (COLOR_SHIFT - 1))
+#define COLOR_FEATURES_NONE 0xffffffff
+
+typedef struct _ColorCoef {
+    INT32   mYOffset;
+    INT32   mY;
+    INT32   mRV;        // v to r
+    INT32   mGU;        // u to g, subtracted
+    INT32   mGV;        // v to g, subtracted
+    INT32   mBU;        // u to b
+} ColorCoef;
+
+// [BT.601, BT.709] x [limited, full]
+static const ColorCoef gColorCoefs[2][2] = {
+    { { 16, 9539, 13075, 3209, 6660, 16525 }, { 0, 8192, 11485, 2819, 5850, 14516 } },
+    { { 16, 9539, 14686, 1747, 4366, 17305 }, { 0, 8192, 12901, 1535, 3835, 15201 } },
+};
+
+// features of cpu which kernels may use, checked at the first conversion
+static UINT32 gColorFeatures = COLOR_FEATURES_NONE;
+
+/*
+ * kernel of simd converts pixels of row in steps, and returns the number of
+ * converted pixels. the rest is done by the scalar one.
+ * step is distance of chroma samples, 1 for planar and 2 for interleaved.
+ */
+typedef INT32 (*COLOR_ROW_FUNC)(const UINT8 *y, const UINT8 *u, const UINT8 *v, INT32 step,
+                                UINT8 *dst, INT32 width, const ColorCoef *coef, RTImageRGBFormat format);
+
+static inline UINT8 color_clip(INT32 value) {
+    value = (value + COLOR_ROUND) >> COLOR_SHIFT;
+    return (UINT8)((value < 0) ? 0 : ((value > 255) ? 255 : value));
+}
+
+static void color_row_c(const UINT8 *y, const UINT8 *u, const UINT8 *v, INT32 step, UINT8 *dst,
+                        INT32 x, INT32 width, const ColorCoef *coef, RTImageRGBFormat format) {
+    INT32 bpp = (RT_IMAGE_RGB24 == format) ? 3 : 4;
+    INT32 ri  = (RT_IMAGE_BGRA32 == format) ? 2 : 0;
+    INT32 bi  = 2 - ri;
+    for (; x < width; x++) {
+        INT32  luma  = coef->mY * (y[x] - coef->mYOffset);
+        INT32  cu    = u[(x >> 1) * step] - 128;
+        INT32  cv    = v[(x >> 1) * step] - 128;
+        UINT8 *pixel = dst + x * bpp;
+        pixel[ri] = color_clip(luma + coef->mRV * cv);
+        pixel[1]  = color_clip(luma - coef->mGU * cu - coef->mGV * cv);
+        pixel[bi] = color_clip(luma + coef->mBU * cu);
+        if (4 == bpp) {
+            pixel[3] = 0xff;
+        }
+    }
+}
+
+#if defined(__SSE2__)
+// pairs of int16 for madd: (y, v), (y, u), (u, 0)...
+typedef struct _ColorCoefSSE2 {
+    __m128i mYOffset;
+    __m128i mRV;
+    __m128i mGU;
+    __m128i mGV;
+    __m128i mBU;
+    __m128i mBias;
+    __m128i mRound;
+} ColorCoefSSE2;
+
+static inline void color_coef_sse2(const ColorCoef *coef, ColorCoefSSE2 *k) {
+    k->mYOffset = _mm_set1_epi16(coef->mYOffset);
+    k->mRV      = _mm_set_epi16(coef->mRV, coef->mY, coef->mRV, coef->mY,
+                                coef->mRV, coef->mY, coef->mRV, coef->mY);
+    k->mGU      = _mm_set_epi16(-coef->mGU, coef->mY, -coef->mGU, coef->mY,
+                                -coef->mGU, coef->mY, -coef->mGU, coef->mY);
+    k->mGV      = _mm_set_epi16(0, -coef->mGV, 0, -coef->mGV, 0, -coef->mGV, 0, -coef->mGV);
+    k->mBU      = _mm_set_epi16(coef->mBU, coef->mY, coef->mBU, coef->mY,
+                                coef->mBU, coef->mY, coef->mBU, coef->mY);
+    k->mBias    = _mm_set1_epi16(128);
+    k->mRound   = _mm_set1_epi32(COLOR_ROUND);
+}
+
+static inline __m128i color_pack_sse2(__m128i lo, __m128i hi, __m128i round) {
+    return _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(lo, round), COLOR_SHIFT),
+                           _mm_srai_epi32(_mm_add_epi32(hi, round), COLOR_SHIFT));
+}
+
+// 8 pixels of int16, chroma is biased and duplicated for each pixel
+static inline void color_calc_sse2(__m128i y, __m128i u, __m128i v, const ColorCoefSSE2 *k,
+                                   __m128i *r, __m128i *g, __m128i *b) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i yvLo = _mm_unpacklo_epi16(y, v);
+    __m128i yvHi = _mm_unpackhi_epi16(y, v);
+    __m128i yuLo = _mm_unpacklo_epi16(y, u);
+    __m128i yuHi = _mm_unpackhi_epi16(y, u);
+    __m128i v0Lo = _mm_unpacklo_epi16(v, zero);
+    __m128i v0Hi = _mm_unpackhi_epi16(v, zero);
+    *r = color_pack_sse2(_mm_madd_epi16(yvLo, k->mRV), _mm_madd_epi16(yvHi, k->mRV), k->mRound);
+    *g = color_pack_sse2(_mm_add_epi32(_mm_madd_epi16(yuLo, k->mGU), _mm_madd_epi16(v0Lo, k->mGV)),
+                         _mm_add_epi32(_mm_madd_epi16(yuHi, k->mGU), _mm_madd_epi16(v0Hi, k->mGV)),
+                         k->mRound);
+    *b = color_pack_sse2(_mm_madd_epi16(yuLo, k->mBU), _mm_madd_epi16(yuHi, k->mBU), k->mRound);
+}
+
+// chroma of 16 pixels, 8 samples of int16 which are not biased
+static inline void color_load_chroma_sse2(const UINT8 *u, const UINT8 *v, INT32 step,
+                                          __m128i *cu, __m128i *cv) {
+    if (1 == step) {
+        const __m128i zero = _mm_setzero_si128();
+        *cu = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(u)), zero);
+        *cv = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(v)), zero);
+        return;
+    }
+    // interleaved, sample at lower address is the even byte
+    __m128i uv   = _mm_loadu_si128(reinterpret_cast<const __m128i *>(RT_MIN(u, v)));
+    __m128i even = _mm_and_si128(uv, _mm_set1_epi16(0x00ff));
+    __m128i odd  = _mm_srli_epi16(uv, 8);
+    *cu = (u < v) ? even : odd;
+    *cv = (u < v) ? odd : even;
+}
+
+// 16 pixels of uint8 in each channel
+static inline void color_store_sse2(__m128i r, __m128i g, __m128i b, UINT8 *dst, RTImageRGBFormat format) {
+    __m128i c0    = (RT_IMAGE_BGRA32 == format) ? b : r;
+    __m128i c2    = (RT_IMAGE_BGRA32 == format) ? r : b;
+    __m128i alpha = _mm_set1_epi8(-1);
+    __m128i lo01  = _mm_unpacklo_epi8(c0, g);
+    __m128i hi01  = _mm_unpackhi_epi8(c0, g);
+    __m128i lo23  = _mm_unpacklo_epi8(c2, alpha);
+    __m128i hi23  = _mm_unpackhi_epi8(c2, alpha);
+    __m128i px[4] = { _mm_unpacklo_epi16(lo01, lo23), _mm_unpackhi_epi16(lo01, lo23),
+                      _mm_unpacklo_epi16(hi01, hi23), _mm_unpackhi_epi16(hi01, hi23) };
+    if (RT_IMAGE_RGB24 != format) {
+        for (INT32 idx = 0; idx < 4; idx++) {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 16 * idx), px[idx]);
+        }
+        return;
+    }
+    // no shuffle of bytes in sse2, alpha is dropped by copy
+    UINT8 rgba[64];
+    for (INT32 idx = 0; idx < 4; idx++) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(rgba + 16 * idx), px[idx]);
+    }
+    for (INT32 idx = 0; idx < 16; idx++) {
+        memcpy(dst + 3 * idx, rgba + 4 * idx, 3);
+    }
+}
+
+static INT32 color_row_sse2(const UINT8 *y, const UINT8 *u, const UINT8 *v, INT32 step,
+                            UINT8 *dst, INT32 width, const ColorCoef *coef, RTImageRGBFormat format) {
+    const __m128i zero = _mm_setzero_si128();
+    INT32 bpp = (RT_IMAGE_RGB24 == format) ? 3 : 4;
+    ColorCoefSSE2 k;
+    color_coef_sse2(coef, &k);
+
+    INT32 x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i y8   = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x));
+        __m128i yLo  = _mm_sub_epi16(_mm_unpacklo_epi8(y8, zero), k.mYOffset);
+        __m128i yHi  = _mm_sub_epi16(_mm_unpackhi_epi8(y8, zero), k.mYOffset);
+        __m128i cu, cv;
+        color_load_chroma_sse2(u + (x >> 1) * step, v + (x >> 1) * step, step, &cu, &cv);
+        cu = _mm_sub_epi16(cu, k.mBias);
+        cv = _mm_sub_epi16(cv, k.mBias);
+
+        __m128i rLo, gLo, bLo, rHi, gHi, bHi;
+        color_calc_sse2(yLo, _mm_unpacklo_epi16(cu, cu), _mm_unpacklo_epi16(cv, cv), &k, &rLo, &gLo, &bLo);
+        color_calc_sse2(yHi, _mm_unpackhi_epi16(cu, cu), _mm_unpackhi_epi16(cv, cv), &k, &rHi, &gHi, &bHi);
+        color_store_sse2(_mm_packus_epi16(rLo, rHi), _mm_packus_epi16(gLo, gHi),
+                         _mm_packus_epi16(bLo, bHi), dst + x * bpp, format);
+    }
+    return x;
+}
+#endif  // __SSE2__
+
+#if defined(COLOR_USE_AVX2)
+// int16 of 16 pixels to uint8, lanes of avx2 are in order after pack of 32 bits
+__attribute__((target("avx2")))
+static inline __m128i color_narrow_avx2(__m256i lo, __m256i hi, __m256i round) {
+    __m256i value = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(lo, round), COLOR_SHIFT),
+                                       _mm256_srai_epi32(_mm256_add_epi32(hi, round), COLOR_SHIFT));
+    return _mm_packus_epi16(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1));
+}
+
+// 16 pixels of rgb24 by shuffle of bytes, 48 bytes are written without overrun
+__attribute__((target("avx2")))
+static inline void color_store_rgb24_avx2(__m128i r, __m128i g, __m128i b, UINT8 *dst) {
+    const __m128i drop  = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    __m128i rg    = _mm_unpacklo_epi8(r, g);
+    __m128i rgHi  = _mm_unpackhi_epi8(r, g);
+    __m128i bz    = _mm_unpacklo_epi8(b, b);
+    __m128i bzHi  = _mm_unpackhi_epi8(b, b);
+    __m128i p0    = _mm_shuffle_epi8(_mm_unpacklo_epi16(rg,   bz),   drop);
+    __m128i p1    = _mm_shuffle_epi8(_mm_unpackhi_epi16(rg,   bz),   drop);
+    __m128i p2    = _mm_shuffle_epi8(_mm_unpacklo_epi16(rgHi, bzHi), drop);
+    __m128i p3    = _mm_shuffle_epi8(_mm_unpackhi_epi16(rgHi, bzHi), drop);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst),
+                     _mm_or_si128(p0, _mm_slli_si128(p1, 12)));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 16),
+                     _mm_or_si128(_mm_srli_si128(p1, 4), _mm_slli_si128(p2, 8)));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 32),
+                     _mm_or_si128(_mm_srli_si128(p2, 8), _mm_slli_si128(p3, 4)));
+}
+
+__attribute__((target("avx2")))
+static INT32 color_row_avx2(const UINT8 *y, const UINT8 *u, const UINT8 *v, INT32 step,
+                            UINT8 *dst, INT32 width, const ColorCoef *coef, RTImageRGBFormat format) {
+    INT32 bpp = (RT_IMAGE_RGB24 == format) ? 3 : 4;
+    ColorCoefSSE2 k;
+    color_coef_sse2(coef, &k);
+    const __m256i zero  = _mm256_setzero_si256();
+    const __m256i yOff  = _mm256_broadcastsi128_si256(k.mYOffset);
+    const __m256i kRV   = _mm256_broadcastsi128_si256(k.mRV);
+    const __m256i kGU   = _mm256_broadcastsi128_si256(k.mGU);
+    const __m256i kGV   = _mm256_broadcastsi128_si256(k.mGV);
+    const __m256i kBU   = _mm256_broadcastsi128_si256(k.mBU);
+    const __m256i round = _mm256_set1_epi32(COLOR_ROUND);
+
+    INT32 x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m256i luma = _mm256_sub_epi16(_mm256_cvtepu8_epi16(
+                           _mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x))), yOff);
+        __m128i cu, cv;
+        color_load_chroma_sse2(u + (x >> 1) * step, v + (x >> 1) * step, step, &cu, &cv);
+        cu = _mm_sub_epi16(cu, k.mBias);
+        cv = _mm_sub_epi16(cv, k.mBias);
+        __m256i cu16 = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi16(cu, cu)),
+                                               _mm_unpackhi_epi16(cu, cu), 1);
+        __m256i cv16 = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi16(cv, cv)),
+                                               _mm_unpackhi_epi16(cv, cv), 1);
+
+        // lo has pixels 0-3 and 8-11, hi has pixels 4-7 and 12-15
+        __m256i yvLo = _mm256_unpacklo_epi16(luma, cv16);
+        __m256i yvHi = _mm256_unpackhi_epi16(luma, cv16);
+        __m256i yuLo = _mm256_unpacklo_epi16(luma, cu16);
+        __m256i yuHi = _mm256_unpackhi_epi16(luma, cu16);
+        __m256i v0Lo = _mm256_unpacklo_epi16(cv16, zero);
+        __m256i v0Hi = _mm256_unpackhi_epi16(cv16, zero);
+        __m128i r = color_narrow_avx2(_mm256_madd_epi16(yvLo, kRV), _mm256_madd_epi16(yvHi, kRV), round);
+        __m128i g = color_narrow_avx2(
+                        _mm256_add_epi32(_mm256_madd_epi16(yuLo, kGU), _mm256_madd_epi16(v0Lo, kGV)),
+                        _mm256_add_epi32(_mm256_madd_epi16(yuHi, kGU), _mm256_madd_epi16(v0Hi, kGV)), round);
+        __m128i b = color_narrow_avx2(_mm256_madd_epi16(yuLo, kBU), _mm256_madd_epi16(yuHi, kBU), round);
+        if (RT_IMAGE_RGB24 == format) {
+            color_store_rgb24_avx2(r, g, b, dst + x * bpp);
+        } else {
+            color_store_sse2(r, g, b, dst + x * bpp, format);
+        }
+    }
+    return x;
+}
+#endif  // COLOR_USE_AVX2
+
+#if defined(COLOR_USE_NEON)
+// 8 pixels of int16, chroma is biased and duplicated for each pixel
+static inline void color_calc_neon(int16x8_t y, int16x8_t u, int16x8_t v, const ColorCoef *coef,
+                                   uint8x8_t *r, uint8x8_t *g, uint8x8_t *b) {
+    int32x4_t lumaLo = vmull_n_s16(vget_low_s16(y),  coef->mY);
+    int32x4_t lumaHi = vmull_n_s16(vget_high_s16(y), coef->mY);
+    int32x4_t rLo = vmlal_n_s16(lumaLo, vget_low_s16(v),  coef->mRV);
+    int32x4_t rHi = vmlal_n_s16(lumaHi, vget_high_s16(v), coef->mRV);
+    int32x4_t gLo = vmlsl_n_s16(vmlsl_n_s16(lumaLo, vget_low_s16(u),  coef->mGU), vget_low_s16(v),  coef->mGV);
+    int32x4_t gHi = vmlsl_n_s16(vmlsl_n_s16(lumaHi, vget_high_s16(u), coef->mGU), vget_high_s16(v), coef->mGV);
+    int32x4_t bLo = vmlal_n_s16(lumaLo, vget_low_s16(u),  coef->mBU);
+    int32x4_t bHi = vmlal_n_s16(lumaHi, vget_high_s16(u), coef->mBU);
+    *r = vqmovun_s16(vcombine_s16(vqrshrn_n_s32(rLo, COLOR_SHIFT), vqrshrn_n_s32(rHi, COLOR_SHIFT)));
+    *g = vqmovun_s16(vcombine_s16(vqrshrn_n_s32(gLo, COLOR_SHIFT), vqrshrn_n_s32(gHi, COLOR_SHIFT)));
+    *b = vqmovun_s16(vcombine_s16(vqrshrn_n_s32(bLo, COLOR_SHIFT), vqrshrn_n_s32(bHi, COLOR_SHIFT)));
+}
+
+static INT32 color_row_neon(const UINT8 *y, const UINT8 *u, const UINT8 *v, INT32 step,
+                            UINT8 *dst, INT32 width, const ColorCoef *coef, RTImageRGBFormat format) {
+    const uint8x8_t yOff = vdup_n_u8((UINT8)coef->mYOffset);
+    const uint8x8_t bias = vdup_n_u8(128);
+    INT32 bpp = (RT_IMAGE_RGB24 == format) ? 3 : 4;
+
+    INT32 x = 0;
+    for (; x + 16 <= width; x += 16) {
+        uint8x16_t y8 = vld1q_u8(y + x);
+        uint8x8_t  u8, v8;
+        if (1 == step) {
+            u8 = vld1_u8(u + (x >> 1));
+            v8 = vld1_u8(v + (x >> 1));
+        } else {
+            uint8x8x2_t uv = vld2_u8(RT_MIN(u, v) + x);
+            u8 = (u < v) ? uv.val[0] : uv.val[1];
+            v8 = (u < v) ? uv.val[1] : uv.val[0];
+        }
+        // wrapped differences of uint8 are right values of int16
+        int16x8x2_t cu  = vzipq_s16(vreinterpretq_s16_u16(vsubl_u8(u8, bias)),
+                                    vreinterpretq_s16_u16(vsubl_u8(u8, bias)));
+        int16x8x2_t cv  = vzipq_s16(vreinterpretq_s16_u16(vsubl_u8(v8, bias)),
+                                    vreinterpretq_s16_u16(vsubl_u8(v8, bias)));
+        int16x8_t   yLo = vreinterpretq_s16_u16(vsubl_u8(vget_low_u8(y8),  yOff));
+        int16x8_t   yHi = vreinterpretq_s16_u16(vsubl_u8(vget_high_u8(y8), yOff));
+
+        uint8x8_t rLo, gLo, bLo, rHi, gHi, bHi;
+        color_calc_neon(yLo, cu.val[0], cv.val[0], coef, &rLo, &gLo, &bLo);
+        color_calc_neon(yHi, cu.val[1], cv.val[1], coef, &rHi, &gHi, &bHi);
+        uint8x16_t r = vcombine_u8(rLo, rHi);
+        uint8x16_t g = vcombine_u8(gLo, gHi);
+        uint8x16_t b = vcombine_u8(bLo, bHi);
+        if (RT_IMAGE_RGB24 == format) {
+            uint8x16x3_t px = { { r, g, b } };
+            vst3q_u8(dst + x * bpp, px);
+        } else {
+            uint8x16x4_t px = { { (RT_IMAGE_BGRA32 == format) ? b : r, g,
+                                  (RT_IMAGE_BGRA32 == format) ? r : b, vdupq_n_u8(0xff) } };
+            vst4q_u8(dst + x * bpp, px);
+        }
+    }
+    return x;
+}
+#endif  // COLOR_USE_NEON
+
+static COLOR_ROW_FUNC color_pick_row(UINT32 features) {
+#if defined(COLOR_USE_AVX2)
+    if (features & RT_CPU_FEATURE_AVX2) {
+        return color_row_avx2;
+    }
+#endif
+#if defined(__SSE2__)
+    if (features & RT_CPU_FEATURE_SSE2) {
+        return color_row_sse2;
+    }
+#endif
+#if defined(COLOR_USE_NEON)
+    if (features & RT_CPU_FEATURE_NEON) {
+        return color_row_neon;
+    }
+#endif
+    return RT_NULL;
+}
+
+UINT32 rt_image_color_set_features(UINT32 mask) {
+    UINT32 used = (COLOR_FEATURES_NONE == gColorFeatures) ? rt_cpu_features() : gColorFeatures;
+    gColorFeatures = rt_cpu_features() & mask;
+    return used;
+}
+
+RT_RET rt_image_yuv_to_rgb(const RTImageYUV *src, UINT8 *dst, INT32 dstStride, RTImageRGBFormat dstFormat,
+                           RTColorSpace space, RTColorRange range) {
+    if ((RT_NULL == src) || (RT_NULL == dst) || (src->mWidth <= 0) || (src->mHeight <= 0)) {
+        return RT_ERR_VALUE;
+    }
+    INT32 bpp = (RT_IMAGE_RGB24 == dstFormat) ? 3 : 4;
+    if (dstStride < src->mWidth * bpp) {
+        RT_LOGE("stride(%d) is less than width(%d) of rgb", dstStride, src->mWidth);
+        return RT_ERR_VALUE;
+    }
+
+    const UINT8 *u       = src->mPlane[1];
+    const UINT8 *v       = src->mPlane[2];
+    INT32        uStride = src->mStride[1];
+    INT32        vStride = src->mStride[2];
+    INT32        step    = 1;
+    switch (src->mFormat) {
+      case RT_FMT_YUV420P:
+        break;
+      case RT_FMT_YUV420SP:
+        v       = src->mPlane[1] + 1;
+        vStride = src->mStride[1];
+        step    = 2;
+        break;
+      case RT_FMT_YUV420SP_VU:
+        u       = src->mPlane[1] + 1;
+        v       = src->mPlane[1];
+        vStride = src->mStride[1];
+        step    = 2;
+        break;
+      default:
+        RT_LOGE("unsupported format(0x%x) of yuv", src->mFormat);
+        return RT_ERR_UNIMPLIMENTED;
+    }
+    if ((RT_NULL == src->mPlane[0]) || (RT_NULL == u) || (RT_NULL == v)) {
+        return RT_ERR_NULL_PTR;
+    }
+
+    if (COLOR_FEATURES_NONE == gColorFeatures) {
+        gColorFeatures = rt_cpu_features();
+    }
+    const ColorCoef *coef = &gColorCoefs[(RTCOL_SPC_BT709 == space) ? 1 : 0][(RTCOL_RANGE_JPEG == range) ? 1 : 0];
+    COLOR_ROW_FUNC   row  = color_pick_row(gColorFeatures);
+    for (INT32 line = 0; line < src->mHeight; line++) {
+        const UINT8 *yRow = src->mPlane[0] + line * src->mStride[0];
+        const UINT8 *uRow = u + (line >> 1) * uStride;
+        const UINT8 *vRow = v + (line >> 1) * vStride;
+        UINT8       *dRow = dst + line * dstStride;
+        INT32        done = (RT_NULL != row) ? row(yRow, uRow, vRow, step, dRow, src->mWidth, coef, dstFormat) : 0;
+        color_row_c(yRow, uRow, vRow, step, dRow, done, src->mWidth, coef, dstFormat);
+    }
+    return RT_OK;
+}
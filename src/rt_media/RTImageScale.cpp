@@ -0,0 +1,394 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * module: scale of 8 bits planes, 2x2 box halving then bilinear or bicubic.
+ */
+
+#if defined(__SSE2__)
+#include <emmintrin.h>              // NOLINT
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>               // NOLINT
+#define SCALE_USE_NEON
+#endif
+
+#include "RTImageScale.h"           // NOLINT
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "RTImageScale"
+
+#ifdef DEBUG_FLAG
+#undef DEBUG_FLAG
+#endif
+#define DEBUG_FLAG 0x0
+
+// 2^16 of width or height at most
+#define SCALE_MAX_LEVELS    17
+
+static inline UINT8 scale_clip(INT32 value) {
+    return (UINT8)((value < 0) ? 0 : ((value > 255) ? 255 : value));
+}
+
+// average of 2x2 pixels of two rows
+static void scale_halve_row(const UINT8 *row0, const UINT8 *row1, UINT8 *dst, INT32 dstW) {
+    INT32 x = 0;
+#if defined(__SSE2__)
+    const __m128i mask = _mm_set1_epi16(0x00ff);
+    const __m128i one  = _mm_set1_epi16(1);
+    for (; x + 8 <= dstW; x += 8) {
+        __m128i v    = _mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + 2 * x)),
+                                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + 2 * x)));
+        __m128i even = _mm_and_si128(v, mask);
+        __m128i odd  = _mm_srli_epi16(v, 8);
+        __m128i sum  = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(even, odd), one), 1);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + x), _mm_packus_epi16(sum, sum));
+    }
+#elif defined(SCALE_USE_NEON)
+    for (; x + 8 <= dstW; x += 8) {
+        uint8x16_t v = vrhaddq_u8(vld1q_u8(row0 + 2 * x), vld1q_u8(row1 + 2 * x));
+        vst1_u8(dst + x, vrshrn_n_u16(vpaddlq_u8(v), 1));
+    }
+#endif
+    for (; x < dstW; x++) {
+        dst[x] = (row0[2 * x] + row0[2 * x + 1] + row1[2 * x] + row1[2 * x + 1] + 2) >> 2;
+    }
+}
+
+// weight of row1 is in [0, 256)
+static void scale_lerp_row(const UINT8 *row0, const UINT8 *row1, UINT8 *dst, INT32 width, INT32 weight) {
+    if (0 == weight) {
+        rt_memcpy(dst, row0, width);
+        return;
+    }
+    INT32 x = 0;
+#if defined(__SSE2__)
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi16(128);
+    const __m128i w0    = _mm_set1_epi16(256 - weight);
+    const __m128i w1    = _mm_set1_epi16(weight);
+    for (; x + 16 <= width; x += 16) {
+        __m128i a  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + x));
+        __m128i b  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + x));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), w0),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), w1));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), w0),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), w1));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(SCALE_USE_NEON)
+    const uint8x8_t w0 = vdup_n_u8((UINT8)(256 - weight));
+    const uint8x8_t w1 = vdup_n_u8((UINT8)weight);
+    for (; x + 16 <= width; x += 16) {
+        uint8x16_t a  = vld1q_u8(row0 + x);
+        uint8x16_t b  = vld1q_u8(row1 + x);
+        uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(a), w0), vget_low_u8(b), w1);
+        uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(a), w0), vget_high_u8(b), w1);
+        vst1q_u8(dst + x, vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8)));
+    }
+#endif
+    for (; x < width; x++) {
+        dst[x] = (row0[x] * (256 - weight) + row1[x] * weight + 128) >> 8;
+    }
+}
+
+// taps of weight are in Q8, their sum is 256, some of them are negative
+static void scale_cubic_row(const UINT8 *const row[4], UINT8 *dst, INT32 width, const INT32 weight[4]) {
+    if (256 == weight[1]) {
+        rt_memcpy(dst, row[1], width);
+        return;
+    }
+    INT32 x = 0;
+#if defined(__SSE2__)
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(128);
+    const __m128i w01   = _mm_set_epi16(weight[1], weight[0], weight[1], weight[0],
+                                        weight[1], weight[0], weight[1], weight[0]);
+    const __m128i w23   = _mm_set_epi16(weight[3], weight[2], weight[3], weight[2],
+                                        weight[3], weight[2], weight[3], weight[2]);
+    for (; x + 16 <= width; x += 16) {
+        __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row[0] + x));
+        __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row[1] + x));
+        __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row[2] + x));
+        __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row[3] + x));
+        // rows are interleaved by pairs, madd gives w0 * r0 + w1 * r1 in int32
+        __m128i p01[2] = { _mm_unpacklo_epi8(r0, r1), _mm_unpackhi_epi8(r0, r1) };
+        __m128i p23[2] = { _mm_unpacklo_epi8(r2, r3), _mm_unpackhi_epi8(r2, r3) };
+        __m128i out[2];
+        for (INT32 half = 0; half < 2; half++) {
+            __m128i sum[2];
+            for (INT32 quad = 0; quad < 2; quad++) {
+                __m128i a = quad ? _mm_unpackhi_epi8(p01[half], zero) : _mm_unpacklo_epi8(p01[half], zero);
+                __m128i b = quad ? _mm_unpackhi_epi8(p23[half], zero) : _mm_unpacklo_epi8(p23[half], zero);
+                sum[quad] = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(a, w01), _mm_madd_epi16(b, w23)), round);
+                sum[quad] = _mm_srai_epi32(sum[quad], 8);
+            }
+            out[half] = _mm_packs_epi32(sum[0], sum[1]);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), _mm_packus_epi16(out[0], out[1]));
+    }
+#elif defined(SCALE_USE_NEON)
+    for (; x + 8 <= width; x += 8) {
+        int16x8_t r0 = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(row[0] + x)));
+        int16x8_t r1 = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(row[1] + x)));
+        int16x8_t r2 = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(row[2] + x)));
+        int16x8_t r3 = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(row[3] + x)));
+        int32x4_t lo = vmull_n_s16(vget_low_s16(r0), (int16_t)weight[0]);
+        int32x4_t hi = vmull_n_s16(vget_high_s16(r0), (int16_t)weight[0]);
+        lo = vmlal_n_s16(lo, vget_low_s16(r1), (int16_t)weight[1]);
+        hi = vmlal_n_s16(hi, vget_high_s16(r1), (int16_t)weight[1]);
+        lo = vmlal_n_s16(lo, vget_low_s16(r2), (int16_t)weight[2]);
+        hi = vmlal_n_s16(hi, vget_high_s16(r2), (int16_t)weight[2]);
+        lo = vmlal_n_s16(lo, vget_low_s16(r3), (int16_t)weight[3]);
+        hi = vmlal_n_s16(hi, vget_high_s16(r3), (int16_t)weight[3]);
+        vst1_u8(dst + x, vqmovn_u16(vcombine_u16(vqrshrun_n_s32(lo, 8), vqrshrun_n_s32(hi, 8))));
+    }
+#endif
+    for (; x < width; x++) {
+        INT32 sum = row[0][x] * weight[0] + row[1][x] * weight[1]
+                  + row[2][x] * weight[2] + row[3][x] * weight[3];
+        dst[x] = scale_clip((sum + 128) >> 8);
+    }
+}
+
+// center of dst pixel is mapped to src, in 16.16 fixed point
+static void scale_map_axis(INT32 srcSize, INT32 dstSize, INT32 index, INT32 *pos, INT32 *weight) {
+    INT64 fixed = ((2ll * index + 1) * srcSize << 16) / (2 * dstSize) - 32768;
+    if (fixed < 0) {
+        fixed = 0;
+    }
+    *pos    = (INT32)(fixed >> 16);
+    *weight = (INT32)((fixed >> 8) & 0xff);
+    if (*pos >= srcSize - 1) {
+        *pos    = srcSize - 1;
+        *weight = 0;
+    }
+}
+
+// catmull-rom of phase in [0, 256), taps are at -1, 0, 1 and 2
+static void scale_cubic_weights(INT32 phase, INT32 weight[4]) {
+    INT64 t  = phase;
+    INT64 t2 = t * t;
+    INT64 t3 = t2 * t;
+    // (x + 65536) >> 17 rounds x / 2^17, which is the half of Q24 in Q8
+    weight[0] = (INT32)((-t3 + 512 * t2 - 65536 * t + 65536) >> 17);
+    weight[2] = (INT32)((-3 * t3 + 1024 * t2 + 65536 * t + 65536) >> 17);
+    weight[3] = (INT32)((t3 - 256 * t2 + 65536) >> 17);
+    weight[1] = 256 - weight[0] - weight[2] - weight[3];
+}
+
+/*
+ * rows [mFirst, mFirst + mCount) of a plane of mWidth x mHeight,
+ * they are the rows which are used by a slice of dst.
+ */
+typedef struct _ScaleRows {
+    const UINT8 *mData;
+    INT32        mStride;
+    INT32        mWidth;
+    INT32        mHeight;
+    INT32        mFirst;
+    INT32        mCount;
+} ScaleRows;
+
+static inline const UINT8* scale_rows_at(const ScaleRows *rows, INT32 y) {
+    y = RT_MIN(RT_MAX(y, 0), rows->mHeight - 1);
+    return rows->mData + (y - rows->mFirst) * rows->mStride;
+}
+
+// rows of src which are used by dst rows [dstY, dstY + dstCount)
+static void scale_rows_used(INT32 srcH, INT32 dstH, INT32 dstY, INT32 dstCount, RTImageScaleMode mode,
+                            INT32 *first, INT32 *count) {
+    INT32 top, bottom, weight;
+    scale_map_axis(srcH, dstH, dstY, &top, &weight);
+    scale_map_axis(srcH, dstH, dstY + dstCount - 1, &bottom, &weight);
+    if (RT_IMAGE_SCALE_BICUBIC == mode) {
+        top    -= 1;
+        bottom += 2;
+    } else {
+        bottom += 1;
+    }
+    top    = RT_MAX(top, 0);
+    bottom = RT_MIN(bottom, srcH - 1);
+    *first = top;
+    *count = bottom - top + 1;
+}
+
+static void scale_bilinear(const ScaleRows *src, UINT8 *dst, INT32 dstStride, INT32 dstW, INT32 dstH,
+                           INT32 dstY, INT32 dstCount, UINT8 *row, INT32 *table) {
+    INT32  srcW    = src->mWidth;
+    INT32 *posX    = table;
+    INT32 *weightX = table + dstW;
+    for (INT32 x = 0; x < dstW; x++) {
+        scale_map_axis(srcW, dstW, x, &posX[x], &weightX[x]);
+    }
+
+    for (INT32 y = dstY; y < dstY + dstCount; y++) {
+        INT32 posY, weightY;
+        scale_map_axis(src->mHeight, dstH, y, &posY, &weightY);
+        scale_lerp_row(scale_rows_at(src, posY), scale_rows_at(src, posY + 1), row, srcW, weightY);
+        row[srcW] = row[srcW - 1];
+
+        UINT8 *out = dst + y * dstStride;
+        for (INT32 x = 0; x < dstW; x++) {
+            const UINT8 *pixel = row + posX[x];
+            out[x] = (pixel[0] * (256 - weightX[x]) + pixel[1] * weightX[x] + 128) >> 8;
+        }
+    }
+}
+
+static void scale_bicubic(const ScaleRows *src, UINT8 *dst, INT32 dstStride, INT32 dstW, INT32 dstH,
+                          INT32 dstY, INT32 dstCount, UINT8 *row, INT32 *table) {
+    INT32  srcW    = src->mWidth;
+    INT32 *posX    = table;
+    INT32 *weightX = table + dstW;
+    for (INT32 x = 0; x < dstW; x++) {
+        INT32 phase;
+        scale_map_axis(srcW, dstW, x, &posX[x], &phase);
+        scale_cubic_weights(phase, weightX + 4 * x);
+    }
+
+    // row has one pixel of edge on the left and two on the right
+    UINT8 *center = row + 1;
+    for (INT32 y = dstY; y < dstY + dstCount; y++) {
+        INT32 posY, phase, weightY[4];
+        scale_map_axis(src->mHeight, dstH, y, &posY, &phase);
+        scale_cubic_weights(phase, weightY);
+        const UINT8 *rows[4] = { scale_rows_at(src, posY - 1), scale_rows_at(src, posY),
+                                 scale_rows_at(src, posY + 1), scale_rows_at(src, posY + 2) };
+        scale_cubic_row(rows, center, srcW, weightY);
+        center[-1]       = center[0];
+        center[srcW]     = center[srcW - 1];
+        center[srcW + 1] = center[srcW - 1];
+
+        UINT8 *out = dst + y * dstStride;
+        for (INT32 x = 0; x < dstW; x++) {
+            const UINT8 *pixel  = center + posX[x];
+            const INT32 *weight = weightX + 4 * x;
+            INT32 sum = pixel[-1] * weight[0] + pixel[0] * weight[1]
+                      + pixel[1] * weight[2] + pixel[2] * weight[3];
+            out[x] = scale_clip((sum + 128) >> 8);
+        }
+    }
+}
+
+/*
+ * slices are independent: each one halves only the rows it uses, so rows
+ * at edges of slices are halved twice, but results are the same as a whole.
+ */
+RT_RET rt_image_scale_plane_slice(const UINT8 *src, INT32 srcStride, INT32 srcW, INT32 srcH,
+                                  UINT8 *dst, INT32 dstStride, INT32 dstW, INT32 dstH,
+                                  RTImageScaleMode mode, INT32 sliceY, INT32 sliceH) {
+    if ((RT_NULL == src) || (RT_NULL == dst) || (srcW <= 0) || (srcH <= 0) || (dstW <= 0) || (dstH <= 0)
+          || (sliceY < 0) || (sliceH <= 0) || (sliceY + sliceH > dstH)) {
+        return RT_ERR_VALUE;
+    }
+
+    // sizes of levels, level 0 is src
+    INT32 levelW[SCALE_MAX_LEVELS], levelH[SCALE_MAX_LEVELS];
+    INT32 levels = 1;
+    levelW[0] = srcW;
+    levelH[0] = srcH;
+    while ((levels < SCALE_MAX_LEVELS) && (levelW[levels - 1] >= 2 * dstW) && (levelH[levels - 1] >= 2 * dstH)) {
+        levelW[levels] = levelW[levels - 1] / 2;
+        levelH[levels] = levelH[levels - 1] / 2;
+        levels++;
+    }
+
+    // rows used by slice, from the last level to src
+    ScaleRows rows[SCALE_MAX_LEVELS];
+    INT32     total = 0;
+    INT32     last  = levels - 1;
+    scale_rows_used(levelH[last], dstH, sliceY, sliceH, mode, &rows[last].mFirst, &rows[last].mCount);
+    for (INT32 level = last; level >= 0; level--) {
+        if (level < last) {
+            rows[level].mFirst = 2 * rows[level + 1].mFirst;
+            rows[level].mCount = 2 * rows[level + 1].mCount;
+        }
+        rows[level].mWidth  = levelW[level];
+        rows[level].mHeight = levelH[level];
+        rows[level].mStride = levelW[level];
+        if (level > 0) {
+            total += rows[level].mCount * rows[level].mWidth;
+        }
+    }
+    rows[0].mData   = src + rows[0].mFirst * srcStride;
+    rows[0].mStride = srcStride;
+
+    UINT8 *halves = (total > 0) ? rt_malloc_size(UINT8, total) : RT_NULL;
+    UINT8 *level  = halves;
+    for (INT32 idx = 1; idx < levels; idx++) {
+        rows[idx].mData = level;
+        for (INT32 y = 0; y < rows[idx].mCount; y++) {
+            INT32 srcY = 2 * (rows[idx].mFirst + y);
+            scale_halve_row(scale_rows_at(&rows[idx - 1], srcY), scale_rows_at(&rows[idx - 1], srcY + 1),
+                            level + y * rows[idx].mWidth, rows[idx].mWidth);
+        }
+        level += rows[idx].mCount * rows[idx].mWidth;
+    }
+
+    const ScaleRows *used = &rows[last];
+    if ((used->mWidth == dstW) && (used->mHeight == dstH)) {
+        for (INT32 y = sliceY; y < sliceY + sliceH; y++) {
+            rt_memcpy(dst + y * dstStride, scale_rows_at(used, y), dstW);
+        }
+    } else if (RT_IMAGE_SCALE_BICUBIC == mode) {
+        UINT8 *row   = rt_malloc_size(UINT8, used->mWidth + 3);
+        INT32 *table = rt_malloc_array(INT32, 5 * dstW);
+        scale_bicubic(used, dst, dstStride, dstW, dstH, sliceY, sliceH, row, table);
+        rt_safe_free(row);
+        rt_safe_free(table);
+    } else {
+        UINT8 *row   = rt_malloc_size(UINT8, used->mWidth + 1);
+        INT32 *table = rt_malloc_array(INT32, 2 * dstW);
+        scale_bilinear(used, dst, dstStride, dstW, dstH, sliceY, sliceH, row, table);
+        rt_safe_free(row);
+        rt_safe_free(table);
+    }
+    rt_safe_free(halves);
+    return RT_OK;
+}
+
+RT_RET rt_image_scale_plane(const UINT8 *src, INT32 srcStride, INT32 srcW, INT32 srcH,
+                            UINT8 *dst, INT32 dstStride, INT32 dstW, INT32 dstH) {
+    return rt_image_scale_plane_slice(src, srcStride, srcW, srcH, dst, dstStride, dstW, dstH,
+                                      RT_IMAGE_SCALE_BILINEAR, 0, dstH);
+}
+
+RT_RET rt_image_scale_yuv420_slice(const UINT8 *const src[3], const INT32 srcStride[3], INT32 srcW, INT32 srcH,
+                                   UINT8 *const dst[3], const INT32 dstStride[3], INT32 dstW, INT32 dstH,
+                                   RTImageScaleMode mode, INT32 sliceY, INT32 sliceH) {
+    if ((dstW & 1) || (dstH & 1) || (sliceY & 1) || (sliceH & 1)) {
+        RT_LOGE("target(%dx%d) or slice(%d+%d) isn't even", dstW, dstH, sliceY, sliceH);
+        return RT_ERR_VALUE;
+    }
+    RT_RET err = rt_image_scale_plane_slice(src[0], srcStride[0], srcW, srcH,
+                                            dst[0], dstStride[0], dstW, dstH, mode, sliceY, sliceH);
+    for (INT32 idx = 1; (idx < 3) && (RT_OK == err); idx++) {
+        err = rt_image_scale_plane_slice(src[idx], srcStride[idx], (srcW + 1) / 2, (srcH + 1) / 2,
+                                         dst[idx], dstStride[idx], dstW / 2, dstH / 2,
+                                         mode, sliceY / 2, sliceH / 2);
+    }
+    return err;
+}
+
+RT_RET rt_image_scale_yuv420(UINT8 *const src[3], const INT32 srcStride[3], INT32 srcW, INT32 srcH,
+                             UINT8 *dst, INT32 dstW, INT32 dstH) {
+    UINT8 *planes[3]  = { dst, dst + dstW * dstH, dst + dstW * dstH + (dstW / 2) * (dstH / 2) };
+    INT32  strides[3] = { dstW, dstW / 2, dstW / 2 };
+    return rt_image_scale_yuv420_slice(src, srcStride, srcW, srcH, planes, strides, dstW, dstH,
+                                       RT_IMAGE_SCALE_BILINEAR, 0, dstH);
+}
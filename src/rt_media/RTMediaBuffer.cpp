@@ -26,6 +26,12 @@
 #endif
 #define LOG_TAG "RTMediaBuffer"
 
+// high bits of mRefCount flag buffer of pool and buffer on its way
+// back to pool, others are refs
+#define MEDIA_BUFFER_POOLED         (1 << 30)
+#define MEDIA_BUFFER_RETURNING      (1 << 29)
+#define MEDIA_BUFFER_REFS_MASK      (MEDIA_BUFFER_RETURNING - 1)
+
 RTMediaBuffer::RTMediaBuffer(void* data, UINT32 size) {
     this->baseInit();
 
@@ -177,70 +183,110 @@ RtMediaBufferStatus RTMediaBuffer::getStatus() {
     return mStatus;
 }
 
+/*
+ * a new reference is taken by one who holds a reference already, so it
+ * does not order anything. the last release is ordered after all others
+ * by acq_rel, so owner sees what all holders wrote in buffer.
+ */
 void RTMediaBuffer::addRefs() {
-    (void) __sync_fetch_and_add(&mRefCount, 1);
+    (void)__atomic_fetch_add(&mRefCount, 1, __ATOMIC_RELAXED);
 }
 
 INT32 RTMediaBuffer::refsCount() {
-    return mRefCount;
+    return __atomic_load_n(&mRefCount, __ATOMIC_ACQUIRE) & MEDIA_BUFFER_REFS_MASK;
+}
+
+RT_BOOL RTMediaBuffer::addRefsIfIdle() {
+    INT32 refs = __atomic_load_n(&mRefCount, __ATOMIC_RELAXED);
+    do {
+        // buffer is idle once pool takes it back
+        if (0 != (refs & (MEDIA_BUFFER_REFS_MASK | MEDIA_BUFFER_RETURNING))) {
+            return RT_FALSE;
+        }
+    } while (!__atomic_compare_exchange_n(&mRefCount, &refs, refs + 1, true,
+                                          __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+    return RT_TRUE;
 }
 
 void RTMediaBuffer::release(bool debug) {
+    INT32 refs = __atomic_load_n(&mRefCount, __ATOMIC_ACQUIRE);
     if (debug) {
-        RT_LOGE("this: %p, mAllocator: %p mObserver=%p, mFuncFree=%p, refs=%d",
-                 this, mAllocator, mObserver, mFuncFree, mRefCount);
+        RT_LOGE("this: %p, mAllocator: %p mObserver=%p, mFuncFree=%p, refs=0x%x",
+                 this, mAllocator, mObserver, mFuncFree, refs);
     }
-    if (mObserver == RT_NULL && mRefCount == 0) {
-        if (mAllocator != RT_NULL) {
-            RTMediaBuffer *this_tmp = this;
-            mAllocator->freeBuffer(&this_tmp);
-        } else if (mFuncFree != RT_NULL) {
-            void *raw_ptr = RT_NULL;
-            mMetaData->findPointer(kKeyPacketPtr, &raw_ptr);
-            if (raw_ptr) {
-                mFuncFree(raw_ptr);
-                mMetaData->setPointer(kKeyPacketPtr, RT_NULL);
-            }
-            delete this;
+    /*
+     * never below 0, so a released buffer is not returned twice. the last
+     * holder owns buffer alone, it frees packet before buffer is idle, and
+     * the last release decides the way back with the pooled flag together.
+     */
+    INT32 next = 0;
+    do {
+        if (0 == (refs & MEDIA_BUFFER_REFS_MASK)) {
+            break;
+        }
+        if (1 == (refs & MEDIA_BUFFER_REFS_MASK)) {
+            freePacket();
+            next = (refs & MEDIA_BUFFER_POOLED)
+                       ? (MEDIA_BUFFER_POOLED | MEDIA_BUFFER_RETURNING) : 0;
         } else {
-            delete this;
+            next = refs - 1;
         }
-        return;
-    }
-    if (mRefCount == 0) {
+    } while (!__atomic_compare_exchange_n(&mRefCount, &refs, next, true,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    if (0 == refs) {
+        freePacket();
+        returnToOwner(RT_FALSE);
+    } else if (0 == (refs & MEDIA_BUFFER_REFS_MASK)) {
         RT_LOGE("refs count is 0, should not release.");
-        return;
+    } else if (1 == (refs & MEDIA_BUFFER_REFS_MASK)) {
+        returnToOwner((refs & MEDIA_BUFFER_POOLED) ? RT_TRUE : RT_FALSE);
     }
+}
 
-    if (mRefCount == 1) {
-         if (mFuncFree != RT_NULL) {
-            void *raw_ptr = RT_NULL;
-            mMetaData->findPointer(kKeyPacketPtr, &raw_ptr);
-            if (raw_ptr) {
-                mFuncFree(raw_ptr);
-                mMetaData->setPointer(kKeyPacketPtr, RT_NULL);
-            }
+void RTMediaBuffer::freePacket() {
+    if (mFuncFree != RT_NULL) {
+        void *raw_ptr = RT_NULL;
+        mMetaData->findPointer(kKeyPacketPtr, &raw_ptr);
+        if (raw_ptr) {
+            mFuncFree(raw_ptr);
+            mMetaData->setPointer(kKeyPacketPtr, RT_NULL);
         }
     }
+}
 
-    int prevCount = __sync_fetch_and_sub(&mRefCount, 1);
-    if (prevCount == 1) {
-        if (mObserver == RT_NULL) {
-            if (mAllocator != RT_NULL) {
-                RTMediaBuffer *this_tmp = this;
-                mAllocator->freeBuffer(&this_tmp);
-                return;
-            }
-            delete this;
-            return;
-        }
+// pool takes buffer back by finishReturn(), buffer is not touched after it
+void RTMediaBuffer::returnToOwner(RT_BOOL pooled) {
+    if (pooled) {
         mObserver->signalBufferReturned(this);
+    } else if (mAllocator != RT_NULL) {
+        RTMediaBuffer *this_tmp = this;
+        mAllocator->freeBuffer(&this_tmp);
+    } else {
+        delete this;
     }
 }
 
+// observer is set before buffer is shared, and kept after it is detached
 void RTMediaBuffer::setObserver(RTMediaBufferObserver *observer) {
     RT_ASSERT(observer != RT_NULL);
     mObserver = observer;
+    (void)__atomic_fetch_or(&mRefCount, MEDIA_BUFFER_POOLED, __ATOMIC_RELEASE);
+}
+
+RT_BOOL RTMediaBuffer::detachObserver() {
+    INT32 refs = __atomic_fetch_and(&mRefCount, ~MEDIA_BUFFER_POOLED, __ATOMIC_ACQ_REL);
+    return (0 == (refs & MEDIA_BUFFER_REFS_MASK)) ? RT_TRUE : RT_FALSE;
+}
+
+RT_BOOL RTMediaBuffer::isReturning() {
+    INT32 refs = __atomic_load_n(&mRefCount, __ATOMIC_ACQUIRE);
+    return (refs & MEDIA_BUFFER_RETURNING) ? RT_TRUE : RT_FALSE;
+}
+
+RT_BOOL RTMediaBuffer::finishReturn() {
+    INT32 refs = __atomic_fetch_and(&mRefCount, ~MEDIA_BUFFER_RETURNING, __ATOMIC_RELEASE);
+    return (refs & MEDIA_BUFFER_POOLED) ? RT_TRUE : RT_FALSE;
 }
 
 
@@ -36,7 +36,8 @@ struct RTMediaBufferPool::RTBufferList {
 };
 
 RTMediaBufferPool::RTMediaBufferPool(UINT32 max_buffer_count)
-    : mBufferList(new RTBufferList()) {
+    : mBufferList(new RTBufferList()),
+      mRunning(RT_FALSE) {
     mBufferList->mMaxBufferCount = max_buffer_count;
 
     RT_ASSERT(RT_NULL != mBufferList->mBuffers);
@@ -110,10 +111,12 @@ RT_BOOL RTMediaBufferPool::hasBuffer() {
 
 RT_RET RTMediaBufferPool::start() {
     mRunning = RT_TRUE;
+    return RT_OK;
 }
 RT_RET RTMediaBufferPool::stop() {
     mRunning = RT_FALSE;
     signalBufferReturned(RT_NULL);
+    return RT_OK;
 }
 
 RT_RET RTMediaBufferPool::acquireBuffer(
@@ -134,15 +137,14 @@ RT_RET RTMediaBufferPool::acquireBuffer(
         for (UINT32 idx = 0; idx < count; idx++) {
             it = reinterpret_cast<RTMediaBuffer *>
                      (array_list_get_data(mBufferList->mBuffers, idx));
-            if (it && it->refsCount() == 0
-                  && it->getSize() >= request_size) {
+            if (it && it->getSize() >= request_size
+                  && it->addRefsIfIdle()) {
                 buffer = it;
                 break;
             }
         }
 
         if (buffer != RT_NULL) {
-            buffer->addRefs();
             buffer->reset();
             *out = buffer;
             return RT_OK;
@@ -156,10 +158,19 @@ RT_RET RTMediaBufferPool::acquireBuffer(
 
         mBufferList->mCondition->wait(mBufferList->mLock);
     }
+
+    *out = RT_NULL;
+    return RT_ERR_BAD;
 }
 
 void RTMediaBufferPool::signalBufferReturned(RTMediaBuffer *buffer) {
     RtMutex::RtAutolock autoLock(mBufferList->mLock);
+    // buffer is idle under lock, so no waiter misses it
+    if ((RT_NULL != buffer) && !buffer->finishReturn()) {
+        // releaseAllBuffers() waits for buffer which is detached
+        mBufferList->mCondition->broadcast();
+        return;
+    }
     mBufferList->mCondition->signal();
 }
 
@@ -171,12 +182,15 @@ RT_RET RTMediaBufferPool::releaseAllBuffers() {
         RTMediaBuffer *buffer = reinterpret_cast<RTMediaBuffer *>
                                     (array_list_get_data(mBufferList->mBuffers, 0));
         array_list_remove(mBufferList->mBuffers, reinterpret_cast<void *>(buffer));
-        buffer->setObserver(RT_NULL);
-        if (buffer->refsCount() != 0) {
+        // buffer in use is freed by its last release, once it is detached
+        if (buffer->detachObserver()) {
+            while (buffer->isReturning()) {
+                mBufferList->mCondition->wait(mBufferList->mLock);
+            }
+            buffer->release();
+        } else {
             RT_LOGD("has buffer still in used, buffer: %p, index: %d, refsCount: %d",
                      buffer, idx, buffer->refsCount());
-        } else {
-            buffer->release();
         }
     }
 
@@ -0,0 +1,276 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * module: push stream, bytes written by caller are read by demuxer.
+ *         single writer and single reader, no lock in data path.
+ */
+
+#include "RTMediaPushStream.h"      // NOLINT
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "RTMediaPushStream"
+
+#ifdef DEBUG_FLAG
+#undef DEBUG_FLAG
+#endif
+#define DEBUG_FLAG 0x0
+
+#define PUSH_STREAM_MIN_SIZE        (64 * 1024)
+#define PUSH_STREAM_WAIT_US         (20 * 1000)
+
+// counter is stored after its data, and loaded before the data is touched
+static inline UINT32 push_load(volatile UINT32 *ptr) {
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+static inline void push_store(volatile UINT32 *ptr, UINT32 value) {
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+static inline INT32 push_flag(volatile INT32 *ptr) {
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+static inline void push_set_flag(volatile INT32 *ptr, INT32 value) {
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+RTMediaPushStream::RTMediaPushStream(INT32 capacity)
+        : mRingHead(0),
+          mRingTail(0),
+          mSegHead(0),
+          mSegTail(0),
+          mSegOffset(0),
+          mEos(0),
+          mInterrupt(0),
+          mAbort(0),
+          mReaderWaiting(0),
+          mWriterWaiting(0),
+          mBytesWritten(0ll),
+          mBytesRead(0ll) {
+    // capacity is power of 2, so that ring offset is masked counter
+    mCapacity = PUSH_STREAM_MIN_SIZE;
+    while (mCapacity < (UINT32)capacity) {
+        mCapacity <<= 1;
+    }
+    mRing = rt_malloc_size(UINT8, mCapacity);
+    RT_ASSERT(RT_NULL != mRing);
+
+    mSegments = rt_malloc_array(RTPushSegment, PUSH_STREAM_MAX_SEGMENTS);
+    RT_ASSERT(RT_NULL != mSegments);
+
+    mWaitLock = new RtMutex();
+    RT_ASSERT(RT_NULL != mWaitLock);
+
+    mWaitCond = new RtCondition();
+    RT_ASSERT(RT_NULL != mWaitCond);
+
+    RTObject::trace(getName(), this, sizeof(RTMediaPushStream));
+}
+
+/*
+ * lent buffers which aren't consumed are returned to writer.
+ */
+RTMediaPushStream::~RTMediaPushStream() {
+    for (UINT32 idx = mSegHead; idx != mSegTail; idx++) {
+        RTPushSegment *seg = &mSegments[idx & (PUSH_STREAM_MAX_SEGMENTS - 1)];
+        if (RT_NULL != seg->mRelease) {
+            seg->mRelease(seg->mOpaque, seg->mData);
+        }
+    }
+    RT_LOGD("done, written: %lld bytes, read: %lld bytes", mBytesWritten, mBytesRead);
+
+    rt_safe_free(mRing);
+    rt_safe_free(mSegments);
+    rt_safe_delete(mWaitCond);
+    rt_safe_delete(mWaitLock);
+    RTObject::untrace(getName(), this);
+}
+
+RT_BOOL RTMediaPushStream::publish(const UINT8 *data, INT32 size, INT32 ringBytes,
+                                   RT_PUSH_RELEASE_FUNC release, void *opaque) {
+    UINT32 segTail = mSegTail;
+    if (segTail - push_load(&mSegHead) >= PUSH_STREAM_MAX_SEGMENTS) {
+        return RT_FALSE;
+    }
+    RTPushSegment *seg = &mSegments[segTail & (PUSH_STREAM_MAX_SEGMENTS - 1)];
+    seg->mData      = data;
+    seg->mSize      = size;
+    seg->mRingBytes = ringBytes;
+    seg->mRelease   = release;
+    seg->mOpaque    = opaque;
+    push_store(&mSegTail, segTail + 1);
+    mBytesWritten += size;
+    wakeUp(&mReaderWaiting);
+    return RT_TRUE;
+}
+
+INT32 RTMediaPushStream::write(const UINT8 *data, INT32 size, RT_BOOL block) {
+    INT32 written = 0;
+    while ((written < size) && !push_flag(&mAbort)) {
+        UINT32 tail    = mRingTail;
+        UINT32 space   = mCapacity - (tail - push_load(&mRingHead));
+        UINT32 offset  = tail & (mCapacity - 1);
+        UINT32 bytes   = RT_MIN(space, mCapacity - offset);
+        bytes          = RT_MIN(bytes, (UINT32)(size - written));
+        RT_BOOL segFree = (mSegTail - push_load(&mSegHead)) < PUSH_STREAM_MAX_SEGMENTS;
+        if ((0 == bytes) || !segFree) {
+            if (!block) {
+                break;
+            }
+            waitFor(&mWriterWaiting, &RTMediaPushStream::canWrite);
+            continue;
+        }
+
+        // reader never touches free area of ring, copy before publishing
+        rt_memcpy(mRing + offset, data + written, bytes);
+        push_store(&mRingTail, tail + bytes);
+        publish(mRing + offset, bytes, bytes, RT_NULL, RT_NULL);
+        written += bytes;
+    }
+    return written;
+}
+
+RT_RET RTMediaPushStream::lend(const UINT8 *data, INT32 size, RT_PUSH_RELEASE_FUNC release,
+                               void *opaque, RT_BOOL block) {
+    if ((RT_NULL == data) || (size <= 0)) {
+        return RT_ERR_VALUE;
+    }
+    while (!push_flag(&mAbort)) {
+        if (publish(data, size, 0, release, opaque)) {
+            return RT_OK;
+        }
+        if (!block) {
+            return RT_ERR_LIST_FULL;
+        }
+        waitFor(&mWriterWaiting, &RTMediaPushStream::canWrite);
+    }
+    // buffer isn't taken, it still belongs to writer
+    return RT_ERR_BAD;
+}
+
+RT_RET RTMediaPushStream::writeEos() {
+    push_set_flag(&mEos, 1);
+    wakeUp(&mReaderWaiting);
+    return RT_OK;
+}
+
+INT32 RTMediaPushStream::readBytes(void *stream, UINT8 *buf, INT32 size) {
+    return reinterpret_cast<RTMediaPushStream*>(stream)->read(buf, size);
+}
+
+/*
+ * returns bytes as soon as some are available, like a socket.
+ */
+INT32 RTMediaPushStream::read(UINT8 *buf, INT32 size) {
+    INT32 bytes = 0;
+    while (bytes < size) {
+        if (push_flag(&mAbort) || push_flag(&mInterrupt)) {
+            return RT_ERR_BAD;
+        }
+        UINT32 head = mSegHead;
+        if (head == push_load(&mSegTail)) {
+            if (bytes > 0) {
+                break;
+            }
+            // eos is set after the last segment, check segments once more
+            if (push_flag(&mEos) && (head == push_load(&mSegTail))) {
+                return RT_ERR_END_OF_STREAM;
+            }
+            waitFor(&mReaderWaiting, &RTMediaPushStream::canRead);
+            continue;
+        }
+
+        RTPushSegment *seg = &mSegments[head & (PUSH_STREAM_MAX_SEGMENTS - 1)];
+        INT32 copy = RT_MIN(size - bytes, seg->mSize - mSegOffset);
+        rt_memcpy(buf + bytes, seg->mData + mSegOffset, copy);
+        bytes      += copy;
+        mSegOffset += copy;
+        if (mSegOffset < seg->mSize) {
+            continue;
+        }
+
+        // segment is consumed, give its memory back to writer
+        if (RT_NULL != seg->mRelease) {
+            seg->mRelease(seg->mOpaque, seg->mData);
+        } else {
+            push_store(&mRingHead, mRingHead + seg->mRingBytes);
+        }
+        mSegOffset = 0;
+        push_store(&mSegHead, head + 1);
+        wakeUp(&mWriterWaiting);
+    }
+    mBytesRead += bytes;
+    return bytes;
+}
+
+void RTMediaPushStream::setInterrupt(RT_BOOL interrupt) {
+    push_set_flag(&mInterrupt, interrupt ? 1 : 0);
+    RtMutex::RtAutolock autoLock(mWaitLock);
+    mWaitCond->broadcast();
+}
+
+void RTMediaPushStream::abort() {
+    push_set_flag(&mAbort, 1);
+    RtMutex::RtAutolock autoLock(mWaitLock);
+    mWaitCond->broadcast();
+}
+
+INT64 RTMediaPushStream::getBytesWritten() {
+    return mBytesWritten;
+}
+
+INT64 RTMediaPushStream::getBytesRead() {
+    return mBytesRead;
+}
+
+void RTMediaPushStream::summary(INT32 fd) {
+    RT_LOGD("ring: %d bytes, used: %d bytes, segments: %d, written: %lld, read: %lld",
+             mCapacity, push_load(&mRingTail) - push_load(&mRingHead),
+             push_load(&mSegTail) - push_load(&mSegHead), mBytesWritten, mBytesRead);
+}
+
+RT_BOOL RTMediaPushStream::canRead() {
+    return (mSegHead != push_load(&mSegTail)) || push_flag(&mEos)
+             || push_flag(&mInterrupt) || push_flag(&mAbort);
+}
+
+RT_BOOL RTMediaPushStream::canWrite() {
+    RT_BOOL ringFree = (mRingTail - push_load(&mRingHead)) < mCapacity;
+    RT_BOOL segFree  = (mSegTail - push_load(&mSegHead)) < PUSH_STREAM_MAX_SEGMENTS;
+    return (ringFree && segFree) || push_flag(&mAbort);
+}
+
+/*
+ * the flag is raised under lock before checking again, so that a wakeUp()
+ * after the check always finds the sleeper. timeout is only a safeguard.
+ */
+void RTMediaPushStream::waitFor(volatile INT32 *waiting, PushReadyFunc ready) {
+    RtMutex::RtAutolock autoLock(mWaitLock);
+    __atomic_store_n(waiting, 1, __ATOMIC_SEQ_CST);
+    if (!(this->*ready)()) {
+        mWaitCond->timedwait(mWaitLock, PUSH_STREAM_WAIT_US);
+    }
+    __atomic_store_n(waiting, 0, __ATOMIC_SEQ_CST);
+}
+
+void RTMediaPushStream::wakeUp(volatile INT32 *waiting) {
+    if (__atomic_load_n(waiting, __ATOMIC_SEQ_CST)) {
+        RtMutex::RtAutolock autoLock(mWaitLock);
+        mWaitCond->broadcast();
+    }
+}
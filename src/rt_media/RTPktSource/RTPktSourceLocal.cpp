@@ -130,30 +130,38 @@ RT_RET RTPktSourceLocal::stop() {
 }
 
 RT_RET RTPktSourceLocal::flush() {
-    RTPacket *pkt = RT_NULL;
-    RtMutex::RtAutolock autoLock(mQueueLock);
-    while (mVideoPktQ && deque_size(mVideoPktQ) > 0) {
-        pkt = RT_NULL;
-        RT_DequeEntry entry = deque_pop(mVideoPktQ);
-        if (entry.data) {
-            pkt = reinterpret_cast<RTPacket *>(entry.data);
-        }
-        mVideoCache->mCurCacheCount = deque_size(mVideoPktQ);
-        mVideoCache->mCurCacheDuration -= pkt->mDuration;
-        mVideoCache->mCurCacheSize -= pkt->mSize;
-        rt_utils_packet_free(pkt);
-        rt_safe_free(pkt);
+    flushTrack(RTTRACK_TYPE_VIDEO);
+    flushTrack(RTTRACK_TYPE_AUDIO);
+    return RT_OK;
+}
+
+RT_RET RTPktSourceLocal::flushTrack(RTTrackType type) {
+    RT_Deque     *pktQ  = RT_NULL;
+    RTMediaCache *cache = RT_NULL;
+    switch (type) {
+      case RTTRACK_TYPE_VIDEO:
+        pktQ  = mVideoPktQ;
+        cache = mVideoCache;
+        break;
+      case RTTRACK_TYPE_AUDIO:
+        pktQ  = mAudioPktQ;
+        cache = mAudioCache;
+        break;
+      default:
+        return RT_ERR_VALUE;
     }
 
-    while (mAudioPktQ && deque_size(mAudioPktQ) > 0) {
+    RTPacket *pkt = RT_NULL;
+    RtMutex::RtAutolock autoLock(mQueueLock);
+    while (pktQ && deque_size(pktQ) > 0) {
         pkt = RT_NULL;
-        RT_DequeEntry entry = deque_pop(mAudioPktQ);
+        RT_DequeEntry entry = deque_pop(pktQ);
         if (entry.data) {
             pkt = reinterpret_cast<RTPacket *>(entry.data);
         }
-        mAudioCache->mCurCacheCount = deque_size(mAudioPktQ);
-        mAudioCache->mCurCacheDuration -= pkt->mDuration;
-        mAudioCache->mCurCacheSize -= pkt->mSize;
+        cache->mCurCacheCount = deque_size(pktQ);
+        cache->mCurCacheDuration -= pkt->mDuration;
+        cache->mCurCacheSize -= pkt->mSize;
         rt_utils_packet_free(pkt);
         rt_safe_free(pkt);
     }
@@ -0,0 +1,409 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * module: network packet source, bytes are fetched by I/O thread
+ *         into a ring buffer, and read by demuxer thread.
+ */
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "RTPktSourceNetwork"
+
+#ifdef DEBUG_FLAG
+#undef DEBUG_FLAG
+#endif
+#define DEBUG_FLAG 0x0
+
+#include <stdio.h>                  // NOLINT
+
+#include "RTPktSourceNetwork.h"     // NOLINT
+#include "RTMediaMetaKeys.h"        // NOLINT
+#include "FFAdapterFormat.h"        // NOLINT
+#include "rt_time.h"                // NOLINT
+
+#define NETWORK_READ_AHEAD_SIZE     (4 * 1024 * 1024)   // 4MB
+#define NETWORK_MIN_READ_AHEAD      (256 * 1024)        // 256KB
+#define NETWORK_FETCH_CHUNK         (64 * 1024)
+#define NETWORK_BANDWIDTH_WINDOW    (500 * 1000)        // 500ms of fetching
+#define NETWORK_WAIT_TIMEOUT        (100 * 1000)        // 100ms
+
+static void* network_io_loop(void* ptr_source) {
+    RTPktSourceNetwork* source = reinterpret_cast<RTPktSourceNetwork*>(ptr_source);
+    source->runTask();
+    return RT_NULL;
+}
+
+static INT32 network_io_interrupt(void* ptr_source) {
+    RTPktSourceNetwork* source = reinterpret_cast<RTPktSourceNetwork*>(ptr_source);
+    return source->isAborted() ? 1 : 0;
+}
+
+RTPktSourceNetwork::RTPktSourceNetwork()
+        : mIOCtx(RT_NULL),
+          mRing(RT_NULL),
+          mRingSize(0),
+          mReadAhead(NETWORK_READ_AHEAD_SIZE),
+          mBackSize(0),
+          mTailPos(0ll),
+          mReadPos(0ll),
+          mWritePos(0ll),
+          mSeekPos(-1ll),
+          mStreamSize(-1ll),
+          mSeekGen(0),
+          mFilling(RT_TRUE),
+          mEos(RT_FALSE),
+          mAbort(RT_FALSE),
+          mInterrupt(RT_FALSE),
+          mError(0),
+          mWindowBytes(0ll),
+          mWindowUs(0ll),
+          mBandwidth(0ll),
+          mBitrate(0ll),
+          mTotalBytes(0ll),
+          mBaseHighWater(0ll) {
+    mRingLock = new RtMutex();
+    RT_ASSERT(RT_NULL != mRingLock);
+
+    mRingCond = new RtCondition();
+    RT_ASSERT(RT_NULL != mRingCond);
+
+    mThread = new RtThread(network_io_loop, reinterpret_cast<void*>(this));
+    mThread->setName("NetSource");
+}
+
+RTPktSourceNetwork::~RTPktSourceNetwork() {
+    release();
+    rt_safe_delete(mThread);
+    rt_safe_delete(mRingCond);
+    rt_safe_delete(mRingLock);
+}
+
+RT_RET RTPktSourceNetwork::init(RtMetaData *config) {
+    RT_ASSERT(RT_NULL != config);
+    RT_RET ret = RTPktSourceLocal::init(config);
+    if (RT_OK != ret) {
+        return ret;
+    }
+    mBaseHighWater = mVideoCache->mHighWaterCacheDuration;
+
+    const char *uri = RT_NULL;
+    if (!config->findCString(kKeyFormatUri, &uri) || (RT_NULL == uri)) {
+        RT_LOGE("no uri to init network source");
+        return RT_ERR_NULL_PTR;
+    }
+    if (!config->findInt32(kKeyReadAheadSize, &mReadAhead)) {
+        mReadAhead = NETWORK_READ_AHEAD_SIZE;
+    }
+    // bytes behind read position are kept for short backward seek
+    mReadAhead = RT_MAX(mReadAhead, NETWORK_MIN_READ_AHEAD);
+    mBackSize  = mReadAhead / 4;
+    mRingSize  = mReadAhead + mBackSize;
+    mRing      = rt_malloc_size(UINT8, mRingSize);
+    RT_ASSERT(RT_NULL != mRing);
+
+    mIOCtx = fa_io_open(uri, network_io_interrupt, this);
+    if (RT_NULL == mIOCtx) {
+        RT_LOGE("fail to open %s", uri);
+        return RT_ERR_OPEN_FILE;
+    }
+    mStreamSize = fa_io_size(mIOCtx);
+
+    RT_LOGD("init: read-ahead: %d, ring: %d, stream size: %lld",
+             mReadAhead, mRingSize, mStreamSize);
+
+    mThread->start();
+    return RT_OK;
+}
+
+/*
+ * packet caches are released by RTPktSourceLocal::~RTPktSourceLocal().
+ */
+RT_RET RTPktSourceNetwork::release() {
+    {
+        RtMutex::RtAutolock autoLock(mRingLock);
+        mAbort = RT_TRUE;
+        mRingCond->broadcast();
+    }
+    if (RT_NULL != mThread) {
+        mThread->requestInterruption();
+        mThread->join();
+    }
+    if (RT_NULL != mIOCtx) {
+        RT_LOGD("done, %lld bytes fetched, bandwidth: %lld bps", mTotalBytes, mBandwidth);
+        fa_io_close(mIOCtx);
+        mIOCtx = RT_NULL;
+    }
+    rt_safe_free(mRing);
+    return RT_OK;
+}
+
+RT_RET RTPktSourceNetwork::start() {
+    {
+        RtMutex::RtAutolock autoLock(mRingLock);
+        mInterrupt = RT_FALSE;
+    }
+    return RTPktSourceLocal::start();
+}
+
+/*
+ * wake up demuxer thread blocked in read(), the I/O thread keeps fetching.
+ */
+RT_RET RTPktSourceNetwork::stop() {
+    {
+        RtMutex::RtAutolock autoLock(mRingLock);
+        mInterrupt = RT_TRUE;
+        mRingCond->broadcast();
+    }
+    return RTPktSourceLocal::stop();
+}
+
+INT32 RTPktSourceNetwork::readBytes(void *source, UINT8 *buf, INT32 size) {
+    return reinterpret_cast<RTPktSourceNetwork*>(source)->read(buf, size);
+}
+
+INT64 RTPktSourceNetwork::seekBytes(void *source, INT64 offset, INT32 whence) {
+    return reinterpret_cast<RTPktSourceNetwork*>(source)->seek(offset, whence);
+}
+
+INT32 RTPktSourceNetwork::read(UINT8 *buf, INT32 size) {
+    RtMutex::RtAutolock autoLock(mRingLock);
+    while (mReadPos >= mWritePos) {
+        if (mAbort || mInterrupt) {
+            return RT_ERR_BAD;
+        }
+        if (mEos) {
+            return RT_ERR_END_OF_STREAM;
+        }
+        if (mError < 0) {
+            return mError;
+        }
+        mRingCond->timedwait(mRingLock, NETWORK_WAIT_TIMEOUT);
+    }
+
+    INT32 bytes  = (INT32)RT_MIN((INT64)size, mWritePos - mReadPos);
+    INT32 offset = (INT32)(mReadPos % mRingSize);
+    INT32 first  = RT_MIN(bytes, mRingSize - offset);
+    rt_memcpy(buf, mRing + offset, first);
+    if (bytes > first) {
+        rt_memcpy(buf + first, mRing, bytes - first);
+    }
+    mReadPos += bytes;
+    mTailPos  = RT_MAX(mTailPos, mReadPos - mBackSize);
+
+    // refill from half of read-ahead, so that I/O thread fetches in bursts
+    if (!mFilling && (mWritePos - mReadPos < mReadAhead / 2)) {
+        mFilling = RT_TRUE;
+        mRingCond->broadcast();
+    }
+    return bytes;
+}
+
+/*
+ * seek in the ring buffer if possible, otherwise I/O thread reconnects
+ * at the new position and the buffered bytes are dropped.
+ */
+INT64 RTPktSourceNetwork::seek(INT64 offset, INT32 whence) {
+    RtMutex::RtAutolock autoLock(mRingLock);
+    INT64 target = 0ll;
+    switch (whence) {
+      case FA_SEEK_SIZE:
+        return mStreamSize;
+      case SEEK_SET:
+        target = offset;
+        break;
+      case SEEK_CUR:
+        target = mReadPos + offset;
+        break;
+      case SEEK_END:
+        if (mStreamSize < 0) {
+            return RT_ERR_VALUE;
+        }
+        target = mStreamSize + offset;
+        break;
+      default:
+        return RT_ERR_VALUE;
+    }
+    if (target < 0) {
+        return RT_ERR_VALUE;
+    }
+
+    if ((target >= mTailPos) && (target <= mWritePos)) {
+        mReadPos = target;
+        RT_LOGD_IF(DEBUG_FLAG, "seek to %lld in ring buffer", target);
+        return target;
+    }
+
+    RT_LOGD("seek to %lld, out of ring buffer[%lld, %lld]", target, mTailPos, mWritePos);
+    mSeekGen++;
+    mSeekPos  = target;
+    mTailPos  = target;
+    mReadPos  = target;
+    mWritePos = target;
+    mEos      = RT_FALSE;
+    mError    = 0;
+    mFilling  = RT_TRUE;
+    mRingCond->broadcast();
+    return target;
+}
+
+void RTPktSourceNetwork::setStreamBitrate(INT64 bitrate) {
+    RtMutex::RtAutolock autoLock(mRingLock);
+    mBitrate = bitrate;
+    updateCacheWater();
+}
+
+INT64 RTPktSourceNetwork::getBandwidth() {
+    RtMutex::RtAutolock autoLock(mRingLock);
+    return mBandwidth;
+}
+
+INT64 RTPktSourceNetwork::getBufferedBytes() {
+    RtMutex::RtAutolock autoLock(mRingLock);
+    return mWritePos - mReadPos;
+}
+
+RT_BOOL RTPktSourceNetwork::isEndOfStream() {
+    RtMutex::RtAutolock autoLock(mRingLock);
+    return mEos && (mReadPos >= mWritePos);
+}
+
+RT_BOOL RTPktSourceNetwork::isAborted() {
+    return mAbort;
+}
+
+void RTPktSourceNetwork::summary(INT32 fd) {
+    RtMutex::RtAutolock autoLock(mRingLock);
+    RT_LOGD("ring: %d bytes, buffered: %lld bytes, read: %lld, size: %lld",
+             mRingSize, mWritePos - mReadPos, mReadPos, mStreamSize);
+    RT_LOGD("fetched: %lld bytes, bandwidth: %lld bps, bitrate: %lld bps",
+             mTotalBytes, mBandwidth, mBitrate);
+}
+
+RT_RET RTPktSourceNetwork::runTask() {
+    RT_LOGD_IF(DEBUG_FLAG, "task begin");
+    while (THREAD_LOOP == mThread->getState()) {
+        INT64  seekPos = -1ll;
+        UINT8 *dst     = RT_NULL;
+        INT32  chunk   = 0;
+        UINT32 gen     = 0;
+        {
+            RtMutex::RtAutolock autoLock(mRingLock);
+            if (mAbort) {
+                break;
+            }
+            if (mSeekPos >= 0) {
+                seekPos  = mSeekPos;
+                mSeekPos = -1ll;
+            } else {
+                INT32 ahead = (INT32)(mWritePos - mReadPos);
+                INT32 space = mRingSize - (INT32)(mWritePos - mTailPos);
+                if (ahead >= mReadAhead) {
+                    mFilling = RT_FALSE;
+                }
+                if (mEos || (mError < 0) || !mFilling || (space <= 0)) {
+                    mRingCond->timedwait(mRingLock, NETWORK_WAIT_TIMEOUT);
+                    continue;
+                }
+                INT32 offset = (INT32)(mWritePos % mRingSize);
+                chunk = RT_MIN(space, mRingSize - offset);
+                chunk = RT_MIN(chunk, RT_MIN(mReadAhead - ahead, NETWORK_FETCH_CHUNK));
+                dst   = mRing + offset;
+            }
+            gen = mSeekGen;
+        }
+
+        if (seekPos >= 0) {
+            INT64 pos = fa_io_seek(mIOCtx, seekPos);
+            RtMutex::RtAutolock autoLock(mRingLock);
+            if ((pos < 0) && (gen == mSeekGen)) {
+                RT_LOGE("fail to seek to %lld, err: %lld", seekPos, pos);
+                mError = (INT32)pos;
+                mRingCond->broadcast();
+            }
+            continue;
+        }
+
+        // the free area of ring isn't touched by demuxer thread, fetch without lock
+        INT64 startUs = RtTime::getNowTimeUs();
+        INT32 ret     = fa_io_read(mIOCtx, dst, chunk);
+        INT64 costUs  = RtTime::getNowTimeUs() - startUs;
+        {
+            RtMutex::RtAutolock autoLock(mRingLock);
+            if (gen != mSeekGen) {
+                // bytes before seeking are out of date
+                continue;
+            }
+            if (ret > 0) {
+                mWritePos   += ret;
+                mTotalBytes += ret;
+                updateBandwidth(ret, costUs);
+            } else if (RT_ERR_END_OF_STREAM == ret) {
+                RT_LOGD("end of stream, %lld bytes fetched", mTotalBytes);
+                mEos = RT_TRUE;
+            } else if (!mAbort) {
+                RT_LOGE("fail to fetch bytes at %lld, err: %d", mWritePos, ret);
+                mError = ret;
+            }
+            mRingCond->broadcast();
+        }
+    }
+    RT_LOGD_IF(DEBUG_FLAG, "task done");
+    return RT_OK;
+}
+
+/*
+ * caller holds mRingLock. idle time of I/O thread isn't counted, so that
+ * the result is bandwidth of link rather than consuming speed of demuxer.
+ */
+void RTPktSourceNetwork::updateBandwidth(INT32 bytes, INT64 costUs) {
+    mWindowBytes += bytes;
+    mWindowUs    += costUs;
+    if (mWindowUs < NETWORK_BANDWIDTH_WINDOW) {
+        return;
+    }
+
+    INT64 sample  = mWindowBytes * 8 * 1000000 / mWindowUs;
+    mBandwidth    = (0 == mBandwidth) ? sample : (mBandwidth * 3 + sample) / 4;
+    mWindowBytes  = 0ll;
+    mWindowUs     = 0ll;
+    RT_LOGD_IF(DEBUG_FLAG, "bandwidth: %lld bps, sample: %lld bps", mBandwidth, sample);
+    updateCacheWater();
+}
+
+/*
+ * caller holds mRingLock. packet caches grow when bandwidth isn't far
+ * above bitrate of stream, so that demuxer can ride out network stalls.
+ */
+void RTPktSourceNetwork::updateCacheWater() {
+    if ((mBitrate <= 0) || (mBandwidth <= 0) || (mBaseHighWater <= 0)) {
+        return;
+    }
+
+    INT64 highWater = mBaseHighWater;
+    if (mBandwidth < mBitrate * 3 / 2) {
+        highWater = mBaseHighWater * 3;
+    } else if (mBandwidth < mBitrate * 3) {
+        highWater = mBaseHighWater * 2;
+    }
+
+    RtMutex::RtAutolock autoLock(mQueueLock);
+    if (mVideoCache->mHighWaterCacheDuration != highWater) {
+        RT_LOGD("bandwidth: %lld bps, bitrate: %lld bps, cache duration: %lld -> %lld",
+                 mBandwidth, mBitrate, mVideoCache->mHighWaterCacheDuration, highWater);
+    }
+    mVideoCache->mHighWaterCacheDuration = highWater;
+    mAudioCache->mHighWaterCacheDuration = highWater;
+}
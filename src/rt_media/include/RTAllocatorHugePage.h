@@ -0,0 +1,73 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * module: huge page allocator
+ */
+
+#ifndef SRC_RT_MEDIA_INCLUDE_RTALLOCATORHUGEPAGE_H_
+#define SRC_RT_MEDIA_INCLUDE_RTALLOCATORHUGEPAGE_H_
+
+#include "rt_header.h"  // NOLINT
+#include "RTAllocatorBase.h" // NOLINT
+
+#define RT_HUGEPAGE_SIZE            (2 << 20)
+// buffers smaller than it are not frame buffers, they are malloced
+#define RT_HUGEPAGE_MIN_BUFFER      (RT_HUGEPAGE_SIZE / 2)
+// cached buffers are bucketed by huge pages, bigger ones are not cached
+#define RT_HUGEPAGE_BUCKETS         32
+#define RT_HUGEPAGE_CACHE_CAP       (128ll << 20)
+
+typedef struct _RtHugePageStat {
+    INT64   mMappedBytes;   // frame buffers which are mapped, in use and cached
+    INT64   mCachedBytes;
+    INT64   mCapBytes;
+    INT32   mHugeTlbs;      // mappings from hugetlbfs pool, others are THP advised
+    INT32   mHits;          // new buffers which are taken from cache
+    INT32   mMisses;
+} RtHugePageStat;
+
+/*
+ * frame buffers are mapped in huge pages, from hugetlbfs pool if reserved,
+ * otherwise 2MB aligned and advised for transparent huge pages. pages are
+ * faulted in on mapping. freed buffers go to a cache of the process, so
+ * buffer pools of next prepare take them without mapping again. cache is
+ * limited by kKeyMemCacheCap of config, buffers over it are unmapped.
+ */
+class RTAllocatorHugePage : public RTAllocator {
+ public:
+    explicit RTAllocatorHugePage(RtMetaData *config);
+    ~RTAllocatorHugePage();
+
+    virtual const char* getName() { return "RTAllocatorHugePage"; }
+    virtual void summary(INT32 fd);
+
+    static RT_BOOL checkAvail();
+    virtual RT_RET newBuffer(UINT32 capacity, RTMediaBuffer **buffer);
+    virtual RT_RET newBuffer(UINT32 width,
+                             UINT32 height,
+                             UINT32 format,
+                             RTMediaBuffer **buffer);
+
+    virtual RT_RET freeBuffer(RTMediaBuffer **buffer);
+
+    RT_RET init(RtMetaData *meta);
+    RT_RET deinit();
+
+    static void   getStat(RtHugePageStat *stat);
+    // unmaps all cached buffers, buffers in use are not touched
+    static void   trimCache();
+};
+
+#endif  // SRC_RT_MEDIA_INCLUDE_RTALLOCATORHUGEPAGE_H_
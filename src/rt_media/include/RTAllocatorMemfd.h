@@ -0,0 +1,69 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * module: memfd allocator
+ */
+
+#ifndef SRC_RT_MEDIA_INCLUDE_RTALLOCATORMEMFD_H_
+#define SRC_RT_MEDIA_INCLUDE_RTALLOCATORMEMFD_H_
+
+#include "rt_header.h"  // NOLINT
+#include "RTAllocatorBase.h" // NOLINT
+
+#define RT_MEMFD_CACHE_CAP          (64ll << 20)
+
+class RtMutex;
+struct RtHashTable;
+struct _RtMemfdRegion;
+
+/*
+ * buffers are memfd regions mapped shared, fd of RTMediaBuffer can be sent
+ * to other processes, which map the same pages without copy. regions are
+ * sealed against resize by default, kKeyMemSeals of config takes F_SEAL_*
+ * and 0 disables it. freed regions are kept for new buffers of same pages
+ * up to kKeyMemCacheCap bytes, fd of a buffer is valid until it is freed.
+ */
+class RTAllocatorMemfd : public RTAllocator {
+ public:
+    explicit RTAllocatorMemfd(RtMetaData *config);
+    ~RTAllocatorMemfd();
+
+    virtual const char* getName() { return "RTAllocatorMemfd"; }
+    virtual void summary(INT32 fd);
+
+    static RT_BOOL checkAvail();
+    virtual RT_RET newBuffer(UINT32 capacity, RTMediaBuffer **buffer);
+    virtual RT_RET newBuffer(UINT32 width,
+                             UINT32 height,
+                             UINT32 format,
+                             RTMediaBuffer **buffer);
+
+    virtual RT_RET freeBuffer(RTMediaBuffer **buffer);
+
+    RT_RET init(RtMetaData *meta);
+    RT_RET deinit();
+
+ private:
+    RtMutex                *mLock;
+    struct RtHashTable     *mRegions;       // data -> region, in use and cached
+    struct _RtMemfdRegion  *mFree;
+    INT64                   mCachedBytes;
+    INT64                   mCapBytes;
+    INT32                   mSeals;
+    INT32                   mPageSize;
+    UINT32                  mCount;
+};
+
+#endif  // SRC_RT_MEDIA_INCLUDE_RTALLOCATORMEMFD_H_
@@ -38,6 +38,8 @@ class RTAllocatorStore : public RTObject {
          * eg: linux. android. windows
          */
         RT_ALLOC_TYPE_PLATFORM_BASE = 0x100,
+        RT_ALLOC_TYPE_HUGEPAGE,
+        RT_ALLOC_TYPE_MEMFD,
 
         /*
          * allocator by vendor,
@@ -62,6 +64,8 @@ class RTAllocatorStore : public RTObject {
     static RTAllocator *fetchIonAllocator(RtMetaData *config);
     static RTAllocator *fetchDrmAllocator(RtMetaData *config);
     static RTAllocator *fetchGrallocAllocator(RtMetaData *config);
+    static RTAllocator *fetchHugePageAllocator(RtMetaData *config);
+    static RTAllocator *fetchMemfdAllocator(RtMetaData *config);
     static RTAllocator *fetchMallocAllocator(RtMetaData* config);
 };
 
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * module: audio time stretch (WSOLA), tempo is changed and pitch is kept.
+ *         interleaved S16 or float pcm, not thread-safe.
+ */
+
+#ifndef SRC_RT_MEDIA_INCLUDE_RTAUDIOSTRETCH_H_
+#define SRC_RT_MEDIA_INCLUDE_RTAUDIOSTRETCH_H_
+
+#include "rt_header.h"      // NOLINT
+#include "RTMediaDef.h"     // NOLINT
+#include "RTObject.h"       // NOLINT
+
+#define AUDIO_STRETCH_MIN_RATE      0.5f
+#define AUDIO_STRETCH_MAX_RATE      2.0f
+
+class RTAudioStretch : public RTObject {
+ public:
+    RTAudioStretch(INT32 sampleRate, INT32 channels, RTSampleFormat format = RT_SAMPLE_FMT_S16);
+    virtual ~RTAudioStretch();
+
+    // rate is changed on the fly, 1.0 copies pcm as it is
+    RT_RET  setRate(float rate);
+    float   getRate();
+
+    // pts of input is kept only when input queue is empty
+    RT_RET  queueInput(const void *data, INT32 bytes, INT64 ptsUs);
+    INT32   readOutput(void *data, INT32 bytes);
+    INT32   availableOutput();
+    INT32   pendingInput();
+    // media time of the first sample to read
+    INT64   getOutputPts();
+    void    flush();
+
+    RT_BOOL isCompatible(INT32 sampleRate, INT32 channels, RTSampleFormat format);
+
+    // override pure virtual methods of RTObject class
+    virtual const char* getName() { return "RTAudioStretch"; }
+    virtual void summary(INT32 fd);
+
+ private:
+    void    process();
+    INT32   seekBestOffset(const UINT8 *input);
+    float   correlate(const UINT8 *input);
+    void    overlapMix(const UINT8 *input, UINT8 *output);
+    UINT8*  reserveOutput(INT32 bytes);
+
+ private:
+    INT32           mSampleRate;
+    INT32           mChannels;
+    RTSampleFormat  mFormat;
+    INT32           mFrameBytes;
+    float           mRate;
+
+    // in frames: sequence of output, overlap of sequences, search window
+    INT32           mSeqFrames;
+    INT32           mOverlapFrames;
+    INT32           mSeekFrames;
+
+    UINT8          *mInput;
+    INT32           mInputCapacity;
+    INT32           mInputHead;
+    INT32           mInputTail;
+    INT64           mInputPtsUs;
+
+    UINT8          *mOutput;
+    INT32           mOutputCapacity;
+    INT32           mOutputHead;
+    INT32           mOutputTail;
+    INT64           mOutputPtsUs;
+
+    // tail of last sequence, mixed with head of next sequence
+    UINT8          *mOverlap;
+    RT_BOOL         mOverlapValid;
+    double          mSkipFraction;
+};
+
+#endif  // SRC_RT_MEDIA_INCLUDE_RTAUDIOSTRETCH_H_
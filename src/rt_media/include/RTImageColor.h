@@ -0,0 +1,59 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * module: colour conversion of yuv420 to rgb, kernels of simd are picked
+ *         by features of cpu, results are the same as the scalar one.
+ */
+
+#ifndef SRC_RT_MEDIA_INCLUDE_RTIMAGECOLOR_H_
+#define SRC_RT_MEDIA_INCLUDE_RTIMAGECOLOR_H_
+
+#include "rt_header.h"      // NOLINT
+#include "RTMediaDef.h"     // NOLINT
+#include "RTMediaPixel.h"   // NOLINT
+
+// order of bytes in memory
+typedef enum _RTImageRGBFormat {
+    RT_IMAGE_RGB24 = 0,
+    RT_IMAGE_RGBA32,
+    RT_IMAGE_BGRA32,
+} RTImageRGBFormat;
+
+/*
+ * RT_FMT_YUV420P has Y/U/V planes, RT_FMT_YUV420SP(NV12) and
+ * RT_FMT_YUV420SP_VU(NV21) have Y/UV planes. size can be odd.
+ */
+typedef struct _RTImageYUV {
+    const UINT8    *mPlane[3];
+    INT32           mStride[3];
+    INT32           mWidth;
+    INT32           mHeight;
+    RtVideoFormat   mFormat;
+} RTImageYUV;
+
+/*
+ * RTCOL_SPC_BT709 is BT.709, others are BT.601.
+ * RTCOL_RANGE_JPEG is full range, others are limited range.
+ */
+RT_RET rt_image_yuv_to_rgb(const RTImageYUV *src, UINT8 *dst, INT32 dstStride, RTImageRGBFormat dstFormat,
+                           RTColorSpace space = RTCOL_SPC_BT470BG, RTColorRange range = RTCOL_RANGE_MPEG);
+
+/*
+ * kernels are limited to RT_CPU_FEATURE_xxx of mask, 0 is the scalar one.
+ * returns features used before, it is for tests and benchmarks.
+ */
+UINT32 rt_image_color_set_features(UINT32 mask);
+
+#endif  // SRC_RT_MEDIA_INCLUDE_RTIMAGECOLOR_H_
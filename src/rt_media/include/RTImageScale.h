@@ -0,0 +1,58 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * module: scale of 8 bits planes, 2x2 box halving then bilinear or bicubic.
+ */
+
+#ifndef SRC_RT_MEDIA_INCLUDE_RTIMAGESCALE_H_
+#define SRC_RT_MEDIA_INCLUDE_RTIMAGESCALE_H_
+
+#include "rt_header.h"      // NOLINT
+
+typedef enum _RTImageScaleMode {
+    RT_IMAGE_SCALE_BILINEAR = 0,
+    RT_IMAGE_SCALE_BICUBIC,             // catmull-rom, sharper but slower
+} RTImageScaleMode;
+
+/*
+ * plane is halved while it's twice larger than target in both directions,
+ * the rest is done by bilinear, so that downscale by any ratio isn't aliased.
+ */
+RT_RET rt_image_scale_plane(const UINT8 *src, INT32 srcStride, INT32 srcW, INT32 srcH,
+                            UINT8 *dst, INT32 dstStride, INT32 dstW, INT32 dstH);
+
+/*
+ * rows [sliceY, sliceY + sliceH) of dst only, slices of a plane can be
+ * scaled by threads at the same time, results are the same as a whole.
+ */
+RT_RET rt_image_scale_plane_slice(const UINT8 *src, INT32 srcStride, INT32 srcW, INT32 srcH,
+                                  UINT8 *dst, INT32 dstStride, INT32 dstW, INT32 dstH,
+                                  RTImageScaleMode mode, INT32 sliceY, INT32 sliceH);
+
+/*
+ * dst is yuv420p with packed planes, dstW and dstH are even.
+ */
+RT_RET rt_image_scale_yuv420(UINT8 *const src[3], const INT32 srcStride[3], INT32 srcW, INT32 srcH,
+                             UINT8 *dst, INT32 dstW, INT32 dstH);
+
+/*
+ * rows [sliceY, sliceY + sliceH) of luma and the half of chroma,
+ * dstW, dstH, sliceY and sliceH are even.
+ */
+RT_RET rt_image_scale_yuv420_slice(const UINT8 *const src[3], const INT32 srcStride[3], INT32 srcW, INT32 srcH,
+                                   UINT8 *const dst[3], const INT32 dstStride[3], INT32 dstW, INT32 dstH,
+                                   RTImageScaleMode mode, INT32 sliceY, INT32 sliceH);
+
+#endif  // SRC_RT_MEDIA_INCLUDE_RTIMAGESCALE_H_
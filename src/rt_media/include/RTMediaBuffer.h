@@ -73,16 +73,31 @@ class RTMediaBuffer : public RTObject {
     RtMediaBufferStatus getStatus();
     RtMetaData* getMetaData();
 
-    // refs manage
+    /*
+     * refs manage. a buffer which is not referenced and not pooled is
+     * freed by release() of its owner. otherwise the last release() takes
+     * the single way back: buffer goes to its pool if it is pooled, or is
+     * freed by its allocator.
+     */
     void   addRefs();
     INT32  refsCount();
+    // takes the first reference of a buffer which is not referenced
+    RT_BOOL addRefsIfIdle();
     void   setObserver(RTMediaBufferObserver *observer);
+    // returns RT_TRUE when buffer is not referenced, then caller releases it
+    // once it is not returning
+    RT_BOOL detachObserver();
+    RT_BOOL isReturning();
+    // called by observer under its lock, returns RT_FALSE if buffer is detached
+    RT_BOOL finishReturn();
 
     // Clears meta data and resets the range to the full extent.
     void reset();
 
  private:
     void baseInit();
+    void freePacket();
+    void returnToOwner(RT_BOOL pooled);
 
  private:
     void*           mData;
@@ -95,7 +110,7 @@ class RTMediaBuffer : public RTObject {
     RT_BOOL         mOwnsData;
     RtMetaData     *mMetaData;
     RTAllocator    *mAllocator;
-    INT32           mRefCount;
+    INT32           mRefCount;      // refs, and flag of pooled
 
     RT_RAW_FREE     mFuncFree;
 
@@ -103,4 +118,57 @@ class RTMediaBuffer : public RTObject {
     RTMediaBufferObserver  *mObserver;
 };
 
+/*
+ * move-only handle of one reference of RTMediaBuffer, which is released
+ * when handle goes out of scope. it adopts the reference which is taken
+ * by caller, e.g. buffer of RTMediaBufferPool::acquireBuffer.
+ */
+class RTMediaBufferRef {
+ public:
+    RTMediaBufferRef() : mBuffer(RT_NULL) {}
+    explicit RTMediaBufferRef(RTMediaBuffer *buffer) : mBuffer(buffer) {}
+    RTMediaBufferRef(RTMediaBufferRef &&other) : mBuffer(other.detach()) {}
+    ~RTMediaBufferRef() { reset(); }
+
+    RTMediaBufferRef& operator=(RTMediaBufferRef &&other) {
+        if (this != &other) {
+            reset(other.detach());
+        }
+        return *this;
+    }
+
+    // another reference of the same buffer, for another thread
+    RTMediaBufferRef share() const {
+        if (RT_NULL != mBuffer) {
+            mBuffer->addRefs();
+        }
+        return RTMediaBufferRef(mBuffer);
+    }
+
+    RTMediaBuffer* get() const { return mBuffer; }
+    RTMediaBuffer* operator->() const { return mBuffer; }
+    explicit operator bool() const { return RT_NULL != mBuffer; }
+
+    // gives up the reference without release, e.g. to c api
+    RTMediaBuffer* detach() {
+        RTMediaBuffer *buffer = mBuffer;
+        mBuffer = RT_NULL;
+        return buffer;
+    }
+
+    void reset(RTMediaBuffer *buffer = RT_NULL) {
+        RTMediaBuffer *old = mBuffer;
+        mBuffer = buffer;
+        if (RT_NULL != old) {
+            old->release();
+        }
+    }
+
+ private:
+    RTMediaBufferRef(const RTMediaBufferRef &);
+    RTMediaBufferRef &operator=(const RTMediaBufferRef &);
+
+    RTMediaBuffer  *mBuffer;
+};
+
 #endif  // SRC_RT_MEDIA_INCLUDE_RTMEDIABUFFER_H_
@@ -30,6 +30,7 @@ class RTMediaBufferObserver {
     RTMediaBufferObserver() {}
     virtual ~RTMediaBufferObserver() {}
 
+    // buffer is returning, observer takes it by finishReturn() under its lock
     virtual void signalBufferReturned(RTMediaBuffer *buffer) = 0;
 
  private:
@@ -26,6 +26,8 @@
 
 typedef INT32 (*RT_RAW_FREE)(void*);
 
+#define RT_PACKET_FLAG_KEY  0x0001  // same as AV_PKT_FLAG_KEY
+
 typedef struct _RTPacket {
     INT64    mPts;
     INT64    mDts;
@@ -26,6 +26,7 @@ enum {
     kKeyFormatDuration   = MKTAG('f', 'd', 'u', 'r'),  // UINT64
     kKeyFormatEOS        = MKTAG('f', 'e', 'o', 's'),
     kKeyFormatUri        = MKTAG('f', 'u', 'r', 'i'),
+    kKeyFormatPushStream = MKTAG('f', 'p', 's', 'h'),  // RTMediaPushStream *
     kKeyUserAgent        = MKTAG('u', 's', 'a', 't'),
 
     /* common track features*/
@@ -56,6 +57,8 @@ enum {
     kKeyVCodecMaxBFrames     = MKTAG('m', 'b', 'f', 'm'),  // INT32 encoder feature
     kKeyVCodecRCMode         = MKTAG('v', 'r', 'c', 'm'),  // INT32 encoder feature
     kKeyVCodecQP             = MKTAG('v', 'c', 'q', 'p'),  // INT32 encoder feature
+    kKeyVCodecLowres         = MKTAG('v', 'l', 'r', 's'),  // INT32 decoder feature, 1/2^n of size
+    kKeyVCodecGlobalHeader   = MKTAG('v', 'g', 'h', 'd'),  // INT32 encoder feature, parameter sets in extradata
 
     /* audio track features*/
     kKeyACodecChanneLayout      = MKTAG('a', 'c', 'l', 't'),
@@ -99,15 +102,42 @@ enum {
     kKeyMemHeapMask         = MKTAG('m', 'h', 'm', 's'),  // INT32
     kKeyMemUsage            = MKTAG('m', 'e', 'u', 's'),  // INT32
     kKeyMemAllocator        = MKTAG('m', 'a', 'l', 'c'),  // RTAllocator *
+    kKeyMemCacheCap         = MKTAG('m', 'c', 'c', 'p'),  // INT64 bytes of freed frame buffers
+    kKeyMemSeals            = MKTAG('m', 's', 'e', 'l'),  // INT32 F_SEAL_* of memfd
 
     /* command options */
     kKeySeekTimeUs          = MKTAG('s', 't', 'u', 's'),  // INT64
     kKeySeekMode            = MKTAG('s', 'm', 'o', 'd'),  // INT32
+    kKeyTrickRate           = MKTAG('t', 'r', 'i', 'k'),  // INT32 1: normal, <0: rewind
+    kKeyTrackIndex          = MKTAG('t', 'i', 'd', 'x'),  // INT32 index of track in media
 
     /* media cache options */
     kKeyMaxCacheCount       = MKTAG('m', 'c', 'c', 't'),  // INT32
     kKeyMaxCacheSize        = MKTAG('m', 'c', 's', 'z'),  // INT32
     kKeyMaxCacheDuration    = MKTAG('m', 'c', 'd', 'r'),  // INT64
+
+    /* network source options */
+    kKeyReadAheadSize       = MKTAG('r', 'a', 'h', 'd'),  // INT32
+
+    /* sink options */
+    kKeySinkUri             = MKTAG('s', 'u', 'r', 'i'),  // const char*
+    kKeySinkShmSlots        = MKTAG('s', 's', 's', 'l'),  // INT32 frames in ring of shm sink
+    kKeySinkShmSlotSize     = MKTAG('s', 's', 's', 'z'),  // INT32 max bytes of a frame in ring
+
+    /* filter options */
+    kKeyFilterScaleMode     = MKTAG('f', 's', 'm', 'd'),  // INT32 RTImageScaleMode
+    kKeyFilterThreads       = MKTAG('f', 't', 'h', 'd'),  // INT32 threads of slices, 0: count of cpu
+
+    /* node statistics */
+    kKeyNodeStat            = MKTAG('n', 's', 't', 't'),  // pointer: RTNodeStat, filled by RT_NODE_CMD_STAT
+    kKeyNodeBusStat         = MKTAG('n', 'b', 's', 't'),  // pointer: RTNodeBusStat, filled by node bus
+    kKeyNodeLatencyUs       = MKTAG('n', 'l', 'a', 'v'),  // INT64 average processing time
+    kKeyNodeLatencyP99Us    = MKTAG('n', 'l', '9', '9'),  // INT64
+    kKeyNodeLatencyMaxUs    = MKTAG('n', 'l', 'm', 'x'),  // INT64
+
+    /* node scheduling */
+    kKeyNodeThreadClass     = MKTAG('n', 't', 'c', 'l'),  // INT32 RT_THREAD_CLASS, overrides class of stub
+    kKeyNodeExecutor        = MKTAG('n', 'e', 'x', 'e'),  // INT32 1: work on shared executor, overrides stub
 };
 
 #endif  // SRC_RT_MEDIA_INCLUDE_RTMEDIAMETAKEYS_H_
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * module: push stream, bytes written by caller are read by demuxer.
+ *         single writer and single reader, no lock in data path.
+ */
+
+#ifndef SRC_RT_MEDIA_INCLUDE_RTMEDIAPUSHSTREAM_H_
+#define SRC_RT_MEDIA_INCLUDE_RTMEDIAPUSHSTREAM_H_
+
+#include "rt_header.h"      // NOLINT
+#include "rt_mutex.h"       // NOLINT
+#include "RTObject.h"       // NOLINT
+
+#define PUSH_STREAM_DEFAULT_SIZE    (2 * 1024 * 1024)   // 2MB
+#define PUSH_STREAM_MAX_SEGMENTS    4096                // power of 2
+
+// called on reader thread when a lent buffer is consumed
+typedef void (*RT_PUSH_RELEASE_FUNC)(void* opaque, const void* data);
+
+typedef struct _RTPushSegment {
+    const UINT8            *mData;
+    INT32                   mSize;
+    INT32                   mRingBytes;     // bytes taken from ring, 0 for lent buffer
+    RT_PUSH_RELEASE_FUNC    mRelease;
+    void                   *mOpaque;
+} RTPushSegment;
+
+class RTMediaPushStream : public RTObject {
+ public:
+    explicit RTMediaPushStream(INT32 capacity = PUSH_STREAM_DEFAULT_SIZE);
+    virtual ~RTMediaPushStream();
+
+    // writer side: copy into ring, or lend buffer to reader (zero copy)
+    INT32   write(const UINT8 *data, INT32 size, RT_BOOL block = RT_TRUE);
+    RT_RET  lend(const UINT8 *data, INT32 size, RT_PUSH_RELEASE_FUNC release,
+                 void *opaque, RT_BOOL block = RT_TRUE);
+    RT_RET  writeEos();
+
+    // reader side, see fa_format_open_reader
+    INT32   read(UINT8 *buf, INT32 size);
+    static INT32 readBytes(void *stream, UINT8 *buf, INT32 size);
+
+    // interrupt wakes up reader, abort wakes up reader and writer for good
+    void    setInterrupt(RT_BOOL interrupt);
+    void    abort();
+
+    INT64   getBytesWritten();
+    INT64   getBytesRead();
+
+    // override pure virtual methods of RTObject class
+    virtual const char* getName() { return "RTMediaPushStream"; }
+    virtual void summary(INT32 fd);
+
+ private:
+    typedef RT_BOOL (RTMediaPushStream::*PushReadyFunc)();
+    RT_BOOL canRead();
+    RT_BOOL canWrite();
+    void    waitFor(volatile INT32 *waiting, PushReadyFunc ready);
+    void    wakeUp(volatile INT32 *waiting);
+    RT_BOOL publish(const UINT8 *data, INT32 size, INT32 ringBytes,
+                    RT_PUSH_RELEASE_FUNC release, void *opaque);
+
+ private:
+    UINT8              *mRing;
+    UINT32              mCapacity;
+    RTPushSegment      *mSegments;
+
+    // counters only grow and wrap, writer owns tails and reader owns heads
+    volatile UINT32     mRingHead;
+    volatile UINT32     mRingTail;
+    volatile UINT32     mSegHead;
+    volatile UINT32     mSegTail;
+    INT32               mSegOffset;
+
+    volatile INT32      mEos;
+    volatile INT32      mInterrupt;
+    volatile INT32      mAbort;
+    volatile INT32      mReaderWaiting;
+    volatile INT32      mWriterWaiting;
+    volatile INT64      mBytesWritten;
+    volatile INT64      mBytesRead;
+
+    // only for sleeping when ring is empty or full
+    RtMutex            *mWaitLock;
+    RtCondition        *mWaitCond;
+};
+
+#endif  // SRC_RT_MEDIA_INCLUDE_RTMEDIAPUSHSTREAM_H_
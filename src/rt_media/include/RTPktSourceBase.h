@@ -56,6 +56,8 @@ class RTPktSourceBase : public RTObject {
     virtual RT_RET start() = 0;
     virtual RT_RET stop() = 0;
     virtual RT_RET flush() = 0;
+    // drops packets of one track, e.g. packets of audio track not used any more
+    virtual RT_RET flushTrack(RTTrackType type) = 0;
 
     virtual INT32  getTotalCacheSize() = 0;
     virtual INT64  getAudioCacheDuration() = 0;
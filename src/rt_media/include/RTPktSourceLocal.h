@@ -35,6 +35,7 @@ class RTPktSourceLocal : public RTPktSourceBase {
     virtual RT_RET start();
     virtual RT_RET stop();
     virtual RT_RET flush();
+    virtual RT_RET flushTrack(RTTrackType type);
 
     virtual INT32  getTotalCacheSize();
     virtual INT64  getAudioCacheDuration();
@@ -49,7 +50,7 @@ class RTPktSourceLocal : public RTPktSourceBase {
     virtual const char* getName() { return "RTPktSourceLocal"; }
     virtual void summary(INT32 fd) {}
 
- private:
+ protected:
     RTMediaCache       *mVideoCache;
     RTMediaCache       *mAudioCache;
     RT_Deque           *mVideoPktQ;
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * module: network packet source, bytes are fetched by I/O thread
+ *         into a ring buffer, and read by demuxer thread.
+ */
+
+#ifndef SRC_RT_MEDIA_INCLUDE_RTPKTSOURCENETWORK_H_
+#define SRC_RT_MEDIA_INCLUDE_RTPKTSOURCENETWORK_H_
+
+#include "rt_header.h"           // NOLINT
+#include "rt_thread.h"           // NOLINT
+#include "RTPktSourceLocal.h"    // NOLINT
+
+struct FAIOContext;
+
+class RTPktSourceNetwork : public RTPktSourceLocal {
+ public:
+    RTPktSourceNetwork();
+    ~RTPktSourceNetwork();
+
+    // packet caches are inherited from RTPktSourceLocal
+    virtual RT_RET init(RtMetaData *config);
+    virtual RT_RET release();
+    virtual RT_RET start();
+    virtual RT_RET stop();
+
+    // byte stream for demuxer, see fa_format_open_reader
+    static INT32 readBytes(void *source, UINT8 *buf, INT32 size);
+    static INT64 seekBytes(void *source, INT64 offset, INT32 whence);
+
+    void    setStreamBitrate(INT64 bitrate);
+    INT64   getBandwidth();
+    INT64   getBufferedBytes();
+    RT_BOOL isEndOfStream();
+
+    // override pure virtual methods of RTObject class
+    virtual const char* getName() { return "RTPktSourceNetwork"; }
+    virtual void summary(INT32 fd);
+
+    RT_RET  runTask();
+    RT_BOOL isAborted();
+
+ private:
+    INT32   read(UINT8 *buf, INT32 size);
+    INT64   seek(INT64 offset, INT32 whence);
+    void    updateBandwidth(INT32 bytes, INT64 costUs);
+    void    updateCacheWater();
+
+ private:
+    FAIOContext        *mIOCtx;
+    RtThread           *mThread;
+    RtMutex            *mRingLock;
+    RtCondition        *mRingCond;
+
+    // ring buffer, positions are offsets of stream
+    UINT8              *mRing;
+    INT32               mRingSize;
+    INT32               mReadAhead;
+    INT32               mBackSize;
+    INT64               mTailPos;
+    INT64               mReadPos;
+    INT64               mWritePos;
+    INT64               mSeekPos;
+    INT64               mStreamSize;
+    UINT32              mSeekGen;
+    RT_BOOL             mFilling;
+    RT_BOOL             mEos;
+    RT_BOOL             mAbort;
+    RT_BOOL             mInterrupt;
+    INT32               mError;
+
+    // bandwidth in bits per second, measured while fetching
+    INT64               mWindowBytes;
+    INT64               mWindowUs;
+    INT64               mBandwidth;
+    INT64               mBitrate;
+    INT64               mTotalBytes;
+    INT64               mBaseHighWater;
+};
+
+#endif  // SRC_RT_MEDIA_INCLUDE_RTPKTSOURCENETWORK_H_
@@ -22,6 +22,8 @@
 #include "RTNodeCodec.h" // NOLINT
 #include "rt_header.h"   // NOLINT
 #include "rt_metadata.h" // NOLINT
+#include "RTMediaMetaKeys.h" // NOLINT
+#include "rt_trace.h"    // NOLINT
 
 #ifdef LOG_TAG
 #undef LOG_TAG
@@ -53,10 +55,44 @@ RT_RET check_warn(RTNode* pNode, RT_RET err, const char* func_name) {
 #define CHECK_ERR(pNode, err) check_err(pNode, err, __FUNCTION__)
 #define CHECK_WARN(pNode, err) check_warn(pNode, err, __FUNCTION__)
 
+/*
+ * class of stub is the default, and kKeyNodeThreadClass of config wins,
+ * so that application can move a node to other cores or priority.
+ */
+static RT_THREAD_CLASS node_thread_class(RTNode* pNode, RtMetaData* metadata) {
+    INT32       cls  = RT_THREAD_CLASS_DEFAULT;
+    RTNodeStub *stub = pNode->queryStub();
+    if (RT_NULL != stub) {
+        cls = stub->mThreadClass;
+    }
+    if ((RT_NULL != metadata) && metadata->findInt32(kKeyNodeThreadClass, &cls)
+         && ((cls < RT_THREAD_CLASS_DEFAULT) || (cls >= RT_THREAD_CLASS_MAX))) {
+        RT_LOGE("unknown thread class(%d) of node(%s)", cls, (RT_NULL != stub) ? stub->mNodeName : "");
+        cls = RT_THREAD_CLASS_DEFAULT;
+    }
+    return (RT_THREAD_CLASS)cls;
+}
+
+// lightweight players move nodes to executor, so that they cost no thread
+static RT_BOOL node_use_executor(RTNode* pNode, RtMetaData* metadata) {
+    INT32       shared = 0;
+    RTNodeStub *stub   = pNode->queryStub();
+    if (RT_NULL != stub) {
+        shared = stub->mUseExecutor;
+    }
+    if (RT_NULL != metadata) {
+        metadata->findInt32(kKeyNodeExecutor, &shared);
+    }
+    return (0 != shared) ? RT_TRUE : RT_FALSE;
+}
+
 RT_RET RTNodeAdapter::init(RTNode* pNode, RtMetaData* metadata) {
+    pNode->mThreadClass = node_thread_class(pNode, metadata);
+    pNode->mUseExecutor = node_use_executor(pNode, metadata);
     RT_RET  err  = pNode->init(metadata);
     pNode->mNext = RT_NULL;
     pNode->mPrev = RT_NULL;
+    rt_node_stat_reset(&pNode->mNodeStat);
     return CHECK_ERR(pNode, err);
 }
 
@@ -66,12 +102,22 @@ RT_RET RTNodeAdapter::release(RTNode* pNode) {
 }
 
 RT_RET RTNodeAdapter::pullBuffer(RTNode* pNode, RTMediaBuffer** data) {
+    RT_TRACE_SCOPE("node.pull", pNode->queryStub()->mNodeName);
     RT_RET err = pNode->pullBuffer(data);
+    if ((RT_OK == err) && (RT_NULL != data) && (RT_NULL != *data)) {
+        rt_node_stat_output(&pNode->mNodeStat, (*data)->getLength());
+    }
     return CHECK_WARN(pNode, err);
 }
 
 RT_RET RTNodeAdapter::pushBuffer(RTNode* pNode, RTMediaBuffer* data) {
-    RT_RET err = pNode->pushBuffer(data);
+    // buffer may be released by node at once, so length is taken before
+    RT_TRACE_SCOPE("node.push", pNode->queryStub()->mNodeName);
+    UINT32 bytes = (RT_NULL != data) ? data->getLength() : 0;
+    RT_RET err   = pNode->pushBuffer(data);
+    if (RT_OK == err) {
+        rt_node_stat_input(&pNode->mNodeStat, bytes);
+    }
     return CHECK_WARN(pNode, err);
 }
 
@@ -19,6 +19,7 @@
  */
 
 #include "rt_hash_table.h"    // NOLINT
+#include "rt_mutex.h"         // NOLINT
 
 #include "rt_string_utils.h"  // NOLINT
 #include "RTMediaMetaKeys.h"  // NOLINT
@@ -30,6 +31,9 @@
 #include "FFNodeDecoder.h"    // NOLINT
 #include "FFNodeEncoder.h"    // NOLINT
 #include "FFNodeDemuxer.h"    // NOLINT
+#include "FFNodeMuxer.h"      // NOLINT
+#include "RTSinkAudioFile.h"  // NOLINT
+#include "RTFilterVideoScale.h" // NOLINT
 
 #ifdef OS_LINUX
 #include "RTSinkAudioALSA.h"   // NOLINT
@@ -54,6 +58,8 @@
 #endif
 #define DEBUG_FLAG 0x1
 
+#define NODE_BUS_MAX_WARM   8
+
 typedef enum _NODE_BUS_STATE {
     NODE_ALL_EMPTY,
     NODE_ALL_OK,
@@ -71,12 +77,27 @@ struct NodeBusContext {
     RTAllocator    *mLinearAllocator;
     RtMetaData     *mVideoMeta;
     RtMetaData     *mAudioMeta;
+    // sink stubs set by user, override the default sinks
+    RTNodeStub     *mSinkStubs[BUS_LINE_MAX];
+    const char     *mSinkUri;
+    // released nodes keyed by stub, codec and format
+    RtHashTable    *mNodeWarm;
+    UINT32          mWarmCount;
+    // guards mNodeBus and mNodeWarm, lines may be built in parallel
+    RtMutex        *mNodeLock;
+    // init metadata of filter and encoder, they are kept by user of node
+    RtMetaData     *mFilterMeta;
+    RtMetaData     *mEncodeMeta;
+    // target size or format of video line, copied from user
+    RtMetaData     *mFilterOption;
 } NodeBusContext;
 
 RTNode* bus_find_and_add_demuxer(RTNodeBus *pNodeBus, RTMediaUri *setting);
 RTNode* bus_find_and_add_codec(RTNodeBus *pNodeBus, RTNode *demuxer, \
                          RTTrackType tType, BUS_LINE_TYPE lType);
 RTNode* bus_find_and_add_sink(RTNodeBus *pNodeBus, RTNode *codec, BUS_LINE_TYPE lType);
+static RTNode* bus_create_codec(RTNodeBus *pNodeBus, RtMetaData *node_meta, BUS_LINE_TYPE lType);
+RTNode* bus_find_and_add_node(RTNodeBus *pNodeBus, RT_NODE_TYPE nType, RtMetaData *nMeta);
 
 UINT32  node_hash_func(UINT32 bucktes, const void *key) {
     void *tmp_key = const_cast<void *>(key);
@@ -90,6 +111,10 @@ RTNodeBus::RTNodeBus() {
                                        hash_ptr_func, hash_ptr_compare);
     mBusCtx->mNodeAll = rt_hash_table_create((RT_NODE_TYPE_MAX - RT_NODE_TYPE_BASE),
                                        hash_ptr_func, hash_ptr_compare);
+    mBusCtx->mNodeWarm = rt_hash_table_create(NODE_BUS_MAX_WARM,
+                                       hash_ptr_func, hash_ptr_compare);
+    mBusCtx->mWarmCount = 0;
+    mBusCtx->mNodeLock  = new RtMutex();
     RT_LOGD("mBusCtx->mNodeBus = %p; mBusCtx->mNodeAll=%p", \
              mBusCtx->mNodeBus, mBusCtx->mNodeAll);
     mBusCtx->mSetting = RT_NULL;
@@ -109,10 +134,15 @@ RTNodeBus::~RTNodeBus() {
     RT_ASSERT(RT_NULL != mBusCtx);
 
     RT_LOGD("call, ~RTNodeBus");
+    // warm nodes hold buffers of linear allocator, release them first
+    clearWarmNodes();
+    rt_hash_table_destory(mBusCtx->mNodeWarm);
     rt_hash_table_destory(mBusCtx->mNodeBus);
     rt_hash_table_destory(mBusCtx->mNodeAll);
     mBusCtx->mNodeBus = RT_NULL;
     mBusCtx->mNodeAll = RT_NULL;
+    rt_safe_delete(mBusCtx->mNodeLock);
+    rt_safe_delete(mBusCtx->mFilterOption);
 
     // NodeBusSetting is released by its producer
     mBusCtx->mSetting = RT_NULL;
@@ -152,33 +182,14 @@ RT_RET RTNodeBus::registerMetadata(RtMetaData *codecMeta) {
     return RT_OK;
 }
 
-RT_RET RTNodeBus::autoBuildCodecSink() {
-    // create [codecs] by meta from demxuer
+RT_RET RTNodeBus::autoBuildCodecSink(RT_BOOL withSink /*= RT_TRUE*/) {
     RT_LOGD("RTNodeBus::autoBuildCodecSink");
-    RTNode *codec_v = bus_find_and_add_codec(this, mBusCtx->mDemuxer, \
-                                       RTTRACK_TYPE_VIDEO, BUS_LINE_VIDEO);
-    if (codec_v != RT_NULL) {
-        mBusCtx->mVideoMeta = RT_NULL;
-        nodeChainAppend(codec_v, BUS_LINE_VIDEO);
-    }
-    RTNode *codec_a = bus_find_and_add_codec(this, mBusCtx->mDemuxer, \
-                                       RTTRACK_TYPE_AUDIO, BUS_LINE_AUDIO);
-    if (codec_a != RT_NULL) {
-        mBusCtx->mAudioMeta = RT_NULL;
-        nodeChainAppend(codec_a, BUS_LINE_AUDIO);
-    }
+    autoBuildLine(BUS_LINE_VIDEO, withSink);
+    autoBuildLine(BUS_LINE_AUDIO, withSink);
     #if TODO_FLAG
     RTNode *codec_s = bus_find_and_add_codec(this, mBusCtx->mDemuxer, \
                                        RTTRACK_TYPE_SUBTITLE, BUS_LINE_SUBTE);
     nodeChainAppend(codec_s, BUS_LINE_SUBTE);
-    #endif
-
-    // create [sink] by meta from codecs
-    RTNode *sink_v = bus_find_and_add_sink(this, codec_v, BUS_LINE_VIDEO);
-    nodeChainAppend(sink_v, BUS_LINE_VIDEO);
-    RTNode *sink_a = bus_find_and_add_sink(this, codec_a, BUS_LINE_AUDIO);
-    nodeChainAppend(sink_a, BUS_LINE_AUDIO);
-    #if TODO_FLAG
     RTNode *sink_s = bus_find_and_add_sink(this, codec_s, BUS_LINE_SUBTE);
     nodeChainAppend(sink_s, BUS_LINE_SUBTE);
     #endif
@@ -191,6 +202,178 @@ RT_RET RTNodeBus::autoBuildCodecSink() {
     return RT_OK;
 }
 
+/*
+ * codec and sink of video or audio line. lines share no nodes, so that
+ * codec and sink of one line may be opened while the other line is built.
+ */
+RT_RET RTNodeBus::autoBuildLine(BUS_LINE_TYPE lType, RT_BOOL withSink /*= RT_TRUE*/) {
+    if ((BUS_LINE_VIDEO != lType) && (BUS_LINE_AUDIO != lType)) {
+        return RT_ERR_VALUE;
+    }
+
+    // create [codec] by meta from demxuer
+    RTTrackType tType = (BUS_LINE_VIDEO == lType) ? RTTRACK_TYPE_VIDEO : RTTRACK_TYPE_AUDIO;
+    RTNode *codec = bus_find_and_add_codec(this, mBusCtx->mDemuxer, tType, lType);
+    if (codec != RT_NULL) {
+        if (BUS_LINE_VIDEO == lType) {
+            mBusCtx->mVideoMeta = RT_NULL;
+        } else {
+            mBusCtx->mAudioMeta = RT_NULL;
+        }
+        nodeChainAppend(codec, lType);
+    }
+
+    // sinks are attached later, when sinks of other node-bus are reused.
+    if (!withSink) {
+        return RT_OK;
+    }
+
+    // create [filter] between codec and sink, if user asks for size or format
+    RTNode *upstream = codec;
+    if ((BUS_LINE_VIDEO == lType) && (RT_NULL != codec)) {
+        RTNode *filter = autoBuildFilter(codec, mBusCtx->mFilterOption);
+        upstream = (RT_NULL != filter) ? filter : codec;
+    }
+
+    // create [sink] by meta from codec or filter
+    RTNode *sink = bus_find_and_add_sink(this, upstream, lType);
+    nodeChainAppend(sink, lType);
+    return RT_OK;
+}
+
+/*
+ * filter of video line, it is chained after upstream if option asks for
+ * kKeyVCodecWidth/kKeyVCodecHeight other than size of upstream, or for
+ * kKeyCodecFormat. kKeyFilterScaleMode and kKeyFilterThreads are passed
+ * to the filter. NULL if no filter is needed or no filter stub is found.
+ */
+RTNode* RTNodeBus::autoBuildFilter(RTNode *upstream, RtMetaData *option) {
+    if ((RT_NULL == upstream) || (RT_NULL == option)) {
+        return RT_NULL;
+    }
+
+    RtMetaData *meta = upstream->queryFormat(RT_PORT_OUTPUT);
+    INT32 srcW = 0, srcH = 0, format = 0, scaleMode = 0, threads = 0;
+    meta->findInt32(kKeyFrameW, &srcW);
+    meta->findInt32(kKeyFrameH, &srcH);
+    INT32 dstW = srcW, dstH = srcH;
+    option->findInt32(kKeyVCodecWidth,  &dstW);
+    option->findInt32(kKeyVCodecHeight, &dstH);
+    RT_BOOL convert = option->findInt32(kKeyCodecFormat, &format);
+    if ((dstW == srcW) && (dstH == srcH) && !convert) {
+        return RT_NULL;
+    }
+
+    rt_safe_delete(mBusCtx->mFilterMeta);
+    mBusCtx->mFilterMeta = new RtMetaData();
+    mBusCtx->mFilterMeta->setInt32(kKeyFrameW, srcW);
+    mBusCtx->mFilterMeta->setInt32(kKeyFrameH, srcH);
+    mBusCtx->mFilterMeta->setInt32(kKeyVCodecWidth,  dstW);
+    mBusCtx->mFilterMeta->setInt32(kKeyVCodecHeight, dstH);
+    if (convert) {
+        mBusCtx->mFilterMeta->setInt32(kKeyCodecFormat, format);
+    }
+    if (option->findInt32(kKeyFilterScaleMode, &scaleMode)) {
+        mBusCtx->mFilterMeta->setInt32(kKeyFilterScaleMode, scaleMode);
+    }
+    if (option->findInt32(kKeyFilterThreads, &threads)) {
+        mBusCtx->mFilterMeta->setInt32(kKeyFilterThreads, threads);
+    }
+    RTNode *filter = bus_find_and_add_node(this, RT_NODE_TYPE_FILTER, mBusCtx->mFilterMeta);
+    if (RT_NULL == filter) {
+        RT_LOGE("%-16s -> no filter, size(%dx%d) is kept", mBusLineNames[BUS_LINE_VIDEO].name, srcW, srcH);
+        return RT_NULL;
+    }
+    nodeChainAppend(filter, BUS_LINE_VIDEO);
+    return filter;
+}
+
+RT_RET RTNodeBus::setFilterOption(RtMetaData *option) {
+    rt_safe_delete(mBusCtx->mFilterOption);
+    if (RT_NULL != option) {
+        mBusCtx->mFilterOption = new RtMetaData(*option);
+    }
+    return RT_OK;
+}
+
+/*
+ * video is transcoded, nodes are chained in order of data flow.
+ * option: kKeySinkUri of output file, kKeyCodecID of encoder, and optional
+ * kKeyVCodecWidth/kKeyVCodecHeight which need a filter of video line,
+ * kKeyFilterScaleMode and kKeyFilterThreads are passed to the filter.
+ * tracks of muxer are added by user of node-bus, such as audio copied.
+ */
+RT_RET RTNodeBus::autoBuildTranscode(RtMetaData *option) {
+    const char *uri = RT_NULL;
+    if ((RT_NULL == mBusCtx->mDemuxer) || (RT_NULL == option) || !option->findCString(kKeySinkUri, &uri)) {
+        RT_LOGE("invalid demuxer or output of transcoding");
+        return RT_ERR_VALUE;
+    }
+
+    // create [decoder] by meta from demuxer
+    RTNode *codec_v = bus_find_and_add_codec(this, mBusCtx->mDemuxer, \
+                                       RTTRACK_TYPE_VIDEO, BUS_LINE_VIDEO);
+    if (RT_NULL == codec_v) {
+        return RT_ERR_UNKNOWN;
+    }
+    nodeChainAppend(codec_v, BUS_LINE_VIDEO);
+
+    // create [muxer] before encoder, encoder follows needs of muxer
+    RtMetaData *nMeta = new RtMetaData();
+    nMeta->setCString(kKeyFormatUri, uri);
+    RTNode *muxer = bus_find_and_add_node(this, RT_NODE_TYPE_MUXER, nMeta);
+    rt_safe_delete(nMeta);
+    if (RT_NULL == muxer) {
+        return RT_ERR_UNKNOWN;
+    }
+
+    // create [filter] if size is changed, filter is optional
+    RTNode     *filter   = autoBuildFilter(codec_v, option);
+    RtMetaData *upstream = (RT_NULL != filter) ? filter->queryFormat(RT_PORT_OUTPUT)
+                                               : codec_v->queryFormat(RT_PORT_OUTPUT);
+    INT32 dstW = 0, dstH = 0;
+
+    // create [encoder] by meta of upstream and option
+    RtMetaData *track = mBusCtx->mDemuxer->queryTrackMeta(
+                            mBusCtx->mDemuxer->queryTrackUsed(RTTRACK_TYPE_VIDEO), RTTRACK_TYPE_VIDEO);
+    INT32 codecID   = RT_VIDEO_ID_AVC;
+    INT32 frameRate = 0;
+    INT32 gopSize   = 0;
+    INT64 bitrate   = 0;
+    INT32 global    = 0;
+    option->findInt32(kKeyCodecID, &codecID);
+    upstream->findInt32(kKeyFrameW, &dstW);
+    upstream->findInt32(kKeyFrameH, &dstH);
+    mBusCtx->mEncodeMeta = new RtMetaData();
+    mBusCtx->mEncodeMeta->setInt32(kKeyCodecType, RTTRACK_TYPE_VIDEO);
+    mBusCtx->mEncodeMeta->setInt32(kKeyCodecID, codecID);
+    mBusCtx->mEncodeMeta->setInt32(kKeyVCodecWidth,  dstW);
+    mBusCtx->mEncodeMeta->setInt32(kKeyVCodecHeight, dstH);
+    if ((RT_NULL != track) && track->findInt32(kKeyVCodecFrameRate, &frameRate)) {
+        mBusCtx->mEncodeMeta->setInt32(kKeyVCodecFrameRate, frameRate);
+    }
+    if (option->findInt64(kKeyCodecBitrate, &bitrate)) {
+        mBusCtx->mEncodeMeta->setInt64(kKeyCodecBitrate, bitrate);
+    }
+    if (option->findInt32(kKeyVCodecGopSize, &gopSize)) {
+        mBusCtx->mEncodeMeta->setInt32(kKeyVCodecGopSize, gopSize);
+    }
+    muxer->queryFormat(RT_PORT_INPUT)->findInt32(kKeyVCodecGlobalHeader, &global);
+    mBusCtx->mEncodeMeta->setInt32(kKeyVCodecGlobalHeader, global);
+    RTNode *encoder = bus_find_and_add_node(this, RT_NODE_TYPE_ENCODER, mBusCtx->mEncodeMeta);
+    if (RT_NULL == encoder) {
+        // muxer isn't in line, it is released here
+        rt_hash_table_remove(mBusCtx->mNodeBus, reinterpret_cast<void *>(RT_NODE_TYPE_MUXER), RT_FALSE);
+        rt_safe_delete(muxer);
+        return RT_ERR_UNKNOWN;
+    }
+    nodeChainAppend(encoder, BUS_LINE_VIDEO);
+    nodeChainAppend(muxer, BUS_LINE_VIDEO);
+
+    nodeChainDumper(BUS_LINE_VIDEO);
+    return RT_OK;
+}
+
 RTNode* RTNodeBus::getRootNode(BUS_LINE_TYPE lType) {
     return mBusCtx->mRootNodes[lType];
 }
@@ -214,6 +397,52 @@ RT_RET RTNodeBus::summary(INT32 fd, RT_BOOL full /*= RT_FALSE*/) {
     }
     RT_LOGD("dump used nodes in node_bus ... DONE!!!");
 
+    RTNodeBusStat *snapshot = rt_malloc(RTNodeBusStat);
+    if ((RT_NULL == snapshot) || (RT_OK != queryStat(snapshot))) {
+        rt_safe_free(snapshot);
+        return RT_OK;
+    }
+    RT_LOGD("%-14s | %-22s | %7s %7s | %9s %9s | %5s | %7s | %7s %7s %7s | %8s %8s",
+             "line", "node", "in", "out", "KB in", "KB out", "drop", "queue", "avg us", "p99 us", "max us",
+             "wait in", "wait out");
+    for (INT32 idx = 0; idx < snapshot->mCount; idx++) {
+        RTNodeStatEntry *entry = &snapshot->mNodes[idx];
+        RTNodeStat      *stat  = &entry->mStat;
+        RT_LOGD("%-14s | %-22s | %7lld %7lld | %9lld %9lld | %5lld | %3lld/%-3lld | %7lld %7lld %7lld "
+                 "| %6lldms %6lldms", mBusLineNames[entry->mLineType].name, entry->mNodeName,
+                 stat->mBufferIn, stat->mBufferOut, stat->mBytesIn / 1024, stat->mBytesOut / 1024,
+                 stat->mDrops, stat->mQueueDepth, stat->mQueueMax,
+                 stat->mProcUs / RT_MAX(stat->mProcCount, 1ull), rt_node_stat_percentile(stat, 99),
+                 stat->mProcMaxUs, stat->mWaitInputUs / 1000, stat->mWaitOutputUs / 1000);
+    }
+    rt_safe_free(snapshot);
+    return RT_OK;
+}
+
+RT_RET RTNodeBus::queryStat(RTNodeBusStat *snapshot) {
+    RT_ASSERT(RT_NULL != mBusCtx);
+    if (RT_NULL == snapshot) {
+        return RT_ERR_NULL_PTR;
+    }
+
+    RtMetaData *query = new RtMetaData();
+    snapshot->mTimeUs = RtTime::getNowTimeUs();
+    snapshot->mCount  = 0;
+    for (INT32 lType = BUS_LINE_ROOT; lType < BUS_LINE_MAX; lType++) {
+        RTNode *pNode = mBusCtx->mRootNodes[lType];
+        for (; (RT_NULL != pNode) && (snapshot->mCount < NODE_STAT_MAX_NODES); pNode = pNode->mNext) {
+            RTNodeStatEntry *entry = &snapshot->mNodes[snapshot->mCount++];
+            entry->mNodeName = pNode->queryStub()->mNodeName;
+            entry->mNodeType = pNode->queryStub()->mNodeType;
+            entry->mLineType = (BUS_LINE_TYPE)lType;
+            query->setPointer(kKeyNodeStat, reinterpret_cast<RT_PTR>(&entry->mStat));
+            if (RT_OK != pNode->runCmd(RT_NODE_CMD_STAT, query)) {
+                // nodes out of tree may not answer, counters of adapter are still there
+                rt_node_stat_copy(&entry->mStat, &pNode->mNodeStat);
+            }
+        }
+    }
+    rt_safe_delete(query);
     return RT_OK;
 }
 
@@ -227,6 +456,8 @@ RT_RET RTNodeBus::registerCoreStubs() {
     registerStub(&ff_node_demuxer);
     registerStub(&ff_node_decoder);
     registerStub(&ff_node_video_encoder);
+    registerStub(&ff_node_muxer);
+    registerStub(&rt_filter_video_scale);
     #ifdef OS_WINDOWS
     registerStub(&rt_sink_display_gles);
     registerStub(&rt_sink_audio_wasapi);
@@ -258,6 +489,14 @@ RTNodeStub* findStub(RT_NODE_TYPE nType, BUS_LINE_TYPE lType) {
     case RT_NODE_TYPE_ENCODER:
         stub = &ff_node_video_encoder;
         break;
+    case RT_NODE_TYPE_MUXER:
+        stub = &ff_node_muxer;
+        break;
+    case RT_NODE_TYPE_FILTER:
+        if (lType == BUS_LINE_VIDEO) {
+            stub = &rt_filter_video_scale;
+        }
+        break;
     case RT_NODE_TYPE_SINK:
         switch (lType) {
           case BUS_LINE_VIDEO:
@@ -297,6 +536,7 @@ RT_RET RTNodeBus::registerNode(RTNode *pNode) {
     INT32 nType  = pNode->queryStub()->mNodeType;
     pNode->mNext = RT_NULL;
     pNode->mPrev = RT_NULL;
+    RtMutex::RtAutolock autoLock(mBusCtx->mNodeLock);
     rt_hash_table_insert(mBusCtx->mNodeBus, reinterpret_cast<void*>(nType), pNode);
     return RT_OK;
 }
@@ -406,15 +646,20 @@ RT_RET RTNodeBus::releaseNodes() {
         if (pHead == RT_NULL) {
             continue;
         }
+        // nodes are recycled to warm pool if possible, keyed by input format
         while (pHead->mNext != RT_NULL) {
             pNode = pHead;
             while (pNode->mNext != RT_NULL) {
                 pNode = pNode->mNext;
             }
             pNode->mPrev->mNext = RT_NULL;
-            rt_safe_delete(pNode);
+            if (RT_OK != recycleNode(pNode, pNode->mPrev->queryFormat(RT_PORT_OUTPUT))) {
+                rt_safe_delete(pNode);
+            }
+        }
+        if (RT_OK != recycleNode(pHead, pHead->queryFormat(RT_PORT_INPUT))) {
+            rt_safe_delete(pHead);
         }
-        rt_safe_delete(pHead);
     }
     if (mBusCtx->mVideoMeta) {
         rt_safe_delete(mBusCtx->mVideoMeta);
@@ -424,9 +669,14 @@ RT_RET RTNodeBus::releaseNodes() {
         rt_safe_delete(mBusCtx->mAudioMeta);
         mBusCtx->mAudioMeta = RT_NULL;
     }
+    rt_safe_delete(mBusCtx->mFilterMeta);
+    rt_safe_delete(mBusCtx->mEncodeMeta);
     mBusCtx->mDemuxer = RT_NULL;
     clearNodeBus();
 
+    // released nodes must not be found any more
+    rt_hash_table_clear(mBusCtx->mNodeBus);
+
     return RT_OK;
 }
 
@@ -444,8 +694,13 @@ RT_RET RTNodeBus::nodeChainAppend(RTNode *pNode, BUS_LINE_TYPE lType) {
     if (RT_NULL == *nRoot) {
         *nRoot = pNode;
     } else {
-        (*nRoot)->mNext = pNode;
-        pNode->mPrev = *nRoot;
+        // node is appended to the tail, lines may be longer than codec and sink
+        RTNode *nTail = *nRoot;
+        while (RT_NULL != nTail->mNext) {
+            nTail = nTail->mNext;
+        }
+        nTail->mNext = pNode;
+        pNode->mPrev = nTail;
     }
     RT_LOGE("%-16s -> add RTNode(ptr=0x%p, name=%s)", mBusLineNames[lType].name,
                pNode, pNode->queryStub()->mNodeName);
@@ -485,6 +740,15 @@ RT_RET RTNodeBus::nodeChainDriver(RTNode *pNode, BUS_LINE_TYPE lType) {
 }
 
 RT_RET RTNodeBus::excuteCommand(RT_NODE_CMD cmd, RtMetaData *option) {
+    // statistics of nodes are gathered into one snapshot of kKeyNodeBusStat
+    if (RT_NODE_CMD_STAT == cmd) {
+        RTNodeBusStat *snapshot = RT_NULL;
+        if ((RT_NULL == option)
+              || !option->findPointer(kKeyNodeBusStat, reinterpret_cast<RT_PTR *>(&snapshot))) {
+            return RT_ERR_VALUE;
+        }
+        return queryStat(snapshot);
+    }
     RT_LOGD("node_bus delivers %s to active nodes", rt_node_cmd_name(cmd));
 
     RTNodeAdapter::runCmd(mBusCtx->mRootNodes[BUS_LINE_ROOT],   cmd, option);
@@ -500,6 +764,220 @@ RT_RET RTNodeBus::setMemAllocator(RtMetaData *option) {
     return RT_OK;
 }
 
+RT_RET RTNodeBus::setSinkStub(BUS_LINE_TYPE lType, RTNodeStub *nStub, const char* uri) {
+    if ((lType >= BUS_LINE_MAX) || ((RT_NULL != nStub) && (RT_NODE_TYPE_SINK != nStub->mNodeType))) {
+        RT_LOGE("%-16s -> invalid sink stub(%p)", mBusLineNames[lType].name, nStub);
+        return RT_ERR_VALUE;
+    }
+    // uri is released by its producer
+    mBusCtx->mSinkStubs[lType] = nStub;
+    mBusCtx->mSinkUri          = uri;
+    return RT_OK;
+}
+
+RTNodeStub* RTNodeBus::querySinkStub(BUS_LINE_TYPE lType) {
+    if (RT_NULL != mBusCtx->mSinkStubs[lType]) {
+        return mBusCtx->mSinkStubs[lType];
+    }
+    return ::findStub(RT_NODE_TYPE_SINK, lType);
+}
+
+RT_RET RTNodeBus::setSinkOption(RtMetaData *option) {
+    if (RT_NULL != mBusCtx->mSinkUri) {
+        option->setCString(kKeySinkUri, mBusCtx->mSinkUri);
+    }
+    return RT_OK;
+}
+
+/*
+ * take the sink away from node-chain and node-bus, but keep it alive.
+ * the caller owns the sink, and attaches it to other node-bus later.
+ */
+RTNode* RTNodeBus::detachSink(BUS_LINE_TYPE lType) {
+    RTNode* nRoot = mBusCtx->mRootNodes[lType];
+    if ((RT_NULL == nRoot) || (RT_NULL == nRoot->mNext)) {
+        return RT_NULL;
+    }
+
+    RTNode* nSink = nRoot->mNext;
+    if (RT_NODE_TYPE_SINK != nSink->queryStub()->mNodeType) {
+        return RT_NULL;
+    }
+    nRoot->mNext = RT_NULL;
+    nSink->mPrev = RT_NULL;
+    unregisterNode(nSink);
+    RT_LOGD("%-16s -> detach RTNode(ptr=0x%p, name=%s)", mBusLineNames[lType].name,
+               nSink, nSink->queryStub()->mNodeName);
+    return nSink;
+}
+
+/*
+ * create codec of a track of demuxer, it isn't added to node-bus until
+ * swapCodec(), so it is prepared while the current codec goes on.
+ */
+RTNode* RTNodeBus::buildTrackCodec(INT32 index, RTTrackType tType) {
+    BUS_LINE_TYPE lType = BUS_LINE_MAX;
+    switch (tType) {
+      case RTTRACK_TYPE_VIDEO:
+        lType = BUS_LINE_VIDEO;
+        break;
+      case RTTRACK_TYPE_AUDIO:
+        lType = BUS_LINE_AUDIO;
+        break;
+      default:
+        return RT_NULL;
+    }
+    if ((RT_NULL == mBusCtx->mDemuxer) || (index < 0)) {
+        return RT_NULL;
+    }
+
+    RtMetaData *node_meta = mBusCtx->mDemuxer->queryTrackMeta(index, tType);
+    rt_utils_dump_track(node_meta);
+    setMemAllocator(node_meta);
+    return bus_create_codec(this, node_meta, lType);
+}
+
+/*
+ * codec of the line is replaced by pCodec, the nodes after it are kept.
+ * the old codec is taken away from node-bus, the caller owns it.
+ */
+RTNode* RTNodeBus::swapCodec(RTNode *pCodec, BUS_LINE_TYPE lType) {
+    RTNode* nRoot = mBusCtx->mRootNodes[lType];
+    if ((RT_NULL == pCodec) || (RT_NULL == nRoot)) {
+        return RT_NULL;
+    }
+
+    registerNode(pCodec);
+    pCodec->mNext = nRoot->mNext;
+    if (RT_NULL != pCodec->mNext) {
+        pCodec->mNext->mPrev = pCodec;
+    }
+    mBusCtx->mRootNodes[lType] = pCodec;
+
+    nRoot->mNext = RT_NULL;
+    unregisterNode(nRoot);
+    RT_LOGD("%-16s -> swap RTNode(ptr=0x%p, name=%s) for RTNode(ptr=0x%p)",
+               mBusLineNames[lType].name, nRoot, nRoot->queryStub()->mNodeName, pCodec);
+    return nRoot;
+}
+
+// remove the node from node-bus, other nodes of same type are kept.
+RT_RET RTNodeBus::unregisterNode(RTNode *pNode) {
+    INT32 nType = pNode->queryStub()->mNodeType;
+    RtMutex::RtAutolock autoLock(mBusCtx->mNodeLock);
+    struct rt_hash_node* list = rt_hash_table_find_root(mBusCtx->mNodeBus,
+                                    reinterpret_cast<void *>(nType));
+    struct rt_hash_node* prev = list;
+    for (struct rt_hash_node* node = list->next; node != RT_NULL; node = node->next) {
+        if (node->data == pNode) {
+            prev->next = node->next;
+            rt_safe_free(node);
+            return RT_OK;
+        }
+        prev = node;
+    }
+    return RT_ERR_VALUE;
+}
+
+static UINT32 node_warm_key(RTNodeStub *nStub, RtMetaData *nMeta) {
+    static const UINT32 keys[] = {
+        kKeyCodecType, kKeyCodecID,
+        kKeyVCodecWidth, kKeyVCodecHeight, kKeyFrameW, kKeyFrameH,
+        kKeyACodecSampleRate, kKeyACodecChannels,
+    };
+    // FNV-1a over stub and format values
+    UINT32 hash = 2166136261u ^ rt_hash_table_string_hash(nStub->mNodeName);
+    for (UINT32 idx = 0; idx < sizeof(keys)/sizeof(keys[0]); idx++) {
+        INT32 value = 0;
+        nMeta->findInt32(keys[idx], &value);
+        hash = (hash ^ (UINT32)value) * 16777619u;
+    }
+    return hash;
+}
+
+/*
+ * find a released node of same stub and format, and re-init it by nMeta.
+ * codec contexts are re-created, but buffers, threads and device handles
+ * are kept, so that switching between compatible sources is cheap.
+ */
+RTNode* RTNodeBus::acquireWarmNode(RTNodeStub *nStub, RtMetaData *nMeta) {
+    if ((RT_NULL == nStub) || (RT_NULL == nMeta) || (!nStub->mRecyclable)) {
+        return RT_NULL;
+    }
+
+    UINT32  key   = node_warm_key(nStub, nMeta);
+    RTNode* pNode = RT_NULL;
+    {
+        RtMutex::RtAutolock autoLock(mBusCtx->mNodeLock);
+        struct rt_hash_node* hashNode = rt_hash_table_find_node(mBusCtx->mNodeWarm,
+                                            reinterpret_cast<void *>(key));
+        if (RT_NULL == hashNode) {
+            return RT_NULL;
+        }
+        pNode = reinterpret_cast<RTNode*>(hashNode->data);
+        rt_hash_table_remove(mBusCtx->mNodeWarm, reinterpret_cast<void *>(key));
+        mBusCtx->mWarmCount--;
+    }
+
+    if ((pNode->queryStub() != nStub) || (RT_OK != pNode->runCmd(RT_NODE_CMD_REINIT, nMeta))) {
+        RT_LOGD("fail to reuse RTNode(ptr=0x%p, name=%s)", pNode, nStub->mNodeName);
+        rt_safe_delete(pNode);
+        return RT_NULL;
+    }
+    RT_LOGD("done, reuse RTNode(ptr=0x%p, name=%s) key=0x%08x", pNode, nStub->mNodeName, key);
+    return pNode;
+}
+
+RT_RET RTNodeBus::recycleNode(RTNode *pNode, RtMetaData *nMeta) {
+    RTNodeStub* nStub = pNode->queryStub();
+    if ((RT_NULL == nMeta) || (!nStub->mRecyclable)) {
+        return RT_ERR_VALUE;
+    }
+    if (mBusCtx->mWarmCount >= NODE_BUS_MAX_WARM) {
+        return RT_ERR_LIST_FULL;
+    }
+
+    // node must be idle in warm pool: no thread, no queued buffers
+    pNode->mNext = RT_NULL;
+    pNode->mPrev = RT_NULL;
+    pNode->runCmd(RT_NODE_CMD_STOP, RT_NULL);
+    pNode->runCmd(RT_NODE_CMD_FLUSH, RT_NULL);
+
+    UINT32 key = node_warm_key(nStub, nMeta);
+    RtMutex::RtAutolock autoLock(mBusCtx->mNodeLock);
+    rt_hash_table_insert(mBusCtx->mNodeWarm, reinterpret_cast<void *>(key), pNode);
+    mBusCtx->mWarmCount++;
+    RT_LOGD("done, recycle RTNode(ptr=0x%p, name=%s) key=0x%08x", pNode, nStub->mNodeName, key);
+    return RT_OK;
+}
+
+RT_RET RTNodeBus::clearWarmNodes() {
+    struct rt_hash_node *list, *node;
+    UINT32 num_buckets = rt_hash_table_get_num_buckets(mBusCtx->mNodeWarm);
+    for (UINT32 bucket = 0; bucket < num_buckets; bucket++) {
+        list = rt_hash_table_get_bucket(mBusCtx->mNodeWarm, bucket);
+        for (node = list->next; node != RT_NULL; node = node->next) {
+            RTNode* pNode = reinterpret_cast<RTNode*>(node->data);
+            rt_safe_delete(pNode);
+        }
+    }
+    rt_hash_table_clear(mBusCtx->mNodeWarm);
+    mBusCtx->mWarmCount = 0;
+    return RT_OK;
+}
+
+RT_RET RTNodeBus::attachSink(RTNode *pSink, BUS_LINE_TYPE lType) {
+    if ((RT_NULL == pSink) || (RT_NULL == mBusCtx->mRootNodes[lType])) {
+        return RT_ERR_NULL_PTR;
+    }
+    if (RT_NULL != mBusCtx->mRootNodes[lType]->mNext) {
+        RT_LOGE("%-16s -> sink is attached already", mBusLineNames[lType].name);
+        return RT_ERR_BAD;
+    }
+    registerNode(pSink);
+    return nodeChainAppend(pSink, lType);
+}
+
 
 RT_RET RTNodeBus::clearNodeBus() {
     // @review: nodes be released when reset, NEED to clear root nodes.
@@ -530,6 +1008,9 @@ RTNode* bus_find_and_add_demuxer(RTNodeBus *pNodeBus, RTMediaUri *setting) {
         pMeta   =  new RtMetaData();
         pMeta->setCString(kKeyFormatUri, setting->mUri);
         pMeta->setCString(kKeyUserAgent, setting->mUserAgent);
+        if (RT_NULL != setting->mPushStream) {
+            pMeta->setPointer(kKeyFormatPushStream, setting->mPushStream);
+        }
         err = RTNodeAdapter::init(demuxer, pMeta);
         if (RT_OK != err) {
             // pMeta will delete by demuxer
@@ -552,9 +1033,7 @@ RTNode* bus_find_and_add_codec(RTNodeBus *pNodeBus, RTNode *demuxer, \
     }
 
     RtMetaData *node_meta   = RT_NULL;
-    RTNodeStub *node_stub   = RT_NULL;
     RTNode     *node_codec  = RT_NULL;
-    RT_RET      err         = RT_OK;
 
     if (RT_NULL != demuxer) {
         RTNodeDemuxer *pDemuxer = reinterpret_cast<RTNodeDemuxer*>(demuxer);
@@ -575,15 +1054,32 @@ RTNode* bus_find_and_add_codec(RTNodeBus *pNodeBus, RTNode *demuxer, \
         RT_LOGD("node_meta = %p", node_meta);
     }
 
-    if (RT_NULL != node_meta) {
-        // @TODO create codec by MIME
-        RTNodeInfo nodeInfo;
-        nodeInfo.mNodeType = RT_NODE_TYPE_DECODER;
-        nodeInfo.mLineType = lType;
-        node_stub = pNodeBus->findStub(&nodeInfo);
-        if (RT_NULL != demuxer) {
-            pNodeBus->setMemAllocator(node_meta);
-        }
+    if (RT_NULL == node_meta) {
+        RT_LOGE("%-16s -> invalid codec()", mBusLineNames[lType].name);
+        return RT_NULL;
+    }
+    if (RT_NULL != demuxer) {
+        pNodeBus->setMemAllocator(node_meta);
+    }
+
+    node_codec = bus_create_codec(pNodeBus, node_meta, lType);
+    if (RT_NULL != node_codec) {
+        pNodeBus->registerNode(node_codec);
+    }
+    return node_codec;
+}
+
+static RTNode* bus_create_codec(RTNodeBus *pNodeBus, RtMetaData *node_meta, BUS_LINE_TYPE lType) {
+    // @TODO create codec by MIME
+    RTNodeInfo nodeInfo;
+    nodeInfo.mNodeType = RT_NODE_TYPE_DECODER;
+    nodeInfo.mLineType = lType;
+    RTNodeStub *node_stub  = pNodeBus->findStub(&nodeInfo);
+
+    // reuse released codec of compatible source
+    RTNode     *node_codec = pNodeBus->acquireWarmNode(node_stub, node_meta);
+    if (RT_NULL != node_codec) {
+        return node_codec;
     }
 
     if (RT_NULL != node_stub) {
@@ -591,13 +1087,12 @@ RTNode* bus_find_and_add_codec(RTNodeBus *pNodeBus, RTNode *demuxer, \
     }
 
     if (RT_NULL != node_codec) {
-         err = RTNodeAdapter::init(node_codec, node_meta);
+        RT_RET err = RTNodeAdapter::init(node_codec, node_meta);
         if (RT_OK != err) {
             rt_safe_delete(node_meta);
             rt_safe_delete(node_codec);
             return RT_NULL;
         }
-        pNodeBus->registerNode(node_codec);
     } else {
         RT_LOGE("%-16s -> invalid codec()", mBusLineNames[lType].name);
     }
@@ -623,8 +1118,18 @@ RTNode* bus_find_and_add_sink(RTNodeBus *pNodeBus, RTNode *codec, BUS_LINE_TYPE
     }
 
     // @TODO create codec by MIME
-    RTNodeStub *nStub = findStub(RT_NODE_TYPE_SINK, lType);
-    RTNode     *nSink = (RT_NULL != nStub)?nStub->mCreateNode():RT_NULL;
+    RTNodeStub *nStub = pNodeBus->querySinkStub(lType);
+    if (RT_NULL != nMeta) {
+        pNodeBus->setSinkOption(nMeta);
+    }
+
+    // reuse released sink of compatible format, device is kept open
+    RTNode     *nSink = pNodeBus->acquireWarmNode(nStub, nMeta);
+    if (RT_NULL != nSink) {
+        pNodeBus->registerNode(nSink);
+        return nSink;
+    }
+    nSink = (RT_NULL != nStub)?nStub->mCreateNode():RT_NULL;
 
     if ((RT_NULL != nSink) && (RT_NULL != nMeta)) {
         err = RTNodeAdapter::init(nSink, nMeta);
@@ -640,3 +1145,27 @@ RTNode* bus_find_and_add_sink(RTNodeBus *pNodeBus, RTNode *codec, BUS_LINE_TYPE
     }
     return nSink;
 }
+
+/*
+ * node of line without demuxer, such as filter, encoder and muxer.
+ * nMeta is kept by user, node isn't released into warm pool.
+ */
+RTNode* bus_find_and_add_node(RTNodeBus *pNodeBus, RT_NODE_TYPE nType, RtMetaData *nMeta) {
+    RTNodeInfo nodeInfo;
+    nodeInfo.mNodeType = nType;
+    nodeInfo.mLineType = BUS_LINE_VIDEO;
+    RTNodeStub *nStub  = pNodeBus->findStub(&nodeInfo);
+    if (RT_NULL == nStub) {
+        RT_LOGE("%-16s -> no %s", mBusLineNames[BUS_LINE_VIDEO].name, rt_node_type_name(nType));
+        return RT_NULL;
+    }
+
+    RTNode *pNode = nStub->mCreateNode();
+    if ((RT_NULL == pNode) || (RT_OK != RTNodeAdapter::init(pNode, nMeta))) {
+        RT_LOGE("%-16s -> fail to init %s", mBusLineNames[BUS_LINE_VIDEO].name, nStub->mNodeName);
+        rt_safe_delete(pNode);
+        return RT_NULL;
+    }
+    pNodeBus->registerNode(pNode);
+    return pNode;
+}
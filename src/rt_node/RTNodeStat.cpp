@@ -0,0 +1,158 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: runtime statistics of node
+ */
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "RTNodeStat"
+
+#include "RTNodeStat.h"       // NOLINT
+#include "rt_metadata.h"      // NOLINT
+#include "RTMediaMetaKeys.h"  // NOLINT
+
+// counters are independent, so relaxed order is enough
+static inline void stat_add(volatile UINT64 *ptr, UINT64 value) {
+    __atomic_fetch_add(ptr, value, __ATOMIC_RELAXED);
+}
+
+static inline UINT64 stat_load(const volatile UINT64 *ptr) {
+    return __atomic_load_n(ptr, __ATOMIC_RELAXED);
+}
+
+static inline void stat_store(volatile UINT64 *ptr, UINT64 value) {
+    __atomic_store_n(ptr, value, __ATOMIC_RELAXED);
+}
+
+static inline void stat_max(volatile UINT64 *ptr, UINT64 value) {
+    UINT64 last = stat_load(ptr);
+    while ((last < value) && !__atomic_compare_exchange_n(ptr, &last, value, RT_TRUE,
+                                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+static inline INT32 stat_hist_bin(UINT64 costUs) {
+    INT32 bin = 0;
+    for (costUs /= NODE_STAT_HIST_BASE_US; (costUs > 0) && (bin < NODE_STAT_HIST_BINS - 1); costUs >>= 1) {
+        bin++;
+    }
+    return bin;
+}
+
+void rt_node_stat_reset(RTNodeStat *stat) {
+    rt_memset(stat, 0, sizeof(RTNodeStat));
+}
+
+void rt_node_stat_input(RTNodeStat *stat, UINT32 bytes) {
+    stat_add(&stat->mBufferIn, 1);
+    stat_add(&stat->mBytesIn, bytes);
+}
+
+void rt_node_stat_output(RTNodeStat *stat, UINT32 bytes) {
+    stat_add(&stat->mBufferOut, 1);
+    stat_add(&stat->mBytesOut, bytes);
+}
+
+void rt_node_stat_drop(RTNodeStat *stat, UINT32 count /* = 1 */) {
+    stat_add(&stat->mDrops, count);
+}
+
+void rt_node_stat_queue(RTNodeStat *stat, UINT32 depth) {
+    stat_store(&stat->mQueueDepth, depth);
+    stat_max(&stat->mQueueMax, depth);
+}
+
+void rt_node_stat_wait_input(RTNodeStat *stat, INT64 costUs) {
+    stat_add(&stat->mWaitInputUs, RT_MAX(costUs, 0ll));
+}
+
+void rt_node_stat_wait_output(RTNodeStat *stat, INT64 costUs) {
+    stat_add(&stat->mWaitOutputUs, RT_MAX(costUs, 0ll));
+}
+
+void rt_node_stat_process(RTNodeStat *stat, INT64 costUs) {
+    UINT64 cost = RT_MAX(costUs, 0ll);
+    stat_add(&stat->mProcCount, 1);
+    stat_add(&stat->mProcUs, cost);
+    stat_add(&stat->mProcHist[stat_hist_bin(cost)], 1);
+    stat_max(&stat->mProcMaxUs, cost);
+}
+
+// counters are copied one by one, they may be a little apart in time
+void rt_node_stat_copy(RTNodeStat *dst, const RTNodeStat *src) {
+    dst->mBufferIn     = stat_load(&src->mBufferIn);
+    dst->mBufferOut    = stat_load(&src->mBufferOut);
+    dst->mBytesIn      = stat_load(&src->mBytesIn);
+    dst->mBytesOut     = stat_load(&src->mBytesOut);
+    dst->mDrops        = stat_load(&src->mDrops);
+    dst->mQueueDepth   = stat_load(&src->mQueueDepth);
+    dst->mQueueMax     = stat_load(&src->mQueueMax);
+    dst->mWaitInputUs  = stat_load(&src->mWaitInputUs);
+    dst->mWaitOutputUs = stat_load(&src->mWaitOutputUs);
+    dst->mProcCount    = stat_load(&src->mProcCount);
+    dst->mProcUs       = stat_load(&src->mProcUs);
+    dst->mProcMaxUs    = stat_load(&src->mProcMaxUs);
+    for (INT32 bin = 0; bin < NODE_STAT_HIST_BINS; bin++) {
+        dst->mProcHist[bin] = stat_load(&src->mProcHist[bin]);
+    }
+}
+
+INT64 rt_node_stat_percentile(const RTNodeStat *stat, INT32 percent) {
+    UINT64 total = 0;
+    UINT64 hist[NODE_STAT_HIST_BINS];
+    for (INT32 bin = 0; bin < NODE_STAT_HIST_BINS; bin++) {
+        hist[bin] = stat_load(&stat->mProcHist[bin]);
+        total    += hist[bin];
+    }
+    if (0 == total) {
+        return 0;
+    }
+
+    UINT64 target = (total * RT_MIN(RT_MAX(percent, 1), 100) + 99) / 100;
+    UINT64 count  = 0;
+    for (INT32 bin = 0; bin < NODE_STAT_HIST_BINS - 1; bin++) {
+        count += hist[bin];
+        if (count >= target) {
+            return RT_MIN((INT64)NODE_STAT_HIST_BASE_US << bin, (INT64)stat_load(&stat->mProcMaxUs));
+        }
+    }
+    return (INT64)stat_load(&stat->mProcMaxUs);
+}
+
+RT_RET rt_node_stat_query(const RTNodeStat *stat, RT_NODE_CMD cmd, RtMetaData *metadata) {
+    RTNodeStat *copy = RT_NULL;
+    if (RT_NULL == metadata) {
+        return RT_ERR_NULL_PTR;
+    }
+    switch (cmd) {
+      case RT_NODE_CMD_STAT:
+        if (!metadata->findPointer(kKeyNodeStat, reinterpret_cast<RT_PTR *>(&copy)) || (RT_NULL == copy)) {
+            return RT_ERR_VALUE;
+        }
+        rt_node_stat_copy(copy, stat);
+        break;
+      case RT_NODE_CMD_LATENCY: {
+        UINT64 count = stat_load(&stat->mProcCount);
+        metadata->setInt64(kKeyNodeLatencyUs, (count > 0) ? (INT64)(stat_load(&stat->mProcUs) / count) : 0);
+        metadata->setInt64(kKeyNodeLatencyP99Us, rt_node_stat_percentile(stat, 99));
+        metadata->setInt64(kKeyNodeLatencyMaxUs, (INT64)stat_load(&stat->mProcMaxUs));
+      } break;
+      default:
+        return RT_ERR_UNIMPLIMENTED;
+    }
+    return RT_OK;
+}
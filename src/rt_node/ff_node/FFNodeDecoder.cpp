@@ -43,14 +43,15 @@
 #include "rt_message.h"             // NOLINT
 #include "RTAllocatorStore.h"       // NOLINT
 #include "RTAllocatorBase.h"        // NOLINT
+#include "RTNDKMediaDef.h"          // NOLINT
+#include "rt_trace.h"               // NOLINT
 
 #define MAX_INPUT_BUFFER_COUNT      30
 #define MAX_OUTPUT_BUFFER_COUNT     8
 
-void* ff_codec_loop(void* ptr_node) {
+static INT64 ff_codec_step(void* ptr_node) {
     FFNodeDecoder* node = reinterpret_cast<FFNodeDecoder*>(ptr_node);
-    node->runTask();
-    return RT_NULL;
+    return node->runStep();
 }
 
 RTObject *allocFFInputBuffer(void *arg) {
@@ -67,12 +68,18 @@ FFNodeDecoder::FFNodeDecoder()
           mMetaOutput(RT_NULL),
           mTrackType(RTTRACK_TYPE_UNKNOWN),
           mStarted(RT_FALSE),
+          mDraining(RT_FALSE),
+          mSeekTargetUs(-1),
+          mSeekBeginUs(0),
+          mSeekPending(RT_FALSE),
           mCountPull(0),
           mCountPush(0),
           mUsePool(RT_FALSE),
-          mByPass(RT_FALSE) {
-    mProcThread = new RtThread(ff_codec_loop, reinterpret_cast<void*>(this));
-    mProcThread->setName("FFDecoder");
+          mByPass(RT_FALSE),
+          mInput(RT_NULL),
+          mOutput(RT_NULL) {
+    mJob = new RtJob(ff_codec_step, reinterpret_cast<void*>(this));
+    mJob->setName("FFDecoder");
 
     mPacketQ = deque_create();
     RT_ASSERT(RT_NULL != mPacketQ);
@@ -153,6 +160,70 @@ RT_RET FFNodeDecoder::init(RtMetaData *metadata) {
     return RT_OK;
 }
 
+/*
+ * recycled by node-bus: codec context is re-created for new track, but
+ * buffer pools, buffers and thread of decoder are reused.
+ */
+RT_RET FFNodeDecoder::reinit(RtMetaData *metadata) {
+    RT_LOGD("call, reinit");
+    RTTrackType  trackType = RTTRACK_TYPE_UNKNOWN;
+    RTAllocator *allocator = RT_NULL;
+    if ((RT_NULL == mFFCodec) || (RT_NULL == metadata)) {
+        return RT_ERR_INIT;
+    }
+    metadata->findInt32(kKeyCodecType, reinterpret_cast<INT32 *>(&trackType));
+    metadata->findPointer(kKeyMemAllocator, reinterpret_cast<void **>(&allocator));
+    if ((trackType != mTrackType) || (allocator != mLinearAllocator)) {
+        RT_LOGE("fail to reinit, track type or allocator is changed");
+        return RT_ERR_VALUE;
+    }
+    if (RTTRACK_TYPE_VIDEO == mTrackType) {
+        INT32 width = 0, height = 0;
+        metadata->findInt32(kKeyVCodecWidth,  &width);
+        metadata->findInt32(kKeyVCodecHeight, &height);
+        if (width * height > mTrackParms->mVideoWidth * mTrackParms->mVideoHeight) {
+            RT_LOGE("fail to reinit, frame buffers are too small");
+            return RT_ERR_VALUE;
+        }
+    }
+
+    FACodecContext *ffCodec = fa_decode_create(metadata, mTrackType);
+    if (!ffCodec) {
+        RT_LOGE("fa_decode_create failed");
+        return RT_ERR_UNKNOWN;
+    }
+    fa_video_decode_destroy(&mFFCodec);
+    mFFCodec = ffCodec;
+
+    mByPass = RT_FALSE;
+    metadata->findInt32(kKeyCodecByePass, reinterpret_cast<INT32 *>(&mByPass));
+    if (mMetaInput != metadata) {
+        rt_safe_delete(mMetaInput);
+        mMetaInput = metadata;
+    }
+    rt_medatdata_goto_trackpar(metadata, mTrackParms);
+
+    switch (mTrackParms->mCodecType) {
+      case RTTRACK_TYPE_VIDEO:
+        mMetaOutput->setInt32(kKeyCodecID,  mTrackParms->mCodecID);
+        mMetaOutput->setInt32(kKeyFrameW,   mTrackParms->mVideoWidth);
+        mMetaOutput->setInt32(kKeyFrameH,   mTrackParms->mVideoHeight);
+        break;
+      case RTTRACK_TYPE_AUDIO:
+        mMetaOutput->setInt32(kKeyCodecID,          mTrackParms->mCodecID);
+        mMetaOutput->setInt32(kKeyACodecChannels,   mTrackParms->mAudioChannels);
+        mMetaOutput->setInt32(kKeyACodecSampleRate, mTrackParms->mAudioSampleRate);
+        break;
+      default:
+        break;
+    }
+    mCountPull   = 0;
+    mCountPush   = 0;
+    mSeekBeginUs = 0;
+    mSeekPending = RT_FALSE;
+    return RT_OK;
+}
+
 RT_RET FFNodeDecoder::allocateBuffersOnPort(RTPortType port) {
     UINT32 i = 0;
     RT_RET ret = RT_OK;
@@ -204,8 +275,8 @@ RT_RET FFNodeDecoder::release() {
     rt_safe_delete(mMetaInput);
     rt_safe_delete(mMetaOutput);
 
-    // thread release
-    rt_safe_delete(mProcThread);
+    // job release
+    rt_safe_delete(mJob);
 
     return RT_OK;
 }
@@ -251,6 +322,8 @@ RT_RET FFNodeDecoder::queueBuffer(RTMediaBuffer* data, RTPortType port) {
             if (data) {
                 RtMutex::RtAutolock autoLock(mLockPacketQ);
                 deque_push(mPacketQ, reinterpret_cast<void *>(data));
+                rt_node_stat_queue(&mNodeStat, deque_size(mPacketQ));
+                mJob->wake();
             } else {
                 RT_LOGE("data is NULL!");
                 ret = RT_ERR_UNKNOWN;
@@ -283,6 +356,9 @@ RT_RET FFNodeDecoder::runCmd(RT_NODE_CMD cmd, RtMetaData *metadata) {
     case RT_NODE_CMD_INIT:
         err = this->init(metadata);
         break;
+    case RT_NODE_CMD_REINIT:
+        err = this->reinit(metadata);
+        break;
     case RT_NODE_CMD_START:
         err = this->onStart();
         break;
@@ -298,8 +374,19 @@ RT_RET FFNodeDecoder::runCmd(RT_NODE_CMD cmd, RtMetaData *metadata) {
     case RT_NODE_CMD_RESET:
         err = this->onReset();
         break;
+    case RT_NODE_CMD_TRICKPLAY:
+        err = this->onTrickPlay(metadata);
+        break;
+    case RT_NODE_CMD_SEEK:
+        err = this->onSeek(metadata);
+        break;
     case RT_NODE_CMD_PREPARE:
         err = this->onPrepare();
+        break;
+    case RT_NODE_CMD_STAT:
+    case RT_NODE_CMD_LATENCY:
+        err = rt_node_stat_query(&mNodeStat, cmd, metadata);
+        break;
     default:
         RT_LOGE("unkown command: %d", cmd);
         err = RT_ERR_UNKNOWN;
@@ -320,6 +407,17 @@ void FFNodeDecoder::signalError(UINT32 what) {
     mEventLooper->post(msg, 0ll);
 }
 
+// latency from seek command to the first frame at target
+void FFNodeDecoder::signalFirstFrame() {
+    INT64 latencyUs = RtTime::getNowTimeUs() - mSeekBeginUs;
+    mSeekBeginUs = 0;
+    RT_LOGD("first frame after seek to %lldms, latency: %lldus", mSeekTargetUs/1000, latencyUs);
+    if (RT_NULL != mEventLooper) {
+        RTMessage *msg = new RTMessage(RT_MEDIA_INFO, RT_INFO_SEEK_FIRST_FRAME, latencyUs);
+        mEventLooper->post(msg, 0ll);
+    }
+}
+
 RtMetaData* FFNodeDecoder::queryFormat(RTPortType port) {
     RtMetaData *nMeta = RT_NULL;
     switch (port) {
@@ -339,99 +437,117 @@ RTNodeStub* FFNodeDecoder::queryStub() {
     return &ff_node_decoder;
 }
 
-RT_RET FFNodeDecoder::runTask() {
-    RTMediaBuffer *input  = RT_NULL;
-    RTMediaBuffer *output = RT_NULL;
-    while (THREAD_LOOP == mProcThread->getState()) {
-        RT_RET err = RT_OK;
+/*
+ * one round of decoding, returns the time to wait before next step.
+ */
+INT64 FFNodeDecoder::runStep() {
+    RT_RET err = RT_OK;
 
-        if (!mStarted) {
-            if (input) {
-                input->release();
-                input = RT_NULL;
-            }
-            RtTime::sleepMs(5);
-            continue;
+    if (!mStarted) {
+        if (mInput) {
+            mInput->release();
+            mInput = RT_NULL;
         }
+        return 5000;
+    }
 
-        if (!input) {
-            RtMutex::RtAutolock autoLock(mLockPacketQ);
-            RT_DequeEntry entry = deque_pop(mPacketQ);
-            if (entry.data) {
-                input = reinterpret_cast<RTMediaBuffer *>(entry.data);
-            }
-        }
-        if (!output) {
-            mFramePool->acquireBuffer(&output, RT_TRUE);
+    if (mSeekPending) {
+        // packets of old position are flushed, so is decoder
+        fa_decode_set_preroll(mFFCodec, mSeekTargetUs);
+        mSeekPending = RT_FALSE;
+        mDraining    = RT_FALSE;
+    }
+
+    if (!mInput && !mDraining) {
+        RtMutex::RtAutolock autoLock(mLockPacketQ);
+        RT_DequeEntry entry = deque_pop(mPacketQ);
+        if (entry.data) {
+            mInput = reinterpret_cast<RTMediaBuffer *>(entry.data);
         }
+    }
+    if (!mOutput) {
+        INT64 waitUs = RtTime::getNowTimeUs();
+        RT_TRACE_BEGIN("decoder", "acquire frame");
+        // worker of executor is not held by a full pool
+        mFramePool->acquireBuffer(&mOutput, mJob->isShared() ? RT_FALSE : RT_TRUE);
+        RT_TRACE_END("decoder", "acquire frame");
+        rt_node_stat_wait_output(&mNodeStat, RtTime::getNowTimeUs() - waitUs);
+    }
 
-        if (!input || !output || !mStarted) {
-            // when seek to target time, input packet may be old time.
-            RtTime::sleepMs(5);
-            continue;
+    if ((!mInput && !mDraining) || !mOutput || !mStarted) {
+        // when seek to target time, input packet may be old time.
+        if (!mInput && !mDraining) {
+            rt_node_stat_wait_input(&mNodeStat, 5000);
         }
+        return 5000;
+    }
 
-       if (mByPass == RT_TRUE) {
-            if (input->getSize() > 0) {
-                if (output->getSize() < input->getSize()) {
-                   memcpy(output->getData(), input->getData(), output->getSize());
-                } else {
-                   memcpy(output->getData(), input->getData(), input->getSize());
-                }
-                output->setRange(0, input->getSize());
+   if (mByPass == RT_TRUE) {
+        if (mInput->getSize() > 0) {
+            if (mOutput->getSize() < mInput->getSize()) {
+               memcpy(mOutput->getData(), mInput->getData(), mOutput->getSize());
             } else {
-                INT32 eos = 0;
-                input->getMetaData()->findInt32(kKeyFrameEOS, &eos);
-                if (eos) {
-                    output->getMetaData()->setInt32(kKeyFrameEOS, 1);
-                }
-                output->setRange(0, 0);
+               memcpy(mOutput->getData(), mInput->getData(), mInput->getSize());
             }
-            RT_LOGD("FFNodeDecoder::runTask output = %p, output->getData() = %p", output, output->getData());
-            input->release();
-            input = NULL;
-            output->getMetaData()->setInt32(kKeyACodecSampleRate, 24000);
-            output->getMetaData()->setInt32(kKeyACodecChannels, 1);
-            output->setStatus(RT_MEDIA_BUFFER_STATUS_READY);
-            RtMutex::RtAutolock autoLock(mLockFrameQ);
-            RT_LOGD("deque_size(mFrameQ) = %d", deque_size(mFrameQ));
-            deque_push(mFrameQ, output);
-            output = NULL;
+            mOutput->setRange(0, mInput->getSize());
         } else {
-            RT_LOGD_IF(DEBUG_FLAG, "input and output ready, go to decode!");
-            err = fa_decode_send_packet(mFFCodec, input);
-            if (err) {
-                if (err == RT_ERR_TIMEOUT) {
-                    RtTime::sleepMs(5);
-                }
-                continue;
-            } else {
-                input->release();
-                input = NULL;
+            INT32 eos = 0;
+            mInput->getMetaData()->findInt32(kKeyFrameEOS, &eos);
+            if (eos) {
+                mOutput->getMetaData()->setInt32(kKeyFrameEOS, 1);
             }
-            err = fa_decode_get_frame(mFFCodec, output);
+            mOutput->setRange(0, 0);
+        }
+        RT_LOGD("FFNodeDecoder::runStep output = %p, output->getData() = %p", mOutput, mOutput->getData());
+        mInput->release();
+        mInput = NULL;
+        mOutput->getMetaData()->setInt32(kKeyACodecSampleRate, 24000);
+        mOutput->getMetaData()->setInt32(kKeyACodecChannels, 1);
+        mOutput->setStatus(RT_MEDIA_BUFFER_STATUS_READY);
+        RtMutex::RtAutolock autoLock(mLockFrameQ);
+        RT_LOGD("deque_size(mFrameQ) = %d", deque_size(mFrameQ));
+        deque_push(mFrameQ, mOutput);
+        mOutput = NULL;
+    } else {
+        RT_LOGD_IF(DEBUG_FLAG, "input and output ready, go to decode!");
+        INT64 procUs = RtTime::getNowTimeUs();
+        if (mInput) {
+            RT_TRACE_BEGIN("decoder", "send packet");
+            err = fa_decode_send_packet(mFFCodec, mInput);
+            RT_TRACE_END("decoder", "send packet");
             if (err) {
-                continue;
-            } else {
-                if (output->getStatus() == RT_MEDIA_BUFFER_STATUS_READY) {
-                    RtMutex::RtAutolock autoLock(mLockFrameQ);
-                    deque_push(mFrameQ, output);
-                    output = NULL;
+                return (err == RT_ERR_TIMEOUT) ? 5000 : 0;
+            }
+            // frames held by decoder are taken without packets after EOS
+            INT32 eos = 0;
+            mInput->getMetaData()->findInt32(kKeyFrameEOS, &eos);
+            mDraining = eos ? RT_TRUE : RT_FALSE;
+            mInput->release();
+            mInput = NULL;
+        }
+        RT_TRACE_BEGIN("decoder", "receive frame");
+        err = fa_decode_get_frame(mFFCodec, mOutput);
+        RT_TRACE_END("decoder", "receive frame");
+        rt_node_stat_process(&mNodeStat, RtTime::getNowTimeUs() - procUs);
+        if (err) {
+            return 0;
+        } else {
+            if (mOutput->getStatus() == RT_MEDIA_BUFFER_STATUS_READY) {
+                INT32 eos = 0;
+                mOutput->getMetaData()->findInt32(kKeyFrameEOS, &eos);
+                if (eos) {
+                    mDraining = RT_FALSE;
                 }
+                if (mSeekBeginUs > 0) {
+                    signalFirstFrame();
+                }
+                RtMutex::RtAutolock autoLock(mLockFrameQ);
+                deque_push(mFrameQ, mOutput);
+                mOutput = NULL;
             }
         }
     }
-
-    if (input) {
-        input->release();
-        input = RT_NULL;
-    }
-    if (output) {
-        output->release();
-        output = RT_NULL;
-    }
-    RT_LOGD("exit ffmpeg decode run task");
-    return RT_OK;
+    return 0;
 }
 
 RT_RET FFNodeDecoder::onStart() {
@@ -454,8 +570,16 @@ RT_RET FFNodeDecoder::onStop() {
     mStarted = RT_FALSE;
     mFramePool->stop();
     mPacketPool->stop();
-    mProcThread->requestInterruption();
-    mProcThread->join();
+    mJob->stop();
+    if (mInput) {
+        mInput->release();
+        mInput = RT_NULL;
+    }
+    if (mOutput) {
+        mOutput->release();
+        mOutput = RT_NULL;
+    }
+    RT_LOGD("exit ffmpeg decode job");
     onFlush();
     return err;
 }
@@ -467,14 +591,49 @@ RT_RET FFNodeDecoder::onReset() {
 
 RT_RET FFNodeDecoder::onPrepare() {
     RT_LOGD("call, prepare");
-    mProcThread->start();
+    mJob->setShared(mUseExecutor);
+    mJob->setSchedClass(mThreadClass);
+    mJob->start();
+    return RT_OK;
+}
+
+/*
+ * only key frames are fed in trick play, references of them are never needed.
+ * decoder skips non-ref frames and loop filter, it is restored at normal rate.
+ */
+RT_RET FFNodeDecoder::onTrickPlay(RtMetaData *options) {
+    INT32 rate = 1;
+    if ((RT_NULL == options) || !options->findInt32(kKeyTrickRate, &rate)) {
+        return RT_ERR_VALUE;
+    }
+    RT_LOGD("call, trick play, rate: %d", rate);
+    fa_decode_set_trick(mFFCodec, (1 != rate) ? RT_TRUE : RT_FALSE);
+    return RT_OK;
+}
+
+/*
+ * exact seek: demuxer restarts at key frame before target, decoder drops
+ * frames before target without copy and skips non-ref frames of them.
+ * no preroll is armed in trick play, key frames there are all shown.
+ */
+RT_RET FFNodeDecoder::onSeek(RtMetaData *options) {
+    INT64 targetUs = 0;
+    if ((RT_NULL == options) || !options->findInt64(kKeySeekTimeUs, &targetUs)) {
+        return RT_ERR_VALUE;
+    }
+    RT_LOGD("call, seek, target: %lldms", targetUs/1000);
+    mSeekTargetUs = targetUs;
+    mSeekPending  = RT_TRUE;
+    // latency of seek is measured on video track
+    mSeekBeginUs  = (RTTRACK_TYPE_VIDEO == mTrackType) ? RtTime::getNowTimeUs() : 0;
     return RT_OK;
 }
 
 RT_RET FFNodeDecoder::onFlush() {
     RT_LOGD("call, flush");
     RT_RET ret = RT_OK;
-    mStarted = RT_FALSE;
+    mStarted  = RT_FALSE;
+    mDraining = RT_FALSE;
     while (deque_size(mPacketQ) > 0) {
         RtMutex::RtAutolock autoLock(mLockPacketQ);
         RTMediaBuffer *pkt  = RT_NULL;
@@ -484,6 +643,7 @@ RT_RET FFNodeDecoder::onFlush() {
         }
         if (pkt) {
             pkt->release();
+            rt_node_stat_drop(&mNodeStat);
         }
     }
     while (deque_size(mFrameQ) > 0) {
@@ -495,6 +655,7 @@ RT_RET FFNodeDecoder::onFlush() {
         }
         if (frame) {
             frame->release();
+            rt_node_stat_drop(&mNodeStat);
         }
     }
 
@@ -512,5 +673,8 @@ struct RTNodeStub ff_node_decoder {
     .mNodeName       = "ff_node_decoder",
     .mNodeRole       = "video,audio",
     .mNodeVersion    = "v1.0",
+    .mThreadClass    = RT_THREAD_CLASS_DECODE,
+    .mUseExecutor    = RT_TRUE,
+    .mRecyclable     = RT_TRUE,
 };
 
@@ -31,22 +31,36 @@
 #endif
 #define DEBUG_FLAG 0x0
 
+#include <string.h>              // NOLINT
+
 #include "rt_array_list.h"      // NOLINT
 #include "rt_buffer.h"          // NOLINT
 #include "rt_common.h"          // NOLINT
 #include "rt_mem.h"             // NOLINT
 #include "rt_metadata.h"        // NOLINT
 #include "rt_thread.h"          // NOLINT
+#include "rt_executor.h"        // NOLINT
 #include "RTPktSourceLocal.h"   // NOLINT
+#include "RTPktSourceNetwork.h" // NOLINT
+#include "RTMediaPushStream.h"  // NOLINT
 #include "RTMediaMetaKeys.h"    // NOLINT
+#include "RTNDKMediaDef.h"      // NOLINT
 #include "FFNodeDemuxer.h"      // NOLINT
 #include "FFMPEGAdapter.h"      // NOLINT
+#include "rt_message.h"         // NOLINT
+#include "rt_trace.h"           // NOLINT
+
+/*
+ * trick play: one key frame and TRICK_STEP_US of audio after it are played
+ * per step, then demuxer jumps rate * TRICK_STEP_US to the next key frame.
+ */
+#define TRICK_STEP_US           (200 * 1000ll)
 
 typedef struct _FFNodeDemuxerCtx {
     FAFormatContext    *mFormatCtx;
     RtMetaData         *mMetaInput;
 
-    RtThread           *mThread;
+    RtJob              *mJob;
     RTMsgLooper        *mEventLooper;
 
     RT_NODE_STATE       mNodeState;
@@ -60,14 +74,31 @@ typedef struct _FFNodeDemuxerCtx {
 
     INT32               mNeedSeek;
     INT64               mSeekTimeUs;
+    INT32               mErrCount;      // reading errors in a row
+    RT_BOOL             mBlockingRead;  // reading waits for bytes of others
+
+    // trick play: 1 is normal rate, >1 fast forward, <0 rewind
+    INT32               mTrickRate;
+    INT32               mTrickSeek;
+    INT64               mTrickPosUs;    // seek target of next step
+    INT64               mTrickKeyUs;    // key frame of this step, -1: searching
+    INT64               mTrickLastUs;   // key frame of last step
+
+    // audio track switching, it is applied by next step of demuxer
+    INT32               mSwitchAudio;
+    INT32               mSwitchIndex;
+    INT64               mSwitchTimeUs;  // audio is read again from here, -1: goes on
+    INT64               mVideoLastUs;   // pts of last queued video packet
+    INT64               mVideoSkipUs;   // video read again up to here is queued already
+    RT_BOOL             mVideoSkipEos;  // eos of video is queued already
 
     RTPktSourceBase    *mSource;
+    RTMediaPushStream  *mPushStream;    // push mode, owned by player
 } FFNodeDemuxerCtx;
 
-void* ff_demuxer_loop(void* ptr_node) {
+static INT64 ff_demuxer_step(void* ptr_node) {
     FFNodeDemuxer* nodeDemuxer = reinterpret_cast<FFNodeDemuxer*>(ptr_node);
-    nodeDemuxer->runTask();
-    return RT_NULL;
+    return nodeDemuxer->runStep();
 }
 
 FFNodeDemuxerCtx* get_demuxer_ctx(void* ptr_ctx) {
@@ -81,16 +112,19 @@ FFNodeDemuxerCtx* get_demuxer_ctx(void* ptr_ctx) {
 FFNodeDemuxer::FFNodeDemuxer() {
     FFNodeDemuxerCtx* ctx = rt_malloc(FFNodeDemuxerCtx);
     rt_memset(ctx, 0, sizeof(FFNodeDemuxerCtx));
+    ctx->mTrickRate   = 1;
+    ctx->mVideoLastUs = -1ll;
+    ctx->mVideoSkipUs = -1ll;
 
     /**
      * TODO (media source): source can be local/network/secure
-     * We should to implement different sources according to different scenarios
+     * local source is replaced by network source in init() for http(s) uri
      */
     ctx->mSource = new RTPktSourceLocal();
     RT_ASSERT(RT_NULL != ctx->mSource);
 
-    ctx->mThread = new RtThread(ff_demuxer_loop, reinterpret_cast<void*>(this));
-    ctx->mThread->setName("FFDemuxer");
+    ctx->mJob = new RtJob(ff_demuxer_step, reinterpret_cast<void*>(this));
+    ctx->mJob->setName("FFDemuxer");
 
     // save private context to mNodeContext
     mNodeContext = ctx;
@@ -102,6 +136,17 @@ FFNodeDemuxer::~FFNodeDemuxer() {
     RT_LOGD("done ~FFNodeDemuxer()");
 }
 
+/*
+ * bytes of http(s) stream are fetched by I/O thread of network source.
+ * segments of hls are opened by hls demuxer of ffmpeg, so it isn't included.
+ */
+static RT_BOOL demuxer_use_network_source(const char* uri) {
+    if (!strncasecmp("http://", uri, 7) || !strncasecmp("https://", uri, 8)) {
+        return (RT_NULL == strstr(uri, "m3u8")) ? RT_TRUE : RT_FALSE;
+    }
+    return RT_FALSE;
+}
+
 INT32 updateDefaultTrack(FAFormatContext* fa_ctx, RTTrackType tType) {
     INT32 bestIndex = fa_format_find_best_track(fa_ctx, tType);
     if (bestIndex < 0) {
@@ -125,7 +170,33 @@ RT_RET FFNodeDemuxer::init(RtMetaData *metaData) {
     RT_ASSERT(RT_NULL != uri);
 
     ctx->mMetaInput = metaData;
-    ctx->mFormatCtx = fa_format_open(uri, FLAG_DEMUXER);
+    RT_PTR pushStream = RT_NULL;
+    if (metaData->findPointer(kKeyFormatPushStream, &pushStream) && (RT_NULL != pushStream)) {
+        // bytes are written by caller, stream isn't seekable
+        ctx->mPushStream   = reinterpret_cast<RTMediaPushStream*>(pushStream);
+        ctx->mBlockingRead = RT_TRUE;
+        ctx->mFormatCtx    = fa_format_open_reader(uri, ctx->mPushStream,
+                                                   RTMediaPushStream::readBytes, RT_NULL);
+    } else if (demuxer_use_network_source(uri)) {
+        // network source fetches bytes before demuxer probes the stream
+        RTPktSourceNetwork* source = new RTPktSourceNetwork();
+        rt_safe_delete(ctx->mSource);
+        ctx->mSource = source;
+        ctx->mBlockingRead = RT_TRUE;
+        ret = source->init(metaData);
+        if (RT_OK != ret) {
+            RT_LOGE("network packet source init failed! err: %d", ret);
+            ctx->mNodeState = NODE_STATE_ERROR;
+            return ret;
+        }
+        ctx->mFormatCtx = fa_format_open_reader(uri, source, RTPktSourceNetwork::readBytes,
+                                                RTPktSourceNetwork::seekBytes);
+        if (RT_NULL != ctx->mFormatCtx) {
+            source->setStreamBitrate(fa_format_get_bitrate(ctx->mFormatCtx));
+        }
+    } else {
+        ctx->mFormatCtx = fa_format_open(uri, FLAG_DEMUXER);
+    }
     if (RT_NULL == ctx->mFormatCtx) {
         RT_LOGE("demuxer open url err.\n");
         return RT_ERR_UNKNOWN;
@@ -135,7 +206,9 @@ RT_RET FFNodeDemuxer::init(RtMetaData *metaData) {
     ctx->mIndexAudio    = updateDefaultTrack(ctx->mFormatCtx, RTTRACK_TYPE_AUDIO);
     ctx->mIndexSubtitle = updateDefaultTrack(ctx->mFormatCtx, RTTRACK_TYPE_SUBTITLE);
 
-    ret = ctx->mSource->init(metaData);
+    if (!demuxer_use_network_source(uri)) {
+        ret = ctx->mSource->init(metaData);
+    }
     if (RT_OK != ret) {
         RT_LOGE("media packet source init failed! err: %d", ret);
         ctx->mNodeState = NODE_STATE_ERROR;
@@ -151,9 +224,9 @@ RT_RET FFNodeDemuxer::release() {
     FFNodeDemuxerCtx* ctx = get_demuxer_ctx(mNodeContext);
     RT_ASSERT(RT_NULL != ctx);
 
-    if (ctx->mThread != RT_NULL) {
-        delete ctx->mThread;
-        ctx->mThread = RT_NULL;
+    if (ctx->mJob != RT_NULL) {
+        delete ctx->mJob;
+        ctx->mJob = RT_NULL;
     }
 
     // @review: code redundancy but logically reasonable
@@ -191,7 +264,7 @@ RT_RET FFNodeDemuxer::pullBuffer(RTMediaBuffer** mediaBuf) {
     pkt = ctx->mSource->dequeuePacket(type);
     if (RT_NULL != pkt) {
         if (RT_NULL == pkt->mRawPtr) {
-            if (ctx->mEosFlag) {
+            if (ctx->mEosFlag || ((RTTRACK_TYPE_VIDEO == type) && ctx->mVideoSkipEos)) {
                 RT_LOGD("receive EOS buffer.");
                 (*mediaBuf)->setData(RT_NULL, 0);
                 meta->setInt32(kKeyFrameEOS, 1);
@@ -242,8 +315,17 @@ RT_RET FFNodeDemuxer::runCmd(RT_NODE_CMD cmd, RtMetaData *metaData) {
     case RT_NODE_CMD_RESET:
         this->onReset();
         break;
+    case RT_NODE_CMD_TRICKPLAY:
+        this->onTrickPlay(metaData);
+        break;
+    case RT_NODE_CMD_SELECT_TRACK:
+        return this->onSelectTrack(metaData);
     case RT_NODE_CMD_PREPARE:
         this->onPrepare();
+        break;
+    case RT_NODE_CMD_STAT:
+    case RT_NODE_CMD_LATENCY:
+        return rt_node_stat_query(&mNodeStat, cmd, metaData);
     default:
         RT_LOGE("demuxer not support the cmd\n");
         break;
@@ -261,6 +343,15 @@ RT_RET FFNodeDemuxer::onSeek(RtMetaData *options) {
         return RT_ERR_UNKNOWN;
     }
 
+    if (1 != ctx->mTrickRate) {
+        // trick play goes on from new position
+        ctx->mEosFlag     = RT_FALSE;
+        ctx->mTrickPosUs  = seekTimeUs;
+        ctx->mTrickLastUs = -1ll;
+        ctx->mTrickSeek   = 1;
+        return RT_OK;
+    }
+
     ctx->mNeedSeek   = 1;
     ctx->mSeekTimeUs = seekTimeUs;
     ctx->mNodeState  = NODE_STATE_SEEKING;
@@ -268,6 +359,86 @@ RT_RET FFNodeDemuxer::onSeek(RtMetaData *options) {
     return RT_OK;
 }
 
+/*
+ * player pauses and flushes nodes before trick play, demuxer starts stepping
+ * from current position. normal rate resumes by a plain seek.
+ */
+RT_RET FFNodeDemuxer::onTrickPlay(RtMetaData *options) {
+    FFNodeDemuxerCtx* ctx = get_demuxer_ctx(mNodeContext);
+    RT_ASSERT(RT_NULL != ctx);
+
+    INT32 rate  = 1;
+    INT64 posUs = 0ll;
+    if ((RT_NULL == options) || !options->findInt32(kKeyTrickRate, &rate)
+          || !options->findInt64(kKeySeekTimeUs, &posUs)) {
+        RT_LOGE("trick rate or position get failed, trick play failed");
+        return RT_ERR_VALUE;
+    }
+    if (RT_NULL != ctx->mPushStream) {
+        RT_LOGE("push stream isn't seekable, trick play failed");
+        return RT_ERR_UNIMPLIMENTED;
+    }
+
+    RT_LOGD("trick play, rate: %d, from %lld ms", rate, posUs/1000);
+    ctx->mTrickRate = rate;
+    ctx->mVideoLastUs  = -1ll;
+    ctx->mVideoSkipUs  = -1ll;
+    ctx->mVideoSkipEos = RT_FALSE;
+    if (1 == rate) {
+        ctx->mTrickSeek  = 0;
+        ctx->mSeekTimeUs = posUs;
+        ctx->mNeedSeek   = 1;
+        ctx->mNodeState  = NODE_STATE_SEEKING;
+        return RT_OK;
+    }
+    ctx->mEosFlag     = RT_FALSE;
+    ctx->mTrickPosUs  = posUs;
+    ctx->mTrickLastUs = -1ll;
+    ctx->mTrickSeek   = 1;
+    return RT_OK;
+}
+
+/*
+ * switches audio track while playing. audio of new track is read again
+ * from kKeySeekTimeUs, where player splices it. the other tracks take
+ * effect at next prepare.
+ */
+RT_RET FFNodeDemuxer::onSelectTrack(RtMetaData *options) {
+    FFNodeDemuxerCtx* ctx = get_demuxer_ctx(mNodeContext);
+    RT_ASSERT(RT_NULL != ctx);
+
+    RTTrackType  tType  = RTTRACK_TYPE_UNKNOWN;
+    INT32        index  = -1;
+    INT64        timeUs = -1ll;
+    if ((RT_NULL == options) || !options->findInt32(kKeyCodecType, reinterpret_cast<INT32*>(&tType))
+          || !options->findInt32(kKeyTrackIndex, &index)) {
+        RT_LOGE("track type or index get failed, select track failed");
+        return RT_ERR_VALUE;
+    }
+    options->findInt64(kKeySeekTimeUs, &timeUs);
+
+    RTTrackParms track_par;
+    rt_memset(&track_par, 0, sizeof(RTTrackParms));
+    if (fa_format_query_track(ctx->mFormatCtx, index, tType, &track_par) < 0) {
+        RT_LOGE("track(index: %d, type: %d) isn't found", index, tType);
+        return RT_ERR_VALUE;
+    }
+    if (RTTRACK_TYPE_AUDIO != tType) {
+        selectTrack(index, tType);
+        return RT_OK;
+    }
+    if (1 != ctx->mTrickRate) {
+        RT_LOGE("audio track can't be switched in trick play");
+        return RT_ERR_BAD;
+    }
+
+    RT_LOGD("switch audio track %d -> %d at %lld ms", ctx->mIndexAudio, index, timeUs/1000);
+    ctx->mSwitchIndex  = index;
+    ctx->mSwitchTimeUs = (RT_NULL != ctx->mPushStream) ? -1ll : timeUs;
+    ctx->mSwitchAudio  = 1;
+    return RT_OK;
+}
+
 RT_RET FFNodeDemuxer::setEventLooper(RTMsgLooper* eventLooper) {
     FFNodeDemuxerCtx* ctx = get_demuxer_ctx(mNodeContext);
     RT_ASSERT(RT_NULL != ctx);
@@ -342,7 +513,8 @@ INT32 FFNodeDemuxer::queryTrackUsed(RTTrackType tType) {
         used_idx = ctx->mIndexVideo;
         break;
     case RTTRACK_TYPE_AUDIO:
-        used_idx = ctx->mIndexAudio;
+        // track which is switched to is in use, before demuxer applies it
+        used_idx = (ctx->mSwitchAudio > 0) ? ctx->mSwitchIndex : ctx->mIndexAudio;
         break;
     case RTTRACK_TYPE_SUBTITLE:
         used_idx = ctx->mIndexSubtitle;
@@ -372,6 +544,10 @@ RT_RET FFNodeDemuxer::onStart() {
     switch (ctx->mNodeState) {
       case NODE_STATE_IDLE:
       case NODE_STATE_PAUSED:
+        ctx->mSource->start();
+        if (RT_NULL != ctx->mPushStream) {
+            ctx->mPushStream->setInterrupt(RT_FALSE);
+        }
         ctx->mEosFlag   = RT_FALSE;
         ctx->mNodeState = NODE_STATE_STARTED;
         break;
@@ -387,11 +563,15 @@ RT_RET FFNodeDemuxer::onStop() {
     RT_ASSERT(RT_NULL != ctx);
 
     RT_LOGD("call, onStop");
-    ctx->mThread->requestInterruption();
     ctx->mSource->stop();
-    ctx->mThread->join();
+    if (RT_NULL != ctx->mPushStream) {
+        ctx->mPushStream->setInterrupt(RT_TRUE);
+    }
+    ctx->mJob->stop();
     ctx->mNeedSeek   = 1;
     ctx->mSeekTimeUs = 0ll;
+    ctx->mTrickRate  = 1;
+    ctx->mTrickSeek  = 0;
 
     // flush all packets in the caches
     onFlush();
@@ -445,68 +625,228 @@ RT_RET FFNodeDemuxer::onPrepare() {
     FFNodeDemuxerCtx* ctx = get_demuxer_ctx(mNodeContext);
     RT_ASSERT(RT_NULL != ctx);
 
-    ctx->mThread->start();
+    // source is stopped by onStop(), wake it up before demuxer thread reads
+    ctx->mSource->start();
+    if (RT_NULL != ctx->mPushStream) {
+        ctx->mPushStream->setInterrupt(RT_FALSE);
+    }
+    // worker of executor isn't held by reading which waits for bytes
+    ctx->mJob->setShared((mUseExecutor && !ctx->mBlockingRead) ? RT_TRUE : RT_FALSE);
+    ctx->mJob->start();
     return RT_OK;
 }
 
-RT_RET FFNodeDemuxer::runTask() {
+static void demuxer_queue_eos(FFNodeDemuxerCtx* ctx) {
+    ctx->mEosFlag = RT_TRUE;
+    if ((ctx->mIndexVideo >= 0) && !ctx->mVideoSkipEos) {
+        ctx->mSource->queueNullPacket(ctx->mIndexVideo, RTTRACK_TYPE_VIDEO);
+    }
+    if (ctx->mIndexAudio >= 0) {
+        ctx->mSource->queueNullPacket(ctx->mIndexAudio, RTTRACK_TYPE_AUDIO);
+    }
+}
+
+/*
+ * packets of tracks which aren't used are dropped, e.g. the other audio
+ * tracks of multi-language media. video which is read again after audio
+ * track switching is dropped too, as it is queued already.
+ */
+static RT_BOOL demuxer_track_accept(FFNodeDemuxerCtx* ctx, RTPacket* pkt) {
+    switch (pkt->mType) {
+      case RTTRACK_TYPE_VIDEO:
+        if (pkt->mTrackIndex != ctx->mIndexVideo) {
+            return RT_FALSE;
+        }
+        if (ctx->mVideoSkipUs >= 0) {
+            if (pkt->mPts <= ctx->mVideoSkipUs) {
+                return RT_FALSE;
+            }
+            ctx->mVideoSkipUs  = -1ll;
+            ctx->mVideoSkipEos = RT_FALSE;
+        }
+        ctx->mVideoLastUs = pkt->mPts;
+        return RT_TRUE;
+      case RTTRACK_TYPE_AUDIO:
+        return (pkt->mTrackIndex == ctx->mIndexAudio) ? RT_TRUE : RT_FALSE;
+      default:
+        return RT_TRUE;
+    }
+}
+
+/*
+ * new audio track is read again from splice position of player, audio of
+ * old track in cache is dropped. a seek which is pending supersedes it.
+ */
+static void demuxer_switch_audio(FFNodeDemuxerCtx* ctx) {
+    ctx->mIndexAudio  = ctx->mSwitchIndex;
+    ctx->mSwitchAudio = 0;
+    ctx->mSource->flushTrack(RTTRACK_TYPE_AUDIO);
+    if ((ctx->mNeedSeek > 0) || (ctx->mSwitchTimeUs < 0)) {
+        return;
+    }
+    if (fa_format_seek_key(ctx->mFormatCtx, ctx->mSwitchTimeUs, RT_TRUE) < 0) {
+        RT_LOGE("fail to seek to %lld ms, new track goes on from here", ctx->mSwitchTimeUs/1000);
+        return;
+    }
+    ctx->mVideoSkipUs  = ctx->mVideoLastUs;
+    ctx->mVideoSkipEos = ctx->mEosFlag;
+    ctx->mEosFlag      = RT_FALSE;
+}
+
+/*
+ * rewind reaches the beginning of stream, it is played at normal rate.
+ * player is told, so that decoder leaves trick mode too.
+ */
+static void demuxer_trick_end(FFNodeDemuxerCtx* ctx) {
+    RT_LOGD("trick play reaches beginning of stream");
+    ctx->mTrickRate  = 1;
+    ctx->mTrickSeek  = 0;
+    ctx->mSeekTimeUs = 0ll;
+    ctx->mNeedSeek   = 1;
+    if (RT_NULL != ctx->mEventLooper) {
+        RTMessage* msg = new RTMessage(RT_MEDIA_INFO, RT_INFO_TRICK_PLAY_END, 0);
+        ctx->mEventLooper->post(msg, 0ll);
+    }
+}
+
+/*
+ * rewind seeks to key frame before target and forward seeks to key frame
+ * after target, both are served by index of demuxer without reading.
+ */
+static void demuxer_trick_seek(FFNodeDemuxerCtx* ctx) {
+    RT_BOOL backward = (ctx->mTrickRate < 0) ? RT_TRUE : RT_FALSE;
+    ctx->mTrickSeek  = 0;
+    ctx->mTrickKeyUs = -1ll;
+    if (fa_format_seek_key(ctx->mFormatCtx, ctx->mTrickPosUs, backward) < 0) {
+        if (backward) {
+            demuxer_trick_end(ctx);
+        } else {
+            // no key frame after target
+            demuxer_queue_eos(ctx);
+        }
+    }
+}
+
+/*
+ * keeps key frame of anchor track (video, or audio of audio-only stream)
+ * and audio of TRICK_STEP_US after it, the others are dropped.
+ */
+static RT_BOOL demuxer_trick_accept(FFNodeDemuxerCtx* ctx, RTPacket* pkt) {
+    INT32 anchor = (ctx->mIndexVideo >= 0) ? ctx->mIndexVideo : ctx->mIndexAudio;
+    INT64 stride = RT_ABS(ctx->mTrickRate) * TRICK_STEP_US;
+
+    if (ctx->mTrickKeyUs < 0) {
+        if ((pkt->mTrackIndex != anchor)
+              || ((anchor == ctx->mIndexVideo) && !(pkt->mFlags & RT_PACKET_FLAG_KEY))) {
+            return RT_FALSE;
+        }
+        if ((ctx->mTrickLastUs >= 0) && (ctx->mTrickRate > 0) && (pkt->mPts <= ctx->mTrickLastUs)) {
+            return RT_FALSE;
+        }
+        if ((ctx->mTrickLastUs >= 0) && (ctx->mTrickRate < 0) && (pkt->mPts >= ctx->mTrickLastUs)) {
+            // landed on key frame of last step, step back further
+            if (ctx->mTrickPosUs <= 0) {
+                demuxer_trick_end(ctx);
+            } else {
+                ctx->mTrickPosUs = RT_MAX(ctx->mTrickPosUs - stride, 0ll);
+                ctx->mTrickSeek  = 1;
+            }
+            return RT_FALSE;
+        }
+        ctx->mTrickKeyUs = pkt->mPts;
+        return RT_TRUE;
+    }
+
+    if (((pkt->mTrackIndex == anchor) || (pkt->mTrackIndex == ctx->mIndexAudio))
+          && (pkt->mPts >= ctx->mTrickKeyUs + TRICK_STEP_US)) {
+        // this step is done
+        ctx->mTrickLastUs = ctx->mTrickKeyUs;
+        ctx->mTrickPosUs  = RT_MAX(ctx->mTrickKeyUs + ctx->mTrickRate * TRICK_STEP_US, 0ll);
+        ctx->mTrickSeek   = 1;
+        return RT_FALSE;
+    }
+    if (pkt->mTrackIndex == ctx->mIndexAudio) {
+        return (pkt->mPts >= ctx->mTrickKeyUs) ? RT_TRUE : RT_FALSE;
+    }
+    return RT_FALSE;
+}
+
+/*
+ * reads one packet, returns the time to wait before next step.
+ */
+INT64 FFNodeDemuxer::runStep() {
     FFNodeDemuxerCtx    *ctx = get_demuxer_ctx(mNodeContext);
     RT_ASSERT(RT_NULL != ctx);
 
     void                *raw_pkt = RT_NULL;
     INT32                err     = 0;
     RTPacket            *rt_pkt  = RT_NULL;
-    INT32                err_cnt = 0;
-
-    RT_LOGD_IF(DEBUG_FLAG, "task begin");
-    while (THREAD_LOOP == ctx->mThread->getState()) {
-        if (ctx->mNeedSeek > 0) {
-            RT_LOGD("do seek, seek to %lld ms", ctx->mSeekTimeUs/1000);
-            int flags = 0;
-            fa_format_seek_to(ctx->mFormatCtx, -1, ctx->mSeekTimeUs, flags);
-            onFlush();
-            RT_LOGD("flush compelete");
-            ctx->mEosFlag   = RT_FALSE;
-            ctx->mNeedSeek  = 0;
-            ctx->mNodeState = NODE_STATE_STARTED;
-        }
 
-        if (!ctx->mEosFlag) {
-            // don't block. demuxer may fail to queue pkt, when pause and stop player.
-            rt_pkt = ctx->mSource->dequeueUnusedPacket(RT_FALSE);
-            if (rt_pkt != RT_NULL) {
-                err = fa_format_packet_read(ctx->mFormatCtx, &raw_pkt);
-                if ((RT_ERR_END_OF_STREAM == err) || (err_cnt > 5)) {
-                    RT_LOGE("read end of stream");
-                    ctx->mEosFlag = RT_TRUE;
-                    if (ctx->mIndexVideo >= 0) {
-                        ctx->mSource->queueNullPacket(ctx->mIndexVideo, RTTRACK_TYPE_VIDEO);
-                    }
-                    if (ctx->mIndexAudio >= 0) {
-                        ctx->mSource->queueNullPacket(ctx->mIndexAudio, RTTRACK_TYPE_AUDIO);
-                    }
-                    ctx->mSource->queueUnusedPacket(rt_pkt);
-                    rt_pkt = RT_NULL;
-                } else if (err < 0) {
-                    char errbuf[64] = {0};
-                    fa_utils_error_string(err, errbuf, 64);
-                    RT_LOGE("fail to av_read_packet, error(%d):%s", err, errbuf);
+    if (ctx->mSwitchAudio > 0) {
+        demuxer_switch_audio(ctx);
+    }
+
+    if (ctx->mNeedSeek > 0) {
+        RT_LOGD("do seek, seek to %lld ms", ctx->mSeekTimeUs/1000);
+        // key frame at or before target, decoder prerolls up to target
+        fa_format_seek_key(ctx->mFormatCtx, ctx->mSeekTimeUs, RT_TRUE);
+        onFlush();
+        RT_LOGD("flush compelete");
+        ctx->mEosFlag   = RT_FALSE;
+        ctx->mNeedSeek  = 0;
+        ctx->mNodeState = NODE_STATE_STARTED;
+        ctx->mVideoLastUs  = -1ll;
+        ctx->mVideoSkipUs  = -1ll;
+        ctx->mVideoSkipEos = RT_FALSE;
+    }
+
+    if ((ctx->mTrickSeek > 0) && !ctx->mEosFlag) {
+        demuxer_trick_seek(ctx);
+    }
+
+    if (!ctx->mEosFlag) {
+        // don't block. demuxer may fail to queue pkt, when pause and stop player.
+        rt_pkt = ctx->mSource->dequeueUnusedPacket(RT_FALSE);
+        if (rt_pkt != RT_NULL) {
+            INT64 procUs = RtTime::getNowTimeUs();
+            RT_TRACE_BEGIN("demuxer", "read packet");
+            err = fa_format_packet_read(ctx->mFormatCtx, &raw_pkt);
+            RT_TRACE_END("demuxer", "read packet");
+            rt_node_stat_process(&mNodeStat, RtTime::getNowTimeUs() - procUs);
+            if ((RT_ERR_END_OF_STREAM == err) || (ctx->mErrCount > 5)) {
+                RT_LOGE("read end of stream");
+                demuxer_queue_eos(ctx);
+                ctx->mSource->queueUnusedPacket(rt_pkt);
+                rt_pkt = RT_NULL;
+            } else if (err < 0) {
+                char errbuf[64] = {0};
+                fa_utils_error_string(err, errbuf, 64);
+                RT_LOGE("fail to av_read_packet, error(%d):%s", err, errbuf);
+                fa_format_packet_free(raw_pkt);
+                ctx->mSource->queueUnusedPacket(rt_pkt);
+                ctx->mErrCount++;
+                return 0;
+            } else {
+                ctx->mErrCount = 0;
+                fa_format_packet_parse(ctx->mFormatCtx, raw_pkt, rt_pkt);
+                if (!demuxer_track_accept(ctx, rt_pkt)
+                      || ((1 != ctx->mTrickRate) && !demuxer_trick_accept(ctx, rt_pkt))) {
+                    // dropped packets aren't cached, keep on scanning
+                    rt_node_stat_drop(&mNodeStat);
                     fa_format_packet_free(raw_pkt);
                     ctx->mSource->queueUnusedPacket(rt_pkt);
-                    err_cnt++;
-                    continue;
-                } else {
-                    err_cnt = 0;
-                    fa_format_packet_parse(ctx->mFormatCtx, raw_pkt, rt_pkt);
-                    ctx->mSource->queuePacket(rt_pkt);
                     rt_pkt = RT_NULL;
+                    return 0;
                 }
+                ctx->mSource->queuePacket(rt_pkt);
+                rt_pkt = RT_NULL;
             }
+        } else {
+            // cache of packets is full, demuxer waits for consumers
+            rt_node_stat_wait_output(&mNodeStat, 2000ll);
         }
-        RtTime::sleepUs(2000llu);
     }
-    RT_LOGD_IF(DEBUG_FLAG, "cache_thread done");
-    return RT_OK;
+    return 2000;
 }
 
 static RTNode* createFFDemuxer() {
@@ -520,4 +860,5 @@ struct RTNodeStub ff_node_demuxer {
     .mNodeName       = "ff_node_demuxer",
     .mNodeRole       = "demuxer",
     .mNodeVersion    = "v1.0",
+    .mUseExecutor    = RT_TRUE,
 };
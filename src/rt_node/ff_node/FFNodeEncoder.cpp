@@ -32,7 +32,6 @@
 #define DEBUG_FLAG 0x0
 
 #include "FFNodeEncoder.h" // NOLINT
-#include "RTObjectPool.h" // NOLINT
 #include "FFMPEGAdapter.h" // NOLINT
 #include "rt_metadata.h" // NOLINT
 #include "RTMediaMetaKeys.h" // NOLINT
@@ -40,9 +39,10 @@
 #include "rt_dequeue.h" // NOLINT
 #include "RTMediaBuffer.h" // NOLINT
 #include "FFAdapterCodec.h" // NOLINT
+#include "rt_trace.h" // NOLINT
 
 #define MAX_INPUT_BUFFER_COUNT      8
-#define MAX_OUTPUT_BUFFER_COUNT     8
+#define MAX_OUTPUT_BUFFER_COUNT     16
 
 void* ff_encode_loop(void* ptr_node) {
     FFNodeEncoder* node = reinterpret_cast<FFNodeEncoder*>(ptr_node);
@@ -50,73 +50,76 @@ void* ff_encode_loop(void* ptr_node) {
     return RT_NULL;
 }
 
-RTObject *allocEncInputBuffer(void *) {
-    return new RTMediaBuffer(1920 * 1088 * 3 / 2);
-}
+FFNodeEncoder::FFNodeEncoder()
+        : mFFCodec(RT_NULL),
+          mPacketPool(RT_NULL),
+          mEventLooper(RT_NULL),
+          mMetaInput(RT_NULL),
+          mMetaOutput(RT_NULL),
+          mStarted(RT_FALSE),
+          mDraining(RT_FALSE),
+          mCountPull(0),
+          mCountPush(0) {
+    mProcThread = new RtThread(ff_encode_loop, reinterpret_cast<void*>(this));
+    mProcThread->setName("FFEncoder");
 
-RTObject *allocEncOutputBuffer(void *) {
-    return new RTMediaBuffer(1920 * 1088 * 3 / 2);
-}
+    mFrameQ = deque_create();
+    RT_ASSERT(RT_NULL != mFrameQ);
 
+    mPacketQ = deque_create();
+    RT_ASSERT(RT_NULL != mPacketQ);
 
-FFNodeEncoder::FFNodeEncoder() {
-    mProcThread = new RtThread(ff_encode_loop, reinterpret_cast<void*>(this));
-    mProcThread->setName("FFEncoder");
+    mLockFrameQ = new RtMutex();
+    RT_ASSERT(RT_NULL != mLockFrameQ);
 
-    mUnusedInputPort  = RT_NULL;
-    mUsedInputPort = RT_NULL;
-    mUnusedOutputPort = RT_NULL;
-    mUsedOutputPort = RT_NULL;
-    mUnusedInputPort = new RTObjectPool(allocEncInputBuffer, MAX_INPUT_BUFFER_COUNT);
-    mUsedInputPort = new RTObjectPool(RT_NULL, MAX_INPUT_BUFFER_COUNT * 4);
-    mUnusedOutputPort = new RTObjectPool(allocEncOutputBuffer, MAX_OUTPUT_BUFFER_COUNT);
-    mUsedOutputPort = new RTObjectPool(RT_NULL, MAX_OUTPUT_BUFFER_COUNT * 4);
+    mLockPacketQ = new RtMutex();
+    RT_ASSERT(RT_NULL != mLockPacketQ);
 }
 
 FFNodeEncoder::~FFNodeEncoder() {
+    onFlush();
+
     release();
+    rt_safe_delete(mLockFrameQ);
+    rt_safe_delete(mLockPacketQ);
+    deque_destory(&mFrameQ);
+    deque_destory(&mPacketQ);
     mNodeContext = RT_NULL;
 }
 
 RT_RET FFNodeEncoder::init(RtMetaData *metadata) {
+    RT_LOGD("call, init");
     mFFCodec = fa_video_encode_create(metadata);
     if (!mFFCodec) {
-        RT_LOGE("fa_video_decode_open failed");
+        RT_LOGE("fa_video_encode_create failed");
         return RT_ERR_UNKNOWN;
     }
 
-    allocateBuffersOnPort(RT_PORT_INPUT);
-    allocateBuffersOnPort(RT_PORT_OUTPUT);
+    // @Best Practice: mMetaInput is created and deleted by user of encoder
+    mMetaInput = metadata;
 
-    return RT_OK;
+    // @Best Practice: mMetaOutput is created and deleted by encoder
+    mMetaOutput = new RtMetaData();
+    fa_encode_query_format(mFFCodec, mMetaOutput);
+
+    mPacketPool = new RTMediaBufferPool(MAX_OUTPUT_BUFFER_COUNT);
+    return allocateBuffersOnPort(RT_PORT_OUTPUT);
 }
 
+/*
+ * packets of encoder are lent to empty buffers, so the pool bounds
+ * packets which are not written by muxer yet.
+ */
 RT_RET FFNodeEncoder::allocateBuffersOnPort(RTPortType port) {
-    UINT32 i = 0;
     switch (port) {
-        case RT_PORT_INPUT: {
-            RTMediaBuffer *buffer[MAX_INPUT_BUFFER_COUNT];
-            for (i = 0; i < MAX_INPUT_BUFFER_COUNT; i++) {
-                buffer[i] = reinterpret_cast<RTMediaBuffer *>(mUnusedInputPort->borrowObj());
-            }
-            for (i = 0; i < MAX_INPUT_BUFFER_COUNT; i++) {
-                mUnusedInputPort->returnObj(buffer[i]);
-            }
-        }
-            break;
-        case RT_PORT_OUTPUT: {
-            RTMediaBuffer *buffer[MAX_OUTPUT_BUFFER_COUNT];
-            for (i = 0; i < MAX_OUTPUT_BUFFER_COUNT; i++) {
-                buffer[i] = reinterpret_cast<RTMediaBuffer *>(mUnusedOutputPort->borrowObj());
-            }
-            for (i = 0; i < MAX_OUTPUT_BUFFER_COUNT; i++) {
-                mUnusedOutputPort->returnObj(buffer[i]);
-            }
+      case RT_PORT_OUTPUT:
+        for (UINT32 i = 0; i < MAX_OUTPUT_BUFFER_COUNT; i++) {
+            mPacketPool->registerBuffer(new RTMediaBuffer(RT_NULL, 0));
         }
-            break;
-        default:
-            RT_LOGE("unknown port! port: %d", port);
-            return RT_ERR_UNKNOWN;
+        break;
+      default:
+        RT_LOGE("unknown port! port: %d", port);
+        return RT_ERR_UNKNOWN;
     }
 
     return RT_OK;
@@ -125,79 +128,86 @@ RT_RET FFNodeEncoder::allocateBuffersOnPort(RTPortType port) {
 RT_RET FFNodeEncoder::release() {
     fa_video_encode_destroy(&mFFCodec);
 
-    if (mUnusedInputPort) {
-        delete mUnusedInputPort;
-        mUnusedInputPort = NULL;
-    }
-    if (mUsedInputPort) {
-        delete mUsedInputPort;
-        mUsedInputPort = NULL;
-    }
-
-    if (mUnusedOutputPort) {
-        delete mUnusedOutputPort;
-        mUnusedOutputPort = NULL;
-    }
-
-    if (mUsedOutputPort) {
-        delete mUsedOutputPort;
-        mUsedOutputPort = NULL;
-    }
+    rt_safe_delete(mPacketPool);
+    rt_safe_delete(mMetaOutput);
+    mMetaInput = RT_NULL;
 
     // thread release
-    delete(mProcThread);
-    mProcThread = RT_NULL;
+    rt_safe_delete(mProcThread);
 
     return RT_OK;
 }
 
-RT_RET FFNodeEncoder::dequeBuffer(RTMediaBuffer **buffer, RTPortType type) {
-    switch (type) {
-        case RT_PORT_INPUT:
-            *buffer = reinterpret_cast<RTMediaBuffer *>(mUnusedInputPort->borrowObj());
-            break;
-        case RT_PORT_OUTPUT:
-            *buffer = reinterpret_cast<RTMediaBuffer *>(mUsedOutputPort->borrowObj());
-            break;
-        default:
-            RT_LOGE("unknown port! port: %d", type);
-            return RT_ERR_UNKNOWN;
-    }
-    if (!(*buffer)) {
+RT_RET FFNodeEncoder::dequeBuffer(RTMediaBuffer **data, RTPortType port) {
+    RT_RET ret = RT_OK;
+    RT_DequeEntry entry;
+    switch (port) {
+      case RT_PORT_INPUT:
+        // frames are buffers of decoder or filter, encoder has none
+        ret = RT_ERR_UNIMPLIMENTED;
+        break;
+      case RT_PORT_OUTPUT: {
+        RtMutex::RtAutolock autoLock(mLockPacketQ);
+        entry = deque_pop(mPacketQ);
+        if (entry.data) {
+            *data = reinterpret_cast<RTMediaBuffer *>(entry.data);
+            (*data)->getMetaData()->setInt32(kKeyCodecType, RTTRACK_TYPE_VIDEO);
+        } else {
+            ret = RT_ERR_LIST_EMPTY;
+        }
+      }
+        break;
+      default:
+        RT_LOGE("unknown port! port: %d", port);
         return RT_ERR_UNKNOWN;
     }
 
-    return RT_OK;
+    return ret;
 }
 
-RT_RET FFNodeEncoder::queueBuffer(RTMediaBuffer *buffer, RTPortType type) {
+RT_RET FFNodeEncoder::queueBuffer(RTMediaBuffer *data, RTPortType port) {
     RT_RET ret = RT_OK;
-    switch (type) {
-        case RT_PORT_INPUT:
-            ret = mUsedInputPort->returnObj(buffer);
-            break;
-        case RT_PORT_OUTPUT:
-            ret = mUnusedOutputPort->returnObj(buffer);
-            break;
-        default:
-            RT_LOGE("unknown port! port: %d", type);
-            return RT_ERR_UNKNOWN;
+    if (RT_NULL == data) {
+        RT_LOGE("data is NULL!");
+        return RT_ERR_NULL_PTR;
     }
-    if (!buffer) {
-        return ret;
+    switch (port) {
+      case RT_PORT_INPUT: {
+        // frames are held by upstream pool, they are never queued without limit
+        RtMutex::RtAutolock autoLock(mLockFrameQ);
+        if (deque_size(mFrameQ) >= MAX_INPUT_BUFFER_COUNT) {
+            ret = RT_ERR_LIST_FULL;
+        } else {
+            deque_push(mFrameQ, reinterpret_cast<void *>(data));
+            rt_node_stat_queue(&mNodeStat, deque_size(mFrameQ));
+        }
+      }
+        break;
+      case RT_PORT_OUTPUT:
+        data->release();
+        break;
+      default:
+        RT_LOGE("unknown port! port: %d", port);
+        return RT_ERR_UNKNOWN;
     }
 
-    return RT_OK;
+    return ret;
 }
 
 RT_RET FFNodeEncoder::pullBuffer(RTMediaBuffer** data) {
-    mCountPull++;
-    return dequeBuffer(data, RT_PORT_OUTPUT);
+    RT_RET err = dequeBuffer(data, RT_PORT_OUTPUT);
+    if (RT_OK == err) {
+        mCountPull++;
+    }
+    return err;
 }
 
 RT_RET FFNodeEncoder::pushBuffer(RTMediaBuffer*  data) {
-    mCountPush++;
-    return queueBuffer(data, RT_PORT_INPUT);
+    RT_RET err = queueBuffer(data, RT_PORT_INPUT);
+    if (RT_OK == err) {
+        mCountPush++;
+    }
+    return err;
 }
 
 RT_RET FFNodeEncoder::runCmd(RT_NODE_CMD cmd, RtMetaData *metadata) {
@@ -206,6 +216,9 @@ RT_RET FFNodeEncoder::runCmd(RT_NODE_CMD cmd, RtMetaData *metadata) {
     case RT_NODE_CMD_INIT:
         err = this->init(metadata);
         break;
+    case RT_NODE_CMD_PREPARE:
+        err = this->onPrepare();
+        break;
     case RT_NODE_CMD_START:
         err = this->onStart();
         break;
@@ -218,6 +231,13 @@ RT_RET FFNodeEncoder::runCmd(RT_NODE_CMD cmd, RtMetaData *metadata) {
     case RT_NODE_CMD_PAUSE:
         err = this->onPause();
         break;
+    case RT_NODE_CMD_RESET:
+        err = this->onReset();
+        break;
+    case RT_NODE_CMD_STAT:
+    case RT_NODE_CMD_LATENCY:
+        err = rt_node_stat_query(&mNodeStat, cmd, metadata);
+        break;
     default:
         RT_LOGE("unkown command: %d", cmd);
         err = RT_ERR_UNKNOWN;
@@ -233,74 +253,171 @@ RT_RET FFNodeEncoder::setEventLooper(RTMsgLooper* eventLooper) {
 }
 
 RtMetaData* FFNodeEncoder::queryFormat(RTPortType port) {
-    return RT_NULL;
+    RtMetaData *nMeta = RT_NULL;
+    switch (port) {
+    case RT_PORT_INPUT:
+        nMeta = mMetaInput;
+        break;
+    case RT_PORT_OUTPUT:
+        nMeta = mMetaOutput;
+        break;
+    default:
+        break;
+    }
+    return nMeta;
 }
 
 RTNodeStub* FFNodeEncoder::queryStub() {
     return &ff_node_video_encoder;
 }
 
+/*
+ * one frame is sent, then all packets of encoder are taken. encoder
+ * waits for empty buffers of pool, which are released by muxer.
+ */
 RT_RET FFNodeEncoder::runTask() {
-    RTMediaBuffer *input = NULL;
-    RTMediaBuffer *output = NULL;
-
+    RTMediaBuffer *input  = RT_NULL;
+    RTMediaBuffer *output = RT_NULL;
     while (THREAD_LOOP == mProcThread->getState()) {
         RT_RET err = RT_OK;
-        if (!input) {
-            input = reinterpret_cast<RTMediaBuffer *>(mUsedInputPort->borrowObj());
-        }
-        if (!output) {
-            output = reinterpret_cast<RTMediaBuffer *>(mUnusedOutputPort->borrowObj());
-        }
 
-        if (!input || !output) {
-            RtTime::sleepMs(10);
+        if (!mStarted) {
+            if (input) {
+                input->release();
+                input = RT_NULL;
+            }
+            RtTime::sleepMs(5);
             continue;
         }
 
-        RT_LOGD("input and output ready, go to encode!");
-        err = fa_encode_send_frame(mFFCodec, input);
-        if (err) {
-            if (err == RT_ERR_TIMEOUT) {
-                continue;
+        if (!input && !mDraining) {
+            RtMutex::RtAutolock autoLock(mLockFrameQ);
+            RT_DequeEntry entry = deque_pop(mFrameQ);
+            if (entry.data) {
+                input = reinterpret_cast<RTMediaBuffer *>(entry.data);
             }
         }
-        err = fa_encode_get_packet(mFFCodec, output);
-        if (err) {
+
+        if (input) {
+            INT64 procUs = RtTime::getNowTimeUs();
+            RT_TRACE_BEGIN("encoder", "send frame");
+            err = fa_encode_send_frame(mFFCodec, input);
+            RT_TRACE_END("encoder", "send frame");
+            if (RT_ERR_TIMEOUT != err) {
+                rt_node_stat_process(&mNodeStat, RtTime::getNowTimeUs() - procUs);
+                // encoder is full, frame is sent again after packets are taken
+                INT32 eos = 0;
+                input->getMetaData()->findInt32(kKeyFrameEOS, &eos);
+                mDraining = eos ? RT_TRUE : RT_FALSE;
+                input->release();
+                input = RT_NULL;
+            }
+        } else if (!mDraining) {
+            INT64 waitUs = RtTime::getNowTimeUs();
+            RtTime::sleepMs(2);
+            rt_node_stat_wait_input(&mNodeStat, RtTime::getNowTimeUs() - waitUs);
             continue;
-        } else {
-            mUsedOutputPort->returnObj(output);
-            mUnusedInputPort->returnObj(input);
-            input = NULL;
-            output = NULL;
         }
+
+        while (mStarted) {
+            if (!output) {
+                INT64 waitUs = RtTime::getNowTimeUs();
+                RT_TRACE_BEGIN("encoder", "acquire packet");
+                mPacketPool->acquireBuffer(&output, RT_TRUE);
+                RT_TRACE_END("encoder", "acquire packet");
+                rt_node_stat_wait_output(&mNodeStat, RtTime::getNowTimeUs() - waitUs);
+            }
+            if (!output) {
+                break;
+            }
+            RT_TRACE_BEGIN("encoder", "receive packet");
+            err = fa_encode_get_packet(mFFCodec, output);
+            RT_TRACE_END("encoder", "receive packet");
+            if (RT_OK != err) {
+                break;
+            }
+            INT32 eos = 0;
+            output->getMetaData()->findInt32(kKeyFrameEOS, &eos);
+            {
+                RtMutex::RtAutolock autoLock(mLockPacketQ);
+                deque_push(mPacketQ, output);
+                output = RT_NULL;
+            }
+            if (eos) {
+                RT_LOGD("encoder is drained, frames: %d packets: %d", mCountPush, mCountPull);
+                mDraining = RT_FALSE;
+                break;
+            }
+        }
+    }
+
+    if (input) {
+        input->release();
+        input = RT_NULL;
+    }
+    if (output) {
+        output->release();
+        output = RT_NULL;
     }
+    RT_LOGD("exit ffmpeg encode run task");
     return RT_OK;
 }
 
 RT_RET FFNodeEncoder::onStart() {
-    RT_RET err = RT_OK;
-    mProcThread->start();
-    return err;
+    mPacketPool->start();
+    mStarted = RT_TRUE;
+    return RT_OK;
 }
 
 RT_RET FFNodeEncoder::onPause() {
+    RT_LOGD("call, pause");
+    mStarted = RT_FALSE;
     return RT_OK;
 }
 
 RT_RET FFNodeEncoder::onStop() {
     RT_RET err = RT_OK;
+    mStarted = RT_FALSE;
+    mPacketPool->stop();
     mProcThread->requestInterruption();
     mProcThread->join();
+    onFlush();
     return err;
 }
 
 RT_RET FFNodeEncoder::onReset() {
-    return RT_ERR_UNIMPLIMENTED;
+    RT_LOGD("call, reset and flush in encoder");
+    return onFlush();
+}
+
+RT_RET FFNodeEncoder::onPrepare() {
+    RT_LOGD("call, prepare");
+    mProcThread->setSchedClass(mThreadClass);
+    mProcThread->start();
+    return RT_OK;
 }
 
 RT_RET FFNodeEncoder::onFlush() {
-    return RT_ERR_UNIMPLIMENTED;
+    RT_LOGD("call, flush");
+    mStarted  = RT_FALSE;
+    mDraining = RT_FALSE;
+    while (deque_size(mFrameQ) > 0) {
+        RtMutex::RtAutolock autoLock(mLockFrameQ);
+        RT_DequeEntry entry = deque_pop(mFrameQ);
+        if (entry.data) {
+            reinterpret_cast<RTMediaBuffer *>(entry.data)->release();
+            rt_node_stat_drop(&mNodeStat);
+        }
+    }
+    while (deque_size(mPacketQ) > 0) {
+        RtMutex::RtAutolock autoLock(mLockPacketQ);
+        RT_DequeEntry entry = deque_pop(mPacketQ);
+        if (entry.data) {
+            reinterpret_cast<RTMediaBuffer *>(entry.data)->release();
+            rt_node_stat_drop(&mNodeStat);
+        }
+    }
+    return RT_OK;
 }
 
 static RTNode* createFFEncoder() {
@@ -312,8 +429,7 @@ struct RTNodeStub ff_node_video_encoder {
     .mNodeType       = RT_NODE_TYPE_ENCODER,
     .mUsePool        = RT_TRUE,
     .mNodeName       = "ff_node_video_encoder",
-    .mNodeRole       = "video,audio",
+    .mNodeRole       = "video",
     .mNodeVersion    = "v1.0",
+    .mThreadClass    = RT_THREAD_CLASS_DECODE,
 };
-
-
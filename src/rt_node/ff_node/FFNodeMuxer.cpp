@@ -23,4 +23,343 @@
 #endif
 #define LOG_TAG "FFNodeMuxer"
 
+#ifdef DEBUG_FLAG
+#undef DEBUG_FLAG
+#endif
+#define DEBUG_FLAG 0x0
+
 #include "./include/FFNodeMuxer.h" // NOLINT
+#include "rt_metadata.h" // NOLINT
+#include "RTMediaMetaKeys.h" // NOLINT
+#include "RTMediaData.h" // NOLINT
+#include "rt_trace.h" // NOLINT
+
+// packets of all tracks, they are held by pools of upstream nodes
+#define MAX_INPUT_BUFFER_COUNT      64
+
+void* ff_muxer_loop(void* ptr_node) {
+    FFNodeMuxer* node = reinterpret_cast<FFNodeMuxer*>(ptr_node);
+    node->runTask();
+    return RT_NULL;
+}
+
+FFNodeMuxer::FFNodeMuxer()
+        : mFormatCtx(RT_NULL),
+          mEventLooper(RT_NULL),
+          mMetaInput(RT_NULL),
+          mTrackCount(0),
+          mTrackEOS(0),
+          mDurationUs(0ll),
+          mHeaderDone(RT_FALSE),
+          mTrailerDone(RT_FALSE),
+          mStarted(RT_FALSE),
+          mCountPush(0),
+          mCountWrite(0) {
+    mProcThread = new RtThread(ff_muxer_loop, reinterpret_cast<void*>(this));
+    mProcThread->setName("FFMuxer");
+
+    mPacketQ = deque_create();
+    RT_ASSERT(RT_NULL != mPacketQ);
+
+    mLockPacketQ = new RtMutex();
+    RT_ASSERT(RT_NULL != mLockPacketQ);
+}
+
+FFNodeMuxer::~FFNodeMuxer() {
+    onFlush();
+
+    release();
+    rt_safe_delete(mLockPacketQ);
+    deque_destory(&mPacketQ);
+    mNodeContext = RT_NULL;
+}
+
+RT_RET FFNodeMuxer::init(RtMetaData *metadata) {
+    const char* uri = RT_NULL;
+    if ((RT_NULL == metadata) || !metadata->findCString(kKeyFormatUri, &uri)) {
+        RT_LOGE("no uri of muxer");
+        return RT_ERR_VALUE;
+    }
+
+    mFormatCtx = fa_format_open(uri, FLAG_MUXER);
+    if (RT_NULL == mFormatCtx) {
+        RT_LOGE("fail to open %s for muxer", uri);
+        return RT_ERR_UNKNOWN;
+    }
+
+    // @Best Practice: mMetaInput is created and deleted by muxer
+    mMetaInput = new RtMetaData();
+    mMetaInput->setInt32(kKeyVCodecGlobalHeader, fa_format_need_global_header(mFormatCtx));
+    return RT_OK;
+}
+
+RT_RET FFNodeMuxer::release() {
+    if (mHeaderDone && !mTrailerDone) {
+        // muxer is stopped before EOS, file is still playable
+        writeTrailer();
+    }
+    fa_format_close(mFormatCtx);
+    mFormatCtx = RT_NULL;
+    rt_safe_delete(mMetaInput);
+
+    // thread release
+    rt_safe_delete(mProcThread);
+    return RT_OK;
+}
+
+RT_RET FFNodeMuxer::pullBuffer(RTMediaBuffer** data) {
+    // muxer is the end of line, it gives out nothing
+    return RT_ERR_UNIMPLIMENTED;
+}
+
+RT_RET FFNodeMuxer::pushBuffer(RTMediaBuffer* data) {
+    if (RT_NULL == data) {
+        RT_LOGE("data is NULL!");
+        return RT_ERR_NULL_PTR;
+    }
+
+    RtMutex::RtAutolock autoLock(mLockPacketQ);
+    if (deque_size(mPacketQ) >= MAX_INPUT_BUFFER_COUNT) {
+        return RT_ERR_LIST_FULL;
+    }
+    deque_push(mPacketQ, reinterpret_cast<void *>(data));
+    rt_node_stat_queue(&mNodeStat, deque_size(mPacketQ));
+    mCountPush++;
+    return RT_OK;
+}
+
+RT_RET FFNodeMuxer::runCmd(RT_NODE_CMD cmd, RtMetaData *metadata) {
+    RT_RET err = RT_OK;
+    switch (cmd) {
+    case RT_NODE_CMD_INIT:
+        err = this->init(metadata);
+        break;
+    case RT_NODE_CMD_PREPARE:
+        err = this->onPrepare();
+        break;
+    case RT_NODE_CMD_START:
+        err = this->onStart();
+        break;
+    case RT_NODE_CMD_STOP:
+        err = this->onStop();
+        break;
+    case RT_NODE_CMD_FLUSH:
+        err = this->onFlush();
+        break;
+    case RT_NODE_CMD_PAUSE:
+        err = this->onPause();
+        break;
+    case RT_NODE_CMD_RESET:
+        err = this->onReset();
+        break;
+    case RT_NODE_CMD_STAT:
+    case RT_NODE_CMD_LATENCY:
+        err = rt_node_stat_query(&mNodeStat, cmd, metadata);
+        break;
+    default:
+        RT_LOGE("unkown command: %d", cmd);
+        err = RT_ERR_UNKNOWN;
+        break;
+    }
+
+    return err;
+}
+
+RT_RET FFNodeMuxer::setEventLooper(RTMsgLooper* eventLooper) {
+    mEventLooper = eventLooper;
+    return RT_OK;
+}
+
+RtMetaData* FFNodeMuxer::queryFormat(RTPortType port) {
+    RtMetaData *nMeta = RT_NULL;
+    switch (port) {
+    case RT_PORT_INPUT:
+        nMeta = mMetaInput;
+        break;
+    default:
+        break;
+    }
+    return nMeta;
+}
+
+RTNodeStub* FFNodeMuxer::queryStub() {
+    return &ff_node_muxer;
+}
+
+INT32 FFNodeMuxer::addTrack(RtMetaData *trackMeta) {
+    if ((RT_NULL == trackMeta) || (RT_NULL == mFormatCtx)) {
+        return -1;
+    }
+    if (mHeaderDone || (mTrackCount >= MUXER_MAX_TRACKS)) {
+        RT_LOGE("fail to add track, header: %d tracks: %d", mHeaderDone, mTrackCount);
+        return -1;
+    }
+
+    RTTrackParms track;
+    rt_memset(&track, 0, sizeof(RTTrackParms));
+    rt_medatdata_goto_trackpar(trackMeta, &track);
+    INT32 index = fa_format_add_stream(mFormatCtx, &track);
+    if (index >= 0) {
+        mTrackCount++;
+    }
+    return index;
+}
+
+RT_BOOL FFNodeMuxer::queryEOS() {
+    return mTrailerDone;
+}
+
+INT64 FFNodeMuxer::queryDuration() {
+    return mDurationUs;
+}
+
+RT_RET FFNodeMuxer::writePacket(RTMediaBuffer *packet) {
+    RtMetaData *meta  = packet->getMetaData();
+    INT32       index = -1;
+    INT32       eos   = 0;
+    meta->findInt32(kKeyPacketIndex, &index);
+    meta->findInt32(kKeyFrameEOS, &eos);
+    if ((index < 0) || (index >= mTrackCount)) {
+        RT_LOGE("drop packet of unknown track(%d)", index);
+        return RT_ERR_VALUE;
+    }
+
+    if (eos) {
+        mTrackEOS |= (1u << index);
+        RT_LOGD("track(%d) meets EOS", index);
+        if (mTrackEOS == ((1u << mTrackCount) - 1)) {
+            return writeTrailer();
+        }
+        return RT_OK;
+    }
+
+    RTPacket pkt;
+    rt_memset(&pkt, 0, sizeof(RTPacket));
+    meta->findInt64(kKeyPacketPts, &pkt.mPts);
+    meta->findInt64(kKeyPacketDts, &pkt.mDts);
+    meta->findInt32(kKeyPacketFlag, &pkt.mFlags);
+    pkt.mData = reinterpret_cast<uint8_t *>(packet->getData());
+    pkt.mSize = packet->getLength();
+    if ((RT_NULL == pkt.mData) || (pkt.mSize <= 0)) {
+        return RT_OK;
+    }
+    if (fa_format_packet_write(mFormatCtx, index, &pkt) < 0) {
+        return RT_ERR_UNKNOWN;
+    }
+    mDurationUs = RT_MAX(mDurationUs, pkt.mPts);
+    mCountWrite++;
+    return RT_OK;
+}
+
+RT_RET FFNodeMuxer::writeTrailer() {
+    if (fa_format_write_trailer(mFormatCtx) < 0) {
+        RT_LOGE("fail to write trailer");
+    }
+    mTrailerDone = RT_TRUE;
+    RT_LOGD("trailer is written, packets: %d/%d duration: %lldms",
+             mCountWrite, mCountPush, mDurationUs / 1000);
+    return RT_OK;
+}
+
+/*
+ * header is written with the first packet, all tracks are added then.
+ * packets are written as fast as they come, muxer interleaves them.
+ */
+RT_RET FFNodeMuxer::runTask() {
+    while (THREAD_LOOP == mProcThread->getState()) {
+        if (!mStarted || mTrailerDone) {
+            RtTime::sleepMs(5);
+            continue;
+        }
+
+        RTMediaBuffer *packet = RT_NULL;
+        {
+            RtMutex::RtAutolock autoLock(mLockPacketQ);
+            RT_DequeEntry entry = deque_pop(mPacketQ);
+            packet = reinterpret_cast<RTMediaBuffer *>(entry.data);
+        }
+        if (RT_NULL == packet) {
+            INT64 waitUs = RtTime::getNowTimeUs();
+            RtTime::sleepMs(2);
+            rt_node_stat_wait_input(&mNodeStat, RtTime::getNowTimeUs() - waitUs);
+            continue;
+        }
+
+        if (!mHeaderDone) {
+            if (fa_format_write_header(mFormatCtx) < 0) {
+                RT_LOGE("fail to write header, tracks: %d", mTrackCount);
+                mTrailerDone = RT_TRUE;
+            }
+            mHeaderDone = RT_TRUE;
+        }
+        if (!mTrailerDone) {
+            INT64 procUs = RtTime::getNowTimeUs();
+            RT_TRACE_BEGIN("muxer", "write packet");
+            writePacket(packet);
+            RT_TRACE_END("muxer", "write packet");
+            rt_node_stat_process(&mNodeStat, RtTime::getNowTimeUs() - procUs);
+        } else {
+            rt_node_stat_drop(&mNodeStat);
+        }
+        packet->release();
+    }
+
+    RT_LOGD("exit ffmpeg muxer run task");
+    return RT_OK;
+}
+
+RT_RET FFNodeMuxer::onStart() {
+    mStarted = RT_TRUE;
+    return RT_OK;
+}
+
+RT_RET FFNodeMuxer::onPause() {
+    RT_LOGD("call, pause");
+    mStarted = RT_FALSE;
+    return RT_OK;
+}
+
+RT_RET FFNodeMuxer::onStop() {
+    mStarted = RT_FALSE;
+    mProcThread->requestInterruption();
+    mProcThread->join();
+    onFlush();
+    return RT_OK;
+}
+
+RT_RET FFNodeMuxer::onReset() {
+    RT_LOGD("call, reset and flush in muxer");
+    return onFlush();
+}
+
+RT_RET FFNodeMuxer::onPrepare() {
+    RT_LOGD("call, prepare");
+    mProcThread->start();
+    return RT_OK;
+}
+
+RT_RET FFNodeMuxer::onFlush() {
+    RT_LOGD("call, flush");
+    while (deque_size(mPacketQ) > 0) {
+        RtMutex::RtAutolock autoLock(mLockPacketQ);
+        RT_DequeEntry entry = deque_pop(mPacketQ);
+        if (entry.data) {
+            reinterpret_cast<RTMediaBuffer *>(entry.data)->release();
+            rt_node_stat_drop(&mNodeStat);
+        }
+    }
+    return RT_OK;
+}
+
+static RTNode* createFFMuxer() {
+    return new FFNodeMuxer();
+}
+
+struct RTNodeStub ff_node_muxer {
+    .mCreateNode     = createFFMuxer,
+    .mNodeType       = RT_NODE_TYPE_MUXER,
+    .mUsePool        = RT_FALSE,
+    .mNodeName       = "ff_node_muxer",
+    .mNodeRole       = "video,audio",
+    .mNodeVersion    = "v1.0",
+};
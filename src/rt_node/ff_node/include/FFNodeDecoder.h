@@ -23,6 +23,7 @@
 
 #include "rt_header.h"      // NOLINT
 #include "rt_thread.h"      // NOLINT
+#include "rt_executor.h"    // NOLINT
 #include "RTNodeCodec.h"    // NOLINT
 #include "FFAdapterCodec.h" // NOLINT
 #include "RTObject.h"       // NOLINT
@@ -32,7 +33,7 @@ class FFNodeDecoder : public RTNodeCodec {
  public:
     FFNodeDecoder();
     virtual ~FFNodeDecoder();
-    RT_RET runTask();
+    INT64  runStep();
 
  public:
     // override RTNode public methods
@@ -56,8 +57,11 @@ class FFNodeDecoder : public RTNodeCodec {
     virtual RT_RET onReset();
     virtual RT_RET onFlush();
     virtual RT_RET onPrepare();
+    virtual RT_RET onTrickPlay(RtMetaData *options);
+    virtual RT_RET onSeek(RtMetaData *options);
 
     RT_RET allocateBuffersOnPort(RTPortType port);
+    RT_RET reinit(RtMetaData *metadata);
 
  public:
     // borrow and return buffer for pool buffer
@@ -66,10 +70,11 @@ class FFNodeDecoder : public RTNodeCodec {
 
  private:
     void signalError(UINT32 what);
+    void signalFirstFrame();
 
  private:
     FACodecContext      *mFFCodec;
-    RtThread            *mProcThread;
+    RtJob               *mJob;
 
     RTMediaBufferPool   *mPacketPool;
     RTMediaBufferPool   *mFramePool;
@@ -87,11 +92,21 @@ class FFNodeDecoder : public RTNodeCodec {
     RTTrackType          mTrackType;
 
     RT_BOOL              mStarted;
+    RT_BOOL              mDraining;      // packet of EOS is sent, frames are left
+
+    // exact seek, target is handed to decoder by its own thread
+    INT64                mSeekTargetUs;
+    INT64                mSeekBeginUs;
+    RT_BOOL              mSeekPending;
 
     UINT32               mCountPull;
     UINT32               mCountPush;
     RT_BOOL              mUsePool;
     RT_BOOL              mByPass;
+
+    // buffers kept by job between steps
+    RTMediaBuffer       *mInput;
+    RTMediaBuffer       *mOutput;
 };
 
 extern struct RTNodeStub ff_node_decoder;
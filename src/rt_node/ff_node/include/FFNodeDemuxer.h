@@ -31,7 +31,7 @@ class FFNodeDemuxer : public RTNodeDemuxer {
  public:
     FFNodeDemuxer();
     ~FFNodeDemuxer();
-    RT_RET runTask();
+    INT64  runStep();
 
     // override RTNode public methods
     virtual RT_RET init(RtMetaData *metaData);
@@ -63,6 +63,8 @@ class FFNodeDemuxer : public RTNodeDemuxer {
     virtual RT_RET onFlush();
     virtual RT_RET onSeek(RtMetaData *options);
     virtual RT_RET onPrepare();
+    virtual RT_RET onTrickPlay(RtMetaData *options);
+    virtual RT_RET onSelectTrack(RtMetaData *options);
 };
 
 extern struct RTNodeStub ff_node_demuxer;
@@ -26,8 +26,8 @@
 #include "FFAdapterCodec.h" // NOLINT
 #include "rt_thread.h" // NOLINT
 #include "RTMediaBuffer.h" // NOLINT
-#include "RTObject.h"   // NOLINT
-#include "RTObjectPool.h"   // NOLINT
+#include "rt_dequeue.h" // NOLINT
+#include "rt_mutex.h" // NOLINT
 
 class FFNodeEncoder : public RTNodeCodec {
  public:
@@ -40,8 +40,8 @@ class FFNodeEncoder : public RTNodeCodec {
     virtual RT_RET init(RtMetaData *metadata);
     virtual RT_RET release();
 
-    virtual RT_RET pullBuffer(RTMediaBuffer **frame);
-    virtual RT_RET pushBuffer(RTMediaBuffer*  packet);
+    virtual RT_RET pullBuffer(RTMediaBuffer **packet);
+    virtual RT_RET pushBuffer(RTMediaBuffer*  frame);
 
     virtual RT_RET runCmd(RT_NODE_CMD cmd, RtMetaData *metadata);
     virtual RT_RET setEventLooper(RTMsgLooper* eventLooper);
@@ -58,6 +58,7 @@ class FFNodeEncoder : public RTNodeCodec {
     virtual RT_RET onStop();
     virtual RT_RET onReset();
     virtual RT_RET onFlush();
+    virtual RT_RET onPrepare();
 
     RT_RET allocateBuffersOnPort(RTPortType port);
 
@@ -69,15 +70,23 @@ class FFNodeEncoder : public RTNodeCodec {
  private:
     FACodecContext      *mFFCodec;
     RtThread            *mProcThread;
-    RTObjectPool        *mUnusedInputPort;
-    RTObjectPool        *mUsedInputPort;
-    RTObjectPool        *mUnusedOutputPort;
-    RTObjectPool        *mUsedOutputPort;
+
+    // frames belong to upstream, packets are lent by encoder
+    RTMediaBufferPool   *mPacketPool;
+    rt_deque            *mFrameQ;
+    rt_deque            *mPacketQ;
+    RtMutex             *mLockFrameQ;
+    RtMutex             *mLockPacketQ;
+
     RTMsgLooper         *mEventLooper;
+    RtMetaData          *mMetaInput;
+    RtMetaData          *mMetaOutput;
+
+    RT_BOOL              mStarted;
+    RT_BOOL              mDraining;
 
     UINT32               mCountPull;
     UINT32               mCountPush;
-    RT_BOOL              mUsePool;
 };
 
 extern struct RTNodeStub ff_node_video_encoder;
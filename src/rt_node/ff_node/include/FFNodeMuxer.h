@@ -15,10 +15,77 @@
  *
  * Author: TOD - UNKOWN
  *   Date: 2018/11/03
- *   Task: use ffmpeg as filters
+ *   Task: use ffmpeg as muxer
  */
 
 #ifndef SRC_RT_NODE_FF_NODE_INCLUDE_FFNODEMUXER_H_
 #define SRC_RT_NODE_FF_NODE_INCLUDE_FFNODEMUXER_H_
 
+#include "RTNodeMuxer.h" // NOLINT
+#include "rt_header.h" // NOLINT
+#include "FFAdapterFormat.h" // NOLINT
+#include "rt_thread.h" // NOLINT
+#include "RTMediaBuffer.h" // NOLINT
+#include "rt_dequeue.h" // NOLINT
+#include "rt_mutex.h" // NOLINT
+
+#define MUXER_MAX_TRACKS    16
+
+class FFNodeMuxer : public RTNodeMuxer {
+ public:
+    FFNodeMuxer();
+    virtual ~FFNodeMuxer();
+    RT_RET runTask();
+
+    // override RTNode public methods
+    virtual RT_RET init(RtMetaData *metadata);
+    virtual RT_RET release();
+
+    virtual RT_RET pullBuffer(RTMediaBuffer** data);
+    virtual RT_RET pushBuffer(RTMediaBuffer*  data);
+
+    virtual RT_RET runCmd(RT_NODE_CMD cmd, RtMetaData *metadata);
+    virtual RT_RET setEventLooper(RTMsgLooper* eventLooper);
+
+    virtual RtMetaData* queryFormat(RTPortType port);
+    virtual RTNodeStub* queryStub();
+
+ public:
+    // override RTNodeMuxer methods
+    virtual INT32   addTrack(RtMetaData *trackMeta);
+    virtual RT_BOOL queryEOS();
+    virtual INT64   queryDuration();
+
+ protected:
+    // override RTNode protected methods
+    virtual RT_RET onStart();
+    virtual RT_RET onPause();
+    virtual RT_RET onStop();
+    virtual RT_RET onReset();
+    virtual RT_RET onFlush();
+    virtual RT_RET onPrepare();
+
+ private:
+    RT_RET writePacket(RTMediaBuffer *packet);
+    RT_RET writeTrailer();
+
+ private:
+    FAFormatContext *mFormatCtx;
+    RtThread        *mProcThread;
+    rt_deque        *mPacketQ;
+    RtMutex         *mLockPacketQ;
+    RTMsgLooper     *mEventLooper;
+    RtMetaData      *mMetaInput;    // needs of muxer for encoders
+    INT32            mTrackCount;
+    UINT32           mTrackEOS;     // bits of tracks at EOS
+    INT64            mDurationUs;
+    RT_BOOL          mHeaderDone;
+    RT_BOOL          mTrailerDone;
+    RT_BOOL          mStarted;
+    UINT32           mCountPush;
+    UINT32           mCountWrite;
+};
+
+extern struct RTNodeStub ff_node_muxer;
+
 #endif  // SRC_RT_NODE_FF_NODE_INCLUDE_FFNODEMUXER_H_
@@ -195,6 +195,10 @@ RT_RET HWNodeMpiDecoder::runCmd(RT_NODE_CMD cmd, RtMetaData *metadata) {
     case RT_NODE_CMD_PAUSE:
         err = this->onPause();
         break;
+    case RT_NODE_CMD_STAT:
+    case RT_NODE_CMD_LATENCY:
+        err = rt_node_stat_query(&mNodeStat, cmd, metadata);
+        break;
     default:
         RT_LOGE("unkown command: %d", cmd);
         err = RT_ERR_UNKNOWN;
@@ -224,6 +228,7 @@ RTNodeStub* HWNodeMpiDecoder::queryStub() {
 
 RT_RET HWNodeMpiDecoder::onStart() {
     RT_RET err = RT_OK;
+    mProcThread->setSchedClass(mThreadClass);
     mProcThread->start();
     return err;
 }
@@ -325,5 +330,6 @@ struct RTNodeStub hw_node_mpi_decoder {
     .mNodeName       = "hw_node_mpi_decoder",
     .mNodeRole       = "video",
     .mNodeVersion    = "v1.0",
+    .mThreadClass    = RT_THREAD_CLASS_DECODE,
 };
 
@@ -204,6 +204,10 @@ RT_RET HWNodeMpiEncoder::runCmd(RT_NODE_CMD cmd, RtMetaData *metadata) {
     case RT_NODE_CMD_PAUSE:
         err = this->onPause();
         break;
+    case RT_NODE_CMD_STAT:
+    case RT_NODE_CMD_LATENCY:
+        err = rt_node_stat_query(&mNodeStat, cmd, metadata);
+        break;
     default:
         RT_LOGE("unkown command: %d", cmd);
         err = RT_ERR_UNKNOWN;
@@ -227,6 +231,7 @@ RTNodeStub* HWNodeMpiEncoder::queryStub() {
 
 RT_RET HWNodeMpiEncoder::onStart() {
     RT_RET          err = RT_OK;
+    mProcThread->setSchedClass(mThreadClass);
     mProcThread->start();
     return err;
 }
@@ -327,5 +332,6 @@ struct RTNodeStub hw_node_mpi_encoder {
     .mNodeName       = "hw_node_mpi_encoder",
     .mNodeRole       = "video",
     .mNodeVersion    = "v1.0",
+    .mThreadClass    = RT_THREAD_CLASS_DECODE,
 };
 
@@ -39,6 +39,8 @@
 #include "RTMediaBuffer.h"  // NOLINT
 #include "RTMediaData.h"    // NOLINT
 #include "RTMediaDef.h"     // NOLINT
+#include "RTNodeStat.h"     // NOLINT
+#include "rt_thread.h"      // NOLINT
 
 #ifdef __cplusplus
 extern "C" {
@@ -57,6 +59,10 @@ typedef enum {
 struct RTNodeStub;
 class RTNode {
  public:
+    RTNode() : mNodeContext(RT_NULL), mNext(RT_NULL), mPrev(RT_NULL),
+               mThreadClass(RT_THREAD_CLASS_DEFAULT), mUseExecutor(RT_FALSE) {
+        rt_node_stat_reset(&mNodeStat);
+    }
     virtual ~RTNode() {}
     // core api for media plugins
     virtual RT_RET init(RtMetaData *metaData) = 0;
@@ -89,6 +95,14 @@ class RTNode {
  public:
     RTNode  *mNext;
     RTNode  *mPrev;
+
+    // buffers in and out are counted by RTNodeAdapter, others by node
+    RTNodeStat mNodeStat;
+
+    // scheduling of worker threads, resolved by RTNodeAdapter::init
+    RT_THREAD_CLASS mThreadClass;
+    // work loop runs on shared executor instead of own thread
+    RT_BOOL         mUseExecutor;
 };
 
 class RTNodeAdapter {
@@ -118,6 +132,9 @@ struct RTNodeStub {
     const char*        mNodeName;
     const char*        mNodeRole;
     const char*        mNodeVersion;
+    const RT_THREAD_CLASS mThreadClass;   // default scheduling of worker threads
+    const RT_BOOL      mUseExecutor;      // work loop can share workers of executor
+    const RT_BOOL      mRecyclable;       // released node is kept warm by bus, see REINIT
 };
 
 RT_RET check_err(RTNode *node, INT8 err, const char* func_name);
@@ -54,16 +54,41 @@ class RTNodeBus {
 
     /* use metadata to init node_bus */
     RT_RET      autoBuild(RTMediaUri* mediaUri);
-    RT_RET      autoBuildCodecSink();
+    RT_RET      autoBuildCodecSink(RT_BOOL withSink = RT_TRUE);
+    /* codec and sink of one line, lines may be built in parallel */
+    RT_RET      autoBuildLine(BUS_LINE_TYPE lType, RT_BOOL withSink = RT_TRUE);
+    /* video line of decoder, filter, encoder and muxer, muxer is tail of line */
+    RT_RET      autoBuildTranscode(RtMetaData *option);
+    /* target size or format of video line, a filter is chained before sink */
+    RT_RET      setFilterOption(RtMetaData *option);
     RT_RET      releaseNodes();
     RTNode*     getRootNode(BUS_LINE_TYPE lType);
     RT_RET      excuteCommand(RT_NODE_CMD cmd, RtMetaData *option = RT_NULL);
     RT_RET      setMemAllocator(RtMetaData *option);
 
+    /* sink override and reuse, used by gapless playback */
+    RT_RET      setSinkStub(BUS_LINE_TYPE lType, RTNodeStub *nStub, const char* uri = RT_NULL);
+    RTNodeStub* querySinkStub(BUS_LINE_TYPE lType);
+    RT_RET      setSinkOption(RtMetaData *option);
+    RTNode*     detachSink(BUS_LINE_TYPE lType);
+    RT_RET      attachSink(RTNode *pSink, BUS_LINE_TYPE lType);
+
+    /* codec of other track, used by audio track switching */
+    RTNode*     buildTrackCodec(INT32 index, RTTrackType tType);
+    RTNode*     swapCodec(RTNode *pCodec, BUS_LINE_TYPE lType);
+
+    /* warm pool of released nodes, reused by compatible sources */
+    RTNode*     acquireWarmNode(RTNodeStub *nStub, RtMetaData *nMeta);
+    RT_RET      recycleNode(RTNode *pNode, RtMetaData *nMeta);
+    RT_RET      clearWarmNodes();
+
     /* node manager */
     RT_RET      summary(INT32 fd, RT_BOOL full = RT_FALSE);
+    /* snapshot of statistics of all nodes in lines, by RT_NODE_CMD_STAT */
+    RT_RET      queryStat(RTNodeBusStat *snapshot);
     RT_RET      registerStub(RTNodeStub *nStub);
     RT_RET      registerNode(RTNode     *pNode);
+    RT_RET      unregisterNode(RTNode   *pNode);
     RT_RET      registerMetadata(RtMetaData *codecMeta);
     RTNodeStub* findStub(RTNodeInfo *nodeInfo);
     RTNode*     findNode(RTNodeInfo *nodeInfo);
@@ -71,6 +96,7 @@ class RTNodeBus {
 
  private:
     RT_RET      registerCoreStubs();
+    RTNode*     autoBuildFilter(RTNode *upstream, RtMetaData *option);
     RT_RET      nodeChainAppend(RTNode *pNode, BUS_LINE_TYPE lType);
     RT_RET      nodeChainDriver(RTNode *pNode, BUS_LINE_TYPE lType);
     RT_RET      nodeChainDumper(BUS_LINE_TYPE lType);
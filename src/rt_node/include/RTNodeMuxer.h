@@ -27,6 +27,13 @@ extern "C" {
 #endif
 
 class RTNodeMuxer : public RTNode {
+ public:
+    // tracks are added before start, index of track is returned
+    virtual INT32   addTrack(RtMetaData *trackMeta) = 0;
+    // all tracks meet EOS and trailer is written
+    virtual RT_BOOL queryEOS() = 0;
+    virtual INT64   queryDuration() = 0;
+
  protected:
     virtual RT_RET onStart() = 0;
     virtual RT_RET onStop()  = 0;
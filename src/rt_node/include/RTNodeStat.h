@@ -0,0 +1,93 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * module: runtime statistics of node, counters are updated by atomic adds
+ *         without lock, so that they are cheap on the path of buffers.
+ */
+
+#ifndef SRC_RT_NODE_INCLUDE_RTNODESTAT_H_
+#define SRC_RT_NODE_INCLUDE_RTNODESTAT_H_
+
+#include "rt_header.h"      // NOLINT
+#include "rt_node_define.h" // NOLINT
+
+class  RtMetaData;
+
+/*
+ * bins of processing time, bin 0 is less than NODE_STAT_HIST_BASE_US,
+ * bin i is less than NODE_STAT_HIST_BASE_US << i, the last one is the rest.
+ */
+#define NODE_STAT_HIST_BINS         16
+#define NODE_STAT_HIST_BASE_US      64
+#define NODE_STAT_MAX_NODES         16
+
+typedef struct _RTNodeStat {
+    volatile UINT64  mBufferIn;
+    volatile UINT64  mBufferOut;
+    volatile UINT64  mBytesIn;
+    volatile UINT64  mBytesOut;
+    volatile UINT64  mDrops;
+    volatile UINT64  mQueueDepth;       // input queue of node, the last one
+    volatile UINT64  mQueueMax;
+    volatile UINT64  mWaitInputUs;      // time of node which is blocked on input
+    volatile UINT64  mWaitOutputUs;     // time of node which is blocked on output
+    volatile UINT64  mProcCount;
+    volatile UINT64  mProcUs;
+    volatile UINT64  mProcMaxUs;
+    volatile UINT64  mProcHist[NODE_STAT_HIST_BINS];
+} RTNodeStat;
+
+// one node of snapshot, stat is a copy at the time of snapshot
+typedef struct _RTNodeStatEntry {
+    const char      *mNodeName;
+    RT_NODE_TYPE     mNodeType;
+    BUS_LINE_TYPE    mLineType;
+    RTNodeStat       mStat;
+} RTNodeStatEntry;
+
+typedef struct _RTNodeBusStat {
+    INT64            mTimeUs;
+    INT32            mCount;
+    RTNodeStatEntry  mNodes[NODE_STAT_MAX_NODES];
+} RTNodeBusStat;
+
+void   rt_node_stat_reset(RTNodeStat *stat);
+
+// buffers and bytes which are pushed to or pulled from node
+void   rt_node_stat_input(RTNodeStat *stat, UINT32 bytes);
+void   rt_node_stat_output(RTNodeStat *stat, UINT32 bytes);
+void   rt_node_stat_drop(RTNodeStat *stat, UINT32 count = 1);
+void   rt_node_stat_queue(RTNodeStat *stat, UINT32 depth);
+void   rt_node_stat_wait_input(RTNodeStat *stat, INT64 costUs);
+void   rt_node_stat_wait_output(RTNodeStat *stat, INT64 costUs);
+void   rt_node_stat_process(RTNodeStat *stat, INT64 costUs);
+
+void   rt_node_stat_copy(RTNodeStat *dst, const RTNodeStat *src);
+
+/*
+ * processing time of percent(1~100) of buffers is less than the result,
+ * it is the upper bound of bin, the last bin is bounded by the max time.
+ */
+INT64  rt_node_stat_percentile(const RTNodeStat *stat, INT32 percent);
+
+/*
+ * answer of RT_NODE_CMD_STAT and RT_NODE_CMD_LATENCY:
+ * RT_NODE_CMD_STAT copies stat to RTNodeStat of kKeyNodeStat.
+ * RT_NODE_CMD_LATENCY sets average, 99th percentile and max processing
+ * time to kKeyNodeLatencyUs, kKeyNodeLatencyP99Us and kKeyNodeLatencyMaxUs.
+ */
+RT_RET rt_node_stat_query(const RTNodeStat *stat, RT_NODE_CMD cmd, RtMetaData *metadata);
+
+#endif  // SRC_RT_NODE_INCLUDE_RTNODESTAT_H_
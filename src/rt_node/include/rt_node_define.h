@@ -63,6 +63,8 @@ typedef enum _RT_NODE_CMD {
     RT_NODE_CMD_PAUSE,
     RT_NODE_CMD_NAVIGATION,
     RT_NODE_CMD_DRAIN,
+    RT_NODE_CMD_TRICKPLAY,
+    RT_NODE_CMD_SELECT_TRACK,
 
     // QOS and debug cmd
     RT_NODE_CMD_LATENCY,
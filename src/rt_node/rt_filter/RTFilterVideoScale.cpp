@@ -0,0 +1,651 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * module: video filter of scale and format conversion, frames are cut
+ *         into slices of rows, which are filtered by threads together.
+ */
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "RTFilterVideoScale"
+
+#ifdef DEBUG_FLAG
+#undef DEBUG_FLAG
+#endif
+#define DEBUG_FLAG 0x0
+
+#include "RTFilterVideoScale.h" // NOLINT
+#include "rt_metadata.h" // NOLINT
+#include "rt_cpu_info.h" // NOLINT
+#include "rt_time.h" // NOLINT
+#include "RTMediaMetaKeys.h" // NOLINT
+#include "RTMediaBufferPool.h" // NOLINT
+#include "RTImageScale.h" // NOLINT
+#include "RTImageColor.h" // NOLINT
+#include "rt_trace.h" // NOLINT
+
+#define MAX_INPUT_BUFFER_COUNT      4
+#define MAX_OUTPUT_BUFFER_COUNT     6
+
+// frames smaller than 2 slices of pixels are filtered by one thread
+#define FILTER_SLICE_PIXELS         (128 * 1024)
+#define FILTER_SLICE_MIN_ROWS       16
+
+/*
+ * one frame which is filtered. planes of dst are yuv420p of output, or
+ * the scaled planes which are converted to rgb of output then.
+ */
+struct RTFilterFrame {
+    RtVideoFormat     mFormat;
+    RTImageRGBFormat  mRGBFormat;
+    RTImageScaleMode  mMode;
+    RTColorSpace      mSpace;
+    RTColorRange      mRange;
+    INT32             mDstW;
+    INT32             mDstH;
+    INT32             mSize;
+    INT32             mThreads;
+
+    const UINT8      *mSrc[3];
+    INT32             mSrcStride[3];
+    INT32             mSrcW;
+    INT32             mSrcH;
+    UINT8            *mDst[3];
+    INT32             mDstStride[3];
+    UINT8            *mRGB;
+    INT32             mRGBStride;
+    UINT8            *mScaled;
+    INT32             mSliceRows;
+};
+
+// words of 32 bits are little endian, so ABGR8888 is R G B A in memory
+static RT_BOOL filter_rgb_format(INT32 format, RTImageRGBFormat *rgb, INT32 *bpp) {
+    switch (format) {
+      case RT_FMT_RGB888:
+        *rgb = RT_IMAGE_RGB24;
+        *bpp = 3;
+        break;
+      case RT_FMT_ABGR8888:
+        *rgb = RT_IMAGE_RGBA32;
+        *bpp = 4;
+        break;
+      case RT_FMT_ARGB8888:
+        *rgb = RT_IMAGE_BGRA32;
+        *bpp = 4;
+        break;
+      default:
+        return RT_FALSE;
+    }
+    return RT_TRUE;
+}
+
+static void filter_yuv420_planes(UINT8 *data, INT32 width, INT32 height, UINT8 *planes[3], INT32 strides[3]) {
+    strides[0] = width;
+    strides[1] = (width + 1) / 2;
+    strides[2] = (width + 1) / 2;
+    planes[0]  = data;
+    planes[1]  = planes[0] + strides[0] * height;
+    planes[2]  = planes[1] + strides[1] * ((height + 1) / 2);
+}
+
+static INT32 filter_yuv420_size(INT32 width, INT32 height) {
+    return width * height + 2 * ((width + 1) / 2) * ((height + 1) / 2);
+}
+
+// rows [y, y + rows) of yuv420p to rgb, y is even
+static RT_RET filter_convert_rows(const UINT8 *const planes[3], const INT32 strides[3], INT32 y, INT32 rows,
+                                  const RTFilterFrame *frame) {
+    RTImageYUV yuv;
+    rt_memset(&yuv, 0, sizeof(RTImageYUV));
+    yuv.mPlane[0]  = planes[0] + y * strides[0];
+    yuv.mPlane[1]  = planes[1] + (y / 2) * strides[1];
+    yuv.mPlane[2]  = planes[2] + (y / 2) * strides[2];
+    yuv.mStride[0] = strides[0];
+    yuv.mStride[1] = strides[1];
+    yuv.mStride[2] = strides[2];
+    yuv.mWidth     = frame->mDstW;
+    yuv.mHeight    = rows;
+    yuv.mFormat    = RT_FMT_YUV420P;
+    return rt_image_yuv_to_rgb(&yuv, frame->mRGB + y * frame->mRGBStride, frame->mRGBStride,
+                               frame->mRGBFormat, frame->mSpace, frame->mRange);
+}
+
+void* rt_filter_scale_loop(void* ptr_node) {
+    RTFilterVideoScale* node = reinterpret_cast<RTFilterVideoScale*>(ptr_node);
+    node->runTask();
+    return RT_NULL;
+}
+
+void* rt_filter_slice_loop(void* ptr_node) {
+    RTFilterVideoScale* node = reinterpret_cast<RTFilterVideoScale*>(ptr_node);
+    node->runWorker();
+    return RT_NULL;
+}
+
+RTFilterVideoScale::RTFilterVideoScale()
+        : mWorkerCount(0),
+          mWorkersRun(RT_FALSE),
+          mSliceRound(0),
+          mSliceCount(0),
+          mSliceNext(0),
+          mSliceDone(0),
+          mSliceError(RT_OK),
+          mFramePool(RT_NULL),
+          mEventLooper(RT_NULL),
+          mMetaInput(RT_NULL),
+          mMetaOutput(RT_NULL),
+          mStarted(RT_FALSE),
+          mCountPush(0),
+          mCountPull(0) {
+    mProcThread = new RtThread(rt_filter_scale_loop, reinterpret_cast<void*>(this));
+    mProcThread->setName("FilterScale");
+    rt_memset(mWorkers, 0, sizeof(mWorkers));
+
+    mFrame = rt_malloc(RTFilterFrame);
+    rt_memset(mFrame, 0, sizeof(RTFilterFrame));
+
+    mInputQ = deque_create();
+    RT_ASSERT(RT_NULL != mInputQ);
+
+    mOutputQ = deque_create();
+    RT_ASSERT(RT_NULL != mOutputQ);
+
+    mLockInputQ  = new RtMutex();
+    mLockOutputQ = new RtMutex();
+    mLockSlice   = new RtMutex();
+    mCondSlice   = new RtCondition();
+    mCondDone    = new RtCondition();
+}
+
+RTFilterVideoScale::~RTFilterVideoScale() {
+    onFlush();
+
+    release();
+    rt_safe_delete(mLockInputQ);
+    rt_safe_delete(mLockOutputQ);
+    rt_safe_delete(mLockSlice);
+    rt_safe_delete(mCondSlice);
+    rt_safe_delete(mCondDone);
+    deque_destory(&mInputQ);
+    deque_destory(&mOutputQ);
+    rt_safe_free(mFrame);
+    mNodeContext = RT_NULL;
+}
+
+/*
+ * metadata: kKeyFrameW/kKeyFrameH of input, kKeyVCodecWidth/kKeyVCodecHeight
+ * of output, and optional kKeyCodecFormat of output, kKeyFilterScaleMode,
+ * kKeyFilterThreads, kKeyVCodecColorSpace and kKeyVCodecColorRange.
+ * input is yuv420p, output is yuv420p or rgb of even size.
+ */
+RT_RET RTFilterVideoScale::init(RtMetaData *metadata) {
+    INT32 srcW = 0, srcH = 0, dstW = 0, dstH = 0, bpp = 0;
+    INT32 format  = RT_FMT_YUV420P;
+    INT32 mode    = RT_IMAGE_SCALE_BILINEAR;
+    INT32 threads = 0;
+    INT32 space   = RTCOL_SPC_BT470BG;
+    INT32 range   = RTCOL_RANGE_MPEG;
+    if ((RT_NULL == metadata) || !metadata->findInt32(kKeyFrameW, &srcW) || !metadata->findInt32(kKeyFrameH, &srcH)) {
+        RT_LOGE("no size of input");
+        return RT_ERR_VALUE;
+    }
+    if (!metadata->findInt32(kKeyVCodecWidth, &dstW) || !metadata->findInt32(kKeyVCodecHeight, &dstH)) {
+        dstW = srcW;
+        dstH = srcH;
+    }
+    metadata->findInt32(kKeyCodecFormat, &format);
+    metadata->findInt32(kKeyFilterScaleMode, &mode);
+    metadata->findInt32(kKeyFilterThreads, &threads);
+    metadata->findInt32(kKeyVCodecColorSpace, &space);
+    metadata->findInt32(kKeyVCodecColorRange, &range);
+
+    RTFilterFrame *frame = mFrame;
+    if (RT_FMT_YUV420P == format) {
+        frame->mSize = filter_yuv420_size(dstW, dstH);
+    } else if (filter_rgb_format(format, &frame->mRGBFormat, &bpp)) {
+        frame->mSize   = dstW * dstH * bpp;
+        frame->mScaled = rt_malloc_size(UINT8, filter_yuv420_size(dstW, dstH));
+    } else {
+        RT_LOGE("unsupported format(%d) of output", format);
+        return RT_ERR_VALUE;
+    }
+    if ((srcW <= 0) || (srcH <= 0) || (dstW <= 0) || (dstH <= 0) || (dstW & 1) || (dstH & 1)) {
+        RT_LOGE("unsupported size, input: %dx%d output: %dx%d", srcW, srcH, dstW, dstH);
+        return RT_ERR_VALUE;
+    }
+    frame->mFormat  = (RtVideoFormat)format;
+    frame->mMode    = (RT_IMAGE_SCALE_BICUBIC == mode) ? RT_IMAGE_SCALE_BICUBIC : RT_IMAGE_SCALE_BILINEAR;
+    frame->mSpace   = (RTColorSpace)space;
+    frame->mRange   = (RTColorRange)range;
+    frame->mDstW    = dstW;
+    frame->mDstH    = dstH;
+    frame->mSrcW    = srcW;
+    frame->mSrcH    = srcH;
+    frame->mThreads = RT_MIN(RT_MAX((threads > 0) ? threads : (INT32)rt_cpu_count(), 1), FILTER_MAX_THREADS);
+
+    // proc thread takes slices too, workers are the others
+    mWorkerCount = frame->mThreads - 1;
+    for (INT32 idx = 0; idx < mWorkerCount; idx++) {
+        mWorkers[idx] = new RtThread(rt_filter_slice_loop, reinterpret_cast<void*>(this));
+        mWorkers[idx]->setName("FilterSlice");
+    }
+
+    // @Best Practice: mMetaInput and mMetaOutput are created and deleted by filter
+    mMetaInput = new RtMetaData();
+    mMetaInput->setInt32(kKeyFrameW, srcW);
+    mMetaInput->setInt32(kKeyFrameH, srcH);
+    mMetaInput->setInt32(kKeyCodecFormat, RT_FMT_YUV420P);
+    mMetaOutput = new RtMetaData();
+    mMetaOutput->setInt32(kKeyFrameW, dstW);
+    mMetaOutput->setInt32(kKeyFrameH, dstH);
+    mMetaOutput->setInt32(kKeyCodecFormat, format);
+
+    mFramePool = new RTMediaBufferPool(MAX_OUTPUT_BUFFER_COUNT);
+    for (UINT32 idx = 0; idx < MAX_OUTPUT_BUFFER_COUNT; idx++) {
+        mFramePool->registerBuffer(new RTMediaBuffer(frame->mSize));
+    }
+    RT_LOGD("init, %dx%d -> %dx%d format: %d mode: %d threads: %d",
+             srcW, srcH, dstW, dstH, format, frame->mMode, frame->mThreads);
+    return RT_OK;
+}
+
+RT_RET RTFilterVideoScale::release() {
+    if (RT_NULL != mFramePool) {
+        // wakes proc thread which waits for frames of output
+        mFramePool->stop();
+    }
+    rt_safe_delete(mProcThread);
+    stopWorkers();
+    for (INT32 idx = 0; idx < FILTER_MAX_THREADS; idx++) {
+        rt_safe_delete(mWorkers[idx]);
+    }
+    mWorkerCount = 0;
+
+    rt_safe_delete(mFramePool);
+    rt_safe_delete(mMetaInput);
+    rt_safe_delete(mMetaOutput);
+    rt_safe_free(mFrame->mScaled);
+    return RT_OK;
+}
+
+RT_RET RTFilterVideoScale::pullBuffer(RTMediaBuffer** data) {
+    RtMutex::RtAutolock autoLock(mLockOutputQ);
+    RT_DequeEntry entry = deque_pop(mOutputQ);
+    if (RT_NULL == entry.data) {
+        return RT_ERR_LIST_EMPTY;
+    }
+    *data = reinterpret_cast<RTMediaBuffer *>(entry.data);
+    mCountPull++;
+    return RT_OK;
+}
+
+RT_RET RTFilterVideoScale::pushBuffer(RTMediaBuffer* data) {
+    if (RT_NULL == data) {
+        RT_LOGE("data is NULL!");
+        return RT_ERR_NULL_PTR;
+    }
+
+    // frames are held by upstream pool, they are never queued without limit
+    RtMutex::RtAutolock autoLock(mLockInputQ);
+    if (deque_size(mInputQ) >= MAX_INPUT_BUFFER_COUNT) {
+        return RT_ERR_LIST_FULL;
+    }
+    deque_push(mInputQ, reinterpret_cast<void *>(data));
+    rt_node_stat_queue(&mNodeStat, deque_size(mInputQ));
+    mCountPush++;
+    return RT_OK;
+}
+
+RT_RET RTFilterVideoScale::runCmd(RT_NODE_CMD cmd, RtMetaData *metadata) {
+    RT_RET err = RT_OK;
+    switch (cmd) {
+    case RT_NODE_CMD_INIT:
+        err = this->init(metadata);
+        break;
+    case RT_NODE_CMD_PREPARE:
+        err = this->onPrepare();
+        break;
+    case RT_NODE_CMD_START:
+        err = this->onStart();
+        break;
+    case RT_NODE_CMD_STOP:
+        err = this->onStop();
+        break;
+    case RT_NODE_CMD_FLUSH:
+        err = this->onFlush();
+        break;
+    case RT_NODE_CMD_PAUSE:
+        err = this->onPause();
+        break;
+    case RT_NODE_CMD_RESET:
+        err = this->onReset();
+        break;
+    case RT_NODE_CMD_STAT:
+    case RT_NODE_CMD_LATENCY:
+        err = rt_node_stat_query(&mNodeStat, cmd, metadata);
+        break;
+    default:
+        RT_LOGE("unkown command: %d", cmd);
+        err = RT_ERR_UNKNOWN;
+        break;
+    }
+
+    return err;
+}
+
+RT_RET RTFilterVideoScale::setEventLooper(RTMsgLooper* eventLooper) {
+    mEventLooper = eventLooper;
+    return RT_OK;
+}
+
+RtMetaData* RTFilterVideoScale::queryFormat(RTPortType port) {
+    RtMetaData *nMeta = RT_NULL;
+    switch (port) {
+    case RT_PORT_INPUT:
+        nMeta = mMetaInput;
+        break;
+    case RT_PORT_OUTPUT:
+        nMeta = mMetaOutput;
+        break;
+    default:
+        break;
+    }
+    return nMeta;
+}
+
+RTNodeStub* RTFilterVideoScale::queryStub() {
+    return &rt_filter_video_scale;
+}
+
+/*
+ * planes of frame are set by size of input, which follows the frame.
+ * slices are even rows of dst, at least FILTER_SLICE_MIN_ROWS.
+ */
+RT_RET RTFilterVideoScale::prepareFrame(RTMediaBuffer *input, RTMediaBuffer *output) {
+    RTFilterFrame *frame = mFrame;
+    RtMetaData    *meta  = input->getMetaData();
+    INT64 pts  = 0ll;
+    INT32 eos  = 0;
+    INT32 srcW = frame->mSrcW;
+    INT32 srcH = frame->mSrcH;
+    meta->findInt32(kKeyFrameW, &srcW);
+    meta->findInt32(kKeyFrameH, &srcH);
+    meta->findInt32(kKeyFrameEOS, &eos);
+    if (meta->findInt64(kKeyFramePts, &pts)) {
+        output->getMetaData()->setInt64(kKeyFramePts, pts);
+    }
+    if (eos) {
+        output->getMetaData()->setInt32(kKeyFrameEOS, 1);
+    }
+    output->getMetaData()->setInt32(kKeyFrameW, frame->mDstW);
+    output->getMetaData()->setInt32(kKeyFrameH, frame->mDstH);
+
+    UINT8 *src = reinterpret_cast<UINT8 *>(input->getData()) + input->getOffset();
+    if ((srcW <= 0) || (srcH <= 0) || (input->getLength() < (UINT32)filter_yuv420_size(srcW, srcH))) {
+        // frame of EOS has no picture
+        output->setRange(0, 0);
+        return RT_ERR_VALUE;
+    }
+
+    UINT8 *planes[3];
+    filter_yuv420_planes(src, srcW, srcH, planes, frame->mSrcStride);
+    for (INT32 idx = 0; idx < 3; idx++) {
+        frame->mSrc[idx] = planes[idx];
+    }
+    frame->mSrcW = srcW;
+    frame->mSrcH = srcH;
+
+    UINT8 *dst = reinterpret_cast<UINT8 *>(output->getData());
+    if (RT_FMT_YUV420P == frame->mFormat) {
+        filter_yuv420_planes(dst, frame->mDstW, frame->mDstH, frame->mDst, frame->mDstStride);
+        frame->mRGB = RT_NULL;
+    } else {
+        filter_yuv420_planes(frame->mScaled, frame->mDstW, frame->mDstH, frame->mDst, frame->mDstStride);
+        frame->mRGB       = dst;
+        frame->mRGBStride = frame->mSize / frame->mDstH;
+    }
+    output->setRange(0, frame->mSize);
+
+    INT32 pixels = RT_MAX(srcW * srcH, frame->mDstW * frame->mDstH);
+    INT32 slices = RT_MIN(frame->mThreads, pixels / FILTER_SLICE_PIXELS);
+    slices = RT_MAX(RT_MIN(slices, frame->mDstH / FILTER_SLICE_MIN_ROWS), 1);
+    frame->mSliceRows = RT_ALIGN((frame->mDstH + slices - 1) / slices, 2);
+    return RT_OK;
+}
+
+RT_RET RTFilterVideoScale::filterSlice(INT32 index) {
+    const RTFilterFrame *frame = mFrame;
+    INT32  y    = index * frame->mSliceRows;
+    INT32  rows = RT_MIN(frame->mSliceRows, frame->mDstH - y);
+    RT_RET err  = RT_OK;
+    if ((RT_NULL != frame->mRGB) && (frame->mSrcW == frame->mDstW) && (frame->mSrcH == frame->mDstH)) {
+        return filter_convert_rows(frame->mSrc, frame->mSrcStride, y, rows, frame);
+    }
+
+    err = rt_image_scale_yuv420_slice(frame->mSrc, frame->mSrcStride, frame->mSrcW, frame->mSrcH,
+                                      frame->mDst, frame->mDstStride, frame->mDstW, frame->mDstH,
+                                      frame->mMode, y, rows);
+    if ((RT_OK == err) && (RT_NULL != frame->mRGB)) {
+        err = filter_convert_rows(frame->mDst, frame->mDstStride, y, rows, frame);
+    }
+    return err;
+}
+
+void RTFilterVideoScale::takeSlices() {
+    while (RT_TRUE) {
+        INT32 index = 0;
+        {
+            RtMutex::RtAutolock autoLock(mLockSlice);
+            if (mSliceNext >= mSliceCount) {
+                return;
+            }
+            index = mSliceNext++;
+        }
+
+        RT_RET err = filterSlice(index);
+        RtMutex::RtAutolock autoLock(mLockSlice);
+        mSliceError = (RT_OK != err) ? err : mSliceError;
+        if (++mSliceDone == mSliceCount) {
+            mCondDone->signal();
+        }
+    }
+}
+
+/*
+ * workers wait for next round of slices, a worker which wakes up late
+ * finds no slice, or takes slices of the next round.
+ */
+RT_RET RTFilterVideoScale::runWorker() {
+    UINT32 round = 0;
+    while (RT_TRUE) {
+        {
+            RtMutex::RtAutolock autoLock(mLockSlice);
+            while (mWorkersRun && (round == mSliceRound)) {
+                mCondSlice->wait(mLockSlice);
+            }
+            if (!mWorkersRun) {
+                break;
+            }
+            round = mSliceRound;
+        }
+        takeSlices();
+    }
+    return RT_OK;
+}
+
+void RTFilterVideoScale::stopWorkers() {
+    {
+        RtMutex::RtAutolock autoLock(mLockSlice);
+        mWorkersRun = RT_FALSE;
+        mCondSlice->broadcast();
+    }
+    for (INT32 idx = 0; idx < mWorkerCount; idx++) {
+        mWorkers[idx]->join();
+    }
+}
+
+/*
+ * one frame of input is filtered into a frame of pool, filter waits for
+ * frames of pool, which are released by downstream.
+ */
+RT_RET RTFilterVideoScale::onFilter() {
+    RTMediaBuffer *input  = RT_NULL;
+    RTMediaBuffer *output = RT_NULL;
+    {
+        RtMutex::RtAutolock autoLock(mLockInputQ);
+        RT_DequeEntry entry = deque_pop(mInputQ);
+        input = reinterpret_cast<RTMediaBuffer *>(entry.data);
+    }
+    if (RT_NULL == input) {
+        return RT_ERR_LIST_EMPTY;
+    }
+    INT64  waitUs = RtTime::getNowTimeUs();
+    RT_TRACE_BEGIN("filter", "acquire frame");
+    RT_RET err    = mFramePool->acquireBuffer(&output, RT_TRUE);
+    RT_TRACE_END("filter", "acquire frame");
+    rt_node_stat_wait_output(&mNodeStat, RtTime::getNowTimeUs() - waitUs);
+    if ((RT_OK != err) || (RT_NULL == output)) {
+        input->release();
+        rt_node_stat_drop(&mNodeStat);
+        return RT_ERR_UNKNOWN;
+    }
+
+    RT_TRACE_SCOPE("filter", "filter frame");
+    INT64 beginUs = RtTime::getNowTimeUs();
+    err = prepareFrame(input, output);
+    if (RT_OK == err) {
+        {
+            RtMutex::RtAutolock autoLock(mLockSlice);
+            mSliceCount = (mFrame->mDstH + mFrame->mSliceRows - 1) / mFrame->mSliceRows;
+            mSliceNext  = 0;
+            mSliceDone  = 0;
+            mSliceError = RT_OK;
+            mSliceRound++;
+            if (mSliceCount > 1) {
+                mCondSlice->broadcast();
+            }
+        }
+        takeSlices();
+
+        RtMutex::RtAutolock autoLock(mLockSlice);
+        while (mSliceDone < mSliceCount) {
+            mCondDone->wait(mLockSlice);
+        }
+        err = mSliceError;
+        if (RT_OK != err) {
+            RT_LOGE("fail to filter frame, err: %d", err);
+            output->setRange(0, 0);
+        }
+        rt_node_stat_process(&mNodeStat, RtTime::getNowTimeUs() - beginUs);
+    }
+    input->release();
+
+    RtMutex::RtAutolock autoLock(mLockOutputQ);
+    deque_push(mOutputQ, reinterpret_cast<void *>(output));
+    return err;
+}
+
+RT_RET RTFilterVideoScale::runTask() {
+    while (THREAD_LOOP == mProcThread->getState()) {
+        if (!mStarted) {
+            RtTime::sleepMs(5);
+            continue;
+        }
+        if (RT_ERR_LIST_EMPTY == onFilter()) {
+            INT64 waitUs = RtTime::getNowTimeUs();
+            RtTime::sleepMs(2);
+            rt_node_stat_wait_input(&mNodeStat, RtTime::getNowTimeUs() - waitUs);
+        }
+    }
+
+    RT_LOGD("exit filter run task, frames: %lld %lldus per frame", mNodeStat.mProcCount,
+             mNodeStat.mProcUs / RT_MAX(mNodeStat.mProcCount, 1ull));
+    return RT_OK;
+}
+
+RT_RET RTFilterVideoScale::onStart() {
+    mFramePool->start();
+    mStarted = RT_TRUE;
+    return RT_OK;
+}
+
+RT_RET RTFilterVideoScale::onPause() {
+    RT_LOGD("call, pause");
+    mStarted = RT_FALSE;
+    return RT_OK;
+}
+
+RT_RET RTFilterVideoScale::onStop() {
+    mStarted = RT_FALSE;
+    mFramePool->stop();
+    mProcThread->requestInterruption();
+    mProcThread->join();
+    stopWorkers();
+    onFlush();
+    return RT_OK;
+}
+
+RT_RET RTFilterVideoScale::onReset() {
+    RT_LOGD("call, reset and flush in filter");
+    return onFlush();
+}
+
+RT_RET RTFilterVideoScale::onPrepare() {
+    RT_LOGD("call, prepare");
+    mWorkersRun = RT_TRUE;
+    for (INT32 idx = 0; idx < mWorkerCount; idx++) {
+        mWorkers[idx]->setSchedClass(mThreadClass);
+        mWorkers[idx]->start();
+    }
+    mProcThread->setSchedClass(mThreadClass);
+    mProcThread->start();
+    return RT_OK;
+}
+
+RT_RET RTFilterVideoScale::onFlush() {
+    RT_LOGD("call, flush");
+    while (deque_size(mInputQ) > 0) {
+        RtMutex::RtAutolock autoLock(mLockInputQ);
+        RT_DequeEntry entry = deque_pop(mInputQ);
+        if (entry.data) {
+            reinterpret_cast<RTMediaBuffer *>(entry.data)->release();
+            rt_node_stat_drop(&mNodeStat);
+        }
+    }
+    while (deque_size(mOutputQ) > 0) {
+        RtMutex::RtAutolock autoLock(mLockOutputQ);
+        RT_DequeEntry entry = deque_pop(mOutputQ);
+        if (entry.data) {
+            reinterpret_cast<RTMediaBuffer *>(entry.data)->release();
+            rt_node_stat_drop(&mNodeStat);
+        }
+    }
+    return RT_OK;
+}
+
+static RTNode* createFilterVideoScale() {
+    return new RTFilterVideoScale();
+}
+
+struct RTNodeStub rt_filter_video_scale {
+    .mCreateNode     = createFilterVideoScale,
+    .mNodeType       = RT_NODE_TYPE_FILTER,
+    .mUsePool        = RT_FALSE,
+    .mNodeName       = "rt_filter_video_scale",
+    .mNodeRole       = "video",
+    .mNodeVersion    = "v1.0",
+    .mThreadClass    = RT_THREAD_CLASS_DECODE,
+};
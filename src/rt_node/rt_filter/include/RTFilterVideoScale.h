@@ -0,0 +1,107 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * module: video filter of scale and format conversion, frames are cut
+ *         into slices of rows, which are filtered by threads together.
+ */
+
+#ifndef SRC_RT_NODE_RT_FILTER_INCLUDE_RTFILTERVIDEOSCALE_H_
+#define SRC_RT_NODE_RT_FILTER_INCLUDE_RTFILTERVIDEOSCALE_H_
+
+#include "RTNodeFilter.h" // NOLINT
+#include "rt_header.h" // NOLINT
+#include "rt_thread.h" // NOLINT
+#include "RTMediaBuffer.h" // NOLINT
+#include "rt_dequeue.h" // NOLINT
+#include "rt_mutex.h" // NOLINT
+
+#define FILTER_MAX_THREADS      8
+
+struct RTFilterFrame;
+class RTFilterVideoScale : public RTNodeFilter {
+ public:
+    RTFilterVideoScale();
+    virtual ~RTFilterVideoScale();
+    RT_RET runTask();
+    RT_RET runWorker();
+
+ public:
+    // override RTNode public methods
+    virtual RT_RET init(RtMetaData *metadata);
+    virtual RT_RET release();
+
+    virtual RT_RET pullBuffer(RTMediaBuffer **frame);
+    virtual RT_RET pushBuffer(RTMediaBuffer*  frame);
+
+    virtual RT_RET runCmd(RT_NODE_CMD cmd, RtMetaData *metadata);
+    virtual RT_RET setEventLooper(RTMsgLooper* eventLooper);
+
+    virtual RtMetaData* queryFormat(RTPortType port);
+    virtual RTNodeStub* queryStub();
+
+ protected:
+    // override RTNode protected method
+    virtual RT_RET onStart();
+    virtual RT_RET onPause();
+    virtual RT_RET onStop();
+    virtual RT_RET onReset();
+    virtual RT_RET onFlush();
+    virtual RT_RET onPrepare();
+
+    // override RTNodeFilter method, one frame is filtered
+    virtual RT_RET onFilter();
+
+ private:
+    RT_RET prepareFrame(RTMediaBuffer *input, RTMediaBuffer *output);
+    RT_RET filterSlice(INT32 index);
+    void   takeSlices();
+    void   stopWorkers();
+
+ private:
+    RtThread            *mProcThread;
+    RtThread            *mWorkers[FILTER_MAX_THREADS];
+    INT32                mWorkerCount;
+    RT_BOOL              mWorkersRun;
+
+    // slices of frame are taken by workers and proc thread
+    RTFilterFrame       *mFrame;
+    RtMutex             *mLockSlice;
+    RtCondition         *mCondSlice;
+    RtCondition         *mCondDone;
+    UINT32               mSliceRound;
+    INT32                mSliceCount;
+    INT32                mSliceNext;
+    INT32                mSliceDone;
+    RT_RET               mSliceError;
+
+    // frames of input belong to upstream, frames of output are filter's
+    RTMediaBufferPool   *mFramePool;
+    rt_deque            *mInputQ;
+    rt_deque            *mOutputQ;
+    RtMutex             *mLockInputQ;
+    RtMutex             *mLockOutputQ;
+
+    RTMsgLooper         *mEventLooper;
+    RtMetaData          *mMetaInput;
+    RtMetaData          *mMetaOutput;
+
+    RT_BOOL              mStarted;
+    UINT32               mCountPush;
+    UINT32               mCountPull;
+};
+
+extern struct RTNodeStub rt_filter_video_scale;
+
+#endif  // SRC_RT_NODE_RT_FILTER_INCLUDE_RTFILTERVIDEOSCALE_H_
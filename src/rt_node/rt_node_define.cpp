@@ -56,6 +56,8 @@ static const rt_enum_name g_node_cmd_names[] = {
     { RT_NODE_CMD_PAUSE,       "PAUSE"},
     { RT_NODE_CMD_NAVIGATION,  "NAVIGATION" },
     { RT_NODE_CMD_DRAIN,       "DRAIN" },
+    { RT_NODE_CMD_TRICKPLAY,   "TRICKPLAY" },
+    { RT_NODE_CMD_SELECT_TRACK, "SELECT_TRACK" },
 
     // QOS and debug cmd
     { RT_NODE_CMD_LATENCY,    "LATENCY" },
@@ -208,6 +208,10 @@ RT_RET RTNodeSinkAWindow::runCmd(RT_NODE_CMD cmd, RtMetaData *metadata) {
     case RT_NODE_CMD_PAUSE:
         err = this->onPause();
         break;
+    case RT_NODE_CMD_STAT:
+    case RT_NODE_CMD_LATENCY:
+        err = rt_node_stat_query(&mNodeStat, cmd, metadata);
+        break;
     default:
         break;
     }
@@ -187,6 +187,10 @@ RT_RET RTNodeSinkGLES::runCmd(RT_NODE_CMD cmd, RtMetaData *metaData) {
     case RT_NODE_CMD_PAUSE:
         err = this->onPause();
         break;
+    case RT_NODE_CMD_STAT:
+    case RT_NODE_CMD_LATENCY:
+        err = rt_node_stat_query(&mNodeStat, cmd, metaData);
+        break;
     default:
         break;
     }
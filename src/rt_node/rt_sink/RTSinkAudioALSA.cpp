@@ -34,11 +34,11 @@
 #include "RTMediaMetaKeys.h"   // NOLINT
 #include "RTMediaBuffer.h"     // NOLINT
 #include "rt_message.h"        // NOLINT
+#include "rt_trace.h"          // NOLINT
 
-void* sink_audio_alsa_loop(void* ptrNode) {
+static INT64 sink_audio_alsa_step(void* ptrNode) {
     RTSinkAudioALSA* audiosink = reinterpret_cast<RTSinkAudioALSA*>(ptrNode);
-    audiosink->runTask();
-    return RT_NULL;
+    return audiosink->runStep();
 }
 
 RTSinkAudioALSA::RTSinkAudioALSA()
@@ -56,9 +56,10 @@ RTSinkAudioALSA::RTSinkAudioALSA()
           mChannels(2),
           mDataSize(4096),
           mPlayStatus(PLAY_STOPPED),
-          mCurPosition(0) {
-    mThread = new RtThread(sink_audio_alsa_loop, reinterpret_cast<void*>(this));
-    mThread->setName("SinkAlsa");
+          mCurPosition(0),
+          mInput(RT_NULL) {
+    mJob = new RtJob(sink_audio_alsa_step, reinterpret_cast<void*>(this));
+    mJob->setName("SinkAlsa");
     mDeque = deque_create(10);
     RT_ASSERT(RT_NULL != mDeque);
     mVolManager = new ALSAVolumeManager();
@@ -111,7 +112,7 @@ RT_RET RTSinkAudioALSA::release() {
         deque_destory(&mDeque);
     }
 
-    rt_safe_delete(mThread);
+    rt_safe_delete(mJob);
     rt_safe_delete(mVolManager);
     rt_safe_delete(mLockBuffer);
     mCurPosition = 0;
@@ -140,6 +141,10 @@ RT_RET RTSinkAudioALSA::pushBuffer(RTMediaBuffer* mediaBuf) {
     RtMutex::RtAutolock autoLock(mLockBuffer);
     if (RT_NULL != mediaBuf) {
         err = deque_push_tail(mDeque, mediaBuf);
+        rt_node_stat_queue(&mNodeStat, deque_size(mDeque));
+    }
+    if (RT_NULL != mJob) {
+        mJob->wake();
     }
 
     return err;
@@ -150,6 +155,8 @@ RT_RET RTSinkAudioALSA::runCmd(RT_NODE_CMD cmd, RtMetaData *metaData) {
 
     switch (cmd) {
     case RT_NODE_CMD_INIT:
+    case RT_NODE_CMD_REINIT:
+        // sound card is kept open, init() only reconfigures params
         err = this->init(metaData);
         break;
     case RT_NODE_CMD_START:
@@ -167,6 +174,10 @@ RT_RET RTSinkAudioALSA::runCmd(RT_NODE_CMD cmd, RtMetaData *metaData) {
     case RT_NODE_CMD_RESET:
         err = this->onReset();
         break;
+    case RT_NODE_CMD_STAT:
+    case RT_NODE_CMD_LATENCY:
+        err = rt_node_stat_query(&mNodeStat, cmd, metaData);
+        break;
     default:
         RT_LOGE("unkown command: %d", cmd);
         err = RT_ERR_UNKNOWN;
@@ -238,8 +249,10 @@ RT_BOOL RTSinkAudioALSA::getMute() {
 RT_RET RTSinkAudioALSA::onStart() {
     RT_RET err = RT_OK;
     RT_LOGD("Audio Sink Thread... begin");
-    if (THREAD_LOOP != mThread->getState()) {
-        mThread->start();
+    if (!mJob->isRunning()) {
+        mJob->setShared(mUseExecutor);
+        mJob->setSchedClass(mThreadClass);
+        mJob->start();
     }
     mPlayStatus = PLAY_START;
     return err;
@@ -248,9 +261,12 @@ RT_RET RTSinkAudioALSA::onStart() {
 RT_RET RTSinkAudioALSA::onStop() {
     RT_RET err = RT_OK;
     mPlayStatus = PLAY_STOPPED;
-    if (mThread) {
-        mThread->requestInterruption();
-        mThread->join();
+    if (mJob) {
+        mJob->stop();
+    }
+    if (mInput) {
+        mInput->release();
+        mInput = RT_NULL;
     }
     onFlush();
     return err;
@@ -326,73 +342,82 @@ RT_RET RTSinkAudioALSA::closeSoundCard() {
     }
 }
 
-RT_VOID RTSinkAudioALSA::usleepData(INT32 samplerate, INT32 channels, INT32 bytes) {
+INT64 RTSinkAudioALSA::durationUs(INT32 samplerate, INT32 channels, INT32 bytes) {
     // @review pay special attention to the scope of the data type
     //         INT32_MAX =((int32_t)2147483647); UINT32_MAX =((uint32_t)4294967295)
-    UINT64 duration = (bytes * 1000000llu) / (2*channels) / samplerate;
-    RtTime::sleepUs(duration);
+    return (INT64)((bytes * 1000000llu) / (2*channels) / samplerate);
 }
 
-RT_RET RTSinkAudioALSA::runTask() {
-    RTMediaBuffer *input = NULL;
-    int ret;
-    while (THREAD_LOOP == mThread->getState()) {
-        RT_RET err = RT_OK;
-        if (mPlayStatus == PLAY_PAUSED) {
-            // RT_LOGD("%s,%d,now runtask is pause",__FUNCTION__,__LINE__);
-            usleepData(mSampleRate, mChannels, mDataSize);
-            mCurPosition = 0;
-            continue;
-        }
-        if (!input) {
-            RtMutex::RtAutolock autoLock(mLockBuffer);
-            pullBuffer(&input);
-        }
+RT_VOID RTSinkAudioALSA::usleepData(INT32 samplerate, INT32 channels, INT32 bytes) {
+    RtTime::sleepUs(durationUs(samplerate, channels, bytes));
+}
+
+/*
+ * one period of sink, returns the time to wait before next step. step on
+ * executor never blocks in sound card, it waits for room of buffer instead.
+ */
+INT64 RTSinkAudioALSA::runStep() {
+    if (mPlayStatus == PLAY_PAUSED) {
+        mCurPosition = 0;
+        return durationUs(mSampleRate, mChannels, mDataSize);
+    }
+    if (!mInput) {
+        RtMutex::RtAutolock autoLock(mLockBuffer);
+        pullBuffer(&mInput);
+    }
 
-        if (!input) {
-            if (mCurPosition != 0) {
-                UINT64 now = RtTime::getNowTimeMs();
-                if (now - mCurPosition > 2000) {
-                    if (RT_NULL != mEventLooper) {
-                        RT_LOGD("already 2s no data, post EOS message");
-                        mCurPosition = 0;
-                        RTMessage* eosMsg = new RTMessage(RT_MEDIA_PLAYBACK_COMPLETE, nullptr, nullptr);
-                        mEventLooper->post(eosMsg);
-                    }
+    if (!mInput) {
+        if (mCurPosition != 0) {
+            UINT64 now = RtTime::getNowTimeMs();
+            if (now - mCurPosition > 2000) {
+                if (RT_NULL != mEventLooper) {
+                    RT_LOGD("already 2s no data, post EOS message");
+                    mCurPosition = 0;
+                    RTMessage* eosMsg = new RTMessage(RT_MEDIA_PLAYBACK_COMPLETE, nullptr, nullptr);
+                    mEventLooper->post(eosMsg);
                 }
             }
-            RtTime::sleepMs(5);
-            continue;
         }
+        rt_node_stat_wait_input(&mNodeStat, 5000);
+        return 5000;
+    }
 
-        if (mALSASinkCtx && input->getLength()) {
-            ret = alsa_snd_write_data(mALSASinkCtx, reinterpret_cast<void *>(input->getData()), input->getLength());
-            mCurPosition = RtTime::getNowTimeMs();
-
-            if (ret != input->getLength()) {
-                usleepData(mSampleRate, mChannels, mDataSize);
+    INT64 delayUs = 0;
+    if (mALSASinkCtx && mInput->getLength()) {
+        if (mJob->isShared()) {
+            delayUs = alsa_snd_wait_us(mALSASinkCtx, mInput->getLength());
+            if (delayUs > 0) {
+                return delayUs;
             }
         }
-
-        INT32 eos = 0;
-        input->getMetaData()->findInt32(kKeyFrameEOS, &eos);
-
-        // @review: return buffer to media-buffer-pool
-        if (RT_NULL != input) {
-            input->release();
-            input = NULL;
+        // writing is blocked by sound card, it is the latency of sink
+        INT64 procUs = RtTime::getNowTimeUs();
+        RT_TRACE_BEGIN("sink", "write pcm");
+        INT32 ret = alsa_snd_write_data(mALSASinkCtx, reinterpret_cast<void *>(mInput->getData()),
+                                        mInput->getLength());
+        RT_TRACE_END("sink", "write pcm");
+        rt_node_stat_process(&mNodeStat, RtTime::getNowTimeUs() - procUs);
+        mCurPosition = RtTime::getNowTimeMs();
+
+        if (ret != (INT32)mInput->getLength()) {
+            delayUs = durationUs(mSampleRate, mChannels, mDataSize);
         }
+    }
 
-        if (eos && (RT_NULL != mEventLooper)) {
-            RT_LOGD("render EOS Flag, post EOS message");
-            mCurPosition = 0;
-            RTMessage* eosMsg = new RTMessage(RT_MEDIA_PLAYBACK_COMPLETE, nullptr, nullptr);
-            mEventLooper->post(eosMsg);
-        }
+    INT32 eos = 0;
+    mInput->getMetaData()->findInt32(kKeyFrameEOS, &eos);
+
+    // @review: return buffer to media-buffer-pool
+    mInput->release();
+    mInput = NULL;
 
-        input = NULL;
+    if (eos && (RT_NULL != mEventLooper)) {
+        RT_LOGD("render EOS Flag, post EOS message");
+        mCurPosition = 0;
+        RTMessage* eosMsg = new RTMessage(RT_MEDIA_PLAYBACK_COMPLETE, nullptr, nullptr);
+        mEventLooper->post(eosMsg);
     }
-    return RT_OK;
+    return delayUs;
 }
 
 static RTNode* createSinkAudioALSA() {
@@ -406,4 +431,6 @@ struct RTNodeStub rt_sink_audio_alsa {
     .mNodeName     = "rt_sink_audio_alsa",
     .mNodeRole     = "audio",
     .mNodeVersion  = "v1.0",
+    .mThreadClass  = RT_THREAD_CLASS_AUDIO_RT,
+    .mRecyclable   = RT_TRUE,
 };
@@ -0,0 +1,224 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Module: write audio pcm data to file, used to verify pcm stream
+ *
+ */
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "RTSinkAudioFile"
+
+#ifdef DEBUG_FLAG
+#undef DEBUG_FLAG
+#endif
+#define DEBUG_FLAG 0x0
+
+#include "RTSinkAudioFile.h"   // NOLINT
+#include "rt_metadata.h"       // NOLINT
+#include "RTMediaMetaKeys.h"   // NOLINT
+#include "RTMediaBuffer.h"     // NOLINT
+#include "rt_message.h"        // NOLINT
+#include "rt_msg_looper.h"     // NOLINT
+
+RTSinkAudioFile::RTSinkAudioFile()
+        : mFile(RT_NULL),
+          mEventLooper(RT_NULL),
+          mSampleRate(48000),
+          mChannels(2),
+          mVolume(100),
+          mMuted(RT_FALSE),
+          mBytesWritten(0) {
+    mLockFile = new RtMutex();
+    RT_ASSERT(RT_NULL != mLockFile);
+}
+
+RTSinkAudioFile::~RTSinkAudioFile() {
+    release();
+    rt_safe_delete(mLockFile);
+}
+
+RT_RET RTSinkAudioFile::init(RtMetaData *metaData) {
+    RT_ASSERT(RT_NULL != metaData);
+    metaData->findInt32(kKeyACodecSampleRate, &mSampleRate);
+    metaData->findInt32(kKeyACodecChannels, &mChannels);
+
+    // the sink is reused by next source, keep the opened file.
+    RtMutex::RtAutolock autoLock(mLockFile);
+    if (RT_NULL == mFile) {
+        const char* uri = RT_NULL;
+        if (!metaData->findCString(kKeySinkUri, &uri) || (RT_NULL == uri)) {
+            uri = SINK_AUDIO_FILE_DEFAULT;
+        }
+        mFile = fopen(uri, "wb");
+        if (RT_NULL == mFile) {
+            RT_LOGE("fail to open %s", uri);
+            return RT_ERR_OPEN_FILE;
+        }
+        RT_LOGD("done, write pcm(%dHz, %dch) to %s", mSampleRate, mChannels, uri);
+    }
+    return RT_OK;
+}
+
+RT_RET RTSinkAudioFile::release() {
+    RtMutex::RtAutolock autoLock(mLockFile);
+    if (RT_NULL != mFile) {
+        RT_LOGD("done, %lld bytes written", mBytesWritten);
+        fclose(mFile);
+        mFile = RT_NULL;
+    }
+    return RT_OK;
+}
+
+RT_RET RTSinkAudioFile::pullBuffer(RTMediaBuffer** mediaBuf) {
+    *mediaBuf = RT_NULL;
+    return RT_ERR_UNIMPLIMENTED;
+}
+
+/*
+ * pcm is written at once, so that file sink consumes as fast as decoder.
+ */
+RT_RET RTSinkAudioFile::pushBuffer(RTMediaBuffer* mediaBuf) {
+    if (RT_NULL == mediaBuf) {
+        return RT_ERR_NULL_PTR;
+    }
+
+    INT32 eos = 0;
+    mediaBuf->getMetaData()->findInt32(kKeyFrameEOS, &eos);
+    {
+        RtMutex::RtAutolock autoLock(mLockFile);
+        if ((RT_NULL != mFile) && (mediaBuf->getLength() > 0)) {
+            fwrite(mediaBuf->getData(), 1, mediaBuf->getLength(), mFile);
+            mBytesWritten += mediaBuf->getLength();
+        }
+        if (eos && (RT_NULL != mFile)) {
+            fflush(mFile);
+        }
+    }
+
+    // @review: return buffer to media-buffer-pool
+    mediaBuf->release();
+
+    if (eos && (RT_NULL != mEventLooper)) {
+        RT_LOGD("render EOS Flag, post EOS message");
+        RTMessage* eosMsg = new RTMessage(RT_MEDIA_PLAYBACK_COMPLETE, nullptr, nullptr);
+        mEventLooper->post(eosMsg);
+    }
+    return RT_OK;
+}
+
+RT_RET RTSinkAudioFile::runCmd(RT_NODE_CMD cmd, RtMetaData *metaData) {
+    RT_RET err = RT_OK;
+
+    switch (cmd) {
+    case RT_NODE_CMD_INIT:
+        err = this->init(metaData);
+        break;
+    case RT_NODE_CMD_START:
+        err = this->onStart();
+        break;
+    case RT_NODE_CMD_STOP:
+        err = this->onStop();
+        break;
+    case RT_NODE_CMD_FLUSH:
+        err = this->onFlush();
+        break;
+    case RT_NODE_CMD_PAUSE:
+        err = this->onPause();
+        break;
+    case RT_NODE_CMD_RESET:
+        err = this->onReset();
+        break;
+    case RT_NODE_CMD_STAT:
+    case RT_NODE_CMD_LATENCY:
+        err = rt_node_stat_query(&mNodeStat, cmd, metaData);
+        break;
+    default:
+        RT_LOGE("unkown command: %d", cmd);
+        err = RT_ERR_UNKNOWN;
+        break;
+    }
+
+    return err;
+}
+
+RT_RET RTSinkAudioFile::setEventLooper(RTMsgLooper* eventLooper) {
+    mEventLooper = eventLooper;
+    return RT_OK;
+}
+
+RtMetaData* RTSinkAudioFile::queryFormat(RTPortType port) {
+    return RT_NULL;
+}
+
+RTNodeStub* RTSinkAudioFile::queryStub() {
+    return &rt_sink_audio_file;
+}
+
+RT_RET RTSinkAudioFile::setVolume(int volume) {
+    mVolume = volume;
+    return RT_OK;
+}
+
+INT32 RTSinkAudioFile::getVolume() {
+    return mVolume;
+}
+
+RT_RET RTSinkAudioFile::setMute(RT_BOOL muted) {
+    mMuted = muted;
+    return RT_OK;
+}
+
+RT_BOOL RTSinkAudioFile::getMute() {
+    return mMuted;
+}
+
+RT_RET RTSinkAudioFile::onStart() {
+    return RT_OK;
+}
+
+RT_RET RTSinkAudioFile::onStop() {
+    RtMutex::RtAutolock autoLock(mLockFile);
+    if (RT_NULL != mFile) {
+        fflush(mFile);
+    }
+    return RT_OK;
+}
+
+RT_RET RTSinkAudioFile::onPause() {
+    return RT_OK;
+}
+
+RT_RET RTSinkAudioFile::onFlush() {
+    return RT_OK;
+}
+
+RT_RET RTSinkAudioFile::onReset() {
+    return RT_OK;
+}
+
+static RTNode* createSinkAudioFile() {
+    return new RTSinkAudioFile();
+}
+
+struct RTNodeStub rt_sink_audio_file {
+    .mCreateNode   = createSinkAudioFile,
+    .mNodeType     = RT_NODE_TYPE_SINK,
+    .mUsePool      = RT_FALSE,
+    .mNodeName     = "rt_sink_audio_file",
+    .mNodeRole     = "audio",
+    .mNodeVersion  = "v1.0",
+};
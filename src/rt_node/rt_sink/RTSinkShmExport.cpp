@@ -0,0 +1,244 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Module: publish decoded frames or pcm to ring of shared memory
+ */
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "RTSinkShmExport"
+
+#ifdef DEBUG_FLAG
+#undef DEBUG_FLAG
+#endif
+#define DEBUG_FLAG 0x0
+
+#include "RTSinkShmExport.h"   // NOLINT
+#include "rt_metadata.h"       // NOLINT
+#include "RTMediaMetaKeys.h"   // NOLINT
+#include "RTMediaBuffer.h"     // NOLINT
+#include "rt_message.h"        // NOLINT
+#include "rt_msg_looper.h"     // NOLINT
+
+RTSinkShmExport::RTSinkShmExport()
+        : mRing(RT_NULL),
+          mEventLooper(RT_NULL),
+          mVolume(100),
+          mMuted(RT_FALSE),
+          mFramesWritten(0),
+          mFramesDropped(0) {
+    rt_memset(&mFormat, 0, sizeof(mFormat));
+    mLockRing = new RtMutex();
+    RT_ASSERT(RT_NULL != mLockRing);
+}
+
+RTSinkShmExport::~RTSinkShmExport() {
+    release();
+    rt_safe_delete(mLockRing);
+}
+
+RT_RET RTSinkShmExport::init(RtMetaData *metaData) {
+    RT_ASSERT(RT_NULL != metaData);
+    RtShmFormat format;
+    rt_memset(&format, 0, sizeof(format));
+    metaData->findInt32(kKeyCodecFormat, &format.mFormat);
+    metaData->findInt32(kKeyVCodecWidth, &format.mWidth);
+    metaData->findInt32(kKeyVCodecHeight, &format.mHeight);
+    metaData->findInt32(kKeyACodecSampleRate, &format.mSampleRate);
+    metaData->findInt32(kKeyACodecChannels, &format.mChannels);
+    if ((format.mWidth > 0) && (format.mHeight > 0)) {
+        format.mType = RT_SHM_FORMAT_VIDEO;
+    } else if (format.mSampleRate > 0) {
+        format.mType = RT_SHM_FORMAT_AUDIO;
+    }
+
+    // the sink is reused by next source, keep the ring and readers of it.
+    RtMutex::RtAutolock autoLock(mLockRing);
+    mFormat = format;
+    if (RT_NULL == mRing) {
+        const char* name = RT_NULL;
+        INT32 slots    = SINK_SHM_DEFAULT_SLOTS;
+        INT32 slotSize = (RT_SHM_FORMAT_VIDEO == format.mType)
+                          ? format.mWidth * format.mHeight * 3 / 2 : SINK_SHM_AUDIO_SLOT_SIZE;
+        if (!metaData->findCString(kKeySinkUri, &name) || (RT_NULL == name)) {
+            name = SINK_SHM_DEFAULT_NAME;
+        }
+        metaData->findInt32(kKeySinkShmSlots, &slots);
+        metaData->findInt32(kKeySinkShmSlotSize, &slotSize);
+        mRing = rt_shm_ring_create(name, slots, slotSize);
+        if (RT_NULL == mRing) {
+            RT_LOGE("fail to create ring %s", name);
+            return RT_ERR_INIT;
+        }
+        RT_LOGD("done, export %d frames of %d bytes to %s", slots, slotSize, name);
+    }
+    return RT_OK;
+}
+
+RT_RET RTSinkShmExport::release() {
+    RtMutex::RtAutolock autoLock(mLockRing);
+    if (RT_NULL != mRing) {
+        RT_LOGD("done, %lld frames written, %lld dropped", mFramesWritten, mFramesDropped);
+        rt_shm_ring_close(&mRing);
+    }
+    return RT_OK;
+}
+
+RT_RET RTSinkShmExport::pullBuffer(RTMediaBuffer** mediaBuf) {
+    *mediaBuf = RT_NULL;
+    return RT_ERR_UNIMPLIMENTED;
+}
+
+/*
+ * frame is copied to ring at once and buffer goes back to its pool, ring
+ * never waits for readers, so the sink consumes as fast as decoder.
+ */
+RT_RET RTSinkShmExport::pushBuffer(RTMediaBuffer* mediaBuf) {
+    if (RT_NULL == mediaBuf) {
+        return RT_ERR_NULL_PTR;
+    }
+
+    RtShmFrame frame;
+    INT32      eos = 0;
+    rt_memset(&frame, 0, sizeof(frame));
+    RtMetaData *meta = mediaBuf->getMetaData();
+    meta->findInt32(kKeyFrameEOS, &eos);
+    meta->findInt64(kKeyFramePts, &frame.mPts);
+    frame.mFlags = eos ? RT_SHM_FRAME_FLAG_EOS : 0;
+    {
+        RtMutex::RtAutolock autoLock(mLockRing);
+        frame.mFormat = mFormat;
+        meta->findInt32(kKeyFrameW, &frame.mFormat.mWidth);
+        meta->findInt32(kKeyFrameH, &frame.mFormat.mHeight);
+        if ((RT_NULL != mRing) && ((mediaBuf->getLength() > 0) || eos)) {
+            const UINT8 *data = reinterpret_cast<const UINT8 *>(mediaBuf->getData()) + mediaBuf->getOffset();
+            if (RT_OK == rt_shm_ring_write(mRing, data, mediaBuf->getLength(), &frame)) {
+                mFramesWritten++;
+            } else if (0 == mFramesDropped++) {
+                RT_LOGE("frame of %d bytes is bigger than slot, it is dropped", mediaBuf->getLength());
+            }
+        }
+    }
+
+    // @review: return buffer to media-buffer-pool
+    mediaBuf->release();
+
+    if (eos && (RT_NULL != mEventLooper)) {
+        RT_LOGD("render EOS Flag, post EOS message");
+        RTMessage* eosMsg = new RTMessage(RT_MEDIA_PLAYBACK_COMPLETE, nullptr, nullptr);
+        mEventLooper->post(eosMsg);
+    }
+    return RT_OK;
+}
+
+RT_RET RTSinkShmExport::runCmd(RT_NODE_CMD cmd, RtMetaData *metaData) {
+    RT_RET err = RT_OK;
+
+    switch (cmd) {
+    case RT_NODE_CMD_INIT:
+        err = this->init(metaData);
+        break;
+    case RT_NODE_CMD_START:
+        err = this->onStart();
+        break;
+    case RT_NODE_CMD_STOP:
+        err = this->onStop();
+        break;
+    case RT_NODE_CMD_FLUSH:
+        err = this->onFlush();
+        break;
+    case RT_NODE_CMD_PAUSE:
+        err = this->onPause();
+        break;
+    case RT_NODE_CMD_RESET:
+        err = this->onReset();
+        break;
+    case RT_NODE_CMD_STAT:
+    case RT_NODE_CMD_LATENCY:
+        err = rt_node_stat_query(&mNodeStat, cmd, metaData);
+        break;
+    default:
+        RT_LOGE("unkown command: %d", cmd);
+        err = RT_ERR_UNKNOWN;
+        break;
+    }
+
+    return err;
+}
+
+RT_RET RTSinkShmExport::setEventLooper(RTMsgLooper* eventLooper) {
+    mEventLooper = eventLooper;
+    return RT_OK;
+}
+
+RtMetaData* RTSinkShmExport::queryFormat(RTPortType port) {
+    return RT_NULL;
+}
+
+RTNodeStub* RTSinkShmExport::queryStub() {
+    return &rt_sink_shm_export;
+}
+
+RT_RET RTSinkShmExport::setVolume(int volume) {
+    mVolume = volume;
+    return RT_OK;
+}
+
+INT32 RTSinkShmExport::getVolume() {
+    return mVolume;
+}
+
+RT_RET RTSinkShmExport::setMute(RT_BOOL muted) {
+    mMuted = muted;
+    return RT_OK;
+}
+
+RT_BOOL RTSinkShmExport::getMute() {
+    return mMuted;
+}
+
+RT_RET RTSinkShmExport::onStart() {
+    return RT_OK;
+}
+
+RT_RET RTSinkShmExport::onStop() {
+    return RT_OK;
+}
+
+RT_RET RTSinkShmExport::onPause() {
+    return RT_OK;
+}
+
+RT_RET RTSinkShmExport::onFlush() {
+    return RT_OK;
+}
+
+RT_RET RTSinkShmExport::onReset() {
+    return RT_OK;
+}
+
+static RTNode* createSinkShmExport() {
+    return new RTSinkShmExport();
+}
+
+struct RTNodeStub rt_sink_shm_export {
+    .mCreateNode   = createSinkShmExport,
+    .mNodeType     = RT_NODE_TYPE_SINK,
+    .mUsePool      = RT_FALSE,
+    .mNodeName     = "rt_sink_shm_export",
+    .mNodeRole     = "any",
+    .mNodeVersion  = "v1.0",
+};
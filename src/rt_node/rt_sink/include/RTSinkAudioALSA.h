@@ -28,6 +28,7 @@
 #endif
 #include "RTObjectPool.h" // NOLINT
 #include "rt_thread.h" // NOLINT
+#include "rt_executor.h" // NOLINT
 #include "rt_dequeue.h" // NOLINT
 #include "ALSAVolumeManager.h"
 
@@ -35,7 +36,7 @@ class RTSinkAudioALSA : public RTNodeAudioSink {
  public:
     RTSinkAudioALSA();
     virtual ~RTSinkAudioALSA();
-    RT_RET runTask();
+    INT64  runStep();
     // override RTNode methods
     virtual RT_RET init(RtMetaData *metaData);
     virtual RT_RET release();
@@ -68,10 +69,11 @@ class RTSinkAudioALSA : public RTNodeAudioSink {
     RT_RET setAlsaSoundParams(RtMetaData *metaData);
     RT_RET closeSoundCard();
     RT_VOID usleepData(INT32 samplerate, INT32 channels, INT32 bytes);
+    INT64   durationUs(INT32 samplerate, INT32 channels, INT32 bytes);
 
     RT_Deque          *mDeque;
     ALSASinkContext   *mALSASinkCtx;
-    RtThread          *mThread;
+    RtJob             *mJob;
     RtMutex           *mLockBuffer;
     RT_Deque          *mQueueBuffer;
     RTObjectPool      *mPoolBuffer;
@@ -87,6 +89,7 @@ class RTSinkAudioALSA : public RTNodeAudioSink {
     INT32              mChannels;
     INT32              mDataSize;
     UINT64             mCurPosition;
+    RTMediaBuffer     *mInput;
 
     typedef enum _audio_play_status {
         PLAY_STOPPED = 0,  ///  < Playback stopped or has not started yet.
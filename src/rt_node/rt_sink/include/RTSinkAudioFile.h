@@ -0,0 +1,74 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Module: write audio pcm data to file, used to verify pcm stream
+ */
+
+#ifndef SRC_RT_NODE_RT_SINK_INCLUDE_RTSINKAUDIOFILE_H_
+#define SRC_RT_NODE_RT_SINK_INCLUDE_RTSINKAUDIOFILE_H_
+
+#include <stdio.h>
+
+#include "RTNodeAudioSink.h" // NOLINT
+#include "rt_header.h"       // NOLINT
+
+#define SINK_AUDIO_FILE_DEFAULT "rt_sink_audio.pcm"
+
+class RTSinkAudioFile : public RTNodeAudioSink {
+ public:
+    RTSinkAudioFile();
+    virtual ~RTSinkAudioFile();
+
+    // override RTNode methods
+    virtual RT_RET init(RtMetaData *metaData);
+    virtual RT_RET release();
+    virtual RT_RET pullBuffer(RTMediaBuffer** mediaBuf);
+    virtual RT_RET pushBuffer(RTMediaBuffer*  mediaBuf);
+
+    virtual RT_RET setEventLooper(RTMsgLooper* eventLooper);
+    virtual RT_RET runCmd(RT_NODE_CMD cmd, RtMetaData *metaData);
+
+    virtual RtMetaData* queryFormat(RTPortType port);
+    virtual RTNodeStub* queryStub();
+
+ public:
+    // override RTNodeAudioSink methods
+    virtual RT_RET   setVolume(int volume);
+    virtual INT32    getVolume();
+    virtual RT_BOOL  getMute();
+    virtual RT_RET   setMute(RT_BOOL muted);
+
+ protected:
+    // override RTNode methods
+    virtual RT_RET onStart();
+    virtual RT_RET onStop();
+    virtual RT_RET onPause();
+    virtual RT_RET onFlush();
+    virtual RT_RET onReset();
+
+ private:
+    FILE              *mFile;
+    RtMutex           *mLockFile;
+    RTMsgLooper       *mEventLooper;
+    INT32              mSampleRate;
+    INT32              mChannels;
+    INT32              mVolume;
+    RT_BOOL            mMuted;
+    UINT64             mBytesWritten;
+};
+
+extern struct RTNodeStub rt_sink_audio_file;
+
+#endif  // SRC_RT_NODE_RT_SINK_INCLUDE_RTSINKAUDIOFILE_H_
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Module: publish decoded frames or pcm to ring of shared memory, which is
+ *         read by other processes with rt_shm_ring_open/read
+ */
+
+#ifndef SRC_RT_NODE_RT_SINK_INCLUDE_RTSINKSHMEXPORT_H_
+#define SRC_RT_NODE_RT_SINK_INCLUDE_RTSINKSHMEXPORT_H_
+
+#include "RTNodeAudioSink.h" // NOLINT
+#include "rt_header.h"       // NOLINT
+#include "rt_shm_ring.h"     // NOLINT
+
+#define SINK_SHM_DEFAULT_NAME       "rt_sink_shm"
+#define SINK_SHM_DEFAULT_SLOTS      8
+#define SINK_SHM_AUDIO_SLOT_SIZE    (64 * 1024)
+
+/*
+ * it is a sink of any bus line, and an audio sink so that player controls
+ * volume of it as others. the ring is kept when sink is reused by next
+ * source, and frames bigger than a slot are dropped.
+ */
+class RTSinkShmExport : public RTNodeAudioSink {
+ public:
+    RTSinkShmExport();
+    virtual ~RTSinkShmExport();
+
+    // override RTNode methods
+    virtual RT_RET init(RtMetaData *metaData);
+    virtual RT_RET release();
+    virtual RT_RET pullBuffer(RTMediaBuffer** mediaBuf);
+    virtual RT_RET pushBuffer(RTMediaBuffer*  mediaBuf);
+
+    virtual RT_RET setEventLooper(RTMsgLooper* eventLooper);
+    virtual RT_RET runCmd(RT_NODE_CMD cmd, RtMetaData *metaData);
+
+    virtual RtMetaData* queryFormat(RTPortType port);
+    virtual RTNodeStub* queryStub();
+
+ public:
+    // override RTNodeAudioSink methods
+    virtual RT_RET   setVolume(int volume);
+    virtual INT32    getVolume();
+    virtual RT_BOOL  getMute();
+    virtual RT_RET   setMute(RT_BOOL muted);
+
+ protected:
+    // override RTNode methods
+    virtual RT_RET onStart();
+    virtual RT_RET onStop();
+    virtual RT_RET onPause();
+    virtual RT_RET onFlush();
+    virtual RT_RET onReset();
+
+ private:
+    struct RtShmRing  *mRing;
+    RtMutex           *mLockRing;
+    RTMsgLooper       *mEventLooper;
+    RtShmFormat        mFormat;
+    INT32              mVolume;
+    RT_BOOL            mMuted;
+    UINT64             mFramesWritten;
+    UINT64             mFramesDropped;
+};
+
+extern struct RTNodeStub rt_sink_shm_export;
+
+#endif  // SRC_RT_NODE_RT_SINK_INCLUDE_RTSINKSHMEXPORT_H_
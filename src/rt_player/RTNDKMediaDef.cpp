@@ -106,6 +106,9 @@ RTProtocolType RTMediaUtil::getMediaProtocol(const char* uri) {
     } else if (strstr(uri, "app_tts-cache")) {
         RT_LOGD("uri is with tts protocol");
         protocol = RT_PROTOCOL_TTS;
+    } else if (!strncasecmp("push://", uri, 7)) {
+        RT_LOGD("uri is with push protocol, bytes come from writeData()");
+        protocol = RT_PROTOCOL_PUSH;
     }
     return protocol;
 }
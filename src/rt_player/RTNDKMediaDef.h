@@ -75,6 +75,12 @@ enum RTMediaInfo {
     // 9xx
     RT_INFO_TIMED_TEXT_ERROR = 900,
     RT_INFO_PLAYING_START    = 901,
+    // Rewind reaches the beginning, playback goes on at normal rate.
+    RT_INFO_TRICK_PLAY_END   = 902,
+    // First frame at target of seek is decoded, extra is latency in ms.
+    RT_INFO_SEEK_FIRST_FRAME = 903,
+    // Audio track is switched at audio clock, extra is latency in ms.
+    RT_INFO_TRACK_SWITCHED   = 904,
 };
 
 enum RTSeekType {
@@ -89,6 +95,7 @@ typedef struct _RTMediaUri {
     char   mUri[1024];
     char   mUserAgent[256];
     char   mVersion[32];
+    void  *mPushStream;     // RTMediaPushStream of push:// uri, owned by player
 } RTMediaUri;
 
 
@@ -112,6 +119,7 @@ enum RTProtocolType {
     RT_PROTOCOL_MMSH,
     RT_PROTOCOL_MMST,
     RT_PROTOCOL_TTS,
+    RT_PROTOCOL_PUSH,
 };
 
 class RTMediaUtil {
@@ -121,6 +121,29 @@ rt_status RTNDKMediaPlayer::setDataSource(const char *url, const char *headers)
     return err;
 }
 
+rt_status RTNDKMediaPlayer::setNextDataSource(const char *url, const char *headers) {
+    rt_status err = checkRuntime(mPlayerCtx, "setNextDataSource");
+    if (RTE_NO_ERROR != err) {
+        return err;
+    }
+
+    // The player may run in a multi-threaded environment
+    RtMutex::RtAutolock autoLock(mPlayerCtx->mCmdLock);
+
+    // next item is prerolled, and played without gap after current item
+    RTMediaUri setting = {0};
+    if (RT_NULL != url) {
+        rt_str_snprintf(setting.mUri, sizeof(setting.mUri), "%s", url);
+    }
+    if (NULL != headers) {
+        rt_str_snprintf(setting.mUserAgent, sizeof(setting.mUserAgent), "%s", headers);
+    }
+
+    RTMessage* msg = new RTMessage(RT_MEDIA_CMD_SET_NEXT_DATASOURCE, &setting, nullptr);
+    err = mPlayerCtx->mNodePlayer->send("setNextDataSource", msg);
+    return err;
+}
+
 rt_status RTNDKMediaPlayer::setDataSource(int fd, int64_t offset, int64_t length) {
     char uri[1024] = {0};
     // @TODO
@@ -151,7 +174,7 @@ rt_status RTNDKMediaPlayer::prepareAsync() {
     // The player may run in a multi-threaded environment
     RtMutex::RtAutolock autoLock(mPlayerCtx->mCmdLock);
 
-    RTMessage* msg = new RTMessage(RT_MEDIA_CMD_PREPARE, nullptr, nullptr);
+    RTMessage* msg = new RTMessage(RT_MEDIA_CMD_PREPARE_ASYNC, nullptr, nullptr);
     err = mPlayerCtx->mNodePlayer->post("prepareAsync", msg);
     return err;
 }
@@ -170,6 +193,34 @@ rt_status RTNDKMediaPlayer::seekTo(int64_t usec) {
     return err;
 }
 
+rt_status RTNDKMediaPlayer::setTrickRate(int32_t rate) {
+    int32_t err = initCheck();
+    if (RTE_NO_ERROR != err) {
+        return err;
+    }
+
+    // The player may run in a multi-threaded environment
+    RtMutex::RtAutolock autoLock(mPlayerCtx->mCmdLock);
+
+    RTMessage* msg = new RTMessage(RT_MEDIA_CMD_SET_TRICK_RATE, rate, 0);
+    err = mPlayerCtx->mNodePlayer->send("setTrickRate", msg);
+    return err;
+}
+
+rt_status RTNDKMediaPlayer::selectTrack(int32_t index) {
+    int32_t err = initCheck();
+    if (RTE_NO_ERROR != err) {
+        return err;
+    }
+
+    // The player may run in a multi-threaded environment
+    RtMutex::RtAutolock autoLock(mPlayerCtx->mCmdLock);
+
+    RTMessage* msg = new RTMessage(RT_MEDIA_CMD_SELECT_TRACK, index, 0);
+    err = mPlayerCtx->mNodePlayer->send("selectTrack", msg);
+    return err;
+}
+
 rt_status RTNDKMediaPlayer::start() {
     int32_t err = initCheck();
     if (RTE_NO_ERROR != err) {
@@ -255,6 +306,18 @@ rt_status RTNDKMediaPlayer::setLooping(int loop) {
     return err;
 }
 
+rt_status RTNDKMediaPlayer::setPlaybackRate(float rate) {
+    rt_status err = checkRuntime(mPlayerCtx, "setPlaybackRate");
+    if (RTE_NO_ERROR != err) {
+        return err;
+    }
+
+    if (RT_OK != mPlayerCtx->mNodePlayer->setPlaybackRate(rate)) {
+        return RTE_BAD_VALUE;
+    }
+    return err;
+}
+
 rt_status RTNDKMediaPlayer::setVideoSurfaceTexture(void* bufferProducer) {
     return RTE_UNSUPPORTED;
 }
@@ -322,6 +385,16 @@ rt_status RTNDKMediaPlayer::setAudioSink(const void* audioSink) {
     return RTE_UNSUPPORTED;
 }
 
+rt_status RTNDKMediaPlayer::setAudioSinkFile(const char* path) {
+    rt_status err = checkRuntime(mPlayerCtx, "setAudioSinkFile");
+    if (RTE_NO_ERROR != err) {
+        return err;
+    }
+
+    // pcm is written to file instead of sound card
+    return mPlayerCtx->mNodePlayer->setAudioSinkFile(path);
+}
+
 rt_status RTNDKMediaPlayer::setVolume(float leftVolume, float rightVolume) {
     return RTE_UNSUPPORTED;
 }
@@ -342,6 +415,17 @@ rt_status RTNDKMediaPlayer::writeData(const char * data, const UINT32 length, in
     return RTE_BAD_VALUE;
 }
 
+rt_status RTNDKMediaPlayer::lendData(const char * data, const UINT32 length, int flag,
+                                     RT_WRITEDATA_RELEASE release, void *opaque) {
+    if (RT_NULL != mPlayerCtx) {
+        if (RT_OK != mPlayerCtx->mNodePlayer->lendData(data, length, flag, release, opaque)) {
+            return RTE_BAD_VALUE;
+        }
+        return RTE_NO_ERROR;
+    }
+    return RTE_BAD_VALUE;
+}
+
 rt_status RTNDKMediaPlayer::setCallBack(RT_CALLBACK_T callback, int p_event, void *p_data) {
     if (RT_NULL != mPlayerCtx) {
         mPlayerCtx->mNodePlayer->setCallBack(callback, p_event, p_data);
@@ -49,7 +49,10 @@ class RTNDKMediaPlayer {
     rt_status setUID(uid_t uid);
     rt_status setDataSource(const char *url, const char *headers);
     rt_status setDataSource(int fd, int64_t offset, int64_t length);
+    rt_status setNextDataSource(const char *url, const char *headers);
     rt_status setLooping(int loop);
+    // 0.5 ~ 2.0, audio is stretched and its pitch is kept
+    rt_status setPlaybackRate(float rate);
     rt_status setVideoSurfaceTexture(void* bufferProducer);
     rt_status setVideoSurface(void* surface);
     rt_status setListener(RTPlayerListener* listener);
@@ -61,6 +64,10 @@ class RTNDKMediaPlayer {
     rt_status prepare();
     rt_status prepareAsync();
     rt_status seekTo(int64_t usec);
+    // 1: normal, 2/4/8/16: fast forward, -2/-4/-8/-16: rewind
+    rt_status setTrickRate(int32_t rate);
+    // switches audio track while playing, index is of track in media
+    rt_status selectTrack(int32_t index);
     rt_status start();
     rt_status stop();
     rt_status pause();
@@ -89,10 +96,13 @@ class RTNDKMediaPlayer {
      * attachAuxEffect: attaches an auxiliary effect to the audio track
      */
     rt_status setAudioSink(const void* audioSink);
+    rt_status setAudioSinkFile(const char* path);
     rt_status setVolume(float leftVolume, float rightVolume);
     rt_status setAuxEffectSendLevel(float level);
     rt_status attachAuxEffect(int effectId);
     rt_status writeData(const char * data, const UINT32 length, int flag, int type);
+    rt_status lendData(const char * data, const UINT32 length, int flag,
+                       RT_WRITEDATA_RELEASE release, void *opaque);
     /*
      * callback
      */
@@ -19,15 +19,23 @@
  */
 
 #include "RTNDKNodePlayer.h"
+#include <string.h>           // NOLINT
 #include "RTNode.h"           // NOLINT
 #include "RTNodeDemuxer.h"    // NOLINT
 #include "RTNodeAudioSink.h"  // NOLINT
+#include "RTSinkAudioFile.h"  // NOLINT
+#include "RTMediaPushStream.h" // NOLINT
+#include "RTAudioStretch.h"    // NOLINT
+#include "RTMediaBufferPool.h" // NOLINT
 #include "rt_header.h"        // NOLINT
 #include "rt_hash_table.h"    // NOLINT
 #include "rt_array_list.h"    // NOLINT
+#include "rt_string_utils.h"  // NOLINT
 #include "rt_message.h"       // NOLINT
 #include "rt_msg_handler.h"   // NOLINT
 #include "rt_msg_looper.h"    // NOLINT
+#include "rt_task.h"          // NOLINT
+#include "rt_taskpool.h"      // NOLINT
 
 #ifdef LOG_TAG
 #undef LOG_TAG
@@ -38,6 +46,12 @@
 #endif
 #define DEBUG_FLAG 0x0
 
+#define PREPARE_POOL_MAX_TASK   64
+#define TRICK_RATE_MAX          32
+#define TRICK_AUDIO_MUTE_RATE   8   // audio snippets are muted above it, or in rewind
+#define STRETCH_POOL_COUNT      8
+#define STRETCH_BUFFER_SIZE     (16 * 1024)
+
 struct NodePlayerContext {
     RTNodeBus*          mNodeBus;
     RTMediaDirector*    mDirector;
@@ -53,7 +67,42 @@ struct NodePlayerContext {
     INT64               mWantSeekTimeUs;
     INT64               mCurTimeUs;
     INT64               mDuration;
+    // trick play: 1 is normal rate, >1 fast forward, <0 rewind
+    INT32               mTrickRate;
+    // variable speed: pcm of decoder is stretched at playback rate, pitch is kept
+    float               mPlaybackRate;
+    RTAudioStretch*     mStretch;
+    RTMediaBufferPool*  mStretchPool;
+    RT_BOOL             mStretchFlush;
     RTProtocolType      mProtocolType;
+    RTMediaUri          mMediaUri;
+    // async prepare: running on shared prepare pool
+    RtMutex            *mPrepareLock;
+    RtCondition        *mPrepareCond;
+    RT_BOOL             mPrepareBusy;
+    RT_BOOL             mPrepareAbort;
+    RT_BOOL             mPrepareCodec;
+    // gapless playback: next item pre-rolls on shared prepare pool
+    RTNodeBus*          mNextBus;
+    RTNodeBus*          mRetiredBus;
+    RTMediaUri          mNextUri;
+    RT_BOOL             mNextBusy;
+    RT_BOOL             mNextAbort;
+    RT_BOOL             mNextReady;
+    RTNodeStub*         mSinkStub;
+    char                mSinkUri[1024];
+    // audio track switching: codec of new track is prepared on shared prepare pool,
+    // deliver thread splices it at the end of last pcm from decoder.
+    INT32               mSwitchIndex;
+    RTNode*             mSwitchCodec;   // NULL: current codec is reused
+    RT_BOOL             mSwitchBusy;
+    RT_BOOL             mSwitchReady;
+    INT64               mSwitchBeginUs;
+    INT64               mSwitchSpliceUs;  // pcm of new track before it is cut, -1: none
+    INT64               mAudioEndUs;      // end of last pcm from decoder, -1: unknown
+    // push mode: writeData() feeds demuxer of push:// uri
+    RTMediaPushStream*  mPushStream;
+    RtMutex            *mPushLock;
     RTPlayerListener*   mListener;
     RT_CALLBACK_T       mRT_Callback;
     INT32               mRT_Callback_Type;
@@ -70,6 +119,192 @@ void* thread_deliver_proc(void* pNodePlayer) {
     return RT_NULL;
 }
 
+/*
+ * all players share one prepare pool, so that open/probe of many players
+ * run in parallel and never block the message looper of player. stages of
+ * one prepare overlap on the stage pool, whose tasks never wait for other
+ * tasks, so prepare tasks waiting for stages can't starve it.
+ */
+static RtTaskPool* prepare_pool_get(RT_BOOL stage = RT_FALSE) {
+    static RtMutex     gPoolLock;
+    static RtTaskPool* gPreparePool = RT_NULL;
+    static RtTaskPool* gStagePool   = RT_NULL;
+    RtMutex::RtAutolock autoLock(&gPoolLock);
+    RtTaskPool** pool = stage ? &gStagePool : &gPreparePool;
+    if (RT_NULL == *pool) {
+        *pool = rt_taskpool_init(0, PREPARE_POOL_MAX_TASK);
+    }
+    return *pool;
+}
+
+// stages of one prepare, the waiter is woken up when all of them are done
+struct RTPrepareStages {
+    RtMutex      mLock;
+    RtCondition  mCond;
+    INT32        mPending;
+};
+
+// codec and sink of one line of node-bus are created and opened on stage pool
+struct RTPrepareStage : public RtTask {
+    RTPrepareStage(RTPrepareStages* stages, RTNodeBus* nodeBus, BUS_LINE_TYPE lType)
+            : mStages(stages), mNodeBus(nodeBus), mLineType(lType) {
+        mID       = 0;
+        mPriority = TASK_PRIOTRY_FIFO;
+    }
+    void   run_impl(void* args) {
+        mNodeBus->autoBuildLine(mLineType);
+        // stages are released by the waiter once it is woken up
+        RtMutex::RtAutolock autoLock(&(mStages->mLock));
+        mStages->mPending--;
+        mStages->mCond.broadcast();
+    }
+    void*  get_args() { return mNodeBus; }
+    char*  get_name() { return const_cast<char*>("PrepareStage"); }
+
+    RTPrepareStages*  mStages;
+    RTNodeBus*        mNodeBus;
+    BUS_LINE_TYPE     mLineType;
+};
+
+static void prepare_stage_start(RTPrepareStages* stages, RTNodeBus* nodeBus, BUS_LINE_TYPE lType) {
+    {
+        RtMutex::RtAutolock autoLock(&(stages->mLock));
+        stages->mPending++;
+    }
+    RTPrepareStage* stage = new RTPrepareStage(stages, nodeBus, lType);
+    if (RT_OK != rt_taskpool_push_tail(prepare_pool_get(RT_TRUE), stage)) {
+        // stage pool refuses it, the stage runs here
+        stage->run(RT_NULL);
+        delete stage;
+    }
+}
+
+static void prepare_stage_wait(RTPrepareStages* stages) {
+    RtMutex::RtAutolock autoLock(&(stages->mLock));
+    while (stages->mPending > 0) {
+        stages->mCond.wait(&(stages->mLock));
+    }
+}
+
+// abort flag is set by cancelPrepareAsync() under prepare lock
+static RT_BOOL prepare_aborted(NodePlayerContext* ctx) {
+    RtMutex::RtAutolock autoLock(ctx->mPrepareLock);
+    return ctx->mPrepareAbort;
+}
+
+typedef RT_RET (RTNDKNodePlayer::*RTPlayerTaskFunc)();
+
+// background work of player, it runs one callback of player on prepare pool
+struct RTPlayerTask : public RtTask {
+    RTPlayerTask(RTNDKNodePlayer* player, RTPlayerTaskFunc func, const char* name)
+            : mPlayer(player), mFunc(func), mName(name) {
+        mID       = 0;
+        mPriority = TASK_PRIOTRY_FIFO;
+    }
+    void   run_impl(void* args) { (mPlayer->*mFunc)(); }
+    void*  get_args() { return mPlayer; }
+    char*  get_name() { return const_cast<char*>(mName); }
+
+    RTNDKNodePlayer*  mPlayer;
+    RTPlayerTaskFunc  mFunc;
+    const char*       mName;
+};
+
+static RT_RET player_task_submit(RTNDKNodePlayer* player, RTPlayerTaskFunc func, const char* name) {
+    RTPlayerTask* task = new RTPlayerTask(player, func, name);
+    if (RT_OK != rt_taskpool_push_tail(prepare_pool_get(), task)) {
+        RT_LOGE("fail to push %s to prepare pool", name);
+        delete task;
+        return RT_ERR_BAD;
+    }
+    return RT_OK;
+}
+
+static void node_bus_destroy(RTNodeBus* nodeBus) {
+    if (RT_NULL != nodeBus) {
+        nodeBus->excuteCommand(RT_NODE_CMD_STOP);
+        nodeBus->excuteCommand(RT_NODE_CMD_RESET);
+        nodeBus->releaseNodes();
+        delete nodeBus;
+    }
+}
+
+/*
+ * pcm of two items can be spliced sample by sample, only if the sink
+ * needn't be reconfigured between them.
+ */
+static RT_BOOL node_codec_compatible(RTNode* curCodec, RTNode* nextCodec) {
+    INT32 curRate = 0, curChannels = 0;
+    INT32 nextRate = 0, nextChannels = 0;
+    RtMetaData* curMeta  = curCodec->queryFormat(RT_PORT_OUTPUT);
+    RtMetaData* nextMeta = nextCodec->queryFormat(RT_PORT_OUTPUT);
+    if ((RT_NULL == curMeta) || (RT_NULL == nextMeta)) {
+        return RT_FALSE;
+    }
+    curMeta->findInt32(kKeyACodecSampleRate,  &curRate);
+    curMeta->findInt32(kKeyACodecChannels,    &curChannels);
+    nextMeta->findInt32(kKeyACodecSampleRate, &nextRate);
+    nextMeta->findInt32(kKeyACodecChannels,   &nextChannels);
+    return ((curRate == nextRate) && (curChannels == nextChannels)) ? RT_TRUE : RT_FALSE;
+}
+
+/*
+ * decoder is reused by new track only if its input format is the same,
+ * e.g. tracks of languages which are encoded by one encoder.
+ */
+static RT_BOOL node_codec_reusable(RTNode* codec, RtMetaData* trackMeta) {
+    static const UINT32 keys[] = {
+        kKeyCodecID, kKeyACodecSampleRate, kKeyACodecChannels, kKeyCodecExtraSize,
+    };
+    RtMetaData* curMeta = codec->queryFormat(RT_PORT_INPUT);
+    if ((RT_NULL == curMeta) || (RT_NULL == trackMeta)) {
+        return RT_FALSE;
+    }
+    for (UINT32 idx = 0; idx < sizeof(keys)/sizeof(keys[0]); idx++) {
+        INT32 curValue = 0, newValue = 0;
+        curMeta->findInt32(keys[idx], &curValue);
+        trackMeta->findInt32(keys[idx], &newValue);
+        if (curValue != newValue) {
+            return RT_FALSE;
+        }
+    }
+
+    INT32  extraSize = 0;
+    RT_PTR curExtra  = RT_NULL;
+    RT_PTR newExtra  = RT_NULL;
+    curMeta->findInt32(kKeyCodecExtraSize, &extraSize);
+    if (extraSize > 0) {
+        curMeta->findPointer(kKeyCodecExtraData, &curExtra);
+        trackMeta->findPointer(kKeyCodecExtraData, &newExtra);
+        if ((RT_NULL == curExtra) || (RT_NULL == newExtra) || memcmp(curExtra, newExtra, extraSize)) {
+            return RT_FALSE;
+        }
+    }
+    return RT_TRUE;
+}
+
+// codec taken away from node-bus goes to warm pool, or is released
+static void node_codec_dispose(RTNodeBus* nodeBus, RTNode* codec) {
+    if ((RT_NULL != codec) && (RT_OK != nodeBus->recycleNode(codec, codec->queryFormat(RT_PORT_INPUT)))) {
+        rt_safe_delete(codec);
+    }
+}
+
+// pcm of ffmpeg decoder is always interleaved S16
+static INT64 node_pcm_duration(RTNode* codec, INT32 bytes) {
+    INT32 sampleRate = 0;
+    INT32 channels   = 0;
+    RtMetaData* format = codec->queryFormat(RT_PORT_OUTPUT);
+    if (RT_NULL != format) {
+        format->findInt32(kKeyACodecSampleRate, &sampleRate);
+        format->findInt32(kKeyACodecChannels, &channels);
+    }
+    if ((sampleRate <= 0) || (channels <= 0)) {
+        return 0ll;
+    }
+    return (INT64)bytes * 1000000ll / ((INT64)sampleRate * channels * 2);
+}
+
 RTNDKNodePlayer::RTNDKNodePlayer() {
     mPlayerCtx = rt_malloc(NodePlayerContext);
     rt_memset(mPlayerCtx, 0, sizeof(NodePlayerContext));
@@ -89,8 +324,30 @@ RTNDKNodePlayer::RTNDKNodePlayer() {
     mPlayerCtx->mRT_Callback   = NULL;
     mPlayerCtx->mLooping       = RT_FALSE;
     mPlayerCtx->mProtocolType  = RT_PROTOCOL_NONE;
+    mPlayerCtx->mTrickRate     = 1;
+    mPlayerCtx->mPlaybackRate  = 1.0f;
+    mPlayerCtx->mStretch       = RT_NULL;
+    mPlayerCtx->mStretchPool   = RT_NULL;
+    mPlayerCtx->mStretchFlush  = RT_FALSE;
     mPlayerCtx->mCmdOptions    = new RtMetaData();
     mPlayerCtx->mNodeLock      = new RtMutex();
+    mPlayerCtx->mPrepareLock   = new RtMutex();
+    mPlayerCtx->mPrepareCond   = new RtCondition();
+    mPlayerCtx->mPrepareBusy   = RT_FALSE;
+    mPlayerCtx->mPrepareAbort  = RT_FALSE;
+    mPlayerCtx->mNextBus       = RT_NULL;
+    mPlayerCtx->mRetiredBus    = RT_NULL;
+    mPlayerCtx->mNextBusy      = RT_FALSE;
+    mPlayerCtx->mNextAbort     = RT_FALSE;
+    mPlayerCtx->mNextReady     = RT_FALSE;
+    mPlayerCtx->mSinkStub      = RT_NULL;
+    mPlayerCtx->mSwitchCodec   = RT_NULL;
+    mPlayerCtx->mSwitchBusy    = RT_FALSE;
+    mPlayerCtx->mSwitchReady   = RT_FALSE;
+    mPlayerCtx->mSwitchSpliceUs = -1ll;
+    mPlayerCtx->mAudioEndUs    = -1ll;
+    mPlayerCtx->mPushStream    = RT_NULL;
+    mPlayerCtx->mPushLock      = new RtMutex();
 
     init();
 
@@ -109,17 +366,33 @@ RT_RET RTNDKNodePlayer::release() {
         return err;
     }
 
+    // async prepare may still hold the player, and wait for pushed bytes
+    closePushStream(RT_FALSE);
+    cancelPrepareAsync();
+    cancelPrerollNext();
+    cancelTrackSwitch();
+
     // @review: release resources in player context
     mPlayerCtx->mLooper->stop();
     rt_safe_delete(mPlayerCtx->mLooper);
     rt_safe_delete(mPlayerCtx->mDirector);
     rt_safe_delete(mPlayerCtx->mCmdOptions);
     rt_safe_delete(mPlayerCtx->mNodeLock);
-    rt_safe_free(mPlayerCtx);
+    rt_safe_delete(mPlayerCtx->mPrepareLock);
+    rt_safe_delete(mPlayerCtx->mPrepareCond);
 
     // @review: release node bus
     rt_safe_delete(mNodeBus);
 
+    // sink is released with node bus, stretched pcm isn't rendered any more
+    rt_safe_delete(mPlayerCtx->mStretch);
+    rt_safe_delete(mPlayerCtx->mStretchPool);
+
+    // demuxer is released with node bus, so that push stream is unused
+    closePushStream(RT_TRUE);
+    rt_safe_delete(mPlayerCtx->mPushLock);
+    rt_safe_free(mPlayerCtx);
+
     return err;
 }
 
@@ -142,6 +415,11 @@ RT_RET RTNDKNodePlayer::reset() {
         return err;
     }
 
+    // abort async prepare before tearing down node-bus, it may be probing
+    // pushed bytes, so that push stream is aborted at first.
+    closePushStream(RT_FALSE);
+    cancelPrepareAsync();
+
     UINT32 curState = this->getCurState();
     if (RT_STATE_IDLE == curState) {
         RTMediaUtil::dumpStateError(curState, __FUNCTION__);
@@ -160,6 +438,10 @@ RT_RET RTNDKNodePlayer::reset() {
         mPlayerCtx->mDeliverThread = RT_NULL;
     }
 
+    // next item and new audio track are fed by deliver thread, drop them after thread exits
+    cancelPrerollNext();
+    cancelTrackSwitch();
+
     // nodebus be operated by multithread
     RtMutex::RtAutolock autoLock(mPlayerCtx->mNodeLock);
 
@@ -169,6 +451,12 @@ RT_RET RTNDKNodePlayer::reset() {
     // release all [RTNodes] in node_bus;
     // but NO NEED to release [NodeStub].
     err = mNodeBus->releaseNodes();
+    closePushStream(RT_TRUE);
+    rt_memset(&(mPlayerCtx->mMediaUri), 0, sizeof(RTMediaUri));
+    mPlayerCtx->mTrickRate    = 1;
+    mPlayerCtx->mPlaybackRate = 1.0f;
+    mPlayerCtx->mStretchFlush = RT_TRUE;
+    mPlayerCtx->mAudioEndUs   = -1ll;
     this->setCurState(RT_STATE_IDLE);
     return err;
 }
@@ -179,31 +467,23 @@ RT_RET RTNDKNodePlayer::setDataSource(RTMediaUri *mediaUri) {
         return err;
     }
 
-    // nodebus be operated by multithread
-    RtMutex::RtAutolock autoLock(mPlayerCtx->mNodeLock);
-
     // MediaPlayer StateMachine: valid state -- RT_STATE_IDLE
     UINT32 curState = getCurState();
     switch (curState) {
       case RT_STATE_IDLE:
-        if (mediaUri->mUri[0] == RT_NULL) {
-            this->setCurState(RT_STATE_INITIALIZED);
-        } else {
+        // open and probe are deferred to prepare()/prepareAsync(),
+        // so that a slow source never blocks the caller here.
+        rt_memcpy(&(mPlayerCtx->mMediaUri), mediaUri, sizeof(RTMediaUri));
+        if (mediaUri->mUri[0] != RT_NULL) {
             mPlayerCtx->mProtocolType = RTMediaUtil::getMediaProtocol(mediaUri->mUri);
-            err = mNodeBus->autoBuild(mediaUri);
-            if (RT_OK != err) {
-                if (RT_NULL == mNodeBus->getRootNode(BUS_LINE_ROOT)) {
-                    RT_LOGE("fail to init demuxer");
-                    mPlayerCtx->mLooper->flush();
-                    RTMessage* msg = new RTMessage(RT_MEDIA_ERROR, RT_NULL, this);
-                    mPlayerCtx->mLooper->post(msg, 0);
-                    // mPlayerCtx->mLooper->requestExit();
-                    return RT_ERR_UNKNOWN;
-                }
-            } else {
-                this->setCurState(RT_STATE_INITIALIZED);
-            }
         }
+        if (RT_PROTOCOL_PUSH == mPlayerCtx->mProtocolType) {
+            // bytes can be written before prepare, prober reads them later
+            RtMutex::RtAutolock autoLock(mPlayerCtx->mPushLock);
+            mPlayerCtx->mPushStream = new RTMediaPushStream();
+            mPlayerCtx->mMediaUri.mPushStream = mPlayerCtx->mPushStream;
+        }
+        this->setCurState(RT_STATE_INITIALIZED);
         break;
       default:
         RTMediaUtil::dumpStateError(curState, __FUNCTION__);
@@ -212,6 +492,48 @@ RT_RET RTNDKNodePlayer::setDataSource(RTMediaUri *mediaUri) {
     return err;
 }
 
+RT_RET RTNDKNodePlayer::setNextDataSource(RTMediaUri *mediaUri) {
+    RT_RET err = checkRuntime("setNextDataSource");
+    if (RT_OK != err) {
+        return err;
+    }
+
+    // MediaPlayer StateMachine: valid state -- from RT_STATE_INITIALIZED to RT_STATE_PAUSED
+    UINT32 curState = getCurState();
+    switch (curState) {
+      case RT_STATE_INITIALIZED:
+      case RT_STATE_PREPARING:
+      case RT_STATE_PREPARED:
+      case RT_STATE_STARTED:
+      case RT_STATE_PAUSED:
+        break;
+      default:
+        RTMediaUtil::dumpStateError(curState, __FUNCTION__);
+        return RT_OK;
+    }
+
+    {
+        RtMutex::RtAutolock autoLock(mPlayerCtx->mPrepareLock);
+        if (mPlayerCtx->mNextBusy || (RT_NULL != mPlayerCtx->mNextBus)) {
+            RT_LOGE("next item is queued already, ignore it");
+            return RT_ERR_BAD;
+        }
+        rt_memcpy(&(mPlayerCtx->mNextUri), mediaUri, sizeof(RTMediaUri));
+        mPlayerCtx->mNextBusy  = RT_TRUE;
+        mPlayerCtx->mNextAbort = RT_FALSE;
+        mPlayerCtx->mNextReady = RT_FALSE;
+    }
+
+    // demuxer and decoder of next item are opened and started in background,
+    // the deliver thread feeds them once current item reaches its end.
+    if (RT_OK != player_task_submit(this, &RTNDKNodePlayer::onPrerollNext, "PrerollTask")) {
+        RtMutex::RtAutolock autoLock(mPlayerCtx->mPrepareLock);
+        mPlayerCtx->mNextBusy = RT_FALSE;
+        return RT_ERR_BAD;
+    }
+    return RT_OK;
+}
+
 RT_RET RTNDKNodePlayer::prepare() {
     RT_RET err = checkRuntime("prepare");
     if (RT_OK != err) {
@@ -225,18 +547,15 @@ RT_RET RTNDKNodePlayer::prepare() {
         return RT_OK;
     }
 
-    if (RT_STATE_INITIALIZED == curState) {
-        err = mNodeBus->autoBuildCodecSink();
-        if (RT_OK != err) {
-            RT_LOGE("fail to use node-bus to build codec sink");
-        }
-    }
-
     setCurState(RT_STATE_PREPARING);
 
-    // @TODO: do prepare player
-    mNodeBus->excuteCommand(RT_NODE_CMD_PREPARE);
-
+    err = buildStreamline(RT_STATE_INITIALIZED == curState);
+    if (RT_OK != err) {
+        setCurState(RT_STATE_ERROR);
+        RTMessage* msg = new RTMessage(RT_MEDIA_ERROR, RT_NULL, this);
+        mPlayerCtx->mLooper->post(msg, 0);
+        return err;
+    }
 
     this->onPreparedDone();
     setCurState(RT_STATE_PREPARED);
@@ -249,6 +568,43 @@ RT_RET RTNDKNodePlayer::prepare() {
     return RT_OK;
 }
 
+RT_RET RTNDKNodePlayer::prepareAsync() {
+    RT_RET err = checkRuntime("prepareAsync");
+    if (RT_OK != err) {
+        return err;
+    }
+
+    // MediaPlayer StateMachine: valid state -- RT_STATE_INITIALIZED&RT_STATE_STOPPED
+    UINT32 curState = this->getCurState();
+    if ((RT_STATE_INITIALIZED != curState) && (RT_STATE_STOPPED != curState)) {
+        RTMediaUtil::dumpStateError(curState, __FUNCTION__);
+        return RT_OK;
+    }
+
+    {
+        RtMutex::RtAutolock autoLock(mPlayerCtx->mPrepareLock);
+        if (mPlayerCtx->mPrepareBusy) {
+            RT_LOGE("prepareAsync is in progress, ignore it");
+            return RT_OK;
+        }
+        mPlayerCtx->mPrepareBusy  = RT_TRUE;
+        mPlayerCtx->mPrepareAbort = RT_FALSE;
+        mPlayerCtx->mPrepareCodec = (RT_STATE_INITIALIZED == curState) ? RT_TRUE : RT_FALSE;
+    }
+
+    setCurState(RT_STATE_PREPARING);
+
+    // open, probe, codec and sink run on shared prepare pool;
+    // RT_MEDIA_PREPARED is posted by onPrepareAsync() through looper.
+    if (RT_OK != player_task_submit(this, &RTNDKNodePlayer::onPrepareAsync, "PrepareTask")) {
+        RtMutex::RtAutolock autoLock(mPlayerCtx->mPrepareLock);
+        mPlayerCtx->mPrepareBusy = RT_FALSE;
+        setCurState(curState);
+        return RT_ERR_BAD;
+    }
+    return RT_OK;
+}
+
 RT_RET RTNDKNodePlayer::start() {
     RT_RET err = checkRuntime("start");
     if (RT_OK != err) {
@@ -323,6 +679,9 @@ RT_RET RTNDKNodePlayer::stop() {
         return err;
     }
 
+    // abort async prepare before stopping nodes
+    cancelPrepareAsync();
+
     UINT32 curState = this->getCurState();
     RTMessage* msg  = RT_NULL;
     switch (curState) {
@@ -347,6 +706,8 @@ RT_RET RTNDKNodePlayer::stop() {
         mPlayerCtx->mLooper->post(msg, 0);
         mPlayerCtx->mCurTimeUs = 0;
         mPlayerCtx->mDuration  = 0;
+        mPlayerCtx->mTrickRate = 1;
+        mPlayerCtx->mStretchFlush = RT_TRUE;
         this->setCurState(RT_STATE_STOPPED);
         break;
     }
@@ -399,6 +760,102 @@ RT_RET RTNDKNodePlayer::seekTo(INT64 usec) {
     return err;
 }
 
+RT_RET RTNDKNodePlayer::setTrickRate(INT32 rate) {
+    RT_RET err = checkRuntime("setTrickRate");
+    if (RT_OK != err) {
+        return err;
+    }
+
+    if (0 == rate) {
+        RT_LOGE("invalid trick rate: %d", rate);
+        return RT_ERR_VALUE;
+    }
+    if (RT_ABS(rate) > TRICK_RATE_MAX) {
+        rate = (rate > 0) ? TRICK_RATE_MAX : -TRICK_RATE_MAX;
+    }
+
+    UINT32 curState = this->getCurState();
+    switch (curState) {
+      case RT_STATE_PREPARED:
+      case RT_STATE_PAUSED:
+      case RT_STATE_STARTED:
+      case RT_STATE_COMPLETE:
+        if (rate != mPlayerCtx->mTrickRate) {
+            err = onTrickPlay(rate);
+        }
+        break;
+      default:
+        RTMediaUtil::dumpStateError(curState, __FUNCTION__);
+        err = RT_ERR_BAD;
+        break;
+    }
+    return err;
+}
+
+/*
+ * audio track is switched without rebuilding streamline. codec of new track
+ * is prepared in background, unless current codec is reused, and deliver
+ * thread splices new track at the end of last pcm from decoder.
+ */
+RT_RET RTNDKNodePlayer::selectTrack(INT32 index) {
+    RT_RET err = checkRuntime("selectTrack");
+    if (RT_OK != err) {
+        return err;
+    }
+
+    UINT32 curState = this->getCurState();
+    switch (curState) {
+      case RT_STATE_PREPARED:
+      case RT_STATE_PAUSED:
+      case RT_STATE_STARTED:
+        break;
+      default:
+        RTMediaUtil::dumpStateError(curState, __FUNCTION__);
+        return RT_ERR_BAD;
+    }
+    if (1 != mPlayerCtx->mTrickRate) {
+        RT_LOGE("audio track can't be switched in trick play");
+        return RT_ERR_BAD;
+    }
+
+    {
+        // nodebus be operated by multithread
+        RtMutex::RtAutolock autoLock(mPlayerCtx->mNodeLock);
+        RTNodeDemuxer* demuxer = reinterpret_cast<RTNodeDemuxer*>(mNodeBus->getRootNode(BUS_LINE_ROOT));
+        if ((RT_NULL == demuxer) || (RT_NULL == mNodeBus->getRootNode(BUS_LINE_AUDIO))) {
+            return RT_ERR_BAD;
+        }
+        if (index == demuxer->queryTrackUsed(RTTRACK_TYPE_AUDIO)) {
+            return RT_OK;
+        }
+        INT32       tType = RTTRACK_TYPE_UNKNOWN;
+        RtMetaData* meta  = demuxer->queryTrackMeta(index, RTTRACK_TYPE_AUDIO);
+        meta->findInt32(kKeyCodecType, &tType);
+        rt_safe_delete(meta);
+        if (RTTRACK_TYPE_AUDIO != tType) {
+            RT_LOGE("track %d isn't audio track", index);
+            return RT_ERR_VALUE;
+        }
+    }
+
+    {
+        RtMutex::RtAutolock autoLock(mPlayerCtx->mPrepareLock);
+        if (mPlayerCtx->mSwitchBusy || mPlayerCtx->mSwitchReady) {
+            RT_LOGE("audio track switching is in progress");
+            return RT_ERR_BAD;
+        }
+        mPlayerCtx->mSwitchIndex   = index;
+        mPlayerCtx->mSwitchBusy    = RT_TRUE;
+        mPlayerCtx->mSwitchBeginUs = RtTime::getNowTimeUs();
+    }
+    RT_LOGD("switch audio track to %d", index);
+    if (RT_OK != player_task_submit(this, &RTNDKNodePlayer::onSwitchTrack, "TrackSwitchTask")) {
+        RtMutex::RtAutolock autoLock(mPlayerCtx->mPrepareLock);
+        mPlayerCtx->mSwitchBusy = RT_FALSE;
+        return RT_ERR_BAD;
+    }
+    return err;
+}
 
 RT_RET RTNDKNodePlayer::setLooping(RT_BOOL loop) {
     RT_RET err = checkRuntime("setLooping");
@@ -417,6 +874,23 @@ RT_RET RTNDKNodePlayer::setLooping(RT_BOOL loop) {
     return err;
 }
 
+/*
+ * rate is changed on the fly, pcm is stretched by delivery thread.
+ */
+RT_RET RTNDKNodePlayer::setPlaybackRate(float rate) {
+    RT_RET err = checkRuntime("setPlaybackRate");
+    if (RT_OK != err) {
+        return err;
+    }
+    if ((rate < AUDIO_STRETCH_MIN_RATE) || (rate > AUDIO_STRETCH_MAX_RATE)) {
+        RT_LOGE("rate(%.2f) is out of [%.1f, %.1f]", rate, AUDIO_STRETCH_MIN_RATE, AUDIO_STRETCH_MAX_RATE);
+        return RT_ERR_VALUE;
+    }
+    mPlayerCtx->mPlaybackRate = rate;
+    RT_LOGD("done, playback rate: %.2f", rate);
+    return err;
+}
+
 RT_RET RTNDKNodePlayer::setListener(RTPlayerListener* listener) {
     RT_RET err = checkRuntime("setLooping");
     if (RT_OK != err) {
@@ -428,6 +902,29 @@ RT_RET RTNDKNodePlayer::setListener(RTPlayerListener* listener) {
     mPlayerCtx->mListener = listener;
 }
 
+RT_RET RTNDKNodePlayer::setAudioSinkFile(const char* path) {
+    RT_RET err = checkRuntime("setAudioSinkFile");
+    if (RT_OK != err) {
+        return err;
+    }
+
+    // MediaPlayer StateMachine: valid state -- before sinks are created
+    UINT32 curState = this->getCurState();
+    if ((RT_STATE_IDLE != curState) && (RT_STATE_INITIALIZED != curState)) {
+        RTMediaUtil::dumpStateError(curState, __FUNCTION__);
+        return RT_ERR_BAD;
+    }
+
+    if (RT_NULL != path) {
+        rt_str_snprintf(mPlayerCtx->mSinkUri, sizeof(mPlayerCtx->mSinkUri), "%s", path);
+        mPlayerCtx->mSinkStub = &rt_sink_audio_file;
+    } else {
+        rt_memset(mPlayerCtx->mSinkUri, 0, sizeof(mPlayerCtx->mSinkUri));
+        mPlayerCtx->mSinkStub = RT_NULL;
+    }
+    return mNodeBus->setSinkStub(BUS_LINE_AUDIO, mPlayerCtx->mSinkStub, mPlayerCtx->mSinkUri);
+}
+
 RT_RET RTNDKNodePlayer::post(const char* caller, RTMessage* msg) {
     RT_RET err = checkRuntime("post message");
     if (RT_OK != err) {
@@ -439,6 +936,7 @@ RT_RET RTNDKNodePlayer::post(const char* caller, RTMessage* msg) {
         RT_LOGE("%24s requested post message:%s", caller, mMediaCmds[what].name);
         mPlayerCtx->mLooper->post(msg, 0);
     }
+    return err;
 }
 
 RT_RET RTNDKNodePlayer::send(const char* caller, RTMessage* msg) {
@@ -452,6 +950,7 @@ RT_RET RTNDKNodePlayer::send(const char* caller, RTMessage* msg) {
         RT_LOGE("%s requested to send message:%s", caller, mMediaCmds[what].name);
         mPlayerCtx->mLooper->send(msg, 0);
     }
+    return err;
 }
 
 RT_RET RTNDKNodePlayer::wait(int64_t timeUs) {
@@ -573,12 +1072,14 @@ RT_RET RTNDKNodePlayer::onSeekTo(INT64 usec) {
 
     // workflow: pause flush (cache maybe) start
     setCurState(RT_STATE_PAUSED);
+    mPlayerCtx->mAudioEndUs = -1ll;
     mNodeBus->excuteCommand(RT_NODE_CMD_PAUSE);
     mNodeBus->excuteCommand(RT_NODE_CMD_FLUSH);
 
     mPlayerCtx->mCmdOptions->clear();
     mPlayerCtx->mCmdOptions->setInt64(kKeySeekTimeUs, usec);
     mNodeBus->excuteCommand(RT_NODE_CMD_SEEK, mPlayerCtx->mCmdOptions);
+    mPlayerCtx->mStretchFlush = RT_TRUE;
     mNodeBus->excuteCommand(RT_NODE_CMD_START);
 
     // post RT_MEDIA_SEEK_COMPLETE
@@ -589,6 +1090,43 @@ RT_RET RTNDKNodePlayer::onSeekTo(INT64 usec) {
     return err;
 }
 
+/*
+ * demuxer feeds key frames only, and decoder skips non-ref frames.
+ * position of player is kept, trick play starts from it.
+ */
+RT_RET RTNDKNodePlayer::onTrickPlay(INT32 rate) {
+    RT_RET err = checkRuntime("onTrickPlay");
+    if (RT_OK != err) {
+        return err;
+    }
+
+    // audio track isn't switched in trick play
+    cancelTrackSwitch();
+
+    // nodebus be operated by multithread
+    RtMutex::RtAutolock autoLock(mPlayerCtx->mNodeLock);
+
+    // workflow: pause flush trickplay start
+    UINT32 curState = getCurState();
+    setCurState(RT_STATE_PAUSED);
+    mNodeBus->excuteCommand(RT_NODE_CMD_PAUSE);
+    mNodeBus->excuteCommand(RT_NODE_CMD_FLUSH);
+
+    mPlayerCtx->mCmdOptions->clear();
+    mPlayerCtx->mCmdOptions->setInt32(kKeyTrickRate, rate);
+    mPlayerCtx->mCmdOptions->setInt64(kKeySeekTimeUs, mPlayerCtx->mCurTimeUs);
+    mNodeBus->excuteCommand(RT_NODE_CMD_TRICKPLAY, mPlayerCtx->mCmdOptions);
+    mPlayerCtx->mTrickRate    = rate;
+    mPlayerCtx->mStretchFlush = RT_TRUE;
+    if (RT_STATE_STARTED == curState) {
+        mNodeBus->excuteCommand(RT_NODE_CMD_START);
+    }
+    setCurState(curState);
+    RT_LOGE("done, trick play at rate:%d from %lldms", rate, mPlayerCtx->mCurTimeUs/1000);
+
+    return err;
+}
+
 RT_RET RTNDKNodePlayer::onPlaybackDone() {
     RT_RET err = checkRuntime("onPlaybackDone");
     if (RT_OK != err) {
@@ -624,6 +1162,386 @@ RT_RET RTNDKNodePlayer::onPreparedDone() {
     return err;
 }
 
+RT_RET RTNDKNodePlayer::buildStreamline(RT_BOOL withCodecSink) {
+    RTMediaUri* mediaUri = &(mPlayerCtx->mMediaUri);
+
+    // stage 1: open and probe the source, the slowest stage
+    if ((mediaUri->mUri[0] != RT_NULL) && (RT_NULL == mNodeBus->getRootNode(BUS_LINE_ROOT))) {
+        RtMutex::RtAutolock autoLock(mPlayerCtx->mNodeLock);
+        if (RT_OK != mNodeBus->autoBuild(mediaUri)) {
+            RT_LOGE("fail to init demuxer");
+            return RT_ERR_UNKNOWN;
+        }
+    }
+    if (prepare_aborted(mPlayerCtx)) {
+        return RT_OK;
+    }
+
+    // stage 2: create codecs and open sinks of selected tracks. video line
+    // is built on stage pool, its codec and sink open while audio line does.
+    if (withCodecSink) {
+        RtMutex::RtAutolock autoLock(mPlayerCtx->mNodeLock);
+        RTPrepareStages stages;
+        stages.mPending = 0;
+        prepare_stage_start(&stages, mNodeBus, BUS_LINE_VIDEO);
+        mNodeBus->autoBuildLine(BUS_LINE_AUDIO);
+        prepare_stage_wait(&stages);
+    }
+    if (prepare_aborted(mPlayerCtx)) {
+        return RT_OK;
+    }
+
+    // stage 3: prepare all nodes in node-bus
+    {
+        RtMutex::RtAutolock autoLock(mPlayerCtx->mNodeLock);
+        mNodeBus->excuteCommand(RT_NODE_CMD_PREPARE);
+    }
+    return RT_OK;
+}
+
+RT_RET RTNDKNodePlayer::onPrepareAsync() {
+    RT_RET err = buildStreamline(mPlayerCtx->mPrepareCodec);
+
+    RtMutex::RtAutolock autoLock(mPlayerCtx->mPrepareLock);
+    if (mPlayerCtx->mPrepareAbort) {
+        RT_LOGD("done, prepareAsync is canceled");
+    } else if (RT_OK != err) {
+        setCurState(RT_STATE_ERROR);
+        RTMessage* msg = new RTMessage(RT_MEDIA_ERROR, RT_NULL, this);
+        mPlayerCtx->mLooper->post(msg, 0);
+    } else {
+        this->onPreparedDone();
+        setCurState(RT_STATE_PREPARED);
+        RTMessage* msg = new RTMessage(RT_MEDIA_PREPARED, RT_NULL, this);
+        mPlayerCtx->mLooper->post(msg, 0);
+        postSeekIfNecessary();
+    }
+
+    // wakeup cancelPrepareAsync(), player must not be touched after it
+    mPlayerCtx->mPrepareBusy = RT_FALSE;
+    mPlayerCtx->mPrepareCond->broadcast();
+    return err;
+}
+
+RT_RET RTNDKNodePlayer::cancelPrepareAsync() {
+    RtMutex::RtAutolock autoLock(mPlayerCtx->mPrepareLock);
+    mPlayerCtx->mPrepareAbort = RT_TRUE;
+    while (mPlayerCtx->mPrepareBusy) {
+        mPlayerCtx->mPrepareCond->wait(mPlayerCtx->mPrepareLock);
+    }
+    mPlayerCtx->mPrepareAbort = RT_FALSE;
+    return RT_OK;
+}
+
+RT_RET RTNDKNodePlayer::onPrerollNext() {
+    RT_RET     err     = RT_OK;
+    RTNodeBus* nextBus = new RTNodeBus();
+    nextBus->setSinkStub(BUS_LINE_AUDIO, mPlayerCtx->mSinkStub, mPlayerCtx->mSinkUri);
+
+    // the sink of current item is reused, so build demuxer and codecs only.
+    err = nextBus->autoBuild(&(mPlayerCtx->mNextUri));
+    if ((RT_OK == err) && !mPlayerCtx->mNextAbort) {
+        nextBus->autoBuildCodecSink(RT_FALSE);
+        if (RT_NULL == nextBus->getRootNode(BUS_LINE_AUDIO)) {
+            RT_LOGE("fail to preroll next item, no audio codec");
+            err = RT_ERR_UNKNOWN;
+        }
+    }
+    if ((RT_OK == err) && !mPlayerCtx->mNextAbort) {
+        nextBus->excuteCommand(RT_NODE_CMD_PREPARE);
+        nextBus->excuteCommand(RT_NODE_CMD_START);
+    }
+
+    {
+        RtMutex::RtAutolock autoLock(mPlayerCtx->mPrepareLock);
+        if (mPlayerCtx->mNextAbort || (RT_OK != err)) {
+            RT_LOGD("done, preroll of next item is dropped, err=%d", err);
+        } else {
+            RT_LOGD("done, next item(%s) is ready", mPlayerCtx->mNextUri.mUri);
+            mPlayerCtx->mNextBus   = nextBus;
+            mPlayerCtx->mNextReady = RT_TRUE;
+            nextBus = RT_NULL;
+        }
+
+        // wakeup cancelPrerollNext(), player must not be touched after it
+        mPlayerCtx->mNextBusy = RT_FALSE;
+        mPlayerCtx->mPrepareCond->broadcast();
+    }
+
+    // dropped node-bus is owned by this task only
+    node_bus_destroy(nextBus);
+    return err;
+}
+
+/*
+ * audio track is switched without rebuilding pipeline: decoder is reused if
+ * new track is compatible, or a new one is prepared here, and deliver thread
+ * splices it at the end of last pcm.
+ */
+RT_RET RTNDKNodePlayer::onSwitchTrack() {
+    RT_RET  err   = RT_OK;
+    RTNode* codec = RT_NULL;
+    {
+        // nodebus be operated by multithread
+        RtMutex::RtAutolock autoLock(mPlayerCtx->mNodeLock);
+        RTNodeDemuxer* demuxer = reinterpret_cast<RTNodeDemuxer*>(mNodeBus->getRootNode(BUS_LINE_ROOT));
+        RTNode*        decoder = mNodeBus->getRootNode(BUS_LINE_AUDIO);
+        if ((RT_NULL == demuxer) || (RT_NULL == decoder)) {
+            err = RT_ERR_BAD;
+        } else {
+            RtMetaData* meta = demuxer->queryTrackMeta(mPlayerCtx->mSwitchIndex, RTTRACK_TYPE_AUDIO);
+            if (!node_codec_reusable(decoder, meta)) {
+                codec = mNodeBus->buildTrackCodec(mPlayerCtx->mSwitchIndex, RTTRACK_TYPE_AUDIO);
+                err   = (RT_NULL != codec) ? RT_OK : RT_ERR_UNKNOWN;
+            }
+            rt_safe_delete(meta);
+        }
+    }
+    // codec of new track decodes as soon as its packets are queued
+    if (RT_NULL != codec) {
+        RTNodeAdapter::runCmd(codec, RT_NODE_CMD_PREPARE, RT_NULL);
+        RTNodeAdapter::runCmd(codec, RT_NODE_CMD_START, RT_NULL);
+    }
+
+    RtMutex::RtAutolock autoLock(mPlayerCtx->mPrepareLock);
+    if (RT_OK != err) {
+        RT_LOGE("fail to switch audio track to %d, err=%d", mPlayerCtx->mSwitchIndex, err);
+    } else {
+        RT_LOGD("done, codec of audio track %d is ready, reused: %d",
+                 mPlayerCtx->mSwitchIndex, (RT_NULL == codec));
+        mPlayerCtx->mSwitchCodec = codec;
+        mPlayerCtx->mSwitchReady = RT_TRUE;
+    }
+
+    // wakeup cancelTrackSwitch(), player must not be touched after it
+    mPlayerCtx->mSwitchBusy = RT_FALSE;
+    mPlayerCtx->mPrepareCond->broadcast();
+    return err;
+}
+
+RT_RET RTNDKNodePlayer::cancelTrackSwitch() {
+    RTNode* codec = RT_NULL;
+    {
+        RtMutex::RtAutolock autoLock(mPlayerCtx->mPrepareLock);
+        while (mPlayerCtx->mSwitchBusy) {
+            mPlayerCtx->mPrepareCond->wait(mPlayerCtx->mPrepareLock);
+        }
+        codec = mPlayerCtx->mSwitchCodec;
+        mPlayerCtx->mSwitchCodec = RT_NULL;
+        mPlayerCtx->mSwitchReady = RT_FALSE;
+    }
+    mPlayerCtx->mSwitchSpliceUs = -1ll;
+    node_codec_dispose(mNodeBus, codec);
+    return RT_OK;
+}
+
+/*
+ * new audio track is spliced at the end of last pcm from decoder: demuxer
+ * reads new track again from there, decoder is flushed or swapped for the
+ * codec of new track. pcm of new track before it is cut by trimAudioFrame().
+ * returns the decoder of audio line.
+ */
+RTNode* RTNDKNodePlayer::switchAudioTrack(RTNode* decoder, RTNode* sink) {
+    RTNode* codec = RT_NULL;
+    INT32   index = -1;
+    {
+        RtMutex::RtAutolock autoLock(mPlayerCtx->mPrepareLock);
+        if (!mPlayerCtx->mSwitchReady) {
+            return decoder;
+        }
+        codec = mPlayerCtx->mSwitchCodec;
+        index = mPlayerCtx->mSwitchIndex;
+        mPlayerCtx->mSwitchCodec = RT_NULL;
+        mPlayerCtx->mSwitchReady = RT_FALSE;
+    }
+
+    // nodebus be operated by multithread
+    RtMutex::RtAutolock autoLock(mPlayerCtx->mNodeLock);
+    INT64 spliceUs = mPlayerCtx->mAudioEndUs;
+    mPlayerCtx->mCmdOptions->clear();
+    mPlayerCtx->mCmdOptions->setInt32(kKeyCodecType, RTTRACK_TYPE_AUDIO);
+    mPlayerCtx->mCmdOptions->setInt32(kKeyTrackIndex, index);
+    mPlayerCtx->mCmdOptions->setInt64(kKeySeekTimeUs, spliceUs);
+    RT_RET err = RTNodeAdapter::runCmd(mNodeBus->getRootNode(BUS_LINE_ROOT),
+                                       RT_NODE_CMD_SELECT_TRACK, mPlayerCtx->mCmdOptions);
+    if (RT_OK != err) {
+        RT_LOGE("fail to select audio track %d, err=%d", index, err);
+        node_codec_dispose(mNodeBus, codec);
+        return decoder;
+    }
+
+    if (RT_NULL == codec) {
+        // workflow: pause flush seek start, decoder prerolls up to splice position
+        RTNodeAdapter::runCmd(decoder, RT_NODE_CMD_PAUSE, RT_NULL);
+        RTNodeAdapter::runCmd(decoder, RT_NODE_CMD_FLUSH, RT_NULL);
+        RTNodeAdapter::runCmd(decoder, RT_NODE_CMD_SEEK, mPlayerCtx->mCmdOptions);
+        RTNodeAdapter::runCmd(decoder, RT_NODE_CMD_START, RT_NULL);
+    } else {
+        RTNode* oldCodec = mNodeBus->swapCodec(codec, BUS_LINE_AUDIO);
+        RTNodeAdapter::runCmd(codec, RT_NODE_CMD_SEEK, mPlayerCtx->mCmdOptions);
+        codec->setEventLooper(mPlayerCtx->mLooper);
+        if (!node_codec_compatible(oldCodec, codec)) {
+            RTNodeAdapter::init(sink, codec->queryFormat(RT_PORT_OUTPUT));
+        }
+        node_codec_dispose(mNodeBus, oldCodec);
+        decoder = codec;
+    }
+    mPlayerCtx->mSwitchSpliceUs = spliceUs;
+    RT_LOGD("done, audio track %d is spliced at %lldms", index, spliceUs/1000);
+    return decoder;
+}
+
+/*
+ * pcm of new track before splice position has been played by old track,
+ * it is cut off. returns RT_FALSE if nothing is left.
+ */
+RT_BOOL RTNDKNodePlayer::trimAudioFrame(RTNode* decoder, RTMediaBuffer* frame, INT64* timeUs) {
+    INT64 spliceUs = mPlayerCtx->mSwitchSpliceUs;
+    if (*timeUs >= spliceUs) {
+        return RT_TRUE;
+    }
+
+    // pcm of ffmpeg decoder is always interleaved S16
+    INT32 sampleRate = 0;
+    INT32 channels   = 0;
+    RtMetaData* format = decoder->queryFormat(RT_PORT_OUTPUT);
+    if (RT_NULL != format) {
+        format->findInt32(kKeyACodecSampleRate, &sampleRate);
+        format->findInt32(kKeyACodecChannels, &channels);
+    }
+    INT64 skip = (spliceUs - *timeUs) * sampleRate / 1000000ll * channels * 2;
+    if (skip >= frame->getLength()) {
+        return RT_FALSE;
+    }
+
+    // data of media buffer starts at offset 0, so that pcm is moved
+    UINT8* data = reinterpret_cast<UINT8*>(frame->getData());
+    memmove(data, data + skip, frame->getLength() - skip);
+    frame->setRange(0, frame->getLength() - skip);
+    frame->getMetaData()->setInt64(kKeyFramePts, spliceUs);
+    *timeUs = spliceUs;
+    return RT_TRUE;
+}
+
+/*
+ * writer may block in writeData() with push lock held, so that stream is
+ * aborted without lock at first, and deleted after writer leaves.
+ */
+RT_RET RTNDKNodePlayer::closePushStream(RT_BOOL destroy) {
+    if (!destroy) {
+        if (RT_NULL != mPlayerCtx->mPushStream) {
+            mPlayerCtx->mPushStream->abort();
+        }
+        return RT_OK;
+    }
+    RtMutex::RtAutolock autoLock(mPlayerCtx->mPushLock);
+    rt_safe_delete(mPlayerCtx->mPushStream);
+    mPlayerCtx->mMediaUri.mPushStream = RT_NULL;
+    return RT_OK;
+}
+
+RT_RET RTNDKNodePlayer::cancelPrerollNext() {
+    RTNodeBus* nextBus    = RT_NULL;
+    RTNodeBus* retiredBus = RT_NULL;
+    {
+        RtMutex::RtAutolock autoLock(mPlayerCtx->mPrepareLock);
+        mPlayerCtx->mNextAbort = RT_TRUE;
+        while (mPlayerCtx->mNextBusy) {
+            mPlayerCtx->mPrepareCond->wait(mPlayerCtx->mPrepareLock);
+        }
+        mPlayerCtx->mNextAbort  = RT_FALSE;
+        mPlayerCtx->mNextReady  = RT_FALSE;
+        nextBus                 = mPlayerCtx->mNextBus;
+        retiredBus              = mPlayerCtx->mRetiredBus;
+        mPlayerCtx->mNextBus    = RT_NULL;
+        mPlayerCtx->mRetiredBus = RT_NULL;
+    }
+    node_bus_destroy(nextBus);
+    node_bus_destroy(retiredBus);
+    return RT_OK;
+}
+
+/*
+ * move the sink of current node-bus to the node-bus of next item, then the
+ * next item becomes current. old node-bus is retired but kept alive, since
+ * its frames may still be queued in the sink.
+ */
+RT_RET RTNDKNodePlayer::spliceNextItem(RT_BOOL reconfigSink) {
+    RTNodeBus* nextBus    = RT_NULL;
+    RTNodeBus* retiredBus = RT_NULL;
+    {
+        RtMutex::RtAutolock autoLock(mPlayerCtx->mPrepareLock);
+        if (!mPlayerCtx->mNextReady) {
+            return RT_ERR_BAD;
+        }
+        nextBus                 = mPlayerCtx->mNextBus;
+        mPlayerCtx->mNextBus    = RT_NULL;
+        mPlayerCtx->mNextReady  = RT_FALSE;
+    }
+
+    {
+        // nodebus be operated by multithread
+        RtMutex::RtAutolock autoLock(mPlayerCtx->mNodeLock);
+        RTNode* sink  = mNodeBus->detachSink(BUS_LINE_AUDIO);
+        RTNode* codec = nextBus->getRootNode(BUS_LINE_AUDIO);
+        if (reconfigSink && (RT_NULL != sink)) {
+            RTNodeAdapter::init(sink, codec->queryFormat(RT_PORT_OUTPUT));
+        }
+        nextBus->attachSink(sink, BUS_LINE_AUDIO);
+
+        retiredBus = mPlayerCtx->mRetiredBus;
+        mPlayerCtx->mRetiredBus = mNodeBus;
+        mNodeBus = nextBus;
+        rt_memcpy(&(mPlayerCtx->mMediaUri), &(mPlayerCtx->mNextUri), sizeof(RTMediaUri));
+        mPlayerCtx->mCurTimeUs  = 0;
+        mPlayerCtx->mTrickRate  = 1;
+        mPlayerCtx->mAudioEndUs = -1ll;
+    }
+    this->onPreparedDone();
+
+    // the item retired by last splice has been rendered completely
+    node_bus_destroy(retiredBus);
+
+    RTMessage* msg = new RTMessage(RT_MEDIA_INFO, RT_INFO_STARTED_AS_NEXT, 0, this);
+    mPlayerCtx->mLooper->post(msg, 0);
+    RT_LOGD("done, next item(%s) is started", mPlayerCtx->mMediaUri.mUri);
+    return RT_OK;
+}
+
+/*
+ * fallback of gapless splice: current item has been rendered to the end,
+ * because next item isn't ready in time or needs to reconfigure the sink.
+ */
+RT_RET RTNDKNodePlayer::onPlayNextItem() {
+    {
+        RtMutex::RtAutolock autoLock(mPlayerCtx->mPrepareLock);
+        while (mPlayerCtx->mNextBusy) {
+            mPlayerCtx->mPrepareCond->wait(mPlayerCtx->mPrepareLock);
+        }
+        if (!mPlayerCtx->mNextReady) {
+            return RT_ERR_BAD;
+        }
+    }
+
+    // shutdown thread of data delivering between plugins
+    if (RT_NULL != mPlayerCtx->mDeliverThread) {
+        mPlayerCtx->mDeliverThread->requestInterruption();
+        mPlayerCtx->mDeliverThread->join();
+        rt_safe_delete(mPlayerCtx->mDeliverThread);
+        mPlayerCtx->mDeliverThread = RT_NULL;
+    }
+
+    // audio track of current item isn't switched any more
+    cancelTrackSwitch();
+    RT_RET err = spliceNextItem(RT_TRUE);
+
+    // thread used for data transferring between plugins
+    mPlayerCtx->mDeliverThread = new RtThread(thread_deliver_proc, this);
+    mPlayerCtx->mDeliverThread->setName("BusDataProc");
+    mPlayerCtx->mDeliverThread->start();
+    return err;
+}
+
 RT_RET RTNDKNodePlayer::checkRuntime(const char* caller) {
     if ((RT_NULL == mPlayerCtx) || (RT_NULL == mNodeBus)) {
         RT_LOGE("fail to %s, context in null", caller);
@@ -634,7 +1552,7 @@ RT_RET RTNDKNodePlayer::checkRuntime(const char* caller) {
 
 RT_RET RTNDKNodePlayer::notifyListener(INT32 msg, INT32 ext1, INT32 ext2, void* ptr) {
     if (RT_NULL != mPlayerCtx->mListener) {
-        mPlayerCtx->mListener->notify(msg, ext1, ext1, ptr);
+        mPlayerCtx->mListener->notify(msg, ext1, ext2, ptr);
         return RT_OK;
     }
 
@@ -657,7 +1575,9 @@ RT_RET RTNDKNodePlayer::onEventReceived(struct RTMessage* msg) {
     INT32 arg2 = 0;
     switch (msg->getWhat()) {
       case RT_MEDIA_PLAYBACK_COMPLETE:
-        if (!mPlayerCtx->mLooping) {
+        if (!mPlayerCtx->mLooping && (RT_OK == this->onPlayNextItem())) {
+            RT_LOGE("player switch to next item.");
+        } else if (!mPlayerCtx->mLooping) {
             setCurState(RT_STATE_COMPLETE);
             this->notifyListener(RT_MEDIA_PLAYBACK_COMPLETE, 0, 0, RT_NULL);
             if (mPlayerCtx->mRT_Callback != RT_NULL) {
@@ -694,7 +1614,23 @@ RT_RET RTNDKNodePlayer::onEventReceived(struct RTMessage* msg) {
       case RT_MEDIA_BUFFERING_UPDATE:
       case RT_MEDIA_SET_VIDEO_SIZE:
       case RT_MEDIA_SKIPPED:
+        this->notifyListener(msg->getWhat(), arg1, arg2, RT_NULL);
+        break;
       case RT_MEDIA_INFO:
+        arg1 = msg->mData.mArgU32;
+        if ((RT_INFO_TRICK_PLAY_END == arg1) && (1 != mPlayerCtx->mTrickRate)) {
+            // demuxer plays from beginning, decoder leaves trick mode too
+            mPlayerCtx->mCurTimeUs = 0ll;
+            onTrickPlay(1);
+        }
+        if (RT_INFO_SEEK_FIRST_FRAME == arg1) {
+            arg2 = (INT32)(msg->mData.mArgU64 / 1000);
+            RT_LOGE("seek to first frame: %dms", arg2);
+        }
+        if (RT_INFO_TRACK_SWITCHED == arg1) {
+            arg2 = (INT32)(msg->mData.mArgU64 / 1000);
+            RT_LOGE("audio track is switched: %dms", arg2);
+        }
         this->notifyListener(msg->getWhat(), arg1, arg2, RT_NULL);
         break;
       default:
@@ -719,9 +1655,21 @@ RT_RET RTNDKNodePlayer::onCmdReceived(struct RTMessage* msg) {
       case RT_MEDIA_CMD_PREPARE:
         err = this->prepare();
         break;
+      case RT_MEDIA_CMD_PREPARE_ASYNC:
+        err = this->prepareAsync();
+        break;
+      case RT_MEDIA_CMD_SET_NEXT_DATASOURCE:
+        err = this->setNextDataSource(reinterpret_cast<RTMediaUri*>(msg->mData.mArgPtr));
+        break;
       case RT_MEDIA_CMD_SEEKTO:
         err = this->seekTo(msg->mData.mArgU64);
         break;
+      case RT_MEDIA_CMD_SET_TRICK_RATE:
+        err = this->setTrickRate((INT32)msg->mData.mArgU32);
+        break;
+      case RT_MEDIA_CMD_SELECT_TRACK:
+        err = this->selectTrack((INT32)msg->mData.mArgU32);
+        break;
       case RT_MEDIA_CMD_START:
         err = this->start();
         break;
@@ -784,16 +1732,49 @@ RT_RET RTNDKNodePlayer::writeData(const char * data, const UINT32 length, int fl
         } else {
             RT_LOGD("writeData err , sink null");
         }
-    } else if (RT_WRITEDATA_TS == flag) {
     } else {
-        if (RTTRACK_TYPE_VIDEO == type) {
-        } else {
+        // TS and ES are demuxed from push stream, demuxer probes format
+        RtMutex::RtAutolock autoLock(mPlayerCtx->mPushLock);
+        RTMediaPushStream* stream = mPlayerCtx->mPushStream;
+        if (RT_NULL == stream) {
+            RT_LOGE("writeData err, setDataSource(push://) first");
+            return RT_ERR_BAD;
+        }
+        if (0 == length) {
+            return stream->writeEos();
+        }
+        if (stream->write(reinterpret_cast<const UINT8*>(data), length) != (INT32)length) {
+            RT_LOGE("writeData err, push stream is aborted");
+            return RT_ERR_BAD;
         }
     }
     RT_LOGD("RTNDKNodePlayer::writeData OUT");
     return RT_OK;
 }
 
+/*
+ * zero copy version of writeData() for TS and ES, data is kept by demuxer
+ * until release is called on demuxer thread. data isn't released on error.
+ */
+RT_RET RTNDKNodePlayer::lendData(const char * data, const UINT32 length, int flag,
+                                 RT_WRITEDATA_RELEASE release, void *opaque) {
+    RT_ASSERT(RT_NULL != mPlayerCtx);
+    if (RT_WRITEDATA_PCM == flag) {
+        RT_LOGE("lendData err, pcm is unsupported");
+        return RT_ERR_UNIMPLIMENTED;
+    }
+    RtMutex::RtAutolock autoLock(mPlayerCtx->mPushLock);
+    RTMediaPushStream* stream = mPlayerCtx->mPushStream;
+    if (RT_NULL == stream) {
+        RT_LOGE("lendData err, setDataSource(push://) first");
+        return RT_ERR_BAD;
+    }
+    if (0 == length) {
+        return stream->writeEos();
+    }
+    return stream->lend(reinterpret_cast<const UINT8*>(data), length, release, opaque);
+}
+
 RT_RET RTNDKNodePlayer::setCallBack(RT_CALLBACK_T callback, int p_event, void *p_data) {
     RT_ASSERT(RT_NULL != mPlayerCtx);
     mPlayerCtx->mRT_Callback = callback;
@@ -808,13 +1789,119 @@ RT_RET RTNDKNodePlayer::setCodecMeta(void *p_metadata) {
     mNodeBus->registerMetadata(reinterpret_cast<RtMetaData *>(p_metadata));
 }
 
+/*
+ * pcm goes through stretcher when playback rate isn't 1, or stretched pcm is
+ * still left. trick play has its own pace, it isn't stretched.
+ * returns RT_TRUE if pcm of frame is taken by stretcher.
+ */
+RT_BOOL RTNDKNodePlayer::stretchAudioFrame(RTNode* decoder, RTMediaBuffer* frame, INT64 timeUs) {
+    float           rate    = mPlayerCtx->mPlaybackRate;
+    RTAudioStretch* stretch = mPlayerCtx->mStretch;
+    RT_BOOL         idle    = (RT_NULL == stretch)
+                               || ((0 == stretch->pendingInput()) && (0 == stretch->availableOutput()));
+    if ((1 != mPlayerCtx->mTrickRate) || ((1.0f == rate) && idle)) {
+        return RT_FALSE;
+    }
+
+    // pcm of ffmpeg decoder is always interleaved S16
+    INT32 sampleRate = 0;
+    INT32 channels   = 0;
+    RtMetaData* format = decoder->queryFormat(RT_PORT_OUTPUT);
+    if (RT_NULL != format) {
+        format->findInt32(kKeyACodecSampleRate, &sampleRate);
+        format->findInt32(kKeyACodecChannels, &channels);
+    }
+    if ((sampleRate <= 0) || (channels <= 0)) {
+        return RT_FALSE;
+    }
+    if ((RT_NULL == stretch) || !stretch->isCompatible(sampleRate, channels, RT_SAMPLE_FMT_S16)) {
+        rt_safe_delete(mPlayerCtx->mStretch);
+        stretch = new RTAudioStretch(sampleRate, channels, RT_SAMPLE_FMT_S16);
+        mPlayerCtx->mStretch = stretch;
+    }
+    stretch->setRate(rate);
+    if (frame->getLength() > 0) {
+        stretch->queueInput(frame->getData(), frame->getLength(), timeUs);
+    }
+    return RT_TRUE;
+}
+
+/*
+ * stretched pcm is sent to sink in buffers of pool, pts of each buffer is
+ * media time, so that position goes at playback rate.
+ * returns RT_TRUE if stretched pcm is waiting for sink.
+ */
+RT_BOOL RTNDKNodePlayer::renderAudioStretch(RTNode* sink) {
+    RTAudioStretch* stretch = mPlayerCtx->mStretch;
+    if (RT_NULL == stretch) {
+        return RT_FALSE;
+    }
+    if (mPlayerCtx->mStretchFlush) {
+        mPlayerCtx->mStretchFlush = RT_FALSE;
+        stretch->flush();
+    }
+    if (RT_NULL == mPlayerCtx->mStretchPool) {
+        RTMediaBufferPool* pool = new RTMediaBufferPool(STRETCH_POOL_COUNT, STRETCH_BUFFER_SIZE);
+        for (INT32 idx = 0; idx < STRETCH_POOL_COUNT; idx++) {
+            pool->registerBuffer(new RTMediaBuffer(STRETCH_BUFFER_SIZE));
+        }
+        pool->start();
+        mPlayerCtx->mStretchPool = pool;
+    }
+
+    RTMediaBufferPool* pool = mPlayerCtx->mStretchPool;
+    while ((stretch->availableOutput() > 0) && pool->hasBuffer()) {
+        RTMediaBuffer* buffer = RT_NULL;
+        if ((RT_OK != pool->acquireBuffer(&buffer, RT_FALSE, STRETCH_BUFFER_SIZE)) || (RT_NULL == buffer)) {
+            break;
+        }
+        INT64 ptsUs = stretch->getOutputPts();
+        INT32 bytes = stretch->readOutput(buffer->getData(), STRETCH_BUFFER_SIZE);
+        buffer->setRange(0, bytes);
+        buffer->setStatus(RT_MEDIA_BUFFER_STATUS_READY);
+        buffer->getMetaData()->setInt64(kKeyFramePts, ptsUs);
+        mPlayerCtx->mCurTimeUs = ptsUs;
+        RTNodeAdapter::pushBuffer(sink, buffer);
+    }
+    return (stretch->availableOutput() > STRETCH_BUFFER_SIZE) ? RT_TRUE : RT_FALSE;
+}
+
+/*
+ * all stretched pcm is rendered before EOS, tail shorter than one
+ * sequence of stretcher is dropped.
+ */
+void RTNDKNodePlayer::drainAudioStretch(RTNode* sink) {
+    RTAudioStretch* stretch = mPlayerCtx->mStretch;
+    if (RT_NULL == stretch) {
+        return;
+    }
+    while ((stretch->availableOutput() > 0) && !mPlayerCtx->mStretchFlush
+             && (mPlayerCtx->mDeliverThread->getState() == THREAD_LOOP)) {
+        renderAudioStretch(sink);
+        if (stretch->availableOutput() > 0) {
+            RtTime::sleepMs(2);
+        }
+    }
+    stretch->flush();
+}
+
 RT_RET RTNDKNodePlayer::startAudioPlayerProc() {
     RT_RET           err       = RT_OK;
     RTMediaBuffer* frame       = RT_NULL;
     RTMediaBuffer* esPacket    = RT_NULL;
 
+    // gapless playback: next item is fed after current demuxer reaches its end
+    RTNodeDemuxer*   nextDemuxer = RT_NULL;
+    RTNode*          nextDecoder = RT_NULL;
+    RTMediaBuffer*   nextPacket  = RT_NULL;
+    RT_BOOL          demuxerEos  = RT_FALSE;
+
     RTNode*          root      = mNodeBus->getRootNode(BUS_LINE_ROOT);
     RTNodeDemuxer*   demuxer   = reinterpret_cast<RTNodeDemuxer*>(root);
+    if (RT_NULL != demuxer) {
+        // demuxer tells the end of trick play
+        demuxer->setEventLooper(mPlayerCtx->mLooper);
+    }
 
     // find working decoder node
     RTNodeInfo nodeInfo;
@@ -850,9 +1937,43 @@ RT_RET RTNDKNodePlayer::startAudioPlayerProc() {
         }
 
         /**
-         * 1. acquire avail audio packet from demuxer
+         * 0. pick up next item, which is prerolled in background
+         */
+        if (demuxerEos && (RT_NULL == nextDecoder)) {
+            RtMutex::RtAutolock autoLock(mPlayerCtx->mPrepareLock);
+            if (mPlayerCtx->mNextReady) {
+                nextDemuxer = reinterpret_cast<RTNodeDemuxer*>(
+                                  mPlayerCtx->mNextBus->getRootNode(BUS_LINE_ROOT));
+                nextDecoder = mPlayerCtx->mNextBus->getRootNode(BUS_LINE_AUDIO);
+                nextDemuxer->setEventLooper(mPlayerCtx->mLooper);
+                nextDecoder->setEventLooper(mPlayerCtx->mLooper);
+            }
+        }
+
+        /**
+         * 0.1 switch audio track, codec of new track is prepared in background
          */
-        if (demuxer != RT_NULL) {
+        if (mPlayerCtx->mSwitchReady && (RT_NULL == nextDecoder) && (mPlayerCtx->mAudioEndUs >= 0)) {
+            if (esPacket) {
+                esPacket->release();
+                esPacket = RT_NULL;
+            }
+            decoder    = switchAudioTrack(decoder, audiosink);
+            demuxerEos = RT_FALSE;
+        }
+
+        /**
+         * 1. acquire avail audio packet from demuxer, or pre-decode next item
+         */
+        if ((RT_NULL != nextDecoder) && (RT_NULL != nextDemuxer)) {
+            if (RT_NULL == nextPacket) {
+                RTNodeAdapter::dequeCodecBuffer(nextDecoder, &nextPacket, RT_PORT_INPUT);
+            }
+            if ((RT_NULL != nextPacket) && (RT_OK == RTNodeAdapter::pullBuffer(nextDemuxer, &nextPacket))) {
+                RTNodeAdapter::pushBuffer(nextDecoder, nextPacket);
+                nextPacket = RT_NULL;
+            }
+        } else if (demuxer != RT_NULL) {
             INT32 audio_idx  = demuxer->queryTrackUsed(RTTRACK_TYPE_AUDIO);
             /**
              * 1.1 deqeue buffer from decoder object pool
@@ -865,7 +1986,15 @@ RT_RET RTNDKNodePlayer::startAudioPlayerProc() {
              */
             if (RT_NULL != esPacket) {
                 err = RTNodeAdapter::pullBuffer(demuxer, &esPacket);
+                INT32 pktIndex = audio_idx;
                 if (RT_OK == err) {
+                    esPacket->getMetaData()->findInt32(kKeyPacketIndex, &pktIndex);
+                }
+                if ((RT_OK == err) && (pktIndex != audio_idx)) {
+                    // packets of old track are pulled before demuxer switches audio track
+                    esPacket->release();
+                    esPacket = RT_NULL;
+                } else if (RT_OK == err) {
                     validAudioPkt = RT_TRUE;
                 } else if (RT_ERR_LIST_EMPTY != err) {
                     RT_LOGE("pull buffer failed from demuxer. err: %d", err);
@@ -877,12 +2006,13 @@ RT_RET RTNDKNodePlayer::startAudioPlayerProc() {
          * 2. push avail audio packet to decoder
          */
         if (validAudioPkt) {
-            if (DEBUG_FLAG) {
-                UINT32 size = 0;
-                INT32 eos   = 0;
-                size = esPacket->getSize();
-                esPacket->getMetaData()->findInt32(kKeyFrameEOS, &eos);
-                RT_LOGD_IF(DEBUG_FLAG, "audio es-packet(ptr=%p, size=%d, eos=%d)", esPacket, size, eos);
+            UINT32 size = 0;
+            INT32 eos   = 0;
+            size = esPacket->getSize();
+            esPacket->getMetaData()->findInt32(kKeyFrameEOS, &eos);
+            RT_LOGD_IF(DEBUG_FLAG, "audio es-packet(ptr=%p, size=%d, eos=%d)", esPacket, size, eos);
+            if (eos) {
+                demuxerEos = RT_TRUE;
             }
             // push es-packet to decoder
             RTNodeAdapter::pushBuffer(decoder, esPacket);
@@ -891,8 +2021,12 @@ RT_RET RTNDKNodePlayer::startAudioPlayerProc() {
         }
 
         /**
-         * 3. acquire avail frame from decoder
+         * 3. acquire avail frame from decoder, unless stretched pcm is waiting for sink
          */
+        if (renderAudioStretch(audiosink)) {
+            RtTime::sleepMs(2);
+            continue;
+        }
         err = RTNodeAdapter::pullBuffer(decoder, &frame);
         if (RT_OK != err && RT_ERR_LIST_EMPTY != err) {
             RT_LOGE("pull buffer failed from decoder. err: %d", err);
@@ -904,11 +2038,74 @@ RT_RET RTNDKNodePlayer::startAudioPlayerProc() {
                 INT64 timeUs = 0ll;
                 frame->getMetaData()->findInt32(kKeyFrameEOS, &eos);
                 frame->getMetaData()->findInt64(kKeyFramePts, &timeUs);
+                RT_BOOL switched = RT_FALSE;
+                if (!eos && (mPlayerCtx->mSwitchSpliceUs >= 0)) {
+                    if (!trimAudioFrame(decoder, frame, &timeUs)) {
+                        frame->release();
+                        frame = NULL;
+                        continue;
+                    }
+                    mPlayerCtx->mSwitchSpliceUs = -1ll;
+                    switched = RT_TRUE;
+                }
                 if (!eos) {
+                    mPlayerCtx->mAudioEndUs = timeUs + node_pcm_duration(decoder, frame->getLength());
+                }
+                if (switched) {
+                    INT64 latencyUs = RtTime::getNowTimeUs() - mPlayerCtx->mSwitchBeginUs;
+                    RTMessage* msg = new RTMessage(RT_MEDIA_INFO, RT_INFO_TRACK_SWITCHED, latencyUs, this);
+                    mPlayerCtx->mLooper->post(msg, 0);
+                }
+                RT_BOOL stretched = stretchAudioFrame(decoder, frame, timeUs);
+                if (!eos && !stretched) {
                     mPlayerCtx->mCurTimeUs = timeUs;
                 }
+                if (stretched) {
+                    if (!eos) {
+                        frame->release();
+                        frame = NULL;
+                        continue;
+                    }
+                    // pcm of EOS frame is stretched too, EOS follows all of it
+                    drainAudioStretch(audiosink);
+                    frame->setRange(0, 0);
+                }
                 RT_LOGD_IF(DEBUG_FLAG, "audio frame(ptr=0x%p, size=%d, timeUs=%lldms, eos=%d)",
                         frame->getData(), frame->getLength(), timeUs/1000, eos);
+                INT32 trickRate = mPlayerCtx->mTrickRate;
+                if (!eos && ((trickRate < 0) || (trickRate > TRICK_AUDIO_MUTE_RATE))) {
+                    // snippets of audio still pace playback, but they are muted
+                    rt_memset(frame->getData(), 0, frame->getLength());
+                }
+                if (eos && (RT_NULL != nextDecoder) && node_codec_compatible(decoder, nextDecoder)) {
+                    /**
+                     * 4. gapless splice: last pcm of current item is followed by
+                     *    first pcm of next item, without EOS and sink reconfig.
+                     */
+                    if (frame->getLength() > 0) {
+                        frame->getMetaData()->setInt32(kKeyFrameEOS, 0);
+                        RTNodeAdapter::pushBuffer(audiosink, frame);
+                    } else {
+                        frame->release();
+                    }
+                    frame = NULL;
+                    if (esPacket) {
+                        esPacket->release();
+                        esPacket = RT_NULL;
+                    }
+                    // audio track of current item isn't switched any more
+                    cancelTrackSwitch();
+                    spliceNextItem(RT_FALSE);
+
+                    demuxer     = nextDemuxer;
+                    decoder     = nextDecoder;
+                    esPacket    = nextPacket;
+                    nextDemuxer = RT_NULL;
+                    nextDecoder = RT_NULL;
+                    nextPacket  = RT_NULL;
+                    demuxerEos  = RT_FALSE;
+                    continue;
+                }
                 RTNodeAdapter::pushBuffer(audiosink, frame);
             }
 
@@ -919,6 +2116,9 @@ RT_RET RTNDKNodePlayer::startAudioPlayerProc() {
     if (esPacket) {
         esPacket->release();
     }
+    if (nextPacket) {
+        nextPacket->release();
+    }
 
     return RT_OK;
 }
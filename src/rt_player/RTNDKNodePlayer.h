@@ -44,9 +44,11 @@ class RTNDKNodePlayer : public RTMsgHandler {
 
     /* basic property operations */
     RT_RET    setLooping(RT_BOOL loop);
+    RT_RET    setPlaybackRate(float rate);
     RT_RET    setVideoSurfaceTexture(void* bufferProducer) { }
     RT_RET    setVideoSurface(void* surface) { }
     RT_RET    setListener(RTPlayerListener* listener);
+    RT_RET    setAudioSinkFile(const char* path);
 
     /* utils for multi-thread */
     RT_RET    post(const char* caller, RTMessage* msg);
@@ -62,8 +64,13 @@ class RTNDKNodePlayer : public RTMsgHandler {
     RT_RET    onMessageReceived(struct RTMessage* msg);
     RT_RET    startDataLooper();
     RT_RET    startAudioPlayerProc();
+    RT_RET    onPrepareAsync();
+    RT_RET    onPrerollNext();
+    RT_RET    onSwitchTrack();
     //  flag: PCM ES TS  type: video audio
     RT_RET    writeData(const char * data, const UINT32 length, int flag, int type);
+    RT_RET    lendData(const char * data, const UINT32 length, int flag,
+                       RT_WRITEDATA_RELEASE release, void *opaque);
 
     /* callback */
     RT_RET setCallBack(RT_CALLBACK_T callback, int p_event, void *p_data);
@@ -72,8 +79,21 @@ class RTNDKNodePlayer : public RTMsgHandler {
  private:
     RT_RET    postSeekIfNecessary();
     RT_RET    onSeekTo(INT64 usec);
+    RT_RET    onTrickPlay(INT32 rate);
     RT_RET    onPlaybackDone();
     RT_RET    onPreparedDone();
+    RT_RET    buildStreamline(RT_BOOL withCodecSink);
+    RT_RET    cancelPrepareAsync();
+    RT_RET    cancelPrerollNext();
+    RT_RET    closePushStream(RT_BOOL destroy);
+    RT_RET    spliceNextItem(RT_BOOL reconfigSink);
+    RT_RET    cancelTrackSwitch();
+    RTNode*   switchAudioTrack(RTNode* decoder, RTNode* sink);
+    RT_BOOL   trimAudioFrame(RTNode* decoder, RTMediaBuffer* frame, INT64* timeUs);
+    RT_BOOL   stretchAudioFrame(RTNode* decoder, RTMediaBuffer* frame, INT64 timeUs);
+    RT_BOOL   renderAudioStretch(RTNode* sink);
+    void      drainAudioStretch(RTNode* sink);
+    RT_RET    onPlayNextItem();
     RT_RET    checkRuntime(const char* caller);
     RT_RET    setCurState(UINT32 newState);
     RT_RET    onEventReceived(struct RTMessage* msg);
@@ -86,11 +106,15 @@ class RTNDKNodePlayer : public RTMsgHandler {
     RT_RET    release();
     RT_RET    reset();
     RT_RET    setDataSource(RTMediaUri *mediaUri);
+    RT_RET    setNextDataSource(RTMediaUri *mediaUri);
     RT_RET    prepare();
+    RT_RET    prepareAsync();
     RT_RET    start();
     RT_RET    pause();
     RT_RET    stop();
     RT_RET    seekTo(INT64 usec);
+    RT_RET    setTrickRate(INT32 rate);
+    RT_RET    selectTrack(INT32 index);
 
  private:
     struct NodePlayerContext* mPlayerCtx;
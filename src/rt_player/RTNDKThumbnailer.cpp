@@ -0,0 +1,278 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: thumbnail of media file, without player, sink and its threads.
+ *         one keyframe is decoded at reduced resolution and downscaled.
+ */
+
+#include "RTNDKThumbnailer.h"
+#include "FFAdapterFormat.h"  // NOLINT
+#include "FFAdapterCodec.h"   // NOLINT
+#include "RTImageScale.h"     // NOLINT
+#include "RTMediaBuffer.h"    // NOLINT
+#include "RTMediaData.h"      // NOLINT
+#include "RTMediaMetaKeys.h"  // NOLINT
+#include "rt_metadata.h"      // NOLINT
+#include "rt_mutex.h"         // NOLINT
+#include "rt_task.h"          // NOLINT
+#include "rt_taskpool.h"      // NOLINT
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "RTNDKThumbnailer"
+
+#ifdef DEBUG_FLAG
+#undef DEBUG_FLAG
+#endif
+#define DEBUG_FLAG 0x0
+
+#define THUMBNAIL_MAX_QUEUED        16
+#define THUMBNAIL_MAX_PACKETS       256                 // gives up if no frame after them
+#define THUMBNAIL_MAX_LOWRES        3
+#define THUMBNAIL_DECODE_SURFACES   4                   // references and current picture
+#define THUMBNAIL_POSTER_MAX_US     (15 * 1000000ll)
+
+struct RTThumbnailTask : public RtTask {
+    RTThumbnailTask(RTNDKThumbnailer* owner, const char* uri, INT32 index, INT64 timeUs,
+                    INT32 width, INT32 height, RT_THUMBNAIL_FUNC callback, void* opaque)
+            : mOwner(owner), mUri(uri), mIndex(index), mTimeUs(timeUs),
+              mWidth(width), mHeight(height), mCallback(callback), mOpaque(opaque) {
+        mID       = index;
+        mPriority = TASK_PRIOTRY_FIFO;
+    }
+    void   run_impl(void* args) {
+        RTThumbnail thumb;
+        RT_RET err = mOwner->extract(mUri, mTimeUs, mWidth, mHeight, &thumb);
+        if (RT_NULL != mCallback) {
+            mCallback(mOpaque, mIndex, err, (RT_OK == err) ? &thumb : RT_NULL);
+        }
+        RTNDKThumbnailer::freeThumbnail(&thumb);
+    }
+    void*  get_args() { return mOwner; }
+    char*  get_name() { return const_cast<char*>("ThumbnailTask"); }
+
+    RTNDKThumbnailer*  mOwner;
+    const char*        mUri;
+    INT32              mIndex;
+    INT64              mTimeUs;
+    INT32              mWidth;
+    INT32              mHeight;
+    RT_THUMBNAIL_FUNC  mCallback;
+    void*              mOpaque;
+};
+
+// fits in box with aspect ratio, sizes of yuv420p are even
+static void thumbnail_fit(INT32 srcW, INT32 srcH, INT32 boxW, INT32 boxH, INT32* width, INT32* height) {
+    if ((INT64)srcW * boxH > (INT64)srcH * boxW) {
+        *width  = boxW;
+        *height = (INT32)((INT64)srcH * boxW / srcW);
+    } else {
+        *width  = (INT32)((INT64)srcW * boxH / srcH);
+        *height = boxH;
+    }
+    *width  = RT_MAX(2, *width & ~1);
+    *height = RT_MAX(2, *height & ~1);
+}
+
+// decoder decodes 1/2^n of size, but not smaller than thumbnail
+static INT32 thumbnail_lowres(INT32 srcW, INT32 srcH, INT32 width, INT32 height) {
+    INT32 lowres = 0;
+    while ((lowres < THUMBNAIL_MAX_LOWRES)
+             && ((srcW >> (lowres + 1)) >= width) && ((srcH >> (lowres + 1)) >= height)) {
+        lowres++;
+    }
+    return lowres;
+}
+
+/*
+ * packets of video track are fed until the first picture, which is scaled
+ * from the planes of decoder directly.
+ */
+static RT_RET thumbnail_decode(FAFormatContext* fc, FACodecContext* codec, INT32 track,
+                               INT32 width, INT32 height, RTThumbnail* thumb) {
+    RT_RET         err      = RT_ERR_TIMEOUT;
+    RT_BOOL        draining = RT_FALSE;
+    FAVideoPicture picture;
+    for (INT32 count = 0; count < THUMBNAIL_MAX_PACKETS; count++) {
+        if (!draining) {
+            void* rawPkt = RT_NULL;
+            if (fa_format_packet_read(fc, &rawPkt) < 0) {
+                // end of file, decoder gives out what it holds
+                fa_format_packet_free(rawPkt);
+                fa_decode_send_packet(codec, RT_NULL);
+                draining = RT_TRUE;
+            } else if (fa_format_packet_type(rawPkt) == track) {
+                RTPacket pkt;
+                fa_format_packet_parse(fc, rawPkt, &pkt);
+                RTMediaBuffer* buffer = new RTMediaBuffer(pkt.mData, pkt.mSize);
+                buffer->getMetaData()->setInt64(kKeyPacketPts, pkt.mPts);
+                buffer->getMetaData()->setInt64(kKeyPacketDts, pkt.mDts);
+                fa_decode_send_packet(codec, buffer);
+                delete buffer;
+                rt_utils_packet_free(&pkt);
+            } else {
+                fa_format_packet_free(rawPkt);
+                continue;
+            }
+        }
+
+        err = fa_video_decode_peek(codec, &picture);
+        if (RT_ERR_TIMEOUT == err) {
+            continue;
+        }
+        if (RT_OK != err) {
+            break;
+        }
+        thumb->mSize = width * height * 3 / 2;
+        thumb->mData = rt_malloc_size(UINT8, thumb->mSize);
+        err = rt_image_scale_yuv420(picture.mPlane, picture.mStride, picture.mWidth, picture.mHeight,
+                                    thumb->mData, width, height);
+        thumb->mWidth  = width;
+        thumb->mHeight = height;
+        thumb->mPtsUs  = picture.mPts;
+        fa_video_decode_unref(codec);
+        break;
+    }
+    return err;
+}
+
+RTNDKThumbnailer::RTNDKThumbnailer(INT32 maxThreads, INT64 memoryBudget)
+        : mMaxThreads(maxThreads),
+          mBudget(memoryBudget),
+          mBudgetUsed(0ll),
+          mBudgetPeak(0ll) {
+    mBudgetLock = new RtMutex();
+    mBudgetCond = new RtCondition();
+}
+
+RTNDKThumbnailer::~RTNDKThumbnailer() {
+    rt_safe_delete(mBudgetCond);
+    rt_safe_delete(mBudgetLock);
+}
+
+RT_RET RTNDKThumbnailer::extract(const char *uri, INT64 timeUs, INT32 width, INT32 height,
+                                 RTThumbnail *thumb) {
+    if ((RT_NULL == uri) || (RT_NULL == thumb) || (width < 2) || (height < 2)) {
+        return RT_ERR_VALUE;
+    }
+    rt_memset(thumb, 0, sizeof(RTThumbnail));
+
+    FAFormatContext* fc = fa_format_open(uri);
+    if (RT_NULL == fc) {
+        RT_LOGE("fail to open %s", uri);
+        return RT_ERR_BAD;
+    }
+
+    RTTrackParms track;
+    rt_memset(&track, 0, sizeof(RTTrackParms));
+    INT32 index = fa_format_find_best_track(fc, RTTRACK_TYPE_VIDEO);
+    if ((index < 0) || (fa_format_query_track(fc, index, RTTRACK_TYPE_VIDEO, &track) < 0)
+          || (track.mVideoWidth <= 0) || (track.mVideoHeight <= 0)) {
+        RT_LOGE("no video track in %s", uri);
+        fa_format_close(fc);
+        return RT_ERR_VALUE;
+    }
+
+    INT32 thumbW, thumbH;
+    thumbnail_fit(track.mVideoWidth, track.mVideoHeight, width, height, &thumbW, &thumbH);
+
+    // not all decoders support lowres, budget is counted at full size
+    INT64 bytes  = (INT64)track.mVideoWidth * track.mVideoHeight * 3 / 2 * THUMBNAIL_DECODE_SURFACES
+                 + thumbW * thumbH * 3 / 2;
+    INT64 budget = acquireBudget(bytes);
+
+    if (timeUs < 0) {
+        timeUs = RT_MIN(fa_format_get_duraton(fc) / 10, THUMBNAIL_POSTER_MAX_US);
+    }
+    if (timeUs > 0) {
+        fa_format_seek_key(fc, timeUs, RT_TRUE);
+    }
+
+    RT_RET      err  = RT_ERR_UNKNOWN;
+    RtMetaData* meta = new RtMetaData();
+    rt_medatdata_from_trackpar(meta, &track);
+    meta->setInt32(kKeyVCodecLowres, thumbnail_lowres(track.mVideoWidth, track.mVideoHeight, thumbW, thumbH));
+    FACodecContext* codec = fa_decode_create(meta, RTTRACK_TYPE_VIDEO);
+    if (RT_NULL != codec) {
+        // only the keyframe is wanted, non-ref frames and loop filter are skipped
+        fa_decode_set_trick(codec, RT_TRUE);
+        err = thumbnail_decode(fc, codec, index, thumbW, thumbH, thumb);
+        fa_video_decode_destroy(&codec);
+    }
+    if (RT_OK != err) {
+        RT_LOGE("fail to decode %s, err: %d", uri, err);
+        freeThumbnail(thumb);
+    }
+
+    delete meta;
+    fa_format_close(fc);
+    releaseBudget(budget);
+    return err;
+}
+
+RT_RET RTNDKThumbnailer::extractBatch(const char **uris, INT32 count, INT64 timeUs,
+                                      INT32 width, INT32 height,
+                                      RT_THUMBNAIL_FUNC callback, void *opaque) {
+    if ((RT_NULL == uris) || (count <= 0)) {
+        return RT_ERR_VALUE;
+    }
+
+    RtTaskPool* pool = rt_taskpool_init(mMaxThreads, THUMBNAIL_MAX_QUEUED);
+    for (INT32 idx = 0; idx < count; idx++) {
+        RtTask* task = new RTThumbnailTask(this, uris[idx], idx, timeUs, width, height, callback, opaque);
+        if (RT_OK != rt_taskpool_push(pool, task)) {
+            delete task;
+            if (RT_NULL != callback) {
+                callback(opaque, idx, RT_ERR_BAD, RT_NULL);
+            }
+        }
+    }
+    // all tasks are done before threads exit
+    rt_taskpool_wait(pool);
+    return RT_OK;
+}
+
+void RTNDKThumbnailer::freeThumbnail(RTThumbnail *thumb) {
+    if (RT_NULL != thumb) {
+        rt_safe_free(thumb->mData);
+        thumb->mSize = 0;
+    }
+}
+
+INT64 RTNDKThumbnailer::getPeakMemory() {
+    RtMutex::RtAutolock autoLock(mBudgetLock);
+    return mBudgetPeak;
+}
+
+/*
+ * file larger than budget is decoded alone.
+ */
+INT64 RTNDKThumbnailer::acquireBudget(INT64 bytes) {
+    RtMutex::RtAutolock autoLock(mBudgetLock);
+    bytes = RT_MIN(bytes, mBudget);
+    while (mBudgetUsed + bytes > mBudget) {
+        mBudgetCond->wait(mBudgetLock);
+    }
+    mBudgetUsed += bytes;
+    mBudgetPeak  = RT_MAX(mBudgetPeak, mBudgetUsed);
+    return bytes;
+}
+
+void RTNDKThumbnailer::releaseBudget(INT64 bytes) {
+    RtMutex::RtAutolock autoLock(mBudgetLock);
+    mBudgetUsed -= bytes;
+    mBudgetCond->broadcast();
+}
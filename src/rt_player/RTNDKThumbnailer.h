@@ -0,0 +1,73 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: thumbnail of media file, without player, sink and its threads.
+ *         one keyframe is decoded at reduced resolution and downscaled.
+ */
+
+#ifndef SRC_RT_PLAYER_RTNDKTHUMBNAILER_H_
+#define SRC_RT_PLAYER_RTNDKTHUMBNAILER_H_
+
+#include "rt_header.h"       // NOLINT
+
+#define THUMBNAIL_DEFAULT_BUDGET    (64 * 1024 * 1024)
+
+class RtMutex;
+class RtCondition;
+
+typedef struct _RTThumbnail {
+    UINT8  *mData;          // yuv420p, planes are packed
+    INT32   mSize;
+    INT32   mWidth;
+    INT32   mHeight;
+    INT64   mPtsUs;         // time of decoded keyframe
+} RTThumbnail;
+
+/*
+ * called on worker thread, thumb is valid only in callback.
+ */
+typedef void (*RT_THUMBNAIL_FUNC)(void *opaque, INT32 index, RT_RET err, const RTThumbnail *thumb);
+
+class RTNDKThumbnailer {
+ public:
+    // 0 thread is one per cpu, budget bounds memory of decoding in parallel
+    explicit RTNDKThumbnailer(INT32 maxThreads = 0, INT64 memoryBudget = THUMBNAIL_DEFAULT_BUDGET);
+    ~RTNDKThumbnailer();
+
+    /*
+     * thumbnail fits in width x height and keeps aspect ratio,
+     * poster frame is picked if timeUs is negative.
+     */
+    RT_RET extract(const char *uri, INT64 timeUs, INT32 width, INT32 height, RTThumbnail *thumb);
+    RT_RET extractBatch(const char **uris, INT32 count, INT64 timeUs, INT32 width, INT32 height,
+                        RT_THUMBNAIL_FUNC callback, void *opaque);
+    static void freeThumbnail(RTThumbnail *thumb);
+
+    INT64  getPeakMemory();
+
+ private:
+    INT64  acquireBudget(INT64 bytes);
+    void   releaseBudget(INT64 bytes);
+
+ private:
+    INT32         mMaxThreads;
+    INT64         mBudget;
+    INT64         mBudgetUsed;
+    INT64         mBudgetPeak;
+    RtMutex      *mBudgetLock;
+    RtCondition  *mBudgetCond;
+};
+
+#endif  // SRC_RT_PLAYER_RTNDKTHUMBNAILER_H_
@@ -0,0 +1,755 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: transcoding of media file by node-bus, without sink and clock.
+ *         video is decoded and encoded, audio is copied to muxer.
+ */
+
+#include "RTNDKTranscoder.h"  // NOLINT
+#include "RTNDKMediaDef.h"    // NOLINT
+#include "RTNodeBus.h"        // NOLINT
+#include "RTNodeDemuxer.h"    // NOLINT
+#include "RTNodeMuxer.h"      // NOLINT
+#include "RTMediaBuffer.h"    // NOLINT
+#include "RTMediaBufferPool.h"  // NOLINT
+#include "RTMediaMetaKeys.h"  // NOLINT
+#include "RTMediaData.h"      // NOLINT
+#include "RTImageScale.h"     // NOLINT
+#include "FFAdapterFormat.h"  // NOLINT
+#include "FFAdapterCodec.h"   // NOLINT
+#include "rt_cpu_info.h"      // NOLINT
+#include "rt_dequeue.h"       // NOLINT
+#include "rt_mutex.h"         // NOLINT
+#include "rt_string_utils.h"  // NOLINT
+#include "rt_task.h"          // NOLINT
+#include "rt_taskpool.h"      // NOLINT
+#include "rt_thread.h"        // NOLINT
+#include "rt_time.h"          // NOLINT
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "RTNDKTranscoder"
+
+#ifdef DEBUG_FLAG
+#undef DEBUG_FLAG
+#endif
+#define DEBUG_FLAG 0x0
+
+#define TRANSCODE_AUDIO_PACKETS     32
+#define TRANSCODE_STALL_US          (10 * 1000000ll)   // gives up if no buffer is moved
+#define TRANSCODE_MAX_KEYFRAMES     65536
+#define TRANSCODE_SEGMENTS_PER_THREAD   2                  // sizes of segments differ, more of them balance threads
+#define TRANSCODE_MIN_SEGMENT_US    (2 * 1000000ll)
+#define TRANSCODE_DTS_STEP_US       1000                   // dts which goes back is pushed after the last one
+
+struct RTTranscodeSegment {
+    INT64       mStartDts;      // keyframe of segment, RT_INT64_MIN for the first one
+    INT64       mEndDts;        // keyframe of next segment, -1 for the last one
+    rt_deque   *mPackets;       // encoded packets, lent by encoder of segment
+    RT_BOOL     mDone;
+    RT_RET      mError;
+    UINT32      mFrames;
+};
+
+struct RTTranscodeJob {
+    const char          *mUri;
+    RtMetaData          *mEncodeMeta;   // shared by encoders of all segments
+    INT32                mAudioTrack;   // track of input which is copied, -1 if none
+    RTTranscodeSegment  *mSegments;
+    INT32                mCount;
+    RtMutex             *mLock;         // packets and states of segments
+    RtCondition         *mCond;
+};
+
+static void* transcode_feed_loop(void* ptr_transcoder) {
+    RTNDKTranscoder* transcoder = reinterpret_cast<RTNDKTranscoder*>(ptr_transcoder);
+    transcoder->feedTask();
+    return RT_NULL;
+}
+
+// packets of encoder are handed to writer, RT_ERR_END_OF_STREAM if encoder is drained
+static RT_RET segment_take_packets(RTTranscodeJob *job, RTTranscodeSegment *segment, FACodecContext *encoder) {
+    while (1) {
+        RTMediaBuffer *packet = new RTMediaBuffer(RT_NULL, 0);
+        RT_RET err = fa_encode_get_packet(encoder, packet);
+        INT32  eos = 0;
+        packet->getMetaData()->findInt32(kKeyFrameEOS, &eos);
+        if ((RT_OK != err) || eos) {
+            packet->release();
+            if (RT_ERR_TIMEOUT == err) {
+                return RT_OK;
+            }
+            return (RT_OK == err) ? RT_ERR_END_OF_STREAM : err;
+        }
+
+        RtMutex::RtAutolock autoLock(job->mLock);
+        deque_push(segment->mPackets, reinterpret_cast<void *>(packet));
+        job->mCond->broadcast();
+    }
+    return RT_OK;
+}
+
+// picture is scaled to size of encoder if it differs, planes of decoder are used otherwise
+static RT_RET segment_encode_picture(RTTranscodeJob *job, RTTranscodeSegment *segment, FACodecContext *encoder,
+                                     FAVideoPicture *picture, INT32 width, INT32 height, UINT8 **scaled) {
+    if ((picture->mWidth != width) || (picture->mHeight != height)) {
+        if (RT_NULL == *scaled) {
+            *scaled = rt_malloc_size(UINT8, width * height * 3 / 2);
+        }
+        rt_image_scale_yuv420(picture->mPlane, picture->mStride, picture->mWidth, picture->mHeight,
+                              *scaled, width, height);
+        picture->mPlane[0]  = *scaled;
+        picture->mPlane[1]  = *scaled + width * height;
+        picture->mPlane[2]  = picture->mPlane[1] + width * height / 4;
+        picture->mStride[0] = width;
+        picture->mStride[1] = width / 2;
+        picture->mStride[2] = width / 2;
+        picture->mWidth     = width;
+        picture->mHeight    = height;
+    }
+    RT_RET err = fa_encode_send_picture(encoder, picture);
+    if (RT_OK != err) {
+        return err;
+    }
+    segment->mFrames++;
+    return segment_take_packets(job, segment, encoder);
+}
+
+/*
+ * packets from keyframe of segment are decoded, and pictures of the segment
+ * are encoded by its own encoder. leading pictures of open gop of next
+ * segment come after its keyframe in decode order, but refer to this
+ * segment, so packets are fed until keyframe of next segment is decoded.
+ * the next segment decodes them too, but drops them for their pts.
+ */
+static RT_RET segment_transcode(RTTranscodeJob *job, RTTranscodeSegment *segment) {
+    FAFormatContext *fc = fa_format_open(job->mUri);
+    if (RT_NULL == fc) {
+        return RT_ERR_BAD;
+    }
+    RTTrackParms track;
+    rt_memset(&track, 0, sizeof(RTTrackParms));
+    INT32 index = fa_format_find_best_track(fc, RTTRACK_TYPE_VIDEO);
+    if ((index < 0) || (fa_format_query_track(fc, index, RTTRACK_TYPE_VIDEO, &track) < 0)) {
+        fa_format_close(fc);
+        return RT_ERR_VALUE;
+    }
+    if (segment->mStartDts > 0) {
+        fa_format_seek_key(fc, segment->mStartDts, RT_TRUE);
+    }
+
+    RtMetaData *decodeMeta = new RtMetaData();
+    RtMetaData *encodeMeta = new RtMetaData(*(job->mEncodeMeta));
+    rt_medatdata_from_trackpar(decodeMeta, &track);
+    FACodecContext *decoder = fa_decode_create(decodeMeta, RTTRACK_TYPE_VIDEO);
+    FACodecContext *encoder = fa_video_encode_create(encodeMeta);
+    RT_RET err = ((RT_NULL != decoder) && (RT_NULL != encoder)) ? RT_OK : RT_ERR_UNKNOWN;
+
+    INT32   width    = 0;
+    INT32   height   = 0;
+    UINT8  *scaled   = RT_NULL;
+    INT64   startPts = RT_INT64_MAX;
+    INT64   endPts   = RT_INT64_MAX;
+    RT_BOOL started  = RT_FALSE;
+    RT_BOOL ending   = RT_FALSE;
+    RT_BOOL draining = RT_FALSE;
+    encodeMeta->findInt32(kKeyVCodecWidth,  &width);
+    encodeMeta->findInt32(kKeyVCodecHeight, &height);
+    while (RT_OK == err) {
+        if (!draining) {
+            void *rawPkt = RT_NULL;
+            if (fa_format_packet_read(fc, &rawPkt) < 0) {
+                // end of file, decoder gives out what it holds
+                fa_format_packet_free(rawPkt);
+                fa_decode_send_packet(decoder, RT_NULL);
+                draining = RT_TRUE;
+            } else if (fa_format_packet_type(rawPkt) != index) {
+                fa_format_packet_free(rawPkt);
+                continue;
+            } else {
+                RTPacket pkt;
+                fa_format_packet_parse(fc, rawPkt, &pkt);
+                RT_BOOL key = (pkt.mFlags & RT_PACKET_FLAG_KEY) ? RT_TRUE : RT_FALSE;
+                if (!started && key && (pkt.mDts >= segment->mStartDts)) {
+                    started  = RT_TRUE;
+                    startPts = pkt.mPts;
+                }
+                if (!started) {
+                    rt_utils_packet_free(&pkt);
+                    continue;
+                }
+                if (!ending && key && (segment->mEndDts >= 0) && (pkt.mDts >= segment->mEndDts)) {
+                    // keyframe of next segment, pictures before it are encoded here
+                    endPts = pkt.mPts;
+                    ending = RT_TRUE;
+                }
+                RTMediaBuffer *buffer = new RTMediaBuffer(pkt.mData, pkt.mSize);
+                buffer->getMetaData()->setInt64(kKeyPacketPts, pkt.mPts);
+                buffer->getMetaData()->setInt64(kKeyPacketDts, pkt.mDts);
+                fa_decode_send_packet(decoder, buffer);
+                delete buffer;
+                rt_utils_packet_free(&pkt);
+            }
+        }
+
+        FAVideoPicture picture;
+        RT_RET ret = RT_OK;
+        while ((RT_OK == err) && (RT_OK == (ret = fa_video_decode_peek(decoder, &picture)))) {
+            if ((picture.mPts >= startPts) && (picture.mPts < endPts)) {
+                err = segment_encode_picture(job, segment, encoder, &picture, width, height, &scaled);
+            } else if (ending && !draining && (picture.mPts >= endPts)) {
+                // pictures come in pts order, no leading picture is left
+                fa_decode_send_packet(decoder, RT_NULL);
+                draining = RT_TRUE;
+            }
+            fa_video_decode_unref(decoder);
+        }
+        if (RT_ERR_END_OF_STREAM == ret) {
+            break;
+        }
+        if ((RT_OK == err) && (RT_ERR_TIMEOUT != ret)) {
+            err = ret;
+        }
+    }
+
+    // encoder is drained, its packets are all handed to writer
+    if (RT_OK == err) {
+        err = fa_encode_send_picture(encoder, RT_NULL);
+    }
+    if (RT_OK == err) {
+        err = segment_take_packets(job, segment, encoder);
+        err = (RT_ERR_END_OF_STREAM == err) ? RT_OK : err;
+    }
+
+    rt_safe_free(scaled);
+    fa_video_decode_destroy(&decoder);
+    fa_video_encode_destroy(&encoder);
+    delete decodeMeta;
+    delete encodeMeta;
+    fa_format_close(fc);
+    return err;
+}
+
+struct RTSegmentTask : public RtTask {
+    RTSegmentTask(RTTranscodeJob *job, INT32 index)
+            : mJob(job), mIndex(index) {
+        mID       = index;
+        mPriority = TASK_PRIOTRY_FIFO;
+    }
+    void   run_impl(void* args) {
+        RTTranscodeSegment *segment = &(mJob->mSegments[mIndex]);
+        RT_RET err = segment_transcode(mJob, segment);
+        RtMutex::RtAutolock autoLock(mJob->mLock);
+        segment->mError = err;
+        segment->mDone  = RT_TRUE;
+        mJob->mCond->broadcast();
+    }
+    void*  get_args() { return mJob; }
+    char*  get_name() { return const_cast<char*>("SegmentTask"); }
+
+    RTTranscodeJob  *mJob;
+    INT32            mIndex;
+};
+
+// audio packets until dts are copied, the first one after dts is kept in pending
+static RT_BOOL segment_copy_audio(FAFormatContext *input, FAFormatContext *output, INT32 track, INT32 index,
+                                  RTPacket *pending, INT64 dts) {
+    while (1) {
+        if (RT_NULL == pending->mRawPtr) {
+            void *rawPkt = RT_NULL;
+            if (fa_format_packet_read(input, &rawPkt) < 0) {
+                fa_format_packet_free(rawPkt);
+                return RT_TRUE;
+            }
+            if (fa_format_packet_type(rawPkt) != track) {
+                fa_format_packet_free(rawPkt);
+                continue;
+            }
+            fa_format_packet_parse(input, rawPkt, pending);
+        }
+        if (pending->mDts > dts) {
+            return RT_FALSE;
+        }
+        fa_format_packet_write(output, index, pending);
+        rt_utils_packet_free(pending);
+        rt_memset(pending, 0, sizeof(RTPacket));
+    }
+    return RT_FALSE;
+}
+
+RTNDKTranscoder::RTNDKTranscoder()
+        : mNodeBus(RT_NULL),
+          mDemuxer(RT_NULL),
+          mMuxer(RT_NULL),
+          mLineSize(0),
+          mFeedThread(RT_NULL),
+          mAudioPool(RT_NULL),
+          mVideoIndex(-1),
+          mAudioIndex(-1),
+          mFrameCount(0),
+          mDurationUs(0ll) {
+    rt_memset(mLine, 0, sizeof(mLine));
+    rt_memset(mPending, 0, sizeof(mPending));
+}
+
+RTNDKTranscoder::~RTNDKTranscoder() {
+    releaseNodes();
+}
+
+RT_RET RTNDKTranscoder::transcode(const char *input, const char *output, RtMetaData *option) {
+    if ((RT_NULL == input) || (RT_NULL == output)) {
+        return RT_ERR_VALUE;
+    }
+
+    RT_RET err = buildNodes(input, output, option);
+    if (RT_OK != err) {
+        releaseNodes();
+        return err;
+    }
+
+    mAudioPool->start();
+    mNodeBus->excuteCommand(RT_NODE_CMD_PREPARE);
+    mNodeBus->excuteCommand(RT_NODE_CMD_START);
+    mFeedThread = new RtThread(transcode_feed_loop, reinterpret_cast<void*>(this));
+    mFeedThread->setName("TranscodeFeed");
+    mFeedThread->start();
+
+    // no clock, frames and packets are moved as soon as downstream takes them
+    INT64 movedUs = RtTime::getNowTimeUs();
+    while (!mMuxer->queryEOS()) {
+        if (driveLine()) {
+            movedUs = RtTime::getNowTimeUs();
+            continue;
+        }
+        if (RtTime::getNowTimeUs() - movedUs > TRANSCODE_STALL_US) {
+            RT_LOGE("transcoding is stalled, frames: %d", mFrameCount);
+            err = RT_ERR_TIMEOUT;
+            break;
+        }
+        RtTime::sleepMs(1);
+    }
+
+    // feeder may wait for buffers of decoder, stop of nodes wakes it up
+    mFeedThread->requestInterruption();
+    mNodeBus->excuteCommand(RT_NODE_CMD_STOP);
+    mFeedThread->join();
+    mDurationUs = mMuxer->queryDuration();
+    RT_LOGD("done, transcode %s to %s, frames: %d duration: %lldms",
+             input, output, mFrameCount, mDurationUs / 1000);
+    releaseNodes();
+    return err;
+}
+
+INT64 RTNDKTranscoder::getDuration() {
+    return mDurationUs;
+}
+
+UINT32 RTNDKTranscoder::getFrameCount() {
+    return mFrameCount;
+}
+
+// segments are cut at the first keyframe after each equal part of duration
+static INT32 transcode_cut_segments(FAFormatContext *fc, INT32 track, INT32 count, RTTranscodeSegment *segments) {
+    INT64 *keyframes  = rt_malloc_array(INT64, TRANSCODE_MAX_KEYFRAMES);
+    INT32  keyCount   = fa_format_query_keyframes(fc, track, keyframes, TRANSCODE_MAX_KEYFRAMES);
+    INT64  durationUs = fa_format_get_duraton(fc);
+    INT64  lastKey    = RT_INT64_MIN;
+    INT32  cut        = 0;
+    for (INT32 part = 1, key = 0; (part < count) && (key < keyCount); part++) {
+        INT64 target = durationUs * part / count;
+        while ((key < keyCount) && ((keyframes[key] < target) || (keyframes[key] <= lastKey))) {
+            key++;
+        }
+        if (key >= keyCount) {
+            break;
+        }
+        segments[cut].mStartDts = lastKey;
+        segments[cut].mEndDts   = keyframes[key];
+        lastKey = keyframes[key];
+        cut++;
+    }
+    segments[cut].mStartDts = lastKey;
+    segments[cut].mEndDts   = -1;
+    rt_safe_free(keyframes);
+    return cut + 1;
+}
+
+RT_RET RTNDKTranscoder::transcodeSegments(const char *input, const char *output,
+                                          RtMetaData *option, INT32 maxThreads) {
+    if ((RT_NULL == input) || (RT_NULL == output)) {
+        return RT_ERR_VALUE;
+    }
+
+    FAFormatContext *source = fa_format_open(input);
+    if (RT_NULL == source) {
+        RT_LOGE("fail to open %s", input);
+        return RT_ERR_BAD;
+    }
+    RTTrackParms track;
+    rt_memset(&track, 0, sizeof(RTTrackParms));
+    INT32 videoTrack = fa_format_find_best_track(source, RTTRACK_TYPE_VIDEO);
+    if ((videoTrack < 0) || (fa_format_query_track(source, videoTrack, RTTRACK_TYPE_VIDEO, &track) < 0)) {
+        RT_LOGE("no video track in %s", input);
+        fa_format_close(source);
+        return RT_ERR_VALUE;
+    }
+
+    RTTranscodeJob job;
+    rt_memset(&job, 0, sizeof(RTTranscodeJob));
+    INT32 threads = (maxThreads > 0) ? maxThreads : (INT32)rt_cpu_count();
+    INT32 count   = (INT32)RT_MIN((INT64)threads * TRANSCODE_SEGMENTS_PER_THREAD,
+                                  fa_format_get_duraton(source) / TRANSCODE_MIN_SEGMENT_US);
+    count         = RT_MAX(count, 1);
+    job.mSegments = rt_malloc_array(RTTranscodeSegment, count);
+    rt_memset(job.mSegments, 0, sizeof(RTTranscodeSegment) * count);
+    job.mCount    = transcode_cut_segments(source, videoTrack, count, job.mSegments);
+    if (job.mCount < 2) {
+        RT_LOGD("no keyframes to cut %s, transcode it in one line", input);
+        rt_safe_free(job.mSegments);
+        fa_format_close(source);
+        return transcode(input, output, option);
+    }
+
+    FAFormatContext *sink = fa_format_open(output, FLAG_MUXER);
+    if (RT_NULL == sink) {
+        RT_LOGE("fail to open %s for muxer", output);
+        rt_safe_free(job.mSegments);
+        fa_format_close(source);
+        return RT_ERR_BAD;
+    }
+
+    // same parameters as encoder of node-bus, see RTNodeBus::autoBuildTranscode
+    RtMetaData *trackMeta = new RtMetaData();
+    rt_medatdata_from_trackpar(trackMeta, &track);
+    INT32 codecID   = RT_VIDEO_ID_AVC;
+    INT32 width     = track.mVideoWidth;
+    INT32 height    = track.mVideoHeight;
+    INT32 frameRate = 0;
+    INT32 gopSize   = 0;
+    INT64 bitrate   = 0;
+    if (RT_NULL != option) {
+        option->findInt32(kKeyCodecID, &codecID);
+        option->findInt32(kKeyVCodecWidth,  &width);
+        option->findInt32(kKeyVCodecHeight, &height);
+    }
+    job.mEncodeMeta = new RtMetaData();
+    job.mEncodeMeta->setInt32(kKeyCodecType, RTTRACK_TYPE_VIDEO);
+    job.mEncodeMeta->setInt32(kKeyCodecID, codecID);
+    job.mEncodeMeta->setInt32(kKeyVCodecWidth,  width);
+    job.mEncodeMeta->setInt32(kKeyVCodecHeight, height);
+    if (trackMeta->findInt32(kKeyVCodecFrameRate, &frameRate)) {
+        job.mEncodeMeta->setInt32(kKeyVCodecFrameRate, frameRate);
+    }
+    if ((RT_NULL != option) && option->findInt64(kKeyCodecBitrate, &bitrate)) {
+        job.mEncodeMeta->setInt64(kKeyCodecBitrate, bitrate);
+    }
+    if ((RT_NULL != option) && option->findInt32(kKeyVCodecGopSize, &gopSize)) {
+        job.mEncodeMeta->setInt32(kKeyVCodecGopSize, gopSize);
+    }
+    job.mEncodeMeta->setInt32(kKeyVCodecGlobalHeader, fa_format_need_global_header(sink));
+    rt_safe_delete(trackMeta);
+
+    // encoders of segments are the same, header of track is taken from a probe one
+    INT32 videoIndex = -1;
+    INT32 audioIndex = -1;
+    FACodecContext *probe = fa_video_encode_create(job.mEncodeMeta);
+    if (RT_NULL != probe) {
+        RtMetaData  *videoMeta = new RtMetaData();
+        RTTrackParms videoPar;
+        rt_memset(&videoPar, 0, sizeof(RTTrackParms));
+        fa_encode_query_format(probe, videoMeta);
+        rt_medatdata_goto_trackpar(videoMeta, &videoPar);
+        videoIndex = fa_format_add_stream(sink, &videoPar);
+        rt_safe_delete(videoMeta);
+        fa_video_encode_destroy(&probe);
+    }
+    job.mAudioTrack = fa_format_find_best_track(source, RTTRACK_TYPE_AUDIO);
+    if (job.mAudioTrack >= 0) {
+        RTTrackParms audioPar;
+        rt_memset(&audioPar, 0, sizeof(RTTrackParms));
+        fa_format_query_track(source, job.mAudioTrack, RTTRACK_TYPE_AUDIO, &audioPar);
+        audioIndex = fa_format_add_stream(sink, &audioPar);
+    }
+    if ((videoIndex < 0) || (fa_format_write_header(sink) < 0)) {
+        RT_LOGE("fail to write header of %s, video track: %d", output, videoIndex);
+        rt_safe_delete(job.mEncodeMeta);
+        rt_safe_free(job.mSegments);
+        fa_format_close(sink);
+        fa_format_close(source);
+        return RT_ERR_UNKNOWN;
+    }
+
+    job.mUri  = input;
+    job.mLock = new RtMutex();
+    job.mCond = new RtCondition();
+    RtTaskPool *pool = rt_taskpool_init(threads, job.mCount);
+    for (INT32 idx = 0; idx < job.mCount; idx++) {
+        job.mSegments[idx].mPackets = deque_create();
+        RtTask *task = new RTSegmentTask(&job, idx);
+        if (RT_OK != rt_taskpool_push(pool, task)) {
+            delete task;
+            job.mSegments[idx].mError = RT_ERR_BAD;
+            job.mSegments[idx].mDone  = RT_TRUE;
+        }
+    }
+
+    mFrameCount = 0;
+    mDurationUs = 0ll;
+    RT_RET err  = writeSegments(&job, source, sink, videoIndex, audioIndex);
+    rt_taskpool_wait(pool);
+    fa_format_write_trailer(sink);
+    RT_LOGD("done, transcode %s to %s in %d segments, frames: %d duration: %lldms",
+             input, output, job.mCount, mFrameCount, mDurationUs / 1000);
+
+    for (INT32 idx = 0; idx < job.mCount; idx++) {
+        deque_destory(&(job.mSegments[idx].mPackets));
+    }
+    rt_safe_delete(job.mCond);
+    rt_safe_delete(job.mLock);
+    rt_safe_delete(job.mEncodeMeta);
+    rt_safe_free(job.mSegments);
+    fa_format_close(sink);
+    fa_format_close(source);
+    return err;
+}
+
+/*
+ * packets of segments are written in order of segments. dts of encoder
+ * starts before pts of keyframe, so first dts of segment may go back,
+ * it is pushed after the last one. audio before each packet is copied.
+ */
+RT_RET RTNDKTranscoder::writeSegments(RTTranscodeJob *job, FAFormatContext *input, FAFormatContext *output,
+                                      INT32 videoIndex, INT32 audioIndex) {
+    RT_RET   err      = RT_OK;
+    INT64    lastDts  = RT_INT64_MIN;
+    RT_BOOL  audioEOS = (audioIndex < 0) ? RT_TRUE : RT_FALSE;
+    RTPacket audio;
+    rt_memset(&audio, 0, sizeof(RTPacket));
+    for (INT32 idx = 0; idx < job->mCount; idx++) {
+        RTTranscodeSegment *segment = &(job->mSegments[idx]);
+        while (1) {
+            RTMediaBuffer *packet = RT_NULL;
+            {
+                RtMutex::RtAutolock autoLock(job->mLock);
+                while ((0 == deque_size(segment->mPackets)) && !segment->mDone) {
+                    job->mCond->wait(job->mLock);
+                }
+                RT_DequeEntry entry = deque_pop(segment->mPackets);
+                packet = reinterpret_cast<RTMediaBuffer *>(entry.data);
+            }
+            if (RT_NULL == packet) {
+                // segment is done, and all of its packets are written
+                break;
+            }
+
+            RTPacket pkt;
+            rt_memset(&pkt, 0, sizeof(RTPacket));
+            packet->getMetaData()->findInt64(kKeyPacketPts, &pkt.mPts);
+            packet->getMetaData()->findInt64(kKeyPacketDts, &pkt.mDts);
+            packet->getMetaData()->findInt32(kKeyPacketFlag, &pkt.mFlags);
+            pkt.mData = reinterpret_cast<UINT8 *>(packet->getData());
+            pkt.mSize = packet->getLength();
+            if (pkt.mDts <= lastDts) {
+                pkt.mDts = lastDts + TRANSCODE_DTS_STEP_US;
+            }
+            pkt.mPts = RT_MAX(pkt.mPts, pkt.mDts);
+            lastDts  = pkt.mDts;
+
+            if (!audioEOS) {
+                audioEOS = segment_copy_audio(input, output, job->mAudioTrack, audioIndex, &audio, pkt.mDts);
+            }
+            if ((RT_OK == err) && (fa_format_packet_write(output, videoIndex, &pkt) < 0)) {
+                err = RT_ERR_UNKNOWN;
+            }
+            mDurationUs = RT_MAX(mDurationUs, pkt.mPts);
+            packet->release();
+        }
+
+        if (RT_OK != segment->mError) {
+            RT_LOGE("fail to transcode segment(%d), err: %d", idx, segment->mError);
+            err = (RT_OK == err) ? segment->mError : err;
+        }
+        mFrameCount += segment->mFrames;
+    }
+
+    if (!audioEOS) {
+        segment_copy_audio(input, output, job->mAudioTrack, audioIndex, &audio, RT_INT64_MAX);
+    }
+    return err;
+}
+
+RT_RET RTNDKTranscoder::buildNodes(const char *input, const char *output, RtMetaData *option) {
+    RTMediaUri uri;
+    rt_memset(&uri, 0, sizeof(RTMediaUri));
+    rt_str_snprintf(uri.mUri, sizeof(uri.mUri), "%s", input);
+
+    mNodeBus = new RTNodeBus();
+    RT_RET err = mNodeBus->autoBuild(&uri);
+    if (RT_OK != err) {
+        return err;
+    }
+    mDemuxer = reinterpret_cast<RTNodeDemuxer*>(mNodeBus->getRootNode(BUS_LINE_ROOT));
+
+    RtMetaData *meta = (RT_NULL != option) ? option : new RtMetaData();
+    meta->setCString(kKeySinkUri, output);
+    err = mNodeBus->autoBuildTranscode(meta);
+    if (meta != option) {
+        rt_safe_delete(meta);
+    }
+    if (RT_OK != err) {
+        return err;
+    }
+
+    for (RTNode *node = mNodeBus->getRootNode(BUS_LINE_VIDEO);
+            (RT_NULL != node) && (mLineSize < TRANSCODE_MAX_NODES); node = node->mNext) {
+        mLine[mLineSize++] = node;
+    }
+    mMuxer = reinterpret_cast<RTNodeMuxer*>(mLine[mLineSize - 1]);
+
+    // tracks of muxer: video of encoder, and audio of demuxer which is copied
+    mVideoIndex = mMuxer->addTrack(mLine[mLineSize - 2]->queryFormat(RT_PORT_OUTPUT));
+    INT32 audioTrack = mDemuxer->queryTrackUsed(RTTRACK_TYPE_AUDIO);
+    if (audioTrack >= 0) {
+        mAudioIndex = mMuxer->addTrack(mDemuxer->queryTrackMeta(audioTrack, RTTRACK_TYPE_AUDIO));
+    }
+    if (mVideoIndex < 0) {
+        RT_LOGE("fail to add video track to muxer");
+        return RT_ERR_UNKNOWN;
+    }
+
+    mAudioPool = new RTMediaBufferPool(TRANSCODE_AUDIO_PACKETS);
+    for (UINT32 idx = 0; idx < TRANSCODE_AUDIO_PACKETS; idx++) {
+        mAudioPool->registerBuffer(new RTMediaBuffer(RT_NULL, 0));
+    }
+    return RT_OK;
+}
+
+/*
+ * one step of video line, buffer of each node is pushed to next node.
+ * buffer refused by a full node is kept, and pushed again in next step.
+ */
+RT_BOOL RTNDKTranscoder::driveLine() {
+    RT_BOOL moved = RT_FALSE;
+    for (INT32 idx = 0; idx < mLineSize - 1; idx++) {
+        RTNode *next = mLine[idx + 1];
+        if (RT_NULL == mPending[idx]) {
+            if (RT_OK != RTNodeAdapter::pullBuffer(mLine[idx], &mPending[idx])) {
+                mPending[idx] = RT_NULL;
+                continue;
+            }
+            if (next == mMuxer) {
+                mPending[idx]->getMetaData()->setInt32(kKeyPacketIndex, mVideoIndex);
+            }
+        }
+        if (RT_OK != RTNodeAdapter::pushBuffer(next, mPending[idx])) {
+            continue;
+        }
+        if (RT_NODE_TYPE_ENCODER == next->queryStub()->mNodeType) {
+            mFrameCount++;
+        }
+        mPending[idx] = RT_NULL;
+        moved = RT_TRUE;
+    }
+    return moved;
+}
+
+// audio packets are copied, they are dropped if muxer refuses the track
+RT_RET RTNDKTranscoder::feedAudio() {
+    RTMediaBuffer *packet = RT_NULL;
+    if (!mAudioPool->hasBuffer() || (RT_OK != mAudioPool->acquireBuffer(&packet, RT_FALSE))) {
+        return RT_ERR_LIST_EMPTY;
+    }
+    packet->getMetaData()->setInt32(kKeyCodecType, RTTRACK_TYPE_AUDIO);
+    if (RT_OK != RTNodeAdapter::pullBuffer(mDemuxer, &packet)) {
+        packet->release();
+        return RT_ERR_LIST_EMPTY;
+    }
+
+    INT32 eos = 0;
+    packet->getMetaData()->findInt32(kKeyFrameEOS, &eos);
+    packet->getMetaData()->setInt32(kKeyPacketIndex, mAudioIndex);
+    while ((mAudioIndex >= 0) && (THREAD_LOOP == mFeedThread->getState())) {
+        if (RT_OK == RTNodeAdapter::pushBuffer(mMuxer, packet)) {
+            packet = RT_NULL;
+            break;
+        }
+        RtTime::sleepMs(1);
+    }
+    if (RT_NULL != packet) {
+        packet->release();
+    }
+    return eos ? RT_ERR_END_OF_STREAM : RT_OK;
+}
+
+RT_RET RTNDKTranscoder::feedTask() {
+    RTMediaBuffer *esPacket   = RT_NULL;
+    RT_BOOL        videoEOS   = RT_FALSE;
+    RT_BOOL        audioEOS   = (mDemuxer->queryTrackUsed(RTTRACK_TYPE_AUDIO) < 0) ? RT_TRUE : RT_FALSE;
+    while ((THREAD_LOOP == mFeedThread->getState()) && (!videoEOS || !audioEOS)) {
+        RT_BOOL moved = RT_FALSE;
+        if (!videoEOS) {
+            if (RT_NULL == esPacket) {
+                // waits for free buffers of decoder, backpressure of video line
+                RTNodeAdapter::dequeCodecBuffer(mLine[0], &esPacket, RT_PORT_INPUT);
+            }
+            if (RT_NULL != esPacket) {
+                esPacket->getMetaData()->setInt32(kKeyCodecType, RTTRACK_TYPE_VIDEO);
+                if (RT_OK == RTNodeAdapter::pullBuffer(mDemuxer, &esPacket)) {
+                    INT32 eos = 0;
+                    esPacket->getMetaData()->findInt32(kKeyFrameEOS, &eos);
+                    videoEOS = eos ? RT_TRUE : RT_FALSE;
+                    RTNodeAdapter::pushBuffer(mLine[0], esPacket);
+                    esPacket = RT_NULL;
+                    moved    = RT_TRUE;
+                }
+            }
+        }
+        if (!audioEOS) {
+            RT_RET err = feedAudio();
+            audioEOS   = (RT_ERR_END_OF_STREAM == err) ? RT_TRUE : RT_FALSE;
+            moved      = (RT_ERR_LIST_EMPTY != err) ? RT_TRUE : moved;
+        }
+        if (!moved) {
+            RtTime::sleepMs(1);
+        }
+    }
+
+    if (RT_NULL != esPacket) {
+        esPacket->release();
+    }
+    RT_LOGD("exit feeder, video EOS: %d audio EOS: %d", videoEOS, audioEOS);
+    return RT_OK;
+}
+
+void RTNDKTranscoder::releaseNodes() {
+    // pending buffers belong to pools of nodes, they are returned first
+    for (INT32 idx = 0; idx < TRANSCODE_MAX_NODES; idx++) {
+        if (RT_NULL != mPending[idx]) {
+            mPending[idx]->release();
+            mPending[idx] = RT_NULL;
+        }
+    }
+    if (RT_NULL != mNodeBus) {
+        mNodeBus->releaseNodes();
+    }
+    rt_safe_delete(mNodeBus);
+    rt_safe_delete(mAudioPool);
+    rt_safe_delete(mFeedThread);
+    rt_memset(mLine, 0, sizeof(mLine));
+    mLineSize = 0;
+    mDemuxer  = RT_NULL;
+    mMuxer    = RT_NULL;
+}
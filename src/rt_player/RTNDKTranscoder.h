@@ -0,0 +1,89 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: transcoding of media file by node-bus, without sink and clock.
+ *         video is decoded and encoded, audio is copied to muxer.
+ */
+
+#ifndef SRC_RT_PLAYER_RTNDKTRANSCODER_H_
+#define SRC_RT_PLAYER_RTNDKTRANSCODER_H_
+
+#include "rt_header.h"       // NOLINT
+
+#define TRANSCODE_MAX_NODES     8
+
+class RTNode;
+class RTNodeBus;
+class RTNodeDemuxer;
+class RTNodeMuxer;
+class RTMediaBuffer;
+class RTMediaBufferPool;
+class RtMetaData;
+class RtThread;
+struct FAFormatContext;
+struct RTTranscodeJob;
+
+class RTNDKTranscoder {
+ public:
+    RTNDKTranscoder();
+    ~RTNDKTranscoder();
+
+    /*
+     * blocks until trailer of output is written. nodes run as fast as they
+     * can, they are bounded by pools and queues of downstream nodes.
+     * option is passed to RTNodeBus::autoBuildTranscode, such as kKeyCodecID,
+     * kKeyCodecBitrate and kKeyVCodecWidth/kKeyVCodecHeight.
+     */
+    RT_RET transcode(const char *input, const char *output, RtMetaData *option = RT_NULL);
+
+    /*
+     * video is cut into segments at keyframes of index, and each segment is
+     * decoded and encoded by its own codecs on a thread of pool. packets are
+     * written in order of segments, audio is copied. 0 thread is one per cpu.
+     * falls back to transcode() if the input has no index or is too short.
+     */
+    RT_RET transcodeSegments(const char *input, const char *output,
+                             RtMetaData *option = RT_NULL, INT32 maxThreads = 0);
+
+    INT64  getDuration();       // media time of output, in us
+    UINT32 getFrameCount();     // frames encoded
+
+    // packets of demuxer to decoder and muxer, on feeder thread
+    RT_RET feedTask();
+
+ private:
+    RT_RET  buildNodes(const char *input, const char *output, RtMetaData *option);
+    RT_RET  writeSegments(RTTranscodeJob *job, FAFormatContext *input, FAFormatContext *output,
+                          INT32 videoIndex, INT32 audioIndex);
+    RT_RET  feedAudio();
+    RT_BOOL driveLine();
+    void    releaseNodes();
+
+ private:
+    RTNodeBus          *mNodeBus;
+    RTNodeDemuxer      *mDemuxer;
+    RTNodeMuxer        *mMuxer;
+    RTNode             *mLine[TRANSCODE_MAX_NODES];     // decoder to muxer
+    RTMediaBuffer      *mPending[TRANSCODE_MAX_NODES];  // refused by next node
+    INT32               mLineSize;
+    RtThread           *mFeedThread;
+    RTMediaBufferPool  *mAudioPool;
+    INT32               mVideoIndex;    // tracks of muxer
+    INT32               mAudioIndex;
+    UINT32              mFrameCount;
+    INT64               mDurationUs;
+};
+
+#endif  // SRC_RT_PLAYER_RTNDKTRANSCODER_H_
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_RT_TASK_INCLUDE_RT_EXECUTOR_H_
+#define SRC_RT_TASK_INCLUDE_RT_EXECUTOR_H_
+
+#include "rt_header.h" // NOLINT
+#include "rt_thread.h" // NOLINT
+
+/*
+ * RtJob is the work loop of a node. step runs once per schedule and returns
+ * the delay in us before next step, RT_JOB_DONE ends the job. a shared job
+ * is run by the workers of process-wide executor, others have own thread.
+ * step of a job never runs on two threads at once.
+ */
+#define RT_JOB_DONE         (-1)
+
+typedef struct _RtExecutorStat {
+    INT32   mWorkers;
+    INT32   mJobs;          // shared jobs which are created
+    INT32   mJobsQueued;    // shared jobs which wait for due time
+    UINT64  mSteps;
+} RtExecutorStat;
+
+class RtJob {
+ public:
+    typedef INT64 (*RtJobStep)(void*);
+
+    explicit RtJob(RtJobStep step, void* data = NULL);
+    ~RtJob();
+
+    void    setName(const char* name);
+    /**
+     * Both are taken by next start(), sched class is for own thread only,
+     * workers of executor are not changed by jobs.
+     */
+    void    setShared(RT_BOOL shared);
+    void    setSchedClass(RT_THREAD_CLASS cls);
+
+    RT_BOOL start();
+    /**
+     * Returns after running step is done, and step never runs again
+     * until start(). it is allowed in step of the job itself.
+     */
+    void    stop();
+    // runs next step at once, instead of after delay
+    void    wake();
+
+    RT_BOOL isShared();
+    RT_BOOL isRunning();
+
+ public:
+    void   *mData;
+};
+
+/*
+ * workers are created by first shared job, 0 means count of cpu.
+ * it takes effect before the first shared job only.
+ */
+RT_RET rt_executor_init(INT32 workers);
+RT_RET rt_executor_stat(RtExecutorStat *stat);
+
+#endif  // SRC_RT_TASK_INCLUDE_RT_EXECUTOR_H_
@@ -73,6 +73,10 @@ enum RTMediaCmd {
     RT_MEDIA_CMD_STOP,
     RT_MEDIA_CMD_PAUSE,
     RT_MEDIA_CMD_RESET,
+    RT_MEDIA_CMD_PREPARE_ASYNC,
+    RT_MEDIA_CMD_SET_NEXT_DATASOURCE,
+    RT_MEDIA_CMD_SET_TRICK_RATE,
+    RT_MEDIA_CMD_SELECT_TRACK,
     RT_MEDIA_CMD_MAX,
 };
 
@@ -108,6 +112,10 @@ static const rt_media_event mMediaCmds[] = {
     { RT_MEDIA_CMD_STOP,              "MEDIA_CMD_STOP" },
     { RT_MEDIA_CMD_PAUSE,             "MEDIA_CMD_PAUSE" },
     { RT_MEDIA_CMD_RESET,             "MEDIA_CMD_RESET" },
+    { RT_MEDIA_CMD_PREPARE_ASYNC,     "MEDIA_CMD_PREPARE_ASYNC" },
+    { RT_MEDIA_CMD_SET_NEXT_DATASOURCE, "MEDIA_CMD_SET_NEXT_DATASOURCE" },
+    { RT_MEDIA_CMD_SET_TRICK_RATE,    "MEDIA_CMD_SET_TRICK_RATE" },
+    { RT_MEDIA_CMD_SELECT_TRACK,      "MEDIA_CMD_SELECT_TRACK" },
 };
 #endif
 
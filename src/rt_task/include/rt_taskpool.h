@@ -62,6 +62,7 @@ typedef struct rt_taskpool {
     RT_Deque    *tasks;
     RT_Deque    *pthreads;
     RtMutex     *task_lock;
+    RtCondition *task_cond;
     RtPoolState state;
 } RtTaskPool;
 
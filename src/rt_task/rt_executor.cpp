@@ -0,0 +1,456 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: jobs of nodes on a fixed pool of workers, or on own threads
+ */
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "rt_executor"
+
+#include "rt_executor.h"      // NOLINT
+#include "rt_cpu_info.h"      // NOLINT
+#include "rt_log.h"           // NOLINT
+#include "rt_mem.h"           // NOLINT
+#include "rt_time.h"          // NOLINT
+#include "rt_string_utils.h"  // NOLINT
+
+#define JOB_NAME_LEN        16
+#define EXECUTOR_HEAP_INIT  64
+
+typedef enum {
+    JOB_IDLE = 0,
+    JOB_QUEUED,     // shared job waits in heap of executor
+    JOB_RUNNING,    // step of shared job runs, or own thread is alive
+} RtJobState;
+
+typedef struct _RtJobData {
+    RtJob::RtJobStep mStep;
+    void            *mPtrData;
+    char             mName[JOB_NAME_LEN];
+    RT_BOOL          mShared;       // mode of this run
+    RT_BOOL          mWantShared;   // taken by next start
+    RT_THREAD_CLASS  mClass;
+    RtJobState       mState;
+    RT_BOOL          mStarted;
+    RT_BOOL          mWake;
+    INT32            mRunner;       // thread which runs step
+    INT64            mDueUs;
+    INT32            mHeapIdx;
+
+    // own thread
+    RtThread        *mThread;
+    RtMutex         *mLock;
+    RtCondition     *mCond;
+} RtJobData;
+
+/*
+ * shared jobs are kept in a min-heap of due time, a job is out of heap
+ * while its step runs, so that it is never taken by two workers.
+ */
+typedef struct _RtExecutor {
+    RtMutex         *mLock;
+    RtCondition     *mCond;         // workers wait for due job
+    RtCondition     *mDoneCond;     // stop waits for running step
+    RtThread       **mWorkers;
+    INT32            mWorkerCount;
+    RtJobData      **mHeap;
+    INT32            mHeapSize;
+    INT32            mHeapCap;
+    INT32            mJobs;
+    UINT64           mSteps;
+} RtExecutor;
+
+static RtExecutor *gExecutor        = RT_NULL;
+static INT32       gExecutorWorkers = 0;
+
+static RtMutex* executor_init_lock() {
+    static RtMutex *lock = new RtMutex();
+    return lock;
+}
+
+static void executor_heap_swap(RtExecutor *executor, INT32 a, INT32 b) {
+    RtJobData *job = executor->mHeap[a];
+    executor->mHeap[a] = executor->mHeap[b];
+    executor->mHeap[b] = job;
+    executor->mHeap[a]->mHeapIdx = a;
+    executor->mHeap[b]->mHeapIdx = b;
+}
+
+static void executor_heap_up(RtExecutor *executor, INT32 idx) {
+    while (idx > 0) {
+        INT32 parent = (idx - 1) / 2;
+        if (executor->mHeap[parent]->mDueUs <= executor->mHeap[idx]->mDueUs) {
+            break;
+        }
+        executor_heap_swap(executor, parent, idx);
+        idx = parent;
+    }
+}
+
+static void executor_heap_down(RtExecutor *executor, INT32 idx) {
+    while (RT_TRUE) {
+        INT32 least = idx;
+        INT32 left  = idx * 2 + 1;
+        INT32 right = left + 1;
+        if ((left < executor->mHeapSize)
+              && (executor->mHeap[left]->mDueUs < executor->mHeap[least]->mDueUs)) {
+            least = left;
+        }
+        if ((right < executor->mHeapSize)
+              && (executor->mHeap[right]->mDueUs < executor->mHeap[least]->mDueUs)) {
+            least = right;
+        }
+        if (least == idx) {
+            break;
+        }
+        executor_heap_swap(executor, least, idx);
+        idx = least;
+    }
+}
+
+static RT_RET executor_heap_push(RtExecutor *executor, RtJobData *job) {
+    if (executor->mHeapSize == executor->mHeapCap) {
+        INT32       cap  = executor->mHeapCap * 2;
+        RtJobData **heap = rt_realloc(executor->mHeap, RtJobData *, cap);
+        if (RT_NULL == heap) {
+            return RT_ERR_MALLOC;
+        }
+        executor->mHeap    = heap;
+        executor->mHeapCap = cap;
+    }
+    job->mHeapIdx = executor->mHeapSize++;
+    job->mState   = JOB_QUEUED;
+    executor->mHeap[job->mHeapIdx] = job;
+    executor_heap_up(executor, job->mHeapIdx);
+    executor->mCond->signal();
+    return RT_OK;
+}
+
+static void executor_heap_remove(RtExecutor *executor, RtJobData *job) {
+    INT32 idx  = job->mHeapIdx;
+    INT32 last = --executor->mHeapSize;
+    if (idx != last) {
+        executor->mHeap[idx] = executor->mHeap[last];
+        executor->mHeap[idx]->mHeapIdx = idx;
+        executor_heap_down(executor, idx);
+        executor_heap_up(executor, idx);
+    }
+    job->mHeapIdx = -1;
+    job->mState   = JOB_IDLE;
+}
+
+static void* executor_loop(void *arg) {
+    RtExecutor *executor = reinterpret_cast<RtExecutor *>(arg);
+    INT32       tid      = RtThread::getThreadID();
+    RtMutex::RtAutolock autoLock(executor->mLock);
+    while (RT_TRUE) {
+        if (0 == executor->mHeapSize) {
+            executor->mCond->wait(executor->mLock);
+            continue;
+        }
+        RtJobData *job   = executor->mHeap[0];
+        INT64      nowUs = RtTime::getNowTimeUs();
+        if (job->mDueUs > nowUs) {
+            executor->mCond->timedwait(executor->mLock, job->mDueUs - nowUs);
+            continue;
+        }
+
+        executor_heap_remove(executor, job);
+        job->mState  = JOB_RUNNING;
+        job->mRunner = tid;
+        job->mWake   = RT_FALSE;
+        executor->mLock->unlock();
+        INT64 delayUs = job->mStep(job->mPtrData);
+        executor->mLock->lock();
+        executor->mSteps++;
+        job->mRunner = 0;
+
+        if ((RT_JOB_DONE == delayUs) || !job->mStarted) {
+            job->mState   = JOB_IDLE;
+            job->mStarted = RT_FALSE;
+            executor->mDoneCond->broadcast();
+            continue;
+        }
+        job->mDueUs = job->mWake ? nowUs : (RtTime::getNowTimeUs() + RT_MAX(delayUs, 0ll));
+        if (RT_OK != executor_heap_push(executor, job)) {
+            RT_LOGE("fail to queue job(%s), it is stopped", job->mName);
+            job->mState   = JOB_IDLE;
+            job->mStarted = RT_FALSE;
+            executor->mDoneCond->broadcast();
+        }
+    }
+    return RT_NULL;
+}
+
+static RtExecutor* executor_get() {
+    RtMutex::RtAutolock autoLock(executor_init_lock());
+    if (RT_NULL != gExecutor) {
+        return gExecutor;
+    }
+
+    RtExecutor *executor = rt_malloc(RtExecutor);
+    if (RT_NULL == executor) {
+        return RT_NULL;
+    }
+    rt_memset(executor, 0, sizeof(RtExecutor));
+    executor->mWorkerCount = (gExecutorWorkers > 0) ? gExecutorWorkers : (INT32)rt_cpu_count();
+    executor->mWorkerCount = RT_MAX(executor->mWorkerCount, 1);
+    executor->mHeapCap     = EXECUTOR_HEAP_INIT;
+    executor->mHeap        = rt_malloc_array(RtJobData *, executor->mHeapCap);
+    executor->mWorkers     = rt_malloc_array(RtThread *, executor->mWorkerCount);
+    if ((RT_NULL == executor->mHeap) || (RT_NULL == executor->mWorkers)) {
+        rt_safe_free(executor->mHeap);
+        rt_safe_free(executor->mWorkers);
+        rt_safe_free(executor);
+        return RT_NULL;
+    }
+    executor->mLock     = new RtMutex();
+    executor->mCond     = new RtCondition();
+    executor->mDoneCond = new RtCondition();
+
+    // workers live as long as process
+    for (INT32 idx = 0; idx < executor->mWorkerCount; idx++) {
+        char name[JOB_NAME_LEN];
+        rt_str_snprintf(name, sizeof(name), "rt_exec_%d", idx);
+        executor->mWorkers[idx] = new RtThread(executor_loop, executor);
+        executor->mWorkers[idx]->setName(name);
+        executor->mWorkers[idx]->start();
+    }
+    RT_LOGD("done, executor with %d workers", executor->mWorkerCount);
+    gExecutor = executor;
+    return gExecutor;
+}
+
+RT_RET rt_executor_init(INT32 workers) {
+    RtMutex::RtAutolock autoLock(executor_init_lock());
+    if (RT_NULL != gExecutor) {
+        return (workers == gExecutor->mWorkerCount) ? RT_OK : RT_ERR_BAD;
+    }
+    gExecutorWorkers = workers;
+    return RT_OK;
+}
+
+RT_RET rt_executor_stat(RtExecutorStat *stat) {
+    if (RT_NULL == stat) {
+        return RT_ERR_NULL_PTR;
+    }
+    rt_memset(stat, 0, sizeof(RtExecutorStat));
+    RtExecutor *executor = RT_NULL;
+    {
+        RtMutex::RtAutolock autoLock(executor_init_lock());
+        executor = gExecutor;
+    }
+    if (RT_NULL != executor) {
+        RtMutex::RtAutolock autoLock(executor->mLock);
+        stat->mWorkers    = executor->mWorkerCount;
+        stat->mJobs       = executor->mJobs;
+        stat->mJobsQueued = executor->mHeapSize;
+        stat->mSteps      = executor->mSteps;
+    }
+    return RT_OK;
+}
+
+/*
+ * own thread runs steps until job is stopped, delay is a timed wait,
+ * so that wake() and stop() don't wait for it.
+ */
+static void* job_thread_loop(void *arg) {
+    RtJobData *job = reinterpret_cast<RtJobData *>(arg);
+    RtMutex::RtAutolock autoLock(job->mLock);
+    job->mRunner = RtThread::getThreadID();
+    while (job->mStarted) {
+        job->mWake = RT_FALSE;
+        job->mLock->unlock();
+        INT64 delayUs = job->mStep(job->mPtrData);
+        job->mLock->lock();
+        if (RT_JOB_DONE == delayUs) {
+            break;
+        }
+        if ((delayUs > 0) && job->mStarted && !job->mWake) {
+            job->mCond->timedwait(job->mLock, delayUs);
+        }
+    }
+    job->mRunner  = 0;
+    job->mStarted = RT_FALSE;
+    job->mState   = JOB_IDLE;
+    return RT_NULL;
+}
+
+static RtJobData* job_data(void *data) {
+    return reinterpret_cast<RtJobData *>(data);
+}
+
+RtJob::RtJob(RtJobStep step, void* data) {
+    RtJobData *job = rt_malloc(RtJobData);
+    RT_ASSERT(RT_NULL != job);
+    rt_memset(job, 0, sizeof(RtJobData));
+    job->mStep     = step;
+    job->mPtrData  = data;
+    job->mClass    = RT_THREAD_CLASS_DEFAULT;
+    job->mState    = JOB_IDLE;
+    job->mHeapIdx  = -1;
+    job->mLock     = new RtMutex();
+    job->mCond     = new RtCondition();
+    mData = job;
+    setName("job-?");
+}
+
+RtJob::~RtJob() {
+    RtJobData *job = job_data(mData);
+    if (RT_NULL == job) {
+        return;
+    }
+    stop();
+    if (job->mShared) {
+        RtExecutor *executor = executor_get();
+        RtMutex::RtAutolock autoLock(executor->mLock);
+        executor->mJobs--;
+    }
+    rt_safe_delete(job->mThread);
+    rt_safe_delete(job->mCond);
+    rt_safe_delete(job->mLock);
+    rt_safe_free(mData);
+}
+
+void RtJob::setName(const char* name) {
+    RtJobData *job = job_data(mData);
+    rt_str_snprintf(job->mName, JOB_NAME_LEN, "%s", name);
+    if (RT_NULL != job->mThread) {
+        job->mThread->setName(job->mName);
+    }
+}
+
+void RtJob::setShared(RT_BOOL shared) {
+    job_data(mData)->mWantShared = shared;
+}
+
+void RtJob::setSchedClass(RT_THREAD_CLASS cls) {
+    job_data(mData)->mClass = cls;
+}
+
+RT_BOOL RtJob::isShared() {
+    return job_data(mData)->mShared;
+}
+
+RT_BOOL RtJob::isRunning() {
+    RtJobData *job = job_data(mData);
+    RtMutex   *lock = job->mShared ? executor_get()->mLock : job->mLock;
+    RtMutex::RtAutolock autoLock(lock);
+    return (JOB_IDLE != job->mState) ? RT_TRUE : RT_FALSE;
+}
+
+RT_BOOL RtJob::start() {
+    RtJobData *job = job_data(mData);
+    RT_BOOL    shared = job->mWantShared;
+    if ((shared != job->mShared) && isRunning()) {
+        // mode is changed by next start after stop
+        shared = job->mShared;
+    }
+
+    if (shared) {
+        RtExecutor *executor = executor_get();
+        if (RT_NULL == executor) {
+            return RT_FALSE;
+        }
+        RtMutex::RtAutolock autoLock(executor->mLock);
+        if (!job->mShared) {
+            job->mShared = RT_TRUE;
+            executor->mJobs++;
+        }
+        job->mStarted = RT_TRUE;
+        if (JOB_IDLE == job->mState) {
+            job->mDueUs = RtTime::getNowTimeUs();
+            return (RT_OK == executor_heap_push(executor, job)) ? RT_TRUE : RT_FALSE;
+        }
+        return RT_TRUE;
+    }
+
+    if (job->mShared) {
+        RtExecutor *executor = executor_get();
+        RtMutex::RtAutolock autoLock(executor->mLock);
+        executor->mJobs--;
+        job->mShared = RT_FALSE;
+    }
+    {
+        RtMutex::RtAutolock autoLock(job->mLock);
+        if (JOB_IDLE != job->mState) {
+            job->mStarted = RT_TRUE;
+            return RT_TRUE;
+        }
+    }
+    if (RT_NULL == job->mThread) {
+        job->mThread = new RtThread(job_thread_loop, job);
+        job->mThread->setName(job->mName);
+    }
+    // thread of last run may exit by itself
+    job->mThread->join();
+    job->mStarted = RT_TRUE;
+    job->mState   = JOB_RUNNING;
+    job->mThread->setSchedClass(job->mClass);
+    if (!job->mThread->start()) {
+        job->mStarted = RT_FALSE;
+        job->mState   = JOB_IDLE;
+        return RT_FALSE;
+    }
+    return RT_TRUE;
+}
+
+void RtJob::stop() {
+    RtJobData *job = job_data(mData);
+    INT32      tid = RtThread::getThreadID();
+    if (job->mShared) {
+        RtExecutor *executor = executor_get();
+        RtMutex::RtAutolock autoLock(executor->mLock);
+        job->mStarted = RT_FALSE;
+        if (JOB_QUEUED == job->mState) {
+            executor_heap_remove(executor, job);
+        }
+        while ((JOB_RUNNING == job->mState) && (tid != job->mRunner)) {
+            executor->mDoneCond->wait(executor->mLock);
+        }
+        return;
+    }
+
+    {
+        RtMutex::RtAutolock autoLock(job->mLock);
+        job->mStarted = RT_FALSE;
+        job->mCond->signal();
+        if ((JOB_IDLE == job->mState) || (tid == job->mRunner)) {
+            return;
+        }
+    }
+    job->mThread->join();
+}
+
+void RtJob::wake() {
+    RtJobData *job = job_data(mData);
+    if (job->mShared) {
+        RtExecutor *executor = executor_get();
+        RtMutex::RtAutolock autoLock(executor->mLock);
+        if (JOB_QUEUED == job->mState) {
+            job->mDueUs = RtTime::getNowTimeUs();
+            executor_heap_up(executor, job->mHeapIdx);
+            executor->mCond->signal();
+        } else if (JOB_RUNNING == job->mState) {
+            job->mWake = RT_TRUE;
+        }
+        return;
+    }
+    RtMutex::RtAutolock autoLock(job->mLock);
+    job->mWake = RT_TRUE;
+    job->mCond->signal();
+}
@@ -21,6 +21,8 @@
 #include "rt_message.h"       // NOLINT
 #include "rt_time.h"          // NOLINT
 #include "rt_string_utils.h"  // NOLINT
+#include "rt_trace.h"         // NOLINT
+#include "rt_task.h"          // NOLINT
 
 #ifdef LOG_TAG
 #undef LOG_TAG
@@ -167,7 +169,9 @@ RT_BOOL RTMsgLooper::msgLoop() {
             if (msg->getTarget() == RT_NULL && mHandler) {
                 msg->setTarget(mHandler);
             }
+            RT_TRACE_BEGIN("looper", "deliver message");
             err = msg->deliver();
+            RT_TRACE_END("looper", "deliver message");
             if (RT_NULL != msg->mDoneListener) {
                  msg->mDoneListener(this, msg->getWhat(), err);
             }
@@ -193,6 +197,9 @@ void* rt_thread_looper(void* ptr_this) {
 RT_RET RTMsgLooper::start(INT32 priority) {
     mThread = new RtThread(rt_thread_looper, reinterpret_cast<void*>(this));
     mThread->setName(rt_str_to_char(mName));
+    if (TASK_PRIOTRY_RT == priority) {
+        mThread->setSchedClass(RT_THREAD_CLASS_REALTIME);
+    }
     mThread->start();
     return RT_OK;
 }
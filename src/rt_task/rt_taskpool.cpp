@@ -45,6 +45,7 @@ RtTaskPool* rt_taskpool_init(UINT32 max_thread_num, UINT32 max_task_num) {
     taskpool->max_task_num    = max_task_num;
     taskpool->state           = kRunning_State;
     taskpool->task_lock       = new RtMutex();
+    taskpool->task_cond       = new RtCondition();
 
     RT_LOGT("Create Taskpool(max_thread_num=%d, max_task_num=%d)",
                     max_thread_num, max_task_num);
@@ -68,25 +69,25 @@ INT8 rt_taskpool_push(
         RT_BOOL header/*=RT_FALSE*/) {
     RT_ASSERT(RT_NULL != taskpool);
 
+    RtMutex::RtAutolock autoLock(taskpool->task_lock);
+    // pusher is blocked until a worker takes one task from full pool
+    while ((kRunning_State == taskpool->state)
+            && (taskpool->cur_task_num == taskpool->max_task_num)) {
+        taskpool->task_cond->wait(taskpool->task_lock);
+    }
     if (kRunning_State != taskpool->state) {
         return RT_ERR_BAD;
     }
 
-    while ((taskpool->cur_task_num == taskpool->max_task_num)) {
-        /* RT_LOGT("Task Pool is Full..."); */
-        RtTime::sleepUs(5000);
-    }
-
-    taskpool->task_lock->lock();
     INT8 err = RT_ERR_BAD;
     err = (RT_TRUE == header) ?
         deque_push_head(taskpool->tasks, reinterpret_cast<void*>(task)) :
         deque_push_tail(taskpool->tasks, reinterpret_cast<void*>(task));
     if (RT_OK == err) {
         taskpool->cur_task_num++;
+        taskpool->task_cond->broadcast();
     }
-    taskpool->task_lock->unlock();
-    RT_LOGE("Task(%p,id:%02d/busy:%02d/wait:%02d/max:%02d)"
+    RT_LOGD("Task(%p,id:%02d/busy:%02d/wait:%02d/max:%02d)"
             " be pushed to TaskPool",
                  task, task->get_id(), taskpool->busy_task_num,
                  taskpool->cur_task_num, taskpool->max_task_num);
@@ -114,7 +115,12 @@ void rt_taskpool_resume(RtTaskPool *taskpool) {
 void rt_taskpool_wait(RtTaskPool *taskpool) {
     // Destory Thread Deque
     RT_Deque* threads   = taskpool->pthreads;
-    taskpool->state = kWaiting_State;
+    {
+        // wake up idle workers, they exit once all tasks are done
+        RtMutex::RtAutolock autoLock(taskpool->task_lock);
+        taskpool->state = kWaiting_State;
+        taskpool->task_cond->broadcast();
+    }
     for (UINT32 idx = 0; idx < threads->size; idx++) {
         RtThread* thread =
             reinterpret_cast<RtThread *>(deque_get(threads, idx));
@@ -130,6 +136,10 @@ void rt_taskpool_wait(RtTaskPool *taskpool) {
     deque_destory(&tasks);
 
     // Destory Lock
+    if (RT_NULL != taskpool->task_cond) {
+        delete taskpool->task_cond;
+        taskpool->task_cond = NULL;
+    }
     if (RT_NULL != taskpool->task_lock) {
         delete taskpool->task_lock;
         taskpool->task_lock = NULL;
@@ -151,39 +161,28 @@ static void* rt_taskpool_loop(void* args) {
     INT32 tid = RtThread::getThreadID();
 
     while (true) {
-        if ((kWaiting_State == taskpool->state)
-                && (taskpool->cur_task_num == 0)) {
+        // We have to be holding the lock to read the queue and to call wait.
+        taskpool->task_lock->lock();
+        while ((taskpool->cur_task_num == 0)
+                && (kWaiting_State != taskpool->state)) {
+            // idle worker sleeps until a task is pushed or pool is waited
+            taskpool->task_cond->wait(taskpool->task_lock);
+        }
+        if (taskpool->cur_task_num == 0) {
             // no task and taskpool is in waiting state
+            taskpool->task_lock->unlock();
             return NULL;
         }
-        if ((kRunning_State == taskpool->state)
-                && (taskpool->cur_task_num == 0)) {
-            // TODO(mechanisms): use elegant mechanisms to sleep
-            RtTime::sleepUs(5000);
-            RT_LOGT("Task Pool is Empty...cur_task_num=%d",
-                        taskpool->cur_task_num);
-            continue;
-        }
 
-        // We have to be holding the lock to read the queue and to call wait.
-        taskpool->task_lock->lock();
         RtTask*       task   = RT_NULL;
         RT_DequeEntry entry = deque_pop(taskpool->tasks);
-        if (RT_NULL != entry.data) {
-            task = reinterpret_cast<RtTask *>(entry.data);
-            entry.data  = RT_NULL;
-            entry.flag  = ENTRY_FLAG_UNUSE;
-            taskpool->cur_task_num--;
-        } else {
-            // TODO(mechanisms): use elegant mechanisms to sleep
-            RtTime::sleepUs(5000);
-            RT_LOGT("Task Pool is Empty...cur_task_num=%d",
-                        taskpool->cur_task_num);
-            taskpool->task_lock->unlock();
-            continue;
-        }
-
+        task = reinterpret_cast<RtTask *>(entry.data);
+        entry.data  = RT_NULL;
+        entry.flag  = ENTRY_FLAG_UNUSE;
+        taskpool->cur_task_num--;
         taskpool->busy_task_num++;
+        // wake up pusher which waits for room of full pool
+        taskpool->task_cond->broadcast();
         taskpool->task_lock->unlock();
 
         // OK, now really do the work.
@@ -191,15 +190,17 @@ static void* rt_taskpool_loop(void* args) {
         task->run(RT_NULL);
 
         UINT64 duration = RtTime::getNowTimeMs() - now;
-        RT_LOGE("Task(%p,id:%02d/busy:%02d/wait:%02d/max:%02d)"
+        RT_LOGD("Task(%p,id:%02d/busy:%02d/wait:%02d/max:%02d)"
                 " spent %lldms on Thread[%d]",
                  task, task->get_id(),
                  taskpool->busy_task_num,
                  taskpool->cur_task_num,
                  taskpool->max_task_num,
-                 duration, tid);
+                 (long long)duration, tid);
 
+        taskpool->task_lock->lock();
         taskpool->busy_task_num--;
+        taskpool->task_lock->unlock();
 
         delete task;
     }
@@ -51,6 +51,11 @@ int main(int argc, char **argv) {
     rt_tests_add(test_ctx, unit_test_lock_unlock, const_cast<char *>("UnitTest-Lock-Unlock"));
     rt_tests_add(test_ctx, unit_test_cond_lock, const_cast<char *>("UnitTest-Cond-Lock"));
 
+    rt_tests_add(test_ctx, unit_test_trace, const_cast<char *>("UnitTest-Trace"));
+    rt_tests_add(test_ctx, unit_test_log_async, const_cast<char *>("UnitTest-Log-Async"));
+    rt_tests_add(test_ctx, unit_test_thread_sched, const_cast<char *>("UnitTest-Thread-Sched"));
+    rt_tests_add(test_ctx, unit_test_shm_ring, const_cast<char *>("UnitTest-Shm-Ring"));
+
     // ! run all testcases
     rt_tests_run(test_ctx, /*mem_dump=*/RT_TRUE);
 
@@ -37,5 +37,9 @@ RT_RET unit_test_mutex(INT32 index, INT32 total_index);
 RT_RET unit_test_thread(INT32 index, INT32 total_index);
 RT_RET unit_test_lock_unlock(INT32 index, INT32 total_index);
 RT_RET unit_test_cond_lock(INT32 index, INT32 total_index);
+RT_RET unit_test_trace(INT32 index, INT32 total_index);
+RT_RET unit_test_log_async(INT32 index, INT32 total_index);
+RT_RET unit_test_thread_sched(INT32 index, INT32 total_index);
+RT_RET unit_test_shm_ring(INT32 index, INT32 total_index);
 
 #endif  // SRC_TESTS_RT_BASE_RT_BASE_TESTS_H_
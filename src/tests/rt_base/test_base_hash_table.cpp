@@ -23,6 +23,7 @@
 
 #include "rt_base_tests.h" // NOLINT
 #include "rt_hash_table.h" // NOLINT
+#include "rt_time.h" // NOLINT
 
 typedef struct _fake_hash_node {
     UINT32 key;
@@ -30,19 +31,12 @@ typedef struct _fake_hash_node {
 } fake_hash_node;
 
 #define MAX_NUM_NODE 1000
+#define BENCH_NUM_NODE 20000
+#define BENCH_KEY_STEP 64       // keys are like pointers of aligned objects
 
-RT_RET unit_test_hash_table(INT32 index, INT32 total_index) {
-    // ! Fake 1000 hash nodes
-    fake_hash_node test_nodes[MAX_NUM_NODE];
-    rt_memset(test_nodes, 0, sizeof(fake_hash_node) * MAX_NUM_NODE);
-    for (INT32 i = 0; i < MAX_NUM_NODE; i++) {
-        test_nodes[i].key = i;
-        test_nodes[i].value = MAX_NUM_NODE - i;
-    }
-
-    RtHashTable *hash = rt_hash_table_create(20, hash_ptr_func, hash_ptr_compare);
-    UINT32 num_nodes = sizeof(test_nodes) / sizeof(test_nodes[0]);
-    RT_LOGE("num_nodes = %d", num_nodes);
+static RT_RET hash_table_check(RtHashTable *hash, fake_hash_node *test_nodes, UINT32 num_nodes) {
+    UINT32 walked = 0;
+    fake_hash_node *hn = NULL;
     for (UINT32 i = 0; i < num_nodes; i++) {
         rt_hash_table_insert(hash,
                             reinterpret_cast<void*>(test_nodes[i].key),
@@ -51,40 +45,124 @@ RT_RET unit_test_hash_table(INT32 index, INT32 total_index) {
 
     // rt_hash_table_dump(hash);
 
-    fake_hash_node *hn = NULL;
     for (UINT32 i = 0; i < num_nodes; i++) {
         hn = reinterpret_cast<fake_hash_node*>(
                  rt_hash_table_find(hash, reinterpret_cast<void*>(test_nodes[i].key)));
-        #if 0
-        RT_ASSERT(RT_NULL != st);
-        RT_ASSERT(st->value == (MAX_NUM_NODE-i));
-        #else
         CHECK_UE(hn, RT_NULL);
         CHECK_EQ(hn->value, (MAX_NUM_NODE-i));
-        #endif
     }
 
+    // every entry is walked once by buckets
+    for (UINT32 bucket = 0; bucket < rt_hash_table_get_num_buckets(hash); bucket++) {
+        struct rt_hash_node *list = rt_hash_table_get_bucket(hash, bucket);
+        for (struct rt_hash_node *node = list->next; node != RT_NULL; node = node->next) {
+            walked++;
+        }
+    }
+    CHECK_EQ(walked, num_nodes);
+
+    // the first half is removed, the rest is still found
+    for (UINT32 i = 0; i < num_nodes / 2; i++) {
+        rt_hash_table_remove(hash, reinterpret_cast<void*>(test_nodes[i].key));
+    }
     for (UINT32 i = 0; i < num_nodes; i++) {
+        hn = reinterpret_cast<fake_hash_node*>(
+                rt_hash_table_find(hash, reinterpret_cast<void*>(test_nodes[i].key)));
+        if (i < num_nodes / 2) {
+            CHECK_EQ(hn, RT_NULL);
+        } else {
+            CHECK_UE(hn, RT_NULL);
+            CHECK_EQ(hn->value, (MAX_NUM_NODE-i));
+        }
+    }
+
+    for (UINT32 i = num_nodes / 2; i < num_nodes; i++) {
         rt_hash_table_remove(hash, reinterpret_cast<void*>(test_nodes[i].key));
     }
 
     for (UINT32 i = 0; i < num_nodes; i++) {
-        fake_hash_node* hn = reinterpret_cast<fake_hash_node*>(
+        hn = reinterpret_cast<fake_hash_node*>(
                 rt_hash_table_find(hash, reinterpret_cast<void*>(test_nodes[i].key)));
-        #if 0
-        RT_ASSERT(RT_NULL != hn);
-        #else
         CHECK_EQ(hn, RT_NULL);
-        #endif
     }
-
-    rt_hash_table_dump(hash);
-    rt_hash_table_destory(hash);
-    hash = RT_NULL;
-
     return RT_OK;
 
 __FAILED:
     return RT_ERR_UNKNOWN;
 }
 
+static void hash_table_bench(const char *name, RtHashTable *hash) {
+    INT64  cost[4];
+    INT64  now   = RtTime::getNowTimeUs();
+    UINT32 found = 0;
+    for (UINT32 i = 0; i < BENCH_NUM_NODE; i++) {
+        rt_hash_table_insert(hash, reinterpret_cast<void*>((i + 1) * BENCH_KEY_STEP),
+                             reinterpret_cast<void*>(i + 1));
+    }
+    cost[0] = RtTime::getNowTimeUs() - now;
+
+    now = RtTime::getNowTimeUs();
+    for (UINT32 i = 0; i < BENCH_NUM_NODE; i++) {
+        found += (RT_NULL != rt_hash_table_find(hash, reinterpret_cast<void*>((i + 1) * BENCH_KEY_STEP)));
+    }
+    cost[1] = RtTime::getNowTimeUs() - now;
+
+    now = RtTime::getNowTimeUs();
+    for (UINT32 bucket = 0; bucket < rt_hash_table_get_num_buckets(hash); bucket++) {
+        struct rt_hash_node *list = rt_hash_table_get_bucket(hash, bucket);
+        for (struct rt_hash_node *node = list->next; node != RT_NULL; node = node->next) {
+            found += (RT_NULL != node->data);
+        }
+    }
+    cost[2] = RtTime::getNowTimeUs() - now;
+
+    now = RtTime::getNowTimeUs();
+    for (UINT32 i = 0; i < BENCH_NUM_NODE; i++) {
+        rt_hash_table_remove(hash, reinterpret_cast<void*>((i + 1) * BENCH_KEY_STEP));
+    }
+    cost[3] = RtTime::getNowTimeUs() - now;
+
+    RT_LOGE("%-8s %d entries: insert %6lldus find %6lldus iterate %6lldus remove %6lldus (found %d)",
+             name, BENCH_NUM_NODE, cost[0], cost[1], cost[2], cost[3], found);
+}
+
+RT_RET unit_test_hash_table(INT32 index, INT32 total_index) {
+    // ! Fake 1000 hash nodes
+    fake_hash_node test_nodes[MAX_NUM_NODE];
+    rt_memset(test_nodes, 0, sizeof(fake_hash_node) * MAX_NUM_NODE);
+    for (INT32 i = 0; i < MAX_NUM_NODE; i++) {
+        test_nodes[i].key = i;
+        test_nodes[i].value = MAX_NUM_NODE - i;
+    }
+    UINT32 num_nodes = sizeof(test_nodes) / sizeof(test_nodes[0]);
+    RT_LOGE("num_nodes = %d", num_nodes);
+
+    RtHashTable *hash = rt_hash_table_create(20, hash_ptr_func, hash_ptr_compare);
+    RT_RET err = hash_table_check(hash, test_nodes, num_nodes);
+    rt_hash_table_dump(hash);
+    rt_hash_table_destory(hash);
+
+    // open addressing grows from the least slots
+    if (RT_OK == err) {
+        hash = rt_hash_table_create_open(0, hash_ptr_func, hash_ptr_compare);
+        err  = hash_table_check(hash, test_nodes, num_nodes);
+        rt_hash_table_dump(hash);
+        rt_hash_table_destory(hash);
+    }
+    if (RT_OK != err) {
+        return err;
+    }
+
+    hash = rt_hash_table_create(20, hash_ptr_func, hash_ptr_compare);
+    hash_table_bench("chained", hash);
+    rt_hash_table_destory(hash);
+
+    hash = rt_hash_table_create(20, hash_ptr_mix_func, hash_ptr_compare);
+    hash_table_bench("mixed", hash);
+    rt_hash_table_destory(hash);
+
+    hash = rt_hash_table_create_open(16, hash_ptr_mix_func, hash_ptr_compare);
+    hash_table_bench("open", hash);
+    rt_hash_table_destory(hash);
+    return RT_OK;
+}
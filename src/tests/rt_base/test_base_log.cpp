@@ -0,0 +1,104 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: calls per second and tail latency of rt_log, 8 threads log
+ *         in sync mode and in async mode.
+ */
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "base_log"
+
+#include <stdlib.h>
+
+#include "rt_log.h" // NOLINT
+#include "rt_thread.h" // NOLINT
+#include "rt_time.h" // NOLINT
+#include "rt_mem.h" // NOLINT
+#include "rt_base_tests.h" // NOLINT
+
+#define LOG_TEST_THREADS        8
+#define LOG_TEST_SYNC_CALLS     50
+#define LOG_TEST_ASYNC_CALLS    4000
+
+typedef struct _LogTestCtx {
+    INT32   mIndex;
+    INT32   mCalls;
+    INT64  *mCostUs;
+} LogTestCtx;
+
+static void* log_test_loop(void *arg) {
+    LogTestCtx *ctx = reinterpret_cast<LogTestCtx *>(arg);
+    for (INT32 idx = 0; idx < ctx->mCalls; idx++) {
+        INT64 beginUs = RtTime::getNowTimeUs();
+        RT_LOGD("thread %d line %05d pts %lld rate %.2f name %s",
+                 ctx->mIndex, idx, (INT64)idx * 40000, idx / 25.0, "bench");
+        ctx->mCostUs[idx] = RtTime::getNowTimeUs() - beginUs;
+    }
+    return RT_NULL;
+}
+
+static int log_test_compare(const void *a, const void *b) {
+    INT64 delta = *reinterpret_cast<const INT64 *>(a) - *reinterpret_cast<const INT64 *>(b);
+    return (delta > 0) ? 1 : ((delta < 0) ? -1 : 0);
+}
+
+static RT_RET log_test_bench(RT_BOOL async, INT32 calls) {
+    RtThread   *threads[LOG_TEST_THREADS];
+    LogTestCtx  ctxs[LOG_TEST_THREADS];
+    INT32       total  = calls * LOG_TEST_THREADS;
+    INT64      *costUs = rt_malloc_array(INT64, total);
+    if (RT_NULL == costUs) {
+        return RT_ERR_MALLOC;
+    }
+
+    rt_set_log_async(async);
+    UINT64 drops   = rt_log_dropped();
+    INT64  beginUs = RtTime::getNowTimeUs();
+    for (INT32 idx = 0; idx < LOG_TEST_THREADS; idx++) {
+        ctxs[idx].mIndex  = idx;
+        ctxs[idx].mCalls  = calls;
+        ctxs[idx].mCostUs = costUs + idx * calls;
+        threads[idx] = new RtThread(log_test_loop, &ctxs[idx]);
+        threads[idx]->start();
+    }
+    for (INT32 idx = 0; idx < LOG_TEST_THREADS; idx++) {
+        threads[idx]->join();
+        rt_safe_delete(threads[idx]);
+    }
+    INT64  wallUs = RT_MAX(RtTime::getNowTimeUs() - beginUs, 1ll);
+    RT_RET err    = rt_log_flush();
+    drops = rt_log_dropped() - drops;
+    rt_set_log_async(RT_FALSE);
+
+    qsort(costUs, total, sizeof(INT64), log_test_compare);
+    RT_LOGE("%s: %d calls of %d threads, %lld calls/s, latency p50 %lldus p99 %lldus max %lldus, drops %llu",
+             async ? "async" : "sync", total, LOG_TEST_THREADS, (INT64)total * 1000000 / wallUs,
+             costUs[total / 2], costUs[total * 99 / 100], costUs[total - 1], drops);
+    if ((RT_OK == err) && (drops > (UINT64)total)) {
+        err = RT_ERR_VALUE;
+    }
+    rt_safe_free(costUs);
+    return err;
+}
+
+RT_RET unit_test_log_async(INT32 index, INT32 total_index) {
+    RT_RET err = log_test_bench(RT_FALSE, LOG_TEST_SYNC_CALLS);
+    if (RT_OK == err) {
+        err = log_test_bench(RT_TRUE, LOG_TEST_ASYNC_CALLS);
+    }
+    return err;
+}
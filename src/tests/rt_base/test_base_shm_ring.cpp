@@ -0,0 +1,243 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: frames of shared memory ring are dropped for slow readers, and
+ *         throughput and latency of a reader in another process.
+ */
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "base_shm_ring"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "rt_shm_ring.h" // NOLINT
+#include "rt_mem.h" // NOLINT
+#include "rt_time.h" // NOLINT
+#include "rt_base_tests.h" // NOLINT
+
+#define SHM_TEST_NAME           "rt_shm_ring_test"
+#define SHM_TEST_SLOTS          8
+#define SHM_TEST_FRAME_BYTES    256
+#define SHM_BENCH_VIDEO_BYTES   (1920 * 1088 * 3 / 2)
+#define SHM_BENCH_VIDEO_FRAMES  300
+#define SHM_BENCH_PCM_BYTES     (480 * 2 * 2)     // 10ms of 48KHz stereo
+#define SHM_BENCH_PCM_FRAMES    1000
+#define SHM_BENCH_PCM_PERIOD_US 1000
+
+typedef struct _ShmBenchResult {
+    INT32   mFrames;
+    INT32   mCorrupts;
+    INT64   mDropped;
+    INT64   mBytes;
+    INT64   mElapsedUs;
+    INT64   mLatencyP50Us;
+    INT64   mLatencyP99Us;
+    INT64   mLatencyMaxUs;
+} ShmBenchResult;
+
+static void shm_test_fill(UINT8 *data, UINT32 size, UINT64 seq) {
+    data[0]        = (UINT8)seq;
+    data[size - 1] = (UINT8)(seq >> 8);
+}
+
+static RT_BOOL shm_test_check(const UINT8 *data, UINT32 size, UINT64 seq) {
+    return ((data[0] == (UINT8)seq) && (data[size - 1] == (UINT8)(seq >> 8))) ? RT_TRUE : RT_FALSE;
+}
+
+static RT_RET shm_test_write(struct RtShmRing *ring, UINT64 seq, INT32 channels) {
+    UINT8      data[SHM_TEST_FRAME_BYTES];
+    RtShmFrame frame;
+    rt_memset(&frame, 0, sizeof(frame));
+    frame.mPts             = seq * 1000;
+    frame.mFormat.mType    = RT_SHM_FORMAT_AUDIO;
+    frame.mFormat.mSampleRate = 48000;
+    frame.mFormat.mChannels   = channels;
+    shm_test_fill(data, sizeof(data), seq);
+    return rt_shm_ring_write(ring, data, sizeof(data), &frame);
+}
+
+static RT_RET shm_test_read(struct RtShmRing *ring, UINT64 seq, UINT64 dropped, UINT32 flags) {
+    UINT8      data[SHM_TEST_FRAME_BYTES];
+    RtShmFrame frame;
+    RT_RET     err = rt_shm_ring_read(ring, data, sizeof(data), &frame, 0);
+    if ((RT_OK != err) || (frame.mSeq != seq) || (frame.mPts != (INT64)seq * 1000)
+         || (frame.mFlags != flags) || !shm_test_check(data, frame.mSize, seq)
+         || (rt_shm_ring_dropped(ring) != dropped)) {
+        RT_LOGE("read %lld: err %d seq %lld flags 0x%x dropped %lld", seq, err, frame.mSeq,
+                 frame.mFlags, rt_shm_ring_dropped(ring));
+        return RT_ERR_VALUE;
+    }
+    return RT_OK;
+}
+
+static RT_RET shm_test_drop() {
+    struct RtShmRing *writer = rt_shm_ring_create(SHM_TEST_NAME, SHM_TEST_SLOTS, SHM_TEST_FRAME_BYTES);
+    if (RT_NULL == writer) {
+        RT_LOGE("shared memory is not supported, skip it");
+        return RT_OK;
+    }
+    // writer goes on without readers
+    UINT64 seq = 0;
+    for (; seq < 20; seq++) {
+        shm_test_write(writer, seq, 2);
+    }
+
+    // reader starts from the oldest one in ring
+    RT_RET err = RT_OK;
+    struct RtShmRing *reader = rt_shm_ring_open(SHM_TEST_NAME);
+    for (UINT64 idx = 20 - SHM_TEST_SLOTS; (RT_OK == err) && (idx < 20); idx++) {
+        err = shm_test_read(reader, idx, 0, 0);
+    }
+
+    // slow reader drops the oldest ones, and format change is flagged
+    for (; seq < 40; seq++) {
+        shm_test_write(writer, seq, (seq < 39) ? 2 : 1);
+    }
+    for (UINT64 idx = 40 - SHM_TEST_SLOTS; (RT_OK == err) && (idx < 40); idx++) {
+        err = shm_test_read(reader, idx, 20 - SHM_TEST_SLOTS, (39 == idx) ? RT_SHM_FRAME_FLAG_FORMAT : 0);
+    }
+
+    RtShmFrame frame;
+    if ((RT_OK == err) && (RT_ERR_TIMEOUT != rt_shm_ring_read(reader, RT_NULL, 0, &frame, 1000))) {
+        err = RT_ERR_VALUE;
+    }
+    rt_shm_ring_close(&writer);
+    if ((RT_OK == err) && (RT_ERR_END_OF_STREAM != rt_shm_ring_read(reader, RT_NULL, 0, &frame, 1000))) {
+        err = RT_ERR_VALUE;
+    }
+    if ((RT_OK == err) && (RT_NULL != rt_shm_ring_open(SHM_TEST_NAME))) {
+        err = RT_ERR_VALUE;
+    }
+    rt_shm_ring_close(&reader);
+    return err;
+}
+
+static int shm_bench_compare(const void *a, const void *b) {
+    INT64 diff = *reinterpret_cast<const INT64 *>(a) - *reinterpret_cast<const INT64 *>(b);
+    return (diff > 0) ? 1 : ((diff < 0) ? -1 : 0);
+}
+
+// reader process, it takes frames until writer closes the ring
+static void shm_bench_reader(INT32 pipeFd, UINT32 frameBytes, INT32 frames) {
+    ShmBenchResult result;
+    rt_memset(&result, 0, sizeof(result));
+    UINT8 *data      = rt_malloc_array(UINT8, frameBytes);
+    INT64 *latencies = rt_malloc_array(INT64, frames);
+    struct RtShmRing *ring = rt_shm_ring_open(SHM_TEST_NAME);
+    INT64  startUs   = 0;
+
+    RtShmFrame frame;
+    while ((RT_NULL != ring) && (RT_OK == rt_shm_ring_read(ring, data, frameBytes, &frame, 1000000))) {
+        INT64 nowUs = RtTime::getNowTimeUs();
+        startUs = (0 == startUs) ? frame.mWriteUs : startUs;
+        if (result.mFrames < frames) {
+            latencies[result.mFrames] = nowUs - frame.mWriteUs;
+        }
+        if (!shm_test_check(data, frame.mSize, frame.mSeq)) {
+            result.mCorrupts++;
+        }
+        result.mFrames++;
+        result.mBytes    += frame.mSize;
+        result.mElapsedUs = nowUs - startUs;
+    }
+    result.mDropped = rt_shm_ring_dropped(ring);
+    INT32 count = RT_MIN(result.mFrames, frames);
+    if (count > 0) {
+        qsort(latencies, count, sizeof(INT64), shm_bench_compare);
+        result.mLatencyP50Us = latencies[count / 2];
+        result.mLatencyP99Us = latencies[count * 99 / 100];
+        result.mLatencyMaxUs = latencies[count - 1];
+    }
+    if (sizeof(result) != write(pipeFd, &result, sizeof(result))) {
+        RT_LOGE("fail to send result of reader");
+    }
+    rt_shm_ring_close(&ring);
+    rt_free(data);
+    rt_free(latencies);
+}
+
+static RT_RET shm_bench(const char *name, UINT32 frameBytes, INT32 frames, INT64 periodUs) {
+    struct RtShmRing *writer = rt_shm_ring_create(SHM_TEST_NAME, 16, frameBytes);
+    INT32             fds[2];
+    if ((RT_NULL == writer) || (0 != pipe(fds))) {
+        rt_shm_ring_close(&writer);
+        return RT_OK;
+    }
+
+    pid_t pid = fork();
+    if (0 == pid) {
+        close(fds[0]);
+        shm_bench_reader(fds[1], frameBytes, frames);
+        _exit(0);
+    }
+    close(fds[1]);
+    RtTime::sleepMs(50);
+
+    UINT8     *data = rt_malloc_array(UINT8, frameBytes);
+    RtShmFrame frame;
+    rt_memset(data, 0, frameBytes);
+    rt_memset(&frame, 0, sizeof(frame));
+    INT64 startUs = RtTime::getNowTimeUs();
+    for (INT32 idx = 0; idx < frames; idx++) {
+        shm_test_fill(data, frameBytes, idx);
+        frame.mPts   = idx;
+        frame.mFlags = (idx == frames - 1) ? RT_SHM_FRAME_FLAG_EOS : 0;
+        rt_shm_ring_write(writer, data, frameBytes, &frame);
+        if (periodUs > 0) {
+            RtTime::sleepUs(periodUs);
+        }
+    }
+    INT64 writeUs = RtTime::getNowTimeUs() - startUs;
+    RtTime::sleepMs(50);
+    rt_shm_ring_close(&writer);
+
+    ShmBenchResult result;
+    rt_memset(&result, 0, sizeof(result));
+    INT32 status = 0;
+    if (sizeof(result) != read(fds[0], &result, sizeof(result))) {
+        result.mCorrupts = -1;
+    }
+    waitpid(pid, &status, 0);
+    close(fds[0]);
+    rt_free(data);
+
+    RT_LOGE("%s: writer %d frames %lldMB/s, reader %d frames %lldMB/s, dropped %lld, "
+            "latency p50 %lldus p99 %lldus max %lldus", name, frames,
+            (INT64)frames * frameBytes / RT_MAX(writeUs, 1ll), result.mFrames,
+            result.mBytes / RT_MAX(result.mElapsedUs, 1ll), result.mDropped,
+            result.mLatencyP50Us, result.mLatencyP99Us, result.mLatencyMaxUs);
+    if ((0 != result.mCorrupts) || (0 == result.mFrames)
+         || (result.mFrames + result.mDropped != frames)) {
+        RT_LOGE("%s: %d frames are corrupt", name, result.mCorrupts);
+        return RT_ERR_VALUE;
+    }
+    return RT_OK;
+}
+
+RT_RET unit_test_shm_ring(INT32 index, INT32 total_index) {
+    RT_RET err = shm_test_drop();
+    if (RT_OK == err) {
+        err = shm_bench("video 1080p", SHM_BENCH_VIDEO_BYTES, SHM_BENCH_VIDEO_FRAMES, 0);
+    }
+    if (RT_OK == err) {
+        err = shm_bench("pcm 10ms", SHM_BENCH_PCM_BYTES, SHM_BENCH_PCM_FRAMES, SHM_BENCH_PCM_PERIOD_US);
+    }
+    return err;
+}
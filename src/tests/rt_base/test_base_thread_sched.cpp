@@ -0,0 +1,194 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: scheduling of RtThread is in effect inside thread, and underruns
+ *         of an audio period under cpu hogs with and without audio class.
+ */
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "base_sched"
+
+#include <pthread.h>
+#include <string.h>
+
+#include "rt_thread.h" // NOLINT
+#include "rt_time.h" // NOLINT
+#include "rt_mem.h" // NOLINT
+#include "rt_cpu_info.h" // NOLINT
+#include "rt_base_tests.h" // NOLINT
+
+#define SCHED_TEST_PERIOD_US    2000
+#define SCHED_TEST_WORK_US      200
+#define SCHED_TEST_LATE_US      (SCHED_TEST_PERIOD_US / 2)
+#define SCHED_TEST_PERIODS      500
+#define SCHED_TEST_HOGS_PER_CPU 2
+#define SCHED_TEST_MAX_HOGS     64
+
+typedef struct _SchedTestCtx {
+    RtThreadSched   mSched;
+    RT_RET          mErr;
+    volatile INT32  mRun;
+    INT32           mUnderruns;
+    INT64           mMaxLateUs;
+} SchedTestCtx;
+
+static void* sched_test_self(void *arg) {
+    SchedTestCtx *ctx = reinterpret_cast<SchedTestCtx *>(arg);
+    ctx->mErr = RtThread::getSchedSelf(&ctx->mSched);
+    return RT_NULL;
+}
+
+// FIFO needs root or CAP_SYS_NICE, so it is probed in a thread of its own
+static void* sched_test_probe_rt(void *arg) {
+    SchedTestCtx *ctx = reinterpret_cast<SchedTestCtx *>(arg);
+    struct sched_param param;
+    rt_memset(&param, 0, sizeof(param));
+    param.sched_priority = 1;
+    ctx->mErr = (0 == pthread_setschedparam(pthread_self(), SCHED_FIFO, &param)) ? RT_OK : RT_ERR_BAD;
+    return RT_NULL;
+}
+
+static RT_RET sched_test_run(RtThread::RtTaskSlot slot, SchedTestCtx *ctx,
+                             const RtThreadSched *sched) {
+    RtThread *thread = new RtThread(slot, ctx);
+    thread->setName("sched");
+    if (RT_NULL != sched) {
+        thread->setSched(sched);
+    }
+    ctx->mErr = RT_ERR_BAD;
+    thread->start();
+    thread->join();
+    rt_safe_delete(thread);
+    return ctx->mErr;
+}
+
+static RT_RET sched_test_apply() {
+    SchedTestCtx  ctx;
+    RtThreadSched want;
+    UINT32        last = RT_MIN(rt_cpu_count(), 64) - 1;
+    rt_memset(&want, 0, sizeof(want));
+    want.mPolicy  = RT_SCHED_OTHER;
+    want.mNice    = 5;
+    want.mCpuMask = 1ull << last;
+    if (RT_OK != sched_test_run(sched_test_self, &ctx, &want)) {
+        return RT_ERR_BAD;
+    }
+    RT_LOGE("nice: policy %d nice %d mask 0x%llx", ctx.mSched.mPolicy, ctx.mSched.mNice,
+             (unsigned long long)ctx.mSched.mCpuMask);
+    if ((RT_SCHED_OTHER != ctx.mSched.mPolicy) || (5 != ctx.mSched.mNice)
+         || (want.mCpuMask != ctx.mSched.mCpuMask)) {
+        return RT_ERR_VALUE;
+    }
+
+    // thread without scheduling inherits from creator
+    RtThreadSched self;
+    RtThread::getSchedSelf(&self);
+    if ((RT_OK != sched_test_run(sched_test_self, &ctx, RT_NULL)) || (self.mNice != ctx.mSched.mNice)) {
+        return RT_ERR_VALUE;
+    }
+
+    if (RT_OK != sched_test_run(sched_test_probe_rt, &ctx, RT_NULL)) {
+        RT_LOGE("realtime scheduling is not permitted, skip check of FIFO");
+        return RT_OK;
+    }
+    rt_thread_sched_of_class(RT_THREAD_CLASS_AUDIO_RT, &want);
+    if (RT_OK != sched_test_run(sched_test_self, &ctx, &want)) {
+        return RT_ERR_BAD;
+    }
+    RT_LOGE("audio: policy %d priority %d mask 0x%llx", ctx.mSched.mPolicy, ctx.mSched.mPriority,
+             (unsigned long long)ctx.mSched.mCpuMask);
+    if ((RT_SCHED_FIFO != ctx.mSched.mPolicy) || (want.mPriority != ctx.mSched.mPriority)
+         || ((0 != want.mCpuMask) && (want.mCpuMask != ctx.mSched.mCpuMask))) {
+        return RT_ERR_VALUE;
+    }
+    return RT_OK;
+}
+
+static void sched_test_busy(INT64 us) {
+    INT64 endUs = RtTime::getNowTimeUs() + us;
+    while ((INT64)RtTime::getNowTimeUs() < endUs) {
+    }
+}
+
+static void* sched_test_hog(void *arg) {
+    SchedTestCtx *ctx = reinterpret_cast<SchedTestCtx *>(arg);
+    while (__atomic_load_n(&ctx->mRun, __ATOMIC_RELAXED)) {
+        sched_test_busy(1000);
+    }
+    return RT_NULL;
+}
+
+// wakes up every period and renders, it underruns when wake up is late
+static void* sched_test_audio(void *arg) {
+    SchedTestCtx *ctx = reinterpret_cast<SchedTestCtx *>(arg);
+    INT64 deadlineUs  = RtTime::getNowTimeUs() + SCHED_TEST_PERIOD_US;
+    for (INT32 idx = 0; idx < SCHED_TEST_PERIODS; idx++) {
+        INT64 nowUs = RtTime::getNowTimeUs();
+        if (deadlineUs > nowUs) {
+            RtTime::sleepUs(deadlineUs - nowUs);
+        }
+        INT64 lateUs = (INT64)RtTime::getNowTimeUs() - deadlineUs;
+        if (lateUs > SCHED_TEST_LATE_US) {
+            ctx->mUnderruns++;
+        }
+        ctx->mMaxLateUs = RT_MAX(ctx->mMaxLateUs, lateUs);
+        sched_test_busy(SCHED_TEST_WORK_US);
+        deadlineUs += SCHED_TEST_PERIOD_US;
+    }
+    return RT_NULL;
+}
+
+static void sched_test_stress(RT_THREAD_CLASS cls) {
+    RtThread     *hogs[SCHED_TEST_MAX_HOGS];
+    SchedTestCtx  hogCtx;
+    SchedTestCtx  ctx;
+    INT32         count = RT_MIN(rt_cpu_count() * SCHED_TEST_HOGS_PER_CPU, SCHED_TEST_MAX_HOGS);
+    rt_memset(&hogCtx, 0, sizeof(hogCtx));
+    rt_memset(&ctx, 0, sizeof(ctx));
+
+    hogCtx.mRun = 1;
+    for (INT32 idx = 0; idx < count; idx++) {
+        hogs[idx] = new RtThread(sched_test_hog, &hogCtx);
+        hogs[idx]->setName("hog");
+        hogs[idx]->start();
+    }
+
+    RtThread *audio = new RtThread(sched_test_audio, &ctx);
+    audio->setName("audio");
+    audio->setSchedClass(cls);
+    audio->start();
+    audio->join();
+    rt_safe_delete(audio);
+
+    __atomic_store_n(&hogCtx.mRun, 0, __ATOMIC_RELAXED);
+    for (INT32 idx = 0; idx < count; idx++) {
+        hogs[idx]->join();
+        rt_safe_delete(hogs[idx]);
+    }
+    RT_LOGE("%s: %d periods of %dus under %d hogs, underruns %d, max late %lldus",
+             (RT_THREAD_CLASS_DEFAULT == cls) ? "default" : "audio-rt", SCHED_TEST_PERIODS,
+             SCHED_TEST_PERIOD_US, count, ctx.mUnderruns, ctx.mMaxLateUs);
+}
+
+RT_RET unit_test_thread_sched(INT32 index, INT32 total_index) {
+    RT_RET err = sched_test_apply();
+    if (RT_OK == err) {
+        sched_test_stress(RT_THREAD_CLASS_DEFAULT);
+        sched_test_stress(RT_THREAD_CLASS_AUDIO_RT);
+    }
+    return err;
+}
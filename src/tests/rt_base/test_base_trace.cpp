@@ -0,0 +1,151 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: rings of tracing from threads, and json of chrome trace-event
+ */
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "base_trace"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "rt_trace.h" // NOLINT
+#include "rt_thread.h" // NOLINT
+#include "rt_time.h" // NOLINT
+#include "rt_mem.h" // NOLINT
+#include "rt_string_utils.h" // NOLINT
+#include "rt_base_tests.h" // NOLINT
+
+#ifdef OS_ANDROID
+#define TRACE_TEST_FILE         "/data/rt_trace_test.json"
+#else
+#define TRACE_TEST_FILE         "/tmp/rt_trace_test.json"
+#endif
+#define TRACE_TEST_THREADS      4
+#define TRACE_TEST_SPANS        1000
+#define TRACE_TEST_COST_EVENTS  200000
+
+typedef struct _TraceTestCtx {
+    INT32   mIndex;
+    char    mName[16];
+} TraceTestCtx;
+
+static void* trace_test_loop(void *arg) {
+    TraceTestCtx *ctx = reinterpret_cast<TraceTestCtx *>(arg);
+    rt_trace_thread_name(ctx->mName);
+    for (INT32 idx = 0; idx < TRACE_TEST_SPANS; idx++) {
+        RtTraceScope scope("test", "span");
+        if (0 == (idx % 100)) {
+            rt_trace_event(RT_TRACE_PHASE_INSTANT, "test", "mark", idx);
+        }
+    }
+    return RT_NULL;
+}
+
+static INT32 trace_test_count(const char *text, const char *pattern) {
+    INT32 count = 0;
+    for (const char *pos = strstr(text, pattern); RT_NULL != pos; pos = strstr(pos + 1, pattern)) {
+        count++;
+    }
+    return count;
+}
+
+static char* trace_test_read(const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (RT_NULL == fp) {
+        return RT_NULL;
+    }
+    fseek(fp, 0, SEEK_END);
+    INT32 size = (INT32)ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    char *text = rt_malloc_size(char, size + 1);
+    if (RT_NULL != text) {
+        text[fread(text, 1, size, fp)] = 0;
+    }
+    fclose(fp);
+    return text;
+}
+
+// cost of event, it is a relaxed load when tracing is disabled
+static void trace_test_cost() {
+    INT64 disableUs = 0;
+    INT64 enableUs  = 0;
+    for (INT32 round = 0; round < 2; round++) {
+        rt_trace_enable((round > 0) ? RT_TRUE : RT_FALSE);
+        INT64 beginUs = RtTime::getNowTimeUs();
+        for (INT32 idx = 0; idx < TRACE_TEST_COST_EVENTS; idx++) {
+            rt_trace_event(RT_TRACE_PHASE_INSTANT, "test", "cost", idx);
+        }
+        INT64 costUs = RtTime::getNowTimeUs() - beginUs;
+        if (round > 0) {
+            enableUs = costUs;
+        } else {
+            disableUs = costUs;
+        }
+    }
+    rt_trace_enable(RT_FALSE);
+    RT_LOGE("%d events, disabled: %lldus enabled: %lldus(%lldns per event)",
+             TRACE_TEST_COST_EVENTS, disableUs, enableUs, enableUs * 1000 / TRACE_TEST_COST_EVENTS);
+}
+
+RT_RET unit_test_trace(INT32 index, INT32 total_index) {
+    RT_RET       err = RT_OK;
+    RtThread    *threads[TRACE_TEST_THREADS];
+    TraceTestCtx ctxs[TRACE_TEST_THREADS];
+
+    trace_test_cost();
+
+    // events are dropped when tracing is disabled
+    rt_trace_reset();
+    rt_trace_event(RT_TRACE_PHASE_INSTANT, "test", "hidden", 0);
+
+    rt_trace_enable(RT_TRUE);
+    for (INT32 idx = 0; idx < TRACE_TEST_THREADS; idx++) {
+        ctxs[idx].mIndex = idx;
+        rt_str_snprintf(ctxs[idx].mName, sizeof(ctxs[idx].mName), "trace-%d", idx);
+        threads[idx] = new RtThread(trace_test_loop, &ctxs[idx]);
+        threads[idx]->start();
+    }
+    for (INT32 idx = 0; idx < TRACE_TEST_THREADS; idx++) {
+        threads[idx]->join();
+        rt_safe_delete(threads[idx]);
+    }
+    rt_trace_enable(RT_FALSE);
+
+    err = rt_trace_dump(TRACE_TEST_FILE);
+    char *text = (RT_OK == err) ? trace_test_read(TRACE_TEST_FILE) : RT_NULL;
+    if (RT_NULL == text) {
+        return RT_ERR_BAD;
+    }
+
+    INT32 begins   = trace_test_count(text, "\"ph\":\"B\"");
+    INT32 ends     = trace_test_count(text, "\"ph\":\"E\"");
+    INT32 instants = trace_test_count(text, "\"name\":\"mark\"");
+    INT32 names    = trace_test_count(text, "\"name\":\"thread_name\"");
+    RT_LOGE("trace dump: %d begin %d end %d instant %d threads", begins, ends, instants, names);
+    if ((TRACE_TEST_THREADS * TRACE_TEST_SPANS != begins) || (begins != ends)
+         || (TRACE_TEST_THREADS * TRACE_TEST_SPANS / 100 != instants)
+         || (TRACE_TEST_THREADS != names) || (0 != trace_test_count(text, "hidden"))
+         || (0 != trace_test_count(text, "\"cost\""))
+         || (0 != strncmp(text, "{\"displayTimeUnit\"", 18))) {
+        err = RT_ERR_VALUE;
+    }
+    rt_safe_free(text);
+    remove(TRACE_TEST_FILE);
+    return err;
+}
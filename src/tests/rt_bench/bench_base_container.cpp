@@ -0,0 +1,198 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: benchmarks of containers of rt_base, sizes are of media pipeline,
+ *         e.g. buffers of a pool and keys of meta data of a buffer.
+ */
+
+#include "rt_bench.h" // NOLINT
+#include "rt_array_list.h" // NOLINT
+#include "rt_dequeue.h" // NOLINT
+#include "rt_hash_table.h" // NOLINT
+#include "rt_linked_list.h" // NOLINT
+#include "rt_metadata.h" // NOLINT
+
+#define BENCH_BATCH             1024
+#define BENCH_SAMPLES           2000
+#define BENCH_LIST_SIZE         64          // buffers of a pool
+#define BENCH_TABLE_SIZE        4096
+#define BENCH_META_KEYS         16          // keys of meta data of a buffer
+
+#define BENCH_KEY(idx)          reinterpret_cast<void *>((intptr_t)(idx) + 1)
+
+/*
+ * array list
+ */
+static void array_list_add_remove(void *param, INT32 count) {
+    RtArrayList *list = reinterpret_cast<RtArrayList *>(param);
+    for (INT32 idx = 0; idx < count; idx++) {
+        array_list_add(list, BENCH_KEY(idx));
+        array_list_remove_at(list, 0);
+    }
+}
+
+static void array_list_get(void *param, INT32 count) {
+    RtArrayList *list = reinterpret_cast<RtArrayList *>(param);
+    for (INT32 idx = 0; idx < count; idx++) {
+        (void)array_list_get_data(list, idx % BENCH_LIST_SIZE);
+    }
+}
+
+static void array_list_find(void *param, INT32 count) {
+    RtArrayList *list = reinterpret_cast<RtArrayList *>(param);
+    for (INT32 idx = 0; idx < count; idx++) {
+        (void)array_list_contains(list, BENCH_KEY(idx % BENCH_LIST_SIZE));
+    }
+}
+
+RT_RET bench_base_array_list(struct RtBenchCtx *ctx) {
+    RtArrayList *list = array_list_create_with_capacity(BENCH_LIST_SIZE * 2);
+    for (INT32 idx = 0; idx < BENCH_LIST_SIZE; idx++) {
+        array_list_add(list, BENCH_KEY(idx));
+    }
+    rt_bench_run(ctx, "array_list/add_remove_head", array_list_add_remove, list,
+                 BENCH_BATCH, BENCH_SAMPLES);
+    rt_bench_run(ctx, "array_list/get", array_list_get, list, BENCH_BATCH, BENCH_SAMPLES);
+    rt_bench_run(ctx, "array_list/contains", array_list_find, list, BENCH_BATCH, BENCH_SAMPLES);
+    array_list_destroy(list);
+    return RT_OK;
+}
+
+/*
+ * linked list
+ */
+static void linked_list_add_remove(void *param, INT32 count) {
+    RtLinkedList *list = reinterpret_cast<RtLinkedList *>(param);
+    for (INT32 idx = 0; idx < count; idx++) {
+        linked_list_add(list, BENCH_KEY(idx));
+        linked_list_remove_at(list, 0);
+    }
+}
+
+static void linked_list_get(void *param, INT32 count) {
+    RtLinkedList *list = reinterpret_cast<RtLinkedList *>(param);
+    for (INT32 idx = 0; idx < count; idx++) {
+        (void)linked_list_get_data(list, idx % BENCH_LIST_SIZE);
+    }
+}
+
+RT_RET bench_base_linked_list(struct RtBenchCtx *ctx) {
+    RtLinkedList *list = linked_list_create();
+    for (INT32 idx = 0; idx < BENCH_LIST_SIZE; idx++) {
+        linked_list_add(list, BENCH_KEY(idx));
+    }
+    rt_bench_run(ctx, "linked_list/add_remove_head", linked_list_add_remove, list,
+                 BENCH_BATCH, BENCH_SAMPLES);
+    rt_bench_run(ctx, "linked_list/get", linked_list_get, list, BENCH_BATCH, BENCH_SAMPLES);
+    linked_list_destroy(&list);
+    return RT_OK;
+}
+
+/*
+ * deque, of malloced entries and of entries of limit mode
+ */
+static void deque_push_pop(void *param, INT32 count) {
+    RT_Deque *deque = reinterpret_cast<RT_Deque *>(param);
+    for (INT32 idx = 0; idx < count; idx++) {
+        deque_push_tail(deque, BENCH_KEY(idx));
+        (void)deque_pop(deque);
+    }
+}
+
+RT_RET bench_base_deque(struct RtBenchCtx *ctx) {
+    RT_Deque *deque = deque_create();
+    rt_bench_run(ctx, "deque/push_pop", deque_push_pop, deque, BENCH_BATCH, BENCH_SAMPLES);
+    deque_destory(&deque);
+
+    deque = deque_create(BENCH_LIST_SIZE);
+    rt_bench_run(ctx, "deque/push_pop_limit", deque_push_pop, deque, BENCH_BATCH, BENCH_SAMPLES);
+    deque_destory(&deque);
+    return RT_OK;
+}
+
+/*
+ * hash table, of chained buckets and of open slots
+ */
+static void hash_table_insert_remove(void *param, INT32 count) {
+    struct RtHashTable *table = reinterpret_cast<struct RtHashTable *>(param);
+    for (INT32 idx = 0; idx < count; idx++) {
+        rt_hash_table_insert(table, BENCH_KEY(BENCH_TABLE_SIZE + idx), BENCH_KEY(idx));
+        rt_hash_table_remove(table, BENCH_KEY(BENCH_TABLE_SIZE + idx));
+    }
+}
+
+static void hash_table_find(void *param, INT32 count) {
+    struct RtHashTable *table = reinterpret_cast<struct RtHashTable *>(param);
+    for (INT32 idx = 0; idx < count; idx++) {
+        (void)rt_hash_table_find(table, BENCH_KEY((idx * 7) % BENCH_TABLE_SIZE));
+    }
+}
+
+RT_RET bench_base_hash_table(struct RtBenchCtx *ctx) {
+    struct RtHashTable *tables[2] = {
+        rt_hash_table_create(BENCH_TABLE_SIZE / 4, hash_ptr_mix_func, hash_ptr_compare),
+        rt_hash_table_create_open(BENCH_TABLE_SIZE, hash_ptr_mix_func, hash_ptr_compare),
+    };
+    const char *names[2][2] = {
+        { "hash_table/insert_remove", "hash_table/find" },
+        { "hash_table_open/insert_remove", "hash_table_open/find" },
+    };
+    for (INT32 type = 0; type < 2; type++) {
+        for (INT32 idx = 0; idx < BENCH_TABLE_SIZE; idx++) {
+            rt_hash_table_insert(tables[type], BENCH_KEY(idx), BENCH_KEY(idx));
+        }
+        rt_bench_run(ctx, names[type][0], hash_table_insert_remove, tables[type],
+                     BENCH_BATCH, BENCH_SAMPLES);
+        rt_bench_run(ctx, names[type][1], hash_table_find, tables[type], BENCH_BATCH, BENCH_SAMPLES);
+        rt_hash_table_destory(tables[type]);
+    }
+    return RT_OK;
+}
+
+/*
+ * meta data, it is set and found for each buffer of pipeline
+ */
+static void meta_data_set(void *param, INT32 count) {
+    RtMetaData *meta = reinterpret_cast<RtMetaData *>(param);
+    for (INT32 idx = 0; idx < count; idx++) {
+        meta->setInt32(MKTAG('b', 'n', 'c', 'a' + idx % BENCH_META_KEYS), idx);
+    }
+}
+
+static void meta_data_find(void *param, INT32 count) {
+    RtMetaData *meta = reinterpret_cast<RtMetaData *>(param);
+    INT32 value = 0;
+    for (INT32 idx = 0; idx < count; idx++) {
+        (void)meta->findInt32(MKTAG('b', 'n', 'c', 'a' + idx % BENCH_META_KEYS), &value);
+    }
+}
+
+static void meta_data_clear(void *param, INT32 count) {
+    RtMetaData *meta = reinterpret_cast<RtMetaData *>(param);
+    for (INT32 idx = 0; idx < count; idx++) {
+        meta->setInt64(MKTAG('b', 'n', 'c', 'p'), idx);
+        meta->setPointer(MKTAG('b', 'n', 'c', 'q'), meta);
+        meta->clear();
+    }
+}
+
+RT_RET bench_base_meta_data(struct RtBenchCtx *ctx) {
+    RtMetaData *meta = new RtMetaData();
+    rt_bench_run(ctx, "meta_data/set_int32", meta_data_set, meta, BENCH_BATCH, BENCH_SAMPLES);
+    rt_bench_run(ctx, "meta_data/find_int32", meta_data_find, meta, BENCH_BATCH, BENCH_SAMPLES);
+    rt_bench_run(ctx, "meta_data/set_clear", meta_data_clear, meta, BENCH_BATCH, BENCH_SAMPLES);
+    rt_safe_delete(meta);
+    return RT_OK;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: benchmarks of memory, locks and threads of OS Adaptive Layer.
+ */
+
+#include <stdlib.h>
+
+#include "rt_bench.h" // NOLINT
+#include "rt_mem.h" // NOLINT
+#include "rt_mutex.h" // NOLINT
+#include "rt_thread.h" // NOLINT
+
+#define BENCH_BATCH             256
+#define BENCH_SAMPLES           2000
+#define BENCH_MEM_SIZE          256
+#define BENCH_MEM_LIVES         1024        // blocks which are tracked already
+#define BENCH_HANDOFF_SAMPLES   20000
+#define BENCH_THREAD_SAMPLES    500
+
+/*
+ * memory, rt_mem_malloc is tracked by RTMemService, so its cost grows
+ * with blocks alive. malloc is the baseline of it.
+ */
+static void mem_malloc_free(void *param, INT32 count) {
+    for (INT32 idx = 0; idx < count; idx++) {
+        void *ptr = rt_malloc_size(void, BENCH_MEM_SIZE);
+        rt_free(ptr);
+    }
+}
+
+static void mem_libc_malloc_free(void *param, INT32 count) {
+    for (INT32 idx = 0; idx < count; idx++) {
+        void *ptr = malloc(BENCH_MEM_SIZE);
+        // keeps compiler from eliding the pair
+        __asm__ __volatile__("" : : "r"(ptr) : "memory");
+        free(ptr);
+    }
+}
+
+RT_RET bench_base_memory(struct RtBenchCtx *ctx) {
+    rt_bench_run(ctx, "memory/malloc_free", mem_libc_malloc_free, RT_NULL,
+                 BENCH_BATCH, BENCH_SAMPLES);
+    rt_bench_run(ctx, "memory/rt_malloc_free", mem_malloc_free, RT_NULL,
+                 BENCH_BATCH, BENCH_SAMPLES);
+
+    void **lives = rt_malloc_array(void *, BENCH_MEM_LIVES);
+    for (INT32 idx = 0; idx < BENCH_MEM_LIVES; idx++) {
+        lives[idx] = rt_malloc_size(void, BENCH_MEM_SIZE);
+    }
+    rt_bench_run(ctx, "memory/rt_malloc_free_tracked", mem_malloc_free, RT_NULL,
+                 BENCH_BATCH, BENCH_SAMPLES);
+    for (INT32 idx = 0; idx < BENCH_MEM_LIVES; idx++) {
+        rt_free(lives[idx]);
+    }
+    rt_free(lives);
+    return RT_OK;
+}
+
+/*
+ * mutex and condition, uncontended lock and handoff between two threads.
+ * an op of handoff is a round trip, it wakes the peer and is woken by it.
+ */
+typedef struct _BenchHandoff {
+    RtMutex        *mLock;
+    RtCondition    *mCond;
+    INT32           mTurn;      // 1 is of peer, 0 is of bench
+    RT_BOOL         mQuit;
+} BenchHandoff;
+
+static void mutex_lock_unlock(void *param, INT32 count) {
+    RtMutex *lock = reinterpret_cast<RtMutex *>(param);
+    for (INT32 idx = 0; idx < count; idx++) {
+        lock->lock();
+        lock->unlock();
+    }
+}
+
+static void* handoff_peer(void *param) {
+    BenchHandoff *handoff = reinterpret_cast<BenchHandoff *>(param);
+    RtMutex::RtAutolock autoLock(handoff->mLock);
+    while (!handoff->mQuit) {
+        if (1 == handoff->mTurn) {
+            handoff->mTurn = 0;
+            handoff->mCond->signal();
+        }
+        handoff->mCond->wait(handoff->mLock);
+    }
+    return RT_NULL;
+}
+
+static void handoff_round_trip(void *param, INT32 count) {
+    BenchHandoff *handoff = reinterpret_cast<BenchHandoff *>(param);
+    for (INT32 idx = 0; idx < count; idx++) {
+        RtMutex::RtAutolock autoLock(handoff->mLock);
+        handoff->mTurn = 1;
+        handoff->mCond->signal();
+        while (0 != handoff->mTurn) {
+            handoff->mCond->wait(handoff->mLock);
+        }
+    }
+}
+
+RT_RET bench_base_mutex_cond(struct RtBenchCtx *ctx) {
+    BenchHandoff handoff;
+    handoff.mLock  = new RtMutex();
+    handoff.mCond  = new RtCondition();
+    handoff.mTurn  = 0;
+    handoff.mQuit  = RT_FALSE;
+    rt_bench_run(ctx, "mutex/lock_unlock", mutex_lock_unlock, handoff.mLock,
+                 BENCH_BATCH, BENCH_SAMPLES);
+
+    RtThread *peer = new RtThread(handoff_peer, &handoff);
+    peer->start();
+    rt_bench_run(ctx, "condition/handoff", handoff_round_trip, &handoff,
+                 1, BENCH_HANDOFF_SAMPLES);
+    {
+        RtMutex::RtAutolock autoLock(handoff.mLock);
+        handoff.mQuit = RT_TRUE;
+        handoff.mCond->signal();
+    }
+    peer->join();
+    rt_safe_delete(peer);
+    rt_safe_delete(handoff.mCond);
+    rt_safe_delete(handoff.mLock);
+    return RT_OK;
+}
+
+/*
+ * thread, what a node pays to start and stop its work loop
+ */
+static void* thread_noop(void *param) {
+    return param;
+}
+
+static void thread_start_join(void *param, INT32 count) {
+    for (INT32 idx = 0; idx < count; idx++) {
+        RtThread *thread = new RtThread(thread_noop, param);
+        thread->start();
+        thread->join();
+        rt_safe_delete(thread);
+    }
+}
+
+RT_RET bench_base_thread(struct RtBenchCtx *ctx) {
+    rt_bench_run(ctx, "thread/start_join", thread_start_join, RT_NULL, 1, BENCH_THREAD_SAMPLES);
+    return RT_OK;
+}
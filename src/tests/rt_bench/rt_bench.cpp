@@ -0,0 +1,174 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * module: microbenchmark harness
+ */
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "rt_bench"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rt_bench.h" // NOLINT
+#include "rt_array_list.h" // NOLINT
+#include "rt_mem.h" // NOLINT
+#include "rt_time.h" // NOLINT
+
+struct RtBenchCtx {
+    char            mSuite[RT_BENCH_NAME_LEN];
+    char            mFilter[RT_BENCH_NAME_LEN];
+    RtArrayList    *mResults;
+};
+
+INT64 rt_bench_now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (INT64)ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+static int rt_bench_compare(const void *a, const void *b) {
+    INT64 diff = *reinterpret_cast<const INT64 *>(a) - *reinterpret_cast<const INT64 *>(b);
+    return (diff > 0) ? 1 : ((diff < 0) ? -1 : 0);
+}
+
+struct RtBenchCtx* rt_bench_init(const char *suite) {
+    struct RtBenchCtx *ctx = rt_malloc(struct RtBenchCtx);
+    if (RT_NULL == ctx) {
+        return RT_NULL;
+    }
+    rt_memset(ctx, 0, sizeof(struct RtBenchCtx));
+    snprintf(ctx->mSuite, sizeof(ctx->mSuite), "%s", suite);
+    ctx->mResults = array_list_create();
+    return ctx;
+}
+
+void rt_bench_set_filter(struct RtBenchCtx *ctx, const char *filter) {
+    snprintf(ctx->mFilter, sizeof(ctx->mFilter), "%s", (RT_NULL != filter) ? filter : "");
+}
+
+RT_RET rt_bench_run(struct RtBenchCtx *ctx, const char *name, RtBenchOps ops,
+                    void *param, INT32 batch, INT32 samples) {
+    if ((RT_NULL == ctx) || (RT_NULL == ops) || (batch <= 0) || (samples <= 0)) {
+        return RT_ERR_VALUE;
+    }
+    if (('\0' != ctx->mFilter[0]) && (RT_NULL == strstr(name, ctx->mFilter))) {
+        return RT_OK;
+    }
+    INT64 *latencies = rt_malloc_array(INT64, samples);
+    RtBenchResult *result = rt_malloc(RtBenchResult);
+    if ((RT_NULL == latencies) || (RT_NULL == result)) {
+        rt_safe_free(latencies);
+        rt_safe_free(result);
+        return RT_ERR_NOMEM;
+    }
+    rt_memset(result, 0, sizeof(RtBenchResult));
+    snprintf(result->mName, sizeof(result->mName), "%s", name);
+
+    ops(param, batch);
+    for (INT32 idx = 0; idx < samples; idx++) {
+        INT64 startNs = rt_bench_now_ns();
+        ops(param, batch);
+        INT64 costNs  = rt_bench_now_ns() - startNs;
+        result->mElapsedNs += costNs;
+        latencies[idx] = costNs / batch;
+    }
+    qsort(latencies, samples, sizeof(INT64), rt_bench_compare);
+    result->mOps       = (INT64)batch * samples;
+    result->mOpsPerSec = result->mOps * 1000000000ll / RT_MAX(result->mElapsedNs, 1ll);
+    result->mP50Ns     = latencies[samples / 2];
+    result->mP90Ns     = latencies[(INT64)samples * 90 / 100];
+    result->mP99Ns     = latencies[(INT64)samples * 99 / 100];
+    result->mMaxNs     = latencies[samples - 1];
+    rt_free(latencies);
+
+    RT_LOGE("%-32s %10lld ops/s  p50 %8lldns  p99 %8lldns  max %8lldns", result->mName,
+             (long long)result->mOpsPerSec, (long long)result->mP50Ns,
+             (long long)result->mP99Ns, (long long)result->mMaxNs);
+    array_list_add(ctx->mResults, result);
+    return RT_OK;
+}
+
+static void rt_bench_report_json(struct RtBenchCtx *ctx, FILE *fp) {
+    RtTime::DateTime date;
+    RtTime::getDateTime(&date);
+    fprintf(fp, "{\n  \"suite\": \"%s\",\n", ctx->mSuite);
+    fprintf(fp, "  \"date\": \"%04d-%02d-%02d %02d:%02d:%02d\",\n", date.mYear, date.mMonth,
+             date.mDay, date.mHour, date.mMinute, date.mSecond);
+    fprintf(fp, "  \"cpus\": %ld,\n  \"results\": [", sysconf(_SC_NPROCESSORS_ONLN));
+    UINT32 count = array_list_get_size(ctx->mResults);
+    for (UINT32 idx = 0; idx < count; idx++) {
+        RtBenchResult *result = reinterpret_cast<RtBenchResult *>
+                                    (array_list_get_data(ctx->mResults, idx));
+        fprintf(fp, "%s\n    {\"name\": \"%s\", \"ops\": %lld, \"elapsed_ns\": %lld, "
+                "\"ops_per_sec\": %lld, \"p50_ns\": %lld, \"p90_ns\": %lld, \"p99_ns\": %lld, "
+                "\"max_ns\": %lld}", (0 == idx) ? "" : ",", result->mName, (long long)result->mOps,
+                (long long)result->mElapsedNs, (long long)result->mOpsPerSec,
+                (long long)result->mP50Ns, (long long)result->mP90Ns,
+                (long long)result->mP99Ns, (long long)result->mMaxNs);
+    }
+    fprintf(fp, "\n  ]\n}\n");
+}
+
+static void rt_bench_report_csv(struct RtBenchCtx *ctx, FILE *fp) {
+    fprintf(fp, "suite,name,ops,elapsed_ns,ops_per_sec,p50_ns,p90_ns,p99_ns,max_ns\n");
+    UINT32 count = array_list_get_size(ctx->mResults);
+    for (UINT32 idx = 0; idx < count; idx++) {
+        RtBenchResult *result = reinterpret_cast<RtBenchResult *>
+                                    (array_list_get_data(ctx->mResults, idx));
+        fprintf(fp, "%s,%s,%lld,%lld,%lld,%lld,%lld,%lld,%lld\n", ctx->mSuite, result->mName,
+                (long long)result->mOps, (long long)result->mElapsedNs,
+                (long long)result->mOpsPerSec, (long long)result->mP50Ns,
+                (long long)result->mP90Ns, (long long)result->mP99Ns, (long long)result->mMaxNs);
+    }
+}
+
+RT_RET rt_bench_report(struct RtBenchCtx *ctx, RT_BENCH_FORMAT format, const char *path) {
+    FILE *fp = (RT_NULL != path) ? fopen(path, "w") : stdout;
+    if (RT_NULL == fp) {
+        RT_LOGE("fail to open %s", path);
+        return RT_ERR_OPEN_FILE;
+    }
+    if (RT_BENCH_FORMAT_CSV == format) {
+        rt_bench_report_csv(ctx, fp);
+    } else {
+        rt_bench_report_json(ctx, fp);
+    }
+    if (stdout != fp) {
+        fclose(fp);
+    } else {
+        fflush(fp);
+    }
+    return RT_OK;
+}
+
+void rt_bench_deinit(struct RtBenchCtx **ctx) {
+    if ((RT_NULL == ctx) || (RT_NULL == *ctx)) {
+        return;
+    }
+    UINT32 count = array_list_get_size((*ctx)->mResults);
+    for (UINT32 idx = 0; idx < count; idx++) {
+        void *result = array_list_get_data((*ctx)->mResults, idx);
+        rt_free(result);
+    }
+    array_list_destroy((*ctx)->mResults);
+    rt_free(*ctx);
+    *ctx = RT_NULL;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * module: microbenchmark harness, results are reported in json or csv,
+ *         which are kept to compare releases.
+ */
+
+#ifndef SRC_TESTS_RT_BENCH_RT_BENCH_H_
+#define SRC_TESTS_RT_BENCH_RT_BENCH_H_
+
+#include "rt_header.h" // NOLINT
+
+#define RT_BENCH_NAME_LEN       64
+
+typedef enum _RT_BENCH_FORMAT {
+    RT_BENCH_FORMAT_JSON = 0,
+    RT_BENCH_FORMAT_CSV,
+} RT_BENCH_FORMAT;
+
+typedef struct _RtBenchResult {
+    char    mName[RT_BENCH_NAME_LEN];
+    INT64   mOps;
+    INT64   mElapsedNs;
+    INT64   mOpsPerSec;
+    INT64   mP50Ns;         // latency of one op
+    INT64   mP90Ns;
+    INT64   mP99Ns;
+    INT64   mMaxNs;
+} RtBenchResult;
+
+// runs count ops of a case, what is set up for ops is in param
+typedef void (*RtBenchOps)(void *param, INT32 count);
+
+struct RtBenchCtx;
+
+struct RtBenchCtx* rt_bench_init(const char *suite);
+// cases of which names do not contain filter are skipped, NULL runs all
+void    rt_bench_set_filter(struct RtBenchCtx *ctx, const char *filter);
+/*
+ * ops are run in samples of batch after one sample of warm up. latency
+ * of an op is the time of its sample over batch, so batch is 1 for ops
+ * which take microseconds, and more for ops which take nanoseconds.
+ */
+RT_RET  rt_bench_run(struct RtBenchCtx *ctx, const char *name, RtBenchOps ops,
+                     void *param, INT32 batch, INT32 samples);
+// path NULL reports to stdout
+RT_RET  rt_bench_report(struct RtBenchCtx *ctx, RT_BENCH_FORMAT format, const char *path);
+void    rt_bench_deinit(struct RtBenchCtx **ctx);
+
+INT64   rt_bench_now_ns();
+
+// benchmarks of rt_base
+RT_RET  bench_base_array_list(struct RtBenchCtx *ctx);
+RT_RET  bench_base_linked_list(struct RtBenchCtx *ctx);
+RT_RET  bench_base_deque(struct RtBenchCtx *ctx);
+RT_RET  bench_base_hash_table(struct RtBenchCtx *ctx);
+RT_RET  bench_base_meta_data(struct RtBenchCtx *ctx);
+RT_RET  bench_base_memory(struct RtBenchCtx *ctx);
+RT_RET  bench_base_mutex_cond(struct RtBenchCtx *ctx);
+RT_RET  bench_base_thread(struct RtBenchCtx *ctx);
+
+#endif  // SRC_TESTS_RT_BENCH_RT_BENCH_H_
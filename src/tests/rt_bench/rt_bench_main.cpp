@@ -0,0 +1,75 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: rt_base_bench [-f json|csv] [-o file] [filter]
+ *         results are written to file, rt_base_bench.json by default,
+ *         stdout is not used as logs of rt_log are there.
+ */
+
+#include <string.h>
+#include <unistd.h>
+
+#include "rt_bench.h" // NOLINT
+
+typedef RT_RET (*BenchFunc)(struct RtBenchCtx *ctx);
+
+int main(int argc, char **argv) {
+    RT_BENCH_FORMAT format = RT_BENCH_FORMAT_JSON;
+    const char     *path   = RT_NULL;
+    INT32           opt    = 0;
+    while (-1 != (opt = getopt(argc, argv, "f:o:h"))) {
+        switch (opt) {
+          case 'f':
+            format = (0 == strcmp(optarg, "csv")) ? RT_BENCH_FORMAT_CSV : RT_BENCH_FORMAT_JSON;
+            break;
+          case 'o':
+            path = optarg;
+            break;
+          default:
+            RT_LOGE("usage: %s [-f json|csv] [-o file] [filter]", argv[0]);
+            return RT_ERR_VALUE;
+        }
+    }
+
+    struct RtBenchCtx *ctx = rt_bench_init("RockitBaseBench");
+    if (RT_NULL == ctx) {
+        return RT_ERR_NOMEM;
+    }
+    rt_bench_set_filter(ctx, (optind < argc) ? argv[optind] : RT_NULL);
+
+    BenchFunc benchs[] = {
+        bench_base_array_list,
+        bench_base_linked_list,
+        bench_base_deque,
+        bench_base_hash_table,
+        bench_base_meta_data,
+        bench_base_memory,
+        bench_base_mutex_cond,
+        bench_base_thread,
+    };
+    RT_RET err = RT_OK;
+    for (UINT32 idx = 0; (RT_OK == err) && (idx < RT_ARRAY_ELEMS(benchs)); idx++) {
+        err = benchs[idx](ctx);
+    }
+    if (RT_NULL == path) {
+        path = (RT_BENCH_FORMAT_CSV == format) ? "rt_base_bench.csv" : "rt_base_bench.json";
+    }
+    if (RT_OK == err) {
+        err = rt_bench_report(ctx, format, path);
+        RT_LOGE("results of %s are written to %s", argv[0], path);
+    }
+    rt_bench_deinit(&ctx);
+    return (RT_OK == err) ? 0 : 1;
+}
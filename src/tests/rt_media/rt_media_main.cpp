@@ -42,10 +42,38 @@ int main(int argc, char **argv) {
                  unit_test_allocator,
                  const_cast<char *>("UnitTest-Allocator"));
 
+    rt_tests_add(test_ctx,
+                 unit_test_allocator_hugepage,
+                 const_cast<char *>("UnitTest-Allocator-HugePage"));
+
+    rt_tests_add(test_ctx,
+                 unit_test_allocator_memfd,
+                 const_cast<char *>("UnitTest-Allocator-Memfd"));
+
     rt_tests_add(test_ctx,
                 unit_test_mediabuffer_pool,
                 const_cast<char *>("UnitTest-MediaBufferPool"));
 
+    rt_tests_add(test_ctx,
+                 unit_test_mediabuffer_refs,
+                 const_cast<char *>("UnitTest-MediaBufferRefs"));
+
+    rt_tests_add(test_ctx,
+                 unit_test_network_source,
+                 const_cast<char *>("UnitTest-NetworkSource"));
+
+    rt_tests_add(test_ctx,
+                 unit_test_push_stream,
+                 const_cast<char *>("UnitTest-PushStream"));
+
+    rt_tests_add(test_ctx,
+                 unit_test_audio_stretch,
+                 const_cast<char *>("UnitTest-AudioStretch"));
+
+    rt_tests_add(test_ctx,
+                 unit_test_image_color,
+                 const_cast<char *>("UnitTest-ImageColor"));
+
     // ! run all testcases
     rt_tests_run(test_ctx, /*mem_dump=*/RT_TRUE);
 
@@ -29,8 +29,15 @@ RT_RET unit_test_object_pool(INT32 index, INT32 total_index);
 RT_RET unit_test_ffmpeg_adapter(INT32 index, INT32 total_index);
 
 RT_RET unit_test_allocator(INT32 index, INT32 total_index);
+RT_RET unit_test_allocator_hugepage(INT32 index, INT32 total_index);
+RT_RET unit_test_allocator_memfd(INT32 index, INT32 total_index);
 RT_RET unit_test_mediabuffer_pool(INT32 index, INT32 total_index);
+RT_RET unit_test_mediabuffer_refs(INT32 index, INT32 total_index);
 RT_RET unit_test_media_sync(INT32 index, INT32 total_index);
+RT_RET unit_test_network_source(INT32 index, INT32 total_index);
+RT_RET unit_test_push_stream(INT32 index, INT32 total_index);
+RT_RET unit_test_audio_stretch(INT32 index, INT32 total_index);
+RT_RET unit_test_image_color(INT32 index, INT32 total_index);
 
 
 #endif  // SRC_TESTS_RT_MEDIA_RT_MEDIA_TESTS_H_
@@ -0,0 +1,226 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: cache and cap of huge page allocator, and latency of new buffers,
+ *         page faults and dTLB misses of 4K decoding against malloc one.
+ */
+
+#include <string.h>                 // NOLINT
+#include <unistd.h>                 // NOLINT
+#include <sys/resource.h>           // NOLINT
+#include <sys/syscall.h>            // NOLINT
+#include <linux/perf_event.h>       // NOLINT
+
+#include "rt_header.h"              // NOLINT
+#include "rt_media_tests.h"         // NOLINT
+#include "rt_metadata.h"            // NOLINT
+#include "rt_time.h"                // NOLINT
+#include "RTAllocatorHugePage.h"    // NOLINT
+#include "RTAllocatorMalloc.h"      // NOLINT
+#include "RTMediaBuffer.h"          // NOLINT
+#include "RTMediaMetaKeys.h"        // NOLINT
+
+#define HUGEPAGE_TEST_W             3840
+#define HUGEPAGE_TEST_H             2160
+#define HUGEPAGE_TEST_FRAME         (HUGEPAGE_TEST_W * HUGEPAGE_TEST_H * 3 / 2)
+#define HUGEPAGE_TEST_POOL          8       // buffers of decoder output pool
+#define HUGEPAGE_TEST_FRAMES        48      // frames decoded in one prepare
+#define HUGEPAGE_TEST_PREPARES      3
+
+typedef struct _HugePageBench {
+    INT64   mAllocUs;       // first prepare, buffers are new
+    INT64   mReallocUs;     // next prepares, buffers of last pool are freed
+    INT64   mDecodeUs;
+    INT64   mFaults;
+    INT64   mTlbMisses;     // -1 when perf events are not allowed
+} HugePageBench;
+
+static INT32 bench_tlb_open() {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = PERF_TYPE_HW_CACHE;
+    attr.config         = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                           | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    return (INT32)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static INT64 bench_tlb_read(INT32 fd) {
+    INT64 count = 0;
+    if ((fd < 0) || (sizeof(count) != read(fd, &count, sizeof(count)))) {
+        return -1;
+    }
+    return count;
+}
+
+static INT64 bench_faults() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt + usage.ru_majflt;
+}
+
+/*
+ * decoder writes a whole frame, and render reads it by lines of luma and
+ * chroma, which is what takes the TLB misses of 4K frames.
+ */
+static UINT32 bench_decode_frame(UINT8 *data, INT32 frame) {
+    UINT32 sum = 0;
+    memset(data, frame & 0xff, HUGEPAGE_TEST_FRAME);
+    for (INT32 x = 0; x < HUGEPAGE_TEST_W; x += 64) {
+        for (INT32 y = 0; y < HUGEPAGE_TEST_H * 3 / 2; y++) {
+            sum += data[y * HUGEPAGE_TEST_W + x];
+        }
+    }
+    return sum;
+}
+
+static RT_RET bench_allocator(RTAllocator *allocator, HugePageBench *bench) {
+    RTMediaBuffer *buffers[HUGEPAGE_TEST_POOL];
+    INT32  tlbFd = bench_tlb_open();
+    INT64  tlbs  = bench_tlb_read(tlbFd);
+    INT64  faults = bench_faults();
+    UINT32 sum = 0;
+    memset(bench, 0, sizeof(HugePageBench));
+
+    for (INT32 prepare = 0; prepare < HUGEPAGE_TEST_PREPARES; prepare++) {
+        INT64 startUs = RtTime::getNowTimeUs();
+        for (INT32 idx = 0; idx < HUGEPAGE_TEST_POOL; idx++) {
+            if (RT_OK != allocator->newBuffer(HUGEPAGE_TEST_FRAME, &buffers[idx])) {
+                return RT_ERR_NOMEM;
+            }
+        }
+        INT64 allocUs = RtTime::getNowTimeUs() - startUs;
+        if (0 == prepare) {
+            bench->mAllocUs = allocUs;
+        } else {
+            bench->mReallocUs += allocUs / (HUGEPAGE_TEST_PREPARES - 1);
+        }
+
+        startUs = RtTime::getNowTimeUs();
+        for (INT32 frame = 0; frame < HUGEPAGE_TEST_FRAMES; frame++) {
+            RTMediaBuffer *buffer = buffers[frame % HUGEPAGE_TEST_POOL];
+            sum += bench_decode_frame(reinterpret_cast<UINT8 *>(buffer->getData()), frame);
+        }
+        bench->mDecodeUs += RtTime::getNowTimeUs() - startUs;
+
+        for (INT32 idx = 0; idx < HUGEPAGE_TEST_POOL; idx++) {
+            allocator->freeBuffer(&buffers[idx]);
+        }
+    }
+
+    bench->mFaults    = bench_faults() - faults;
+    bench->mTlbMisses = (tlbs < 0) ? -1 : bench_tlb_read(tlbFd) - tlbs;
+    if (tlbFd >= 0) {
+        close(tlbFd);
+    }
+    RT_LOGD("checksum of frames: %u", sum);
+    return RT_OK;
+}
+
+// cap is of the process, and taken by allocators with it in config
+static void hugepage_test_set_cap(INT64 capBytes) {
+    RtMetaData *config = new RtMetaData();
+    config->setInt64(kKeyMemCacheCap, capBytes);
+    RTAllocator *allocator = new RTAllocatorHugePage(config);
+    rt_safe_delete(allocator);
+    rt_safe_delete(config);
+}
+
+static RT_RET hugepage_test_cache() {
+    RTAllocator   *allocator = RT_NULL;
+    RTMediaBuffer *buffers[HUGEPAGE_TEST_POOL];
+    RtHugePageStat stat;
+    RT_RET         err = RT_OK;
+
+    // cap of two frames
+    INT64 frameBytes = RT_ALIGN(HUGEPAGE_TEST_FRAME, RT_HUGEPAGE_SIZE);
+    hugepage_test_set_cap(frameBytes * 2);
+    RTAllocatorHugePage::trimCache();
+    allocator = new RTAllocatorHugePage(RT_NULL);
+
+    for (INT32 idx = 0; idx < HUGEPAGE_TEST_POOL; idx++) {
+        allocator->newBuffer(HUGEPAGE_TEST_FRAME, &buffers[idx]);
+        memset(buffers[idx]->getData(), idx, HUGEPAGE_TEST_FRAME);
+    }
+    for (INT32 idx = 0; idx < HUGEPAGE_TEST_POOL; idx++) {
+        allocator->freeBuffer(&buffers[idx]);
+    }
+    RTAllocatorHugePage::getStat(&stat);
+    if ((stat.mCachedBytes != frameBytes * 2) || (stat.mMappedBytes != stat.mCachedBytes)) {
+        RT_LOGE("cap is not kept: cached %lld mapped %lld", stat.mCachedBytes, stat.mMappedBytes);
+        err = RT_ERR_VALUE;
+    }
+
+    // buffers are taken from cache by next pool, and by another allocator
+    rt_safe_delete(allocator);
+    allocator = new RTAllocatorHugePage(RT_NULL);
+    INT32 hits = stat.mHits;
+    allocator->newBuffer(HUGEPAGE_TEST_FRAME, &buffers[0]);
+    allocator->newBuffer(HUGEPAGE_TEST_FRAME - 4096, &buffers[1]);
+    allocator->newBuffer(4096, &buffers[2]);
+    RTAllocatorHugePage::getStat(&stat);
+    if ((stat.mHits != hits + 2) || (0 != stat.mCachedBytes)) {
+        RT_LOGE("cache is not used: hits %d cached %lld", stat.mHits - hits, stat.mCachedBytes);
+        err = RT_ERR_VALUE;
+    }
+    for (INT32 idx = 0; idx < 3; idx++) {
+        allocator->freeBuffer(&buffers[idx]);
+    }
+
+    // lower cap trims cache at once
+    hugepage_test_set_cap(0);
+    RTAllocatorHugePage::getStat(&stat);
+    if ((0 != stat.mCachedBytes) || (0 != stat.mMappedBytes)) {
+        RT_LOGE("cache is not trimmed: cached %lld", stat.mCachedBytes);
+        err = RT_ERR_VALUE;
+    }
+    hugepage_test_set_cap(RT_HUGEPAGE_CACHE_CAP);
+
+    rt_safe_delete(allocator);
+    return err;
+}
+
+RT_RET unit_test_allocator_hugepage(INT32 index, INT32 total_index) {
+    RT_RET err = hugepage_test_cache();
+    if (RT_OK != err) {
+        return err;
+    }
+
+    HugePageBench  benchs[2];
+    RTAllocator   *allocators[2] = { new RTAllocatorMalloc(RT_NULL), new RTAllocatorHugePage(RT_NULL) };
+    const char    *names[2]      = { "malloc", "hugepage" };
+    for (INT32 idx = 0; idx < 2; idx++) {
+        err = bench_allocator(allocators[idx], &benchs[idx]);
+        if (RT_OK != err) {
+            break;
+        }
+        RT_LOGE("%-8s %d prepares of %d 4K frames: new %lldus, renew %lldus, decode %lldms, "
+                "faults %lld, dTLB misses %lld", names[idx], HUGEPAGE_TEST_PREPARES,
+                HUGEPAGE_TEST_POOL, benchs[idx].mAllocUs, benchs[idx].mReallocUs,
+                benchs[idx].mDecodeUs / 1000, benchs[idx].mFaults, benchs[idx].mTlbMisses);
+    }
+
+    RtHugePageStat stat;
+    RTAllocatorHugePage::getStat(&stat);
+    RT_LOGE("hugepage: mapped %lldKB, cached %lldKB, hugetlb %d, hits %d, misses %d",
+             stat.mMappedBytes >> 10, stat.mCachedBytes >> 10, stat.mHugeTlbs,
+             stat.mHits, stat.mMisses);
+    rt_safe_delete(allocators[0]);
+    rt_safe_delete(allocators[1]);
+    RTAllocatorHugePage::trimCache();
+    return err;
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: fd of memfd buffer is sent to a child process, which maps and
+ *         checks the frame and writes back, seals and recycle of regions.
+ */
+
+#include <string.h>                 // NOLINT
+#include <unistd.h>                 // NOLINT
+#include <sys/mman.h>               // NOLINT
+#include <sys/socket.h>             // NOLINT
+#include <sys/stat.h>               // NOLINT
+#include <sys/wait.h>               // NOLINT
+
+#include "rt_header.h"              // NOLINT
+#include "rt_media_tests.h"         // NOLINT
+#include "rt_metadata.h"            // NOLINT
+#include "RTAllocatorStore.h"       // NOLINT
+#include "RTAllocatorBase.h"        // NOLINT
+#include "RTMediaBuffer.h"          // NOLINT
+
+#define MEMFD_TEST_W                1920
+#define MEMFD_TEST_H                1080
+#define MEMFD_TEST_FRAME            (MEMFD_TEST_W * MEMFD_TEST_H * 3 / 2)
+#define MEMFD_TEST_MARK             0x5a
+
+// fd is sent like compositor takes it, not inherited by fork
+static RT_RET memfd_test_send_fd(INT32 sock, INT32 fd) {
+    char            byte = 0;
+    char            ctrl[CMSG_SPACE(sizeof(INT32))];
+    struct iovec    iov = { &byte, 1 };
+    struct msghdr   msg;
+    memset(&msg, 0, sizeof(msg));
+    memset(ctrl, 0, sizeof(ctrl));
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = ctrl;
+    msg.msg_controllen = sizeof(ctrl);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type  = SCM_RIGHTS;
+    cmsg->cmsg_len   = CMSG_LEN(sizeof(INT32));
+    memcpy(CMSG_DATA(cmsg), &fd, sizeof(INT32));
+    return (1 == sendmsg(sock, &msg, 0)) ? RT_OK : RT_ERR_BAD;
+}
+
+static INT32 memfd_test_recv_fd(INT32 sock) {
+    char            byte = 0;
+    char            ctrl[CMSG_SPACE(sizeof(INT32))];
+    struct iovec    iov = { &byte, 1 };
+    struct msghdr   msg;
+    INT32           fd = -1;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = ctrl;
+    msg.msg_controllen = sizeof(ctrl);
+    if (recvmsg(sock, &msg, 0) <= 0) {
+        return -1;
+    }
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if ((RT_NULL != cmsg) && (SCM_RIGHTS == cmsg->cmsg_type)) {
+        memcpy(&fd, CMSG_DATA(cmsg), sizeof(INT32));
+    }
+    return fd;
+}
+
+// child maps what it receives, and exits with 0 when frame is right
+static INT32 memfd_test_child(INT32 sock) {
+    INT32 fd = memfd_test_recv_fd(sock);
+    struct stat st;
+    if ((fd < 0) || (0 != fstat(fd, &st)) || (st.st_size < MEMFD_TEST_FRAME)) {
+        return 1;
+    }
+    UINT8 *data = reinterpret_cast<UINT8 *>(mmap(RT_NULL, st.st_size, PROT_READ | PROT_WRITE,
+                                                 MAP_SHARED, fd, 0));
+    if (MAP_FAILED == data) {
+        return 2;
+    }
+    for (INT32 idx = 0; idx < MEMFD_TEST_FRAME; idx += 4093) {
+        if (data[idx] != (UINT8)(idx & 0xff)) {
+            return 3;
+        }
+    }
+    // sealed against resize, so a reader can't cut the frame of others
+    if (0 == ftruncate(fd, 4096)) {
+        return 4;
+    }
+    data[MEMFD_TEST_FRAME - 1] = MEMFD_TEST_MARK;
+    munmap(data, st.st_size);
+    close(fd);
+    return 0;
+}
+
+static RT_RET memfd_test_share(RTMediaBuffer *buffer) {
+    UINT8 *data = reinterpret_cast<UINT8 *>(buffer->getData());
+    INT32  socks[2];
+    for (INT32 idx = 0; idx < MEMFD_TEST_FRAME; idx++) {
+        data[idx] = (UINT8)(idx & 0xff);
+    }
+    if (0 != socketpair(AF_UNIX, SOCK_STREAM, 0, socks)) {
+        return RT_ERR_BAD;
+    }
+
+    pid_t pid = fork();
+    if (0 == pid) {
+        close(socks[0]);
+        _exit(memfd_test_child(socks[1]));
+    }
+    close(socks[1]);
+    RT_RET err = (pid > 0) ? memfd_test_send_fd(socks[0], buffer->getFd()) : RT_ERR_BAD;
+    INT32  status = -1;
+    if (pid > 0) {
+        waitpid(pid, &status, 0);
+    }
+    close(socks[0]);
+
+    // write of child is in pages of parent, nothing is copied
+    if ((RT_OK != err) || !WIFEXITED(status) || (0 != WEXITSTATUS(status))
+         || (MEMFD_TEST_MARK != data[MEMFD_TEST_FRAME - 1])) {
+        RT_LOGE("child fails: status 0x%x, mark 0x%x", status, data[MEMFD_TEST_FRAME - 1]);
+        return RT_ERR_VALUE;
+    }
+    return RT_OK;
+}
+
+RT_RET unit_test_allocator_memfd(INT32 index, INT32 total_index) {
+    RTAllocatorStore *store     = new RTAllocatorStore();
+    RTAllocator      *allocator = RT_NULL;
+    RTMediaBuffer    *buffer    = RT_NULL;
+    RT_RET            err       = RT_OK;
+
+    store->fetchAllocator(RTAllocatorStore::RT_ALLOC_TYPE_MEMFD, RT_NULL, &allocator);
+    if (RT_NULL == allocator) {
+        RT_LOGE("memfd is not supported, skip it");
+        rt_safe_delete(store);
+        return RT_OK;
+    }
+
+    do {
+        err = allocator->newBuffer(MEMFD_TEST_FRAME, &buffer);
+        if ((RT_OK != err) || (buffer->getFd() <= 0)) {
+            RT_LOGE("memfd buffer fails: err %d", err);
+            err = RT_ERR_VALUE;
+            break;
+        }
+        err = memfd_test_share(buffer);
+        if (RT_OK != err) {
+            break;
+        }
+
+        // region of freed buffer is taken by next buffer of same pages
+        void  *data = buffer->getData();
+        INT32  fd   = buffer->getFd();
+        allocator->freeBuffer(&buffer);
+        allocator->newBuffer(MEMFD_TEST_FRAME - 100, &buffer);
+        if ((data != buffer->getData()) || (fd != buffer->getFd())) {
+            RT_LOGE("region is not recycled");
+            err = RT_ERR_VALUE;
+        }
+        allocator->freeBuffer(&buffer);
+    } while (0);
+
+    if (RT_NULL != buffer) {
+        allocator->freeBuffer(&buffer);
+    }
+    rt_safe_delete(allocator);
+    rt_safe_delete(store);
+    return err;
+}
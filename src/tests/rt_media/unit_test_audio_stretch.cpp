@@ -0,0 +1,266 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: audio time stretch, duration/clock/pitch error and cpu of each rate
+ */
+
+#include <math.h>               // NOLINT
+
+#include "rt_header.h"          // NOLINT
+#include "rt_media_tests.h"     // NOLINT
+#include "rt_time.h"            // NOLINT
+#include "RTAudioStretch.h"     // NOLINT
+
+#define STRETCH_TEST_RATE       44100
+#define STRETCH_TEST_CHANNELS   2
+#define STRETCH_TEST_SECONDS    8
+#define STRETCH_TEST_CHUNK      1024                // frames of one decoded frame
+#define STRETCH_TEST_WINDOW     16384               // frames of pitch analysis
+#define STRETCH_MAX_DURATION    0.02f
+#define STRETCH_MAX_PITCH       0.01f
+
+enum StretchSignal {
+    STRETCH_SIGNAL_SPEECH = 0,  // voiced speech like: 140Hz harmonics, 4Hz syllables
+    STRETCH_SIGNAL_MUSIC,       // major chord and a high tone, 55Hz common period
+};
+
+static const float gStretchRates[] = { 0.5f, 0.75f, 1.0f, 1.25f, 1.5f, 2.0f };
+static const float gSwitchRates[]  = { 1.0f, 1.5f, 0.75f, 1.0f, 2.0f, 0.5f };
+
+typedef struct _StretchTestStat {
+    INT64   mOutFrames;
+    INT64   mEndPtsUs;
+    INT64   mConsumedUs;
+    INT64   mCostUs;
+} StretchTestStat;
+
+static float stretch_signal(INT32 signal, INT32 frame) {
+    double t = static_cast<double>(frame) / STRETCH_TEST_RATE;
+    double v = 0.0;
+    if (STRETCH_SIGNAL_SPEECH == signal) {
+        for (INT32 k = 1; k <= 8; k++) {
+            v += sin(2 * M_PI * 140 * k * t) / k;
+        }
+        v *= (0.55 + 0.45 * sin(2 * M_PI * 4 * t)) * 0.8 / 2.72;
+    } else {
+        v = 0.22 * (sin(2 * M_PI * 220 * t) + sin(2 * M_PI * 275 * t) + sin(2 * M_PI * 330 * t))
+          + 0.1 * sin(2 * M_PI * 880 * t);
+    }
+    return static_cast<float>(v);
+}
+
+static INT32 stretch_frame_bytes(RTSampleFormat format) {
+    return STRETCH_TEST_CHANNELS * ((RT_SAMPLE_FMT_FLT == format) ? sizeof(float) : sizeof(INT16));
+}
+
+static void stretch_make_input(INT32 signal, RTSampleFormat format, UINT8 *data, INT32 frames) {
+    for (INT32 frame = 0; frame < frames; frame++) {
+        float v = stretch_signal(signal, frame);
+        for (INT32 ch = 0; ch < STRETCH_TEST_CHANNELS; ch++) {
+            INT32 idx = frame * STRETCH_TEST_CHANNELS + ch;
+            if (RT_SAMPLE_FMT_FLT == format) {
+                reinterpret_cast<float *>(data)[idx] = v;
+            } else {
+                reinterpret_cast<INT16 *>(data)[idx] = (INT16)(v * 32767);
+            }
+        }
+    }
+}
+
+// first channel of pcm, in [-1, 1]
+static void stretch_to_mono(const UINT8 *data, RTSampleFormat format, INT64 start, INT32 frames, float *mono) {
+    for (INT32 frame = 0; frame < frames; frame++) {
+        INT64 idx = (start + frame) * STRETCH_TEST_CHANNELS;
+        if (RT_SAMPLE_FMT_FLT == format) {
+            mono[frame] = reinterpret_cast<const float *>(data)[idx];
+        } else {
+            mono[frame] = reinterpret_cast<const INT16 *>(data)[idx] / 32768.0f;
+        }
+    }
+}
+
+/*
+ * pitch period in frames: the first autocorrelation peak near the highest
+ * one, refined by parabola.
+ */
+static float stretch_pitch_period(const float *mono, INT32 frames) {
+    INT32  minLag = STRETCH_TEST_RATE / 1000;
+    INT32  maxLag = STRETCH_TEST_RATE / 50;
+    INT32  count  = frames - maxLag - 1;
+    float *ac     = rt_malloc_array(float, maxLag + 2);
+    float  best   = 0.0f;
+    for (INT32 lag = minLag - 1; lag <= maxLag + 1; lag++) {
+        double corr = 0.0, norm0 = 0.0, norm1 = 0.0;
+        for (INT32 idx = 0; idx < count; idx++) {
+            corr  += mono[idx] * mono[idx + lag];
+            norm0 += mono[idx] * mono[idx];
+            norm1 += mono[idx + lag] * mono[idx + lag];
+        }
+        ac[lag] = static_cast<float>(corr / sqrt(norm0 * norm1 + 1e-9));
+        if ((lag >= minLag) && (lag <= maxLag)) {
+            best = RT_MAX(best, ac[lag]);
+        }
+    }
+
+    float period = 0.0f;
+    for (INT32 lag = minLag; lag <= maxLag; lag++) {
+        if ((ac[lag] > 0.9f * best) && (ac[lag] >= ac[lag - 1]) && (ac[lag] >= ac[lag + 1])) {
+            float denom = ac[lag - 1] - 2 * ac[lag] + ac[lag + 1];
+            period = lag + ((denom < 0.0f) ? 0.5f * (ac[lag - 1] - ac[lag + 1]) / denom : 0.0f);
+            break;
+        }
+    }
+    rt_safe_free(ac);
+    return period;
+}
+
+static float stretch_max_step(const float *mono, INT32 frames) {
+    float step = 0.0f;
+    for (INT32 idx = 1; idx < frames; idx++) {
+        step = RT_MAX(step, fabsf(mono[idx] - mono[idx - 1]));
+    }
+    return step;
+}
+
+/*
+ * input is fed as decoded frames, rate changes every period frames.
+ */
+static void stretch_run(const UINT8 *input, INT32 inFrames, RTSampleFormat format,
+                        const float *rates, INT32 count, INT32 period,
+                        UINT8 *output, INT64 capacity, StretchTestStat *stat) {
+    INT32 fb       = stretch_frame_bytes(format);
+    INT64 outBytes = 0;
+    RTAudioStretch *stretch = new RTAudioStretch(STRETCH_TEST_RATE, STRETCH_TEST_CHANNELS, format);
+
+    INT64 startUs = RtTime::getNowTimeUs();
+    for (INT32 frame = 0; frame < inFrames; frame += STRETCH_TEST_CHUNK) {
+        INT32 frames = RT_MIN(STRETCH_TEST_CHUNK, inFrames - frame);
+        stretch->setRate(rates[(frame / period) % count]);
+        stretch->queueInput(input + frame * fb, frames * fb, frame * 1000000ll / STRETCH_TEST_RATE);
+        outBytes += stretch->readOutput(output + outBytes, (INT32)(capacity - outBytes));
+    }
+    stat->mCostUs     = RtTime::getNowTimeUs() - startUs;
+    stat->mOutFrames  = outBytes / fb;
+    stat->mEndPtsUs   = stretch->getOutputPts();
+    stat->mConsumedUs = (inFrames - stretch->pendingInput() / fb) * 1000000ll / STRETCH_TEST_RATE;
+    rt_safe_delete(stretch);
+}
+
+static RT_RET stretch_test_signal(INT32 signal, RTSampleFormat format) {
+    RT_RET err      = RT_OK;
+    INT32  fb       = stretch_frame_bytes(format);
+    INT32  inFrames = STRETCH_TEST_RATE * STRETCH_TEST_SECONDS;
+    INT64  capacity = (INT64)inFrames * fb * 2 + STRETCH_TEST_RATE * fb;
+    UINT8 *input    = rt_malloc_size(UINT8, inFrames * fb);
+    UINT8 *output   = rt_malloc_size(UINT8, capacity);
+    float *mono     = rt_malloc_array(float, STRETCH_TEST_WINDOW);
+    const char *name = (STRETCH_SIGNAL_SPEECH == signal) ? "speech" : "music";
+
+    stretch_make_input(signal, format, input, inFrames);
+    stretch_to_mono(input, format, inFrames / 2, STRETCH_TEST_WINDOW, mono);
+    float inPeriod = stretch_pitch_period(mono, STRETCH_TEST_WINDOW);
+
+    for (INT32 idx = 0; idx < (INT32)RT_ARRAY_ELEMS(gStretchRates); idx++) {
+        StretchTestStat stat;
+        float rate = gStretchRates[idx];
+        stretch_run(input, inFrames, format, &rate, 1, inFrames, output, capacity, &stat);
+
+        float expect   = inFrames / rate;
+        float duration = fabsf(stat.mOutFrames - expect) / expect;
+        float clock    = fabsf(static_cast<float>(stat.mEndPtsUs - stat.mConsumedUs)) / stat.mConsumedUs;
+        stretch_to_mono(output, format, stat.mOutFrames / 2 - STRETCH_TEST_WINDOW / 2, STRETCH_TEST_WINDOW, mono);
+        float pitch    = fabsf(stretch_pitch_period(mono, STRETCH_TEST_WINDOW) - inPeriod) / inPeriod;
+        float speed    = (stat.mCostUs > 0) ? stat.mOutFrames * 1000000.0f / STRETCH_TEST_RATE / stat.mCostUs : 0.0f;
+        RT_LOGE("%-6s %-5s | %4.2f | %6.2f%% | %6.2f%% | %6.2f%% | %8.1f",
+                 name, (RT_SAMPLE_FMT_FLT == format) ? "float" : "s16", rate,
+                 duration * 100, clock * 100, pitch * 100, speed);
+        if ((duration > STRETCH_MAX_DURATION) || (clock > STRETCH_MAX_DURATION) || (pitch > STRETCH_MAX_PITCH)) {
+            err = RT_ERR_VALUE;
+        }
+    }
+
+    rt_safe_free(input);
+    rt_safe_free(output);
+    rt_safe_free(mono);
+    return err;
+}
+
+/*
+ * rate is changed on the fly, there must be no click at the changes.
+ */
+static RT_RET stretch_test_switch(RTSampleFormat format) {
+    RT_RET err      = RT_OK;
+    INT32  fb       = stretch_frame_bytes(format);
+    INT32  inFrames = STRETCH_TEST_RATE * STRETCH_TEST_SECONDS;
+    INT64  capacity = (INT64)inFrames * fb * 2 + STRETCH_TEST_RATE * fb;
+    UINT8 *input    = rt_malloc_size(UINT8, inFrames * fb);
+    UINT8 *output   = rt_malloc_size(UINT8, capacity);
+    float *mono     = rt_malloc_array(float, inFrames * 2);
+
+    StretchTestStat stat;
+    stretch_make_input(STRETCH_SIGNAL_SPEECH, format, input, inFrames);
+    stretch_to_mono(input, format, 0, inFrames, mono);
+    float inStep = stretch_max_step(mono, inFrames);
+    stretch_run(input, inFrames, format, gSwitchRates, RT_ARRAY_ELEMS(gSwitchRates),
+                STRETCH_TEST_RATE / 2, output, capacity, &stat);
+    stretch_to_mono(output, format, 0, (INT32)stat.mOutFrames, mono);
+    float outStep = stretch_max_step(mono, (INT32)stat.mOutFrames);
+    float clock   = fabsf(static_cast<float>(stat.mEndPtsUs - stat.mConsumedUs)) / stat.mConsumedUs;
+
+    RT_LOGE("switch %-5s | max step: %.4f of %.4f, clock: %.2f%%",
+             (RT_SAMPLE_FMT_FLT == format) ? "float" : "s16", outStep, inStep, clock * 100);
+    if ((outStep > inStep * 1.5f) || (clock > STRETCH_MAX_DURATION)) {
+        err = RT_ERR_VALUE;
+    }
+
+    rt_safe_free(input);
+    rt_safe_free(output);
+    rt_safe_free(mono);
+    return err;
+}
+
+RT_RET unit_test_audio_stretch(INT32 index, INT32 total_index) {
+    (void)index;
+    (void)total_index;
+    RT_RET err = RT_OK;
+
+    RT_LOGE("signal format | rate | duration |   clock |   pitch | x realtime");
+    do {
+        err = stretch_test_signal(STRETCH_SIGNAL_SPEECH, RT_SAMPLE_FMT_S16);
+        if (RT_OK != err) {
+            break;
+        }
+        err = stretch_test_signal(STRETCH_SIGNAL_MUSIC, RT_SAMPLE_FMT_S16);
+        if (RT_OK != err) {
+            break;
+        }
+        err = stretch_test_signal(STRETCH_SIGNAL_SPEECH, RT_SAMPLE_FMT_FLT);
+        if (RT_OK != err) {
+            break;
+        }
+        err = stretch_test_signal(STRETCH_SIGNAL_MUSIC, RT_SAMPLE_FMT_FLT);
+        if (RT_OK != err) {
+            break;
+        }
+        err = stretch_test_switch(RT_SAMPLE_FMT_S16);
+        if (RT_OK != err) {
+            break;
+        }
+        err = stretch_test_switch(RT_SAMPLE_FMT_FLT);
+    } while (0);
+
+    RT_LOGE("audio stretch %s", (RT_OK == err) ? "PASS" : "FAIL");
+    return err;
+}
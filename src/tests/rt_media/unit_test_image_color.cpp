@@ -0,0 +1,203 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: yuv to rgb, kernels of simd against the scalar one, and Mpix/s
+ */
+
+#include <math.h>               // NOLINT
+#include <stdlib.h>             // NOLINT
+#include <string.h>             // NOLINT
+
+#include "rt_header.h"          // NOLINT
+#include "rt_media_tests.h"     // NOLINT
+#include "rt_cpu_info.h"        // NOLINT
+#include "rt_time.h"            // NOLINT
+#include "RTImageColor.h"       // NOLINT
+
+#define COLOR_TEST_MAX_W        67
+#define COLOR_TEST_MAX_H        7
+#define COLOR_TEST_PADDING      13          // extra bytes of strides
+#define COLOR_BENCH_W           1920
+#define COLOR_BENCH_H           1080
+#define COLOR_BENCH_LOOPS       20
+
+static const RtVideoFormat    gColorInputs[]  = { RT_FMT_YUV420P, RT_FMT_YUV420SP, RT_FMT_YUV420SP_VU };
+static const RTImageRGBFormat gColorOutputs[] = { RT_IMAGE_RGB24, RT_IMAGE_RGBA32, RT_IMAGE_BGRA32 };
+static const char*            gInputNames[]   = { "I420", "NV12", "NV21" };
+static const char*            gOutputNames[]  = { "RGB24", "RGBA", "BGRA" };
+
+typedef struct _ColorTestImage {
+    UINT8      *mData;
+    RTImageYUV  mYUV;
+} ColorTestImage;
+
+// planes are filled by random bytes, strides are padded
+static void color_make_image(RtVideoFormat format, INT32 width, INT32 height, INT32 padding,
+                             ColorTestImage *image) {
+    INT32 chromaW = (width + 1) / 2;
+    INT32 chromaH = (height + 1) / 2;
+    INT32 yStride = width + padding;
+    INT32 cStride = ((RT_FMT_YUV420P == format) ? chromaW : chromaW * 2) + padding;
+    INT32 size    = yStride * height + cStride * chromaH * 2;
+
+    image->mData = rt_malloc_size(UINT8, size);
+    for (INT32 idx = 0; idx < size; idx++) {
+        image->mData[idx] = (UINT8)rand();
+    }
+    rt_memset(&image->mYUV, 0, sizeof(RTImageYUV));
+    image->mYUV.mPlane[0]  = image->mData;
+    image->mYUV.mPlane[1]  = image->mData + yStride * height;
+    image->mYUV.mPlane[2]  = image->mYUV.mPlane[1] + cStride * chromaH;
+    image->mYUV.mStride[0] = yStride;
+    image->mYUV.mStride[1] = cStride;
+    image->mYUV.mStride[2] = cStride;
+    image->mYUV.mWidth     = width;
+    image->mYUV.mHeight    = height;
+    image->mYUV.mFormat    = format;
+}
+
+// every size up to 4 steps of simd, with odd width and height
+static RT_RET color_test_exact(UINT32 features) {
+    INT32  dstStride = COLOR_TEST_MAX_W * 4 + COLOR_TEST_PADDING;
+    UINT8 *expect    = rt_malloc_size(UINT8, dstStride * COLOR_TEST_MAX_H);
+    UINT8 *actual    = rt_malloc_size(UINT8, dstStride * COLOR_TEST_MAX_H);
+    INT32  failed    = 0;
+    INT32  count     = 0;
+    for (UINT32 in = 0; in < RT_ARRAY_ELEMS(gColorInputs); in++) {
+        for (INT32 width = 1; width <= COLOR_TEST_MAX_W; width++) {
+            for (INT32 height = 1; height <= COLOR_TEST_MAX_H; height += 3) {
+                ColorTestImage image;
+                color_make_image(gColorInputs[in], width, height, COLOR_TEST_PADDING, &image);
+                for (UINT32 out = 0; out < RT_ARRAY_ELEMS(gColorOutputs); out++) {
+                    for (INT32 mode = 0; mode < 4; mode++) {
+                        RTColorSpace space = (mode & 1) ? RTCOL_SPC_BT709 : RTCOL_SPC_BT470BG;
+                        RTColorRange range = (mode & 2) ? RTCOL_RANGE_JPEG : RTCOL_RANGE_MPEG;
+                        rt_memset(expect, 0, dstStride * height);
+                        rt_memset(actual, 0, dstStride * height);
+                        rt_image_color_set_features(0);
+                        rt_image_yuv_to_rgb(&image.mYUV, expect, dstStride, gColorOutputs[out], space, range);
+                        rt_image_color_set_features(features);
+                        rt_image_yuv_to_rgb(&image.mYUV, actual, dstStride, gColorOutputs[out], space, range);
+                        count++;
+                        if (0 != memcmp(expect, actual, dstStride * height)) {
+                            RT_LOGE("%s to %s %dx%d mode(%d) differs from the scalar one",
+                                     gInputNames[in], gOutputNames[out], width, height, mode);
+                            failed++;
+                        }
+                    }
+                }
+                rt_safe_free(image.mData);
+            }
+        }
+    }
+    RT_LOGE("features 0x%x: %d of %d conversions are the same as the scalar one",
+             features, count - failed, count);
+
+    rt_safe_free(expect);
+    rt_safe_free(actual);
+    return (0 == failed) ? RT_OK : RT_ERR_VALUE;
+}
+
+// gray and primaries of BT.601/BT.709 against the formula in double
+static RT_RET color_test_formula() {
+    static const double kr[2] = { 0.299, 0.2126 };
+    static const double kb[2] = { 0.114, 0.0722 };
+    INT32 worst = 0;
+    for (INT32 mode = 0; mode < 4; mode++) {
+        INT32   bt709 = mode & 1;
+        RT_BOOL full  = (mode & 2) ? RT_TRUE : RT_FALSE;
+        for (INT32 sample = 0; sample < 256; sample++) {
+            UINT8 y = (UINT8)sample, u = (UINT8)(255 - sample), v = (UINT8)(sample * 7);
+            UINT8 rgb[3];
+            RTImageYUV yuv;
+            rt_memset(&yuv, 0, sizeof(RTImageYUV));
+            yuv.mPlane[0] = &y;
+            yuv.mPlane[1] = &u;
+            yuv.mPlane[2] = &v;
+            yuv.mWidth    = 1;
+            yuv.mHeight   = 1;
+            yuv.mFormat   = RT_FMT_YUV420P;
+            rt_image_yuv_to_rgb(&yuv, rgb, 3, RT_IMAGE_RGB24, bt709 ? RTCOL_SPC_BT709 : RTCOL_SPC_BT470BG,
+                                full ? RTCOL_RANGE_JPEG : RTCOL_RANGE_MPEG);
+
+            double l  = full ? y : (y - 16) * 255.0 / 219;
+            double cb = full ? (u - 128) : (u - 128) * 255.0 / 224;
+            double cr = full ? (v - 128) : (v - 128) * 255.0 / 224;
+            double r  = l + 2 * (1 - kr[bt709]) * cr;
+            double b  = l + 2 * (1 - kb[bt709]) * cb;
+            double g  = (l - kr[bt709] * r - kb[bt709] * b) / (1 - kr[bt709] - kb[bt709]);
+            double ref[3] = { r, g, b };
+            for (INT32 ch = 0; ch < 3; ch++) {
+                INT32 expect = (INT32)floor(RT_MIN(RT_MAX(ref[ch], 0.0), 255.0) + 0.5);
+                worst = RT_MAX(worst, abs(expect - rgb[ch]));
+            }
+        }
+    }
+    RT_LOGE("max error against formula: %d", worst);
+    return (worst <= 1) ? RT_OK : RT_ERR_VALUE;
+}
+
+static void color_bench(UINT32 features, const char *name) {
+    ColorTestImage image;
+    INT32  dstStride = COLOR_BENCH_W * 4;
+    UINT8 *dst       = rt_malloc_size(UINT8, dstStride * COLOR_BENCH_H);
+    rt_image_color_set_features(features);
+    for (UINT32 in = 0; in < RT_ARRAY_ELEMS(gColorInputs); in++) {
+        color_make_image(gColorInputs[in], COLOR_BENCH_W, COLOR_BENCH_H, 0, &image);
+        for (UINT32 out = 0; out < RT_ARRAY_ELEMS(gColorOutputs); out++) {
+            INT64 beginUs = RtTime::getNowTimeUs();
+            for (INT32 loop = 0; loop < COLOR_BENCH_LOOPS; loop++) {
+                rt_image_yuv_to_rgb(&image.mYUV, dst, dstStride, gColorOutputs[out]);
+            }
+            INT64 costUs = RT_MAX(RtTime::getNowTimeUs() - beginUs, 1ll);
+            RT_LOGE("  %-6s | %s to %-5s | %8.1f Mpix/s", name, gInputNames[in], gOutputNames[out],
+                     (double)COLOR_BENCH_W * COLOR_BENCH_H * COLOR_BENCH_LOOPS / costUs);
+        }
+        rt_safe_free(image.mData);
+    }
+    rt_safe_free(dst);
+}
+
+RT_RET unit_test_image_color(INT32 index, INT32 total_index) {
+    (void)index;
+    (void)total_index;
+    UINT32 features = rt_cpu_features();
+    RT_RET err      = RT_OK;
+    srand(19);
+
+    do {
+        err = color_test_formula();
+        if (RT_OK != err) {
+            break;
+        }
+        // each kernel which runs on this cpu, and the best one
+        err = color_test_exact(features & (RT_CPU_FEATURE_SSE2 | RT_CPU_FEATURE_NEON));
+        if (RT_OK != err) {
+            break;
+        }
+        err = color_test_exact(features);
+    } while (0);
+
+    RT_LOGE("  kernel | conversion    |     speed");
+    color_bench(0, "scalar");
+    color_bench(features & (RT_CPU_FEATURE_SSE2 | RT_CPU_FEATURE_NEON), "simd");
+    if (features & RT_CPU_FEATURE_AVX2) {
+        color_bench(features, "avx2");
+    }
+    rt_image_color_set_features(~0u);
+
+    RT_LOGE("image color %s", (RT_OK == err) ? "PASS" : "FAIL");
+    return err;
+}
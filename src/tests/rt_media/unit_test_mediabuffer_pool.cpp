@@ -62,6 +62,7 @@ RT_RET unit_test_mediabuffer_pool(INT32 index, INT32 total_index) {
         const char* name = "mediabuffer_pool_test";
         thread = new RtThread(test_loop, pool);
         thread->setName(name);
+        pool->start();
 
         store->priorAvailLinearAllocator(config,
                                          &allocator);
@@ -0,0 +1,283 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: buffers of pool are shared by threads and returned exactly once,
+ *         packets of buffers are freed once by their last holder, buffers
+ *         in use are freed once after pool is released, and throughput of
+ *         release. it is kept clean of -fsanitize=thread.
+ */
+
+#include "rt_header.h"              // NOLINT
+#include "rt_media_tests.h"         // NOLINT
+#include "rt_thread.h"              // NOLINT
+#include "rt_time.h"                // NOLINT
+#include "RTAllocatorMalloc.h"      // NOLINT
+#include "RTMediaBuffer.h"          // NOLINT
+#include "RTMediaBufferPool.h"      // NOLINT
+
+#define REFS_TEST_BUFFERS       8
+#define REFS_TEST_BUFFER_SIZE   4096
+#define REFS_TEST_PAIRS         4       // producer and consumer threads
+#define REFS_TEST_ROUNDS        20000   // buffers of one producer
+#define REFS_TEST_QUEUE         16
+#define REFS_DETACH_ROUNDS      1000    // last release races with release of pool
+#define REFS_BENCH_THREADS      4
+#define REFS_BENCH_RELEASES     (1 << 20)
+
+// packet which is attached to buffer, like packet of decoder
+typedef struct _RefsTestPacket {
+    UINT32          mSeq;
+} RefsTestPacket;
+
+static INT32 gRefsPackets = 0;          // packets which are not freed
+
+static INT32 refs_test_packet_free(void *packet) {
+    (void)__atomic_fetch_sub(&gRefsPackets, 1, __ATOMIC_RELAXED);
+    rt_free(packet);
+    return 0;
+}
+
+static void refs_test_packet_attach(RTMediaBuffer *buffer, UINT32 seq) {
+    RefsTestPacket *packet = rt_malloc(RefsTestPacket);
+    packet->mSeq = seq;
+    (void)__atomic_fetch_add(&gRefsPackets, 1, __ATOMIC_RELAXED);
+    buffer->getMetaData()->setPointer(kKeyPacketPtr, packet);
+}
+
+// buffer of allocator, which frees its packet by refs_test_packet_free
+static RTMediaBuffer* refs_test_buffer_new(RTAllocator *allocator) {
+    RTMediaBuffer *buffer = RT_NULL;
+    allocator->newBuffer(REFS_TEST_BUFFER_SIZE, &buffer);
+    buffer->setData(buffer->getData(), buffer->getSize(), refs_test_packet_free);
+    return buffer;
+}
+
+// pool which counts buffers returned to it
+class RefsTestPool : public RTMediaBufferPool {
+ public:
+    RefsTestPool() : RTMediaBufferPool(REFS_TEST_BUFFERS, REFS_TEST_BUFFER_SIZE), mReturns(0) {}
+    virtual void signalBufferReturned(RTMediaBuffer *buffer) {
+        if (RT_NULL != buffer) {
+            (void)__atomic_fetch_add(&mReturns, 1, __ATOMIC_RELAXED);
+        }
+        RTMediaBufferPool::signalBufferReturned(buffer);
+    }
+    INT64 mReturns;
+};
+
+// allocator which counts buffers freed by it
+class RefsTestAllocator : public RTAllocatorMalloc {
+ public:
+    RefsTestAllocator() : RTAllocatorMalloc(RT_NULL), mFrees(0) {}
+    virtual RT_RET freeBuffer(RTMediaBuffer **buffer) {
+        (void)__atomic_fetch_add(&mFrees, 1, __ATOMIC_RELAXED);
+        return RTAllocatorMalloc::freeBuffer(buffer);
+    }
+    INT32 mFrees;
+};
+
+// queue of one producer and one consumer
+typedef struct _RefsTestQueue {
+    RTMediaBuffer  *mBuffers[REFS_TEST_QUEUE];
+    UINT32          mHead;
+    UINT32          mTail;
+    RefsTestPool   *mPool;
+    INT32           mCorrupts;
+} RefsTestQueue;
+
+static void* refs_test_producer(void *param) {
+    RefsTestQueue *queue = reinterpret_cast<RefsTestQueue *>(param);
+    for (UINT32 seq = 0; seq < REFS_TEST_ROUNDS; seq++) {
+        RTMediaBuffer *out = RT_NULL;
+        queue->mPool->acquireBuffer(&out, RT_TRUE);
+        RTMediaBufferRef buffer(out);
+        *reinterpret_cast<UINT32 *>(buffer->getData()) = seq;
+        refs_test_packet_attach(buffer.get(), seq);
+
+        UINT32 head = __atomic_load_n(&queue->mHead, __ATOMIC_RELAXED);
+        while (head - __atomic_load_n(&queue->mTail, __ATOMIC_ACQUIRE) >= REFS_TEST_QUEUE) {
+            RtTime::sleepUs(10);
+        }
+        // consumer takes a reference, and last one of both returns buffer
+        queue->mBuffers[head % REFS_TEST_QUEUE] = buffer.share().detach();
+        __atomic_store_n(&queue->mHead, head + 1, __ATOMIC_RELEASE);
+    }
+    return RT_NULL;
+}
+
+static void* refs_test_consumer(void *param) {
+    RefsTestQueue *queue = reinterpret_cast<RefsTestQueue *>(param);
+    for (UINT32 seq = 0; seq < REFS_TEST_ROUNDS; seq++) {
+        UINT32 tail = __atomic_load_n(&queue->mTail, __ATOMIC_RELAXED);
+        while (__atomic_load_n(&queue->mHead, __ATOMIC_ACQUIRE) == tail) {
+            RtTime::sleepUs(10);
+        }
+        RTMediaBufferRef buffer(queue->mBuffers[tail % REFS_TEST_QUEUE]);
+        __atomic_store_n(&queue->mTail, tail + 1, __ATOMIC_RELEASE);
+        void *packet = RT_NULL;
+        buffer->getMetaData()->findPointer(kKeyPacketPtr, &packet);
+        if ((*reinterpret_cast<UINT32 *>(buffer->getData()) != seq) || (RT_NULL == packet)
+              || (reinterpret_cast<RefsTestPacket *>(packet)->mSeq != seq)) {
+            queue->mCorrupts++;
+        }
+    }
+    return RT_NULL;
+}
+
+static RT_RET refs_test_pool() {
+    RefsTestAllocator *allocator = new RefsTestAllocator();
+    RefsTestPool      *pool      = new RefsTestPool();
+    RefsTestQueue      queues[REFS_TEST_PAIRS];
+    RtThread          *threads[REFS_TEST_PAIRS * 2];
+    RT_RET             err = RT_OK;
+
+    for (INT32 idx = 0; idx < REFS_TEST_BUFFERS; idx++) {
+        pool->registerBuffer(refs_test_buffer_new(allocator));
+    }
+    pool->start();
+
+    INT64 startUs = RtTime::getNowTimeUs();
+    for (INT32 idx = 0; idx < REFS_TEST_PAIRS; idx++) {
+        rt_memset(&queues[idx], 0, sizeof(RefsTestQueue));
+        queues[idx].mPool = pool;
+        threads[idx * 2]     = new RtThread(refs_test_producer, &queues[idx]);
+        threads[idx * 2 + 1] = new RtThread(refs_test_consumer, &queues[idx]);
+        threads[idx * 2]->start();
+        threads[idx * 2 + 1]->start();
+    }
+    INT32 corrupts = 0;
+    for (INT32 idx = 0; idx < REFS_TEST_PAIRS * 2; idx++) {
+        threads[idx]->join();
+        rt_safe_delete(threads[idx]);
+    }
+    for (INT32 idx = 0; idx < REFS_TEST_PAIRS; idx++) {
+        corrupts += queues[idx].mCorrupts;
+    }
+    INT64 costUs = RtTime::getNowTimeUs() - startUs;
+
+    INT64 returns = __atomic_load_n(&pool->mReturns, __ATOMIC_RELAXED);
+    INT32 packets = __atomic_load_n(&gRefsPackets, __ATOMIC_RELAXED);
+    RT_LOGE("%d threads passed %d buffers of pool in %lldms, returns %lld, corrupts %d, packets %d",
+             REFS_TEST_PAIRS * 2, REFS_TEST_PAIRS * REFS_TEST_ROUNDS, costUs / 1000,
+             returns, corrupts, packets);
+    if ((returns != REFS_TEST_PAIRS * REFS_TEST_ROUNDS) || (0 != corrupts) || (0 != packets)) {
+        err = RT_ERR_VALUE;
+    }
+
+    // buffers in use are freed by their last release after pool is gone
+    RTMediaBuffer *out = RT_NULL;
+    pool->acquireBuffer(&out, RT_FALSE);
+    RTMediaBufferRef inUse(out);
+    RTMediaBufferRef shared = inUse.share();
+    refs_test_packet_attach(inUse.get(), 0);
+    pool->stop();
+    rt_safe_delete(pool);
+    if (allocator->mFrees != REFS_TEST_BUFFERS - 1) {
+        RT_LOGE("idle buffers of pool are not freed, frees %d", allocator->mFrees);
+        err = RT_ERR_VALUE;
+    }
+    inUse.reset();
+    shared.reset();
+    if ((allocator->mFrees != REFS_TEST_BUFFERS) || (0 != gRefsPackets)) {
+        RT_LOGE("buffer in use is not freed once, frees %d, packets %d",
+                 allocator->mFrees, gRefsPackets);
+        err = RT_ERR_VALUE;
+    }
+    rt_safe_delete(allocator);
+    return err;
+}
+
+static void* refs_detach_release(void *param) {
+    reinterpret_cast<RTMediaBuffer *>(param)->release();
+    return RT_NULL;
+}
+
+// buffer is freed once, whether its last release or release of pool wins
+static RT_RET refs_test_detach() {
+    RefsTestAllocator *allocator = new RefsTestAllocator();
+    for (INT32 round = 0; round < REFS_DETACH_ROUNDS; round++) {
+        RefsTestPool *pool = new RefsTestPool();
+        pool->registerBuffer(refs_test_buffer_new(allocator));
+        pool->start();
+        RTMediaBuffer *buffer = RT_NULL;
+        pool->acquireBuffer(&buffer, RT_FALSE);
+        refs_test_packet_attach(buffer, round);
+
+        RtThread *thread = new RtThread(refs_detach_release, buffer);
+        thread->start();
+        pool->stop();
+        rt_safe_delete(pool);
+        thread->join();
+        rt_safe_delete(thread);
+    }
+
+    RT_LOGE("%d buffers raced with release of pool, frees %d, packets %d",
+             REFS_DETACH_ROUNDS, allocator->mFrees, gRefsPackets);
+    RT_RET err = ((REFS_DETACH_ROUNDS == allocator->mFrees) && (0 == gRefsPackets))
+                     ? RT_OK : RT_ERR_VALUE;
+    rt_safe_delete(allocator);
+    return err;
+}
+
+static void* refs_bench_release(void *param) {
+    RTMediaBuffer *buffer = reinterpret_cast<RTMediaBuffer *>(param);
+    for (INT32 idx = 0; idx < REFS_BENCH_RELEASES / REFS_BENCH_THREADS; idx++) {
+        buffer->release();
+    }
+    return RT_NULL;
+}
+
+// one buffer which is referenced by all threads, the worst of contention
+static RT_RET refs_bench(INT32 threadCount) {
+    RefsTestAllocator *allocator = new RefsTestAllocator();
+    RtThread          *threads[REFS_BENCH_THREADS];
+    RTMediaBuffer     *buffer    = RT_NULL;
+    allocator->newBuffer(REFS_TEST_BUFFER_SIZE, &buffer);
+    for (INT32 idx = 0; idx < REFS_BENCH_RELEASES / REFS_BENCH_THREADS * threadCount; idx++) {
+        buffer->addRefs();
+    }
+
+    INT64 startUs = RtTime::getNowTimeUs();
+    for (INT32 idx = 0; idx < threadCount; idx++) {
+        threads[idx] = new RtThread(refs_bench_release, buffer);
+        threads[idx]->start();
+    }
+    for (INT32 idx = 0; idx < threadCount; idx++) {
+        threads[idx]->join();
+        rt_safe_delete(threads[idx]);
+    }
+    INT64 costUs = RT_MAX(RtTime::getNowTimeUs() - startUs, 1ll);
+    INT32 releases = REFS_BENCH_RELEASES / REFS_BENCH_THREADS * threadCount;
+    RT_LOGE("%d threads: %d releases in %lldus, %lld releases/ms", threadCount, releases,
+             costUs, (INT64)releases * 1000 / costUs);
+
+    RT_RET err = (1 == allocator->mFrees) ? RT_OK : RT_ERR_VALUE;
+    rt_safe_delete(allocator);
+    return err;
+}
+
+RT_RET unit_test_mediabuffer_refs(INT32 index, INT32 total_index) {
+    RT_RET err = refs_test_pool();
+    if (RT_OK == err) {
+        err = refs_test_detach();
+    }
+    if (RT_OK == err) {
+        err = refs_bench(1);
+    }
+    if (RT_OK == err) {
+        err = refs_bench(REFS_BENCH_THREADS);
+    }
+    return err;
+}
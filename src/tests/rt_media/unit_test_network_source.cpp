@@ -0,0 +1,265 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: network packet source against a local http server
+ */
+
+#include <stdio.h>              // NOLINT
+#include <stdlib.h>             // NOLINT
+#include <string.h>             // NOLINT
+#include <atomic>               // NOLINT
+#ifndef OS_WINDOWS
+#include <unistd.h>             // NOLINT
+#include <arpa/inet.h>          // NOLINT
+#include <netinet/in.h>         // NOLINT
+#include <sys/socket.h>         // NOLINT
+#endif
+
+#include "rt_header.h"          // NOLINT
+#include "rt_media_tests.h"     // NOLINT
+#include "rt_metadata.h"        // NOLINT
+#include "rt_thread.h"          // NOLINT
+#include "rt_time.h"            // NOLINT
+#include "RTMediaMetaKeys.h"    // NOLINT
+#include "RTPktSourceNetwork.h" // NOLINT
+#include "FFAdapterFormat.h"    // NOLINT
+
+#define HTTP_STREAM_SIZE        (3 * 1024 * 1024 + 4321)
+#define HTTP_SEND_CHUNK         (32 * 1024)
+#define HTTP_SEND_INTERVAL_MS   10                      // about 3.2MB/s
+#define HTTP_READ_AHEAD         (512 * 1024)
+#define HTTP_READ_CHUNK         (7 * 1024 + 13)
+
+// shared by server thread and test thread
+typedef struct _HttpServerCtx {
+    INT32               mSocket;
+    INT32               mPort;
+    std::atomic<bool>   mQuit;
+    std::atomic<INT32>  mRequests;
+} HttpServerCtx;
+
+static UINT8 http_stream_byte(INT64 pos) {
+    return (UINT8)((pos >> 8) ^ (pos & 0xff) ^ 0x5a);
+}
+
+#ifndef OS_WINDOWS
+/*
+ * serves HTTP_STREAM_SIZE bytes with range support, one connection at a time.
+ */
+static void http_server_serve(HttpServerCtx* ctx, INT32 client) {
+    char  request[2048] = {0};
+    INT32 length = 0;
+    while (length < (INT32)sizeof(request) - 1) {
+        INT32 ret = recv(client, request + length, sizeof(request) - 1 - length, 0);
+        if (ret <= 0) {
+            return;
+        }
+        length += ret;
+        request[length] = '\0';
+        if (RT_NULL != strstr(request, "\r\n\r\n")) {
+            break;
+        }
+    }
+    ctx->mRequests++;
+
+    INT64 start = 0;
+    const char* range = strstr(request, "Range: bytes=");
+    if (RT_NULL != range) {
+        start = atoll(range + strlen("Range: bytes="));
+    }
+    start = RT_MIN(start, (INT64)HTTP_STREAM_SIZE);
+
+    char header[512] = {0};
+    if (RT_NULL != range) {
+        snprintf(header, sizeof(header), "HTTP/1.1 206 Partial Content\r\n"
+                 "Content-Type: application/octet-stream\r\n"
+                 "Content-Length: %lld\r\nContent-Range: bytes %lld-%lld/%d\r\n"
+                 "Accept-Ranges: bytes\r\nConnection: close\r\n\r\n",
+                 (long long)(HTTP_STREAM_SIZE - start), (long long)start,
+                 (long long)HTTP_STREAM_SIZE - 1, HTTP_STREAM_SIZE);
+    } else {
+        snprintf(header, sizeof(header), "HTTP/1.1 200 OK\r\n"
+                 "Content-Type: application/octet-stream\r\n"
+                 "Content-Length: %d\r\nAccept-Ranges: bytes\r\nConnection: close\r\n\r\n",
+                 HTTP_STREAM_SIZE);
+    }
+    send(client, header, strlen(header), MSG_NOSIGNAL);
+
+    UINT8 chunk[HTTP_SEND_CHUNK];
+    for (INT64 pos = start; (pos < HTTP_STREAM_SIZE) && !ctx->mQuit; ) {
+        INT32 size = (INT32)RT_MIN((INT64)HTTP_SEND_CHUNK, HTTP_STREAM_SIZE - pos);
+        for (INT32 idx = 0; idx < size; idx++) {
+            chunk[idx] = http_stream_byte(pos + idx);
+        }
+        if (send(client, chunk, size, MSG_NOSIGNAL) != size) {
+            // client closes connection after seeking
+            break;
+        }
+        pos += size;
+        RtTime::sleepMs(HTTP_SEND_INTERVAL_MS);
+    }
+}
+
+static void* http_server_loop(void* ptr_ctx) {
+    HttpServerCtx* ctx = reinterpret_cast<HttpServerCtx*>(ptr_ctx);
+    while (!ctx->mQuit) {
+        INT32 client = accept(ctx->mSocket, NULL, NULL);
+        if (client < 0) {
+            continue;
+        }
+        http_server_serve(ctx, client);
+        close(client);
+    }
+    return RT_NULL;
+}
+
+static RT_RET http_server_open(HttpServerCtx* ctx) {
+    struct sockaddr_in addr;
+    socklen_t addrLen = sizeof(addr);
+    rt_memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port        = 0;
+
+    ctx->mSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if ((ctx->mSocket < 0)
+          || (bind(ctx->mSocket, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+          || (listen(ctx->mSocket, 4) < 0)
+          || (getsockname(ctx->mSocket, (struct sockaddr*)&addr, &addrLen) < 0)) {
+        RT_LOGE("fail to open local http server");
+        return RT_ERR_BAD;
+    }
+    // accept() returns at times, so that server can quit
+    struct timeval timeout = {0, 100 * 1000};
+    setsockopt(ctx->mSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ctx->mPort = ntohs(addr.sin_port);
+    return RT_OK;
+}
+
+static RT_RET network_check_bytes(RTPktSourceNetwork* source, INT64 start, INT64 size) {
+    UINT8 buf[HTTP_READ_CHUNK];
+    for (INT64 pos = start; pos < start + size; ) {
+        INT32 want = (INT32)RT_MIN((INT64)HTTP_READ_CHUNK, start + size - pos);
+        INT32 ret  = RTPktSourceNetwork::readBytes(source, buf, want);
+        if (ret <= 0) {
+            RT_LOGE("fail to read at %lld, err: %d", pos, ret);
+            return RT_ERR_BAD;
+        }
+        for (INT32 idx = 0; idx < ret; idx++) {
+            if (buf[idx] != http_stream_byte(pos + idx)) {
+                RT_LOGE("mismatch at %lld", pos + idx);
+                return RT_ERR_VALUE;
+            }
+        }
+        pos += ret;
+    }
+    return RT_OK;
+}
+#endif
+
+RT_RET unit_test_network_source(INT32 index, INT32 total_index) {
+    (void)index;
+    (void)total_index;
+#ifdef OS_WINDOWS
+    return RT_OK;
+#else
+    RT_RET         err = RT_OK;
+    HttpServerCtx  server;
+    server.mSocket   = -1;
+    server.mPort     = 0;
+    server.mQuit     = false;
+    server.mRequests = 0;
+    if (RT_OK != http_server_open(&server)) {
+        return RT_ERR_BAD;
+    }
+    RtThread* thread = new RtThread(http_server_loop, &server);
+    thread->setName("HttpServer");
+    thread->start();
+
+    char uri[64] = {0};
+    snprintf(uri, sizeof(uri), "http://127.0.0.1:%d/stream.bin", server.mPort);
+    RtMetaData* config = new RtMetaData();
+    config->setCString(kKeyFormatUri, uri);
+    config->setInt32(kKeyReadAheadSize, HTTP_READ_AHEAD);
+
+    RTPktSourceNetwork* source = new RTPktSourceNetwork();
+    INT64 startMs = RtTime::getNowTimeMs();
+    do {
+        err = source->init(config);
+        if (RT_OK != err) {
+            break;
+        }
+        if (RTPktSourceNetwork::seekBytes(source, 0, FA_SEEK_SIZE) != HTTP_STREAM_SIZE) {
+            RT_LOGE("stream size isn't reported by source");
+            err = RT_ERR_VALUE;
+            break;
+        }
+
+        // read-ahead is bounded by ring buffer, whatever demuxer does
+        RtTime::sleepMs(500);
+        INT64 buffered = source->getBufferedBytes();
+        RT_LOGE("buffered %lld bytes before reading, read-ahead: %d", buffered, HTTP_READ_AHEAD);
+        if ((buffered <= 0) || (buffered > HTTP_READ_AHEAD)) {
+            err = RT_ERR_VALUE;
+            break;
+        }
+
+        // sequential read, short backward seek in ring, and seek out of ring
+        err = network_check_bytes(source, 0, HTTP_STREAM_SIZE / 2);
+        if (RT_OK != err) {
+            break;
+        }
+        RTPktSourceNetwork::seekBytes(source, -(HTTP_READ_AHEAD / 8), SEEK_CUR);
+        err = network_check_bytes(source, HTTP_STREAM_SIZE / 2 - HTTP_READ_AHEAD / 8, HTTP_READ_AHEAD / 8);
+        if (RT_OK != err) {
+            break;
+        }
+        RTPktSourceNetwork::seekBytes(source, 1000, SEEK_SET);
+        err = network_check_bytes(source, 1000, 64 * 1024);
+        if (RT_OK != err) {
+            break;
+        }
+        RTPktSourceNetwork::seekBytes(source, HTTP_STREAM_SIZE / 2, SEEK_SET);
+        err = network_check_bytes(source, HTTP_STREAM_SIZE / 2, HTTP_STREAM_SIZE - HTTP_STREAM_SIZE / 2);
+        if (RT_OK != err) {
+            break;
+        }
+        UINT8 tail[16];
+        if (RTPktSourceNetwork::readBytes(source, tail, sizeof(tail)) != RT_ERR_END_OF_STREAM) {
+            RT_LOGE("end of stream isn't reported by source");
+            err = RT_ERR_VALUE;
+            break;
+        }
+
+        // bytes buffered by socket while ring is full make the result above limit
+        INT64 limit     = (INT64)HTTP_SEND_CHUNK * 8 * 1000 / HTTP_SEND_INTERVAL_MS;
+        INT64 bandwidth = source->getBandwidth();
+        RT_LOGE("bandwidth: %lld bps, limit of server: %lld bps, requests: %d, cost: %lldms",
+                 bandwidth, limit, server.mRequests.load(), RtTime::getNowTimeMs() - startMs);
+        if (bandwidth <= 0) {
+            err = RT_ERR_VALUE;
+        }
+    } while (0);
+
+    rt_safe_delete(source);
+    server.mQuit = true;
+    rt_safe_delete(thread);
+    close(server.mSocket);
+    rt_safe_delete(config);
+
+    RT_LOGE("network source %s", (RT_OK == err) ? "PASS" : "FAIL");
+    return err;
+#endif
+}
@@ -0,0 +1,224 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: push stream, order of bytes and throughput of copy/lend modes
+ */
+
+#include "rt_header.h"          // NOLINT
+#include "rt_media_tests.h"     // NOLINT
+#include "rt_thread.h"          // NOLINT
+#include "rt_time.h"            // NOLINT
+#include "RTMediaPushStream.h"  // NOLINT
+
+#define PUSH_TEST_BYTES         (64 * 1024 * 1024)
+#define PUSH_TEST_CHUNK         (188 * 7)           // one TS datagram
+#define PUSH_TEST_READ          (32 * 1024)         // avio buffer of demuxer
+#define PUSH_TEST_POOL          64
+
+enum PushTestMode {
+    PUSH_MODE_MALLOC = 0,   // legacy: one heap copy per written chunk
+    PUSH_MODE_COPY,
+    PUSH_MODE_LEND,
+};
+
+typedef struct _PushTestCtx {
+    RTMediaPushStream  *mStream;
+    INT32               mMode;
+    INT64               mReadBytes;
+    RT_BOOL             mMismatch;
+    UINT8              *mPool[PUSH_TEST_POOL];
+    volatile INT32      mLent[PUSH_TEST_POOL];
+    volatile INT32      mReleased;
+} PushTestCtx;
+
+static UINT8 push_stream_byte(INT64 pos) {
+    return (UINT8)((pos >> 10) ^ (pos & 0xff));
+}
+
+static void push_fill_chunk(UINT8 *chunk, INT64 pos, INT32 size) {
+    for (INT32 idx = 0; idx < size; idx++) {
+        chunk[idx] = push_stream_byte(pos + idx);
+    }
+}
+
+static void push_release_chunk(void *opaque, const void *data) {
+    PushTestCtx *ctx = reinterpret_cast<PushTestCtx *>(opaque);
+    for (INT32 idx = 0; idx < PUSH_TEST_POOL; idx++) {
+        if (ctx->mPool[idx] == data) {
+            __sync_fetch_and_and(&ctx->mLent[idx], 0);
+            break;
+        }
+    }
+    __sync_fetch_and_add(&ctx->mReleased, 1);
+}
+
+static void push_release_malloc(void *opaque, const void *data) {
+    (void)opaque;
+    void *ptr = const_cast<void *>(data);
+    rt_safe_free(ptr);
+}
+
+static void* push_stream_reader(void *ptr_ctx) {
+    PushTestCtx *ctx = reinterpret_cast<PushTestCtx *>(ptr_ctx);
+    UINT8 *buf = rt_malloc_size(UINT8, PUSH_TEST_READ);
+    while (!ctx->mMismatch) {
+        INT32 bytes = RTMediaPushStream::readBytes(ctx->mStream, buf, PUSH_TEST_READ);
+        if (bytes <= 0) {
+            break;
+        }
+        // spot check is enough for order, full check would measure memory only
+        for (INT32 idx = 0; idx < bytes; idx += 61) {
+            if (buf[idx] != push_stream_byte(ctx->mReadBytes + idx)) {
+                RT_LOGE("mismatch at %lld", ctx->mReadBytes + idx);
+                ctx->mMismatch = RT_TRUE;
+                break;
+            }
+        }
+        ctx->mReadBytes += bytes;
+    }
+    rt_safe_free(buf);
+    return RT_NULL;
+}
+
+static RT_RET push_stream_write(PushTestCtx *ctx, INT64 pos, UINT8 *chunk) {
+    switch (ctx->mMode) {
+      case PUSH_MODE_MALLOC: {
+        // what writeData() did before: allocate, copy, queue one buffer
+        UINT8 *copy = rt_malloc_size(UINT8, PUSH_TEST_CHUNK);
+        rt_memcpy(copy, chunk, PUSH_TEST_CHUNK);
+        return ctx->mStream->lend(copy, PUSH_TEST_CHUNK, push_release_malloc, ctx);
+      }
+      case PUSH_MODE_COPY:
+        if (ctx->mStream->write(chunk, PUSH_TEST_CHUNK) != PUSH_TEST_CHUNK) {
+            return RT_ERR_BAD;
+        }
+        return RT_OK;
+      default:
+        break;
+    }
+
+    // chunk of pool isn't touched until reader releases it
+    INT32 slot = (INT32)((pos / PUSH_TEST_CHUNK) % PUSH_TEST_POOL);
+    while (__sync_fetch_and_add(&ctx->mLent[slot], 0)) {
+        RtTime::sleepUs(50);
+    }
+    push_fill_chunk(ctx->mPool[slot], pos, PUSH_TEST_CHUNK);
+    __sync_fetch_and_or(&ctx->mLent[slot], 1);
+    return ctx->mStream->lend(ctx->mPool[slot], PUSH_TEST_CHUNK, push_release_chunk, ctx);
+}
+
+static RT_RET push_stream_run(INT32 mode, const char *name) {
+    RT_RET      err = RT_OK;
+    PushTestCtx ctx;
+    rt_memset(&ctx, 0, sizeof(PushTestCtx));
+    ctx.mMode   = mode;
+    ctx.mStream = new RTMediaPushStream();
+    for (INT32 idx = 0; idx < PUSH_TEST_POOL; idx++) {
+        ctx.mPool[idx] = rt_malloc_size(UINT8, PUSH_TEST_CHUNK);
+    }
+
+    RtThread *reader = new RtThread(push_stream_reader, &ctx);
+    reader->setName("PushReader");
+    reader->start();
+
+    UINT8 *chunk  = rt_malloc_size(UINT8, PUSH_TEST_CHUNK);
+    INT64 total   = (PUSH_TEST_BYTES / PUSH_TEST_CHUNK) * PUSH_TEST_CHUNK;
+    INT64 startUs = RtTime::getNowTimeUs();
+    for (INT64 pos = 0; (pos < total) && (RT_OK == err); pos += PUSH_TEST_CHUNK) {
+        // filling is the job of caller, it's done in all modes
+        if (PUSH_MODE_LEND != mode) {
+            push_fill_chunk(chunk, pos, PUSH_TEST_CHUNK);
+        }
+        err = push_stream_write(&ctx, pos, chunk);
+    }
+    ctx.mStream->writeEos();
+    reader->join();
+    INT64 costUs = RtTime::getNowTimeUs() - startUs;
+
+    if ((RT_OK == err) && (ctx.mMismatch || (ctx.mReadBytes != total))) {
+        RT_LOGE("read %lld bytes of %lld", ctx.mReadBytes, total);
+        err = RT_ERR_VALUE;
+    }
+    if ((RT_OK == err) && (PUSH_MODE_LEND == mode) && (ctx.mReleased != total / PUSH_TEST_CHUNK)) {
+        RT_LOGE("released %d buffers of %lld", ctx.mReleased, total / PUSH_TEST_CHUNK);
+        err = RT_ERR_VALUE;
+    }
+    RT_LOGE("%-6s: %lld MB in %lldms, %lld MB/s", name, total >> 20, costUs / 1000,
+             (costUs > 0) ? ((total * 1000000ll / costUs) >> 20) : 0ll);
+
+    rt_safe_delete(reader);
+    rt_safe_delete(ctx.mStream);
+    rt_safe_free(chunk);
+    for (INT32 idx = 0; idx < PUSH_TEST_POOL; idx++) {
+        rt_safe_free(ctx.mPool[idx]);
+    }
+    return err;
+}
+
+/*
+ * reader blocked on empty stream must leave when stream is aborted.
+ */
+static void* push_stream_blocked_reader(void *ptr_ctx) {
+    UINT8 buf[16];
+    PushTestCtx *ctx = reinterpret_cast<PushTestCtx *>(ptr_ctx);
+    ctx->mReadBytes = RTMediaPushStream::readBytes(ctx->mStream, buf, sizeof(buf));
+    return RT_NULL;
+}
+
+static RT_RET push_stream_abort() {
+    PushTestCtx ctx;
+    rt_memset(&ctx, 0, sizeof(PushTestCtx));
+    ctx.mStream = new RTMediaPushStream();
+
+    RtThread *reader = new RtThread(push_stream_blocked_reader, &ctx);
+    reader->setName("PushReader");
+    reader->start();
+    RtTime::sleepMs(50);
+    ctx.mStream->abort();
+    reader->join();
+
+    RT_RET err = (RT_ERR_BAD == ctx.mReadBytes) ? RT_OK : RT_ERR_VALUE;
+    UINT8 chunk[PUSH_TEST_CHUNK] = {0};
+    if (ctx.mStream->write(chunk, PUSH_TEST_CHUNK) != 0) {
+        err = RT_ERR_VALUE;
+    }
+    rt_safe_delete(reader);
+    rt_safe_delete(ctx.mStream);
+    return err;
+}
+
+RT_RET unit_test_push_stream(INT32 index, INT32 total_index) {
+    (void)index;
+    (void)total_index;
+    RT_RET err = RT_OK;
+    do {
+        err = push_stream_run(PUSH_MODE_MALLOC, "malloc");
+        if (RT_OK != err) {
+            break;
+        }
+        err = push_stream_run(PUSH_MODE_COPY, "copy");
+        if (RT_OK != err) {
+            break;
+        }
+        err = push_stream_run(PUSH_MODE_LEND, "lend");
+        if (RT_OK != err) {
+            break;
+        }
+        err = push_stream_abort();
+    } while (0);
+
+    RT_LOGE("push stream %s", (RT_OK == err) ? "PASS" : "FAIL");
+    return err;
+}
@@ -50,6 +50,14 @@ int main(int argc, char **argv) {
 #endif
     rt_tests_add(test_ctx, unit_test_node_simple_player,
                            const_cast<char *>("UnitTest-NodeCodecSimplePlayer"));
+    rt_tests_add(test_ctx, unit_test_node_trick_play,
+                           const_cast<char *>("UnitTest-NodeTrickPlay"));
+    rt_tests_add(test_ctx, unit_test_node_seek_accuracy,
+                           const_cast<char *>("UnitTest-NodeSeekAccuracy"));
+    rt_tests_add(test_ctx, unit_test_node_video_filter,
+                           const_cast<char *>("UnitTest-NodeVideoFilter"));
+    rt_tests_add(test_ctx, unit_test_node_stat,
+                           const_cast<char *>("UnitTest-NodeStat"));
 
     // ! run all testcases
     rt_tests_run(test_ctx, /*mem_dump=*/RT_TRUE);
@@ -27,6 +27,10 @@ RT_RET unit_test_node_bus(INT32 index, INT32 total);
 RT_RET unit_test_node_data_flow(INT32 index, INT32 total);
 RT_RET unit_test_ff_node_demuxer(INT32 index, INT32 total);
 RT_RET unit_test_node_audio_decoder(INT32 index, INT32 total);
+RT_RET unit_test_node_trick_play(INT32 index, INT32 total);
+RT_RET unit_test_node_seek_accuracy(INT32 index, INT32 total);
+RT_RET unit_test_node_video_filter(INT32 index, INT32 total);
+RT_RET unit_test_node_stat(INT32 index, INT32 total);
 
 RT_RET unit_test_node_render_gles(INT32 index, INT32 total);
 RT_RET unit_test_node_simple_player(INT32 index, INT32 total);
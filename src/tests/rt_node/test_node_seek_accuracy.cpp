@@ -0,0 +1,232 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: exact seek of demuxer and decoder, first frame and its latency,
+ *         and seek while rewinding
+ */
+
+#include "FFNodeDemuxer.h"   // NOLINT
+#include "FFNodeDecoder.h"   // NOLINT
+#include "FFAdapterUtils.h"  // NOLINT
+
+#include "rt_node_tests.h"   // NOLINT
+#include "rt_metadata.h"     // NOLINT
+#include "RTMediaBuffer.h"   // NOLINT
+#include "RTMediaMetaKeys.h" // NOLINT
+
+#ifdef OS_WINDOWS
+#define TEST_URI "E:\\CloudSync\\low-used\\videos\\h264-1080p.mp4"
+#else
+#define TEST_URI "h264-1080p.mp4"
+#endif
+
+#define SEEK_TEST_COUNT         8
+#define SEEK_TEST_TIMEOUT_MS    3000
+#define SEEK_REWIND_RATE        (-8)
+
+// audio isn't decoded here, it is dropped
+static void seek_drop_audio(RTNode* demuxer, RTMediaBuffer* buf) {
+    RTPacket pkt = {0};
+    buf->reset();
+    buf->getMetaData()->setInt32(kKeyCodecType, RTTRACK_TYPE_AUDIO);
+    while (RT_OK == demuxer->pullBuffer(&buf)) {
+        rt_mediabuf_goto_packet(buf, &pkt);
+        rt_utils_packet_free(&pkt);
+        buf->reset();
+        buf->getMetaData()->setInt32(kKeyCodecType, RTTRACK_TYPE_AUDIO);
+    }
+}
+
+/*
+ * same workflow of player: pause flush cmd start, then the first frame
+ * from decoder.
+ */
+static RT_RET seek_cmd_first_frame(RTNode* demuxer, RTNode* decoder, RT_NODE_CMD cmd,
+                                   RtMetaData* options, INT64* firstPts, INT64* latencyUs) {
+    INT64 beginUs = RtTime::getNowTimeUs();
+    RTNodeAdapter::runCmd(demuxer, RT_NODE_CMD_PAUSE, RT_NULL);
+    RTNodeAdapter::runCmd(decoder, RT_NODE_CMD_PAUSE, RT_NULL);
+    RTNodeAdapter::runCmd(demuxer, RT_NODE_CMD_FLUSH, RT_NULL);
+    RTNodeAdapter::runCmd(decoder, RT_NODE_CMD_FLUSH, RT_NULL);
+    RTNodeAdapter::runCmd(demuxer, cmd, options);
+    RTNodeAdapter::runCmd(decoder, cmd, options);
+    RTNodeAdapter::runCmd(demuxer, RT_NODE_CMD_START, RT_NULL);
+    RTNodeAdapter::runCmd(decoder, RT_NODE_CMD_START, RT_NULL);
+
+    RT_RET         err      = RT_ERR_TIMEOUT;
+    RTMediaBuffer* audio    = new RTMediaBuffer(RT_NULL, 0);
+    RTMediaBuffer* esPacket = RT_NULL;
+    RTMediaBuffer* frame    = RT_NULL;
+    while (RtTime::getNowTimeUs() - beginUs < SEEK_TEST_TIMEOUT_MS * 1000ll) {
+        seek_drop_audio(demuxer, audio);
+        if (RT_NULL == esPacket) {
+            RTNodeAdapter::dequeCodecBuffer(decoder, &esPacket, RT_PORT_INPUT);
+        }
+        if (RT_NULL != esPacket) {
+            esPacket->getMetaData()->setInt32(kKeyCodecType, RTTRACK_TYPE_VIDEO);
+            if (RT_OK == RTNodeAdapter::pullBuffer(demuxer, &esPacket)) {
+                RTNodeAdapter::pushBuffer(decoder, esPacket);
+                esPacket = RT_NULL;
+            }
+        }
+
+        frame = RT_NULL;
+        RTNodeAdapter::pullBuffer(decoder, &frame);
+        if (RT_NULL == frame) {
+            RtTime::sleepMs(1);
+            continue;
+        }
+        INT32 eos = 0;
+        frame->getMetaData()->findInt32(kKeyFrameEOS, &eos);
+        frame->getMetaData()->findInt64(kKeyFramePts, firstPts);
+        RT_BOOL ready = (RT_MEDIA_BUFFER_STATUS_READY == frame->getStatus()) ? RT_TRUE : RT_FALSE;
+        frame->release();
+        if (ready || eos) {
+            *latencyUs = RtTime::getNowTimeUs() - beginUs;
+            err = eos ? RT_ERR_END_OF_STREAM : RT_OK;
+            break;
+        }
+    }
+
+    if (RT_NULL != esPacket) {
+        esPacket->release();
+    }
+    rt_safe_delete(audio);
+    return err;
+}
+
+/*
+ * the first frame after seek is at target or after it, never at key frame
+ * before it.
+ */
+static RT_RET seek_first_frame(RTNode* demuxer, RTNode* decoder, INT64 targetUs,
+                               INT64* firstPts, INT64* latencyUs) {
+    RtMetaData* options = new RtMetaData();
+    options->setInt64(kKeySeekTimeUs, targetUs);
+    RT_RET err = seek_cmd_first_frame(demuxer, decoder, RT_NODE_CMD_SEEK, options,
+                                      firstPts, latencyUs);
+    rt_safe_delete(options);
+    return err;
+}
+
+/*
+ * seek while rewinding moves stepping of key frames, so the first key frame
+ * is at target or before it. normal rate resumes at that key frame, frames
+ * before target of the seek are not dropped any more.
+ */
+static RT_RET seek_in_rewind(RTNode* demuxer, RTNode* decoder, INT64 duration) {
+    RtMetaData* options   = new RtMetaData();
+    INT64       targetUs  = duration / 2 + 123456;
+    INT64       keyPts    = -1;
+    INT64       firstPts  = -1;
+    INT64       latencyUs = 0;
+    RT_RET      err       = RT_OK;
+    do {
+        options->setInt32(kKeyTrickRate, SEEK_REWIND_RATE);
+        options->setInt64(kKeySeekTimeUs, duration * 3 / 4);
+        err = seek_cmd_first_frame(demuxer, decoder, RT_NODE_CMD_TRICKPLAY, options,
+                                   &firstPts, &latencyUs);
+        if (RT_OK != err) {
+            RT_LOGE("no frame in rewind");
+            break;
+        }
+
+        options->setInt64(kKeySeekTimeUs, targetUs);
+        err = seek_cmd_first_frame(demuxer, decoder, RT_NODE_CMD_SEEK, options,
+                                   &keyPts, &latencyUs);
+        RT_LOGE("  rewind seek %10lld | %9lld | %11lld", targetUs/1000, keyPts/1000, latencyUs/1000);
+        if (RT_OK != err) {
+            RT_LOGE("no key frame after seek to %lldms in rewind", targetUs/1000);
+            break;
+        }
+        if (keyPts > targetUs) {
+            RT_LOGE("key frame(%lldus) is after target(%lldus) in rewind", keyPts, targetUs);
+            err = RT_ERR_VALUE;
+            break;
+        }
+
+        options->setInt32(kKeyTrickRate, 1);
+        options->setInt64(kKeySeekTimeUs, keyPts);
+        err = seek_cmd_first_frame(demuxer, decoder, RT_NODE_CMD_TRICKPLAY, options,
+                                   &firstPts, &latencyUs);
+        RT_LOGE("  rewind end  %10lld | %9lld | %11lld", keyPts/1000, firstPts/1000, latencyUs/1000);
+        if (RT_OK != err) {
+            RT_LOGE("no frame after rewind ends");
+            break;
+        }
+        if (firstPts > keyPts) {
+            RT_LOGE("frames before %lldus are dropped after rewind ends", firstPts);
+            err = RT_ERR_VALUE;
+        }
+    } while (0);
+    rt_safe_delete(options);
+    return err;
+}
+
+RT_RET unit_test_node_seek_accuracy(INT32 index, INT32 total) {
+    RT_RET      err  = RT_OK;
+    RtMetaData* meta = new RtMetaData();
+    meta->setCString(kKeyFormatUri, TEST_URI);
+
+    RTNodeDemuxer* demuxer = reinterpret_cast<RTNodeDemuxer*>(ff_node_demuxer.mCreateNode());
+    RTNode*        decoder = ff_node_decoder.mCreateNode();
+    RTNodeAdapter::init(demuxer, meta);
+    INT32 videoIdx = demuxer->queryTrackUsed(RTTRACK_TYPE_VIDEO);
+    INT64 duration = demuxer->queryDuration();
+    if ((videoIdx < 0) || (duration <= 0)) {
+        RT_LOGE("no video track in %s", TEST_URI);
+        RTNodeAdapter::release(demuxer);
+        delete demuxer;
+        delete decoder;
+        return RT_ERR_UNKNOWN;
+    }
+    RTNodeAdapter::init(decoder, demuxer->queryTrackMeta(videoIdx, RTTRACK_TYPE_VIDEO));
+    RTNodeAdapter::runCmd(demuxer, RT_NODE_CMD_PREPARE, RT_NULL);
+    RTNodeAdapter::runCmd(decoder, RT_NODE_CMD_PREPARE, RT_NULL);
+
+    RT_LOGE("exact seek of %s, duration: %lldms", TEST_URI, duration/1000);
+    RT_LOGE("  target(ms) | first(ms) | latency(ms)");
+    for (INT32 idx = 0; idx < SEEK_TEST_COUNT; idx++) {
+        // forward and backward by turns, away from key frames
+        INT64 targetUs  = duration * ((idx % 2) ? (SEEK_TEST_COUNT - idx) : (idx + 1)) / (SEEK_TEST_COUNT + 2)
+                        + 123456;
+        INT64 firstPts  = -1;
+        INT64 latencyUs = 0;
+        err = seek_first_frame(demuxer, decoder, targetUs, &firstPts, &latencyUs);
+        RT_LOGE("  %10lld | %9lld | %11lld", targetUs/1000, firstPts/1000, latencyUs/1000);
+        if (RT_OK != err) {
+            RT_LOGE("no frame after seek to %lldms", targetUs/1000);
+            break;
+        }
+        if (firstPts < targetUs) {
+            RT_LOGE("first frame(%lldus) is before target(%lldus)", firstPts, targetUs);
+            err = RT_ERR_VALUE;
+            break;
+        }
+    }
+    if (RT_OK == err) {
+        err = seek_in_rewind(demuxer, decoder, duration);
+    }
+
+    RTNodeAdapter::runCmd(decoder, RT_NODE_CMD_STOP, RT_NULL);
+    RTNodeAdapter::runCmd(demuxer, RT_NODE_CMD_STOP, RT_NULL);
+    RTNodeAdapter::release(decoder);
+    RTNodeAdapter::release(demuxer);
+    delete decoder;
+    delete demuxer;
+
+    RT_LOGE("seek accuracy %s", (RT_OK == err) ? "PASS" : "FAIL");
+    return err;
+}
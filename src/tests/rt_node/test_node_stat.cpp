@@ -0,0 +1,153 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: statistics of node, counters of adapter and answers of
+ *         RT_NODE_CMD_STAT and RT_NODE_CMD_LATENCY
+ */
+
+#include "RTNodeStat.h"           // NOLINT
+#include "RTFilterVideoScale.h"   // NOLINT
+#include "rt_node_tests.h"        // NOLINT
+#include "rt_metadata.h"          // NOLINT
+#include "rt_time.h"              // NOLINT
+#include "RTMediaBufferPool.h"    // NOLINT
+#include "RTMediaMetaKeys.h"      // NOLINT
+
+#define STAT_TEST_W             320
+#define STAT_TEST_H             240
+#define STAT_TEST_FRAMES        20
+#define STAT_TEST_INPUTS        4
+#define STAT_TEST_TIMEOUT_MS    3000
+
+#define STAT_CHECK(cond)                                    \
+    do {                                                    \
+        if (!(cond)) {                                      \
+            RT_LOGE("check failed: %s", #cond);             \
+            return RT_ERR_VALUE;                            \
+        }                                                   \
+    } while (0)
+
+// bins of histogram and percentile of known times
+static RT_RET stat_test_histogram() {
+    RTNodeStat stat;
+    rt_node_stat_reset(&stat);
+    for (INT32 idx = 0; idx < 98; idx++) {
+        rt_node_stat_process(&stat, 10);
+    }
+    rt_node_stat_process(&stat, 1000);
+    rt_node_stat_process(&stat, 5000000);
+
+    STAT_CHECK(100 == stat.mProcCount);
+    STAT_CHECK(5000000 == stat.mProcMaxUs);
+    STAT_CHECK(98 == stat.mProcHist[0]);
+    STAT_CHECK(1 == stat.mProcHist[4]);     // [512, 1024)
+    STAT_CHECK(1 == stat.mProcHist[NODE_STAT_HIST_BINS - 1]);
+    STAT_CHECK(NODE_STAT_HIST_BASE_US == rt_node_stat_percentile(&stat, 50));
+    STAT_CHECK(5000000 == rt_node_stat_percentile(&stat, 100));
+
+    rt_node_stat_queue(&stat, 3);
+    rt_node_stat_queue(&stat, 1);
+    STAT_CHECK((1 == stat.mQueueDepth) && (3 == stat.mQueueMax));
+    return RT_OK;
+}
+
+// frames go through filter by adapter, then counters are asked by commands
+static RT_RET stat_test_node() {
+    INT32 size = STAT_TEST_W * STAT_TEST_H * 3 / 2;
+    RtMetaData *meta = new RtMetaData();
+    meta->setInt32(kKeyFrameW, STAT_TEST_W);
+    meta->setInt32(kKeyFrameH, STAT_TEST_H);
+    meta->setInt32(kKeyFilterThreads, 1);
+
+    RTMediaBufferPool *inputs = new RTMediaBufferPool(STAT_TEST_INPUTS);
+    for (INT32 idx = 0; idx < STAT_TEST_INPUTS; idx++) {
+        inputs->registerBuffer(new RTMediaBuffer(size));
+    }
+    inputs->start();
+
+    RTNode *filter = rt_filter_video_scale.mCreateNode();
+    RT_RET  err    = RTNodeAdapter::init(filter, meta);
+    if (RT_OK == err) {
+        filter->runCmd(RT_NODE_CMD_PREPARE, RT_NULL);
+        filter->runCmd(RT_NODE_CMD_START, RT_NULL);
+
+        INT32 pushed  = 0;
+        INT32 pulled  = 0;
+        INT64 beginUs = RtTime::getNowTimeUs();
+        while ((pulled < STAT_TEST_FRAMES)
+                 && (RtTime::getNowTimeUs() - beginUs < STAT_TEST_TIMEOUT_MS * 1000ll)) {
+            RTMediaBuffer *input = RT_NULL;
+            if ((pushed < STAT_TEST_FRAMES) && (pushed - pulled < STAT_TEST_INPUTS - 1)) {
+                inputs->acquireBuffer(&input, RT_FALSE);
+            }
+            if (RT_NULL != input) {
+                input->getMetaData()->setInt32(kKeyFrameW, STAT_TEST_W);
+                input->getMetaData()->setInt32(kKeyFrameH, STAT_TEST_H);
+                if (RT_OK == RTNodeAdapter::pushBuffer(filter, input)) {
+                    pushed++;
+                } else {
+                    input->release();
+                }
+            }
+            RTMediaBuffer *output = RT_NULL;
+            if (RT_OK == RTNodeAdapter::pullBuffer(filter, &output)) {
+                output->release();
+                pulled++;
+            } else {
+                RtTime::sleepUs(500);
+            }
+        }
+
+        RTNodeStat  stat;
+        RtMetaData *query = new RtMetaData();
+        INT64 avgUs = 0, p99Us = 0, maxUs = 0;
+        query->setPointer(kKeyNodeStat, reinterpret_cast<RT_PTR>(&stat));
+        err = filter->runCmd(RT_NODE_CMD_STAT, query);
+        if (RT_OK == err) {
+            err = filter->runCmd(RT_NODE_CMD_LATENCY, query);
+        }
+        query->findInt64(kKeyNodeLatencyUs, &avgUs);
+        query->findInt64(kKeyNodeLatencyP99Us, &p99Us);
+        query->findInt64(kKeyNodeLatencyMaxUs, &maxUs);
+        rt_safe_delete(query);
+        filter->runCmd(RT_NODE_CMD_STOP, RT_NULL);
+
+        RT_LOGE("in: %lld out: %lld bytes: %lld/%lld queue max: %lld latency: %lld/%lld/%lldus",
+                 stat.mBufferIn, stat.mBufferOut, stat.mBytesIn, stat.mBytesOut, stat.mQueueMax,
+                 avgUs, p99Us, maxUs);
+        if ((RT_OK == err) && ((STAT_TEST_FRAMES != stat.mBufferIn) || (STAT_TEST_FRAMES != stat.mBufferOut)
+              || ((UINT64)size * STAT_TEST_FRAMES != stat.mBytesIn) || (stat.mBytesIn != stat.mBytesOut)
+              || (STAT_TEST_FRAMES != stat.mProcCount) || (avgUs > p99Us) || (p99Us > maxUs))) {
+            err = RT_ERR_VALUE;
+        }
+    }
+
+    rt_safe_delete(filter);
+    rt_safe_delete(meta);
+    inputs->stop();
+    rt_safe_delete(inputs);
+    return err;
+}
+
+RT_RET unit_test_node_stat(INT32 index, INT32 total) {
+    (void)index;
+    (void)total;
+    RT_RET err = stat_test_histogram();
+    if (RT_OK == err) {
+        err = stat_test_node();
+    }
+    RT_LOGE("node stat %s", (RT_OK == err) ? "PASS" : "FAIL");
+    return err;
+}
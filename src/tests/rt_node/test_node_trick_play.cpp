@@ -0,0 +1,190 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: trick play of demuxer and decoder, speed and cpu of each rate
+ */
+
+#ifndef OS_WINDOWS
+#include <sys/resource.h>    // NOLINT
+#endif
+
+#include "FFNodeDemuxer.h"   // NOLINT
+#include "FFNodeDecoder.h"   // NOLINT
+#include "FFAdapterUtils.h"  // NOLINT
+
+#include "rt_node_tests.h"   // NOLINT
+#include "rt_metadata.h"     // NOLINT
+#include "RTMediaBuffer.h"   // NOLINT
+#include "RTMediaMetaKeys.h" // NOLINT
+
+#ifdef OS_WINDOWS
+#define TEST_URI "E:\\CloudSync\\low-used\\videos\\h264-1080p.mp4"
+#else
+#define TEST_URI "h264-1080p.mp4"
+#endif
+
+#define TRICK_TEST_TIME_MS      3000
+
+static const INT32 gTrickRates[] = { 1, 2, 4, 8, 16, -8 };
+
+typedef struct _TrickTestStat {
+    INT32   mFrames;
+    INT64   mFirstPts;
+    INT64   mLastPts;
+    INT64   mWallUs;
+    INT64   mCpuUs;
+} TrickTestStat;
+
+static INT64 trick_cpu_time_us() {
+#ifndef OS_WINDOWS
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000ll
+             + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+#else
+    return 0ll;
+#endif
+}
+
+// audio snippets of trick play aren't decoded here, they are dropped
+static void trick_drop_audio(RTNode* demuxer, RTMediaBuffer* buf) {
+    RTPacket pkt = {0};
+    buf->reset();
+    buf->getMetaData()->setInt32(kKeyCodecType, RTTRACK_TYPE_AUDIO);
+    while (RT_OK == demuxer->pullBuffer(&buf)) {
+        rt_mediabuf_goto_packet(buf, &pkt);
+        rt_utils_packet_free(&pkt);
+        buf->reset();
+        buf->getMetaData()->setInt32(kKeyCodecType, RTTRACK_TYPE_AUDIO);
+    }
+}
+
+static RT_RET trick_play_run(RTNode* demuxer, RTNode* decoder, INT32 rate,
+                             INT64 startUs, TrickTestStat* stat) {
+    RtMetaData* options = new RtMetaData();
+    options->setInt32(kKeyTrickRate, rate);
+    options->setInt64(kKeySeekTimeUs, startUs);
+
+    // workflow of player: pause flush trickplay start
+    RTNodeAdapter::runCmd(demuxer, RT_NODE_CMD_PAUSE, RT_NULL);
+    RTNodeAdapter::runCmd(decoder, RT_NODE_CMD_PAUSE, RT_NULL);
+    RTNodeAdapter::runCmd(demuxer, RT_NODE_CMD_FLUSH, RT_NULL);
+    RTNodeAdapter::runCmd(decoder, RT_NODE_CMD_FLUSH, RT_NULL);
+    RTNodeAdapter::runCmd(demuxer, RT_NODE_CMD_TRICKPLAY, options);
+    RTNodeAdapter::runCmd(decoder, RT_NODE_CMD_TRICKPLAY, options);
+    RTNodeAdapter::runCmd(demuxer, RT_NODE_CMD_START, RT_NULL);
+    RTNodeAdapter::runCmd(decoder, RT_NODE_CMD_START, RT_NULL);
+
+    rt_memset(stat, 0, sizeof(TrickTestStat));
+    RTMediaBuffer* audio    = new RTMediaBuffer(RT_NULL, 0);
+    RTMediaBuffer* esPacket = RT_NULL;
+    RTMediaBuffer* frame    = RT_NULL;
+    INT64 cpuUs   = trick_cpu_time_us();
+    INT64 startMs = RtTime::getNowTimeMs();
+    while (RtTime::getNowTimeMs() - startMs < TRICK_TEST_TIME_MS) {
+        trick_drop_audio(demuxer, audio);
+        if (RT_NULL == esPacket) {
+            RTNodeAdapter::dequeCodecBuffer(decoder, &esPacket, RT_PORT_INPUT);
+        }
+        if (RT_NULL != esPacket) {
+            esPacket->getMetaData()->setInt32(kKeyCodecType, RTTRACK_TYPE_VIDEO);
+            if (RT_OK == RTNodeAdapter::pullBuffer(demuxer, &esPacket)) {
+                RTNodeAdapter::pushBuffer(decoder, esPacket);
+                esPacket = RT_NULL;
+            }
+        }
+
+        frame = RT_NULL;
+        RTNodeAdapter::pullBuffer(decoder, &frame);
+        if (RT_NULL == frame) {
+            RtTime::sleepMs(1);
+            continue;
+        }
+        INT32 eos   = 0;
+        INT64 ptsUs = 0ll;
+        frame->getMetaData()->findInt32(kKeyFrameEOS, &eos);
+        frame->getMetaData()->findInt64(kKeyFramePts, &ptsUs);
+        if ((RT_MEDIA_BUFFER_STATUS_READY == frame->getStatus()) && !eos) {
+            if (0 == stat->mFrames) {
+                stat->mFirstPts = ptsUs;
+            }
+            stat->mLastPts = ptsUs;
+            stat->mFrames++;
+        }
+        frame->release();
+        if (eos) {
+            break;
+        }
+    }
+    stat->mWallUs = (RtTime::getNowTimeMs() - startMs) * 1000ll;
+    stat->mCpuUs  = trick_cpu_time_us() - cpuUs;
+
+    if (RT_NULL != esPacket) {
+        esPacket->release();
+    }
+    rt_safe_delete(audio);
+    rt_safe_delete(options);
+    return (stat->mFrames > 0) ? RT_OK : RT_ERR_VALUE;
+}
+
+RT_RET unit_test_node_trick_play(INT32 index, INT32 total) {
+    RT_RET      err  = RT_OK;
+    RtMetaData* meta = new RtMetaData();
+    meta->setCString(kKeyFormatUri, TEST_URI);
+
+    RTNodeDemuxer* demuxer = reinterpret_cast<RTNodeDemuxer*>(ff_node_demuxer.mCreateNode());
+    RTNode*        decoder = ff_node_decoder.mCreateNode();
+    RTNodeAdapter::init(demuxer, meta);
+    INT32 videoIdx = demuxer->queryTrackUsed(RTTRACK_TYPE_VIDEO);
+    INT64 duration = demuxer->queryDuration();
+    if (videoIdx < 0) {
+        RT_LOGE("no video track in %s", TEST_URI);
+        RTNodeAdapter::release(demuxer);
+        delete demuxer;
+        delete decoder;
+        return RT_ERR_UNKNOWN;
+    }
+    RTNodeAdapter::init(decoder, demuxer->queryTrackMeta(videoIdx, RTTRACK_TYPE_VIDEO));
+    RTNodeAdapter::runCmd(demuxer, RT_NODE_CMD_PREPARE, RT_NULL);
+    RTNodeAdapter::runCmd(decoder, RT_NODE_CMD_PREPARE, RT_NULL);
+
+    RT_LOGE("trick play of %s, duration: %lldms", TEST_URI, duration/1000);
+    RT_LOGE("  rate | frames |   fps | media(s)/wall(s) |  cpu");
+    for (INT32 idx = 0; idx < (INT32)RT_ARRAY_ELEMS(gTrickRates); idx++) {
+        INT32 rate = gTrickRates[idx];
+        TrickTestStat stat;
+        // rewind starts from the middle, the others from the beginning
+        err = trick_play_run(demuxer, decoder, rate, (rate < 0) ? duration / 2 : 0ll, &stat);
+        if (RT_OK != err) {
+            RT_LOGE("no frame at rate %d", rate);
+            break;
+        }
+        INT64 mediaUs = RT_ABS(stat.mLastPts - stat.mFirstPts);
+        RT_LOGE("  %4d | %6d | %5lld | %16.2f | %3lld%%",
+                 rate, stat.mFrames, stat.mFrames * 1000000ll / stat.mWallUs,
+                 static_cast<double>(mediaUs) / stat.mWallUs,
+                 stat.mCpuUs * 100 / stat.mWallUs);
+    }
+
+    RTNodeAdapter::runCmd(decoder, RT_NODE_CMD_STOP, RT_NULL);
+    RTNodeAdapter::runCmd(demuxer, RT_NODE_CMD_STOP, RT_NULL);
+    RTNodeAdapter::release(decoder);
+    RTNodeAdapter::release(demuxer);
+    delete decoder;
+    delete demuxer;
+
+    RT_LOGE("trick play %s", (RT_OK == err) ? "PASS" : "FAIL");
+    return err;
+}
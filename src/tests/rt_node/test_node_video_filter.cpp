@@ -0,0 +1,211 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: video filter of scale and conversion, slices against a whole
+ *         frame, and frames per second by threads
+ */
+
+#include <stdlib.h>               // NOLINT
+#include <string.h>               // NOLINT
+
+#include "RTFilterVideoScale.h"   // NOLINT
+#include "rt_node_tests.h"        // NOLINT
+#include "rt_metadata.h"          // NOLINT
+#include "rt_cpu_info.h"          // NOLINT
+#include "rt_time.h"              // NOLINT
+#include "RTMediaBufferPool.h"    // NOLINT
+#include "RTMediaMetaKeys.h"      // NOLINT
+#include "RTImageScale.h"         // NOLINT
+#include "RTImageColor.h"         // NOLINT
+
+#define FILTER_TEST_SRC_W       1920
+#define FILTER_TEST_SRC_H       1080
+#define FILTER_TEST_FRAMES      60
+#define FILTER_TEST_INPUTS      4
+#define FILTER_TEST_TIMEOUT_MS  5000
+
+typedef struct _FilterTestCase {
+    const char       *mName;
+    INT32             mDstW;
+    INT32             mDstH;
+    INT32             mFormat;
+    RTImageScaleMode  mMode;
+} FilterTestCase;
+
+static const FilterTestCase gFilterCases[] = {
+    { "preview bilinear", 640,  360,  RT_FMT_YUV420P,  RT_IMAGE_SCALE_BILINEAR },
+    { "preview bicubic",  640,  360,  RT_FMT_YUV420P,  RT_IMAGE_SCALE_BICUBIC  },
+    { "720p bicubic",     1280, 720,  RT_FMT_YUV420P,  RT_IMAGE_SCALE_BICUBIC  },
+    { "rgba 1080p",       1920, 1080, RT_FMT_ABGR8888, RT_IMAGE_SCALE_BILINEAR },
+    { "rgb24 720p",       1280, 720,  RT_FMT_RGB888,   RT_IMAGE_SCALE_BILINEAR },
+};
+
+// the same frame of a whole, by one thread
+static UINT8* filter_expect(const UINT8 *src, const FilterTestCase *test, INT32 *size) {
+    INT32  dstW      = test->mDstW;
+    INT32  dstH      = test->mDstH;
+    INT32  yuvSize   = dstW * dstH * 3 / 2;
+    UINT8 *yuv       = rt_malloc_size(UINT8, yuvSize);
+    const UINT8 *planes[3]  = { src, src + FILTER_TEST_SRC_W * FILTER_TEST_SRC_H,
+                                src + FILTER_TEST_SRC_W * FILTER_TEST_SRC_H * 5 / 4 };
+    const INT32  strides[3] = { FILTER_TEST_SRC_W, FILTER_TEST_SRC_W / 2, FILTER_TEST_SRC_W / 2 };
+    UINT8 *dst[3]       = { yuv, yuv + dstW * dstH, yuv + dstW * dstH * 5 / 4 };
+    INT32  dstStride[3] = { dstW, dstW / 2, dstW / 2 };
+    rt_image_scale_yuv420_slice(planes, strides, FILTER_TEST_SRC_W, FILTER_TEST_SRC_H,
+                                dst, dstStride, dstW, dstH, test->mMode, 0, dstH);
+    if (RT_FMT_YUV420P == test->mFormat) {
+        *size = yuvSize;
+        return yuv;
+    }
+
+    RTImageRGBFormat format = (RT_FMT_RGB888 == test->mFormat) ? RT_IMAGE_RGB24 : RT_IMAGE_RGBA32;
+    INT32  bpp = (RT_FMT_RGB888 == test->mFormat) ? 3 : 4;
+    UINT8 *rgb = rt_malloc_size(UINT8, dstW * dstH * bpp);
+    RTImageYUV image;
+    rt_memset(&image, 0, sizeof(RTImageYUV));
+    for (INT32 idx = 0; idx < 3; idx++) {
+        image.mPlane[idx]  = dst[idx];
+        image.mStride[idx] = dstStride[idx];
+    }
+    image.mWidth  = dstW;
+    image.mHeight = dstH;
+    image.mFormat = RT_FMT_YUV420P;
+    rt_image_yuv_to_rgb(&image, rgb, dstW * bpp, format);
+    rt_safe_free(yuv);
+    *size = dstW * dstH * bpp;
+    return rgb;
+}
+
+/*
+ * frames are pushed as fast as filter takes them, and pulled at once.
+ * the first frame of output is checked against the expected one.
+ */
+static RT_RET filter_run_case(RTMediaBufferPool *inputs, const FilterTestCase *test, INT32 threads,
+                              const UINT8 *expect, INT32 expectSize, INT32 *frameRate) {
+    RtMetaData *meta = new RtMetaData();
+    meta->setInt32(kKeyFrameW, FILTER_TEST_SRC_W);
+    meta->setInt32(kKeyFrameH, FILTER_TEST_SRC_H);
+    meta->setInt32(kKeyVCodecWidth,  test->mDstW);
+    meta->setInt32(kKeyVCodecHeight, test->mDstH);
+    meta->setInt32(kKeyCodecFormat, test->mFormat);
+    meta->setInt32(kKeyFilterScaleMode, test->mMode);
+    meta->setInt32(kKeyFilterThreads, threads);
+
+    RTNode *filter = rt_filter_video_scale.mCreateNode();
+    RT_RET  err    = filter->runCmd(RT_NODE_CMD_INIT, meta);
+    if (RT_OK != err) {
+        rt_safe_delete(filter);
+        rt_safe_delete(meta);
+        return err;
+    }
+    filter->runCmd(RT_NODE_CMD_PREPARE, RT_NULL);
+    filter->runCmd(RT_NODE_CMD_START, RT_NULL);
+
+    INT32 pushed  = 0;
+    INT32 pulled  = 0;
+    INT64 beginUs = RtTime::getNowTimeUs();
+    RTMediaBuffer *input = RT_NULL;
+    while ((pulled < FILTER_TEST_FRAMES) && (RtTime::getNowTimeUs() - beginUs < FILTER_TEST_TIMEOUT_MS * 1000ll)) {
+        // frames in filter are fewer than the pool, so one of input is free
+        if ((pushed < FILTER_TEST_FRAMES) && (pushed - pulled < FILTER_TEST_INPUTS - 1) && (RT_NULL == input)) {
+            inputs->acquireBuffer(&input, RT_FALSE);
+            if (RT_NULL != input) {
+                input->getMetaData()->setInt64(kKeyFramePts, pushed * 40000ll);
+                input->getMetaData()->setInt32(kKeyFrameW, FILTER_TEST_SRC_W);
+                input->getMetaData()->setInt32(kKeyFrameH, FILTER_TEST_SRC_H);
+            }
+        }
+        if ((RT_NULL != input) && (RT_OK == filter->pushBuffer(input))) {
+            input = RT_NULL;
+            pushed++;
+        }
+
+        RTMediaBuffer *output = RT_NULL;
+        if (RT_OK != filter->pullBuffer(&output)) {
+            RtTime::sleepUs(200);
+            continue;
+        }
+        if ((0 == pulled) && ((output->getLength() != (UINT32)expectSize)
+              || (0 != memcmp(output->getData(), expect, expectSize)))) {
+            RT_LOGE("%s: output of %d threads differs from a whole frame", test->mName, threads);
+            err = RT_ERR_VALUE;
+        }
+        output->release();
+        pulled++;
+    }
+    INT64 costUs = RT_MAX(RtTime::getNowTimeUs() - beginUs, 1ll);
+    *frameRate   = (INT32)(pulled * 1000000ll / costUs);
+    if (RT_NULL != input) {
+        input->release();
+    }
+    if (pulled < FILTER_TEST_FRAMES) {
+        RT_LOGE("%s: %d of %d frames in %dms", test->mName, pulled, FILTER_TEST_FRAMES, FILTER_TEST_TIMEOUT_MS);
+        err = RT_ERR_TIMEOUT;
+    }
+
+    filter->runCmd(RT_NODE_CMD_STOP, RT_NULL);
+    rt_safe_delete(filter);
+    rt_safe_delete(meta);
+    return err;
+}
+
+RT_RET unit_test_node_video_filter(INT32 index, INT32 total) {
+    (void)index;
+    (void)total;
+    INT32  size    = FILTER_TEST_SRC_W * FILTER_TEST_SRC_H * 3 / 2;
+    // slices are checked even if there is only one cpu
+    INT32  threads = RT_MIN(RT_MAX((INT32)rt_cpu_count(), 4), FILTER_MAX_THREADS);
+    RT_RET err     = RT_OK;
+
+    // frames of input are random, they are kept in pool
+    RTMediaBufferPool *inputs = new RTMediaBufferPool(FILTER_TEST_INPUTS);
+    RTMediaBuffer     *buffers[FILTER_TEST_INPUTS];
+    srand(22);
+    for (INT32 idx = 0; idx < FILTER_TEST_INPUTS; idx++) {
+        buffers[idx] = new RTMediaBuffer(size);
+        UINT8 *data  = reinterpret_cast<UINT8 *>(buffers[idx]->getData());
+        for (INT32 pos = 0; pos < size; pos++) {
+            data[pos] = (UINT8)(((pos % FILTER_TEST_SRC_W) + (pos / FILTER_TEST_SRC_W) * 3 + (rand() & 15)) & 0xff);
+        }
+        // all frames are the same as the first one
+        if (idx > 0) {
+            rt_memcpy(data, buffers[0]->getData(), size);
+        }
+        inputs->registerBuffer(buffers[idx]);
+    }
+    inputs->start();
+
+    RT_LOGE("  case             | 1 thread  | %d threads | speedup", threads);
+    for (UINT32 cs = 0; cs < RT_ARRAY_ELEMS(gFilterCases); cs++) {
+        const FilterTestCase *test = &gFilterCases[cs];
+        INT32  expectSize = 0;
+        UINT8 *expect     = filter_expect(reinterpret_cast<UINT8 *>(buffers[0]->getData()), test, &expectSize);
+        INT32  serial     = 0;
+        INT32  parallel   = 0;
+        RT_RET ret        = filter_run_case(inputs, test, 1, expect, expectSize, &serial);
+        if (RT_OK == ret) {
+            ret = filter_run_case(inputs, test, threads, expect, expectSize, &parallel);
+        }
+        RT_LOGE("  %-16s | %5d fps | %6d fps | %.2fx", test->mName, serial, parallel,
+                 (double)parallel / RT_MAX(serial, 1));
+        err = (RT_OK != ret) ? ret : err;
+        rt_safe_free(expect);
+    }
+
+    inputs->stop();
+    rt_safe_delete(inputs);
+    RT_LOGE("node video filter %s", (RT_OK == err) ? "PASS" : "FAIL");
+    return err;
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: gapless playback, pcm of two items is spliced sample by sample
+ */
+
+#include <stdio.h>              // NOLINT
+#include <math.h>               // NOLINT
+
+#include "rt_header.h"          // NOLINT
+#include "rt_time.h"            // NOLINT
+
+#include "player_test_utils.h"  // NOLINT
+#include "RTNDKMediaPlayer.h"   // NOLINT
+#include "RTNDKMediaDef.h"      // NOLINT
+
+#define GAPLESS_SAMPLE_RATE   44100
+#define GAPLESS_CHANNELS      2
+#define GAPLESS_SINE_HZ       441
+// split point isn't aligned to any packet or frame size
+#define GAPLESS_SPLIT_SAMPLES (GAPLESS_SAMPLE_RATE * 2 + 317)
+#define GAPLESS_TOTAL_SAMPLES (GAPLESS_SAMPLE_RATE * 4 + 59)
+#define GAPLESS_TIMEOUT_MS    30000
+
+#define GAPLESS_FIRST_FILE    "gapless_first.wav"
+#define GAPLESS_SECOND_FILE   "gapless_second.wav"
+#define GAPLESS_OUTPUT_FILE   "gapless_output.pcm"
+
+static INT16 gapless_sine_sample(INT32 idx, INT32 channel) {
+    double phase = 2.0 * M_PI * GAPLESS_SINE_HZ * idx / GAPLESS_SAMPLE_RATE;
+    return (INT16)(16000 * sin(phase + channel * M_PI / 2));
+}
+
+static void gapless_write_le(FILE* fp, UINT32 value, INT32 bytes) {
+    for (INT32 idx = 0; idx < bytes; idx++) {
+        fputc((value >> (8 * idx)) & 0xff, fp);
+    }
+}
+
+/*
+ * write samples [start, end) of one continuous sine to a s16le wav file.
+ */
+static RT_RET gapless_write_wav(const char* path, INT32 start, INT32 end) {
+    FILE* fp = fopen(path, "wb");
+    if (RT_NULL == fp) {
+        RT_LOGE("fail to open %s", path);
+        return RT_ERR_OPEN_FILE;
+    }
+    UINT32 dataSize = (end - start) * GAPLESS_CHANNELS * sizeof(INT16);
+    fwrite("RIFF", 1, 4, fp);
+    gapless_write_le(fp, 36 + dataSize, 4);
+    fwrite("WAVEfmt ", 1, 8, fp);
+    gapless_write_le(fp, 16, 4);
+    gapless_write_le(fp, 1, 2);
+    gapless_write_le(fp, GAPLESS_CHANNELS, 2);
+    gapless_write_le(fp, GAPLESS_SAMPLE_RATE, 4);
+    gapless_write_le(fp, GAPLESS_SAMPLE_RATE * GAPLESS_CHANNELS * sizeof(INT16), 4);
+    gapless_write_le(fp, GAPLESS_CHANNELS * sizeof(INT16), 2);
+    gapless_write_le(fp, 16, 2);
+    fwrite("data", 1, 4, fp);
+    gapless_write_le(fp, dataSize, 4);
+    for (INT32 idx = start; idx < end; idx++) {
+        for (INT32 ch = 0; ch < GAPLESS_CHANNELS; ch++) {
+            gapless_write_le(fp, (UINT16)gapless_sine_sample(idx, ch), 2);
+        }
+    }
+    fclose(fp);
+    return RT_OK;
+}
+
+/*
+ * output must be the original sine: no silence, no overlap at the boundary.
+ */
+static RT_RET gapless_check_output(const char* path) {
+    FILE* fp = fopen(path, "rb");
+    if (RT_NULL == fp) {
+        RT_LOGE("fail to open %s", path);
+        return RT_ERR_OPEN_FILE;
+    }
+    INT16  pcm[GAPLESS_CHANNELS];
+    INT32  count    = 0;
+    INT32  mismatch = -1;
+    while (fread(pcm, sizeof(INT16), GAPLESS_CHANNELS, fp) == GAPLESS_CHANNELS) {
+        for (INT32 ch = 0; (ch < GAPLESS_CHANNELS) && (mismatch < 0); ch++) {
+            if (pcm[ch] != gapless_sine_sample(count, ch)) {
+                mismatch = count;
+            }
+        }
+        count++;
+    }
+    fclose(fp);
+
+    RT_LOGE("output samples=%d expected=%d split=%d first-mismatch=%d",
+             count, GAPLESS_TOTAL_SAMPLES, GAPLESS_SPLIT_SAMPLES, mismatch);
+    if ((count != GAPLESS_TOTAL_SAMPLES) || (mismatch >= 0)) {
+        return RT_ERR_VALUE;
+    }
+    return RT_OK;
+}
+
+RT_RET unit_test_player_gapless() {
+    RT_RET err = RT_OK;
+    gapless_write_wav(GAPLESS_FIRST_FILE,  0, GAPLESS_SPLIT_SAMPLES);
+    gapless_write_wav(GAPLESS_SECOND_FILE, GAPLESS_SPLIT_SAMPLES, GAPLESS_TOTAL_SAMPLES);
+
+    RTNDKMediaPlayer* player = new RTNDKMediaPlayer();
+    player->setAudioSinkFile(GAPLESS_OUTPUT_FILE);
+    player->setDataSource(GAPLESS_FIRST_FILE, RT_NULL);
+    player->setNextDataSource(GAPLESS_SECOND_FILE, RT_NULL);
+    player->prepare();
+    player->start();
+
+    INT64 startMs = RtTime::getNowTimeMs();
+    while (RtTime::getNowTimeMs() - startMs < GAPLESS_TIMEOUT_MS) {
+        rt_status state = player->getState();
+        if ((RT_STATE_COMPLETE == state) || (RT_STATE_ERROR == state)) {
+            break;
+        }
+        RtTime::sleepMs(10);
+    }
+    player->stop();
+    player->reset();
+    rt_safe_delete(player);
+
+    err = gapless_check_output(GAPLESS_OUTPUT_FILE);
+    RT_LOGE("gapless playback %s", (RT_OK == err) ? "PASS" : "FAIL");
+    return err;
+}
+
+int main(int argc, char **argv) {
+    rt_mem_record_reset();
+
+    RT_RET err = unit_test_player_gapless();
+
+    rt_mem_record_dump();
+    return (RT_OK == err) ? 0 : -1;
+}
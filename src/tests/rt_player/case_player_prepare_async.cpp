@@ -0,0 +1,142 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: benchmark of time-to-prepared for concurrent players
+ */
+
+#include <stdlib.h>             // NOLINT
+
+#include "rt_header.h"          // NOLINT
+#include "rt_time.h"            // NOLINT
+
+#include "player_test_utils.h"  // NOLINT
+#include "RTNDKMediaPlayer.h"   // NOLINT
+#include "RTNDKMediaDef.h"      // NOLINT
+
+#include "RTObject.h"           // NOLINT
+
+#define MAX_PLAYER_COUNT    64
+#define PREPARE_TIMEOUT_MS  30000
+
+typedef struct _PrepareBenchCtx {
+    RTNDKMediaPlayer* mPlayers[MAX_PLAYER_COUNT];
+    INT64             mPreparedMs[MAX_PLAYER_COUNT];
+    INT32             mCount;
+} PrepareBenchCtx;
+
+static void bench_dump_result(PrepareBenchCtx* ctx, const char* mode, INT64 apiMs, INT64 totalMs) {
+    INT64 minMs = RT_INT64_MAX;
+    INT64 maxMs = 0;
+    INT64 sumMs = 0;
+    INT32 count = 0;
+    for (INT32 idx = 0; idx < ctx->mCount; idx++) {
+        if (ctx->mPreparedMs[idx] < 0) {
+            continue;
+        }
+        minMs  = RT_MIN(minMs, ctx->mPreparedMs[idx]);
+        maxMs  = RT_MAX(maxMs, ctx->mPreparedMs[idx]);
+        sumMs += ctx->mPreparedMs[idx];
+        count++;
+    }
+    RT_LOGE("%-6s players=%02d prepared=%02d api-blocked=%lldms total=%lldms",
+             mode, ctx->mCount, count, apiMs, totalMs);
+    if (count > 0) {
+        RT_LOGE("%-6s time-to-prepared min=%lldms avg=%lldms max=%lldms",
+                 mode, minMs, sumMs/count, maxMs);
+    }
+}
+
+/*
+ * sync:  prepare() of every player is called one by one on caller thread.
+ * async: prepareAsync() of every player returns at once, then polls states.
+ */
+RT_RET unit_test_player_prepare(const char* uri, INT32 count, RT_BOOL async) {
+    PrepareBenchCtx ctx;
+    rt_memset(&ctx, 0, sizeof(PrepareBenchCtx));
+    ctx.mCount = count;
+    for (INT32 idx = 0; idx < count; idx++) {
+        ctx.mPlayers[idx]    = new RTNDKMediaPlayer();
+        ctx.mPreparedMs[idx] = -1;
+    }
+
+    INT64 startMs = RtTime::getNowTimeMs();
+    for (INT32 idx = 0; idx < count; idx++) {
+        ctx.mPlayers[idx]->setDataSource(uri, RT_NULL);
+        if (async) {
+            ctx.mPlayers[idx]->prepareAsync();
+        } else {
+            ctx.mPlayers[idx]->prepare();
+            ctx.mPreparedMs[idx] = RtTime::getNowTimeMs() - startMs;
+        }
+    }
+    INT64 apiMs = RtTime::getNowTimeMs() - startMs;
+
+    INT32 pending = async ? count : 0;
+    while ((pending > 0) && (RtTime::getNowTimeMs() - startMs < PREPARE_TIMEOUT_MS)) {
+        pending = 0;
+        for (INT32 idx = 0; idx < count; idx++) {
+            if (ctx.mPreparedMs[idx] >= 0) {
+                continue;
+            }
+            switch (ctx.mPlayers[idx]->getState()) {
+              case RT_STATE_PREPARED:
+                ctx.mPreparedMs[idx] = RtTime::getNowTimeMs() - startMs;
+                break;
+              case RT_STATE_ERROR:
+                break;
+              default:
+                pending++;
+                break;
+            }
+        }
+        RtTime::sleepMs(1);
+    }
+    INT64 totalMs = RtTime::getNowTimeMs() - startMs;
+
+    bench_dump_result(&ctx, async ? "async" : "sync", apiMs, totalMs);
+
+    for (INT32 idx = 0; idx < count; idx++) {
+        ctx.mPlayers[idx]->reset();
+        rt_safe_delete(ctx.mPlayers[idx]);
+    }
+    return RT_OK;
+}
+
+int main(int argc, char **argv) {
+    const char* uri   = NULL;
+    INT32       count = 8;
+    switch (argc) {
+      case 3:
+        count = atoi(argv[2]);
+      case 2:
+        uri = argv[1];
+        break;
+      default:
+        RT_LOGE("Usage:");
+        RT_LOGE("./case_player_prepare_async <uri> [players]");
+        return 0;
+    }
+    count = RT_MAX(1, RT_MIN(count, MAX_PLAYER_COUNT));
+
+    rt_mem_record_reset();
+    RTObject::resetTraces();
+
+    unit_test_player_prepare(uri, count, RT_FALSE);
+    unit_test_player_prepare(uri, count, RT_TRUE);
+
+    rt_mem_record_dump();
+    RTObject::dumpTraces();
+    return 0;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: benchmark of switch latency, reset-setDataSource-prepare-start
+ */
+
+#include <stdlib.h>             // NOLINT
+
+#include "rt_header.h"          // NOLINT
+#include "rt_time.h"            // NOLINT
+
+#include "player_test_utils.h"  // NOLINT
+#include "RTNDKMediaPlayer.h"   // NOLINT
+#include "RTNDKMediaDef.h"      // NOLINT
+
+#include "RTObject.h"           // NOLINT
+
+#define MAX_SWITCH_COUNT    1000
+#define SWITCH_PLAY_MS      200
+
+typedef struct _SwitchBenchCtx {
+    INT64   mSwitchUs[MAX_SWITCH_COUNT];
+    INT64   mStartUs[MAX_SWITCH_COUNT];
+    INT32   mCount;
+} SwitchBenchCtx;
+
+static void bench_dump_stage(const char* stage, INT64* samples, INT32 count) {
+    INT64 minUs = RT_INT64_MAX;
+    INT64 maxUs = 0;
+    INT64 sumUs = 0;
+    // first switch builds nodes from scratch, the others may reuse nodes
+    for (INT32 idx = 1; idx < count; idx++) {
+        minUs  = RT_MIN(minUs, samples[idx]);
+        maxUs  = RT_MAX(maxUs, samples[idx]);
+        sumUs += samples[idx];
+    }
+    if (count > 1) {
+        RT_LOGE("%-8s first=%lldus min=%lldus avg=%lldus max=%lldus",
+                 stage, samples[0], minUs, sumUs/(count - 1), maxUs);
+    }
+}
+
+/*
+ * same usage as case_player_fast_switch, but one control thread only, so
+ * that every switch is measured without interference.
+ */
+RT_RET unit_test_player_switch_latency(const char* uri1, const char* uri2, INT32 count) {
+    SwitchBenchCtx ctx;
+    rt_memset(&ctx, 0, sizeof(SwitchBenchCtx));
+    ctx.mCount = count;
+
+    RTNDKMediaPlayer* player = new RTNDKMediaPlayer();
+    for (INT32 idx = 0; idx < count; idx++) {
+        const char* uri = (idx % 2) ? uri2 : uri1;
+        INT64 beginUs   = RtTime::getNowTimeUs();
+        player->reset();
+        player->setDataSource(uri, RT_NULL);
+        player->prepare();
+        INT64 preparedUs = RtTime::getNowTimeUs();
+        player->start();
+        INT64 startedUs  = RtTime::getNowTimeUs();
+
+        ctx.mSwitchUs[idx] = preparedUs - beginUs;
+        ctx.mStartUs[idx]  = startedUs - beginUs;
+        RT_LOGD("switch(%03d) to %s: prepared=%lldus started=%lldus",
+                 idx, uri, ctx.mSwitchUs[idx], ctx.mStartUs[idx]);
+        RtTime::sleepMs(SWITCH_PLAY_MS);
+    }
+    player->stop();
+    player->reset();
+    rt_safe_delete(player);
+
+    RT_LOGE("switches=%d between %s and %s", count, uri1, uri2);
+    bench_dump_stage("prepared", ctx.mSwitchUs, count);
+    bench_dump_stage("started",  ctx.mStartUs,  count);
+    return RT_OK;
+}
+
+int main(int argc, char **argv) {
+    const char* uri1  = NULL;
+    const char* uri2  = NULL;
+    INT32       count = 50;
+    switch (argc) {
+      case 4:
+        count = atoi(argv[3]);
+      case 3:
+        uri1 = argv[1];
+        uri2 = argv[2];
+        break;
+      default:
+        RT_LOGE("Usage:");
+        RT_LOGE("./case_player_switch_latency <uri1> <uri2> [switches]");
+        return 0;
+    }
+    count = RT_MAX(2, RT_MIN(count, MAX_SWITCH_COUNT));
+
+    rt_mem_record_reset();
+    RTObject::resetTraces();
+
+    unit_test_player_switch_latency(uri1, uri2, count);
+
+    rt_mem_record_dump();
+    RTObject::dumpTraces();
+    return 0;
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: benchmark of batch thumbnail, files per second and peak memory
+ */
+
+#include <dirent.h>             // NOLINT
+#include <stdio.h>              // NOLINT
+#include <stdlib.h>             // NOLINT
+
+#include "rt_header.h"          // NOLINT
+#include "rt_time.h"            // NOLINT
+#include "rt_mutex.h"           // NOLINT
+
+#include "RTNDKThumbnailer.h"   // NOLINT
+
+#define MAX_THUMBNAIL_FILES     1024
+#define THUMBNAIL_WIDTH         320
+#define THUMBNAIL_HEIGHT        180
+
+typedef struct _ThumbBenchCtx {
+    RtMutex    *mLock;
+    INT32       mDone;
+    INT32       mFailed;
+    INT64       mPixels;
+} ThumbBenchCtx;
+
+static void bench_on_thumbnail(void *opaque, INT32 index, RT_RET err, const RTThumbnail *thumb) {
+    ThumbBenchCtx *ctx = reinterpret_cast<ThumbBenchCtx *>(opaque);
+    RtMutex::RtAutolock autoLock(ctx->mLock);
+    if (RT_OK == err) {
+        ctx->mDone++;
+        ctx->mPixels += thumb->mWidth * thumb->mHeight;
+        RT_LOGD("thumbnail(%03d) %dx%d at %lldus", index, thumb->mWidth, thumb->mHeight, thumb->mPtsUs);
+    } else {
+        ctx->mFailed++;
+        RT_LOGD("thumbnail(%03d) fails, err: %d", index, err);
+    }
+}
+
+static INT32 bench_list_dir(const char *dir, char **uris, INT32 maxCount) {
+    DIR *handle = opendir(dir);
+    if (RT_NULL == handle) {
+        RT_LOGE("fail to open dir %s", dir);
+        return 0;
+    }
+    INT32 count = 0;
+    struct dirent *entry = RT_NULL;
+    while ((count < maxCount) && (RT_NULL != (entry = readdir(handle)))) {
+        if ('.' == entry->d_name[0]) {
+            continue;
+        }
+        uris[count] = rt_malloc_size(char, 1024);
+        snprintf(uris[count], 1024, "%s/%s", dir, entry->d_name);
+        count++;
+    }
+    closedir(handle);
+    return count;
+}
+
+RT_RET unit_test_player_thumbnail(const char *dir, INT32 threads, INT64 budget) {
+    char  *uris[MAX_THUMBNAIL_FILES];
+    INT32  count = bench_list_dir(dir, uris, MAX_THUMBNAIL_FILES);
+    if (count <= 0) {
+        return RT_ERR_VALUE;
+    }
+
+    ThumbBenchCtx ctx;
+    rt_memset(&ctx, 0, sizeof(ThumbBenchCtx));
+    ctx.mLock = new RtMutex();
+
+    RTNDKThumbnailer *thumbnailer = new RTNDKThumbnailer(threads, budget);
+    INT64 beginUs = RtTime::getNowTimeUs();
+    thumbnailer->extractBatch(const_cast<const char **>(uris), count, -1,
+                              THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT, bench_on_thumbnail, &ctx);
+    INT64 costUs  = RtTime::getNowTimeUs() - beginUs;
+
+    RT_LOGE("files=%d done=%d failed=%d threads=%d cost=%lldms",
+             count, ctx.mDone, ctx.mFailed, threads, costUs / 1000);
+    RT_LOGE("throughput=%.2f files/s peak-memory=%lldKB of budget %lldKB",
+             count * 1000000.0 / RT_MAX(costUs, 1ll), thumbnailer->getPeakMemory() / 1024, budget / 1024);
+
+    rt_safe_delete(thumbnailer);
+    rt_safe_delete(ctx.mLock);
+    for (INT32 idx = 0; idx < count; idx++) {
+        rt_safe_free(uris[idx]);
+    }
+    return (ctx.mDone > 0) ? RT_OK : RT_ERR_UNKNOWN;
+}
+
+int main(int argc, char **argv) {
+    const char* dir     = NULL;
+    INT32       threads = 0;
+    INT64       budget  = THUMBNAIL_DEFAULT_BUDGET;
+    switch (argc) {
+      case 4:
+        budget  = atoll(argv[3]) * 1024 * 1024;
+      case 3:
+        threads = atoi(argv[2]);
+      case 2:
+        dir     = argv[1];
+        break;
+      default:
+        RT_LOGE("Usage:");
+        RT_LOGE("./case_player_thumbnail <dir> [threads] [budget in MB]");
+        return 0;
+    }
+
+    rt_mem_record_reset();
+
+    unit_test_player_thumbnail(dir, threads, budget);
+
+    rt_mem_record_dump();
+    return 0;
+}
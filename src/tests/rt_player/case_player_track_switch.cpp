@@ -0,0 +1,250 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: audio track is switched while playing, pcm of tracks is spliced
+ *         at audio clock, without gap or overlap.
+ */
+
+#include <stdio.h>              // NOLINT
+
+#include "rt_header.h"          // NOLINT
+#include "rt_mutex.h"           // NOLINT
+#include "rt_time.h"            // NOLINT
+
+#include "player_test_utils.h"  // NOLINT
+#include "RTNDKMediaPlayer.h"   // NOLINT
+#include "RTNDKMediaDef.h"      // NOLINT
+#include "RTNDKNodePlayer.h"    // NOLINT
+#include "rt_message.h"         // NOLINT
+#include "RTMediaData.h"        // NOLINT
+#include "FFAdapterFormat.h"    // NOLINT
+
+#define SWITCH_SAMPLE_RATE    8000
+#define SWITCH_CHANNELS       2
+#define SWITCH_PKT_SAMPLES    256     // 32ms, pts of packets are exact in ms of mkv
+#define SWITCH_TOTAL_SAMPLES  (SWITCH_SAMPLE_RATE * 60)
+#define SWITCH_TRACKS         3       // the last track is pcm_s24le, it needs a new decoder
+#define SWITCH_START_US       (2 * 1000 * 1000ll)
+#define SWITCH_WAIT_MS        300
+#define SWITCH_LATENCY_MS     100
+#define SWITCH_TIMEOUT_MS     30000
+
+#define SWITCH_MEDIA_FILE     "track_switch.mkv"
+#define SWITCH_OUTPUT_FILE    "track_switch_output.pcm"
+
+/*
+ * a sample tells its track and index: left is low 15 bits of index,
+ * right is track * 1000 + high bits of index.
+ */
+static INT16 switch_sample(INT32 track, INT32 idx, INT32 channel) {
+    return (0 == channel) ? (INT16)(idx & 0x7fff) : (INT16)(track * 1000 + (idx >> 15));
+}
+
+class TrackSwitchListener : public RTPlayerListener {
+ public:
+    TrackSwitchListener() : mSwitches(0), mMaxLatencyMs(0) {}
+    void notify(INT32 msg, INT32 ext1, INT32 ext2, void* ptr) {
+        if ((RT_MEDIA_INFO == msg) && (RT_INFO_TRACK_SWITCHED == ext1)) {
+            RtMutex::RtAutolock autoLock(&mLock);
+            mSwitches++;
+            mMaxLatencyMs = RT_MAX(mMaxLatencyMs, ext2);
+            RT_LOGE("audio track is switched, latency: %dms", ext2);
+        }
+    }
+    INT32 switches() {
+        RtMutex::RtAutolock autoLock(&mLock);
+        return mSwitches;
+    }
+    INT32 maxLatencyMs() {
+        RtMutex::RtAutolock autoLock(&mLock);
+        return mMaxLatencyMs;
+    }
+
+ private:
+    RtMutex mLock;
+    INT32   mSwitches;
+    INT32   mMaxLatencyMs;
+};
+
+/*
+ * mkv of SWITCH_TRACKS audio tracks, packets of tracks are interleaved.
+ */
+static RT_RET switch_write_media(const char* path) {
+    FAFormatContext* fc = fa_format_open(path, FLAG_MUXER);
+    if (RT_NULL == fc) {
+        RT_LOGE("fail to open %s", path);
+        return RT_ERR_OPEN_FILE;
+    }
+
+    INT32 sampleBytes[SWITCH_TRACKS];
+    for (INT32 track = 0; track < SWITCH_TRACKS; track++) {
+        sampleBytes[track] = (SWITCH_TRACKS - 1 == track) ? 3 : 2;
+        RTTrackParms par;
+        rt_memset(&par, 0, sizeof(RTTrackParms));
+        par.mCodecType          = RTTRACK_TYPE_AUDIO;
+        par.mCodecID            = (3 == sampleBytes[track]) ? RT_AUDIO_ID_PCM_S24LE : RT_AUDIO_ID_PCM_S16LE;
+        par.mAudioChannels      = SWITCH_CHANNELS;
+        par.mAudioSampleRate    = SWITCH_SAMPLE_RATE;
+        par.mAudioBlockAlign    = SWITCH_CHANNELS * sampleBytes[track];
+        par.mAudiobitsPerCodedSample = sampleBytes[track] * 8;
+        par.mBitrate            = SWITCH_SAMPLE_RATE * par.mAudioBlockAlign * 8;
+        if (fa_format_add_stream(fc, &par) != track) {
+            fa_format_close(fc);
+            return RT_ERR_UNKNOWN;
+        }
+    }
+    if (fa_format_write_header(fc) < 0) {
+        fa_format_close(fc);
+        return RT_ERR_UNKNOWN;
+    }
+
+    UINT8* data = rt_malloc_size(UINT8, SWITCH_PKT_SAMPLES * SWITCH_CHANNELS * 3);
+    RT_RET err  = RT_OK;
+    for (INT32 start = 0; (RT_OK == err) && (start < SWITCH_TOTAL_SAMPLES); start += SWITCH_PKT_SAMPLES) {
+        for (INT32 track = 0; track < SWITCH_TRACKS; track++) {
+            UINT8* ptr = data;
+            for (INT32 idx = start; idx < start + SWITCH_PKT_SAMPLES; idx++) {
+                for (INT32 ch = 0; ch < SWITCH_CHANNELS; ch++) {
+                    // 24 bits sample is decoded to the same 16 bits sample
+                    UINT32 value = (UINT16)switch_sample(track, idx, ch);
+                    if (3 == sampleBytes[track]) {
+                        *ptr++ = 0;
+                    }
+                    *ptr++ = value & 0xff;
+                    *ptr++ = (value >> 8) & 0xff;
+                }
+            }
+            RTPacket pkt;
+            rt_memset(&pkt, 0, sizeof(RTPacket));
+            pkt.mData     = data;
+            pkt.mSize     = ptr - data;
+            pkt.mPts      = (INT64)start * 1000000ll / SWITCH_SAMPLE_RATE;
+            pkt.mDts      = pkt.mPts;
+            pkt.mDuration = (INT64)SWITCH_PKT_SAMPLES * 1000000ll / SWITCH_SAMPLE_RATE;
+            pkt.mFlags    = RT_PACKET_FLAG_KEY;
+            if (fa_format_packet_write(fc, track, &pkt) < 0) {
+                err = RT_ERR_UNKNOWN;
+                break;
+            }
+        }
+    }
+    rt_free(data);
+    if (fa_format_write_trailer(fc) < 0) {
+        err = RT_ERR_UNKNOWN;
+    }
+    fa_format_close(fc);
+    return err;
+}
+
+/*
+ * output goes on sample by sample across switches, and ends with the
+ * track which is selected at last.
+ */
+static RT_RET switch_check_output(const char* path, INT32 switches, INT32 lastTrack) {
+    FILE* fp = fopen(path, "rb");
+    if (RT_NULL == fp) {
+        RT_LOGE("fail to open %s", path);
+        return RT_ERR_OPEN_FILE;
+    }
+    INT16  pcm[SWITCH_CHANNELS];
+    INT32  count    = 0;
+    INT32  mismatch = -1;
+    INT32  track    = -1;
+    INT32  changes  = 0;
+    while (fread(pcm, sizeof(INT16), SWITCH_CHANNELS, fp) == SWITCH_CHANNELS) {
+        INT32 curTrack = pcm[1] / 1000;
+        if ((track >= 0) && (curTrack != track)) {
+            RT_LOGE("track %d -> %d at sample %d", track, curTrack, count);
+            changes++;
+        }
+        track = curTrack;
+        if ((mismatch < 0) && (pcm[0] != switch_sample(track, count, 0)
+              || pcm[1] != switch_sample(track, count, 1))) {
+            mismatch = count;
+        }
+        count++;
+    }
+    fclose(fp);
+
+    RT_LOGE("output samples=%d expected=%d first-mismatch=%d changes=%d switches=%d last-track=%d",
+             count, SWITCH_TOTAL_SAMPLES, mismatch, changes, switches, track);
+    if ((count != SWITCH_TOTAL_SAMPLES) || (mismatch >= 0) || (changes < 2)
+          || (changes != switches) || (track != lastTrack)) {
+        return RT_ERR_VALUE;
+    }
+    return RT_OK;
+}
+
+RT_RET unit_test_player_track_switch() {
+    RT_RET err = switch_write_media(SWITCH_MEDIA_FILE);
+    if (RT_OK != err) {
+        RT_LOGE("fail to write %s", SWITCH_MEDIA_FILE);
+        return err;
+    }
+
+    TrackSwitchListener listener;
+    RTNDKMediaPlayer* player = new RTNDKMediaPlayer();
+    player->setListener(&listener);
+    player->setAudioSinkFile(SWITCH_OUTPUT_FILE);
+    player->setDataSource(SWITCH_MEDIA_FILE, RT_NULL);
+    player->prepare();
+    player->start();
+
+    INT64   startMs  = RtTime::getNowTimeMs();
+    int64_t position = 0;
+    while ((position < SWITCH_START_US) && (RtTime::getNowTimeMs() - startMs < SWITCH_TIMEOUT_MS)) {
+        player->getCurrentPosition(&position);
+        RtTime::sleepMs(2);
+    }
+
+    // the track which plays already isn't switched, the others are
+    INT32 tracks[] = { 1, SWITCH_TRACKS - 1, 0 };
+    for (UINT32 idx = 0; idx < RT_ARRAY_ELEMS(tracks); idx++) {
+        INT32 switches = listener.switches();
+        player->selectTrack(tracks[idx]);
+        INT64 selectMs = RtTime::getNowTimeMs();
+        while ((listener.switches() == switches) && (RtTime::getNowTimeMs() - selectMs < SWITCH_WAIT_MS)) {
+            RtTime::sleepMs(2);
+        }
+    }
+
+    while (RtTime::getNowTimeMs() - startMs < SWITCH_TIMEOUT_MS) {
+        rt_status state = player->getState();
+        if ((RT_STATE_COMPLETE == state) || (RT_STATE_ERROR == state)) {
+            break;
+        }
+        RtTime::sleepMs(10);
+    }
+    player->stop();
+    player->reset();
+    rt_safe_delete(player);
+
+    err = switch_check_output(SWITCH_OUTPUT_FILE, listener.switches(), 0);
+    if ((RT_OK == err) && (listener.maxLatencyMs() >= SWITCH_LATENCY_MS)) {
+        RT_LOGE("latency of switching %dms is over %dms", listener.maxLatencyMs(), SWITCH_LATENCY_MS);
+        err = RT_ERR_VALUE;
+    }
+    RT_LOGE("audio track switching %s", (RT_OK == err) ? "PASS" : "FAIL");
+    return err;
+}
+
+int main(int argc, char **argv) {
+    rt_mem_record_reset();
+
+    RT_RET err = unit_test_player_track_switch();
+
+    rt_mem_record_dump();
+    return (RT_OK == err) ? 0 : -1;
+}
@@ -0,0 +1,230 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: benchmark of transcoding, realtime factor and utilisation of stages.
+ *         segmented transcoding is compared with one line if threads is given.
+ */
+
+#include <dirent.h>             // NOLINT
+#include <stdio.h>              // NOLINT
+#include <stdlib.h>             // NOLINT
+#include <string.h>             // NOLINT
+#include <unistd.h>             // NOLINT
+
+#include "rt_header.h"          // NOLINT
+#include "rt_time.h"            // NOLINT
+#include "rt_thread.h"          // NOLINT
+#include "rt_metadata.h"        // NOLINT
+#include "RTMediaMetaKeys.h"    // NOLINT
+
+#include "RTNDKTranscoder.h"    // NOLINT
+
+#define MAX_STAGE_THREADS       64
+#define STAGE_SAMPLE_MS         50
+
+typedef struct _StageThread {
+    INT32   mTid;
+    char    mName[16];
+    INT64   mTicks;             // utime + stime
+} StageThread;
+
+typedef struct _StageSampler {
+    StageThread mThreads[MAX_STAGE_THREADS];
+    INT32       mCount;
+    RtThread   *mThread;
+} StageSampler;
+
+// threads exit with nodes, so cpu time of each thread is sampled while it runs
+static void sampler_poll(StageSampler *sampler) {
+    DIR *dir = opendir("/proc/self/task");
+    if (RT_NULL == dir) {
+        return;
+    }
+    struct dirent *entry = RT_NULL;
+    while (RT_NULL != (entry = readdir(dir))) {
+        if ('.' == entry->d_name[0]) {
+            continue;
+        }
+        char path[sizeof("/proc/self/task//stat") + sizeof(entry->d_name)];
+        char line[512];
+        snprintf(path, sizeof(path), "/proc/self/task/%s/stat", entry->d_name);
+        FILE *fp = fopen(path, "r");
+        if (RT_NULL == fp) {
+            continue;
+        }
+        size_t size = fread(line, 1, sizeof(line) - 1, fp);
+        fclose(fp);
+        line[size] = 0;
+
+        // comm is in brackets, utime and stime are 14th and 15th fields
+        char *begin = strchr(line, '(');
+        char *end   = strrchr(line, ')');
+        if ((RT_NULL == begin) || (RT_NULL == end)) {
+            continue;
+        }
+        unsigned long utime = 0, stime = 0;
+        if (2 != sscanf(end + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime, &stime)) {
+            continue;
+        }
+
+        INT32 tid = atoi(entry->d_name);
+        INT32 idx = 0;
+        for (; idx < sampler->mCount; idx++) {
+            if (sampler->mThreads[idx].mTid == tid) {
+                break;
+            }
+        }
+        if (idx >= MAX_STAGE_THREADS) {
+            continue;
+        }
+        StageThread *thread = &(sampler->mThreads[idx]);
+        if (idx == sampler->mCount) {
+            sampler->mCount++;
+        }
+        INT32 length = RT_MIN((INT32)(end - begin - 1), (INT32)sizeof(thread->mName) - 1);
+        rt_memcpy(thread->mName, begin + 1, length);
+        thread->mName[length] = 0;
+        thread->mTid   = tid;
+        thread->mTicks = utime + stime;
+    }
+    closedir(dir);
+}
+
+static void* sampler_loop(void *ptr_sampler) {
+    StageSampler *sampler = reinterpret_cast<StageSampler *>(ptr_sampler);
+    while (THREAD_LOOP == sampler->mThread->getState()) {
+        sampler_poll(sampler);
+        RtTime::sleepMs(STAGE_SAMPLE_MS);
+    }
+    return RT_NULL;
+}
+
+static void sampler_dump(StageSampler *sampler, INT64 wallUs) {
+    // demuxer and decoder run on workers of executor, named rt_exec_N
+    static const char *stages[] = { "FFDemuxer", "TranscodeFeed", "FFDecoder", "FFEncoder", "FFMuxer",
+                                    "rt_exec_" };
+    INT64 hz = sysconf(_SC_CLK_TCK);
+    for (UINT32 stage = 0; stage < sizeof(stages) / sizeof(stages[0]); stage++) {
+        INT64 ticks = 0;
+        for (INT32 idx = 0; idx < sampler->mCount; idx++) {
+            if (0 == strncmp(sampler->mThreads[idx].mName, stages[stage], strlen(stages[stage]))) {
+                ticks += sampler->mThreads[idx].mTicks;
+            }
+        }
+        RT_LOGE("  %-14s | %6.1f%%", stages[stage], ticks * 100.0 * 1000000 / hz / RT_MAX(wallUs, 1ll));
+    }
+}
+
+RT_RET unit_test_player_transcode(const char *input, const char *output, INT64 bitrate) {
+    StageSampler sampler;
+    rt_memset(&sampler, 0, sizeof(StageSampler));
+    sampler.mThread = new RtThread(sampler_loop, &sampler);
+    sampler.mThread->setName("StageSampler");
+
+    RtMetaData *option = new RtMetaData();
+    if (bitrate > 0) {
+        option->setInt64(kKeyCodecBitrate, bitrate);
+    }
+
+    RTNDKTranscoder *transcoder = new RTNDKTranscoder();
+    sampler.mThread->start();
+    INT64  beginUs = RtTime::getNowTimeUs();
+    RT_RET err     = transcoder->transcode(input, output, option);
+    INT64  wallUs  = RtTime::getNowTimeUs() - beginUs;
+    sampler.mThread->requestInterruption();
+    sampler.mThread->join();
+
+    INT64 durationUs = transcoder->getDuration();
+    RT_LOGE("transcode %s to %s, err: %d", input, output, err);
+    RT_LOGE("frames=%d duration=%lldms wall=%lldms realtime-factor=%.2fx",
+             transcoder->getFrameCount(), durationUs / 1000, wallUs / 1000,
+             (double)durationUs / RT_MAX(wallUs, 1ll));
+    RT_LOGE("  stage          | utilisation");
+    sampler_dump(&sampler, wallUs);
+
+    rt_safe_delete(transcoder);
+    rt_safe_delete(option);
+    rt_safe_delete(sampler.mThread);
+    return err;
+}
+
+RT_RET unit_test_player_transcode_segments(const char *input, const char *output,
+                                           INT64 bitrate, INT32 threads) {
+    RtMetaData *option = new RtMetaData();
+    if (bitrate > 0) {
+        option->setInt64(kKeyCodecBitrate, bitrate);
+    }
+
+    RTNDKTranscoder *transcoder = new RTNDKTranscoder();
+    INT64  beginUs  = RtTime::getNowTimeUs();
+    RT_RET err      = transcoder->transcode(input, output, option);
+    INT64  serialUs = RtTime::getNowTimeUs() - beginUs;
+    INT64  durationUs = transcoder->getDuration();
+    UINT32 frames     = transcoder->getFrameCount();
+    RT_LOGE("one line:  frames=%d wall=%lldms realtime-factor=%.2fx err: %d",
+             transcoder->getFrameCount(), serialUs / 1000,
+             (double)durationUs / RT_MAX(serialUs, 1ll), err);
+
+    beginUs = RtTime::getNowTimeUs();
+    err     = transcoder->transcodeSegments(input, output, option, threads);
+    INT64  segmentUs = RtTime::getNowTimeUs() - beginUs;
+    durationUs = transcoder->getDuration();
+    RT_LOGE("segments:  frames=%d wall=%lldms realtime-factor=%.2fx err: %d",
+             transcoder->getFrameCount(), segmentUs / 1000,
+             (double)durationUs / RT_MAX(segmentUs, 1ll), err);
+    RT_LOGE("speedup of %d threads: %.2fx", threads, (double)serialUs / RT_MAX(segmentUs, 1ll));
+    // pictures at borders of segments, such as leading ones of open gop, are never lost
+    if ((RT_OK == err) && (transcoder->getFrameCount() != frames)) {
+        RT_LOGE("segments encode %d frames, one line encodes %d", transcoder->getFrameCount(), frames);
+        err = RT_ERR_VALUE;
+    }
+
+    rt_safe_delete(transcoder);
+    rt_safe_delete(option);
+    return err;
+}
+
+int main(int argc, char **argv) {
+    const char* input   = NULL;
+    const char* output  = NULL;
+    INT64       bitrate = 0;
+    INT32       threads = -1;
+    switch (argc) {
+      case 5:
+        threads = atoi(argv[4]);
+      case 4:
+        bitrate = atoll(argv[3]);
+      case 3:
+        output  = argv[2];
+        input   = argv[1];
+        break;
+      default:
+        RT_LOGE("Usage:");
+        RT_LOGE("./case_player_transcode <input> <output> [bitrate] [threads]");
+        RT_LOGE("   threads: segmented transcoding, 0 is one thread per cpu");
+        return 0;
+    }
+
+    rt_mem_record_reset();
+
+    if (threads >= 0) {
+        unit_test_player_transcode_segments(input, output, bitrate, threads);
+    } else {
+        unit_test_player_transcode(input, output, bitrate);
+    }
+
+    rt_mem_record_dump();
+    return 0;
+}
@@ -35,6 +35,9 @@ int main(int argc, char **argv) {
     rt_tests_add(test_ctx,
                  unit_test_taskpool,
                  const_cast<char *>("UnitTest-TaskPool"));
+    rt_tests_add(test_ctx,
+                 unit_test_executor,
+                 const_cast<char *>("UnitTest-Executor"));
 
     // ! run all testcases
     rt_tests_run(test_ctx, /*mem_dump=*/RT_TRUE);
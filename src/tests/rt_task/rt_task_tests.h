@@ -29,4 +29,6 @@ RT_RET  unit_test_msgqueue(INT32 index, INT32 total);
 
 RT_RET  unit_test_message(INT32 index, INT32 total);
 
+RT_RET  unit_test_executor(INT32 index, INT32 total);
+
 #endif  // SRC_TESTS_RT_TASK_RT_TASK_TESTS_H_
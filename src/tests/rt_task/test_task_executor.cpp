@@ -0,0 +1,220 @@
+/*
+ * Copyright 2019 Rockchip Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   Task: jobs on executor and on own threads, and threads, cpu and memory
+ *         of 1~500 audio players, each of them is demuxer, decoder and sink.
+ */
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "test_executor"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include "rt_executor.h" // NOLINT
+#include "rt_mem.h" // NOLINT
+#include "rt_time.h" // NOLINT
+#include "rt_task_tests.h" // NOLINT
+
+#define EXECUTOR_TEST_WORKERS   4
+#define EXECUTOR_TEST_JOBS      16
+#define EXECUTOR_TEST_RUN_MS    200
+#define EXECUTOR_TEST_STAGES    3
+#define EXECUTOR_TEST_BENCH_MS  1000
+
+typedef struct _JobTestCtx {
+    RtJob          *mJob;
+    volatile INT32  mInStep;
+    volatile INT32  mOverlaps;
+    volatile INT32  mSteps;
+    INT32           mDoneAt;    // returns RT_JOB_DONE at this step, 0: never
+    INT64           mDelayUs;
+    INT64           mStepUs;    // time of last step
+} JobTestCtx;
+
+static INT64 job_test_step(void *arg) {
+    JobTestCtx *ctx = reinterpret_cast<JobTestCtx *>(arg);
+    if (0 != __atomic_fetch_add(&ctx->mInStep, 1, __ATOMIC_ACQ_REL)) {
+        __atomic_fetch_add(&ctx->mOverlaps, 1, __ATOMIC_RELAXED);
+    }
+    INT32 steps = __atomic_add_fetch(&ctx->mSteps, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&ctx->mStepUs, (INT64)RtTime::getNowTimeUs(), __ATOMIC_RELAXED);
+    __atomic_fetch_sub(&ctx->mInStep, 1, __ATOMIC_ACQ_REL);
+    return ((ctx->mDoneAt > 0) && (steps >= ctx->mDoneAt)) ? RT_JOB_DONE : ctx->mDelayUs;
+}
+
+static RT_RET job_test_mode(RT_BOOL shared) {
+    JobTestCtx ctxs[EXECUTOR_TEST_JOBS];
+    RT_RET     err = RT_OK;
+    rt_memset(ctxs, 0, sizeof(ctxs));
+
+    for (INT32 idx = 0; idx < EXECUTOR_TEST_JOBS; idx++) {
+        ctxs[idx].mDelayUs = 1000;
+        ctxs[idx].mDoneAt  = (0 == idx) ? 5 : 0;
+        ctxs[idx].mJob     = new RtJob(job_test_step, &ctxs[idx]);
+        ctxs[idx].mJob->setName("job");
+        ctxs[idx].mJob->setShared(shared);
+        ctxs[idx].mJob->start();
+    }
+    RtTime::sleepMs(EXECUTOR_TEST_RUN_MS);
+
+    // job 0 ends by itself
+    if ((5 != ctxs[0].mSteps) || ctxs[0].mJob->isRunning()) {
+        RT_LOGE("job which is done: steps %d running %d", ctxs[0].mSteps, ctxs[0].mJob->isRunning());
+        err = RT_ERR_VALUE;
+    }
+
+    // wake runs next step at once instead of after delay
+    JobTestCtx *slow = &ctxs[1];
+    slow->mDelayUs = 1000000;
+    RtTime::sleepMs(20);
+    INT32 steps   = slow->mSteps;
+    INT64 wakeUs  = RtTime::getNowTimeUs();
+    slow->mJob->wake();
+    while ((slow->mSteps == steps) && (RtTime::getNowTimeUs() - wakeUs < 500000)) {
+        RtTime::sleepMs(1);
+    }
+    INT64 latencyUs = RtTime::getNowTimeUs() - wakeUs;
+    if (latencyUs > 100000) {
+        RT_LOGE("wake is late: %lldus", latencyUs);
+        err = RT_ERR_VALUE;
+    }
+
+    INT32 total = 0;
+    for (INT32 idx = 0; idx < EXECUTOR_TEST_JOBS; idx++) {
+        ctxs[idx].mJob->stop();
+        steps = ctxs[idx].mSteps;
+        if ((0 != ctxs[idx].mInStep) || (0 != ctxs[idx].mOverlaps) || (steps < 5)) {
+            RT_LOGE("job %d: steps %d overlaps %d", idx, steps, ctxs[idx].mOverlaps);
+            err = RT_ERR_VALUE;
+        }
+        total += steps;
+    }
+    RtTime::sleepMs(10);
+    for (INT32 idx = 0; idx < EXECUTOR_TEST_JOBS; idx++) {
+        total -= ctxs[idx].mSteps;
+        rt_safe_delete(ctxs[idx].mJob);
+    }
+    if (0 != total) {
+        RT_LOGE("%d steps after stop", -total);
+        err = RT_ERR_VALUE;
+    }
+    RT_LOGE("%s: %d jobs, err %d, wake latency %lldus", shared ? "shared" : "own thread",
+             EXECUTOR_TEST_JOBS, err, latencyUs);
+    return err;
+}
+
+/*
+ * stages of a player poll like nodes do: demuxer reads a packet every 2ms,
+ * decoder checks packets every 5ms, sink writes a period of 5ms. work of
+ * them is left out, what is measured is the cost of waiting.
+ */
+static const INT64 gStageDelayUs[EXECUTOR_TEST_STAGES] = { 2000, 5000, 5000 };
+
+typedef struct _StageCtx {
+    INT32   mStage;
+} StageCtx;
+
+static INT64 player_stage_step(void *arg) {
+    StageCtx *ctx = reinterpret_cast<StageCtx *>(arg);
+    return gStageDelayUs[ctx->mStage];
+}
+
+static INT32 bench_proc_status(const char *key) {
+    char  line[128];
+    INT32 value = 0;
+    FILE *fp = fopen("/proc/self/status", "r");
+    if (RT_NULL == fp) {
+        return -1;
+    }
+    while (RT_NULL != fgets(line, sizeof(line), fp)) {
+        if (0 == strncmp(line, key, strlen(key))) {
+            sscanf(line + strlen(key), "%d", &value);
+            break;
+        }
+    }
+    fclose(fp);
+    return value;
+}
+
+static INT64 bench_cpu_us() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (INT64)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000
+            + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+static void executor_bench(INT32 players, RT_BOOL shared) {
+    INT32     count = players * EXECUTOR_TEST_STAGES;
+    RtJob   **jobs  = rt_malloc_array(RtJob *, count);
+    StageCtx *ctxs  = rt_malloc_array(StageCtx, count);
+    if ((RT_NULL == jobs) || (RT_NULL == ctxs)) {
+        rt_safe_free(jobs);
+        rt_safe_free(ctxs);
+        return;
+    }
+
+    INT32 rssKb = bench_proc_status("VmRSS:");
+    for (INT32 idx = 0; idx < count; idx++) {
+        ctxs[idx].mStage = idx % EXECUTOR_TEST_STAGES;
+        jobs[idx] = new RtJob(player_stage_step, &ctxs[idx]);
+        jobs[idx]->setName("player");
+        jobs[idx]->setShared(shared);
+        jobs[idx]->start();
+    }
+    RtTime::sleepMs(100);
+    INT64 cpuUs  = bench_cpu_us();
+    INT64 wallUs = RtTime::getNowTimeUs();
+    RtTime::sleepMs(EXECUTOR_TEST_BENCH_MS);
+    cpuUs  = bench_cpu_us() - cpuUs;
+    wallUs = RtTime::getNowTimeUs() - wallUs;
+    INT32 threads = bench_proc_status("Threads:");
+    rssKb = bench_proc_status("VmRSS:") - rssKb;
+
+    for (INT32 idx = 0; idx < count; idx++) {
+        rt_safe_delete(jobs[idx]);
+    }
+    rt_safe_free(jobs);
+    rt_safe_free(ctxs);
+    RT_LOGE("%-10s %3d players: %4d threads, cpu %3lld%%, rss +%dKB",
+             shared ? "executor" : "own thread", players, threads,
+             cpuUs * 100 / RT_MAX(wallUs, 1ll), rssKb);
+}
+
+RT_RET unit_test_executor(INT32 index, INT32 total) {
+    static const INT32 players[] = { 1, 10, 100, 500 };
+    rt_executor_init(EXECUTOR_TEST_WORKERS);
+
+    RT_RET err = job_test_mode(RT_TRUE);
+    if (RT_OK == err) {
+        err = job_test_mode(RT_FALSE);
+    }
+    if (RT_OK != err) {
+        return err;
+    }
+
+    for (INT32 idx = 0; idx < (INT32)(sizeof(players) / sizeof(players[0])); idx++) {
+        executor_bench(players[idx], RT_FALSE);
+        executor_bench(players[idx], RT_TRUE);
+    }
+
+    RtExecutorStat stat;
+    rt_executor_stat(&stat);
+    RT_LOGE("executor: %d workers, %d jobs, %llu steps", stat.mWorkers, stat.mJobs, stat.mSteps);
+    return (0 == stat.mJobs) ? RT_OK : RT_ERR_VALUE;
+}